@@ -32,5 +32,40 @@ error = assert.throws(
     () => coll.aggregate([{$unwind: "$y"}, {$group: {_id: null, strings: {$addToSet: "$y"}}}]));
 assert.eq(error.code, ErrorCodes.ExceededMemoryLimit);
 
+// With 'allowDiskUse', both accumulators spill to disk instead of failing, and produce the same
+// results as they do when they stay within the limit.
+const pushPipeline = [
+    {$sort: {_id: 1}},
+    {$unwind: "$y"},
+    {$group: {_id: {$mod: ["$x", 3]}, strings: {$push: "$y"}}},
+    {$sort: {_id: 1}}
+];
+const addToSetPipeline = [
+    {$unwind: "$y"},
+    {$group: {_id: {$mod: ["$x", 3]}, strings: {$addToSet: "$y"}}},
+    {$project: {_id: 1, strings: {$size: "$strings"}}},
+    {$sort: {_id: 1}}
+];
+assert.commandWorked(db.adminCommand({
+    setParameter: 1,
+    internalQueryMaxPushBytes: 100 * 1024 * 1024,
+    internalQueryMaxAddToSetBytes: 100 * 1024 * 1024
+}));
+const expectedPush = coll.aggregate(pushPipeline).toArray();
+const expectedAddToSet = coll.aggregate(addToSetPipeline).toArray();
+
+assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalQueryMaxPushBytes: 100, internalQueryMaxAddToSetBytes: 100}));
+assert.eq(coll.aggregate(pushPipeline, {allowDiskUse: true}).toArray(), expectedPush);
+assert.eq(coll.aggregate(addToSetPipeline, {allowDiskUse: true}).toArray(), expectedAddToSet);
+
+// The profiler reports that the aggregation used disk.
+assert.commandWorked(db.setProfilingLevel(2));
+coll.aggregate(pushPipeline, {allowDiskUse: true, comment: "spilling push"}).toArray();
+const profileEntry = db.system.profile.findOne({"command.comment": "spilling push"});
+assert.neq(null, profileEntry);
+assert.eq(profileEntry.usedDisk, true, tojson(profileEntry));
+assert.commandWorked(db.setProfilingLevel(0));
+
 MongoRunner.stopMongod(conn);
 }());
@@ -0,0 +1,71 @@
+/**
+ * Tests that an unfiltered $group which only needs the fields of an index reads them with a covered
+ * scan of the whole index rather than a COLLSCAN, and that documents which lack the indexed fields
+ * are grouped the same way as without the index.
+ *
+ * @tags: [requires_fcv_47]
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For aggPlanHasStage().
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB(jsTestName());
+const coll = testDB.coll;
+
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < 1000; ++i) {
+    const doc = {_id: i, a: i % 10, b: i, c: "c" + i};
+    if (i % 7 == 0) {
+        delete doc.a;
+    } else if (i % 11 == 0) {
+        doc.a = null;
+    }
+    bulk.insert(doc);
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(coll.createIndex({a: 1, b: 1}));
+
+function assertCovered(pipeline, expectCovered) {
+    const explain = coll.explain().aggregate(pipeline);
+    assert.eq(aggPlanHasStage(explain, "IXSCAN"), expectCovered, tojson(explain));
+    assert.eq(aggPlanHasStage(explain, "COLLSCAN"), !expectCovered, tojson(explain));
+    assert(!aggPlanHasStage(explain, "FETCH"), tojson(explain));
+
+    // The results are the same as those of a COLLSCAN.
+    const sortedPipeline = pipeline.concat([{$sort: {_id: 1}}]);
+    assert.eq(coll.aggregate(sortedPipeline).toArray(),
+              coll.aggregate(sortedPipeline, {hint: {$natural: 1}}).toArray(),
+              tojson(pipeline));
+}
+
+assertCovered([{$group: {_id: "$a", n: {$sum: 1}}}], true);
+assertCovered([{$group: {_id: "$a", total: {$sum: "$b"}, min: {$min: "$b"}, max: {$max: "$b"}}}],
+              true);
+assertCovered([{$group: {_id: null, avg: {$avg: "$a"}, count: {$sum: 1}}}], true);
+assertCovered([{$project: {a: 1, _id: 0}}, {$group: {_id: "$a", max: {$max: "$b"}}}], true);
+
+// Documents which lack 'a' are grouped with those where 'a' is null.
+const groups = coll.aggregate([{$group: {_id: "$a", n: {$sum: 1}}}, {$sort: {_id: 1}}]).toArray();
+assert.eq(groups[0]._id, null, tojson(groups));
+assert.eq(groups[0].n,
+          coll.find({$or: [{a: null}, {a: {$exists: false}}]}).itcount(),
+          tojson(groups));
+
+// A field outside of the index needs the documents.
+assertCovered([{$group: {_id: "$a", n: {$sum: "$c"}}}], false);
+
+// The output of these pipelines would tell a missing field from a null one.
+assertCovered([{$group: {_id: {a: "$a"}, n: {$sum: 1}}}], false);
+assertCovered([{$group: {_id: "$a", all: {$push: "$b"}}}], false);
+assertCovered([{$group: {_id: {$type: "$a"}, n: {$sum: 1}}}], false);
+assertCovered([{$project: {a: 1, _id: 0}}], false);
+
+// A multikey index can't cover the $group.
+assert.commandWorked(coll.insert({_id: "array", a: [1, 2], b: 1}));
+assertCovered([{$group: {_id: "$a", n: {$sum: 1}}}], false);
+
+MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,130 @@
+/**
+ * Tests that a clustered collection, which stores its documents keyed by _id instead of keeping a
+ * separate _id index, returns the same results as a regular collection, and that queries on _id
+ * only read the matching range of its records.
+ *
+ * @tags: [requires_wiredtiger, requires_fcv_47]
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage.
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB(jsTestName());
+const clustered = testDB.clustered;
+const regular = testDB.regular;
+
+assert.commandWorked(testDB.createCollection(clustered.getName(), {clusteredIndex: true}));
+assert.commandWorked(testDB.createCollection(regular.getName()));
+
+// The collection has no _id index.
+assert.eq(clustered.getIndexes(), []);
+const info = testDB.getCollectionInfos({name: clustered.getName()})[0];
+assert.eq(info.options.clusteredIndex, true, tojson(info));
+
+// The _id values include numbers of different types, strings, documents and ObjectIds, and are
+// not inserted in order.
+const docs = [];
+for (let i = 99; i >= 0; --i) {
+    docs.push({_id: i % 3 ? i : NumberLong(i), x: i});
+    docs.push({_id: "s" + i, x: i});
+}
+docs.push({_id: {a: 1, b: "c"}, x: 100});
+docs.push({_id: 0.5, x: 101});
+docs.push({_id: ObjectId(), x: 102});
+for (let coll of [clustered, regular]) {
+    assert.commandWorked(coll.insert(docs, {ordered: false}));
+}
+
+function assertSameResults(query, sort) {
+    sort = sort || {x: 1, _id: 1};
+    assert.eq(clustered.find(query).sort(sort).toArray(),
+              regular.find(query).sort(sort).toArray(),
+              tojson(query));
+}
+
+assertSameResults({});
+assertSameResults({_id: 5});
+assertSameResults({_id: NumberLong(3)});
+assertSameResults({_id: "s7"});
+assertSameResults({_id: {a: 1, b: "c"}});
+assertSameResults({_id: {$gte: 10, $lt: 20}});
+assertSameResults({_id: {$gt: 0, $lte: 1}});
+assertSameResults({_id: {$gt: "s5"}});
+assertSameResults({_id: {$lt: 5}, x: {$gt: 2}});
+assertSameResults({_id: {$in: [1, "s1", 200]}});
+assertSameResults({x: {$gte: 50}}, {_id: -1});
+
+// Queries on _id read the records in the range they match.
+function getCollScan(query) {
+    const explain = clustered.find(query).explain("executionStats");
+    const collScan = getPlanStage(explain.executionStats.executionStages, "COLLSCAN");
+    assert.neq(null, collScan, tojson(explain));
+    return collScan;
+}
+
+let collScan = getCollScan({_id: 5});
+assert(collScan.hasOwnProperty("minRecord"), tojson(collScan));
+assert.eq(collScan.minRecord, collScan.maxRecord, tojson(collScan));
+assert.eq(collScan.docsExamined, 1, tojson(collScan));
+
+collScan = getCollScan({_id: "s42"});
+assert.eq(collScan.docsExamined, 1, tojson(collScan));
+
+collScan = getCollScan({_id: 1000});
+assert.eq(collScan.docsExamined, 0, tojson(collScan));
+
+collScan = getCollScan({_id: {$gte: 10, $lt: 20}});
+assert(collScan.hasOwnProperty("minRecord"), tojson(collScan));
+assert(collScan.hasOwnProperty("maxRecord"), tojson(collScan));
+assert.eq(collScan.docsExamined, 11, tojson(collScan));
+
+collScan = getCollScan({x: 5});
+assert(!collScan.hasOwnProperty("minRecord"), tojson(collScan));
+assert.eq(collScan.docsExamined, docs.length, tojson(collScan));
+
+// A query with a collation other than the simple collation reads every record.
+collScan = clustered.find({_id: "s42"}).collation({locale: "fr"}).explain("executionStats");
+assert.eq(collScan.executionStats.totalDocsExamined, docs.length, tojson(collScan));
+
+// The _id values which compare equal are duplicates.
+for (let dup of [5, NumberLong(5), 5.0, NumberInt(5), "s5", {a: 1, b: "c"}]) {
+    assert.commandFailedWithCode(clustered.insert({_id: dup}), ErrorCodes.DuplicateKey);
+}
+assert.eq(clustered.find().itcount(), docs.length);
+
+// Updates and deletes.
+for (let coll of [clustered, regular]) {
+    assert.commandWorked(coll.update({_id: 5}, {$set: {y: 1}}));
+    assert.commandWorked(coll.update({_id: {$gte: 90}}, {$inc: {x: 1000}}, {multi: true}));
+    assert.commandWorked(coll.update({_id: "new"}, {$set: {x: 103}}, {upsert: true}));
+    assert.commandWorked(coll.remove({_id: {$lt: 10}}));
+    assert.commandWorked(coll.remove({_id: "s3"}));
+}
+assertSameResults({});
+
+// Secondary indexes are not supported.
+assert.commandFailedWithCode(clustered.createIndex({x: 1}), ErrorCodes.CannotCreateIndex);
+
+// A clustered collection cannot be combined with other options.
+for (let options of [{capped: true, size: 1024},
+                     {collation: {locale: "fr"}},
+                     {idIndex: {key: {_id: 1}, name: "_id_"}}]) {
+    assert.commandFailedWithCode(
+        testDB.createCollection("bad", Object.assign({clusteredIndex: true}, options)),
+        ErrorCodes.BadValue);
+}
+assert.eq(testDB.getCollectionInfos({name: "bad"}), []);
+
+// The collection survives a restart.
+MongoRunner.stopMongod(conn);
+const restarted = MongoRunner.runMongod({dbpath: conn.dbpath, noCleanData: true});
+assert.neq(null, restarted, "mongod was unable to restart");
+const restartedDB = restarted.getDB(jsTestName());
+assert.eq(restartedDB.clustered.find().sort({x: 1, _id: 1}).toArray(),
+          restartedDB.regular.find().sort({x: 1, _id: 1}).toArray());
+assert.commandFailedWithCode(restartedDB.clustered.insert({_id: 20}), ErrorCodes.DuplicateKey);
+MongoRunner.stopMongod(restarted);
+}());
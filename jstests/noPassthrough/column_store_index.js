@@ -0,0 +1,83 @@
+/**
+ * Tests that a query which would scan the collection reads only the columns it needs from a column
+ * store index instead, with the same results, and that column store indexes are gated on the
+ * featureCompatibilityVersion.
+ *
+ * @tags: [requires_wiredtiger, requires_fcv_47]
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage.
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB(jsTestName());
+const adminDB = conn.getDB("admin");
+const coll = testDB.coll;
+
+const docs = [];
+for (let i = 0; i < 200; ++i) {
+    const doc = {_id: i, a: i % 7, c: "s" + i};
+    if (i % 3) {
+        doc.b = {x: i, y: [i, i + 1]};
+    }
+    if (i % 5 == 0) {
+        doc.d = [{e: i}, {e: i % 2}];
+    }
+    docs.push(doc);
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({"$**": "columnstore"}));
+
+function assertUsesColumnScan(query, projection, sort) {
+    let cursor = coll.find(query, projection);
+    let expectedCursor = coll.find(query, projection).hint({$natural: 1});
+    if (sort) {
+        cursor = cursor.sort(sort);
+        expectedCursor = expectedCursor.sort(sort);
+    }
+    const explain = cursor.explain();
+    assert.neq(null, getPlanStage(explain, "COLUMN_SCAN"), tojson(explain));
+    assert.eq(cursor.toArray(), expectedCursor.toArray(), tojson({query, projection, sort}));
+}
+
+assertUsesColumnScan({a: 3}, {a: 1, c: 1});
+assertUsesColumnScan({"b.x": {$gt: 100}}, {_id: 0, b: 1});
+assertUsesColumnScan({"b.y": 11}, {"b.x": 1});
+assertUsesColumnScan({"d.e": 1}, {_id: 0, a: 1, d: 1});
+assertUsesColumnScan({b: {$exists: false}}, {c: 1}, {c: -1});
+assertUsesColumnScan({}, {a: 1}, {a: 1, _id: 1});
+
+// The documents are kept up to date by updates and deletes.
+assert.commandWorked(coll.update({a: 3}, {$set: {c: "updated"}, $unset: {b: 1}}, {multi: true}));
+assert.commandWorked(coll.remove({a: 4}));
+assertUsesColumnScan({a: {$in: [3, 4]}}, {b: 1, c: 1});
+
+// A query which needs the whole document, or more fields than the planner allows, scans the
+// collection.
+let explain = coll.find({a: 3}).explain();
+assert.eq(null, getPlanStage(explain, "COLUMN_SCAN"), tojson(explain));
+assert.commandWorked(
+    adminDB.runCommand({setParameter: 1, internalQueryColumnScanMaxFields: 2}));
+explain = coll.find({a: 3}, {b: 1, c: 1}).explain();
+assert.eq(null, getPlanStage(explain, "COLUMN_SCAN"), tojson(explain));
+assert.commandWorked(
+    adminDB.runCommand({setParameter: 1, internalQueryColumnScanMaxFields: 5}));
+
+// The featureCompatibilityVersion cannot be downgraded while a column store index exists. The
+// failed downgrade leaves it downgrading, where column store indexes cannot be created, until the
+// index is dropped and the downgrade completes.
+assert.commandFailedWithCode(adminDB.runCommand({setFeatureCompatibilityVersion: lastLTSFCV}),
+                             ErrorCodes.IllegalOperation);
+assert.commandFailedWithCode(testDB.other.createIndex({"$**": "columnstore"}),
+                             ErrorCodes.CannotCreateIndex);
+assert.commandWorked(coll.dropIndex({"$**": "columnstore"}));
+assert.commandWorked(adminDB.runCommand({setFeatureCompatibilityVersion: lastLTSFCV}));
+assert.commandFailedWithCode(coll.createIndex({"$**": "columnstore"}),
+                             ErrorCodes.CannotCreateIndex);
+assert.commandWorked(adminDB.runCommand({setFeatureCompatibilityVersion: latestFCV}));
+assert.commandWorked(coll.createIndex({"$**": "columnstore"}));
+
+MongoRunner.stopMongod(conn);
+})();
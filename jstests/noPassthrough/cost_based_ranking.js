@@ -0,0 +1,90 @@
+/**
+ * Tests that the 'analyze' command gathers statistics about a collection, and that the planner
+ * uses them to discard candidate plans which are clearly more expensive than the cheapest one,
+ * reporting the estimated cardinalities in explain.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");
+
+const conn = MongoRunner.runMongod({
+    setParameter: {internalQueryPlannerEnableCostBasedRanking: true},
+});
+assert.neq(null, conn, "mongod was unable to start up");
+const db = conn.getDB("test");
+const coll = db.cost_based_ranking;
+coll.drop();
+
+// 'a' is unique, while 'b' is 0 in all but 10 documents.
+const kNumDocs = 1000;
+let docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i, b: i < 990 ? 0 : 1});
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+
+const query = {
+    a: 5,
+    b: 0
+};
+
+// Without statistics, both index scans are raced against each other.
+let explain = coll.find(query).explain();
+assert.gt(getRejectedPlans(explain).length, 0, explain);
+assert.eq(null, getPlanStage(explain.queryPlanner.winningPlan, "IXSCAN").estimatedCardinality);
+
+// Analyze the indexed paths.
+let res = assert.commandWorked(db.runCommand({analyze: coll.getName()}));
+assert.eq(kNumDocs, res.numDocuments, res);
+assert.eq(["_id", "a", "b"], res.fields.map(field => field.path).sort(), res);
+for (let field of res.fields) {
+    assert.eq(kNumDocs, field.valueCount, res);
+    assert.gt(field.numBuckets, 0, res);
+}
+const aStats = res.fields.find(field => field.path === "a");
+assert.between(0.9 * kNumDocs, aStats.distinctCount, 1.1 * kNumDocs, res);
+assert.eq(3, db.system.statistics.find({"_id.coll": coll.getName()}).itcount());
+
+// The scan of the index on 'b' examines almost every document, so it is discarded without a trial.
+explain = coll.find(query).explain();
+assert.eq(0, getRejectedPlans(explain).length, explain);
+const ixscan = getPlanStage(explain.queryPlanner.winningPlan, "IXSCAN");
+assert.eq({a: 1}, ixscan.keyPattern, explain);
+assert.lte(ixscan.estimatedCardinality, 2, explain);
+assert.eq([{_id: 5, a: 5, b: 0}], coll.find(query).toArray());
+
+// Candidates of comparable cost are still raced.
+explain = coll.find({a: {$gte: 990}, b: 1}).explain();
+assert.gt(getRejectedPlans(explain).length, 0, explain);
+assert.eq(10, coll.find({a: {$gte: 990}, b: 1}).itcount());
+
+// The statistics of a dropped collection do not apply to a new collection of the same name.
+assert(coll.drop());
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+explain = coll.find(query).explain();
+assert.gt(getRejectedPlans(explain).length, 0, explain);
+
+// Only the given paths are analyzed when 'keys' is specified.
+res = assert.commandWorked(
+    db.runCommand({analyze: coll.getName(), keys: ["a"], numberOfBuckets: 10}));
+assert.eq(["a"], res.fields.map(field => field.path), res);
+assert.lte(res.fields[0].numBuckets, 10, res);
+
+// The index on 'b' cannot be costed without statistics on 'b', so the candidates are raced.
+explain = coll.find(query).explain();
+assert.gt(getRejectedPlans(explain).length, 0, explain);
+
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), keys: "a"}), 5095410);
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), keys: [""]}), 5095411);
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), numberOfBuckets: 0}),
+                             5095412);
+assert.commandFailedWithCode(db.runCommand({analyze: "does_not_exist"}),
+                             ErrorCodes.NamespaceNotFound);
+
+MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,90 @@
+/**
+ * Tests that $facet sub-pipelines run by concurrent workers produce the same results as when they
+ * run one at a time, including when the input is split into many small batches, and when there are
+ * fewer worker threads than sub-pipelines.
+ *
+ * @tags: [requires_fcv_47]
+ */
+(function() {
+"use strict";
+
+// Fewer worker threads than there are sub-pipelines in the $facet stages below.
+const conn = MongoRunner.runMongod({setParameter: {internalQueryFacetWorkerPoolMaxThreads: 4}});
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB(jsTestName());
+const coll = testDB.coll;
+const otherColl = testDB.other;
+
+const numDocs = 5000;
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < numDocs; ++i) {
+    bulk.insert({_id: i, category: "cat" + (i % 7), price: (i * 37) % 1000, tags: ["a", "b"]});
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(otherColl.insert({_id: "cat0", label: "first"}));
+
+function setParameter(params) {
+    assert.commandWorked(testDB.adminCommand(Object.assign({setParameter: 1}, params)));
+}
+
+function runFacet(facetSpec) {
+    return coll.aggregate([{$facet: facetSpec}]).toArray();
+}
+
+const dashboard = {
+    byCategory: [{$sortByCount: "$category"}, {$sort: {count: -1, _id: 1}}],
+    priceBuckets: [{$bucket: {groupBy: "$price", boundaries: [0, 250, 500, 750, 1000]}}],
+    topPrices: [{$sort: {price: -1, _id: 1}}, {$limit: 5}],
+    tagCounts: [{$unwind: "$tags"}, {$group: {_id: "$tags", n: {$sum: 1}}}, {$sort: {_id: 1}}],
+    cheap: [{$match: {price: {$lt: 10}}}, {$project: {_id: 1}}, {$sort: {_id: 1}}],
+    total: [{$count: "n"}],
+    stats: [{$group: {_id: null, avg: {$avg: "$price"}, max: {$max: "$price"}}}],
+};
+
+setParameter({internalQueryFacetMaxWorkers: 0});
+const serialResult = runFacet(dashboard);
+assert.eq(serialResult.length, 1, tojson(serialResult));
+assert.eq(serialResult[0].total, [{n: numDocs}], tojson(serialResult));
+
+// Use a small buffer so that the workers have to wait for many batches.
+setParameter({internalQueryFacetBufferSizeBytes: 16 * 1024});
+for (let maxWorkers of [2, 4, 16]) {
+    setParameter({internalQueryFacetMaxWorkers: maxWorkers});
+    assert.eq(runFacet(dashboard), serialResult, "maxWorkers: " + maxWorkers);
+}
+
+// Sub-pipelines which read from another collection still work, since they make the $facet run
+// on the calling thread.
+const withLookup = Object.assign({}, dashboard, {
+    joined: [
+        {$match: {_id: 0}},
+        {$lookup: {from: otherColl.getName(), localField: "category", foreignField: "_id", as: "c"}}
+    ]
+});
+const lookupResult = runFacet(withLookup);
+assert.eq(lookupResult[0].joined.length, 1, tojson(lookupResult));
+assert.eq(lookupResult[0].joined[0].c, [{_id: "cat0", label: "first"}], tojson(lookupResult));
+assert.eq(lookupResult[0].topPrices, serialResult[0].topPrices, tojson(lookupResult));
+
+// Concurrent $facet stages wanting more worker threads than are left run with fewer workers, or
+// on the calling thread, rather than waiting for threads held by the others.
+const shellCode = `
+    const coll = db.getSiblingDB("${testDB.getName()}").coll;
+    for (let j = 0; j < 5; ++j) {
+        assert.eq(coll.aggregate([{$facet: ${tojson(dashboard)}}]).toArray(),
+                  ${tojson(serialResult)});
+    }`;
+const awaitShells = [];
+for (let i = 0; i < 4; ++i) {
+    awaitShells.push(startParallelShell(shellCode, conn.port));
+}
+awaitShells.forEach(awaitShell => awaitShell());
+
+// Errors raised by a worker are reported to the client.
+setParameter({internalQueryFacetMaxOutputDocSizeBytes: 1024});
+assert.commandFailedWithCode(
+    testDB.runCommand({aggregate: coll.getName(), pipeline: [{$facet: dashboard}], cursor: {}}),
+    4031700);
+
+MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,72 @@
+/**
+ * Tests that $graphLookup spills its visited documents and frontier to disk when it exceeds its
+ * memory limit and disk use is allowed, and that it reports doing so in explain.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getAggPlanStage().
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod failed to start up");
+
+const testDb = conn.getDB("test");
+const employees = testDb.graph_lookup_spill_to_disk_employees;
+const roots = testDb.graph_lookup_spill_to_disk_roots;
+employees.drop();
+roots.drop();
+
+// An org chart in which every employee other than the first reports to one of three managers.
+const numEmployees = 3000;
+const bulk = employees.initializeUnorderedBulkOp();
+for (let i = 0; i < numEmployees; ++i) {
+    const reportsTo = (i === 0 ? null : Math.floor((i - 1) / 3));
+    bulk.insert({_id: i, reportsTo: reportsTo, pad: "x".repeat(100)});
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(roots.insert([{_id: 0}, {_id: 1}, {_id: 4}]));
+
+const pipeline = [
+    {
+        $graphLookup: {
+            from: employees.getName(),
+            startWith: "$_id",
+            connectFromField: "_id",
+            connectToField: "reportsTo",
+            depthField: "depth",
+            as: "reports"
+        }
+    },
+    {$project: {numReports: {$size: "$reports"}, maxDepth: {$max: "$reports.depth"}}},
+    {$sort: {_id: 1}}
+];
+
+const expected = roots.aggregate(pipeline).toArray();
+assert.eq(numEmployees - 1, expected[0].numReports, expected);
+
+// Lower the memory limit so that the search no longer fits in memory.
+assert.commandWorked(testDb.adminCommand(
+    {setParameter: 1, internalDocumentSourceGraphLookupMaxMemoryBytes: 256 * 1024}));
+assert.commandFailedWithCode(
+    testDb.runCommand(
+        {aggregate: roots.getName(), pipeline: pipeline, cursor: {}, allowDiskUse: false}),
+    40099);
+
+assert.eq(expected, roots.aggregate(pipeline, {allowDiskUse: true}).toArray());
+
+// Also search the frontier in small batches, which requires several queries per wave.
+assert.commandWorked(testDb.adminCommand(
+    {setParameter: 1, internalDocumentSourceGraphLookupFrontierBatchSizeBytes: 1024}));
+assert.eq(expected, roots.aggregate(pipeline, {allowDiskUse: true}).toArray());
+
+const explain = roots.explain("executionStats").aggregate(pipeline, {allowDiskUse: true});
+const graphLookupStage = getAggPlanStage(explain, "$graphLookup");
+assert.neq(null, graphLookupStage, explain);
+const searchStats = graphLookupStage.$graphLookup.searchStats;
+assert.eq(true, searchStats.usedDisk, explain);
+assert.gt(searchStats.numVisitedSpills, 0, explain);
+assert.gt(searchStats.numVisitedDocumentsSpilled, 0, explain);
+assert.gt(searchStats.numQueries, expected[0].maxDepth + 1, explain);
+
+MongoRunner.stopMongod(conn);
+}());
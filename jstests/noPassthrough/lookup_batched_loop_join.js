@@ -0,0 +1,99 @@
+/**
+ * Tests that a localField/foreignField $lookup which runs one foreign pipeline per batch of input
+ * documents, as set by internalQueryLookupBatchSize, returns the same documents in the same order
+ * as one which runs a foreign pipeline per input document.
+ *
+ * @tags: [requires_fcv_47]
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB(jsTestName());
+const coll = testDB.local;
+const foreign = testDB.foreign;
+
+// The local values include numbers of different types which compare equal, arrays, regular
+// expressions, null and missing values.
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < 500; ++i) {
+    const doc = {_id: i};
+    switch (i % 8) {
+        case 0:
+            break;
+        case 1:
+            doc.a = null;
+            break;
+        case 2:
+            doc.a = [i % 40, (i + 1) % 40];
+            break;
+        case 3:
+            doc.a = NumberLong(i % 40);
+            break;
+        case 4:
+            doc.a = /^s1/;
+            break;
+        case 5:
+            doc.a = "s" + (i % 20);
+            break;
+        default:
+            doc.a = i % 40;
+    }
+    bulk.insert(doc);
+}
+assert.commandWorked(bulk.execute());
+
+const foreignBulk = foreign.initializeUnorderedBulkOp();
+for (let i = 0; i < 100; ++i) {
+    foreignBulk.insert({_id: i, x: i % 50});
+    foreignBulk.insert({_id: 100 + i, x: [i % 30, "s" + (i % 30)]});
+}
+foreignBulk.insert({_id: 1000});
+foreignBulk.insert({_id: 1001, x: /^s1/});
+assert.commandWorked(foreignBulk.execute());
+
+function setParameter(params) {
+    assert.commandWorked(testDB.adminCommand(Object.assign({setParameter: 1}, params)));
+}
+
+const pipeline = [
+    {$sort: {_id: 1}},
+    {$lookup: {from: foreign.getName(), localField: "a", foreignField: "x", as: "joined"}}
+];
+
+function getStrategy() {
+    const explain = coll.explain("executionStats").aggregate(pipeline);
+    const lookupStage = explain.stages.find(stage => stage.hasOwnProperty("$lookup"));
+    return lookupStage.$lookup.strategy;
+}
+
+setParameter({internalQueryLookupBatchSize: 0});
+const expected = coll.aggregate(pipeline).toArray();
+assert.eq(expected.length, 500);
+assert.eq(getStrategy(), "NestedLoopJoin");
+
+for (let batchSize of [2, 7, 100, 1000]) {
+    setParameter({internalQueryLookupBatchSize: batchSize});
+    assert.eq(coll.aggregate(pipeline).toArray(), expected, "batchSize: " + batchSize);
+    assert.eq(coll.aggregate(pipeline, {cursor: {batchSize: 3}}).toArray(),
+              expected,
+              "batchSize: " + batchSize);
+    assert.eq(getStrategy(), "BatchedLoopJoin");
+}
+
+// Once the hash join is enabled, a small foreign collection is joined with a hash table, unless
+// 'foreignField' has a visible index.
+setParameter({internalQueryLookupHashJoinMaxForeignCollectionCount: 1000});
+assert.eq(coll.aggregate(pipeline).toArray(), expected);
+assert.eq(getStrategy(), "HashJoin");
+
+assert.commandWorked(foreign.createIndex({x: 1}));
+assert.eq(getStrategy(), "BatchedLoopJoin");
+
+assert.commandWorked(foreign.hideIndex({x: 1}));
+assert.eq(coll.aggregate(pipeline).toArray(), expected);
+assert.eq(getStrategy(), "HashJoin");
+
+MongoRunner.stopMongod(conn);
+}());
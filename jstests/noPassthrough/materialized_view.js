@@ -0,0 +1,138 @@
+/**
+ * Tests that a materialized view holds the output of its pipeline over the source collection as
+ * documents are inserted into, updated in and deleted from the source, and that the secondaries
+ * replicate the view's documents.
+ *
+ * @tags: [requires_replication, requires_fcv_47]
+ */
+(function() {
+"use strict";
+
+const rst = new ReplSetTest({nodes: 2});
+rst.startSet();
+rst.initiate();
+
+const primaryDB = rst.getPrimary().getDB(jsTestName());
+const source = primaryDB.orders;
+const view = primaryDB.rollup;
+
+assert.commandWorked(primaryDB.createCollection(source.getName(), {recordPreImages: true}));
+for (let i = 0; i < 100; ++i) {
+    assert.commandWorked(
+        source.insert({_id: i, cust: "c" + (i % 7), status: i % 3 ? "A" : "B", amount: i}));
+}
+
+const pipeline = [
+    {$match: {status: "A"}},
+    {$set: {cents: {$multiply: ["$amount", 100]}}},
+    {$group: {_id: "$cust", n: {$sum: 1}, total: {$sum: "$amount"}, cents: {$sum: "$cents"}}}
+];
+assert.commandWorked(primaryDB.runCommand(
+    {create: view.getName(), materializedView: {source: source.getName(), pipeline: pipeline}}));
+
+function assertViewIsUpToDate() {
+    const expected = source.aggregate(pipeline.concat([{$sort: {_id: 1}}])).toArray();
+    assert.eq(view.find().sort({_id: 1}).toArray(), expected);
+}
+
+// The view is filled when it is created.
+assertViewIsUpToDate();
+assert.eq(view.find().itcount(), 7);
+
+// Inserts, including a batch.
+assert.commandWorked(source.insert({_id: 100, cust: "c0", status: "A", amount: 1000}));
+assert.commandWorked(source.insert([
+    {_id: 101, cust: "new", status: "A", amount: 5},
+    {_id: 102, cust: "new", status: "A", amount: 6},
+    {_id: 103, status: "A", amount: 7},
+]));
+assertViewIsUpToDate();
+
+// Updates which change the summed values, the group and whether the document matches.
+assert.commandWorked(source.update({_id: 1}, {$inc: {amount: 10}}));
+assert.commandWorked(source.update({_id: 2}, {$set: {cust: "c3"}}));
+assert.commandWorked(source.update({_id: 4}, {$set: {status: "B"}}));
+assert.commandWorked(source.update({_id: 3}, {$set: {status: "A"}}));
+assert.commandWorked(source.update({}, {$inc: {amount: 1}}, {multi: true}));
+assert.commandWorked(source.update({_id: 0}, {cust: "c1", status: "A", amount: 3}));
+assertViewIsUpToDate();
+
+// Deleting every document of a group removes the group.
+assert.commandWorked(source.remove({cust: "new"}));
+assert.eq(view.find({_id: "new"}).itcount(), 0);
+assert.commandWorked(source.remove({_id: {$lt: 20}}));
+assertViewIsUpToDate();
+
+// Writes in a transaction update the view in the same transaction.
+const session = primaryDB.getMongo().startSession();
+const sessionSource = session.getDatabase(primaryDB.getName())[source.getName()];
+session.startTransaction();
+assert.commandWorked(sessionSource.insert({_id: 200, cust: "txn", status: "A", amount: 1}));
+assert.commandWorked(sessionSource.update({_id: 50}, {$inc: {amount: 100}}));
+assert.commandWorked(session.commitTransaction_forTesting());
+assertViewIsUpToDate();
+
+session.startTransaction();
+assert.commandWorked(sessionSource.insert({_id: 201, cust: "aborted", status: "A", amount: 1}));
+assert.commandWorked(session.abortTransaction_forTesting());
+assert.eq(view.find({_id: "aborted"}).itcount(), 0);
+assertViewIsUpToDate();
+
+// The secondaries replicate the writes to the view instead of applying the writes to the source
+// again.
+rst.awaitReplication();
+const secondaryView = rst.getSecondary().getDB(jsTestName())[view.getName()];
+assert.eq(secondaryView.find().sort({_id: 1}).toArray(), view.find().sort({_id: 1}).toArray());
+
+// The definition is stored in the options of the view's collection.
+const viewInfo = primaryDB.getCollectionInfos({name: view.getName()})[0];
+assert.eq(viewInfo.options.materializedView.source, source.getName(), tojson(viewInfo));
+
+// Invalid definitions are rejected.
+function assertCreateFails(name, definition, code) {
+    assert.commandFailedWithCode(
+        primaryDB.runCommand({create: name, materializedView: definition}), code);
+    assert.eq(primaryDB.getCollectionInfos({name: name}).length, 0);
+}
+const group = {$group: {_id: "$cust", n: {$sum: 1}}};
+assertCreateFails("bad", {source: source.getName(), pipeline: [group], extra: 1}, 5095420);
+assertCreateFails("bad", {source: 1, pipeline: [group]}, 5095421);
+assertCreateFails("bad", {source: source.getName(), pipeline: [{$match: {}}]}, 5095422);
+assertCreateFails("bad", {source: source.getName(), pipeline: [{$sort: {a: 1}}, group]}, 5095423);
+assertCreateFails(
+    "bad",
+    {source: source.getName(), pipeline: [{$group: {_id: "$cust", n: {$sum: 1}, a: {$avg: "$x"}}}]},
+    5095424);
+assertCreateFails(
+    "bad", {source: source.getName(), pipeline: [{$group: {_id: "$cust", a: {$sum: "$x"}}}]}, 5095425);
+assertCreateFails("bad", {source: "bad", pipeline: [group]}, 5095427);
+assert.commandWorked(primaryDB.createCollection("noPreImages"));
+assertCreateFails("bad", {source: "noPreImages", pipeline: [group]}, 5095428);
+
+// While views depend on the source, it cannot be renamed, replaced or dropped, nor can its
+// pre-images be disabled, including implicitly by a collMod which does not enable them.
+assert.commandFailedWithCode(source.renameCollection("renamed"), 5095436);
+assert.commandWorked(primaryDB.createCollection("other"));
+assert.commandFailedWithCode(primaryDB.other.renameCollection(source.getName(), true), 5095437);
+assert.commandFailedWithCode(
+    primaryDB.runCommand({collMod: source.getName(), recordPreImages: false}), 5095435);
+assert.commandFailedWithCode(primaryDB.runCommand({collMod: source.getName(), validator: {}}),
+                             5095435);
+assert.commandFailedWithCode(primaryDB.runCommand({drop: source.getName()}), 5095438);
+assert.commandWorked(source.update({_id: 50}, {$inc: {amount: 1}}));
+assertViewIsUpToDate();
+
+// Once the view is dropped, writes to the source no longer touch it, and the source can be dropped.
+assert(view.drop());
+assert.commandWorked(source.insert({_id: 300, cust: "afterDrop", status: "A", amount: 1}));
+assert.eq(primaryDB.getCollectionInfos({name: view.getName()}).length, 0);
+assert(source.drop());
+
+// Dropping the database drops the views along with their source.
+assert.commandWorked(primaryDB.createCollection(source.getName(), {recordPreImages: true}));
+assert.commandWorked(primaryDB.runCommand(
+    {create: view.getName(), materializedView: {source: source.getName(), pipeline: pipeline}}));
+assert.commandWorked(primaryDB.dropDatabase());
+
+rst.stopSet();
+})();
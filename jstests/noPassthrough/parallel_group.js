@@ -0,0 +1,89 @@
+/**
+ * Tests that a $group split across several consumers by internalQueryParallelGroupConsumers
+ * produces the same groups as a $group which runs on a single thread.
+ *
+ * @tags: [requires_fcv_47]
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB(jsTestName());
+const coll = testDB.coll;
+
+// The values of 'k' include numbers of different types which compare equal, and null, undefined
+// and missing values, which all belong to the same group.
+const numDocs = 5000;
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < numDocs; ++i) {
+    const doc = {_id: i, x: i % 100, s: "s" + (i % 13)};
+    switch (i % 10) {
+        case 0:
+            break;
+        case 1:
+            doc.k = null;
+            break;
+        case 2:
+            doc.k = undefined;
+            break;
+        case 3:
+            doc.k = NumberLong(i % 50);
+            break;
+        case 4:
+            doc.k = (i % 50) + 0.0;
+            break;
+        default:
+            doc.k = NumberInt(i % 50);
+    }
+    bulk.insert(doc);
+}
+assert.commandWorked(bulk.execute());
+
+function setParameter(params) {
+    assert.commandWorked(testDB.adminCommand(Object.assign({setParameter: 1}, params)));
+}
+
+function runGroup(pipeline, options) {
+    return coll.aggregate(pipeline.concat([{$sort: {_id: 1}}]), options || {}).toArray();
+}
+
+const pipelines = [
+    [{$group: {_id: "$k", n: {$sum: 1}, total: {$sum: "$x"}, min: {$min: "$x"}}}],
+    [
+        {$match: {x: {$lt: 50}}},
+        {$group: {_id: {k: "$k", s: "$s"}, n: {$sum: 1}, max: {$max: "$x"}}}
+    ],
+    [{$project: {s: 1, x: 1}}, {$group: {_id: "$s", avg: {$avg: "$x"}}}],
+];
+
+setParameter({internalQueryParallelGroupConsumers: 0});
+const serialResults = pipelines.map(pipeline => runGroup(pipeline));
+assert.eq(serialResults[0].length, 51, tojson(serialResults[0]));
+
+for (let nConsumers of [2, 4, 8]) {
+    setParameter({internalQueryParallelGroupConsumers: nConsumers});
+    for (let i = 0; i < pipelines.length; ++i) {
+        assert.eq(runGroup(pipelines[i]),
+                  serialResults[i],
+                  "nConsumers: " + nConsumers + ", pipeline: " + tojson(pipelines[i]));
+    }
+}
+
+// Each consumer spills its groups when it runs out of memory.
+setParameter({internalQueryParallelGroupConsumers: 4});
+setParameter({internalDocumentSourceGroupMaxMemoryBytes: 1});
+assert.eq(runGroup(pipelines[1], {allowDiskUse: true}), serialResults[1]);
+assert.commandFailedWithCode(
+    testDB.runCommand(
+        {aggregate: coll.getName(), pipeline: pipelines[1], cursor: {}, allowDiskUse: false}),
+    ErrorCodes.QueryExceededMemoryLimitNoDiskUseAllowed);
+setParameter({internalDocumentSourceGroupMaxMemoryBytes: 100 * 1024 * 1024});
+
+// Errors raised by a consumer are reported to the client.
+const badGroup = [{$group: {_id: "$k", bad: {$sum: {$divide: ["$x", 0]}}}}];
+assert.commandFailedWithCode(
+    testDB.runCommand({aggregate: coll.getName(), pipeline: badGroup, cursor: {}}), 16608);
+
+MongoRunner.stopMongod(conn);
+}());
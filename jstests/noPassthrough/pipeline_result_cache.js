@@ -0,0 +1,118 @@
+/**
+ * Tests that the pipeline result cache answers repeated identical aggregations, and that writes to
+ * any of the collections an aggregation reads from make its cached results stale.
+ *
+ * @tags: [requires_fcv_47]
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod(
+    {setParameter: {internalQueryPipelineResultCacheMaxSizeBytes: 16 * 1024 * 1024}});
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB(jsTestName());
+const coll = testDB.coll;
+const foreignColl = testDB.foreign;
+
+for (let i = 0; i < 100; ++i) {
+    assert.commandWorked(coll.insert({_id: i, k: i % 5, x: i}));
+}
+for (let k = 0; k < 5; ++k) {
+    assert.commandWorked(foreignColl.insert({_id: k, label: "k" + k}));
+}
+
+function getCacheMetrics() {
+    return testDB.serverStatus().metrics.query.pipelineResultCache;
+}
+
+// Runs the aggregation and asserts whether it was answered from the cache.
+function runAndCheck(pipeline, expectHit, options) {
+    const before = getCacheMetrics();
+    const results = coll.aggregate(pipeline, options || {}).toArray();
+    const after = getCacheMetrics();
+    assert.eq(after.hits - before.hits, expectHit ? 1 : 0, tojson(pipeline));
+    assert.eq(after.misses - before.misses, expectHit ? 0 : 1, tojson(pipeline));
+    return results;
+}
+
+const groupPipeline = [{$group: {_id: "$k", total: {$sum: "$x"}}}, {$sort: {_id: 1}}];
+const firstResults = runAndCheck(groupPipeline, false);
+assert.eq(firstResults.length, 5, tojson(firstResults));
+assert.eq(runAndCheck(groupPipeline, true), firstResults);
+assert.eq(runAndCheck(groupPipeline, true), firstResults);
+
+// A pipeline which optimizes differently, or a different collation, is a different entry.
+runAndCheck([{$match: {k: 0}}].concat(groupPipeline), false);
+runAndCheck(groupPipeline, false, {collation: {locale: "fr"}});
+runAndCheck(groupPipeline, true, {collation: {locale: "fr"}});
+
+// A write to the collection makes the results stale.
+assert.commandWorked(coll.update({_id: 0}, {$inc: {x: 1000}}));
+const updatedResults = runAndCheck(groupPipeline, false);
+assert.eq(updatedResults[0].total, firstResults[0].total + 1000, tojson(updatedResults));
+assert.eq(runAndCheck(groupPipeline, true), updatedResults);
+
+assert.commandWorked(coll.remove({_id: 1}));
+runAndCheck(groupPipeline, false);
+assert.commandWorked(coll.insert({_id: 1, k: 1, x: 1}));
+runAndCheck(groupPipeline, false);
+runAndCheck(groupPipeline, true);
+
+// A write to a collection joined by $lookup makes the results stale too.
+const lookupPipeline = [
+    {$match: {_id: {$lt: 10}}},
+    {$lookup: {from: foreignColl.getName(), localField: "k", foreignField: "_id", as: "f"}},
+    {$sort: {_id: 1}}
+];
+runAndCheck(lookupPipeline, false);
+runAndCheck(lookupPipeline, true);
+assert.commandWorked(foreignColl.update({_id: 0}, {$set: {label: "changed"}}));
+const lookupResults = runAndCheck(lookupPipeline, false);
+assert.eq(lookupResults[0].f, [{_id: 0, label: "changed"}], tojson(lookupResults));
+
+// Writes in a transaction only make the results stale once the transaction commits.
+const session = testDB.getMongo().startSession();
+const sessionColl = session.getDatabase(testDB.getName())[coll.getName()];
+runAndCheck(groupPipeline, true);
+session.startTransaction();
+assert.commandWorked(sessionColl.insert({_id: 1000, k: 0, x: 1}));
+assert.commandWorked(session.abortTransaction_forTesting());
+runAndCheck(groupPipeline, true);
+session.startTransaction();
+assert.commandWorked(sessionColl.insert({_id: 1000, k: 0, x: 1}));
+assert.commandWorked(session.commitTransaction_forTesting());
+runAndCheck(groupPipeline, false);
+
+// Dropping and recreating the collection never serves the results of the old collection.
+runAndCheck(groupPipeline, true);
+assert(coll.drop());
+assert.commandWorked(coll.insert({_id: 0, k: 0, x: 1}));
+assert.eq(runAndCheck(groupPipeline, false), [{_id: 0, total: 1}]);
+
+// Aggregations whose results depend on more than the data, or which write, are not cached.
+function assertNotCached(pipeline, options) {
+    const before = getCacheMetrics();
+    coll.aggregate(pipeline, options || {}).toArray();
+    coll.aggregate(pipeline, options || {}).toArray();
+    const after = getCacheMetrics();
+    assert.eq(after.hits, before.hits, tojson(pipeline));
+    assert.eq(after.misses, before.misses, tojson(pipeline));
+}
+assertNotCached([{$sample: {size: 1}}]);
+assertNotCached([{$project: {r: {$rand: {}}}}]);
+assertNotCached([{$addFields: {now: "$$NOW"}}]);
+assertNotCached([{$match: {x: {$gt: 0}}}, {$out: "out"}]);
+
+// Neither are results which do not fit in the first batch.
+const before = getCacheMetrics();
+coll.aggregate([{$match: {}}], {cursor: {batchSize: 0}}).toArray();
+coll.aggregate([{$match: {}}], {cursor: {batchSize: 0}}).toArray();
+assert.eq(getCacheMetrics().hits, before.hits);
+
+// The cache can be disabled at runtime.
+assert.commandWorked(
+    testDB.adminCommand({setParameter: 1, internalQueryPipelineResultCacheMaxSizeBytes: 0}));
+assertNotCached(groupPipeline);
+
+MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,85 @@
+/**
+ * Tests that executions of a cached plan are recorded in its plan cache entry, are reported by
+ * $planCacheStats, and can deactivate the entry once the plan's efficiency has degraded.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryCacheFeedbackMinExecutions: 3,
+        internalQueryCacheFeedbackHistorySize: 2,
+    }
+});
+assert.neq(null, conn, "mongod failed to start up");
+
+const testDb = conn.getDB("test");
+const coll = testDb.plan_cache_execution_feedback;
+coll.drop();
+
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < 1000; ++i) {
+    bulk.insert({a: i % 10, b: i % 7});
+}
+assert.commandWorked(bulk.execute());
+
+const query = {
+    a: 1,
+    b: 1
+};
+
+function getCacheEntry() {
+    const entries =
+        coll.aggregate([{$planCacheStats: {}}, {$match: {"createdFromQuery.query": query}}])
+            .toArray();
+    assert.eq(1, entries.length, entries);
+    return entries[0];
+}
+
+// The first run creates an inactive entry, and the second activates it. Neither ran a cached plan,
+// so no executions have been recorded yet.
+assert.eq(15, coll.find(query).itcount());
+assert.eq(15, coll.find(query).itcount());
+let entry = getCacheEntry();
+assert.eq(true, entry.isActive, entry);
+assert.eq(0, entry.executionFeedback.numExecutions, entry);
+assert.eq([], entry.executionFeedback.history, entry);
+assert.gt(entry.executionFeedback.decisionWorksPerResult, 0, entry);
+assert(!entry.executionFeedback.hasOwnProperty("worksPerResultEwma"), entry);
+
+// Runs of the cached plan are recorded, keeping only the most recent executions.
+for (let i = 0; i < 3; ++i) {
+    assert.eq(15, coll.find(query).itcount());
+}
+entry = getCacheEntry();
+assert.eq(true, entry.isActive, entry);
+assert.eq(3, entry.executionFeedback.numExecutions, entry);
+assert.eq(2, entry.executionFeedback.history.length, entry);
+for (let execution of entry.executionFeedback.history) {
+    assert.gt(execution.works, 0, execution);
+    assert.eq(15, execution.nReturned, execution);
+    assert(execution.time instanceof Date, execution);
+}
+assert.gt(entry.executionFeedback.worksPerResultEwma, 0, entry);
+
+// Make any observed efficiency look degraded. The entry is deactivated once the minimum number of
+// executions has been observed since it was cached.
+assert.commandWorked(
+    testDb.adminCommand({setParameter: 1, internalQueryCacheFeedbackDegradationRatio: 0.001}));
+coll.getPlanCache().clear();
+for (let i = 0; i < 2; ++i) {
+    assert.eq(15, coll.find(query).itcount());
+}
+assert.eq(true, getCacheEntry().isActive);
+for (let i = 0; i < 3; ++i) {
+    assert.eq(15, coll.find(query).itcount());
+}
+entry = getCacheEntry();
+assert.eq(false, entry.isActive, entry);
+assert.eq(3, entry.executionFeedback.numExecutions, entry);
+
+MongoRunner.stopMongod(conn);
+}());
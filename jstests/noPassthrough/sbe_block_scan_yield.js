@@ -0,0 +1,41 @@
+/**
+ * Tests that an SBE collection scan in block mode does not return records of its current block
+ * which were deleted or updated while the query was yielded.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: true,
+        internalQuerySlotBasedExecutionScanBlockSize: 100,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+const db = conn.getDB("test");
+const coll = db.sbe_block_scan_yield;
+coll.drop();
+
+const kNumDocs = 50;
+let docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i});
+}
+assert.commandWorked(coll.insert(docs));
+
+// The first batch is returned from the first block, which holds every document. The plan is saved
+// between the batches, so the getMore must read the rest of the collection again.
+const cursor = coll.find({a: {$gte: 0}}).batchSize(2);
+assert.eq(0, cursor.next()._id);
+assert.eq(1, cursor.next()._id);
+
+assert.commandWorked(coll.remove({_id: {$gte: 10}}));
+assert.commandWorked(coll.update({_id: 5}, {$set: {a: -1}}));
+assert.commandWorked(coll.update({_id: 6}, {$set: {b: 1}}));
+
+const rest = cursor.toArray();
+assert.eq([2, 3, 4, 6, 7, 8, 9], rest.map(doc => doc._id), tojson(rest));
+assert.eq({_id: 6, a: 6, b: 1}, rest[3]);
+
+MongoRunner.stopMongod(conn);
+})();
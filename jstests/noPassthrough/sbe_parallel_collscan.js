@@ -0,0 +1,68 @@
+/**
+ * Tests that collection scans split across multiple threads by the slot-based execution engine
+ * return the same results as a single-threaded scan.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: true,
+        internalQuerySlotBasedExecutionParallelScanMinCollectionSizeBytes: 0,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+const db = conn.getDB("test");
+const coll = db.sbe_parallel_collscan;
+coll.drop();
+
+// Insert enough documents for the parallel scan to split the collection into several ranges.
+const kNumDocs = 50 * 1000;
+let bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    bulk.insert({_id: i, a: i % 100, b: "str" + i});
+}
+assert.commandWorked(bulk.execute());
+
+function runQueries() {
+    return {
+        all: coll.find({}, {_id: 1}).toArray().map(doc => doc._id).sort((a, b) => a - b),
+        filtered: coll.find({a: {$lt: 10}}, {_id: 1}).toArray().map(doc => doc._id).sort(
+            (a, b) => a - b),
+        count: coll.find({a: 42}).itcount(),
+        grouped: coll.aggregate([{$match: {a: {$gte: 90}}}, {$group: {_id: "$a", n: {$sum: 1}}}])
+                     .toArray()
+                     .sort((x, y) => x._id - y._id),
+    };
+}
+
+function setDegree(degree) {
+    assert.commandWorked(db.adminCommand(
+        {setParameter: 1, internalQuerySlotBasedExecutionParallelScanDegree: degree}));
+}
+
+setDegree(1);
+const expected = runQueries();
+assert.eq(kNumDocs, expected.all.length);
+assert.eq(kNumDocs / 10, expected.filtered.length);
+assert.eq(kNumDocs / 100, expected.count);
+assert.eq(10, expected.grouped.length);
+
+for (let degree of [2, 4, 8]) {
+    setDegree(degree);
+    assert.eq(expected, runQueries(), "degree: " + degree);
+}
+
+// A scan hinted or sorted by {$natural: 1} must return the documents in their natural order, so it
+// is never split.
+setDegree(1);
+const naturalOrder = coll.find({}, {_id: 1}).hint({$natural: 1}).toArray();
+setDegree(4);
+assert.eq(naturalOrder, coll.find({}, {_id: 1}).hint({$natural: 1}).toArray());
+assert.eq(naturalOrder, coll.find({}, {_id: 1}).sort({$natural: 1}).toArray());
+
+// A scan which is not read to the end must shut down its producers cleanly.
+assert.eq(10, coll.find().limit(10).itcount());
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,86 @@
+/**
+ * Tests that the slot-based execution engine reuses parameterized plans for queries of the same
+ * shape, and that the reused plans are re-bound to the constants of each query.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: true,
+        internalQuerySlotBasedExecutionReuseCachedPlans: true,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+const db = conn.getDB("test");
+const coll = db.sbe_plan_cache_reuse;
+coll.drop();
+
+const kNumDocs = 1000;
+let docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i % 50, b: i % 7, c: i});
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+
+function getCounters() {
+    const metrics = assert.commandWorked(db.serverStatus()).metrics.query.sbePlanCache;
+    return {hits: metrics.hits, misses: metrics.misses};
+}
+
+function sortedIds(cursor) {
+    return cursor.toArray().map(doc => doc._id).sort((x, y) => x - y);
+}
+
+function expectedIds(predicate) {
+    return docs.filter(predicate).map(doc => doc._id);
+}
+
+// Run a query shape with several different constants. The first runs create and activate the plan
+// cache entry, the following runs are answered by plans cloned from the SBE plan cache.
+function runShape(makeQuery, makePredicate, constants) {
+    for (let round = 0; round < 3; ++round) {
+        for (let [x, y] of constants) {
+            assert.eq(expectedIds(makePredicate(x, y)),
+                      sortedIds(coll.find(makeQuery(x, y))),
+                      tojson(makeQuery(x, y)));
+        }
+    }
+}
+
+const before = getCounters();
+
+// A point query on one index with a residual filter.
+runShape((x, y) => ({a: x, b: y}),
+         (x, y) => (doc => doc.a === x && doc.b === y),
+         [[1, 1], [2, 2], [3, 3], [4, 4], [49, 0]]);
+
+// A range query, including constants for which the query matches nothing.
+runShape((x, y) => ({a: {$gte: x, $lt: x + 3}, b: {$gt: y}, c: {$lte: 900}}),
+         (x, y) => (doc => doc.a >= x && doc.a < x + 3 && doc.b > y && doc.c <= 900),
+         [[0, 5], [10, 3], [47, 0], [100, 0], [20, 7]]);
+
+// An $or which cannot use an index and is evaluated by the filter.
+runShape((x, y) => ({b: 3, $or: [{a: x}, {c: y}]}),
+         (x, y) => (doc => doc.b === 3 && (doc.a === x || doc.c === y)),
+         [[5, 10], [6, 24], [7, 999]]);
+
+const after = getCounters();
+assert.gt(after.hits, before.hits, tojson({before: before, after: after}));
+
+// Plans of different shapes are not mixed up, even when they use the same indexes.
+assert.eq(expectedIds(doc => doc.a === 1 && doc.b === 1).slice(0, 2),
+          sortedIds(coll.find({a: 1, b: 1}).sort({_id: 1}).limit(2)));
+assert.eq(expectedIds(doc => doc.a === 1 && doc.b === 1).length,
+          coll.find({a: 1, b: 1}, {_id: 0, a: 1}).itcount());
+
+// Dropping an index clears the cached plans, and the queries still return correct results.
+assert.commandWorked(coll.dropIndex({b: 1}));
+runShape((x, y) => ({a: x, b: y}),
+         (x, y) => (doc => doc.a === x && doc.b === y),
+         [[1, 1], [2, 2], [3, 3]]);
+
+MongoRunner.stopMongod(conn);
+})();
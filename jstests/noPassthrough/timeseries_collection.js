@@ -0,0 +1,142 @@
+/**
+ * Tests that a time-series collection, which stores its measurements grouped into buckets by their
+ * meta field and time, returns the same measurements as a regular collection, and that queries on
+ * the meta and time fields only unpack the buckets which may hold matching measurements.
+ *
+ * @tags: [requires_fcv_47]
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getAggPlanStage.
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+const testDB = conn.getDB(jsTestName());
+const coll = testDB.weather;
+const buckets = testDB.getCollection("system.buckets." + coll.getName());
+const regular = testDB.regular;
+
+assert.commandWorked(testDB.createCollection(coll.getName(),
+                                             {timeseries: {timeField: "time", metaField: "meta"}}));
+assert.commandWorked(testDB.createCollection(regular.getName()));
+
+const viewInfo = testDB.getCollectionInfos({name: coll.getName()})[0];
+assert.eq(viewInfo.type, "view", tojson(viewInfo));
+assert.eq(viewInfo.options.viewOn, buckets.getName(), tojson(viewInfo));
+const bucketsInfo = testDB.getCollectionInfos({name: buckets.getName()})[0];
+assert.eq(bucketsInfo.options.timeseries,
+          {timeField: "time", metaField: "meta", bucketMaxSpanSeconds: 3600},
+          tojson(bucketsInfo));
+
+// The measurements of 5 sensors over 10 minutes, along with measurements with other types of meta
+// values and without a meta value.
+const start = ISODate("2020-10-16T00:00:00Z");
+const docs = [];
+for (let i = 0; i < 1000; ++i) {
+    docs.push({
+        _id: i,
+        time: new Date(start.getTime() + i * 600),
+        meta: "sensor" + (i % 5),
+        value: i % 100,
+        extra: i % 7 ? undefined : {a: i}
+    });
+}
+docs.push({_id: 1000, time: start, meta: {building: 1, floor: 2}, value: 1});
+docs.push({_id: 1001, time: start, meta: NumberLong(3), value: 2});
+docs.push({_id: 1002, time: start, value: 3});
+for (let doc of docs) {
+    if (doc.extra === undefined) {
+        delete doc.extra;
+    }
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(regular.insert(docs));
+
+// The measurements of each sensor are in a single bucket.
+assert.eq(buckets.find().itcount(), 8);
+assert.eq(coll.find().itcount(), docs.length);
+
+// The fields of a measurement are not kept in order.
+function sortFields(doc) {
+    const sorted = {};
+    for (let field of Object.keys(doc).sort()) {
+        sorted[field] = doc[field];
+    }
+    return sorted;
+}
+
+function assertSameResults(query) {
+    assert.eq(coll.find(query).sort({_id: 1}).toArray().map(sortFields),
+              regular.find(query).sort({_id: 1}).toArray().map(sortFields),
+              tojson(query));
+}
+
+assertSameResults({});
+assertSameResults({meta: "sensor3"});
+assertSameResults({meta: {$in: ["sensor1", "sensor4"]}});
+assertSameResults({"meta.building": 1});
+assertSameResults({meta: 3});
+assertSameResults({meta: null});
+assertSameResults({time: {$gte: new Date(start.getTime() + 300 * 1000)}});
+assertSameResults({time: {$lt: new Date(start.getTime() + 1000)}, meta: "sensor2"});
+assertSameResults({time: new Date(start.getTime() + 6000)});
+assertSameResults({value: {$gt: 90}, "extra.a": {$exists: true}});
+assertSameResults({$or: [{meta: "sensor0"}, {value: 2}]});
+
+// Predicates on the meta and time fields only read the matching buckets.
+function getBucketsUnpacked(query) {
+    const explain = coll.explain("executionStats").aggregate([{$match: query}]);
+    const collScan = getAggPlanStage(explain, "COLLSCAN");
+    assert.neq(null, collScan, tojson(explain));
+    return collScan.nReturned;
+}
+
+assert.eq(getBucketsUnpacked({meta: "sensor3"}), 1);
+assert.eq(getBucketsUnpacked({meta: "sensor3", time: {$gte: start}}), 1);
+assert.eq(getBucketsUnpacked({time: {$lt: start}}), 0);
+assert.eq(getBucketsUnpacked({value: 1}), buckets.find().itcount());
+
+// Buckets are closed when they are full, or when a measurement is outside of their time span.
+assert.commandWorked(testDB.adminCommand({setParameter: 1, timeseriesBucketMaxCount: 10}));
+const more = [];
+for (let i = 0; i < 100; ++i) {
+    more.push({_id: 2000 + i, time: new Date(start.getTime() + i), meta: "full", value: i});
+}
+more.push({_id: 3000, time: new Date(start.getTime() + 2 * 3600 * 1000), meta: "full", value: 0});
+assert.commandWorked(coll.insert(more));
+assert.commandWorked(regular.insert(more));
+assert.eq(buckets.find({meta: "full"}).itcount(), 11);
+assertSameResults({meta: "full"});
+assert.commandWorked(testDB.adminCommand({setParameter: 1, timeseriesBucketMaxCount: 1000}));
+
+// Measurements without a date in the time field are rejected, and the others are inserted.
+let res = coll.insert([{_id: 4000, time: start, meta: "bad"}, {_id: 4001, meta: "bad"}],
+                      {ordered: false});
+assert.eq(res.nInserted, 1, tojson(res));
+assert.eq(res.getWriteErrors()[0].code, 5095431, tojson(res));
+assert.commandFailedWithCode(coll.insert({_id: 4002, time: 1, meta: "bad"}), 5095431);
+assert.commandFailedWithCode(coll.insert({_id: 4003, time: start, "a.b": 1}), 5095432);
+assert.eq(coll.find({meta: "bad"}).itcount(), 1);
+
+// Invalid options are rejected.
+function assertCreateFails(options, code) {
+    assert.commandFailedWithCode(testDB.createCollection("bad", options), code);
+    assert.eq(testDB.getCollectionInfos({name: "bad"}), []);
+    assert.eq(testDB.getCollectionInfos({name: "system.buckets.bad"}), []);
+}
+assertCreateFails({timeseries: {timeField: "t", metaField: "t"}}, 5095433);
+assertCreateFails({timeseries: {timeField: "a.b"}}, 5095433);
+assertCreateFails({timeseries: {timeField: "t", bucketMaxSpanSeconds: 0}}, 51024);
+assertCreateFails({timeseries: {metaField: "m"}}, 40414);
+assertCreateFails({timeseries: {timeField: "t"}, capped: true, size: 1024}, ErrorCodes.BadValue);
+assert.commandFailedWithCode(testDB.createCollection(coll.getName(), {timeseries: {timeField: "t"}}),
+                             ErrorCodes.NamespaceExists);
+
+// Dropping the collection drops its buckets.
+assert(coll.drop());
+assert.eq(testDB.getCollectionInfos({name: coll.getName()}), []);
+assert.eq(testDB.getCollectionInfos({name: buckets.getName()}), []);
+
+MongoRunner.stopMongod(conn);
+}());
@@ -1,5 +1,7 @@
 /**
- * Tests that the $limit stage is pushed before $lookup stages, except when there is an $unwind.
+ * Tests that the $limit stage, and a $sort bounded by a $limit, are pushed before $lookup stages,
+ * and that a copy of them is pushed before a $lookup which absorbed an $unwind preserving null and
+ * empty arrays.
  */
 (function() {
 "use strict";
@@ -77,4 +79,57 @@ pipeline = [
 ];
 checkResults(pipeline, false, ["COLLSCAN", "$lookup", "$unwind", "$sort", "$limit"]);
 checkResults(pipeline, true, ["COLLSCAN", "$lookup", "$sort"]);
+
+// Checks that the pipeline returns the same documents whether it is optimized or not.
+function checkSameResults(pipeline) {
+    assert.commandWorked(db.adminCommand(
+        {"configureFailPoint": 'disablePipelineOptimization', "mode": 'alwaysOn'}));
+    const unoptimized = coll.aggregate(pipeline).toArray();
+    assert.commandWorked(
+        db.adminCommand({"configureFailPoint": 'disablePipelineOptimization', "mode": 'off'}));
+    const optimized = coll.aggregate(pipeline).toArray();
+    assert.sameMembers(optimized, unoptimized);
+}
+
+// Check that lookup->sort->limit is reordered to sort->lookup, with the limit stage being absorbed
+// into the sort stage and both being pushed down to the query system.
+pipeline = [
+    {$lookup: {from: other.getName(), localField: "x", foreignField: "x", as: "from_other"}},
+    {$sort: {x: -1}},
+    {$limit: 5}
+];
+checkResults(pipeline, false, ["COLLSCAN", "$lookup", "$sort", "$limit"]);
+checkResults(pipeline, true, ["SORT", "$lookup"]);
+checkSameResults(pipeline);
+
+// Check that a sort on the field which the lookup sets is not moved.
+pipeline = [
+    {$lookup: {from: other.getName(), localField: "x", foreignField: "x", as: "from_other"}},
+    {$sort: {"from_other.y": 1}},
+    {$limit: 5}
+];
+checkResults(pipeline, true, ["COLLSCAN", "$lookup", "$sort"]);
+
+// Check that lookup->unwind->sort->limit gets a copy of the sort and limit ahead of the lookup when
+// the unwind preserves null and empty arrays, since every input document then produces at least
+// one output document. Each value of 'x' joins two documents, so the limit doesn't split a tie.
+pipeline = [
+    {$lookup: {from: other.getName(), localField: "x", foreignField: "x", as: "from_other"}},
+    {$unwind: {path: "$from_other", preserveNullAndEmptyArrays: true}},
+    {$sort: {x: -1}},
+    {$limit: 6}
+];
+checkResults(pipeline, false, ["COLLSCAN", "$lookup", "$unwind", "$sort", "$limit"]);
+checkResults(pipeline, true, ["SORT", "$lookup", "$sort"]);
+checkSameResults(pipeline);
+
+// The same applies to a limit without a sort.
+pipeline = [
+    {$lookup: {from: other.getName(), localField: "x", foreignField: "x", as: "from_other"}},
+    {$unwind: {path: "$from_other", preserveNullAndEmptyArrays: true}},
+    {$limit: 5}
+];
+checkResults(pipeline, false, ["COLLSCAN", "$lookup", "$unwind", "$limit"]);
+checkResults(pipeline, true, ["LIMIT", "$lookup", "$limit"]);
+assert.eq(coll.aggregate(pipeline).itcount(), 5);
 }());
@@ -0,0 +1,58 @@
+/**
+ * Tests that the statistics a secondary costs plans with follow the writes to the statistics
+ * collection replicated from the primary, rather than staying as they were when first cached.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");
+
+const rst = new ReplSetTest({
+    nodes: [{}, {rsConfig: {priority: 0}}],
+    nodeOptions: {setParameter: {internalQueryPlannerEnableCostBasedRanking: true}},
+});
+rst.startSet();
+rst.initiate();
+
+const primaryDB = rst.getPrimary().getDB("test");
+const secondary = rst.getSecondary();
+secondary.setSecondaryOk();
+const secondaryColl = secondary.getDB("test").cost_based_ranking_secondary;
+const primaryColl = primaryDB.cost_based_ranking_secondary;
+
+// 'a' is unique, while 'b' is 0 in all but 10 documents.
+const kNumDocs = 1000;
+let docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i, b: i < 990 ? 0 : 1});
+}
+assert.commandWorked(primaryColl.insert(docs));
+assert.commandWorked(primaryColl.createIndex({a: 1}));
+assert.commandWorked(primaryColl.createIndex({b: 1}));
+rst.awaitReplication();
+
+const query = {
+    a: 5,
+    b: 0
+};
+
+// Without statistics, the secondary races both index scans. Running the query caches the plan and
+// the absence of statistics.
+let explain = secondaryColl.find(query).explain();
+assert.gt(getRejectedPlans(explain).length, 0, explain);
+for (let i = 0; i < 3; ++i) {
+    assert.eq(1, secondaryColl.find(query).itcount());
+}
+
+// The statistics gathered on the primary are used by the secondary once replicated.
+assert.commandWorked(primaryDB.runCommand({analyze: primaryColl.getName()}));
+rst.awaitReplication();
+explain = secondaryColl.find(query).explain();
+assert.eq(0, getRejectedPlans(explain).length, explain);
+const ixscan = getPlanStage(explain.queryPlanner.winningPlan, "IXSCAN");
+assert.eq({a: 1}, ixscan.keyPattern, explain);
+assert.lte(ixscan.estimatedCardinality, 2, explain);
+assert.eq([{_id: 5, a: 5, b: 0}], secondaryColl.find(query).toArray());
+
+rst.stopSet();
+}());
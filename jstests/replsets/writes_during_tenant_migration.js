@@ -441,6 +441,7 @@ const testCases = {
             assert(!collectionExists(db, collName + "Out"));
         }
     },
+    analyze: {skip: isNotWriteCommand},
     appendOplogNote: {skip: isNotRunOnUserDatabase},
     applyOps: {
         explicitlyCreateCollection: true,
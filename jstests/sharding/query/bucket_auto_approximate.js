@@ -0,0 +1,82 @@
+/**
+ * Tests that an approximate $bucketAuto is split across shards, with each shard summarizing its
+ * own documents and the merging half of the pipeline computing the bucket boundaries.
+ *
+ * @tags: [requires_fcv_47]
+ */
+(function() {
+'use strict';
+
+const st = new ShardingTest({shards: 2, mongos: 1});
+
+const dbName = jsTestName();
+const testDB = st.s0.getDB(dbName);
+const coll = testDB.coll;
+
+assert.commandWorked(st.s0.adminCommand({enableSharding: dbName}));
+st.ensurePrimaryShard(dbName, st.shard0.shardName);
+assert.commandWorked(st.s0.adminCommand({shardCollection: coll.getFullName(), key: {_id: 1}}));
+assert.commandWorked(st.s0.adminCommand({split: coll.getFullName(), middle: {_id: 1000}}));
+assert.commandWorked(st.s0.adminCommand(
+    {moveChunk: coll.getFullName(), find: {_id: 1000}, to: st.shard1.shardName}));
+
+// The 'x' values of the documents on each shard span the whole range, so that the shards'
+// summaries overlap.
+const numDocs = 2000;
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < numDocs; ++i) {
+    bulk.insert({_id: i, x: (i * 7) % numDocs});
+}
+assert.commandWorked(bulk.execute());
+
+const numBuckets = 5;
+const pipeline = [{
+    $bucketAuto: {
+        groupBy: "$x",
+        buckets: numBuckets,
+        approximate: true,
+        output: {count: {$sum: 1}, total: {$sum: "$x"}}
+    }
+}];
+
+// The shards part summarizes the input, and the merger part computes the buckets.
+const explain = coll.explain().aggregate(pipeline);
+assert(explain.hasOwnProperty("splitPipeline"), tojson(explain));
+assert.eq(explain.splitPipeline.shardsPart.length, 1, tojson(explain));
+assert(explain.splitPipeline.shardsPart[0].$bucketAuto.approximate, tojson(explain));
+const mergingStages =
+    explain.splitPipeline.mergerPart.filter(stage => stage.hasOwnProperty("$bucketAuto"));
+assert.eq(mergingStages.length, 1, tojson(explain));
+assert(mergingStages[0].$bucketAuto.$doingMerge, tojson(explain));
+
+const results = coll.aggregate(pipeline).toArray();
+assert.eq(results.length, numBuckets, tojson(results));
+assert.eq(results[0]._id.min, 0, tojson(results));
+assert.eq(results[numBuckets - 1]._id.max, numDocs - 1, tojson(results));
+
+let totalCount = 0;
+let totalSum = 0;
+for (let i = 0; i < results.length; ++i) {
+    const bucket = results[i];
+    assert.lte(Math.abs(bucket.count - numDocs / numBuckets), numDocs / numBuckets / 8,
+               tojson(results));
+    if (i + 1 < results.length) {
+        assert.eq(bucket._id.max, results[i + 1]._id.min, tojson(results));
+    }
+    totalCount += bucket.count;
+    totalSum += bucket.total;
+}
+assert.eq(totalCount, numDocs, tojson(results));
+assert.eq(totalSum, numDocs * (numDocs - 1) / 2, tojson(results));
+
+// 'granularity' rounds each boundary based on the exact values in the buckets, so it can't be
+// combined with 'approximate'.
+assert.commandFailedWithCode(testDB.runCommand({
+    aggregate: coll.getName(),
+    pipeline: [{$bucketAuto: {groupBy: "$x", buckets: 2, approximate: true, granularity: "R5"}}],
+    cursor: {}
+}),
+                             5095416);
+
+st.stop();
+})();
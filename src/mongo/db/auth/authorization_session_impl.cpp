@@ -436,6 +436,24 @@ Status AuthorizationSessionImpl::checkAuthForCreate(const NamespaceString& ns,
         return checkAuthForCreateOrModifyView(this, ns, viewOnNs, pipeline, isMongos);
     }
 
+    // A materialized view is filled from its source collection, so creating one requires being
+    // able to read the source.
+    if (auto materializedView = cmdObj["materializedView"]) {
+        if (!hasCreateCollectionAction) {
+            return Status(ErrorCodes::Unauthorized, "unauthorized");
+        }
+
+        if (materializedView.type() == Object) {
+            auto source = materializedView.Obj()["source"];
+            if (source.type() == String &&
+                !isAuthorizedForActionsOnNamespace(
+                    NamespaceString(ns.db(), source.valueStringData()), ActionType::find)) {
+                return Status(ErrorCodes::Unauthorized, "unauthorized");
+            }
+        }
+        return Status::OK();
+    }
+
     // To create a regular collection, ActionType::createCollection or ActionType::insert are
     // both acceptable.
     if (hasCreateCollectionAction || isAuthorizedForActionsOnNamespace(ns, ActionType::insert)) {
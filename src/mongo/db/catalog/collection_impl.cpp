@@ -346,6 +346,11 @@ bool CollectionImpl::requiresIdIndex() const {
         return false;
     }
 
+    if (isClustered()) {
+        // The record store of a clustered collection is keyed by _id.
+        return false;
+    }
+
     if (_ns.isSystem()) {
         StringData shortName = _ns.coll().substr(_ns.coll().find('.') + 1);
         if (shortName == "indexes" || shortName == "namespaces" || shortName == "profile") {
@@ -497,6 +502,7 @@ Status CollectionImpl::insertDocumentsForOplog(OperationContext* opCtx,
 
     opCtx->recoveryUnit()->onCommit(
         [this](boost::optional<Timestamp>) { notifyCappedWaitersIfNeeded(); });
+    CollectionQueryInfo::get(this).notifyOfWrite(opCtx);
 
     return status;
 }
@@ -542,6 +548,7 @@ Status CollectionImpl::insertDocuments(OperationContext* opCtx,
 
     opCtx->recoveryUnit()->onCommit(
         [this](boost::optional<Timestamp>) { notifyCappedWaitersIfNeeded(); });
+    CollectionQueryInfo::get(this).notifyOfWrite(opCtx);
 
     hangAfterCollectionInserts.executeIf(
         [&](const BSONObj& data) {
@@ -628,6 +635,7 @@ Status CollectionImpl::insertDocumentForBulkLoader(
 
     opCtx->recoveryUnit()->onCommit(
         [this](boost::optional<Timestamp>) { notifyCappedWaitersIfNeeded(); });
+    CollectionQueryInfo::get(this).notifyOfWrite(opCtx);
 
     return loc.getStatus();
 }
@@ -764,6 +772,7 @@ void CollectionImpl::deleteDocument(OperationContext* opCtx,
 
     getGlobalServiceContext()->getOpObserver()->onDelete(
         opCtx, ns(), uuid(), stmtId, fromMigrate, deletedDoc);
+    CollectionQueryInfo::get(this).notifyOfWrite(opCtx);
 
     if (opDebug) {
         opDebug->additiveMetrics.incrementKeysDeleted(keysDeleted);
@@ -855,6 +864,7 @@ RecordId CollectionImpl::updateDocument(OperationContext* opCtx,
 
     OplogUpdateEntryArgs entryArgs(*args, ns(), _uuid);
     getGlobalServiceContext()->getOpObserver()->onUpdate(opCtx, entryArgs);
+    CollectionQueryInfo::get(this).notifyOfWrite(opCtx);
 
     return {oldLocation};
 }
@@ -892,6 +902,7 @@ StatusWith<RecordData> CollectionImpl::updateDocumentWithDamages(
         args->preImageRecordingEnabledForCollection = getRecordPreImages();
         OplogUpdateEntryArgs entryArgs(*args, ns(), _uuid);
         getGlobalServiceContext()->getOpObserver()->onUpdate(opCtx, entryArgs);
+        CollectionQueryInfo::get(this).notifyOfWrite(opCtx);
     }
     return newRecStatus;
 }
@@ -916,6 +927,10 @@ bool CollectionImpl::isCapped() const {
     return _cappedNotifier.get();
 }
 
+bool CollectionImpl::isClustered() const {
+    return _recordStore && _recordStore->keyFormat() == KeyFormat::String;
+}
+
 CappedCallback* CollectionImpl::getCappedCallback() {
     return this;
 }
@@ -1016,6 +1031,7 @@ Status CollectionImpl::truncate(OperationContext* opCtx) {
     auto status = _recordStore->truncate(opCtx);
     if (!status.isOK())
         return status;
+    CollectionQueryInfo::get(this).notifyOfWrite(opCtx);
 
     // 4) re-create indexes
     for (size_t i = 0; i < indexSpecs.size(); i++) {
@@ -1035,6 +1051,7 @@ void CollectionImpl::cappedTruncateAfter(OperationContext* opCtx,
     invariant(_indexCatalog->numIndexesInProgress(opCtx) == 0);
 
     _recordStore->cappedTruncateAfter(opCtx, end, inclusive);
+    CollectionQueryInfo::get(this).notifyOfWrite(opCtx);
 }
 
 void CollectionImpl::setValidator(OperationContext* opCtx, Validator validator) {
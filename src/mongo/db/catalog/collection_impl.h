@@ -283,6 +283,8 @@ public:
 
     bool isCapped() const final;
 
+    bool isClustered() const final;
+
     CappedCallback* getCappedCallback() final;
     const CappedCallback* getCappedCallback() const final;
 
@@ -223,6 +223,10 @@ public:
         std::abort();
     }
 
+    bool isClustered() const {
+        return false;
+    }
+
     CappedCallback* getCappedCallback() {
         std::abort();
     }
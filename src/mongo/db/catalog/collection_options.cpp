@@ -170,6 +170,8 @@ StatusWith<CollectionOptions> CollectionOptions::parse(const BSONObj& options, P
             collectionOptions.temp = e.trueValue();
         } else if (fieldName == "recordPreImages") {
             collectionOptions.recordPreImages = e.trueValue();
+        } else if (fieldName == "clusteredIndex") {
+            collectionOptions.clusteredIndex = e.trueValue();
         } else if (fieldName == "storageEngine") {
             Status status = checkStorageEngineOptions(e);
             if (!status.isOK()) {
@@ -237,6 +239,18 @@ StatusWith<CollectionOptions> CollectionOptions::parse(const BSONObj& options, P
             }
 
             collectionOptions.pipeline = e.Obj().getOwned();
+        } else if (fieldName == "materializedView") {
+            if (e.type() != mongo::Object) {
+                return Status(ErrorCodes::BadValue, "'materializedView' has to be a document.");
+            }
+
+            collectionOptions.materializedView = e.Obj().getOwned();
+        } else if (fieldName == "timeseries") {
+            if (e.type() != mongo::Object) {
+                return Status(ErrorCodes::BadValue, "'timeseries' has to be a document.");
+            }
+
+            collectionOptions.timeseries = e.Obj().getOwned();
         } else if (fieldName == "idIndex" && kind == parseForCommand) {
             if (e.type() != mongo::Object) {
                 return Status(ErrorCodes::TypeMismatch, "'idIndex' has to be an object.");
@@ -260,6 +274,39 @@ StatusWith<CollectionOptions> CollectionOptions::parse(const BSONObj& options, P
         return Status(ErrorCodes::BadValue, "'pipeline' cannot be specified without 'viewOn'");
     }
 
+    // The documents of a materialized view are maintained from the simple collation grouping of
+    // the source documents.
+    if (!collectionOptions.materializedView.isEmpty() &&
+        (collectionOptions.isView() || collectionOptions.capped ||
+         !collectionOptions.collation.isEmpty())) {
+        return Status(ErrorCodes::BadValue,
+                      "'materializedView' cannot be combined with 'viewOn', 'capped' or "
+                      "'collation'");
+    }
+
+    // A clustered collection is ordered by the binary comparison of its _id values, and its
+    // documents cannot be moved around as a capped collection or a materialized view requires.
+    if (collectionOptions.clusteredIndex &&
+        (collectionOptions.isView() || collectionOptions.capped ||
+         !collectionOptions.collation.isEmpty() || !collectionOptions.idIndex.isEmpty() ||
+         !collectionOptions.materializedView.isEmpty() ||
+         collectionOptions.autoIndexId == CollectionOptions::NO)) {
+        return Status(ErrorCodes::BadValue,
+                      "'clusteredIndex' cannot be combined with 'viewOn', 'capped', 'collation', "
+                      "'idIndex', 'materializedView' or 'autoIndexId: false'");
+    }
+
+    // The buckets of a time-series collection are grouped by the binary value of the meta field of
+    // their measurements, and are only written by the bucket catalog.
+    if (!collectionOptions.timeseries.isEmpty() &&
+        (collectionOptions.isView() || collectionOptions.capped ||
+         !collectionOptions.collation.isEmpty() || !collectionOptions.materializedView.isEmpty() ||
+         collectionOptions.clusteredIndex)) {
+        return Status(ErrorCodes::BadValue,
+                      "'timeseries' cannot be combined with 'viewOn', 'capped', 'collation', "
+                      "'materializedView' or 'clusteredIndex'");
+    }
+
     return collectionOptions;
 }
 
@@ -292,6 +339,10 @@ void CollectionOptions::appendBSON(BSONObjBuilder* builder) const {
         builder->appendBool("recordPreImages", true);
     }
 
+    if (clusteredIndex) {
+        builder->appendBool("clusteredIndex", true);
+    }
+
     if (!storageEngine.isEmpty()) {
         builder->append("storageEngine", storageEngine);
     }
@@ -324,6 +375,14 @@ void CollectionOptions::appendBSON(BSONObjBuilder* builder) const {
         builder->appendArray("pipeline", pipeline);
     }
 
+    if (!materializedView.isEmpty()) {
+        builder->append("materializedView", materializedView);
+    }
+
+    if (!timeseries.isEmpty()) {
+        builder->append("timeseries", timeseries);
+    }
+
     if (!idIndex.isEmpty()) {
         builder->append("idIndex", idIndex);
     }
@@ -351,6 +410,10 @@ bool CollectionOptions::matchesStorageOptions(const CollectionOptions& other,
         return false;
     }
 
+    if (clusteredIndex != other.clusteredIndex) {
+        return false;
+    }
+
     if (temp != other.temp) {
         return false;
     }
@@ -395,6 +458,14 @@ bool CollectionOptions::matchesStorageOptions(const CollectionOptions& other,
         return false;
     }
 
+    if (materializedView.woCompare(other.materializedView) != 0) {
+        return false;
+    }
+
+    if (timeseries.woCompare(other.timeseries) != 0) {
+        return false;
+    }
+
     return true;
 }
 }  // namespace mongo
@@ -121,6 +121,10 @@ struct CollectionOptions {
     bool temp = false;
     bool recordPreImages = false;
 
+    // Whether the documents of this collection are stored keyed by their _id, in which case the
+    // collection has no separate _id index.
+    bool clusteredIndex = false;
+
     // Storage engine collection options. Always owned or empty.
     BSONObj storageEngine;
 
@@ -144,5 +148,15 @@ struct CollectionOptions {
     std::string viewOn;
     // The aggregation pipeline that defines this view.
     BSONObj pipeline;
+
+    // The definition of the materialized view stored in this collection, of the form
+    // {source: <collection name>, pipeline: [...]}, or empty if this collection is not a
+    // materialized view. Always owned or empty.
+    BSONObj materializedView;
+
+    // The options of the time-series collection whose buckets are stored in this collection, of the
+    // form {timeField: <string>, metaField: <string>, bucketMaxSpanSeconds: <number>}, or empty if
+    // this collection does not hold buckets. Always owned or empty.
+    BSONObj timeseries;
 };
 }  // namespace mongo
@@ -318,6 +318,73 @@ TEST(CollectionOptions, ParseUUID) {
     ASSERT_OK(options.validateForStorage());
 }
 
+TEST(CollectionOptions, MaterializedView) {
+    const auto group = BSON("$group" << BSON("_id"
+                                             << "$cust"
+                                             << "n" << BSON("$sum" << 1)));
+    const auto definition = BSON("source"
+                                 << "orders"
+                                 << "pipeline" << BSON_ARRAY(group));
+
+    auto options = assertGet(CollectionOptions::parse(BSON("materializedView" << definition)));
+    ASSERT_BSONOBJ_EQ(options.materializedView, definition);
+    ASSERT_FALSE(options.isView());
+    ASSERT_BSONOBJ_EQ(options.toBSON(), BSON("materializedView" << definition));
+
+    ASSERT_NOT_OK(CollectionOptions::parse(BSON("materializedView" << 1)).getStatus());
+    ASSERT_NOT_OK(CollectionOptions::parse(BSON("materializedView" << definition << "viewOn"
+                                                                   << "orders"))
+                      .getStatus());
+    ASSERT_NOT_OK(CollectionOptions::parse(BSON("materializedView" << definition << "capped"
+                                                                   << true << "size" << 1024))
+                      .getStatus());
+    ASSERT_NOT_OK(CollectionOptions::parse(BSON("materializedView" << definition << "collation"
+                                                                   << BSON("locale"
+                                                                           << "fr")))
+                      .getStatus());
+}
+
+TEST(CollectionOptions, ClusteredIndex) {
+    auto options = assertGet(CollectionOptions::parse(fromjson("{clusteredIndex: true}")));
+    ASSERT_TRUE(options.clusteredIndex);
+    ASSERT_BSONOBJ_EQ(options.toBSON(), fromjson("{clusteredIndex: true}"));
+    ASSERT_FALSE(options.matchesStorageOptions(CollectionOptions(), nullptr));
+
+    options = assertGet(CollectionOptions::parse(fromjson("{clusteredIndex: false}")));
+    ASSERT_FALSE(options.clusteredIndex);
+    ASSERT_BSONOBJ_EQ(options.toBSON(), BSONObj());
+
+    ASSERT_NOT_OK(
+        CollectionOptions::parse(fromjson("{clusteredIndex: true, capped: true, size: 1024}"))
+            .getStatus());
+    ASSERT_NOT_OK(
+        CollectionOptions::parse(fromjson("{clusteredIndex: true, viewOn: 'c', pipeline: []}"))
+            .getStatus());
+    ASSERT_NOT_OK(
+        CollectionOptions::parse(fromjson("{clusteredIndex: true, collation: {locale: 'fr'}}"))
+            .getStatus());
+    ASSERT_NOT_OK(CollectionOptions::parse(fromjson("{clusteredIndex: true, autoIndexId: false}"))
+                      .getStatus());
+}
+
+TEST(CollectionOptions, Timeseries) {
+    auto options = assertGet(CollectionOptions::parse(fromjson("{timeseries: {timeField: 't'}}")));
+    ASSERT_BSONOBJ_EQ(options.timeseries, fromjson("{timeField: 't'}"));
+    ASSERT_BSONOBJ_EQ(options.toBSON(), fromjson("{timeseries: {timeField: 't'}}"));
+    ASSERT_FALSE(options.matchesStorageOptions(CollectionOptions(), nullptr));
+
+    ASSERT_NOT_OK(CollectionOptions::parse(fromjson("{timeseries: 't'}")).getStatus());
+    ASSERT_NOT_OK(CollectionOptions::parse(
+                      fromjson("{timeseries: {timeField: 't'}, capped: true, size: 1024}"))
+                      .getStatus());
+    ASSERT_NOT_OK(
+        CollectionOptions::parse(fromjson("{timeseries: {timeField: 't'}, clusteredIndex: true}"))
+            .getStatus());
+    ASSERT_NOT_OK(CollectionOptions::parse(
+                      fromjson("{timeseries: {timeField: 't'}, collation: {locale: 'fr'}}"))
+                      .getStatus());
+}
+
 TEST(CollectionOptions, SizeNumberLimits) {
     CollectionOptions options = assertGet(CollectionOptions::parse(fromjson("{size: 'a'}")));
     ASSERT_EQ(options.cappedSize, 0);
@@ -47,6 +47,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/ops/insert.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/timeseries/timeseries_gen.h"
 #include "mongo/db/views/view_catalog.h"
 #include "mongo/logv2/log.h"
 
@@ -109,13 +110,48 @@ Status _createView(OperationContext* opCtx,
     });
 }
 
+/**
+ * Returns the source collection of the materialized view which 'collectionOptions' define for
+ * 'nss', if any. The rest of the definition is validated when the view is filled.
+ */
+boost::optional<NamespaceString> getMaterializedViewSource(
+    const NamespaceString& nss, const CollectionOptions& collectionOptions) {
+    auto source = collectionOptions.materializedView["source"];
+    if (collectionOptions.temp || source.type() != String) {
+        return boost::none;
+    }
+
+    NamespaceString sourceNss(nss.db(), source.valueStringData());
+    if (!sourceNss.isValid() || sourceNss == nss) {
+        return boost::none;
+    }
+    return sourceNss;
+}
+
 Status _createCollection(OperationContext* opCtx,
                          const NamespaceString& nss,
                          const CollectionOptions& collectionOptions,
                          const BSONObj& idIndex) {
     return writeConflictRetry(opCtx, "create", nss.ns(), [&] {
         AutoGetOrCreateDb autoDb(opCtx, nss.db(), MODE_IX);
-        Lock::CollectionLock collLock(opCtx, nss, MODE_IX);
+
+        // A materialized view is filled from its source as part of its creation, and is maintained
+        // from the writes to the source once the creation commits. The writes to the source are
+        // excluded from before the snapshot of the creation is opened until it commits, so that
+        // each of them is either read when filling the view or applied to it. To prevent deadlock,
+        // the collections are locked in ascending resourceId order.
+        boost::optional<Lock::CollectionLock> collLock;
+        boost::optional<Lock::CollectionLock> sourceLock;
+        const auto source = getMaterializedViewSource(nss, collectionOptions);
+        if (source &&
+            ResourceId(RESOURCE_COLLECTION, source->ns()) <
+                ResourceId(RESOURCE_COLLECTION, nss.ns())) {
+            sourceLock.emplace(opCtx, *source, MODE_S);
+        }
+        collLock.emplace(opCtx, nss, MODE_IX);
+        if (source && !sourceLock) {
+            sourceLock.emplace(opCtx, *source, MODE_S);
+        }
         // This is a top-level handler for collection creation name conflicts. New commands coming
         // in, or commands that generated a WriteConflict must return a NamespaceExists error here
         // on conflict.
@@ -159,6 +195,52 @@ Status _createCollection(OperationContext* opCtx,
     });
 }
 
+/**
+ * Creates the time-series collection 'nss', which is a view of the collection holding its buckets,
+ * system.buckets.<collection>. The view unpacks the measurements out of the buckets.
+ */
+Status _createTimeseries(OperationContext* opCtx,
+                         const NamespaceString& nss,
+                         const CollectionOptions& collectionOptions) {
+    auto options =
+        TimeseriesOptions::parse(IDLParserErrorContext("timeseries"), collectionOptions.timeseries);
+    auto isTopLevelField = [](StringData field) {
+        return !field.empty() && field.find('.') == std::string::npos && field[0] != '$';
+    };
+    uassert(5095433,
+            str::stream() << "The time and meta fields of a time-series collection must be "
+                             "distinct top-level field names: "
+                          << collectionOptions.timeseries,
+            isTopLevelField(options.getTimeField()) &&
+                (!options.getMetaField() ||
+                 (isTopLevelField(*options.getMetaField()) &&
+                  *options.getMetaField() != options.getTimeField())));
+
+    const auto bucketsNss = nss.makeTimeseriesBucketsNamespace();
+    {
+        AutoGetDb autoDb(opCtx, nss.db(), MODE_IS);
+        if (CollectionCatalog::get(opCtx).lookupCollectionByNamespace(opCtx, nss) ||
+            (autoDb.getDb() && ViewCatalog::get(autoDb.getDb())->lookup(opCtx, nss.ns()))) {
+            return Status(ErrorCodes::NamespaceExists,
+                          str::stream() << "A collection or view already exists. NS: " << nss);
+        }
+    }
+
+    // The buckets collection keeps the options with their defaults filled in, so that the bucket
+    // catalog and the view read the same bucket span.
+    CollectionOptions bucketsOptions = collectionOptions;
+    bucketsOptions.timeseries = options.toBSON();
+    auto status = _createCollection(opCtx, bucketsNss, bucketsOptions, BSONObj());
+    if (!status.isOK()) {
+        return status;
+    }
+
+    CollectionOptions viewOptions;
+    viewOptions.viewOn = bucketsNss.coll().toString();
+    viewOptions.pipeline = BSON_ARRAY(BSON("$_internalUnpackBucket" << bucketsOptions.timeseries));
+    return _createView(opCtx, nss, viewOptions, BSONObj());
+}
+
 /**
  * Shared part of the implementation of the createCollection versions for replicated and regular
  * collection creation.
@@ -205,7 +287,14 @@ Status createCollection(OperationContext* opCtx,
         collectionOptions = statusWith.getValue();
     }
 
-    if (collectionOptions.isView()) {
+    // The creation of the buckets collection of a time-series collection is replicated on its own.
+    if (!collectionOptions.timeseries.isEmpty() && !nss.isTimeseriesBucketsCollection()) {
+        uassert(ErrorCodes::OperationNotSupportedInTransaction,
+                str::stream() << "Cannot create a time-series collection in a multi-document "
+                                 "transaction.",
+                !opCtx->inMultiDocumentTransaction());
+        return _createTimeseries(opCtx, nss, collectionOptions);
+    } else if (collectionOptions.isView()) {
         uassert(ErrorCodes::OperationNotSupportedInTransaction,
                 str::stream() << "Cannot create a view in a multi-document "
                                  "transaction.",
@@ -292,8 +292,12 @@ Status dropCollection(OperationContext* opCtx,
     }
 
     try {
+        // Set once the view of a time-series collection is dropped, so that only its buckets are
+        // left to drop if the drop is retried.
+        bool isTimeseries = false;
         return writeConflictRetry(opCtx, "drop", collectionName.ns(), [&] {
-            {
+            const auto bucketsNss = collectionName.makeTimeseriesBucketsNamespace();
+            if (!isTimeseries) {
                 AutoGetDb autoDb(opCtx, collectionName.db(), MODE_IX);
                 Database* db = autoDb.getDb();
                 if (!db) {
@@ -304,10 +308,22 @@ Status dropCollection(OperationContext* opCtx,
                     opCtx, collectionName);
 
                 if (!coll) {
-                    return _dropView(opCtx, db, collectionName, result);
+                    auto status = _dropView(opCtx, db, collectionName, result);
+                    // The buckets of a time-series collection are dropped along with its view.
+                    if (!status.isOK() || collectionName.isTimeseriesBucketsCollection() ||
+                        !CollectionCatalog::get(opCtx).lookupUUIDByNSS(opCtx, bucketsNss)) {
+                        return status;
+                    }
+                    isTimeseries = true;
                 }
             }
 
+            if (isTimeseries) {
+                BSONObjBuilder unusedBuilder;
+                return _abortIndexBuildsAndDropCollection(
+                    opCtx, bucketsNss, systemCollectionMode, unusedBuilder);
+            }
+
             return _abortIndexBuildsAndDropCollection(
                 opCtx, collectionName, systemCollectionMode, result);
         });
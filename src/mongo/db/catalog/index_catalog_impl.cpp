@@ -609,6 +609,12 @@ Status IndexCatalogImpl::_isSpecOk(OperationContext* opCtx, const BSONObj& spec)
     if (nss.isOplog())
         return Status(ErrorCodes::CannotCreateIndex, "cannot have an index on the oplog");
 
+    // The entries of an index refer to documents by RecordId, and indexes do not yet support the
+    // variable-length RecordIds of a clustered collection, whose _id needs no index anyway.
+    if (_collection->isClustered())
+        return Status(ErrorCodes::CannotCreateIndex,
+                      "cannot have an index on a clustered collection");
+
     // logical name of the index
     const BSONElement nameElem = spec["name"];
     if (nameElem.type() != String)
@@ -670,7 +676,7 @@ Status IndexCatalogImpl::_isSpecOk(OperationContext* opCtx, const BSONObj& spec)
 
     const bool isSparse = spec["sparse"].trueValue();
 
-    if (pluginName == IndexNames::WILDCARD) {
+    if (pluginName == IndexNames::WILDCARD || pluginName == IndexNames::COLUMN_STORE) {
         if (isSparse) {
             return Status(ErrorCodes::CannotCreateIndex,
                           str::stream() << "Index type '" << pluginName
@@ -690,6 +696,14 @@ Status IndexCatalogImpl::_isSpecOk(OperationContext* opCtx, const BSONObj& spec)
         }
     }
 
+    // A column store index must hold an entry for every document, so that the documents read from
+    // it are the documents of the collection.
+    if (pluginName == IndexNames::COLUMN_STORE && spec.getField("partialFilterExpression")) {
+        return Status(ErrorCodes::CannotCreateIndex,
+                      str::stream() << "Index type '" << pluginName
+                                    << "' does not support the partialFilterExpression option");
+    }
+
     // Create an ExpressionContext, used to parse the match expression and to house the collator for
     // the remaining checks.
     boost::intrusive_ptr<ExpressionContext> expCtx(
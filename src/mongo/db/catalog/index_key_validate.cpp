@@ -137,7 +137,7 @@ Status validateKeyPattern(const BSONObj& key, IndexDescriptor::IndexVersion inde
                                           << static_cast<int>(indexVersion)};
                 }
 
-                if (pluginName == IndexNames::WILDCARD) {
+                if (pluginName == IndexNames::WILDCARD || pluginName == IndexNames::COLUMN_STORE) {
                     return {code,
                             str::stream() << "'" << pluginName
                                           << "' index plugin is not allowed with index version v:"
@@ -184,6 +184,16 @@ Status validateKeyPattern(const BSONObj& key, IndexDescriptor::IndexVersion inde
             return Status(code, "wildcard indexes do not allow compounding");
         }
 
+        // A column store index holds every top-level field, so its only valid key pattern is
+        // {"$**": "columnstore"}.
+        if (pluginName == IndexNames::COLUMN_STORE &&
+            (key.nFields() != 1 || keyElement.fieldNameStringData() != "$**")) {
+            return Status(code,
+                          str::stream() << "The key pattern of a '" << IndexNames::COLUMN_STORE
+                                        << "' index must be {\"$**\": \""
+                                        << IndexNames::COLUMN_STORE << "\"}");
+        }
+
         // Ensure that the fields on which we are building the index are valid: a field must not
         // begin with a '$' unless it is part of a wildcard, DBRef or text index, and a field path
         // cannot contain an empty field. If a field cannot be created or updated, it should not be
@@ -196,9 +206,10 @@ Status validateKeyPattern(const BSONObj& key, IndexDescriptor::IndexVersion inde
             return Status(code, "Index keys cannot be an empty field.");
         }
 
-        // "$**" is acceptable for a text index or wildcard index.
+        // "$**" is acceptable for a text, wildcard or column store index.
         if ((keyElement.fieldNameStringData() == "$**") &&
-            ((keyElement.isNumber()) || (keyElement.valuestrsafe() == IndexNames::TEXT)))
+            ((keyElement.isNumber()) || (keyElement.valuestrsafe() == IndexNames::TEXT) ||
+             (keyElement.valuestrsafe() == IndexNames::COLUMN_STORE)))
             continue;
 
         if ((keyElement.fieldNameStringData() == "_fts") &&
@@ -301,6 +312,18 @@ StatusWith<BSONObj> validateIndexSpec(
                 return keyPatternValidateStatus;
             }
 
+            // Binaries of the last versions cannot read column store indexes, so new ones are only
+            // accepted once the featureCompatibilityVersion is fully upgraded.
+            if (IndexNames::findPluginName(indexSpecElem.Obj()) == IndexNames::COLUMN_STORE &&
+                !(featureCompatibility.isVersionInitialized() &&
+                  featureCompatibility.isGreaterThanOrEqualTo(
+                      ServerGlobalParams::FeatureCompatibility::Version::kVersion47))) {
+                return {ErrorCodes::CannotCreateIndex,
+                        str::stream() << "'" << IndexNames::COLUMN_STORE
+                                      << "' indexes require featureCompatibilityVersion "
+                                      << "4.7 or greater"};
+            }
+
             for (const auto& keyElement : indexSpecElem.Obj()) {
                 if (keyElement.type() == String && keyElement.str().empty()) {
                     return {ErrorCodes::CannotCreateIndex,
@@ -283,6 +283,49 @@ TEST(IndexKeyValidateTest, KeyElementNameWildcardFailsWhenValueIsPluginNameWithV
     ASSERT_EQ(status, ErrorCodes::CannotCreateIndex);
 }
 
+TEST(IndexKeyValidateTest, ColumnStoreIndexKeyPattern) {
+    ASSERT_OK(validateKeyPattern(BSON("$**"
+                                      << "columnstore"),
+                                 IndexVersion::kV2));
+    ASSERT_EQ(ErrorCodes::CannotCreateIndex,
+              validateKeyPattern(BSON("$**"
+                                      << "columnstore"),
+                                 IndexVersion::kV1));
+    ASSERT_EQ(ErrorCodes::CannotCreateIndex,
+              validateKeyPattern(BSON("a"
+                                      << "columnstore"),
+                                 IndexVersion::kV2));
+    ASSERT_EQ(ErrorCodes::CannotCreateIndex,
+              validateKeyPattern(BSON("a.$**"
+                                      << "columnstore"),
+                                 IndexVersion::kV2));
+    ASSERT_EQ(ErrorCodes::CannotCreateIndex,
+              validateKeyPattern(BSON("$**"
+                                      << "columnstore"
+                                      << "a" << 1),
+                                 IndexVersion::kV2));
+}
+
+TEST(IndexKeyValidateTest, ColumnStoreIndexRequiresLatestFCV) {
+    const auto spec = fromjson("{key: {'$**': 'columnstore'}, name: 'index'}");
+
+    // The featureCompatibilityVersion defaults to uninitialized.
+    ServerGlobalParams::FeatureCompatibility fcv;
+    ASSERT_EQ(ErrorCodes::CannotCreateIndex,
+              index_key_validate::validateIndexSpec(nullptr, spec, fcv).getStatus());
+
+    fcv.setVersion(ServerGlobalParams::FeatureCompatibility::Version::kFullyDowngradedTo44);
+    ASSERT_EQ(ErrorCodes::CannotCreateIndex,
+              index_key_validate::validateIndexSpec(nullptr, spec, fcv).getStatus());
+
+    fcv.setVersion(ServerGlobalParams::FeatureCompatibility::Version::kDowngradingFrom47To44);
+    ASSERT_EQ(ErrorCodes::CannotCreateIndex,
+              index_key_validate::validateIndexSpec(nullptr, spec, fcv).getStatus());
+
+    fcv.setVersion(ServerGlobalParams::FeatureCompatibility::Version::kVersion47);
+    ASSERT_OK(index_key_validate::validateIndexSpec(nullptr, spec, fcv));
+}
+
 TEST(IndexKeyValidateTest, CompoundHashedIndex) {
     // Validation succeeds with hashed prefix in the index.
     ASSERT_OK(index_key_validate::validateIndexSpec(
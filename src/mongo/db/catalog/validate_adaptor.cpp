@@ -486,10 +486,11 @@ void ValidateAdaptor::validateIndexKeyCount(const IndexCatalogEntry* index,
 
     // Confirm that the number of index entries is not greater than the number of documents in the
     // collection. This check is only valid for indexes that are not multikey (indexed arrays
-    // produce an index key per array entry) and not $** indexes which can produce index keys for
-    // multiple paths within a single document.
+    // produce an index key per array entry) and not $** or column store indexes which can produce
+    // index keys for multiple paths within a single document.
     if (results.valid && !index->isMultikey() &&
-        desc->getIndexType() != IndexType::INDEX_WILDCARD && numTotalKeys > _numRecords) {
+        desc->getIndexType() != IndexType::INDEX_WILDCARD &&
+        desc->getIndexType() != IndexType::INDEX_COLUMN_STORE && numTotalKeys > _numRecords) {
         std::string err = str::stream()
             << "index " << desc->indexName() << " is not multi-key, but has more entries ("
             << numTotalKeys << ") than documents in the index (" << _numRecords << ")";
@@ -44,8 +44,12 @@ void ValidateResults::appendToResultObj(BSONObjBuilder& resultObj, bool debuggin
 
     // Need to convert RecordId to int64_t to append to BSONObjBuilder
     BSONArrayBuilder builder;
-    for (RecordId corruptRecord : corruptRecords) {
-        builder.append(corruptRecord.repr());
+    for (const RecordId& corruptRecord : corruptRecords) {
+        if (corruptRecord.isStr()) {
+            builder.append(corruptRecord.toString());
+        } else {
+            builder.append(corruptRecord.repr());
+        }
     }
     resultObj.append("corruptRecords", builder.done());
 
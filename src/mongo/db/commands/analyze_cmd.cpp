@@ -0,0 +1,242 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/db/query/collection_statistics_catalog.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/logv2/log.h"
+#include "mongo/platform/random.h"
+
+namespace mongo {
+namespace {
+/**
+ * Returns the leading field of every btree index of 'collection', which are the paths the cost
+ * model needs statistics for to cost index scans.
+ */
+std::vector<std::string> getIndexedPaths(OperationContext* opCtx, const Collection* collection) {
+    std::vector<std::string> paths;
+    auto it = collection->getIndexCatalog()->getIndexIterator(opCtx, false);
+    while (it->more()) {
+        const IndexDescriptor* descriptor = it->next()->descriptor();
+        if (descriptor->getIndexType() != INDEX_BTREE) {
+            continue;
+        }
+
+        std::string path = descriptor->keyPattern().firstElementFieldName();
+        if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+            paths.push_back(std::move(path));
+        }
+    }
+    return paths;
+}
+
+/**
+ * Gathers statistics about the values of some paths of a collection and stores them in the
+ * 'system.statistics' collection of its database, for the cost model to use when ranking
+ * candidate plans.
+ *
+ * {
+ *     analyze: <collection>,
+ *     keys: [<path>, ...],     // Optional, defaults to the leading fields of all btree indexes.
+ *     numberOfBuckets: <int>   // Optional, the maximum number of buckets of each histogram.
+ * }
+ *
+ * Every document of the collection is counted, but the histograms are built from a sample of about
+ * 'internalQueryAnalyzeSampleSize' documents.
+ */
+class AnalyzeCommand final : public BasicCommand {
+public:
+    AnalyzeCommand() : BasicCommand("analyze") {}
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kNever;
+    }
+
+    std::string help() const override {
+        return "Gathers statistics about the values of some paths of a collection, which the "
+               "query planner uses to estimate the cost of candidate plans.";
+    }
+
+    Status checkAuthForCommand(Client* client,
+                               const std::string& dbname,
+                               const BSONObj& cmdObj) const override {
+        AuthorizationSession* authzSession = AuthorizationSession::get(client);
+        ResourcePattern pattern = parseResourcePattern(dbname, cmdObj);
+
+        if (authzSession->isAuthorizedForActionsOnResource(pattern, ActionType::find) &&
+            authzSession->isAuthorizedForActionsOnResource(pattern,
+                                                           ActionType::planCacheWrite)) {
+            return Status::OK();
+        }
+
+        return Status(ErrorCodes::Unauthorized, "unauthorized");
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const NamespaceString nss(CommandHelpers::parseNsCollectionRequired(dbname, cmdObj));
+
+        std::vector<std::string> paths;
+        if (auto keysElem = cmdObj["keys"]) {
+            uassert(5095410,
+                    "'keys' must be an array of field paths",
+                    keysElem.type() == BSONType::Array);
+            for (auto&& key : keysElem.Obj()) {
+                uassert(5095411,
+                        "'keys' must be an array of non-empty field paths",
+                        key.type() == BSONType::String && !key.valueStringData().empty());
+                paths.push_back(key.str());
+            }
+        }
+
+        int numBuckets = internalQueryAnalyzeDefaultNumBuckets.load();
+        if (auto numBucketsElem = cmdObj["numberOfBuckets"]) {
+            uassert(5095412,
+                    "'numberOfBuckets' must be a number between 1 and 1000",
+                    numBucketsElem.isNumber() && numBucketsElem.numberInt() >= 1 &&
+                        numBucketsElem.numberInt() <= 1000);
+            numBuckets = numBucketsElem.numberInt();
+        }
+
+        // Scan the collection and build the statistics of every path.
+        boost::optional<UUID> uuid;
+        double numDocuments = 0;
+        std::vector<FieldStatistics> fieldStats;
+        {
+            AutoGetCollectionForReadCommand ctx(opCtx, nss);
+            uassert(ErrorCodes::CommandNotSupportedOnView,
+                    str::stream() << "cannot analyze view " << nss,
+                    !ctx.getView());
+            const Collection* collection = ctx.getCollection();
+            uassert(ErrorCodes::NamespaceNotFound,
+                    str::stream() << "collection " << nss << " does not exist",
+                    collection);
+            uuid = collection->uuid();
+
+            if (paths.empty()) {
+                paths = getIndexedPaths(opCtx, collection);
+            }
+            uassert(5095413,
+                    "no paths to analyze: specify 'keys' or create an index",
+                    !paths.empty());
+
+            std::vector<FieldStatisticsBuilder> builders;
+            for (auto&& path : paths) {
+                builders.emplace_back(path);
+            }
+
+            const double numRecords = collection->numRecords(opCtx);
+            const double sampleRate = numRecords > 0
+                ? std::min(1.0, internalQueryAnalyzeSampleSize.load() / numRecords)
+                : 1.0;
+            PseudoRandom random(SecureRandom().nextInt64());
+
+            auto exec = InternalPlanner::collectionScan(
+                opCtx, nss.ns(), collection, PlanYieldPolicy::YieldPolicy::YIELD_AUTO);
+            BSONObj doc;
+            while (exec->getNext(&doc, nullptr) == PlanExecutor::ADVANCED) {
+                const bool sampled = random.nextCanonicalDouble() < sampleRate;
+                for (auto&& builder : builders) {
+                    builder.addDocument(doc, sampled);
+                }
+                ++numDocuments;
+            }
+
+            for (auto&& builder : builders) {
+                fieldStats.push_back(builder.done(numBuckets));
+            }
+        }
+
+        // Store the statistics, replacing the ones gathered by earlier runs.
+        const auto statsNss = collection_statistics_catalog::statisticsNamespace(nss.db());
+        writeConflictRetry(opCtx, "analyze", statsNss.ns(), [&] {
+            AutoGetCollection autoColl(opCtx, statsNss, MODE_IX);
+            uassert(ErrorCodes::NotWritablePrimary,
+                    str::stream() << "Not primary while writing to " << statsNss,
+                    repl::ReplicationCoordinator::get(opCtx)->canAcceptWritesFor(opCtx,
+                                                                                 statsNss));
+
+            WriteUnitOfWork wuow(opCtx);
+            for (auto&& stats : fieldStats) {
+                Helpers::upsert(opCtx,
+                                statsNss.ns(),
+                                collection_statistics_catalog::makeStatisticsDocument(
+                                    nss, *uuid, numDocuments, stats));
+            }
+            wuow.commit();
+        });
+
+        // The statistics and plans cached by the collection are cleared on its next query, on this
+        // node and on the secondaries, by the CollectionStatisticsOpObserver.
+
+        LOGV2(5095414,
+              "Analyzed collection",
+              "namespace"_attr = nss,
+              "paths"_attr = paths,
+              "numDocuments"_attr = numDocuments);
+
+        result.append("numDocuments", numDocuments);
+        BSONArrayBuilder fieldsBuilder(result.subarrayStart("fields"));
+        for (auto&& stats : fieldStats) {
+            BSONObjBuilder fieldBuilder(fieldsBuilder.subobjStart());
+            fieldBuilder.append("path", stats.path);
+            fieldBuilder.append("valueCount", stats.valueCount);
+            fieldBuilder.append("distinctCount", stats.distinctCount);
+            fieldBuilder.append("numBuckets", static_cast<int>(stats.histogram.numBuckets()));
+        }
+        fieldsBuilder.doneFast();
+        return true;
+    }
+} analyzeCmd;
+}  // namespace
+}  // namespace mongo
@@ -320,6 +320,8 @@ public:
             << "  indexOptionDefaults: <document: default configuration for indexes>,\n"
             << "  viewOn: <string: name of source collection or view>,\n"
             << "  pipeline: <array<object>: aggregation pipeline stage>,\n"
+            << "  materializedView: <document: source collection and pipeline to maintain>,\n"
+            << "  timeseries: <document: time field, meta field and bucket span of measurements>,\n"
             << "  collation: <document: default collation for the collection or view>,\n"
             << "  writeConcern: <document: write concern expression for the operation>]\n"
             << "}";
@@ -38,6 +38,7 @@
 #include <vector>
 
 #include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection_catalog.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/cursor_manager.h"
@@ -53,6 +54,7 @@
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/pipeline/pipeline_d.h"
+#include "mongo/db/pipeline/pipeline_result_cache.h"
 #include "mongo/db/pipeline/plan_executor_pipeline.h"
 #include "mongo/db/pipeline/process_interface/mongo_process_interface.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
@@ -62,10 +64,12 @@
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_executor_factory.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/read_concern.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/read_concern_args.h"
+#include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/speculative_majority_read_info.h"
 #include "mongo/db/s/operation_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
@@ -110,14 +114,16 @@ bool canOptimizeAwayPipeline(const Pipeline* pipeline,
  * Returns true if we need to keep a ClientCursor saved for this pipeline (for future getMore
  * requests). Otherwise, returns false. The passed 'nsForCursor' is only used to determine the
  * namespace used in the returned cursor, which will be registered with the global cursor manager,
- * and thus will be different from that in 'request'.
+ * and thus will be different from that in 'request'. If 'resultsToCache' is not null and the
+ * first batch holds all of the results, they are copied to 'resultsToCache'.
  */
 bool handleCursorCommand(OperationContext* opCtx,
                          boost::intrusive_ptr<ExpressionContext> expCtx,
                          const NamespaceString& nsForCursor,
                          std::vector<ClientCursor*> cursors,
                          const AggregationRequest& request,
-                         rpc::ReplyBuilderInterface* result) {
+                         rpc::ReplyBuilderInterface* result,
+                         std::vector<BSONObj>* resultsToCache) {
     invariant(!cursors.empty());
     long long batchSize = request.getBatchSize();
 
@@ -215,6 +221,9 @@ bool handleCursorCommand(OperationContext* opCtx,
         // If this executor produces a postBatchResumeToken, add it to the cursor response.
         responseBuilder.setPostBatchResumeToken(exec->getPostBatchResumeToken());
         responseBuilder.append(nextDoc);
+        if (resultsToCache) {
+            resultsToCache->push_back(nextDoc.getOwned());
+        }
     }
 
     if (cursor) {
@@ -239,6 +248,10 @@ bool handleCursorCommand(OperationContext* opCtx,
         curOp->debug().cursorExhausted = true;
     }
 
+    if (cursor && resultsToCache) {
+        resultsToCache->clear();
+    }
+
     const CursorId cursorId = cursor ? cursor->cursorid() : 0LL;
     responseBuilder.done(cursorId, nsForCursor.ns());
 
@@ -463,6 +476,190 @@ std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> createExchangePipelinesI
 
     return pipelines;
 }
+
+/**
+ * Returns true if the first $group of the pipeline may be split across threads. The threads run
+ * under operations of their own, which don't carry this operation's transaction or read concern.
+ */
+bool canParallelizeGroup(OperationContext* opCtx,
+                         const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                         const AggregationRequest& request) {
+    if (request.getExchangeSpec() || expCtx->explain || opCtx->inMultiDocumentTransaction()) {
+        return false;
+    }
+
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(opCtx);
+    return readConcernArgs.getLevel() == repl::ReadConcernLevel::kLocalReadConcern &&
+        !readConcernArgs.getArgsOpTime() && !readConcernArgs.getArgsAfterClusterTime() &&
+        !readConcernArgs.getArgsAtClusterTime();
+}
+
+/**
+ * Returns true if 'obj' names a stage or an expression, or refers to a variable, whose value is
+ * not determined by the documents the aggregation reads.
+ */
+bool dependsOnMoreThanData(const BSONObj& obj) {
+    static const StringDataSet kStagesAndExpressions{"$accumulator",
+                                                     "$collStats",
+                                                     "$currentOp",
+                                                     "$function",
+                                                     "$indexStats",
+                                                     "$listLocalSessions",
+                                                     "$listSessions",
+                                                     "$planCacheStats",
+                                                     "$rand",
+                                                     "$sample",
+                                                     "$where"};
+    for (auto&& elem : obj) {
+        if (kStagesAndExpressions.count(elem.fieldNameStringData())) {
+            return true;
+        }
+        if (elem.type() == BSONType::String &&
+            (elem.valueStringData().startsWith("$$NOW") ||
+             elem.valueStringData().startsWith("$$CLUSTER_TIME"))) {
+            return true;
+        }
+        if (elem.isABSONObj() && dependsOnMoreThanData(elem.Obj())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns true if the results of this aggregation can be served from and stored in the pipeline
+ * result cache: they must depend only on the latest committed documents of the collections the
+ * aggregation reads, and the aggregation must not write.
+ */
+bool canUseResultCache(OperationContext* opCtx,
+                       const NamespaceString& nss,
+                       const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                       const AggregationRequest& request,
+                       const LiteParsedPipeline& liteParsedPipeline,
+                       const Pipeline& pipeline) {
+    if (nss.isCollectionlessAggregateNS() || liteParsedPipeline.hasChangeStream() ||
+        expCtx->tailableMode != TailableModeEnum::kNormal || pipeline.getSources().empty() ||
+        pipeline.getSources().back()->constraints().writesPersistentData()) {
+        return false;
+    }
+
+    // On shards, the results of an aggregation also depend on which chunks the shard owns, and on
+    // secondaries, the reads may be at a point in time before the latest committed writes.
+    if (ShardingState::get(opCtx)->enabled() ||
+        !repl::ReplicationCoordinator::get(opCtx)->canAcceptWritesForDatabase(opCtx, nss.db())) {
+        return false;
+    }
+
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(opCtx);
+    if (request.getExchangeSpec() || expCtx->explain || opCtx->inMultiDocumentTransaction() ||
+        readConcernArgs.getLevel() != repl::ReadConcernLevel::kLocalReadConcern ||
+        readConcernArgs.getArgsOpTime() || readConcernArgs.getArgsAfterClusterTime() ||
+        readConcernArgs.getArgsAtClusterTime()) {
+        return false;
+    }
+
+    for (auto&& stage : request.getPipeline()) {
+        if (dependsOnMoreThanData(stage)) {
+            return false;
+        }
+    }
+    return !dependsOnMoreThanData(request.getLetParameters());
+}
+
+/**
+ * Returns the key under which the results of the given optimized 'pipeline' are cached. The key
+ * includes the UUIDs of the collections in 'version', so that the results are never served for a
+ * collection which was dropped and created again, and the batch size, since the results are only
+ * cached when they fit in the first batch.
+ */
+std::string makeResultCacheKey(const NamespaceString& nss,
+                               const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                               const AggregationRequest& request,
+                               const LiteParsedPipeline& liteParsedPipeline,
+                               const Pipeline& pipeline,
+                               const PipelineResultCache::Version& version) {
+    BSONObjBuilder keyBuilder;
+    keyBuilder.append("ns", nss.ns());
+    keyBuilder.append("pipeline", pipeline.serializeToBson());
+    keyBuilder.append("collation", expCtx->getCollatorBSON());
+    keyBuilder.append("batchSize", request.getBatchSize());
+    keyBuilder.append("let", request.getLetParameters());
+
+    // The definitions of the views the pipeline reads from are part of the key, since a view can
+    // be redefined without writing to any collection.
+    std::map<NamespaceString, BSONObj> resolvedNamespaces;
+    for (auto&& involvedNs : liteParsedPipeline.getInvolvedNamespaces()) {
+        const auto& resolvedNs = expCtx->getResolvedNamespace(involvedNs);
+        BSONObjBuilder resolvedNsBuilder;
+        resolvedNsBuilder.append("ns", involvedNs.ns());
+        resolvedNsBuilder.append("resolvedNs", resolvedNs.ns.ns());
+        resolvedNsBuilder.append("pipeline", resolvedNs.pipeline);
+        resolvedNamespaces.emplace(involvedNs, resolvedNsBuilder.obj());
+    }
+    BSONArrayBuilder involvedBuilder(keyBuilder.subarrayStart("involved"));
+    for (auto&& [involvedNs, resolvedNsObj] : resolvedNamespaces) {
+        involvedBuilder.append(resolvedNsObj);
+    }
+    involvedBuilder.doneFast();
+
+    BSONArrayBuilder uuidsBuilder(keyBuilder.subarrayStart("uuids"));
+    for (auto&& [uuid, writeCount] : version.writeCounts) {
+        uuid.appendToArrayBuilder(&uuidsBuilder);
+    }
+    uuidsBuilder.doneFast();
+
+    auto key = keyBuilder.obj();
+    return std::string(key.objdata(), key.objsize());
+}
+
+/**
+ * Returns the version of the data the aggregation on 'nss' reads, or boost::none if one of the
+ * collections it reads does not exist. Must be called before the aggregation opens its snapshot.
+ */
+boost::optional<PipelineResultCache::Version> getResultCacheVersion(
+    OperationContext* opCtx,
+    const NamespaceString& nss,
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const LiteParsedPipeline& liteParsedPipeline) {
+    const auto& catalog = CollectionCatalog::get(opCtx);
+
+    std::set<NamespaceString> namespaces{nss};
+    for (auto&& involvedNs : liteParsedPipeline.getInvolvedNamespaces()) {
+        namespaces.insert(expCtx->getResolvedNamespace(involvedNs).ns);
+    }
+
+    PipelineResultCache::Version version;
+    version.catalogEpoch = catalog.getEpoch();
+    for (auto&& ns : namespaces) {
+        auto collection = catalog.lookupCollectionByNamespaceForRead(opCtx, ns);
+        if (!collection) {
+            return boost::none;
+        }
+        const auto writeCount = CollectionQueryInfo::get(collection.get()).getWriteCount();
+        version.writeCounts.emplace_back(collection->uuid(), writeCount);
+    }
+    return version;
+}
+
+/**
+ * Replies to the aggregation with the cached 'results', as a cursor which is already exhausted.
+ */
+void appendCachedResults(OperationContext* opCtx,
+                         const NamespaceString& nsForCursor,
+                         const std::vector<BSONObj>& results,
+                         rpc::ReplyBuilderInterface* result) {
+    CursorResponseBuilder::Options options;
+    options.isInitialResponse = true;
+    CursorResponseBuilder responseBuilder(result, options);
+    for (auto&& doc : results) {
+        responseBuilder.append(doc);
+    }
+    responseBuilder.done(0LL, nsForCursor.ns());
+
+    auto curOp = CurOp::get(opCtx);
+    curOp->debug().nreturned = results.size();
+    curOp->debug().cursorExhausted = true;
+}
 }  // namespace
 
 Status runAggregate(OperationContext* opCtx,
@@ -499,6 +696,10 @@ Status runAggregate(OperationContext* opCtx,
     std::vector<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> execs;
     boost::intrusive_ptr<ExpressionContext> expCtx;
     auto curOp = CurOp::get(opCtx);
+
+    // Set if the results of this aggregation are to be stored in the pipeline result cache.
+    boost::optional<std::string> resultCacheKey;
+    boost::optional<PipelineResultCache::Version> resultCacheVersion;
     {
         // If we are in a transaction, check whether the parsed pipeline supports
         // being in a transaction.
@@ -640,6 +841,25 @@ Status runAggregate(OperationContext* opCtx,
 
         pipeline->optimizePipeline();
 
+        // Serve the results from the pipeline result cache if this aggregation ran before on the
+        // same data. The version of the data is read before any of it is, so that the results
+        // cached by this aggregation are stale if a write commits while it runs.
+        if (internalQueryPipelineResultCacheMaxSizeBytes.load() > 0 &&
+            canUseResultCache(opCtx, nss, expCtx, request, liteParsedPipeline, *pipeline)) {
+            resultCacheVersion = getResultCacheVersion(opCtx, nss, expCtx, liteParsedPipeline);
+            if (resultCacheVersion) {
+                resultCacheKey = makeResultCacheKey(
+                    nss, expCtx, request, liteParsedPipeline, *pipeline, *resultCacheVersion);
+                auto cachedResults = PipelineResultCache::get(opCtx->getServiceContext())
+                                         .lookup(*resultCacheKey, *resultCacheVersion);
+                if (cachedResults) {
+                    liteParsedPipeline.tickGlobalStageCounters();
+                    appendCachedResults(opCtx, origNss, *cachedResults, result);
+                    return Status::OK();
+                }
+            }
+        }
+
         // Check if the pipeline has a $geoNear stage, as it will be ripped away during the build
         // query executor phase below (to be replaced with a $geoNearCursorStage later during the
         // executor attach phase).
@@ -680,6 +900,11 @@ Status runAggregate(OperationContext* opCtx,
                                                           std::move(attachExecutorCallback.second),
                                                           pipeline.get());
 
+            const auto nGroupConsumers = internalQueryParallelGroupConsumers.load();
+            if (nGroupConsumers > 1 && canParallelizeGroup(opCtx, expCtx, request)) {
+                PipelineD::parallelizeGroup(pipeline.get(), nGroupConsumers);
+            }
+
             auto pipelines =
                 createExchangePipelinesIfNeeded(opCtx, expCtx, request, std::move(pipeline), uuid);
             for (auto&& pipelineIt : pipelines) {
@@ -768,10 +993,23 @@ Status runAggregate(OperationContext* opCtx,
         }
     } else {
         // Cursor must be specified, if explain is not.
-        const bool keepCursor =
-            handleCursorCommand(opCtx, expCtx, origNss, std::move(cursors), request, result);
+        std::vector<BSONObj> resultsToCache;
+        const bool keepCursor = handleCursorCommand(opCtx,
+                                                    expCtx,
+                                                    origNss,
+                                                    std::move(cursors),
+                                                    request,
+                                                    result,
+                                                    resultCacheKey ? &resultsToCache : nullptr);
         if (keepCursor) {
             cursorFreer.dismiss();
+        } else if (resultCacheKey) {
+            PipelineResultCache::get(opCtx->getServiceContext())
+                .add(*resultCacheKey,
+                     std::move(*resultCacheVersion),
+                     std::move(resultsToCache),
+                     internalQueryPipelineResultCacheMaxSizeBytes.load(),
+                     internalQueryPipelineResultCacheMaxEntrySizeBytes.load());
         }
 
         PlanSummaryStats stats;
@@ -33,8 +33,10 @@
 
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/catalog/coll_mod.h"
+#include "mongo/db/catalog/collection_catalog_helper.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/feature_compatibility_version.h"
 #include "mongo/db/commands/feature_compatibility_version_documentation.h"
@@ -44,6 +46,7 @@
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/index_builds_coordinator.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/ops/write_ops.h"
 #include "mongo/db/read_write_concern_defaults.h"
@@ -352,6 +355,10 @@ public:
             if (failDowngrading.shouldFail())
                 return false;
 
+            // No column store index can be created past the barrier above, and the binaries of the
+            // last versions cannot read the existing ones.
+            _checkNoColumnStoreIndexes(opCtx);
+
             if (serverGlobalParams.clusterRole == ClusterRole::ShardServer) {
                 LOGV2(20502, "Downgrade: dropping config.rangeDeletions collection");
                 migrationutil::dropRangeDeletionsCollection(opCtx);
@@ -382,6 +389,32 @@ public:
     }
 
 private:
+    /**
+     * Fails the downgrade if any collection has a column store index, including one which is still
+     * being built.
+     */
+    void _checkNoColumnStoreIndexes(OperationContext* opCtx) {
+        for (auto&& dbName : CollectionCatalog::get(opCtx).getAllDbNames()) {
+            Lock::DBLock dbLock(opCtx, dbName, MODE_IS);
+            catalog::forEachCollectionFromDb(
+                opCtx, dbName, MODE_IS, [&](const Collection* collection) {
+                    auto it = collection->getIndexCatalog()->getIndexIterator(
+                        opCtx, true /* includeUnfinishedIndexes */);
+                    while (it->more()) {
+                        auto desc = it->next()->descriptor();
+                        uassert(ErrorCodes::IllegalOperation,
+                                str::stream()
+                                    << "cannot downgrade featureCompatibilityVersion while '"
+                                    << IndexNames::COLUMN_STORE << "' index '"
+                                    << desc->indexName() << "' exists on collection "
+                                    << collection->ns() << "; drop it first",
+                                desc->getIndexType() != IndexType::INDEX_COLUMN_STORE);
+                    }
+                    return true;
+                });
+        }
+    }
+
     /*
      * Rolls back any upgraded on-disk changes to reflect the disk format of the last-continuous
      * version.
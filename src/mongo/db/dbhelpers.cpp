@@ -48,6 +48,7 @@
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/storage/record_id_helpers.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
@@ -139,6 +140,18 @@ bool Helpers::findById(OperationContext* opCtx,
     if (nsFound)
         *nsFound = true;
 
+    if (collection->isClustered()) {
+        // The documents of a clustered collection are found in the record store by their _id.
+        if (indexFound)
+            *indexFound = 1;
+
+        Snapshotted<BSONObj> doc;
+        if (!collection->findDoc(opCtx, record_id_helpers::keyForId(query["_id"]), &doc))
+            return false;
+        result = doc.value();
+        return true;
+    }
+
     const IndexCatalog* catalog = collection->getIndexCatalog();
     const IndexDescriptor* desc = catalog->findIdIndex(opCtx);
 
@@ -159,6 +172,11 @@ RecordId Helpers::findById(OperationContext* opCtx,
                            const Collection* collection,
                            const BSONObj& idquery) {
     verify(collection);
+    if (collection->isClustered()) {
+        const RecordId loc = record_id_helpers::keyForId(idquery["_id"]);
+        Snapshotted<BSONObj> doc;
+        return collection->findDoc(opCtx, loc, &doc) ? loc : RecordId();
+    }
     const IndexCatalog* catalog = collection->getIndexCatalog();
     const IndexDescriptor* desc = catalog->findIdIndex(opCtx);
     uassert(13430, "no _id index", desc);
@@ -64,12 +64,14 @@ CachedPlanStage::CachedPlanStage(ExpressionContext* expCtx,
                                  CanonicalQuery* cq,
                                  const QueryPlannerParams& params,
                                  size_t decisionWorks,
+                                 PlanCacheKey planCacheKey,
                                  std::unique_ptr<PlanStage> root)
     : RequiresAllIndicesStage(kStageType, expCtx, collection),
       _ws(ws),
       _canonicalQuery(cq),
       _plannerParams(params),
-      _decisionWorks(decisionWorks) {
+      _decisionWorks(decisionWorks),
+      _planCacheKey(std::move(planCacheKey)) {
     _children.emplace_back(std::move(root));
 }
 
@@ -133,10 +135,12 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
 
             if (_results.size() >= numResults) {
                 // Once a plan returns enough results, stop working. There is no need to replan.
+                recordExecutionFeedback(i + 1);
                 return Status::OK();
             }
         } else if (PlanStage::IS_EOF == state) {
             // Cached plan hit EOF quickly enough. No need to replan.
+            recordExecutionFeedback(i + 1);
             return Status::OK();
         } else if (PlanStage::NEED_YIELD == state) {
             invariant(id == WorkingSet::INVALID_ID);
@@ -177,6 +181,14 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
             << " works");
 }
 
+void CachedPlanStage::recordExecutionFeedback(size_t works) {
+    // A cached plan that keeps passing its trial period may still be drifting away from the
+    // efficiency it had when it was cached. Let the plan cache track this across executions, so
+    // that it can force a replan before the plan becomes bad enough to fail the trial period.
+    plan_cache_util::recordExecutionFeedback(
+        expCtx()->opCtx, collection(), _planCacheKey, works, _results.size());
+}
+
 Status CachedPlanStage::tryYield(PlanYieldPolicy* yieldPolicy) {
     // These are the conditions which can cause us to yield:
     //   1) The yield policy's timer elapsed, or
@@ -36,6 +36,7 @@
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/record_id.h"
@@ -62,6 +63,7 @@ public:
                     CanonicalQuery* cq,
                     const QueryPlannerParams& params,
                     size_t decisionWorks,
+                    PlanCacheKey planCacheKey,
                     std::unique_ptr<PlanStage> root);
 
     bool isEOF() final;
@@ -109,6 +111,12 @@ private:
      */
     Status tryYield(PlanYieldPolicy* yieldPolicy);
 
+    /**
+     * Reports to the plan cache the outcome of a trial period which completed, without needing
+     * to replan, after 'works' work cycles.
+     */
+    void recordExecutionFeedback(size_t works);
+
     // Not owned.
     WorkingSet* _ws;
 
@@ -121,6 +129,9 @@ private:
     // cached.
     size_t _decisionWorks;
 
+    // The key of the plan cache entry which the plan came from, used to report execution feedback.
+    const PlanCacheKey _planCacheKey;
+
     // If we fall back to re-planning the query, and there is just one resulting query solution,
     // that solution is owned here.
     std::unique_ptr<QuerySolution> _replannedQs;
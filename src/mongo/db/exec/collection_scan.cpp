@@ -69,6 +69,8 @@ CollectionScan::CollectionScan(ExpressionContext* expCtx,
     _specificStats.direction = params.direction;
     _specificStats.minTs = params.minTs;
     _specificStats.maxTs = params.maxTs;
+    _specificStats.minRecord = params.minRecord;
+    _specificStats.maxRecord = params.maxRecord;
     _specificStats.tailable = params.tailable;
     if (params.minTs || params.maxTs) {
         // The 'minTs' and 'maxTs' parameters are used for a special optimization that
@@ -77,6 +79,10 @@ CollectionScan::CollectionScan(ExpressionContext* expCtx,
         invariant(collection->ns().isOplog());
         invariant(!params.resumeAfterRecordId);
     }
+    if (params.minRecord || params.maxRecord) {
+        invariant(collection->isClustered());
+        invariant(!params.resumeAfterRecordId);
+    }
     invariant(!_params.shouldTrackLatestOplogTimestamp || collection->ns().isOplog());
 
     // We should never see 'assertMinTsHasNotFallenOffOplog' if 'minTS' is not present.
@@ -181,6 +187,20 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
             }
         }
 
+        if (_lastSeenId.isNull() && !record) {
+            // Seek to the start of the range of RecordIds of a clustered collection to scan.
+            const auto& start = _params.direction == CollectionScanParams::FORWARD
+                ? _params.minRecord
+                : _params.maxRecord;
+            if (start) {
+                record = _cursor->seekNear(*start);
+                if (!record) {
+                    _commonStats.isEOF = true;
+                    return PlanStage::IS_EOF;
+                }
+            }
+        }
+
         if (!record) {
             record = _cursor->next();
         }
@@ -203,6 +223,16 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    // Stop once past the end of the range of RecordIds of a clustered collection to scan.
+    const auto& end =
+        _params.direction == CollectionScanParams::FORWARD ? _params.maxRecord : _params.minRecord;
+    if (end &&
+        (_params.direction == CollectionScanParams::FORWARD ? record->id > *end
+                                                            : record->id < *end)) {
+        _commonStats.isEOF = true;
+        return PlanStage::IS_EOF;
+    }
+
     _lastSeenId = record->id;
     if (_params.assertMinTsHasNotFallenOffOplog) {
         assertMinTsHasNotFallenOffOplog(*record);
@@ -35,6 +35,7 @@
 #include "mongo/db/exec/requires_collection_stage.h"
 #include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_id_helpers.h"
 #include "mongo/s/resharding/resume_token_gen.h"
 
 namespace mongo {
@@ -77,7 +78,9 @@ public:
     BSONObj getPostBatchResumeToken() const {
         // Return a resume token compatible with resumable initial sync.
         if (_params.requestResumeToken) {
-            return BSON("$recordId" << _lastSeenId.repr());
+            BSONObjBuilder builder;
+            record_id_helpers::appendToBSONAs(_lastSeenId, &builder, "$recordId");
+            return builder.obj();
         }
         // Return a resume token compatible with resharding oplog sync.
         if (_params.shouldTrackLatestOplogTimestamp) {
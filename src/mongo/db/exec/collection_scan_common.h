@@ -53,6 +53,12 @@ struct CollectionScanParams {
     // This field cannot be used in conjunction with 'resumeAfterRecordId'.
     boost::optional<Timestamp> maxTs;
 
+    // If present, the collection scan will skip the records of a clustered collection whose
+    // RecordId is before 'minRecord' or after 'maxRecord', both inclusive, by seeking to the start
+    // of the range and returning EOF past its end.
+    boost::optional<RecordId> minRecord;
+    boost::optional<RecordId> maxRecord;
+
     // If true, the collection scan will return a token that can be used to resume the scan.
     bool requestResumeToken = false;
 
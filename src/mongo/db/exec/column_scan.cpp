@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/column_scan.h"
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/working_set.h"
+
+namespace mongo {
+
+// static
+const char* ColumnScan::kStageType = "COLUMN_SCAN";
+
+ColumnScan::ColumnScan(ExpressionContext* expCtx,
+                       const Collection* collection,
+                       const IndexDescriptor* indexDescriptor,
+                       std::vector<std::string> fields,
+                       WorkingSet* workingSet,
+                       const MatchExpression* filter)
+    : RequiresIndexStage(kStageType, expCtx, collection, indexDescriptor, workingSet),
+      _workingSet(workingSet),
+      _filter(filter) {
+    _specificStats.indexName = indexDescriptor->indexName();
+    _specificStats.fields = std::move(fields);
+}
+
+PlanStage::StageState ColumnScan::doWork(WorkingSetID* out) {
+    if (_commonStats.isEOF)
+        return PlanStage::IS_EOF;
+
+    boost::optional<ColumnStoreAccessMethod::RowCursor::Row> row;
+    try {
+        if (!_cursor) {
+            _cursor = static_cast<const ColumnStoreAccessMethod*>(indexAccessMethod())
+                          ->newRowCursor(opCtx(), _specificStats.fields);
+        }
+        row = _cursor->next();
+    } catch (const WriteConflictException&) {
+        // The cursor resumes after the last document it returned when it is restored.
+        *out = WorkingSet::INVALID_ID;
+        return PlanStage::NEED_YIELD;
+    }
+    _specificStats.keysExamined = _cursor->keysExamined();
+
+    if (!row) {
+        _commonStats.isEOF = true;
+        return PlanStage::IS_EOF;
+    }
+
+    WorkingSetID id = _workingSet->allocate();
+    WorkingSetMember* member = _workingSet->get(id);
+    member->recordId = row->recordId;
+    member->resetDocument(opCtx()->recoveryUnit()->getSnapshotId(), std::move(row->obj));
+    _workingSet->transitionToRecordIdAndObj(id);
+
+    ++_specificStats.docsTested;
+    if (!Filter::passes(member, _filter)) {
+        _workingSet->free(id);
+        return PlanStage::NEED_TIME;
+    }
+
+    *out = id;
+    return PlanStage::ADVANCED;
+}
+
+bool ColumnScan::isEOF() {
+    return _commonStats.isEOF;
+}
+
+void ColumnScan::doSaveStateRequiresIndex() {
+    if (_cursor)
+        _cursor->save();
+}
+
+void ColumnScan::doRestoreStateRequiresIndex() {
+    if (_cursor)
+        _cursor->restore();
+}
+
+void ColumnScan::doDetachFromOperationContext() {
+    if (_cursor)
+        _cursor->detachFromOperationContext();
+}
+
+void ColumnScan::doReattachToOperationContext() {
+    if (_cursor)
+        _cursor->reattachToOperationContext(opCtx());
+}
+
+std::unique_ptr<PlanStageStats> ColumnScan::getStats() {
+    _commonStats.isEOF = isEOF();
+
+    // Add a BSON representation of the filter to the stats tree, if there is one.
+    if (nullptr != _filter) {
+        BSONObjBuilder bob;
+        _filter->serialize(&bob);
+        _commonStats.filter = bob.obj();
+    }
+
+    auto ret = std::make_unique<PlanStageStats>(_commonStats, STAGE_COLUMN_SCAN);
+    ret->specific = std::make_unique<ColumnScanStats>(_specificStats);
+    return ret;
+}
+
+const SpecificStats* ColumnScan::getSpecificStats() const {
+    return &_specificStats;
+}
+
+}  // namespace mongo
@@ -0,0 +1,92 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/exec/requires_index_stage.h"
+#include "mongo/db/index/column_store_access_method.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+class WorkingSet;
+
+/**
+ * Reads the documents of a collection from its column store index instead of its record store.
+ * Only the columns of 'fields' are read, so each document holds only those of its top-level
+ * fields. The documents which pass the filter are returned, in record id order, in the
+ * RID_AND_OBJ state.
+ *
+ * The planner only uses this stage when 'fields' hold everything that the filter and the rest of
+ * the plan need, so the partial documents may stand in for the whole ones.
+ */
+class ColumnScan final : public RequiresIndexStage {
+public:
+    ColumnScan(ExpressionContext* expCtx,
+               const Collection* collection,
+               const IndexDescriptor* indexDescriptor,
+               std::vector<std::string> fields,
+               WorkingSet* workingSet,
+               const MatchExpression* filter);
+
+    StageState doWork(WorkingSetID* out) final;
+    bool isEOF() final;
+
+    StageType stageType() const final {
+        return STAGE_COLUMN_SCAN;
+    }
+
+    std::unique_ptr<PlanStageStats> getStats() final;
+
+    const SpecificStats* getSpecificStats() const final;
+
+    static const char* kStageType;
+
+protected:
+    void doSaveStateRequiresIndex() final;
+    void doRestoreStateRequiresIndex() final;
+    void doDetachFromOperationContext() final;
+    void doReattachToOperationContext() final;
+
+private:
+    // The WorkingSet we annotate with results.  Not owned by us.
+    WorkingSet* _workingSet;
+
+    // The filter is not owned by us.
+    const MatchExpression* _filter;
+
+    std::unique_ptr<ColumnStoreAccessMethod::RowCursor> _cursor;
+
+    ColumnScanStats _specificStats;
+};
+
+}  // namespace mongo
@@ -34,6 +34,7 @@
 #include "mongo/db/exec/plan_cache_util.h"
 
 #include "mongo/db/query/explain.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/logv2/log.h"
 
 namespace mongo::plan_cache_util {
@@ -69,4 +70,22 @@ void logNotCachingNoData(std::string&& solution) {
                 "solutions"_attr = redact(solution));
 }
 }  // namespace log_detail
+
+void recordExecutionFeedback(OperationContext* opCtx,
+                             const Collection* collection,
+                             const PlanCacheKey& planCacheKey,
+                             size_t works,
+                             size_t nReturned) {
+    if (internalQueryCacheFeedbackDegradationRatio.load() <= 0) {
+        // Execution feedback is disabled, there is no need to read the clock.
+        return;
+    }
+
+    CollectionQueryInfo::get(collection)
+        .getPlanCache()
+        ->recordExecutionFeedback(planCacheKey,
+                                  works,
+                                  nReturned,
+                                  opCtx->getServiceContext()->getPreciseClockSource()->now());
+}
 }  // namespace mongo::plan_cache_util
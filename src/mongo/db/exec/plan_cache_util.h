@@ -68,6 +68,18 @@ void logNotCachingZeroResults(std::string&& query, double score, std::string win
 void logNotCachingNoData(std::string&& solution);
 }  // namespace log_detail
 
+/**
+ * Reports to the plan cache that the cached plan for the query shape identified by 'planCacheKey'
+ * performed 'works' work cycles (or physical reads, for SBE plans) and returned 'nReturned'
+ * documents during its trial period. This may deactivate the cache entry if its plan has degraded
+ * over time.
+ */
+void recordExecutionFeedback(OperationContext* opCtx,
+                             const Collection* collection,
+                             const PlanCacheKey& planCacheKey,
+                             size_t works,
+                             size_t nReturned);
+
 /**
  * Caches the best candidate plan, chosen from the given 'candidates' based on the 'ranking'
  * decision, if the 'query' is of a type that can be cached. Otherwise, does nothing.
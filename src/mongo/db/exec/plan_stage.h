@@ -347,6 +347,14 @@ public:
         _commonStats.executionTimeMillis.emplace(0);
     }
 
+    /**
+     * Records the number of results the cost model expects this stage to produce, so that explain
+     * can report it.
+     */
+    void setEstimatedCardinality(double cardinality) {
+        _commonStats.estimatedCardinality = cardinality;
+    }
+
 protected:
     /**
      * Performs one unit of work.  See comment at work() above.
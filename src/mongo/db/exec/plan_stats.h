@@ -37,6 +37,7 @@
 #include "mongo/db/index/multikey_paths.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/stage_types.h"
+#include "mongo/db/record_id.h"
 #include "mongo/util/container_size_helper.h"
 #include "mongo/util/time_support.h"
 
@@ -99,6 +100,10 @@ struct CommonStats {
     // cache.
     boost::optional<long long> executionTimeMillis;
 
+    // The number of results the cost model expected this stage to produce, if the plan was costed
+    // before it was run.
+    boost::optional<double> estimatedCardinality;
+
     // TODO: have some way of tracking WSM sizes (or really any series of #s).  We can measure
     // the size of our inputs and the size of our outputs.  We can do a lot with the WS here.
 
@@ -249,6 +254,36 @@ struct CollectionScanStats : public SpecificStats {
     // document that does not pass the filter and has a "ts" Timestamp field greater than 'maxTs'.
     // Must only be set on forward oplog scans.
     boost::optional<Timestamp> maxTs;
+
+    // The range of RecordIds read from a clustered collection, both inclusive.
+    boost::optional<RecordId> minRecord;
+    boost::optional<RecordId> maxRecord;
+};
+
+struct ColumnScanStats : public SpecificStats {
+    SpecificStats* clone() const final {
+        ColumnScanStats* specific = new ColumnScanStats(*this);
+        return specific;
+    }
+
+    uint64_t estimateObjectSizeInBytes() const {
+        return container_size_helper::estimateObjectSizeInBytes(
+                   fields,
+                   [](const auto& field) { return field.capacity(); },
+                   true) +
+            indexName.capacity() + sizeof(*this);
+    }
+
+    std::string indexName;
+
+    // The top-level fields whose columns are read.
+    std::vector<std::string> fields;
+
+    // Number of column store index keys read, across all of the columns.
+    size_t keysExamined = 0;
+
+    // How many documents did we check against our filter?
+    size_t docsTested = 0;
 };
 
 struct CountStats : public SpecificStats {
@@ -90,6 +90,27 @@ protected:
         return _vm.runPredicate(compiledExpr);
     }
 
+    /**
+     * Returns the positions of the rows in the block passing the predicate, see
+     * 'vm::ByteCode::runPredicateBlock()'.
+     */
+    std::vector<uint32_t> runCompiledExpressionPredicateBlock(const vm::CodeFragment* compiledExpr,
+                                                              const vm::BlockBindings& bindings,
+                                                              size_t blockSize) {
+        std::vector<uint32_t> selection;
+        _vm.runPredicateBlock(compiledExpr, bindings, blockSize, &selection);
+        return selection;
+    }
+
+    std::pair<value::TypeTags, value::Value> runCompiledExpressionClosures(
+        const vm::ClosureFragment* compiledExpr) {
+        auto [owned, tag, val] = _vm.run(compiledExpr);
+        if (!owned) {
+            return value::copyValue(tag, val);
+        }
+        return {tag, val};
+    }
+
 private:
     value::SlotIdGenerator _slotIdGenerator;
     CoScanStage _emptyStage;
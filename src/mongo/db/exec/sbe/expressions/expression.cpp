@@ -764,6 +764,14 @@ value::SlotId RuntimeEnvironment::getSlot(StringData type) {
     uasserted(4946305, str::stream() << "environment slot is not registered for type: " << type);
 }
 
+boost::optional<value::SlotId> RuntimeEnvironment::getSlotIfExists(StringData type) {
+    if (auto it = _state->slots.find(type); it != _state->slots.end()) {
+        return it->second.first;
+    }
+
+    return boost::none;
+}
+
 void RuntimeEnvironment::resetSlot(value::SlotId slot,
                                    value::TypeTags tag,
                                    value::Value val,
@@ -797,6 +805,30 @@ std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeCopy(bool isSmp) {
     return std::unique_ptr<RuntimeEnvironment>(new RuntimeEnvironment(*this));
 }
 
+std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeDeepCopy() const {
+    invariant(!_isSmp);
+
+    auto env = std::make_unique<RuntimeEnvironment>();
+    env->_state->slots = _state->slots;
+    env->_state->typeTags = _state->typeTags;
+    env->_state->vals = _state->vals;
+    env->_state->owned = _state->owned;
+
+    for (size_t idx = 0; idx < env->_state->vals.size(); ++idx) {
+        if (env->_state->owned[idx]) {
+            auto [tag, val] = value::copyValue(env->_state->typeTags[idx], env->_state->vals[idx]);
+            env->_state->typeTags[idx] = tag;
+            env->_state->vals[idx] = val;
+        }
+    }
+
+    for (auto&& [type, slot] : env->_state->slots) {
+        env->emplaceAccessor(slot.first, slot.second);
+    }
+
+    return env;
+}
+
 void RuntimeEnvironment::debugString(StringBuilder* builder) {
     *builder << "env: { ";
     for (auto&& [type, slot] : _state->slots) {
@@ -831,7 +863,9 @@ void CompileCtx::popCorrelated() {
 }
 
 CompileCtx CompileCtx::makeCopy(bool isSmp) {
-    return {env->makeCopy(isSmp)};
+    CompileCtx copy{env->makeCopy(isSmp)};
+    copy.closureCompilation = closureCompilation;
+    return copy;
 }
 }  // namespace sbe
 }  // namespace mongo
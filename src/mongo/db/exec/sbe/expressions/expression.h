@@ -92,6 +92,12 @@ public:
      */
     value::SlotId getSlot(StringData type);
 
+    /**
+     * Returns a SlotId registered for the given slot 'type', or boost::none if the slot hasn't been
+     * registered yet.
+     */
+    boost::optional<value::SlotId> getSlotIfExists(StringData type);
+
     /**
      * Store the given value in the specified slot within this runtime environment instance.
      *
@@ -118,6 +124,14 @@ public:
      */
     std::unique_ptr<RuntimeEnvironment> makeCopy(bool isSmp);
 
+    /**
+     * Make a fully independent copy of this environment: slot ids are preserved, but the copy gets
+     * its own storage and its own copies of all owned values, so that slots can be reset in either
+     * environment without affecting the other. Only non-parallel environments can be copied this
+     * way.
+     */
+    std::unique_ptr<RuntimeEnvironment> makeDeepCopy() const;
+
     /**
      * Dumps all the slots currently defined in this environment into the given string builder.
      */
@@ -207,6 +221,10 @@ struct CompileCtx {
     stdx::unordered_map<SpoolId, std::shared_ptr<SpoolBuffer>> spoolBuffers;
     bool aggExpression{false};
 
+    // When set, stages evaluating expressions on every row additionally translate their bytecode
+    // into a vm::ClosureFragment and run that instead, if the translation is supported.
+    bool closureCompilation{false};
+
 private:
     // Any data that a PlanStage needs from the RuntimeEnvironment should not be accessed directly
     // but insteady by looking up the corresponding slots. These slots are set up during the process
@@ -853,9 +853,12 @@ void Parser::walkMkObj(AstQuery& ast) {
 void Parser::walkGroup(AstQuery& ast) {
     walkChildren(ast);
 
-    ast.stage = makeS<HashAggStage>(std::move(ast.nodes[2]->stage),
-                                    lookupSlots(std::move(ast.nodes[0]->identifiers)),
-                                    lookupSlots(std::move(ast.nodes[1]->projects)));
+    ast.stage = makeS<HashAggStage>(
+        std::move(ast.nodes[2]->stage),
+        lookupSlots(std::move(ast.nodes[0]->identifiers)),
+        lookupSlots(std::move(ast.nodes[1]->projects)),
+        _memoryLimit,
+        _allowDiskUse);
 }
 
 void Parser::walkHashJoin(AstQuery& ast) {
@@ -866,8 +869,9 @@ void Parser::walkHashJoin(AstQuery& ast) {
                              lookupSlots(ast.nodes[0]->nodes[0]->identifiers),  // outer conditions
                              lookupSlots(ast.nodes[0]->nodes[1]->identifiers),  // outer projections
                              lookupSlots(ast.nodes[1]->nodes[0]->identifiers),  // inner conditions
-                             lookupSlots(ast.nodes[1]->nodes[1]->identifiers)   // inner projections
-        );
+                             lookupSlots(ast.nodes[1]->nodes[1]->identifiers),  // inner projections
+                             _memoryLimit,
+                             _allowDiskUse);
 }
 
 void Parser::walkNLJoin(AstQuery& ast) {
@@ -1460,7 +1464,8 @@ void Parser::walk(AstQuery& ast) {
     }
 }
 
-Parser::Parser() {
+Parser::Parser(bool allowDiskUse, size_t memoryLimit)
+    : _allowDiskUse(allowDiskUse), _memoryLimit(memoryLimit) {
     _parser.log = [&](size_t ln, size_t col, const std::string& msg) {
         LOGV2(4885902, "{msg}", "msg"_attr = format_error_message(ln, col, msg));
     };
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <limits>
+
 #define PEGLIB_USE_STD_ANY 0
 #include <third_party/peglib/peglib.h>
 
@@ -59,7 +61,12 @@ using AstQuery = peg::AstBase<ParsedQueryTree>;
 
 class Parser {
 public:
-    Parser();
+    /**
+     * The 'allowDiskUse' and 'memoryLimit' parameters are passed to the stages which can spill to
+     * disk, that is the hash aggregation and the hash join.
+     */
+    explicit Parser(bool allowDiskUse = false,
+                    size_t memoryLimit = std::numeric_limits<size_t>::max());
     std::unique_ptr<PlanStage> parse(OperationContext* opCtx,
                                      StringData defaultDb,
                                      StringData line);
@@ -73,6 +80,8 @@ private:
     using SymbolTable = stdx::unordered_map<std::string, value::SlotId>;
     using SpoolBufferLookupTable = stdx::unordered_map<std::string, SpoolId>;
     peg::parser _parser;
+    const bool _allowDiskUse;
+    const size_t _memoryLimit;
     OperationContext* _opCtx{nullptr};
     std::string _defaultDb;
     SymbolTable _symbolsLookupTable;
@@ -0,0 +1,241 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for sbe::HashAggStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <map>
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/hash_agg.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/unittest/temp_dir.h"
+
+namespace mongo::sbe {
+
+class HashAggStageTest : public PlanStageTestFixture {
+public:
+    /**
+     * Groups the numbers 0 thru 'numRows' - 1 by their remainder after division by 'numGroups'
+     * and returns a map from each group key to the sum of its numbers. If 'mixKeyTypes' is true,
+     * the keys of the second half of the rows are doubles rather than 64-bit integers.
+     */
+    std::map<int64_t, int64_t> runSumByGroup(int64_t numRows,
+                                             int64_t numGroups,
+                                             size_t memoryLimit,
+                                             bool allowDiskUse,
+                                             HashAggStats* statsOut,
+                                             bool mixKeyTypes = false) {
+        auto [inputTag, inputVal] = value::makeNewArray();
+        value::ValueGuard inputGuard{inputTag, inputVal};
+        auto inputView = value::getArrayView(inputVal);
+        for (int64_t i = 0; i < numRows; ++i) {
+            auto [rowTag, rowVal] = value::makeNewArray();
+            auto rowView = value::getArrayView(rowVal);
+            if (mixKeyTypes && i >= numRows / 2) {
+                rowView->push_back(value::TypeTags::NumberDouble,
+                                   value::bitcastFrom<double>(i % numGroups));
+            } else {
+                rowView->push_back(value::TypeTags::NumberInt64,
+                                   value::bitcastFrom<int64_t>(i % numGroups));
+            }
+            rowView->push_back(value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(i));
+            inputView->push_back(rowTag, rowVal);
+        }
+
+        inputGuard.reset();
+        auto [scanSlots, scanStage] = generateMockScanMulti(2, inputTag, inputVal);
+
+        auto sumSlot = generateSlotId();
+        auto stage = makeS<HashAggStage>(
+            std::move(scanStage),
+            makeSV(scanSlots[0]),
+            makeEM(sumSlot, makeE<EFunction>("sum", makeEs(makeE<EVariable>(scanSlots[1])))),
+            memoryLimit,
+            allowDiskUse);
+
+        auto accessors = prepareTree(stage.get(), makeSV(scanSlots[0], sumSlot));
+
+        std::map<int64_t, int64_t> results;
+        while (stage->getNext() == PlanState::ADVANCED) {
+            auto [keyTag, keyVal] = accessors[0]->getViewOfValue();
+            auto [sumTag, sumVal] = accessors[1]->getViewOfValue();
+            ASSERT_TRUE(keyTag == value::TypeTags::NumberInt64 ||
+                        (mixKeyTypes && keyTag == value::TypeTags::NumberDouble));
+            ASSERT_TRUE(sumTag == value::TypeTags::NumberInt64);
+
+            auto [it, inserted] = results.emplace(value::numericCast<int64_t>(keyTag, keyVal),
+                                                  value::bitcastTo<int64_t>(sumVal));
+            ASSERT_TRUE(inserted);
+        }
+
+        *statsOut = *static_cast<const HashAggStats*>(stage->getSpecificStats());
+        stage->close();
+        return results;
+    }
+
+    void assertSumByGroup(const std::map<int64_t, int64_t>& results,
+                          int64_t numRows,
+                          int64_t numGroups) {
+        ASSERT_EQ(results.size(), static_cast<size_t>(numGroups));
+        for (auto&& [key, sum] : results) {
+            int64_t expected = 0;
+            for (int64_t i = key; i < numRows; i += numGroups) {
+                expected += i;
+            }
+            ASSERT_EQ(sum, expected);
+        }
+    }
+};
+
+TEST_F(HashAggStageTest, GroupsInMemory) {
+    HashAggStats stats;
+    auto results =
+        runSumByGroup(1000, 10, std::numeric_limits<std::size_t>::max(), false, &stats);
+
+    assertSumByGroup(results, 1000, 10);
+    ASSERT_TRUE(stats.usedFixedKeyTable);
+    ASSERT_FALSE(stats.usedDisk);
+    ASSERT_EQ(stats.spilledRecords, 0U);
+}
+
+TEST_F(HashAggStageTest, ReturnsAllGroupsWhenLastRowIsNotInLastGroup) {
+    // The last row, 1004, belongs to group 4, which is neither the first nor the last group
+    // inserted into the table.
+    HashAggStats stats;
+    auto results =
+        runSumByGroup(1005, 10, std::numeric_limits<std::size_t>::max(), false, &stats);
+
+    assertSumByGroup(results, 1005, 10);
+    ASSERT_TRUE(stats.usedFixedKeyTable);
+}
+
+TEST_F(HashAggStageTest, KeysOfMixedTypesMoveGroupsToGenericTable) {
+    // The double keys of the second half of the rows are equal to the integer keys of the first
+    // half, so they must end up in the same groups.
+    HashAggStats stats;
+    auto results = runSumByGroup(
+        1000, 10, std::numeric_limits<std::size_t>::max(), false, &stats, true /* mixKeyTypes */);
+
+    assertSumByGroup(results, 1000, 10);
+    ASSERT_FALSE(stats.usedFixedKeyTable);
+}
+
+TEST_F(HashAggStageTest, KeysOfMixedTypesAfterSpilling) {
+    unittest::TempDir tempDir("sbe_hash_agg_test");
+    storageGlobalParams.dbpath = tempDir.path();
+
+    HashAggStats stats;
+    auto results = runSumByGroup(1000, 100, 1024, true, &stats, true /* mixKeyTypes */);
+
+    assertSumByGroup(results, 1000, 100);
+    ASSERT_TRUE(stats.usedDisk);
+    ASSERT_FALSE(stats.usedFixedKeyTable);
+}
+
+TEST_F(HashAggStageTest, SpillsGroupsWhichDoNotFitInMemory) {
+    unittest::TempDir tempDir("sbe_hash_agg_test");
+    storageGlobalParams.dbpath = tempDir.path();
+
+    // The memory limit only leaves room for a few groups, so the rows of most groups are spilled.
+    HashAggStats stats;
+    auto results = runSumByGroup(1000, 100, 1024, true, &stats);
+
+    assertSumByGroup(results, 1000, 100);
+    ASSERT_TRUE(stats.usedDisk);
+    ASSERT_GT(stats.spilledRecords, 0U);
+    ASSERT_LT(stats.spilledRecords, 1000U);
+    ASSERT_GT(stats.spilledBytes, 0U);
+}
+
+TEST_F(HashAggStageTest, SpillsWhenGroupsInMemoryGrow) {
+    unittest::TempDir tempDir("sbe_hash_agg_test");
+    storageGlobalParams.dbpath = tempDir.path();
+
+    // The first 900 rows belong to two groups, whose arrays outgrow the memory limit. The rows of
+    // the ten groups which only appear afterwards are then spilled.
+    auto [inputTag, inputVal] = value::makeNewArray();
+    value::ValueGuard inputGuard{inputTag, inputVal};
+    auto inputView = value::getArrayView(inputVal);
+    for (int64_t i = 0; i < 1000; ++i) {
+        auto [rowTag, rowVal] = value::makeNewArray();
+        auto rowView = value::getArrayView(rowVal);
+        rowView->push_back(value::TypeTags::NumberInt64,
+                           value::bitcastFrom<int64_t>(i < 900 ? i % 2 : 2 + i % 10));
+        rowView->push_back(value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(i));
+        inputView->push_back(rowTag, rowVal);
+    }
+
+    inputGuard.reset();
+    auto [scanSlots, scanStage] = generateMockScanMulti(2, inputTag, inputVal);
+
+    auto pushSlot = generateSlotId();
+    auto stage = makeS<HashAggStage>(
+        std::move(scanStage),
+        makeSV(scanSlots[0]),
+        makeEM(pushSlot, makeE<EFunction>("addToArray", makeEs(makeE<EVariable>(scanSlots[1])))),
+        4096,
+        true);
+
+    auto accessors = prepareTree(stage.get(), makeSV(scanSlots[0], pushSlot));
+
+    std::map<int64_t, size_t> results;
+    while (stage->getNext() == PlanState::ADVANCED) {
+        auto [keyTag, keyVal] = accessors[0]->getViewOfValue();
+        auto [pushTag, pushVal] = accessors[1]->getViewOfValue();
+        ASSERT_TRUE(keyTag == value::TypeTags::NumberInt64);
+        ASSERT_TRUE(pushTag == value::TypeTags::Array);
+        results.emplace(value::bitcastTo<int64_t>(keyVal), value::getArrayView(pushVal)->size());
+    }
+    auto stats = *static_cast<const HashAggStats*>(stage->getSpecificStats());
+    stage->close();
+
+    ASSERT_EQ(results.size(), 12U);
+    ASSERT_EQ(results[0], 450U);
+    ASSERT_EQ(results[1], 450U);
+    for (int64_t key = 2; key < 12; ++key) {
+        ASSERT_EQ(results[key], 10U);
+    }
+    ASSERT_TRUE(stats.usedDisk);
+    ASSERT_EQ(stats.spilledRecords, 100U);
+}
+
+TEST_F(HashAggStageTest, DoesNotSpillWithoutAllowDiskUse) {
+    HashAggStats stats;
+    auto results = runSumByGroup(1000, 100, 1024, false, &stats);
+
+    assertSumByGroup(results, 1000, 100);
+    ASSERT_FALSE(stats.usedDisk);
+    ASSERT_EQ(stats.spilledRecords, 0U);
+}
+
+}  // namespace mongo::sbe
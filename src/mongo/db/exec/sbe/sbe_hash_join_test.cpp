@@ -0,0 +1,190 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for sbe::HashJoinStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/hash_join.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/unittest/temp_dir.h"
+
+namespace mongo::sbe {
+
+class HashJoinStageTest : public PlanStageTestFixture {
+public:
+    /**
+     * Makes an array of 'numRows' [key, value] pairs in which the key is the row number modulo
+     * 'numKeys' plus 'firstKey' and the value is the row number multiplied by 'valueFactor'.
+     */
+    std::pair<value::TypeTags, value::Value> makeInput(int64_t numRows,
+                                                       int64_t numKeys,
+                                                       int64_t valueFactor,
+                                                       int64_t firstKey = 0) {
+        auto [inputTag, inputVal] = value::makeNewArray();
+        auto inputView = value::getArrayView(inputVal);
+        for (int64_t i = 0; i < numRows; ++i) {
+            auto [rowTag, rowVal] = value::makeNewArray();
+            auto rowView = value::getArrayView(rowVal);
+            rowView->push_back(value::TypeTags::NumberInt64,
+                               value::bitcastFrom<int64_t>(firstKey + i % numKeys));
+            rowView->push_back(value::TypeTags::NumberInt64,
+                               value::bitcastFrom<int64_t>(i * valueFactor));
+            inputView->push_back(rowTag, rowVal);
+        }
+        return {inputTag, inputVal};
+    }
+
+    /**
+     * Joins 1000 outer rows with 'numKeys' distinct keys against 100 inner rows with 100 distinct
+     * keys and verifies that each outer row is joined with the single inner row of the same key.
+     */
+    void runJoinTest(int64_t numKeys,
+                     size_t memoryLimit,
+                     bool allowDiskUse,
+                     HashJoinStats* statsOut) {
+        ASSERT_LTE(numKeys, 100);
+        auto [outerTag, outerVal] = makeInput(1000, numKeys, 1);
+        auto [outerSlots, outerStage] = generateMockScanMulti(2, outerTag, outerVal);
+        auto [innerTag, innerVal] = makeInput(100, 100, 10);
+        auto [innerSlots, innerStage] = generateMockScanMulti(2, innerTag, innerVal);
+
+        auto stage = makeS<HashJoinStage>(std::move(outerStage),
+                                          std::move(innerStage),
+                                          makeSV(outerSlots[0]),
+                                          makeSV(outerSlots[1]),
+                                          makeSV(innerSlots[0]),
+                                          makeSV(innerSlots[1]),
+                                          memoryLimit,
+                                          allowDiskUse);
+
+        auto accessors =
+            prepareTree(stage.get(), makeSV(outerSlots[0], outerSlots[1], innerSlots[1]));
+
+        size_t numResults = 0;
+        while (stage->getNext() == PlanState::ADVANCED) {
+            auto [keyTag, keyVal] = accessors[0]->getViewOfValue();
+            auto [outerValueTag, outerValueVal] = accessors[1]->getViewOfValue();
+            auto [innerValueTag, innerValueVal] = accessors[2]->getViewOfValue();
+            ASSERT_TRUE(keyTag == value::TypeTags::NumberInt64);
+            ASSERT_TRUE(outerValueTag == value::TypeTags::NumberInt64);
+            ASSERT_TRUE(innerValueTag == value::TypeTags::NumberInt64);
+
+            auto key = value::bitcastTo<int64_t>(keyVal);
+            ASSERT_EQ(value::bitcastTo<int64_t>(outerValueVal) % numKeys, key);
+            ASSERT_EQ(value::bitcastTo<int64_t>(innerValueVal), key * 10);
+            ++numResults;
+        }
+        ASSERT_EQ(numResults, 1000U);
+
+        *statsOut = *static_cast<const HashJoinStats*>(stage->getSpecificStats());
+        stage->close();
+    }
+};
+
+TEST_F(HashJoinStageTest, JoinsInMemory) {
+    HashJoinStats stats;
+    runJoinTest(50, std::numeric_limits<std::size_t>::max(), true, &stats);
+
+    ASSERT_FALSE(stats.usedDisk);
+    ASSERT_EQ(stats.spilledBuildRecords, 0U);
+    ASSERT_EQ(stats.spilledProbeRecords, 0U);
+    ASSERT_GT(stats.peakMemoryUsageBytes, 0U);
+}
+
+TEST_F(HashJoinStageTest, SpillsPartitionsWhichDoNotFitInMemory) {
+    unittest::TempDir tempDir("sbe_hash_join_test");
+    storageGlobalParams.dbpath = tempDir.path();
+
+    HashJoinStats stats;
+    runJoinTest(50, 1024, true, &stats);
+
+    ASSERT_TRUE(stats.usedDisk);
+    ASSERT_GT(stats.spilledBuildRecords, 0U);
+    ASSERT_GT(stats.spilledProbeRecords, 0U);
+    ASSERT_GT(stats.spilledBytes, 0U);
+}
+
+TEST_F(HashJoinStageTest, SplitsSpilledPartitionsWhichDoNotFitInMemory) {
+    unittest::TempDir tempDir("sbe_hash_join_test");
+    storageGlobalParams.dbpath = tempDir.path();
+
+    // With 100 keys of 10 rows each, the spilled partitions hold several keys each and exceed the
+    // limit when they are loaded, so their build rows are written to disk again by the split.
+    HashJoinStats stats;
+    runJoinTest(100, 1024, true, &stats);
+
+    ASSERT_TRUE(stats.usedDisk);
+    ASSERT_GT(stats.spilledBuildRecords, 1000U);
+}
+
+TEST_F(HashJoinStageTest, FailsWhenSpilledPartitionCannotBeSplit) {
+    unittest::TempDir tempDir("sbe_hash_join_test");
+    storageGlobalParams.dbpath = tempDir.path();
+
+    // Pick a key which is not kept in memory, so all outer rows end up in one spilled partition
+    // which exceeds the limit and cannot be split because all of its rows share the key.
+    int64_t key = 0;
+    for (;; ++key) {
+        value::MaterializedRow row{1};
+        row.reset(0, false, value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(key));
+        if (value::MaterializedRowHasher{}(row) % HashJoinStage::kNumPartitions != 0) {
+            break;
+        }
+    }
+
+    auto [outerTag, outerVal] = makeInput(1000, 1, 1, key);
+    auto [outerSlots, outerStage] = generateMockScanMulti(2, outerTag, outerVal);
+    auto [innerTag, innerVal] = makeInput(1, 1, 10, key);
+    auto [innerSlots, innerStage] = generateMockScanMulti(2, innerTag, innerVal);
+
+    auto stage = makeS<HashJoinStage>(std::move(outerStage),
+                                      std::move(innerStage),
+                                      makeSV(outerSlots[0]),
+                                      makeSV(outerSlots[1]),
+                                      makeSV(innerSlots[0]),
+                                      makeSV(innerSlots[1]),
+                                      1024,
+                                      true /* allowDiskUse */);
+    prepareTree(stage.get(), makeSV(outerSlots[0]));
+
+    ASSERT_THROWS_CODE(
+        [&] {
+            while (stage->getNext() == PlanState::ADVANCED) {
+            }
+        }(),
+        DBException,
+        5095439);
+    stage->close();
+}
+
+}  // namespace mongo::sbe
@@ -27,6 +27,7 @@
  *    it in the license file.
  */
 
+#include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 #include "mongo/unittest/unittest.h"
@@ -199,4 +200,40 @@ TEST(SBEVM, Add) {
     }
 }
 
+TEST(SBERuntimeEnvironment, DeepCopyCanBeResetIndependently) {
+    using namespace std::literals;
+    value::SlotIdGenerator slotIdGenerator;
+    RuntimeEnvironment env;
+
+    auto [strTag, strVal] = value::makeNewString("a string which is not small"sv);
+    auto strSlot = env.registerSlot("str"_sd, strTag, strVal, true, &slotIdGenerator);
+    auto intSlot = env.registerSlot("int"_sd,
+                                    value::TypeTags::NumberInt32,
+                                    value::bitcastFrom<int32_t>(1),
+                                    false,
+                                    &slotIdGenerator);
+
+    auto copy = env.makeDeepCopy();
+    ASSERT_EQ(strSlot, copy->getSlot("str"_sd));
+    ASSERT_EQ(intSlot, copy->getSlot("int"_sd));
+    ASSERT_FALSE(copy->getSlotIfExists("missing"_sd));
+
+    // Owned values are copied rather than shared.
+    auto [copyTag, copyVal] = copy->getAccessor(strSlot)->getViewOfValue();
+    ASSERT_EQ(strTag, copyTag);
+    ASSERT_NE(strVal, copyVal);
+    ASSERT_EQ("a string which is not small"sv, value::getStringView(copyTag, copyVal));
+
+    // Resetting a slot in the copy leaves the original environment alone, and vice versa.
+    copy->resetSlot(intSlot, value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(2), false);
+    env.resetSlot(strSlot, value::TypeTags::Nothing, 0, false);
+
+    auto [intTag, intVal] = env.getAccessor(intSlot)->getViewOfValue();
+    ASSERT_EQ(1, value::bitcastTo<int32_t>(intVal));
+    std::tie(intTag, intVal) = copy->getAccessor(intSlot)->getViewOfValue();
+    ASSERT_EQ(2, value::bitcastTo<int32_t>(intVal));
+    std::tie(copyTag, copyVal) = copy->getAccessor(strSlot)->getViewOfValue();
+    ASSERT_EQ("a string which is not small"sv, value::getStringView(copyTag, copyVal));
+}
+
 }  // namespace mongo::sbe
@@ -0,0 +1,155 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/exec/sbe/expression_test_base.h"
+
+namespace mongo::sbe {
+
+/**
+ * Checks that evaluating a predicate over a block of rows selects exactly the rows for which the
+ * row-at-a-time evaluation returns true.
+ */
+class SBEVMBlockTest : public EExpressionTestFixture {
+protected:
+    SBEVMBlockTest() : _xSlot{bindAccessor(&_xAccessor)}, _ySlot{bindAccessor(&_yAccessor)} {
+        auto [decTag, decVal] = value::makeCopyDecimal(Decimal128{20});
+        auto [strTag, strVal] = value::makeNewString("a string too long to be stored inline");
+        auto [shortTag, shortVal] = value::makeSmallString("abc");
+        _ownedValues = {{decTag, decVal}, {strTag, strVal}};
+
+        addRow(value::TypeTags::NumberInt32, 1, shortTag, shortVal);
+        addRow(value::TypeTags::NumberInt64, 150, value::TypeTags::Nothing, 0);
+        addRow(value::TypeTags::NumberDouble, value::bitcastFrom(12.5), strTag, strVal);
+        addRow(decTag, decVal, shortTag, shortVal);
+        addRow(value::TypeTags::Nothing, 0, value::TypeTags::Null, 0);
+        addRow(value::TypeTags::Null, 0, value::TypeTags::NumberInt32, 7);
+        addRow(strTag, strVal, value::TypeTags::Boolean, value::bitcastFrom(true));
+        addRow(value::TypeTags::NumberInt32, 99, shortTag, shortVal);
+        addRow(value::TypeTags::NumberInt32, 100, value::TypeTags::Nothing, 0);
+        addRow(value::TypeTags::NumberInt64, -5, value::TypeTags::NumberInt32, 7);
+    }
+
+    ~SBEVMBlockTest() {
+        for (auto [tag, val] : _ownedValues) {
+            value::releaseValue(tag, val);
+        }
+    }
+
+    std::unique_ptr<EExpression> x() const {
+        return makeE<EVariable>(_xSlot);
+    }
+
+    std::unique_ptr<EExpression> y() const {
+        return makeE<EVariable>(_ySlot);
+    }
+
+    std::unique_ptr<EExpression> int32(int32_t i) const {
+        return makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom(i));
+    }
+
+    void assertBlockMatchesRows(const EExpression& expr) {
+        auto code = compileExpression(expr);
+
+        std::vector<uint32_t> expected;
+        for (uint32_t row = 0; row < _xTags.size(); ++row) {
+            _xAccessor.reset(_xTags[row], _xVals[row]);
+            _yAccessor.reset(_yTags[row], _yVals[row]);
+            if (runCompiledExpressionPredicate(code.get())) {
+                expected.push_back(row);
+            }
+        }
+
+        vm::BlockBindings bindings{{&_xAccessor, {_xTags.data(), _xVals.data()}},
+                                   {&_yAccessor, {_yTags.data(), _yVals.data()}}};
+        ASSERT(expected ==
+               runCompiledExpressionPredicateBlock(code.get(), bindings, _xTags.size()));
+
+        // A block covering only a prefix of the rows must select the same prefix of the result.
+        auto prefix = runCompiledExpressionPredicateBlock(code.get(), bindings, 5);
+        expected.erase(std::lower_bound(expected.begin(), expected.end(), 5), expected.end());
+        ASSERT(expected == prefix);
+    }
+
+private:
+    void addRow(value::TypeTags xTag, value::Value xVal, value::TypeTags yTag, value::Value yVal) {
+        _xTags.push_back(xTag);
+        _xVals.push_back(xVal);
+        _yTags.push_back(yTag);
+        _yVals.push_back(yVal);
+    }
+
+    value::ViewOfValueAccessor _xAccessor;
+    value::ViewOfValueAccessor _yAccessor;
+    const value::SlotId _xSlot;
+    const value::SlotId _ySlot;
+
+    std::vector<value::TypeTags> _xTags;
+    std::vector<value::Value> _xVals;
+    std::vector<value::TypeTags> _yTags;
+    std::vector<value::Value> _yVals;
+    std::vector<std::pair<value::TypeTags, value::Value>> _ownedValues;
+};
+
+TEST_F(SBEVMBlockTest, Comparison) {
+    assertBlockMatchesRows(*makeE<EPrimBinary>(EPrimBinary::less, x(), int32(100)));
+    assertBlockMatchesRows(*makeE<EPrimBinary>(EPrimBinary::greaterEq, x(), int32(99)));
+    assertBlockMatchesRows(*makeE<EPrimBinary>(EPrimBinary::eq, y(), y()));
+}
+
+TEST_F(SBEVMBlockTest, LogicalOperatorsSplitTheBlock) {
+    assertBlockMatchesRows(
+        *makeE<EPrimBinary>(EPrimBinary::logicAnd,
+                            makeE<EPrimBinary>(EPrimBinary::greaterEq, x(), int32(10)),
+                            makeE<EPrimBinary>(EPrimBinary::less, x(), int32(1000))));
+    auto greaterOrMissing = makeE<EFunction>(
+        "fillEmpty",
+        makeEs(makeE<EPrimBinary>(EPrimBinary::greater, x(), int32(5)),
+               makeE<EConstant>(value::TypeTags::Boolean, value::bitcastFrom(true))));
+    assertBlockMatchesRows(*makeE<EPrimBinary>(EPrimBinary::logicOr,
+                                               std::move(greaterOrMissing),
+                                               makeE<EFunction>("exists", makeEs(y()))));
+    assertBlockMatchesRows(*makeE<EPrimUnary>(
+        EPrimUnary::logicNot, makeE<EPrimBinary>(EPrimBinary::eq, y(), int32(7))));
+}
+
+TEST_F(SBEVMBlockTest, ConditionalWithOwnedValues) {
+    // Adding to the Decimal128 row produces an owned value which has to be released.
+    assertBlockMatchesRows(*makeE<EIf>(
+        makeE<EFunction>("isNumber", makeEs(x())),
+        makeE<EPrimBinary>(EPrimBinary::greater,
+                           makeE<EPrimBinary>(EPrimBinary::add, x(), int32(1)),
+                           int32(15)),
+        makeE<EFunction>("isString", makeEs(y()))));
+}
+
+TEST_F(SBEVMBlockTest, BuiltinFunctionCalls) {
+    assertBlockMatchesRows(*makeE<EPrimBinary>(
+        EPrimBinary::greater, makeE<EFunction>("abs", makeEs(x())), int32(10)));
+}
+}  // namespace mongo::sbe
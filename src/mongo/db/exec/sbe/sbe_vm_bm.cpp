@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/stages/co_scan.h"
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+namespace mongo::sbe {
+namespace {
+
+constexpr size_t kNumRows = 64 * 1024;
+
+enum class Predicate { kLess, kRange, kFillEmpty };
+
+/**
+ * Holds a column of 'kNumRows' random integers, a tenth of which are missing, and a compiled
+ * predicate reading the column through 'accessor'.
+ */
+struct PredicateFixture {
+    explicit PredicateFixture(Predicate predicate)
+        : ctx{std::make_unique<RuntimeEnvironment>()}, tags(kNumRows), vals(kNumRows) {
+        std::mt19937 gen(1234);
+        for (size_t row = 0; row < kNumRows; ++row) {
+            auto number = gen() % 2000;
+            tags[row] = number < 200 ? value::TypeTags::Nothing : value::TypeTags::NumberInt32;
+            vals[row] = value::bitcastFrom<int32_t>(number);
+        }
+
+        ctx.root = &emptyStage;
+        value::SlotId slot = 1;
+        ctx.pushCorrelated(slot, &accessor);
+
+        auto x = [&] { return makeE<EVariable>(slot); };
+        auto int32 = [](int32_t i) {
+            return makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom(i));
+        };
+
+        std::unique_ptr<EExpression> expr;
+        switch (predicate) {
+            case Predicate::kLess:
+                expr = makeE<EPrimBinary>(EPrimBinary::less, x(), int32(100));
+                break;
+            case Predicate::kRange:
+                expr = makeE<EPrimBinary>(
+                    EPrimBinary::logicAnd,
+                    makeE<EPrimBinary>(EPrimBinary::greaterEq, x(), int32(10)),
+                    makeE<EPrimBinary>(EPrimBinary::less, x(), int32(1000)));
+                break;
+            case Predicate::kFillEmpty:
+                expr = makeE<EFunction>(
+                    "fillEmpty",
+                    makeEs(makeE<EPrimBinary>(EPrimBinary::greater, x(), int32(1500)),
+                           makeE<EConstant>(value::TypeTags::Boolean, value::bitcastFrom(false))));
+                break;
+        }
+        code = expr->compile(ctx);
+    }
+
+    CoScanStage emptyStage;
+    CompileCtx ctx;
+    value::ViewOfValueAccessor accessor;
+    std::unique_ptr<vm::CodeFragment> code;
+    std::vector<value::TypeTags> tags;
+    std::vector<value::Value> vals;
+};
+
+void BM_RunPredicateRowAtATime(benchmark::State& state, Predicate predicate) {
+    PredicateFixture fixture(predicate);
+    vm::ByteCode vm;
+
+    for (auto _ : state) {
+        size_t selected = 0;
+        for (size_t row = 0; row < kNumRows; ++row) {
+            fixture.accessor.reset(fixture.tags[row], fixture.vals[row]);
+            selected += vm.runPredicate(fixture.code.get());
+        }
+        benchmark::DoNotOptimize(selected);
+    }
+    state.SetItemsProcessed(state.iterations() * kNumRows);
+}
+
+void BM_RunPredicateBlock(benchmark::State& state, Predicate predicate) {
+    PredicateFixture fixture(predicate);
+    vm::ByteCode vm;
+    const size_t blockSize = state.range(0);
+    std::vector<uint32_t> selection;
+    selection.reserve(blockSize);
+
+    for (auto _ : state) {
+        size_t selected = 0;
+        for (size_t begin = 0; begin < kNumRows; begin += blockSize) {
+            vm::BlockBindings bindings{
+                {&fixture.accessor, {&fixture.tags[begin], &fixture.vals[begin]}}};
+            selection.clear();
+            vm.runPredicateBlock(
+                fixture.code.get(), bindings, std::min(blockSize, kNumRows - begin), &selection);
+            selected += selection.size();
+        }
+        benchmark::DoNotOptimize(selected);
+    }
+    state.SetItemsProcessed(state.iterations() * kNumRows);
+}
+
+void BM_RunPredicateClosures(benchmark::State& state, Predicate predicate) {
+    PredicateFixture fixture(predicate);
+    auto closures = vm::ClosureFragment::compile(fixture.code.get());
+    invariant(closures);
+    vm::ByteCode vm;
+
+    for (auto _ : state) {
+        size_t selected = 0;
+        for (size_t row = 0; row < kNumRows; ++row) {
+            fixture.accessor.reset(fixture.tags[row], fixture.vals[row]);
+            selected += vm.runPredicate(closures.get());
+        }
+        benchmark::DoNotOptimize(selected);
+    }
+    state.SetItemsProcessed(state.iterations() * kNumRows);
+}
+
+BENCHMARK_CAPTURE(BM_RunPredicateRowAtATime, Less, Predicate::kLess);
+BENCHMARK_CAPTURE(BM_RunPredicateRowAtATime, Range, Predicate::kRange);
+BENCHMARK_CAPTURE(BM_RunPredicateRowAtATime, FillEmpty, Predicate::kFillEmpty);
+
+BENCHMARK_CAPTURE(BM_RunPredicateClosures, Less, Predicate::kLess);
+BENCHMARK_CAPTURE(BM_RunPredicateClosures, Range, Predicate::kRange);
+BENCHMARK_CAPTURE(BM_RunPredicateClosures, FillEmpty, Predicate::kFillEmpty);
+
+BENCHMARK_CAPTURE(BM_RunPredicateBlock, Less, Predicate::kLess)->Arg(128)->Arg(1024)->Arg(8192);
+BENCHMARK_CAPTURE(BM_RunPredicateBlock, Range, Predicate::kRange)->Arg(128)->Arg(1024)->Arg(8192);
+BENCHMARK_CAPTURE(BM_RunPredicateBlock, FillEmpty, Predicate::kFillEmpty)
+    ->Arg(128)
+    ->Arg(1024)
+    ->Arg(8192);
+
+}  // namespace
+}  // namespace mongo::sbe
@@ -0,0 +1,160 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/exec/sbe/expression_test_base.h"
+
+namespace mongo::sbe {
+
+/**
+ * Checks that running an expression translated into a vm::ClosureFragment produces the same
+ * results as interpreting its bytecode.
+ */
+class SBEVMClosureTest : public EExpressionTestFixture {
+protected:
+    SBEVMClosureTest() : _xSlot{bindAccessor(&_xAccessor)}, _ySlot{bindAccessor(&_yAccessor)} {
+        auto [decTag, decVal] = value::makeCopyDecimal(Decimal128{20});
+        auto [strTag, strVal] = value::makeNewString("a string too long to be stored inline");
+        auto [shortTag, shortVal] = value::makeSmallString("abc");
+        _ownedValues = {{decTag, decVal}, {strTag, strVal}};
+
+        addRow(value::TypeTags::NumberInt32, 1, shortTag, shortVal);
+        addRow(value::TypeTags::NumberInt64, 150, value::TypeTags::Nothing, 0);
+        addRow(value::TypeTags::NumberDouble, value::bitcastFrom(12.5), strTag, strVal);
+        addRow(decTag, decVal, shortTag, shortVal);
+        addRow(value::TypeTags::Nothing, 0, value::TypeTags::Null, 0);
+        addRow(value::TypeTags::Null, 0, value::TypeTags::NumberInt32, 7);
+        addRow(strTag, strVal, value::TypeTags::Boolean, value::bitcastFrom(true));
+        addRow(value::TypeTags::NumberInt32, 100, value::TypeTags::NumberInt64, 100);
+        addRow(value::TypeTags::NumberInt64, -5, value::TypeTags::NumberInt32, 7);
+    }
+
+    ~SBEVMClosureTest() {
+        for (auto [tag, val] : _ownedValues) {
+            value::releaseValue(tag, val);
+        }
+    }
+
+    std::unique_ptr<EExpression> x() const {
+        return makeE<EVariable>(_xSlot);
+    }
+
+    std::unique_ptr<EExpression> y() const {
+        return makeE<EVariable>(_ySlot);
+    }
+
+    std::unique_ptr<EExpression> int32(int32_t i) const {
+        return makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom(i));
+    }
+
+    void assertClosuresMatchBytecode(const EExpression& expr) {
+        auto code = compileExpression(expr);
+        auto closures = vm::ClosureFragment::compile(code.get());
+        ASSERT(closures);
+
+        for (size_t row = 0; row < _rows.size(); ++row) {
+            auto [xTag, xVal, yTag, yVal] = _rows[row];
+            _xAccessor.reset(xTag, xVal);
+            _yAccessor.reset(yTag, yVal);
+
+            auto [expectedTag, expectedVal] = runCompiledExpression(code.get());
+            value::ValueGuard expectedGuard{expectedTag, expectedVal};
+            auto [tag, val] = runCompiledExpressionClosures(closures.get());
+            value::ValueGuard guard{tag, val};
+
+            ASSERT_EQ(expectedTag, tag) << "row " << row;
+            if (expectedTag != value::TypeTags::Nothing) {
+                auto [cmpTag, cmpVal] = value::compareValue(expectedTag, expectedVal, tag, val);
+                ASSERT_EQ(cmpTag, value::TypeTags::NumberInt32) << "row " << row;
+                ASSERT_EQ(value::bitcastTo<int32_t>(cmpVal), 0) << "row " << row;
+            }
+        }
+    }
+
+private:
+    void addRow(value::TypeTags xTag, value::Value xVal, value::TypeTags yTag, value::Value yVal) {
+        _rows.push_back({xTag, xVal, yTag, yVal});
+    }
+
+    value::ViewOfValueAccessor _xAccessor;
+    value::ViewOfValueAccessor _yAccessor;
+    const value::SlotId _xSlot;
+    const value::SlotId _ySlot;
+
+    std::vector<std::tuple<value::TypeTags, value::Value, value::TypeTags, value::Value>> _rows;
+    std::vector<std::pair<value::TypeTags, value::Value>> _ownedValues;
+};
+
+TEST_F(SBEVMClosureTest, Comparison) {
+    assertClosuresMatchBytecode(*makeE<EPrimBinary>(EPrimBinary::less, x(), int32(100)));
+    assertClosuresMatchBytecode(*makeE<EPrimBinary>(EPrimBinary::greaterEq, x(), int32(100)));
+    assertClosuresMatchBytecode(*makeE<EPrimBinary>(EPrimBinary::eq, x(), y()));
+    assertClosuresMatchBytecode(*makeE<EPrimBinary>(EPrimBinary::neq, y(), int32(7)));
+    assertClosuresMatchBytecode(*makeE<EPrimBinary>(EPrimBinary::cmp3w, x(), y()));
+}
+
+TEST_F(SBEVMClosureTest, Arithmetic) {
+    assertClosuresMatchBytecode(*makeE<EPrimBinary>(EPrimBinary::add, x(), y()));
+    assertClosuresMatchBytecode(*makeE<EPrimBinary>(
+        EPrimBinary::mul, makeE<EPrimBinary>(EPrimBinary::sub, x(), int32(1)), int32(3)));
+    assertClosuresMatchBytecode(*makeE<EPrimUnary>(EPrimUnary::negate, x()));
+}
+
+TEST_F(SBEVMClosureTest, LogicalOperatorsAndConditionals) {
+    assertClosuresMatchBytecode(
+        *makeE<EPrimBinary>(EPrimBinary::logicAnd,
+                            makeE<EPrimBinary>(EPrimBinary::greaterEq, x(), int32(10)),
+                            makeE<EPrimBinary>(EPrimBinary::less, x(), int32(1000))));
+    auto greaterOrMissing = makeE<EFunction>(
+        "fillEmpty",
+        makeEs(makeE<EPrimBinary>(EPrimBinary::greater, x(), int32(5)),
+               makeE<EConstant>(value::TypeTags::Boolean, value::bitcastFrom(true))));
+    assertClosuresMatchBytecode(*makeE<EPrimBinary>(EPrimBinary::logicOr,
+                                                    std::move(greaterOrMissing),
+                                                    makeE<EFunction>("exists", makeEs(y()))));
+    assertClosuresMatchBytecode(*makeE<EPrimUnary>(
+        EPrimUnary::logicNot, makeE<EPrimBinary>(EPrimBinary::eq, y(), int32(7))));
+    assertClosuresMatchBytecode(
+        *makeE<EIf>(makeE<EFunction>("isNumber", makeEs(x())), y(), int32(-1)));
+}
+
+TEST_F(SBEVMClosureTest, BuiltinFunctionCalls) {
+    assertClosuresMatchBytecode(*makeE<EFunction>("isString", makeEs(y())));
+    assertClosuresMatchBytecode(*makeE<EFunction>("abs", makeEs(x())));
+    assertClosuresMatchBytecode(*makeE<EFunction>("coerceToString", makeEs(x())));
+}
+
+TEST_F(SBEVMClosureTest, AggregatesAreLeftToTheInterpreter) {
+    value::OwnedValueAccessor accumulator;
+    vm::CodeFragment code;
+    code.appendAccessVal(&accumulator);
+    code.appendConstVal(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(1));
+    code.appendSum();
+    ASSERT_FALSE(vm::ClosureFragment::compile(&code));
+}
+}  // namespace mongo::sbe
@@ -0,0 +1,249 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/stages/column_scan.h"
+
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/repl/replication_coordinator.h"
+
+namespace mongo::sbe {
+ColumnScanStage::ColumnScanStage(const NamespaceStringOrUUID& name,
+                                 std::string_view indexName,
+                                 std::vector<std::string> fields,
+                                 boost::optional<value::SlotId> recordSlot,
+                                 boost::optional<value::SlotId> recordIdSlot,
+                                 PlanYieldPolicy* yieldPolicy,
+                                 TrialRunProgressTracker* tracker)
+    : PlanStage("columnscan"_sd, yieldPolicy),
+      _name(name),
+      _indexName(indexName),
+      _fields(std::move(fields)),
+      _recordSlot(recordSlot),
+      _recordIdSlot(recordIdSlot),
+      _tracker(tracker) {
+    _specificStats.indexName = _indexName;
+    _specificStats.fields = _fields;
+}
+
+std::unique_ptr<PlanStage> ColumnScanStage::clone() const {
+    return std::make_unique<ColumnScanStage>(
+        _name, _indexName, _fields, _recordSlot, _recordIdSlot, _yieldPolicy, _tracker);
+}
+
+void ColumnScanStage::prepare(CompileCtx& ctx) {
+    if (_recordSlot) {
+        _recordAccessor = std::make_unique<value::ViewOfValueAccessor>();
+    }
+
+    if (_recordIdSlot) {
+        _recordIdAccessor = std::make_unique<value::ViewOfValueAccessor>();
+    }
+}
+
+value::SlotAccessor* ColumnScanStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (_recordSlot && *_recordSlot == slot) {
+        return _recordAccessor.get();
+    }
+
+    if (_recordIdSlot && *_recordIdSlot == slot) {
+        return _recordIdAccessor.get();
+    }
+
+    return ctx.getAccessor(slot);
+}
+
+void ColumnScanStage::doSaveState() {
+    if (_cursor) {
+        _cursor->save();
+    }
+
+    _coll.reset();
+}
+
+void ColumnScanStage::doRestoreState() {
+    invariant(_opCtx);
+    invariant(!_coll);
+
+    // If this stage is not currently open, then there is nothing to restore.
+    if (!_open) {
+        return;
+    }
+
+    _coll.emplace(_opCtx, _name);
+
+    uassertStatusOK(repl::ReplicationCoordinator::get(_opCtx)->checkCanServeReadsFor(
+        _opCtx, _coll->getNss(), true));
+
+    if (_cursor) {
+        // The cursor holds the access method of the index, which goes away with the index.
+        auto entry = _weakIndexCatalogEntry.lock();
+        uassert(ErrorCodes::QueryPlanKilled,
+                str::stream() << "query plan killed :: index '" << _indexName << "' dropped",
+                entry && !entry->isDropped());
+        _cursor->restore();
+    }
+}
+
+void ColumnScanStage::doDetachFromOperationContext() {
+    if (_cursor) {
+        _cursor->detachFromOperationContext();
+    }
+}
+
+void ColumnScanStage::doAttachFromOperationContext(OperationContext* opCtx) {
+    if (_cursor) {
+        _cursor->reattachToOperationContext(opCtx);
+    }
+}
+
+void ColumnScanStage::doRebindTrialRunProgressTracker(TrialRunProgressTracker* tracker) {
+    if (_tracker) {
+        _tracker = tracker;
+    }
+}
+
+void ColumnScanStage::open(bool reOpen) {
+    _commonStats.opens++;
+
+    invariant(_opCtx);
+    if (!reOpen) {
+        invariant(!_cursor);
+        invariant(!_coll);
+        _coll.emplace(_opCtx, _name);
+
+        uassertStatusOK(repl::ReplicationCoordinator::get(_opCtx)->checkCanServeReadsFor(
+            _opCtx, _coll->getNss(), true));
+    } else {
+        invariant(_coll);
+    }
+
+    _open = true;
+    _cursor.reset();
+    _row.reset();
+
+    if (auto collection = _coll->getCollection()) {
+        auto indexCatalog = collection->getIndexCatalog();
+        auto indexDesc = indexCatalog->findIndexByName(_opCtx, _indexName);
+        if (indexDesc) {
+            _weakIndexCatalogEntry = indexCatalog->getEntryShared(indexDesc);
+        }
+
+        if (auto entry = _weakIndexCatalogEntry.lock()) {
+            _cursor = static_cast<const ColumnStoreAccessMethod*>(entry->accessMethod())
+                          ->newRowCursor(_opCtx, _fields);
+        }
+    }
+}
+
+PlanState ColumnScanStage::getNext() {
+    if (!_cursor) {
+        return trackPlanState(PlanState::IS_EOF);
+    }
+
+    checkForInterrupt(_opCtx);
+
+    _row = _cursor->next();
+    _specificStats.keysExamined = _cursor->keysExamined();
+    if (!_row) {
+        return trackPlanState(PlanState::IS_EOF);
+    }
+
+    if (_recordAccessor) {
+        _recordAccessor->reset(value::TypeTags::bsonObject,
+                               value::bitcastFrom<const char*>(_row->obj.objdata()));
+    }
+
+    if (_recordIdAccessor) {
+        _recordIdAccessor->reset(value::TypeTags::NumberInt64,
+                                 value::bitcastFrom<int64_t>(_row->recordId.repr()));
+    }
+
+    if (_tracker && _tracker->trackProgress<TrialRunProgressTracker::kNumReads>(1)) {
+        // If we're collecting execution stats during multi-planning and reached the end of the
+        // trial period, then we can reset the tracker.
+        _tracker = nullptr;
+    }
+    ++_specificStats.docsTested;
+    return trackPlanState(PlanState::ADVANCED);
+}
+
+void ColumnScanStage::close() {
+    _commonStats.closes++;
+
+    _cursor.reset();
+    _row.reset();
+    _coll.reset();
+    _open = false;
+}
+
+std::unique_ptr<PlanStageStats> ColumnScanStage::getStats() const {
+    auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<ColumnScanStats>(_specificStats);
+    return ret;
+}
+
+const SpecificStats* ColumnScanStage::getSpecificStats() const {
+    return &_specificStats;
+}
+
+std::vector<DebugPrinter::Block> ColumnScanStage::debugPrint() const {
+    std::vector<DebugPrinter::Block> ret;
+    DebugPrinter::addKeyword(ret, "columnscan");
+
+    if (_recordSlot) {
+        DebugPrinter::addIdentifier(ret, _recordSlot.get());
+    }
+
+    if (_recordIdSlot) {
+        DebugPrinter::addIdentifier(ret, _recordIdSlot.get());
+    }
+
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    for (size_t idx = 0; idx < _fields.size(); ++idx) {
+        if (idx) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+        DebugPrinter::addIdentifier(ret, _fields[idx]);
+    }
+    ret.emplace_back(DebugPrinter::Block("`]"));
+
+    ret.emplace_back("@\"`");
+    DebugPrinter::addIdentifier(ret, _name.toString());
+    ret.emplace_back("`\"");
+
+    ret.emplace_back("@\"`");
+    DebugPrinter::addIdentifier(ret, _indexName);
+    ret.emplace_back("`\"");
+
+    return ret;
+}
+}  // namespace mongo::sbe
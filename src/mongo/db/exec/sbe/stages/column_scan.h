@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/exec/trial_run_progress_tracker.h"
+#include "mongo/db/index/column_store_access_method.h"
+
+namespace mongo::sbe {
+
+/**
+ * A stage that reads the documents of a collection from its column store index 'indexName',
+ * restricted to the top-level 'fields'. Only the columns of those fields are read.
+ *
+ * The "output" slots are
+ *   - 'recordSlot': the document, holding only the requested fields, and
+ *   - 'recordIdSlot': the record id of the document.
+ */
+class ColumnScanStage final : public PlanStage {
+public:
+    ColumnScanStage(const NamespaceStringOrUUID& name,
+                    std::string_view indexName,
+                    std::vector<std::string> fields,
+                    boost::optional<value::SlotId> recordSlot,
+                    boost::optional<value::SlotId> recordIdSlot,
+                    PlanYieldPolicy* yieldPolicy,
+                    TrialRunProgressTracker* tracker);
+
+    std::unique_ptr<PlanStage> clone() const final;
+
+    void prepare(CompileCtx& ctx) final;
+    value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final;
+    void open(bool reOpen) final;
+    PlanState getNext() final;
+    void close() final;
+
+    std::unique_ptr<PlanStageStats> getStats() const final;
+    const SpecificStats* getSpecificStats() const final;
+    std::vector<DebugPrinter::Block> debugPrint() const final;
+
+protected:
+    void doSaveState() override;
+    void doRestoreState() override;
+    void doDetachFromOperationContext() override;
+    void doAttachFromOperationContext(OperationContext* opCtx) override;
+    void doRebindTrialRunProgressTracker(TrialRunProgressTracker* tracker) override;
+
+private:
+    const NamespaceStringOrUUID _name;
+    const std::string _indexName;
+    const std::vector<std::string> _fields;
+    const boost::optional<value::SlotId> _recordSlot;
+    const boost::optional<value::SlotId> _recordIdSlot;
+
+    std::unique_ptr<value::ViewOfValueAccessor> _recordAccessor;
+    std::unique_ptr<value::ViewOfValueAccessor> _recordIdAccessor;
+
+    std::unique_ptr<ColumnStoreAccessMethod::RowCursor> _cursor;
+    std::weak_ptr<const IndexCatalogEntry> _weakIndexCatalogEntry;
+    boost::optional<AutoGetCollectionForRead> _coll;
+
+    // The document the record slot points into.
+    boost::optional<ColumnStoreAccessMethod::RowCursor::Row> _row;
+
+    bool _open{false};
+    ColumnScanStats _specificStats;
+
+    // If provided, used during a trial run to accumulate certain execution stats. Once the trial
+    // run is complete, this pointer is reset to nullptr.
+    TrialRunProgressTracker* _tracker{nullptr};
+};
+}  // namespace mongo::sbe
@@ -362,7 +362,10 @@ void ExchangeConsumer::close() {
 
 std::unique_ptr<PlanStageStats> ExchangeConsumer::getStats() const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
-    ret->children.emplace_back(_children[0]->getStats());
+    // Once the consumer has been opened its subtree is owned by the producers.
+    if (!_children.empty()) {
+        ret->children.emplace_back(_children[0]->getStats());
+    }
     return ret;
 }
 
@@ -55,11 +55,22 @@ public:
         return std::make_unique<FilterStage>(_children[0]->clone(), _filter->clone());
     }
 
+    const PlanStage* getInput() const {
+        return _children[0].get();
+    }
+
+    const EExpression* getFilter() const {
+        return _filter.get();
+    }
+
     void prepare(CompileCtx& ctx) final {
         _children[0]->prepare(ctx);
 
         ctx.root = this;
         _filterCode = _filter->compile(ctx);
+        if (ctx.closureCompilation) {
+            _filterClosures = vm::ClosureFragment::compile(_filterCode.get());
+        }
     }
 
     value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final {
@@ -72,7 +83,7 @@ public:
         if constexpr (IsConst) {
             _specificStats.numTested++;
 
-            auto pass = _bytecode.runPredicate(_filterCode.get());
+            auto pass = runPredicate();
             if (!pass) {
                 close();
                 return;
@@ -101,7 +112,7 @@ public:
             if (state == PlanState::ADVANCED) {
                 _specificStats.numTested++;
 
-                pass = _bytecode.runPredicate(_filterCode.get());
+                pass = runPredicate();
 
                 if constexpr (IsEof) {
                     if (!pass) {
@@ -156,8 +167,14 @@ public:
     }
 
 private:
+    bool runPredicate() {
+        return _filterClosures ? _bytecode.runPredicate(_filterClosures.get())
+                               : _bytecode.runPredicate(_filterCode.get());
+    }
+
     const std::unique_ptr<EExpression> _filter;
     std::unique_ptr<vm::CodeFragment> _filterCode;
+    std::unique_ptr<vm::ClosureFragment> _filterClosures;
 
     vm::ByteCode _bytecode;
 
@@ -31,23 +31,95 @@
 
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 
+#include <algorithm>
+
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashAggFileCounter;
+    return "extsort-hash-agg-sbe." + std::to_string(hashAggFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
+namespace {
+/**
+ * Returns the number of elements of 'tag'/'val' if it is an array or a set, such as the aggregates
+ * built by $push and $addToSet, or boost::none otherwise.
+ */
+boost::optional<size_t> getNumElements(value::TypeTags tag, value::Value val) {
+    if (tag == value::TypeTags::Array) {
+        return value::getArrayView(val)->size();
+    }
+    if (tag == value::TypeTags::ArraySet) {
+        return value::getArraySetView(val)->size();
+    }
+    return boost::none;
+}
+}  // namespace
+
 HashAggStage::HashAggStage(std::unique_ptr<PlanStage> input,
                            value::SlotVector gbs,
-                           value::SlotMap<std::unique_ptr<EExpression>> aggs)
-    : PlanStage("group"_sd), _gbs(std::move(gbs)), _aggs(std::move(aggs)) {
+                           value::SlotMap<std::unique_ptr<EExpression>> aggs,
+                           size_t memoryLimit,
+                           bool allowDiskUse)
+    : PlanStage("group"_sd),
+      _gbs(std::move(gbs)),
+      _aggs(std::move(aggs)),
+      _memoryLimit(memoryLimit),
+      _allowDiskUse(allowDiskUse) {
     _children.emplace_back(std::move(input));
 }
 
+HashAggStage::~HashAggStage() {}
+
+std::pair<value::TypeTags, value::Value> HashAggStage::HashKeyAccessor::getViewOfValue() const {
+    if (_stage._fixedTable) {
+        return _stage._fixedTable->getKey(_stage._fixedGroup, _slot);
+    }
+    return _stage._htIt->first.getViewOfValue(_slot);
+}
+
+std::pair<value::TypeTags, value::Value> HashAggStage::HashKeyAccessor::copyOrMoveValue() {
+    // We can never move out values from keys.
+    auto [tag, val] = getViewOfValue();
+    return value::copyValue(tag, val);
+}
+
+std::pair<value::TypeTags, value::Value> HashAggStage::HashAggAccessor::getViewOfValue() const {
+    if (_stage._fixedTable) {
+        return _stage._fixedTable->getAgg(_stage._fixedGroup, _slot);
+    }
+    return _stage._htIt->second.getViewOfValue(_slot);
+}
+
+std::pair<value::TypeTags, value::Value> HashAggStage::HashAggAccessor::copyOrMoveValue() {
+    if (_stage._fixedTable) {
+        return _stage._fixedTable->copyOrMoveAgg(_stage._fixedGroup, _slot);
+    }
+    return _stage._htIt->second.copyOrMoveValue(_slot);
+}
+
+void HashAggStage::HashAggAccessor::reset(bool owned, value::TypeTags tag, value::Value val) {
+    if (_stage._fixedTable) {
+        _stage._fixedTable->resetAgg(_stage._fixedGroup, _slot, owned, tag, val);
+    } else {
+        _stage._htIt->second.reset(_slot, owned, tag, val);
+    }
+}
+
 std::unique_ptr<PlanStage> HashAggStage::clone() const {
     value::SlotMap<std::unique_ptr<EExpression>> aggs;
     for (auto& [k, v] : _aggs) {
         aggs.emplace(k, v->clone());
     }
-    return std::make_unique<HashAggStage>(_children[0]->clone(), _gbs, std::move(aggs));
+    return std::make_unique<HashAggStage>(
+        _children[0]->clone(), _gbs, std::move(aggs), _memoryLimit, _allowDiskUse);
 }
 
 void HashAggStage::prepare(CompileCtx& ctx) {
@@ -61,7 +133,7 @@ void HashAggStage::prepare(CompileCtx& ctx) {
         uassert(4822827, str::stream() << "duplicate field: " << slot, inserted);
 
         _inKeyAccessors.emplace_back(_children[0]->getAccessor(ctx, slot));
-        _outKeyAccessors.emplace_back(std::make_unique<HashKeyAccessor>(_htIt, counter++));
+        _outKeyAccessors.emplace_back(std::make_unique<HashKeyAccessor>(*this, counter++));
         _outAccessors[slot] = _outKeyAccessors.back().get();
     }
 
@@ -74,7 +146,7 @@ void HashAggStage::prepare(CompileCtx& ctx) {
         const auto slotId = slot;
         uassert(4822828, str::stream() << "duplicate field: " << slotId, inserted);
 
-        _outAggAccessors.emplace_back(std::make_unique<HashAggAccessor>(_htIt, counter++));
+        _outAggAccessors.emplace_back(std::make_unique<HashAggAccessor>(*this, counter++));
         _outAccessors[slot] = _outAggAccessors.back().get();
 
         ctx.root = this;
@@ -92,6 +164,8 @@ value::SlotAccessor* HashAggStage::getAccessor(CompileCtx& ctx, value::SlotId sl
         if (auto it = _outAccessors.find(slot); it != _outAccessors.end()) {
             return it->second;
         }
+    } else if (_allowDiskUse && ctx.aggExpression) {
+        return getSpillableInputAccessor(ctx, slot);
     } else {
         return _children[0]->getAccessor(ctx, slot);
     }
@@ -99,11 +173,205 @@ value::SlotAccessor* HashAggStage::getAccessor(CompileCtx& ctx, value::SlotId sl
     return ctx.getAccessor(slot);
 }
 
+value::SlotAccessor* HashAggStage::getSpillableInputAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (auto it = _aggInputSlots.find(slot); it != _aggInputSlots.end()) {
+        return _aggInputAccessors[it->second].get();
+    }
+
+    _aggInputSlots.emplace(slot, _aggInputAccessors.size());
+    _inAggInputAccessors.emplace_back(_children[0]->getAccessor(ctx, slot));
+    _aggInputAccessors.emplace_back(std::make_unique<value::ViewOfValueAccessor>());
+    return _aggInputAccessors.back().get();
+}
+
+void HashAggStage::makeSpiller() {
+    SortOptions opts;
+    opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+    opts.maxMemoryUsageBytes = _memoryLimit;
+    opts.extSortAllowed = true;
+
+    auto comp = [](const SpilledRow& lhs, const SpilledRow& rhs) {
+        auto size = lhs.first.size();
+        auto& left = lhs.first;
+        auto& right = rhs.first;
+        for (size_t idx = 0; idx < size; ++idx) {
+            auto [lhsTag, lhsVal] = left.getViewOfValue(idx);
+            auto [rhsTag, rhsVal] = right.getViewOfValue(idx);
+            auto [tag, val] = value::compareValue(lhsTag, lhsVal, rhsTag, rhsVal);
+
+            auto result = value::bitcastTo<int32_t>(val);
+            if (result) {
+                return result;
+            }
+        }
+
+        return 0;
+    };
+
+    _spiller.reset(Spiller::make(opts, comp, {}));
+}
+
+void HashAggStage::spillRow(value::MaterializedRow key) {
+    key.makeOwned();
+
+    value::MaterializedRow vals{_inAggInputAccessors.size()};
+    size_t idx = 0;
+    for (auto accessor : _inAggInputAccessors) {
+        auto [tag, val] = accessor->copyOrMoveValue();
+        vals.reset(idx++, true, tag, val);
+    }
+
+    ++_specificStats.spilledRecords;
+    _specificStats.spilledBytes += key.memUsageForSorter() + vals.memUsageForSorter();
+    _spiller->emplace(std::move(key), std::move(vals));
+}
+
+void HashAggStage::accumulate() {
+    // While the hash table may still have to spill, the change in size of every aggregate is added
+    // to its memory usage, as aggregates such as $push and $addToSet grow with every row of their
+    // group. Measuring such an aggregate in full after every row would take quadratic time, so only
+    // its new elements are measured. The elements of a set have no order, so each new element of a
+    // set is taken to be as large as the input values of the row.
+    const bool trackMemoryUsage = _allowDiskUse && !_spiller;
+    int64_t inputSize = 0;
+    for (size_t idx = 0; idx < _inAggInputAccessors.size(); ++idx) {
+        auto [tag, val] = _inAggInputAccessors[idx]->getViewOfValue();
+        _aggInputAccessors[idx]->reset(tag, val);
+        if (trackMemoryUsage) {
+            inputSize += value::getApproximateSize(tag, val);
+        }
+    }
+
+    int64_t growth = 0;
+    for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
+        value::TypeTags tagBefore = value::TypeTags::Nothing;
+        boost::optional<size_t> numElementsBefore;
+        if (trackMemoryUsage) {
+            auto [tag, val] = _outAggAccessors[idx]->getViewOfValue();
+            tagBefore = tag;
+            numElementsBefore = getNumElements(tag, val);
+            if (!numElementsBefore) {
+                growth -= value::getApproximateSize(tag, val);
+            }
+        }
+
+        auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
+        _outAggAccessors[idx]->reset(owned, tag, val);
+
+        if (!trackMemoryUsage) {
+            continue;
+        }
+        auto numElements = getNumElements(tag, val);
+        if (!numElementsBefore || !numElements || tag != tagBefore) {
+            growth += value::getApproximateSize(tag, val);
+        } else if (tag == value::TypeTags::Array) {
+            auto arr = value::getArrayView(val);
+            for (size_t elem = *numElementsBefore; elem < *numElements; ++elem) {
+                auto [elemTag, elemVal] = arr->getAt(elem);
+                growth += value::getApproximateSize(elemTag, elemVal);
+            }
+        } else if (*numElements > *numElementsBefore) {
+            growth += static_cast<int64_t>(*numElements - *numElementsBefore) * inputSize;
+        }
+    }
+
+    if (trackMemoryUsage) {
+        _htMemoryUsage = static_cast<size_t>(
+            std::max<int64_t>(0, static_cast<int64_t>(_htMemoryUsage) + growth));
+    }
+}
+
+bool HashAggStage::accumulateInFixedTable() {
+    std::array<value::TypeTags, value::FixedKeyHashTable::kMaxKeys> tags;
+    std::array<value::Value, value::FixedKeyHashTable::kMaxKeys> vals;
+    for (size_t idx = 0; idx < _inKeyAccessors.size(); ++idx) {
+        std::tie(tags[idx], vals[idx]) = _inKeyAccessors[idx]->getViewOfValue();
+    }
+    if (!_fixedTable->canStore(tags.data())) {
+        return false;
+    }
+
+    size_t group;
+    bool inserted = false;
+    if (_spiller) {
+        group = _fixedTable->find(tags.data(), vals.data());
+        if (group == value::FixedKeyHashTable::kNoGroup) {
+            value::MaterializedRow key{_inKeyAccessors.size()};
+            for (size_t idx = 0; idx < _inKeyAccessors.size(); ++idx) {
+                key.reset(idx, false, tags[idx], vals[idx]);
+            }
+            spillRow(std::move(key));
+            return true;
+        }
+    } else {
+        std::tie(group, inserted) = _fixedTable->findOrInsert(tags.data(), vals.data());
+        if (group == value::FixedKeyHashTable::kNoGroup) {
+            return false;
+        }
+    }
+
+    _fixedGroup = group;
+    if (inserted && _allowDiskUse) {
+        _htMemoryUsage += _fixedTable->bytesPerGroup();
+        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
+            auto [tag, val] = _fixedTable->getAgg(group, idx);
+            _htMemoryUsage += value::getApproximateSize(tag, val);
+        }
+    }
+
+    accumulate();
+
+    if (!_spiller && _allowDiskUse && _htMemoryUsage > _memoryLimit) {
+        makeSpiller();
+    }
+    return true;
+}
+
+void HashAggStage::moveFixedTableToGenericTable() {
+    for (size_t group = 0; group < _fixedTable->size(); ++group) {
+        value::MaterializedRow key{_inKeyAccessors.size()};
+        for (size_t idx = 0; idx < _inKeyAccessors.size(); ++idx) {
+            auto [tag, val] = _fixedTable->getKey(group, idx);
+            key.reset(idx, false, tag, val);
+        }
+        key.makeOwned();
+
+        value::MaterializedRow aggs{_outAggAccessors.size()};
+        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
+            auto [tag, val] = _fixedTable->copyOrMoveAgg(group, idx);
+            aggs.reset(idx, true, tag, val);
+        }
+
+        _ht.emplace(std::move(key), std::move(aggs));
+    }
+    _fixedTable.reset();
+}
+
 void HashAggStage::open(bool reOpen) {
     _commonStats.opens++;
     _children[0]->open(reOpen);
 
+    _spilledRow.reset();
+    _spillIt.reset();
+    _spiller.reset();
+    _ht.clear();
+    _htMemoryUsage = 0;
+
+    _fixedTable.reset();
+    _fixedGroup = value::FixedKeyHashTable::kNoGroup;
+    if (!_gbs.empty() && _gbs.size() <= value::FixedKeyHashTable::kMaxKeys) {
+        _fixedTable =
+            std::make_unique<value::FixedKeyHashTable>(_gbs.size(), _outAggAccessors.size());
+    }
+
     while (_children[0]->getNext() == PlanState::ADVANCED) {
+        if (_fixedTable) {
+            if (accumulateInFixedTable()) {
+                continue;
+            }
+            moveFixedTableToGenericTable();
+        }
+
         value::MaterializedRow key{_inKeyAccessors.size()};
         // Copy keys in order to do the lookup.
         size_t idx = 0;
@@ -112,28 +380,99 @@ void HashAggStage::open(bool reOpen) {
             key.reset(idx++, false, tag, val);
         }
 
-        auto [it, inserted] = _ht.try_emplace(std::move(key), value::MaterializedRow{0});
-        if (inserted) {
-            // Copy keys.
-            const_cast<value::MaterializedRow&>(it->first).makeOwned();
-            // Initialize accumulators.
-            it->second.resize(_outAggAccessors.size());
+        TableType::iterator it;
+        bool inserted = false;
+        if (_spiller) {
+            // The hash table is full, so only the groups which are already in memory can be
+            // updated. The rows of all other groups are aggregated after reading them back from
+            // disk.
+            it = _ht.find(key);
+            if (it == _ht.end()) {
+                spillRow(std::move(key));
+                continue;
+            }
+        } else {
+            std::tie(it, inserted) = _ht.try_emplace(std::move(key), value::MaterializedRow{0});
+            if (inserted) {
+                // Copy keys.
+                const_cast<value::MaterializedRow&>(it->first).makeOwned();
+                // Initialize accumulators.
+                it->second.resize(_outAggAccessors.size());
+            }
+        }
+
+        if (inserted && _allowDiskUse) {
+            _htMemoryUsage += it->first.memUsageForSorter() + it->second.memUsageForSorter();
         }
 
         // Accumulate.
         _htIt = it;
-        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
-            auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
-            _outAggAccessors[idx]->reset(owned, tag, val);
+        accumulate();
+
+        if (!_spiller && _allowDiskUse && _htMemoryUsage > _memoryLimit) {
+            makeSpiller();
         }
     }
 
     _children[0]->close();
 
+    // Accumulating moved '_fixedGroup' to the group of the last input row, so it is rewound for
+    // getNext() to start from the first group.
+    _fixedGroup = value::FixedKeyHashTable::kNoGroup;
+
+    if (_spiller) {
+        _spillIt.reset(_spiller->done());
+        _specificStats.usedDisk = _specificStats.usedDisk || _spiller->usedDisk();
+    }
+
+    _specificStats.usedFixedKeyTable = static_cast<bool>(_fixedTable);
     _htIt = _ht.end();
 }
 
+void HashAggStage::aggregateNextSpilledGroup() {
+    if (!_spilledRow) {
+        _spilledRow = _spillIt->next();
+    }
+
+    _ht.clear();
+    auto [it, inserted] = _ht.try_emplace(std::move(_spilledRow->first), value::MaterializedRow{0});
+    invariant(inserted);
+    it->second.resize(_outAggAccessors.size());
+    _htIt = it;
+
+    // The spilled rows are ordered by the group key, so all rows of this group are adjacent.
+    do {
+        for (size_t idx = 0; idx < _aggInputAccessors.size(); ++idx) {
+            auto [tag, val] = _spilledRow->second.getViewOfValue(idx);
+            _aggInputAccessors[idx]->reset(tag, val);
+        }
+
+        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
+            auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
+            _outAggAccessors[idx]->reset(owned, tag, val);
+        }
+
+        if (!_spillIt->more()) {
+            _spilledRow.reset();
+            break;
+        }
+        _spilledRow = _spillIt->next();
+    } while (_spilledRow->first == _htIt->first);
+}
+
 PlanState HashAggStage::getNext() {
+    if (_fixedTable) {
+        _fixedGroup = _fixedGroup == value::FixedKeyHashTable::kNoGroup ? 0 : _fixedGroup + 1;
+        if (_fixedGroup < _fixedTable->size()) {
+            return trackPlanState(PlanState::ADVANCED);
+        }
+
+        // All groups held in memory have been returned. The spilled groups, if any, are read back
+        // into the generic hash table.
+        _fixedTable.reset();
+        _htIt = _ht.end();
+    }
+
     if (_htIt == _ht.end()) {
         _htIt = _ht.begin();
     } else {
@@ -141,6 +480,11 @@ PlanState HashAggStage::getNext() {
     }
 
     if (_htIt == _ht.end()) {
+        if (_spillIt && (_spilledRow || _spillIt->more())) {
+            aggregateNextSpilledGroup();
+            return trackPlanState(PlanState::ADVANCED);
+        }
+
         return trackPlanState(PlanState::IS_EOF);
     }
 
@@ -149,16 +493,20 @@ PlanState HashAggStage::getNext() {
 
 std::unique_ptr<PlanStageStats> HashAggStage::getStats() const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashAggStats>(_specificStats);
     ret->children.emplace_back(_children[0]->getStats());
     return ret;
 }
 
 const SpecificStats* HashAggStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 void HashAggStage::close() {
     _commonStats.closes++;
+    _spilledRow.reset();
+    _spillIt.reset();
+    _spiller.reset();
 }
 
 std::vector<DebugPrinter::Block> HashAggStage::debugPrint() const {
@@ -33,16 +33,43 @@
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/exec/sbe/values/fixed_key_hash_table.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 #include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
+template <typename Key, typename Value>
+class SortIteratorInterface;
+template <typename Key, typename Value>
+class Sorter;
+
 namespace sbe {
+/**
+ * Groups the input rows by the values in the 'gbs' slots and computes the 'aggs' expressions for
+ * every group.
+ *
+ * The groups are kept in an in-memory hash table. If 'allowDiskUse' is true and the estimated size
+ * of the hash table, including aggregates such as $push which grow with every row of their group,
+ * exceeds 'memoryLimit' bytes, the table stops accepting new groups. Input rows which belong to
+ * groups already in the table are still aggregated in memory, while all other input rows are
+ * spilled to disk through a Sorter ordered by the group key. Once the groups held in memory have
+ * been returned, the spilled rows are read back in key order and aggregated one group at a time,
+ * so the memory consumption of this second phase is bounded by a single group.
+ *
+ * When grouping by one or two keys, the groups are first collected in a value::FixedKeyHashTable,
+ * which avoids hashing generic rows and allocating memory for every group. As soon as an input row
+ * has a key the specialized table cannot store, e.g. a string or a number of a different type than
+ * the previous keys, its groups are moved to the generic hash table.
+ */
 class HashAggStage final : public PlanStage {
 public:
     HashAggStage(std::unique_ptr<PlanStage> input,
                  value::SlotVector gbs,
-                 value::SlotMap<std::unique_ptr<EExpression>> aggs);
+                 value::SlotMap<std::unique_ptr<EExpression>> aggs,
+                 size_t memoryLimit,
+                 bool allowDiskUse);
+
+    ~HashAggStage();
 
     std::unique_ptr<PlanStage> clone() const final;
 
@@ -60,11 +87,82 @@ private:
     using TableType = stdx::
         unordered_map<value::MaterializedRow, value::MaterializedRow, value::MaterializedRowHasher>;
 
-    using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
-    using HashAggAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
+    /**
+     * Provides a view of a group key of the current group, which is held either by the generic or
+     * by the fixed-width hash table.
+     */
+    class HashKeyAccessor final : public value::SlotAccessor {
+    public:
+        HashKeyAccessor(const HashAggStage& stage, size_t slot) : _stage(stage), _slot(slot) {}
+
+        std::pair<value::TypeTags, value::Value> getViewOfValue() const override;
+        std::pair<value::TypeTags, value::Value> copyOrMoveValue() override;
+
+    private:
+        const HashAggStage& _stage;
+        const size_t _slot;
+    };
+
+    /**
+     * Provides access to an aggregate value of the current group, which is held either by the
+     * generic or by the fixed-width hash table.
+     */
+    class HashAggAccessor final : public value::SlotAccessor {
+    public:
+        HashAggAccessor(HashAggStage& stage, size_t slot) : _stage(stage), _slot(slot) {}
+
+        std::pair<value::TypeTags, value::Value> getViewOfValue() const override;
+        std::pair<value::TypeTags, value::Value> copyOrMoveValue() override;
+        void reset(bool owned, value::TypeTags tag, value::Value val);
+
+    private:
+        HashAggStage& _stage;
+        const size_t _slot;
+    };
+
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+    using Spiller = Sorter<value::MaterializedRow, value::MaterializedRow>;
+
+    /**
+     * Returns an accessor through which the aggregate expressions read the input 'slot'. The
+     * accessor can be pointed either at the current row of the child stage or at a row read back
+     * from disk.
+     */
+    value::SlotAccessor* getSpillableInputAccessor(CompileCtx& ctx, value::SlotId slot);
+
+    /**
+     * Runs the aggregate expressions for the current input row against the current group, and adds
+     * the growth of the aggregates to '_htMemoryUsage' while the hash table may still spill.
+     */
+    void accumulate();
+
+    /**
+     * Aggregates the current input row in '_fixedTable', or spills it if the table is full. Returns
+     * false if the key of the row cannot be stored in the fixed-width table, in which case the row
+     * is left unprocessed. Such a key may still be equal to the key of an in-memory group, e.g. a
+     * double equal to an integer, so it must be looked up in the generic table.
+     */
+    bool accumulateInFixedTable();
+
+    /**
+     * Moves all groups from '_fixedTable' to the generic hash table and destroys '_fixedTable'.
+     */
+    void moveFixedTableToGenericTable();
+
+    void makeSpiller();
+    void spillRow(value::MaterializedRow key);
+
+    /**
+     * Replaces the content of the hash table with the next group read back from disk and
+     * positions '_htIt' on it.
+     */
+    void aggregateNextSpilledGroup();
 
     const value::SlotVector _gbs;
     const value::SlotMap<std::unique_ptr<EExpression>> _aggs;
+    const size_t _memoryLimit;
+    const bool _allowDiskUse;
 
     value::SlotAccessorMap _outAccessors;
     std::vector<value::SlotAccessor*> _inKeyAccessors;
@@ -73,11 +171,32 @@ private:
     std::vector<std::unique_ptr<HashAggAccessor>> _outAggAccessors;
     std::vector<std::unique_ptr<vm::CodeFragment>> _aggCodes;
 
+    // Child slots read by the aggregate expressions when spilling is allowed. Their values are
+    // copied into the spilled rows so the aggregates can be computed later from the disk data.
+    value::SlotMap<size_t> _aggInputSlots;
+    std::vector<value::SlotAccessor*> _inAggInputAccessors;
+    std::vector<std::unique_ptr<value::ViewOfValueAccessor>> _aggInputAccessors;
+
     TableType _ht;
     TableType::iterator _htIt;
 
+    // Holds the in-memory groups instead of '_ht' while it is not null.
+    std::unique_ptr<value::FixedKeyHashTable> _fixedTable;
+    // The current group in '_fixedTable', or 'kNoGroup' before the first call to getNext().
+    size_t _fixedGroup{value::FixedKeyHashTable::kNoGroup};
+
+    // Approximate amount of memory used by the hash table, in bytes.
+    size_t _htMemoryUsage{0};
+
+    std::unique_ptr<Spiller> _spiller;
+    std::unique_ptr<SpillIterator> _spillIt;
+    // The next row read back from disk which has not been aggregated yet.
+    boost::optional<SpilledRow> _spilledRow;
+
     vm::ByteCode _bytecode;
 
+    HashAggStats _specificStats;
+
     bool _compiled{false};
 };
 }  // namespace sbe
@@ -31,9 +31,21 @@
 
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 
+#include <boost/filesystem/operations.hpp>
+
 #include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashJoinFileCounter;
+    return "extsort-hash-join-sbe." + std::to_string(hashJoinFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
 HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
@@ -41,13 +53,18 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
                              value::SlotVector outerCond,
                              value::SlotVector outerProjects,
                              value::SlotVector innerCond,
-                             value::SlotVector innerProjects)
+                             value::SlotVector innerProjects,
+                             size_t memoryLimit,
+                             bool allowDiskUse)
     : PlanStage("hj"_sd),
       _outerCond(std::move(outerCond)),
       _outerProjects(std::move(outerProjects)),
       _innerCond(std::move(innerCond)),
       _innerProjects(std::move(innerProjects)),
-      _probeKey(0) {
+      _memoryLimit(memoryLimit),
+      _allowDiskUse(allowDiskUse),
+      _probeKey(0),
+      _probeRow({0, 0}) {
     if (_outerCond.size() != _innerCond.size()) {
         uasserted(4822823, "left and right size do not match");
     }
@@ -56,13 +73,19 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
     _children.emplace_back(std::move(inner));
 }
 
+HashJoinStage::~HashJoinStage() {
+    resetSpilledPartitions();
+}
+
 std::unique_ptr<PlanStage> HashJoinStage::clone() const {
     return std::make_unique<HashJoinStage>(_children[0]->clone(),
                                            _children[1]->clone(),
                                            _outerCond,
                                            _outerProjects,
                                            _innerCond,
-                                           _innerProjects);
+                                           _innerProjects,
+                                           _memoryLimit,
+                                           _allowDiskUse);
 }
 
 void HashJoinStage::prepare(CompileCtx& ctx) {
@@ -86,6 +109,10 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
         uassert(4822825, str::stream() << "duplicate field: " << slot, inserted);
 
         _inInnerKeyAccessors.emplace_back(_children[1]->getAccessor(ctx, slot));
+        if (_allowDiskUse) {
+            _outInnerKeyAccessors.emplace_back(std::make_unique<value::ViewOfValueAccessor>());
+            _outInnerAccessors.emplace(slot, _outInnerKeyAccessors.back().get());
+        }
     }
 
     counter = 0;
@@ -99,6 +126,14 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
         _outOuterAccessors[slot] = _outOuterProjectAccessors.back().get();
     }
 
+    if (_allowDiskUse) {
+        for (auto& slot : _innerProjects) {
+            _inInnerProjectAccessors.emplace_back(_children[1]->getAccessor(ctx, slot));
+            _outInnerProjectAccessors.emplace_back(std::make_unique<value::ViewOfValueAccessor>());
+            _outInnerAccessors.emplace(slot, _outInnerProjectAccessors.back().get());
+        }
+    }
+
     _probeKey.resize(_inInnerKeyAccessors.size());
 
     _compiled = true;
@@ -110,15 +145,226 @@ value::SlotAccessor* HashJoinStage::getAccessor(CompileCtx& ctx, value::SlotId s
             return it->second;
         }
 
+        if (auto it = _outInnerAccessors.find(slot); it != _outInnerAccessors.end()) {
+            return it->second;
+        }
+
         return _children[1]->getAccessor(ctx, slot);
     }
 
     return ctx.getAccessor(slot);
 }
 
+size_t HashJoinStage::getPartition(const value::MaterializedRow& key, size_t level) {
+    // Each level uses the next bits of the hash, so that the keys of a partition, which share the
+    // bits of all previous levels, are spread over the partitions of the next level.
+    return (value::MaterializedRowHasher{}(key) >> (level * kPartitionBits)) % kNumPartitions;
+}
+
+void HashJoinStage::spillRow(SpilledPartition& partition, const SpilledRow& row) {
+    partition.writer->addAlreadySorted(row.first, row.second);
+    _specificStats.spilledBytes += row.first.memUsageForSorter() + row.second.memUsageForSorter();
+}
+
+void HashJoinStage::spillBuildSide() {
+    SortOptions opts;
+    opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+
+    _partitions.resize(kNumPartitions);
+    for (size_t idx = 1; idx < kNumPartitions; ++idx) {
+        auto& partition = _partitions[idx];
+        partition.fileFullPath = opts.tempDir + "/" + nextFileName();
+        partition.writer = std::make_unique<SpillWriter>(opts, partition.fileFullPath, 0);
+    }
+
+    for (auto it = _ht.begin(); it != _ht.end();) {
+        auto partitionIdx = getPartition(it->first);
+        if (partitionIdx == 0) {
+            ++it;
+            continue;
+        }
+
+        auto& partition = _partitions[partitionIdx];
+        spillRow(partition, *it);
+        ++partition.buildRecords;
+        ++_specificStats.spilledBuildRecords;
+
+        _htMemoryUsage -= it->first.memUsageForSorter() + it->second.memUsageForSorter();
+        it = _ht.erase(it);
+    }
+
+    _specificStats.usedDisk = true;
+}
+
+void HashJoinStage::finishBuildPartitions(size_t firstPartition) {
+    SortOptions opts;
+    opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+
+    for (size_t idx = firstPartition; idx < _partitions.size(); ++idx) {
+        auto& partition = _partitions[idx];
+        if (!partition.buildRecords) {
+            // The probe rows of this partition will be discarded, so there is nothing to write.
+            partition.writer.reset();
+            continue;
+        }
+
+        partition.buildIt.reset(partition.writer->done());
+        auto probeStartOffset = partition.writer->getFileEndOffset();
+        partition.writer =
+            std::make_unique<SpillWriter>(opts, partition.fileFullPath, probeStartOffset);
+    }
+}
+
+void HashJoinStage::finishProbePartitions(size_t firstPartition) {
+    for (size_t idx = firstPartition; idx < _partitions.size(); ++idx) {
+        auto& partition = _partitions[idx];
+        if (partition.probeRecords) {
+            partition.probeIt.reset(partition.writer->done());
+        }
+        partition.writer.reset();
+    }
+}
+
+bool HashJoinStage::loadNextSpilledPartition() {
+    if (_probeIt) {
+        _probeIt->closeSource();
+        _probeIt = nullptr;
+    }
+
+    while (++_currentPartition < _partitions.size()) {
+        auto& partition = _partitions[_currentPartition];
+        if (!partition.buildIt || !partition.probeIt) {
+            // Without rows on either side, the partition cannot produce any results.
+            continue;
+        }
+
+        _ht.clear();
+        _htMemoryUsage = 0;
+        partition.buildIt->openSource();
+        while (partition.buildIt->more() && _htMemoryUsage <= _memoryLimit) {
+            auto row = partition.buildIt->next();
+            _htMemoryUsage += row.first.memUsageForSorter() + row.second.memUsageForSorter();
+            _specificStats.peakMemoryUsageBytes =
+                std::max(_specificStats.peakMemoryUsageBytes, _htMemoryUsage);
+            _ht.emplace(std::move(row));
+        }
+
+        if (_htMemoryUsage > _memoryLimit) {
+            // The partition is split into new partitions at the end of the list, which are joined
+            // after the remaining ones.
+            splitSpilledPartition(_currentPartition);
+            continue;
+        }
+        partition.buildIt->closeSource();
+
+        // getNext() compares the iterators into the table, which the clear and the inserts above
+        // have invalidated.
+        _htIt = _htItEnd = _ht.end();
+
+        _probeIt = partition.probeIt.get();
+        _probeIt->openSource();
+        return true;
+    }
+
+    _ht.clear();
+    _htIt = _htItEnd = _ht.end();
+    return false;
+}
+
+void HashJoinStage::splitSpilledPartition(size_t partitionIdx) {
+    auto level = _partitions[partitionIdx].level + 1;
+    uassert(5095439,
+            str::stream() << "Hash join partition exceeded the memory limit of " << _memoryLimit
+                          << " bytes after being split " << kMaxPartitionLevel
+                          << " times, too many rows of the outer side share the same join key",
+            level <= kMaxPartitionLevel);
+
+    // Take over the rows of the partition, since its entry may be moved by growing the list. The
+    // entry keeps the file name, so that the file is removed even if the split fails.
+    auto buildIt = std::move(_partitions[partitionIdx].buildIt);
+    auto probeIt = std::move(_partitions[partitionIdx].probeIt);
+
+    SortOptions opts;
+    opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+
+    auto firstPartition = _partitions.size();
+    _partitions.resize(firstPartition + kNumPartitions);
+    for (size_t idx = firstPartition; idx < _partitions.size(); ++idx) {
+        auto& partition = _partitions[idx];
+        partition.level = level;
+        partition.fileFullPath = opts.tempDir + "/" + nextFileName();
+        partition.writer = std::make_unique<SpillWriter>(opts, partition.fileFullPath, 0);
+    }
+
+    auto spillBuildRow = [&](const SpilledRow& row) {
+        auto& partition = _partitions[firstPartition + getPartition(row.first, level)];
+        spillRow(partition, row);
+        ++partition.buildRecords;
+        ++_specificStats.spilledBuildRecords;
+    };
+
+    // Move the build rows which have already been loaded back to disk, followed by the rest.
+    for (auto&& row : _ht) {
+        spillBuildRow(row);
+    }
+    _ht.clear();
+    _htMemoryUsage = 0;
+
+    while (buildIt->more()) {
+        spillBuildRow(buildIt->next());
+    }
+    buildIt->closeSource();
+    finishBuildPartitions(firstPartition);
+
+    probeIt->openSource();
+    while (probeIt->more()) {
+        auto row = probeIt->next();
+        auto& partition = _partitions[firstPartition + getPartition(row.first, level)];
+        if (partition.buildRecords) {
+            spillRow(partition, row);
+            ++partition.probeRecords;
+            ++_specificStats.spilledProbeRecords;
+        }
+    }
+    probeIt->closeSource();
+    finishProbePartitions(firstPartition);
+
+    buildIt.reset();
+    probeIt.reset();
+    auto& partition = _partitions[partitionIdx];
+    boost::system::error_code ec;
+    boost::filesystem::remove(partition.fileFullPath, ec);
+    partition.fileFullPath.clear();
+}
+
+void HashJoinStage::resetSpilledPartitions() {
+    if (_probeIt) {
+        _probeIt->closeSource();
+        _probeIt = nullptr;
+    }
+
+    for (auto& partition : _partitions) {
+        partition.buildIt.reset();
+        partition.probeIt.reset();
+        partition.writer.reset();
+        if (!partition.fileFullPath.empty()) {
+            boost::system::error_code ec;
+            boost::filesystem::remove(partition.fileFullPath, ec);
+        }
+    }
+
+    _partitions.clear();
+    _currentPartition = 0;
+}
+
 void HashJoinStage::open(bool reOpen) {
     _commonStats.opens++;
     _children[0]->open(reOpen);
+
+    resetSpilledPartitions();
+    _ht.clear();
+    _htMemoryUsage = 0;
+
     // Insert the outer side into the hash table.
     while (_children[0]->getNext() == PlanState::ADVANCED) {
         value::MaterializedRow key{_inOuterKeyAccessors.size()};
@@ -138,11 +384,35 @@ void HashJoinStage::open(bool reOpen) {
             project.reset(idx++, true, tag, val);
         }
 
+        if (!_partitions.empty()) {
+            if (auto partitionIdx = getPartition(key); partitionIdx != 0) {
+                auto& partition = _partitions[partitionIdx];
+                spillRow(partition, {std::move(key), std::move(project)});
+                ++partition.buildRecords;
+                ++_specificStats.spilledBuildRecords;
+                continue;
+            }
+        }
+
+        if (_allowDiskUse) {
+            _htMemoryUsage += key.memUsageForSorter() + project.memUsageForSorter();
+            _specificStats.peakMemoryUsageBytes =
+                std::max(_specificStats.peakMemoryUsageBytes, _htMemoryUsage);
+        }
+
         _ht.emplace(std::move(key), std::move(project));
+
+        if (_allowDiskUse && _partitions.empty() && _htMemoryUsage > _memoryLimit) {
+            spillBuildSide();
+        }
     }
 
     _children[0]->close();
 
+    if (!_partitions.empty()) {
+        finishBuildPartitions(0);
+    }
+
     _children[1]->open(reOpen);
 
     _htIt = _ht.end();
@@ -156,8 +426,43 @@ PlanState HashJoinStage::getNext() {
 
     if (_htIt == _htItEnd) {
         while (_htIt == _htItEnd) {
+            if (_currentPartition) {
+                // The inner side has been exhausted and the spilled partitions are being joined.
+                if (!_probeIt || !_probeIt->more()) {
+                    if (!loadNextSpilledPartition()) {
+                        return trackPlanState(PlanState::IS_EOF);
+                    }
+                    continue;
+                }
+
+                _probeRow = _probeIt->next();
+                for (size_t idx = 0; idx < _outInnerKeyAccessors.size(); ++idx) {
+                    auto [tag, val] = _probeRow.first.getViewOfValue(idx);
+                    _outInnerKeyAccessors[idx]->reset(tag, val);
+                }
+                for (size_t idx = 0; idx < _outInnerProjectAccessors.size(); ++idx) {
+                    auto [tag, val] = _probeRow.second.getViewOfValue(idx);
+                    _outInnerProjectAccessors[idx]->reset(tag, val);
+                }
+
+                auto [low, hi] = _ht.equal_range(_probeRow.first);
+                _htIt = low;
+                _htItEnd = hi;
+                continue;
+            }
+
             auto state = _children[1]->getNext();
             if (state == PlanState::IS_EOF) {
+                if (!_partitions.empty()) {
+                    finishProbePartitions(0);
+
+                    // Partition 0 has already been joined, move on to the spilled partitions.
+                    _currentPartition = 0;
+                    if (loadNextSpilledPartition()) {
+                        continue;
+                    }
+                }
+
                 // LEFT and OUTER joins should enumerate "non-returned" rows here.
                 return trackPlanState(state);
             }
@@ -169,6 +474,36 @@ PlanState HashJoinStage::getNext() {
                 _probeKey.reset(idx++, false, tag, val);
             }
 
+            if (!_partitions.empty()) {
+                if (auto partitionIdx = getPartition(_probeKey); partitionIdx != 0) {
+                    auto& partition = _partitions[partitionIdx];
+                    if (partition.buildRecords) {
+                        // There is no need to keep the probe rows of a partition without build
+                        // rows, since they cannot match anything.
+                        value::MaterializedRow project{_inInnerProjectAccessors.size()};
+                        idx = 0;
+                        for (auto& p : _inInnerProjectAccessors) {
+                            auto [tag, val] = p->getViewOfValue();
+                            project.reset(idx++, false, tag, val);
+                        }
+
+                        spillRow(partition, {_probeKey, std::move(project)});
+                        ++partition.probeRecords;
+                        ++_specificStats.spilledProbeRecords;
+                    }
+                    continue;
+                }
+            }
+
+            for (idx = 0; idx < _outInnerKeyAccessors.size(); ++idx) {
+                auto [tag, val] = _inInnerKeyAccessors[idx]->getViewOfValue();
+                _outInnerKeyAccessors[idx]->reset(tag, val);
+            }
+            for (idx = 0; idx < _outInnerProjectAccessors.size(); ++idx) {
+                auto [tag, val] = _inInnerProjectAccessors[idx]->getViewOfValue();
+                _outInnerProjectAccessors[idx]->reset(tag, val);
+            }
+
             auto [low, hi] = _ht.equal_range(_probeKey);
             _htIt = low;
             _htItEnd = hi;
@@ -183,17 +518,19 @@ PlanState HashJoinStage::getNext() {
 void HashJoinStage::close() {
     _commonStats.closes++;
     _children[1]->close();
+    resetSpilledPartitions();
 }
 
 std::unique_ptr<PlanStageStats> HashJoinStage::getStats() const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashJoinStats>(_specificStats);
     ret->children.emplace_back(_children[0]->getStats());
     ret->children.emplace_back(_children[1]->getStats());
     return ret;
 }
 
 const SpecificStats* HashJoinStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 std::vector<DebugPrinter::Block> HashJoinStage::debugPrint() const {
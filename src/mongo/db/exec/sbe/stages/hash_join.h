@@ -34,15 +34,49 @@
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 
+namespace mongo {
+template <typename Key, typename Value>
+class SortIteratorInterface;
+template <typename Key, typename Value>
+class SortedFileWriter;
+}  // namespace mongo
+
 namespace mongo::sbe {
+/**
+ * Joins the rows of the 'outer' (build) side with the rows of the 'inner' (probe) side on the
+ * equality of the 'outerCond' and 'innerCond' slots. The outer side is loaded into an in-memory
+ * hash table which is then probed with every inner row.
+ *
+ * If 'allowDiskUse' is true and the estimated size of the hash table exceeds 'memoryLimit' bytes,
+ * the stage switches to a hybrid grace hash join. The key space is split into 'kNumPartitions'
+ * partitions by hash. Partition 0 stays in memory while the build rows of all other partitions are
+ * moved to temporary files, and so are the probe rows which hash to those partitions. Once the
+ * inner side is exhausted, each spilled partition is joined in turn by loading its build rows into
+ * the hash table and streaming its probe rows from disk. A spilled partition whose build rows do
+ * not fit into 'memoryLimit' either is split again into 'kNumPartitions' partitions by the next
+ * bits of the hash, up to 'kMaxPartitionLevel' times, after which the join fails. In this mode only
+ * the 'innerCond' and 'innerProjects' slots of the inner side are visible to the parent stages.
+ */
 class HashJoinStage final : public PlanStage {
 public:
+    static constexpr size_t kNumPartitions = 16;
+    // The number of hash bits used to pick a partition at each level of partitioning.
+    static constexpr size_t kPartitionBits = 4;
+    static_assert(kNumPartitions == size_t{1} << kPartitionBits);
+    // The number of times a spilled partition can be split before the join gives up. Build rows
+    // which share the same join key can never be split apart.
+    static constexpr size_t kMaxPartitionLevel = 3;
+
     HashJoinStage(std::unique_ptr<PlanStage> outer,
                   std::unique_ptr<PlanStage> inner,
                   value::SlotVector outerCond,
                   value::SlotVector outerProjects,
                   value::SlotVector innerCond,
-                  value::SlotVector innerProjects);
+                  value::SlotVector innerProjects,
+                  size_t memoryLimit,
+                  bool allowDiskUse);
+
+    ~HashJoinStage();
 
     std::unique_ptr<PlanStage> clone() const final;
 
@@ -64,10 +98,71 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashProjectAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+    using SpillWriter = SortedFileWriter<value::MaterializedRow, value::MaterializedRow>;
+
+    /**
+     * A partition of the key space whose build and probe rows are kept on disk. Both ranges are
+     * stored in the same file, the probe range following the build range.
+     */
+    struct SpilledPartition {
+        // The number of times the key space has been split to produce this partition.
+        size_t level{0};
+        std::string fileFullPath;
+        std::unique_ptr<SpillWriter> writer;
+        std::unique_ptr<SpillIterator> buildIt;
+        std::unique_ptr<SpillIterator> probeIt;
+        size_t buildRecords{0};
+        size_t probeRecords{0};
+    };
+
+    /**
+     * Returns the partition of the given key among the 'kNumPartitions' partitions produced by
+     * splitting a partition at 'level'.
+     */
+    static size_t getPartition(const value::MaterializedRow& key, size_t level = 0);
+
+    /**
+     * Switches the stage into the partitioned mode and moves the build rows of all partitions but
+     * the first one from the hash table to disk.
+     */
+    void spillBuildSide();
+    void spillRow(SpilledPartition& partition, const SpilledRow& row);
+
+    /**
+     * Closes the writers of the build ranges and opens the writers of the probe ranges of the
+     * partitions starting at 'firstPartition'.
+     */
+    void finishBuildPartitions(size_t firstPartition);
+
+    /**
+     * Closes the writers of the probe ranges of the partitions starting at 'firstPartition'.
+     */
+    void finishProbePartitions(size_t firstPartition);
+
+    /**
+     * Loads the build rows of the next spilled partition that has both build and probe rows into
+     * the hash table and positions '_probeIt' at the start of its probe rows. A partition which
+     * does not fit into the memory limit is split instead of being joined. Returns false if there
+     * are no more partitions to join.
+     */
+    bool loadNextSpilledPartition();
+
+    /**
+     * Splits the spilled partition at 'partitionIdx', whose build rows have been partially loaded
+     * into the hash table, into 'kNumPartitions' new partitions appended to '_partitions'. Throws
+     * if the partition has already been split 'kMaxPartitionLevel' times.
+     */
+    void splitSpilledPartition(size_t partitionIdx);
+    void resetSpilledPartitions();
+
     const value::SlotVector _outerCond;
     const value::SlotVector _outerProjects;
     const value::SlotVector _innerCond;
     const value::SlotVector _innerProjects;
+    const size_t _memoryLimit;
+    const bool _allowDiskUse;
 
     // All defined values from the outer side (i.e. they come from the hash table).
     value::SlotAccessorMap _outOuterAccessors;
@@ -87,6 +182,15 @@ private:
     // Accessors of input codition values (keys) that are being inserted into the hash table.
     std::vector<value::SlotAccessor*> _inInnerKeyAccessors;
 
+    // Accessors of input projection values from the inner side.
+    std::vector<value::SlotAccessor*> _inInnerProjectAccessors;
+
+    // When spilling is allowed, the inner key and projection values are exposed through these
+    // accessors, so they can be fed either from the inner child or from a spilled probe row.
+    value::SlotMap<value::ViewOfValueAccessor*> _outInnerAccessors;
+    std::vector<std::unique_ptr<value::ViewOfValueAccessor>> _outInnerKeyAccessors;
+    std::vector<std::unique_ptr<value::ViewOfValueAccessor>> _outInnerProjectAccessors;
+
     // Key used to probe inside the hash table.
     value::MaterializedRow _probeKey;
 
@@ -94,8 +198,24 @@ private:
     TableType::iterator _htIt;
     TableType::iterator _htItEnd;
 
+    // Approximate amount of memory used by the hash table, in bytes.
+    size_t _htMemoryUsage{0};
+
+    // Spilled partitions. The first 'kNumPartitions' entries are indexed by partition number, the
+    // first partition is always kept in memory and its entry is unused. The partitions produced by
+    // splitting a partition are appended after them. Empty unless the stage is in the partitioned
+    // mode.
+    std::vector<SpilledPartition> _partitions;
+    // The partition which is being joined after the inner side was exhausted.
+    size_t _currentPartition{0};
+    // The probe rows of the current partition and the probe row being joined.
+    SpillIterator* _probeIt{nullptr};
+    SpilledRow _probeRow;
+
     vm::ByteCode _bytecode;
 
+    HashJoinStats _specificStats;
+
     bool _compiled{false};
 };
 }  // namespace mongo::sbe
@@ -157,6 +157,12 @@ void IndexScanStage::doAttachFromOperationContext(OperationContext* opCtx) {
     }
 }
 
+void IndexScanStage::doRebindTrialRunProgressTracker(TrialRunProgressTracker* tracker) {
+    if (_tracker) {
+        _tracker = tracker;
+    }
+}
+
 void IndexScanStage::open(bool reOpen) {
     _commonStats.opens++;
 
@@ -99,6 +99,45 @@ struct LimitSkipStats : public SpecificStats {
     boost::optional<long long> skip;
 };
 
+struct HashAggStats : public SpecificStats {
+    SpecificStats* clone() const final {
+        return new HashAggStats(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const {
+        return sizeof(*this);
+    }
+
+    bool usedDisk{false};
+    // Whether all groups held in memory were keyed by fixed-width values and stored in the
+    // specialized hash table for such keys.
+    bool usedFixedKeyTable{false};
+    // The number of input rows which were written to disk because their group did not fit into
+    // the memory budget of the hash table.
+    size_t spilledRecords{0};
+    // The approximate amount of data written to disk, in bytes.
+    size_t spilledBytes{0};
+};
+
+struct HashJoinStats : public SpecificStats {
+    SpecificStats* clone() const final {
+        return new HashJoinStats(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const {
+        return sizeof(*this);
+    }
+
+    // The peak approximate amount of memory used by the hash table, in bytes.
+    size_t peakMemoryUsageBytes{0};
+    bool usedDisk{false};
+    // The number of build (outer) and probe (inner) rows written to the spilled partitions.
+    size_t spilledBuildRecords{0};
+    size_t spilledProbeRecords{0};
+    // The approximate amount of data written to disk, in bytes.
+    size_t spilledBytes{0};
+};
+
 /**
  * Calculates the total number of physical reads in the given plan stats tree. If a stage can do
  * a physical read (e.g. COLLSCAN or IXSCAN), then its 'numReads' stats is added to the total.
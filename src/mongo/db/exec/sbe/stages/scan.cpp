@@ -31,12 +31,44 @@
 
 #include "mongo/db/exec/sbe/stages/scan.h"
 
+#include <numeric>
+
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
 namespace sbe {
+namespace {
+/**
+ * Calls 'onField' with the entry of 'fieldMap' and the value of every top-level field of 'rawBson'
+ * whose name is present in 'fieldMap'. The values are views into 'rawBson'.
+ */
+template <typename FieldMap, typename OnField>
+void extractFields(FieldMap& fieldMap, const char* rawBson, OnField&& onField) {
+    auto fieldsToMatch = fieldMap.size();
+    auto be = rawBson + 4;
+    auto end = rawBson + ConstDataView(rawBson).read<LittleEndian<uint32_t>>();
+    while (*be != 0) {
+        auto sv = bson::fieldNameView(be);
+        if (auto it = fieldMap.find(sv); it != fieldMap.end()) {
+            // Found the field so convert it to Value.
+            auto [tag, val] = bson::convertFrom(true, be, end, sv.size());
+
+            onField(it->second, tag, val);
+
+            if ((--fieldsToMatch) == 0) {
+                // No need to scan any further so bail out early.
+                break;
+            }
+        }
+
+        be = bson::advance(be, sv.size());
+    }
+}
+}  // namespace
+
 ScanStage::ScanStage(const NamespaceStringOrUUID& name,
                      boost::optional<value::SlotId> recordSlot,
                      boost::optional<value::SlotId> recordIdSlot,
@@ -46,7 +78,9 @@ ScanStage::ScanStage(const NamespaceStringOrUUID& name,
                      bool forward,
                      PlanYieldPolicy* yieldPolicy,
                      TrialRunProgressTracker* tracker,
-                     ScanOpenCallback openCallback)
+                     ScanOpenCallback openCallback,
+                     std::unique_ptr<EExpression> filter,
+                     size_t blockSize)
     : PlanStage(seekKeySlot ? "seek"_sd : "scan"_sd, yieldPolicy),
       _name(name),
       _recordSlot(recordSlot),
@@ -56,9 +90,13 @@ ScanStage::ScanStage(const NamespaceStringOrUUID& name,
       _seekKeySlot(seekKeySlot),
       _forward(forward),
       _tracker(tracker),
-      _openCallback(openCallback) {
+      _openCallback(openCallback),
+      _filter(std::move(filter)),
+      _blockSize(blockSize) {
     invariant(_fields.size() == _vars.size());
     invariant(!_seekKeySlot || _forward);
+    invariant(!_seekKeySlot || !_blockSize);
+    invariant(!_filter || _blockSize);
 }
 
 std::unique_ptr<PlanStage> ScanStage::clone() const {
@@ -71,7 +109,9 @@ std::unique_ptr<PlanStage> ScanStage::clone() const {
                                        _forward,
                                        _yieldPolicy,
                                        _tracker,
-                                       _openCallback);
+                                       _openCallback,
+                                       _filter ? _filter->clone() : nullptr,
+                                       _blockSize);
 }
 
 void ScanStage::prepare(CompileCtx& ctx) {
@@ -94,6 +134,31 @@ void ScanStage::prepare(CompileCtx& ctx) {
     if (_seekKeySlot) {
         _seekKeyAccessor = ctx.getAccessor(*_seekKeySlot);
     }
+
+    if (_blockSize) {
+        auto bindColumn = [&](value::ViewOfValueAccessor* accessor, BlockColumn& column) {
+            column.tags.resize(_blockSize);
+            column.vals.resize(_blockSize);
+            _blockAccessors.push_back(accessor);
+            _blockBindings.emplace_back(accessor,
+                                        vm::ValueBlock{column.tags.data(), column.vals.data()});
+        };
+
+        if (_recordAccessor) {
+            bindColumn(_recordAccessor.get(), _recordColumn);
+        }
+        if (_recordIdAccessor) {
+            bindColumn(_recordIdAccessor.get(), _recordIdColumn);
+        }
+        for (auto& [name, accessor] : _fieldAccessors) {
+            bindColumn(accessor.get(), _fieldColumns[name]);
+        }
+    }
+
+    if (_filter) {
+        ctx.root = this;
+        _filterCode = _filter->compile(ctx);
+    }
 }
 
 value::SlotAccessor* ScanStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
@@ -113,6 +178,24 @@ value::SlotAccessor* ScanStage::getAccessor(CompileCtx& ctx, value::SlotId slot)
 }
 
 void ScanStage::doSaveState() {
+    if (_blockSize && _blockPosition < _blockSelection.size()) {
+        // The buffered rows may be deleted or updated while yielding, so the rest of the block is
+        // discarded and read again after the last row returned.
+        const size_t firstUnreturned =
+            _blockPosition ? _blockSelection[_blockPosition - 1] + 1 : 0;
+        trackBlockReads(firstUnreturned);
+        _blockResumeId = RecordId{_blockRecordIds[firstUnreturned]};
+        _blockSelection.clear();
+        _blockPosition = 0;
+        _blockEof = false;
+    } else if (_fillingBlock && !_blockOffsets.empty()) {
+        // Yielding while a block is being filled restarts the block from its first row.
+        _blockResumeId = RecordId{_blockRecordIds[0]};
+        _blockData.clear();
+        _blockOffsets.clear();
+        _blockRecordIds.clear();
+    }
+
     if (_cursor) {
         _cursor->save();
     }
@@ -155,6 +238,12 @@ void ScanStage::doAttachFromOperationContext(OperationContext* opCtx) {
     }
 }
 
+void ScanStage::doRebindTrialRunProgressTracker(TrialRunProgressTracker* tracker) {
+    if (_tracker) {
+        _tracker = tracker;
+    }
+}
+
 void ScanStage::open(bool reOpen) {
     _commonStats.opens++;
     invariant(_opCtx);
@@ -196,6 +285,12 @@ void ScanStage::open(bool reOpen) {
 
     _open = true;
     _firstGetNext = true;
+
+    _blockSelection.clear();
+    _blockPosition = 0;
+    _blockRowsRead = 0;
+    _blockEof = false;
+    _blockResumeId = boost::none;
 }
 
 PlanState ScanStage::getNext() {
@@ -203,6 +298,10 @@ PlanState ScanStage::getNext() {
         return trackPlanState(PlanState::IS_EOF);
     }
 
+    if (_blockSize) {
+        return getNextFromBlock();
+    }
+
     checkForInterrupt(_opCtx);
 
     auto nextRecord =
@@ -224,40 +323,120 @@ PlanState ScanStage::getNext() {
     }
 
     if (!_fieldAccessors.empty()) {
-        auto fieldsToMatch = _fieldAccessors.size();
-        auto rawBson = nextRecord->data.data();
-        auto be = rawBson + 4;
-        auto end = rawBson + ConstDataView(rawBson).read<LittleEndian<uint32_t>>();
         for (auto& [name, accessor] : _fieldAccessors) {
             accessor->reset();
         }
-        while (*be != 0) {
-            auto sv = bson::fieldNameView(be);
-            if (auto it = _fieldAccessors.find(sv); it != _fieldAccessors.end()) {
-                // Found the field so convert it to Value.
-                auto [tag, val] = bson::convertFrom(true, be, end, sv.size());
+        extractFields(_fieldAccessors,
+                      nextRecord->data.data(),
+                      [](auto& accessor, value::TypeTags tag, value::Value val) {
+                          accessor->reset(tag, val);
+                      });
+    }
 
-                it->second->reset(tag, val);
+    trackReads(1);
+    return trackPlanState(PlanState::ADVANCED);
+}
 
-                if ((--fieldsToMatch) == 0) {
-                    // No need to scan any further so bail out early.
-                    break;
-                }
-            }
+PlanState ScanStage::getNextFromBlock() {
+    while (_blockPosition == _blockSelection.size()) {
+        // The rows after the last one passing the filter have been read as well.
+        trackBlockReads(_blockOffsets.size());
+        if (_blockEof) {
+            return trackPlanState(PlanState::IS_EOF);
+        }
+        fillBlock();
+    }
 
-            be = bson::advance(be, sv.size());
+    auto row = _blockSelection[_blockPosition++];
+    trackBlockReads(row + 1);
+    for (size_t idx = 0; idx < _blockAccessors.size(); ++idx) {
+        const auto& block = _blockBindings[idx].second;
+        _blockAccessors[idx]->reset(block.tags[row], block.vals[row]);
+    }
+
+    return trackPlanState(PlanState::ADVANCED);
+}
+
+void ScanStage::fillBlock() {
+    _blockData.clear();
+    _blockOffsets.clear();
+    _blockRecordIds.clear();
+    _blockSelection.clear();
+    _blockPosition = 0;
+    _blockRowsRead = 0;
+
+    _fillingBlock = true;
+    ON_BLOCK_EXIT([&] { _fillingBlock = false; });
+    while (_blockOffsets.size() < _blockSize) {
+        checkForInterrupt(_opCtx);
+
+        auto nextRecord = _blockResumeId ? _cursor->seekNear(*_blockResumeId) : _cursor->next();
+        _blockResumeId = boost::none;
+        if (!nextRecord) {
+            _blockEof = true;
+            break;
         }
+
+        auto data = nextRecord->data.data();
+        _blockOffsets.push_back(_blockData.size());
+        _blockData.insert(_blockData.end(), data, data + nextRecord->data.size());
+        _blockRecordIds.push_back(nextRecord->id.repr());
     }
 
-    if (_tracker && _tracker->trackProgress<TrialRunProgressTracker::kNumReads>(1)) {
+    // The columns are only filled in once the whole block has been read, as '_blockData' may be
+    // reallocated while it is growing.
+    const auto numRows = _blockOffsets.size();
+    for (size_t row = 0; row < numRows; ++row) {
+        auto rawBson = _blockData.data() + _blockOffsets[row];
+
+        if (_recordAccessor) {
+            _recordColumn.tags[row] = value::TypeTags::bsonObject;
+            _recordColumn.vals[row] = value::bitcastFrom<const char*>(rawBson);
+        }
+
+        if (_recordIdAccessor) {
+            _recordIdColumn.tags[row] = value::TypeTags::NumberInt64;
+            _recordIdColumn.vals[row] = value::bitcastFrom<int64_t>(_blockRecordIds[row]);
+        }
+
+        if (!_fieldColumns.empty()) {
+            for (auto& [name, column] : _fieldColumns) {
+                column.tags[row] = value::TypeTags::Nothing;
+                column.vals[row] = 0;
+            }
+            extractFields(_fieldColumns,
+                          rawBson,
+                          [row](auto& column, value::TypeTags tag, value::Value val) {
+                              column.tags[row] = tag;
+                              column.vals[row] = val;
+                          });
+        }
+    }
+
+    if (_filterCode) {
+        _bytecode.runPredicateBlock(_filterCode.get(), _blockBindings, numRows, &_blockSelection);
+    } else {
+        _blockSelection.resize(numRows);
+        std::iota(_blockSelection.begin(), _blockSelection.end(), 0);
+    }
+}
+
+void ScanStage::trackBlockReads(size_t numRows) {
+    if (numRows > _blockRowsRead) {
+        trackReads(numRows - _blockRowsRead);
+        _blockRowsRead = numRows;
+    }
+}
+
+void ScanStage::trackReads(size_t numReads) {
+    if (_tracker && _tracker->trackProgress<TrialRunProgressTracker::kNumReads>(numReads)) {
         // If we're collecting execution stats during multi-planning and reached the end of the
         // trial period (trackProgress() will return 'true' in this case), then we can reset the
         // tracker. Note that a trial period is executed only once per a PlanStge tree, and once
         // completed never run again on the same tree.
         _tracker = nullptr;
     }
-    ++_specificStats.numReads;
-    return trackPlanState(PlanState::ADVANCED);
+    _specificStats.numReads += numReads;
 }
 
 void ScanStage::close() {
@@ -313,6 +492,17 @@ std::vector<DebugPrinter::Block> ScanStage::debugPrint() const {
     DebugPrinter::addIdentifier(ret, _name.toString());
     ret.emplace_back("`\"");
 
+    if (_blockSize) {
+        DebugPrinter::addKeyword(ret, "block");
+        ret.emplace_back(std::to_string(_blockSize));
+    }
+
+    if (_filter) {
+        ret.emplace_back("{`");
+        DebugPrinter::addBlocks(ret, _filter->debugPrint());
+        ret.emplace_back("`}");
+    }
+
     return ret;
 }
 
@@ -483,11 +673,27 @@ void ParallelScanStage::open(bool reOpen) {
 
 boost::optional<Record> ParallelScanStage::nextRange() {
     invariant(_cursor);
+    if (_hasClaimedRange) {
+        // The producers cannot be yielded by the query's yield policy, so the locks and storage
+        // snapshot are released between ranges instead.
+        saveState();
+        _opCtx->recoveryUnit()->abandonSnapshot();
+        restoreState();
+    }
+
     _currentRange = _state->currentRange.fetchAndAdd(1);
+    _hasClaimedRange = true;
     if (_currentRange < _state->ranges.size()) {
         _range = _state->ranges[_currentRange];
 
-        return _range.begin.isNull() ? _cursor->next() : _cursor->seekExact(_range.begin);
+        if (_range.begin.isNull()) {
+            return _cursor->next();
+        }
+
+        // The record the range starts at may have been deleted since the ranges were sampled, so
+        // position the cursor on the first record at or after it. If that record is past the end
+        // of the range, the caller moves on to the next range.
+        return _cursor->seekNear(_range.begin);
     } else {
         return boost::none;
     }
@@ -510,7 +716,8 @@ PlanState ParallelScanStage::getNext() {
             return PlanState::IS_EOF;
         }
 
-        if (!_range.end.isNull() && nextRecord->id == _range.end) {
+        // Compare with '>=', as the record the next range starts at may have been deleted.
+        if (!_range.end.isNull() && nextRecord->id >= _range.end) {
             setNeedsRange();
             nextRecord = boost::none;
         }
@@ -30,8 +30,10 @@
 #pragma once
 
 #include "mongo/db/db_raii.h"
+#include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/exec/sbe/vm/vm.h"
 #include "mongo/db/exec/trial_run_progress_tracker.h"
 #include "mongo/db/storage/record_store.h"
 
@@ -39,6 +41,15 @@ namespace mongo {
 namespace sbe {
 using ScanOpenCallback = std::function<void(OperationContext*, const Collection*, bool)>;
 
+/**
+ * A collection scan. When 'blockSize' is non-zero the scan runs in block mode: it reads up to
+ * 'blockSize' records at a time into a buffer owned by the stage, decodes the requested fields of
+ * all of them into columns, and evaluates the optional 'filter' over the whole block with
+ * vm::ByteCode::runPredicateBlock(). Only the records passing the filter are then returned from
+ * getNext(), one at a time. The filter may only reference slots produced by this stage and
+ * correlated slots which do not change while the scan is open. Block mode is not supported for
+ * seeks.
+ */
 class ScanStage final : public PlanStage {
 public:
     ScanStage(const NamespaceStringOrUUID& name,
@@ -50,7 +61,9 @@ public:
               bool forward,
               PlanYieldPolicy* yieldPolicy,
               TrialRunProgressTracker* tracker,
-              ScanOpenCallback openCallback = {});
+              ScanOpenCallback openCallback = {},
+              std::unique_ptr<EExpression> filter = nullptr,
+              size_t blockSize = 0);
 
     std::unique_ptr<PlanStage> clone() const final;
 
@@ -69,8 +82,30 @@ protected:
     void doRestoreState() override;
     void doDetachFromOperationContext() override;
     void doAttachFromOperationContext(OperationContext* opCtx) override;
+    void doRebindTrialRunProgressTracker(TrialRunProgressTracker* tracker) override;
 
 private:
+    struct BlockColumn {
+        std::vector<value::TypeTags> tags;
+        std::vector<value::Value> vals;
+    };
+
+    PlanState getNextFromBlock();
+
+    /**
+     * Reads the next block of records from the cursor, decodes it into the columns and fills in
+     * '_blockSelection' with the positions of the records passing the filter.
+     */
+    void fillBlock();
+
+    /**
+     * Counts the rows of the current block before position 'numRows' as read, unless they have
+     * been counted already.
+     */
+    void trackBlockReads(size_t numRows);
+
+    void trackReads(size_t numReads);
+
     const NamespaceStringOrUUID _name;
     const boost::optional<value::SlotId> _recordSlot;
     const boost::optional<value::SlotId> _recordIdSlot;
@@ -85,6 +120,9 @@ private:
 
     ScanOpenCallback _openCallback;
 
+    const std::unique_ptr<EExpression> _filter;
+    const size_t _blockSize;
+
     std::unique_ptr<value::ViewOfValueAccessor> _recordAccessor;
     std::unique_ptr<value::ViewOfValueAccessor> _recordIdAccessor;
 
@@ -99,6 +137,27 @@ private:
     RecordId _key;
     bool _firstGetNext{false};
 
+    // Block mode state. The records of the current block are copied back to back into
+    // '_blockData', as the data of a record is only valid until the cursor moves on. The rows
+    // which have not been returned yet are discarded on a yield, and re-read from
+    // '_blockResumeId' when the next block is filled, so they are never returned stale.
+    std::unique_ptr<vm::CodeFragment> _filterCode;
+    vm::ByteCode _bytecode;
+    vm::BlockBindings _blockBindings;
+    std::vector<value::ViewOfValueAccessor*> _blockAccessors;
+    std::vector<char> _blockData;
+    std::vector<size_t> _blockOffsets;
+    std::vector<int64_t> _blockRecordIds;
+    BlockColumn _recordColumn;
+    BlockColumn _recordIdColumn;
+    absl::flat_hash_map<std::string, BlockColumn> _fieldColumns;
+    std::vector<uint32_t> _blockSelection;
+    size_t _blockPosition{0};
+    size_t _blockRowsRead{0};
+    bool _blockEof{false};
+    bool _fillingBlock{false};
+    boost::optional<RecordId> _blockResumeId;
+
     ScanStats _specificStats;
 };
 
@@ -172,6 +231,7 @@ private:
 
     size_t _currentRange{std::numeric_limits<std::size_t>::max()};
     Range _range;
+    bool _hasClaimedRange{false};
 
     bool _open{false};
 
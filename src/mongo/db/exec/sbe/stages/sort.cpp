@@ -74,6 +74,12 @@ std::unique_ptr<PlanStage> SortStage::clone() const {
         _children[0]->clone(), _obs, _dirs, _vals, _limit, _memoryLimit, _allowDiskUse, _tracker);
 }
 
+void SortStage::doRebindTrialRunProgressTracker(TrialRunProgressTracker* tracker) {
+    if (_tracker) {
+        _tracker = tracker;
+    }
+}
+
 void SortStage::prepare(CompileCtx& ctx) {
     _children[0]->prepare(ctx);
 
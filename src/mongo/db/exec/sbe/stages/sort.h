@@ -65,6 +65,9 @@ public:
     const SpecificStats* getSpecificStats() const final;
     std::vector<DebugPrinter::Block> debugPrint() const final;
 
+protected:
+    void doRebindTrialRunProgressTracker(TrialRunProgressTracker* tracker) override;
+
 private:
     void makeSorter();
 
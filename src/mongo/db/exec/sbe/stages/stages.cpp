@@ -75,5 +75,17 @@ void CanChangeState::restoreState() {
 
     doRestoreState();
 }
+
+void PlanStage::rebindYieldPolicyAndTracker(PlanYieldPolicy* yieldPolicy,
+                                            TrialRunProgressTracker* tracker) {
+    for (auto&& child : _children) {
+        child->rebindYieldPolicyAndTracker(yieldPolicy, tracker);
+    }
+
+    if (_yieldPolicy) {
+        _yieldPolicy = yieldPolicy;
+    }
+    doRebindTrialRunProgressTracker(tracker);
+}
 }  // namespace sbe
 }  // namespace mongo
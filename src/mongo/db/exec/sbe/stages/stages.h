@@ -38,6 +38,8 @@
 #include "mongo/db/query/plan_yield_policy.h"
 
 namespace mongo {
+class TrialRunProgressTracker;
+
 namespace sbe {
 
 struct CompileCtx;
@@ -208,7 +210,7 @@ public:
     }
 
 protected:
-    PlanYieldPolicy* const _yieldPolicy{nullptr};
+    PlanYieldPolicy* _yieldPolicy{nullptr};
 
 private:
     static const int kInterruptCheckPeriod = 128;
@@ -275,10 +277,24 @@ public:
 
     virtual std::vector<DebugPrinter::Block> debugPrint() const = 0;
 
+    /**
+     * Hands a tree which has not been prepared yet over to a new yield policy and trial run
+     * progress tracker. This is used when a tree cloned from the SBE plan cache is reused by a new
+     * query: only stages which were originally built with a yield policy, or a tracker, are
+     * switched to the new ones.
+     *
+     * Propagates to all children, then calls doRebindTrialRunProgressTracker().
+     */
+    void rebindYieldPolicyAndTracker(PlanYieldPolicy* yieldPolicy,
+                                     TrialRunProgressTracker* tracker);
+
     friend class CanSwitchOperationContext;
     friend class CanChangeState;
 
 protected:
+    // Stages which track trial run progress must override this method.
+    virtual void doRebindTrialRunProgressTracker(TrialRunProgressTracker* tracker) {}
+
     std::vector<std::unique_ptr<PlanStage>> _children;
 };
 
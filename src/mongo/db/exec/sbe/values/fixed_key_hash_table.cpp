@@ -0,0 +1,253 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/values/fixed_key_hash_table.h"
+
+#include <cstring>
+
+namespace mongo::sbe::value {
+namespace {
+constexpr size_t kInitialNumBuckets = 64;
+// An ObjectId is stored in two words, all other key types in one.
+constexpr size_t kMaxKeyWidth = 2;
+
+size_t keyWidth(TypeTags tag) {
+    return isObjectId(tag) ? 2 : 1;
+}
+
+/**
+ * Writes the 'width' words representing the fixed-width value to 'out'.
+ */
+void storeKey(TypeTags tag, Value val, uint64_t* out) {
+    if (tag == TypeTags::ObjectId) {
+        out[1] = 0;
+        memcpy(out, getObjectIdView(val)->data(), sizeof(ObjectIdType));
+    } else if (tag == TypeTags::bsonObjectId) {
+        out[1] = 0;
+        memcpy(out, bitcastTo<const char*>(val), sizeof(ObjectIdType));
+    } else if (tag == TypeTags::NumberInt32) {
+        // Only the low 32 bits of the value are meaningful.
+        out[0] = static_cast<uint32_t>(bitcastTo<int32_t>(val));
+    } else {
+        out[0] = val;
+    }
+}
+
+size_t mix(size_t hash, uint64_t word) {
+    hash ^= word + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+}  // namespace
+
+FixedKeyHashTable::FixedKeyHashTable(size_t numKeys, size_t numAggs)
+    : _numKeys(numKeys), _numAggs(numAggs) {
+    invariant(numKeys > 0 && numKeys <= kMaxKeys);
+    _keyTags.fill(TypeTags::Nothing);
+    _keyWidths.fill(1);
+    _buckets.resize(kInitialNumBuckets);
+}
+
+FixedKeyHashTable::~FixedKeyHashTable() {
+    clear();
+}
+
+bool FixedKeyHashTable::isFixedWidth(TypeTags tag) {
+    switch (tag) {
+        case TypeTags::NumberInt32:
+        case TypeTags::NumberInt64:
+        case TypeTags::NumberDouble:
+        case TypeTags::Date:
+        case TypeTags::ObjectId:
+        case TypeTags::bsonObjectId:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t FixedKeyHashTable::hashKey(const TypeTags* tags, const Value* vals) const {
+    size_t hash = 0;
+    for (size_t idx = 0; idx < _numKeys; ++idx) {
+        std::array<uint64_t, kMaxKeyWidth> words;
+        storeKey(tags[idx], vals[idx], words.data());
+        if (tags[idx] == TypeTags::NumberDouble && bitcastTo<double>(vals[idx]) == 0) {
+            // Negative zero is equal to positive zero, so they must hash the same.
+            words[0] = 0;
+        }
+        for (size_t word = 0; word < keyWidth(tags[idx]); ++word) {
+            hash = mix(hash, words[word]);
+        }
+    }
+    return hash;
+}
+
+bool FixedKeyHashTable::keyEquals(size_t group, const TypeTags* tags, const Value* vals) const {
+    for (size_t idx = 0; idx < _numKeys; ++idx) {
+        auto width = _keyWidths[idx];
+        const uint64_t* stored = &_keyColumns[idx][group * width];
+        std::array<uint64_t, kMaxKeyWidth> words;
+        storeKey(tags[idx], vals[idx], words.data());
+
+        if (tags[idx] == TypeTags::NumberDouble) {
+            // Comparing the bits would make -0.0 differ from 0.0 and NaN equal to itself.
+            if (bitcastTo<double>(stored[0]) != bitcastTo<double>(words[0])) {
+                return false;
+            }
+        } else if (memcmp(stored, words.data(), width * sizeof(uint64_t)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t FixedKeyHashTable::find(const TypeTags* tags, const Value* vals) const {
+    for (size_t idx = 0; idx < _numKeys; ++idx) {
+        if (tags[idx] != _keyTags[idx]) {
+            return kNoGroup;
+        }
+    }
+
+    auto hash = static_cast<uint32_t>(hashKey(tags, vals));
+    auto mask = _buckets.size() - 1;
+    for (auto bucket = hash & mask; _buckets[bucket]; bucket = (bucket + 1) & mask) {
+        auto group = _buckets[bucket] - 1;
+        if (_hashes[group] == hash && keyEquals(group, tags, vals)) {
+            return group;
+        }
+    }
+    return kNoGroup;
+}
+
+bool FixedKeyHashTable::canStore(const TypeTags* tags) const {
+    for (size_t idx = 0; idx < _numKeys; ++idx) {
+        if (tags[idx] != _keyTags[idx] &&
+            (_keyTags[idx] != TypeTags::Nothing || !isFixedWidth(tags[idx]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::pair<size_t, bool> FixedKeyHashTable::findOrInsert(const TypeTags* tags, const Value* vals) {
+    if (!canStore(tags) || _size == std::numeric_limits<uint32_t>::max() - 1) {
+        return {kNoGroup, false};
+    }
+
+    auto hash = static_cast<uint32_t>(hashKey(tags, vals));
+    auto mask = _buckets.size() - 1;
+    auto bucket = hash & mask;
+    for (; _buckets[bucket]; bucket = (bucket + 1) & mask) {
+        auto group = _buckets[bucket] - 1;
+        if (_hashes[group] == hash && keyEquals(group, tags, vals)) {
+            return {group, false};
+        }
+    }
+
+    if (_size == 0) {
+        for (size_t idx = 0; idx < _numKeys; ++idx) {
+            _keyTags[idx] = tags[idx];
+            _keyWidths[idx] = keyWidth(tags[idx]);
+        }
+    }
+
+    auto group = _size++;
+    for (size_t idx = 0; idx < _numKeys; ++idx) {
+        auto& column = _keyColumns[idx];
+        column.resize(column.size() + _keyWidths[idx]);
+        storeKey(tags[idx], vals[idx], &column[group * _keyWidths[idx]]);
+    }
+    _aggTags.resize(_aggTags.size() + _numAggs, TypeTags::Nothing);
+    _aggVals.resize(_aggVals.size() + _numAggs, 0);
+    _aggOwned.resize(_aggOwned.size() + _numAggs, false);
+    _hashes.push_back(hash);
+    _buckets[bucket] = group + 1;
+
+    // Keep the load factor at or below one half so that the probe sequences stay short.
+    if (_size * 2 > _buckets.size()) {
+        rehash(_buckets.size() * 2);
+    }
+    return {group, true};
+}
+
+void FixedKeyHashTable::rehash(size_t numBuckets) {
+    _buckets.assign(numBuckets, 0);
+    auto mask = numBuckets - 1;
+    for (size_t group = 0; group < _size; ++group) {
+        auto bucket = _hashes[group] & mask;
+        while (_buckets[bucket]) {
+            bucket = (bucket + 1) & mask;
+        }
+        _buckets[bucket] = group + 1;
+    }
+}
+
+void FixedKeyHashTable::clear() {
+    for (size_t pos = 0; pos < _aggOwned.size(); ++pos) {
+        if (_aggOwned[pos]) {
+            releaseValue(_aggTags[pos], _aggVals[pos]);
+        }
+    }
+    _aggTags.clear();
+    _aggVals.clear();
+    _aggOwned.clear();
+    for (auto& column : _keyColumns) {
+        column.clear();
+    }
+    _keyTags.fill(TypeTags::Nothing);
+    _keyWidths.fill(1);
+    _hashes.clear();
+    _buckets.assign(kInitialNumBuckets, 0);
+    _size = 0;
+}
+
+std::pair<TypeTags, Value> FixedKeyHashTable::getKey(size_t group, size_t idx) const {
+    auto tag = _keyTags[idx];
+    const uint64_t* stored = &_keyColumns[idx][group * _keyWidths[idx]];
+    if (isObjectId(tag)) {
+        // Both kinds of ObjectId values point to the 12 bytes of the ObjectId.
+        return {tag, bitcastFrom<const uint64_t*>(stored)};
+    } else if (tag == TypeTags::NumberInt32) {
+        return {tag, bitcastFrom<int32_t>(static_cast<int32_t>(stored[0]))};
+    }
+    return {tag, stored[0]};
+}
+
+size_t FixedKeyHashTable::bytesPerGroup() const {
+    size_t bytes = sizeof(uint32_t) * 3;  // The hash and, at the maximum load factor, two buckets.
+    for (size_t idx = 0; idx < _numKeys; ++idx) {
+        bytes += _keyWidths[idx] * sizeof(uint64_t);
+    }
+    return bytes + _numAggs * (sizeof(TypeTags) + sizeof(Value) + sizeof(uint8_t));
+}
+}  // namespace mongo::sbe::value
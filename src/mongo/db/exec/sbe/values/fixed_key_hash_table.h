@@ -0,0 +1,152 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <limits>
+#include <vector>
+
+#include "mongo/db/exec/sbe/values/value.h"
+
+namespace mongo::sbe::value {
+/**
+ * An open-addressing hash table mapping group keys of one or two fixed-width values to a row of
+ * aggregate values.
+ *
+ * Every key column holds values of a single type, which is fixed by the first key inserted into
+ * the table. Keys of a different type, or of a type which is not fixed-width, are rejected and the
+ * caller has to fall back to a generic table. Two keys are equal if all their values compare equal
+ * according to 'compareValue()', so the table groups rows exactly as a generic table would.
+ *
+ * The groups are numbered densely in insertion order. The key values and the aggregate values are
+ * stored inline in contiguous arrays indexed by the group number, so inserting a group does not
+ * allocate memory unless the arrays grow.
+ */
+class FixedKeyHashTable {
+public:
+    static constexpr size_t kMaxKeys = 2;
+    static constexpr size_t kNoGroup = std::numeric_limits<size_t>::max();
+
+    FixedKeyHashTable(size_t numKeys, size_t numAggs);
+    FixedKeyHashTable(const FixedKeyHashTable&) = delete;
+    FixedKeyHashTable& operator=(const FixedKeyHashTable&) = delete;
+    ~FixedKeyHashTable();
+
+    /**
+     * Returns true if values of type 'tag' can be used as keys of this table.
+     */
+    static bool isFixedWidth(TypeTags tag);
+
+    /**
+     * Returns true if a key made of values of the given types can be stored in this table.
+     */
+    bool canStore(const TypeTags* tags) const;
+
+    /**
+     * Returns the group of the key made of 'numKeys' values, inserting a new group with all
+     * aggregate values set to Nothing if there is none, and whether a group was inserted. Returns
+     * 'kNoGroup' if the key cannot be stored in this table or the table is full.
+     */
+    std::pair<size_t, bool> findOrInsert(const TypeTags* tags, const Value* vals);
+
+    /**
+     * Returns the group of the key made of 'numKeys' values, or 'kNoGroup' if there is none.
+     */
+    size_t find(const TypeTags* tags, const Value* vals) const;
+
+    /**
+     * Removes all groups. The types of the key columns are reset as well.
+     */
+    void clear();
+
+    size_t size() const {
+        return _size;
+    }
+
+    /**
+     * The returned view remains valid until the next insertion into the table.
+     */
+    std::pair<TypeTags, Value> getKey(size_t group, size_t idx) const;
+
+    std::pair<TypeTags, Value> getAgg(size_t group, size_t idx) const {
+        auto pos = group * _numAggs + idx;
+        return {_aggTags[pos], _aggVals[pos]};
+    }
+
+    std::pair<TypeTags, Value> copyOrMoveAgg(size_t group, size_t idx) {
+        auto pos = group * _numAggs + idx;
+        if (_aggOwned[pos]) {
+            _aggOwned[pos] = false;
+            return {_aggTags[pos], _aggVals[pos]};
+        }
+        return copyValue(_aggTags[pos], _aggVals[pos]);
+    }
+
+    void resetAgg(size_t group, size_t idx, bool owned, TypeTags tag, Value val) {
+        auto pos = group * _numAggs + idx;
+        if (_aggOwned[pos]) {
+            releaseValue(_aggTags[pos], _aggVals[pos]);
+        }
+        _aggTags[pos] = tag;
+        _aggVals[pos] = val;
+        _aggOwned[pos] = owned;
+    }
+
+    /**
+     * Returns the amount of memory used by the table for every group, not including the memory
+     * the aggregate values point to.
+     */
+    size_t bytesPerGroup() const;
+
+private:
+    size_t hashKey(const TypeTags* tags, const Value* vals) const;
+    bool keyEquals(size_t group, const TypeTags* tags, const Value* vals) const;
+    void rehash(size_t numBuckets);
+
+    const size_t _numKeys;
+    const size_t _numAggs;
+
+    // The type of the values in every key column, or Nothing if the table has been empty so far.
+    std::array<TypeTags, kMaxKeys> _keyTags;
+    // The number of 64-bit words every value of a key column is stored in.
+    std::array<size_t, kMaxKeys> _keyWidths;
+    std::array<std::vector<uint64_t>, kMaxKeys> _keyColumns;
+
+    std::vector<TypeTags> _aggTags;
+    std::vector<Value> _aggVals;
+    std::vector<uint8_t> _aggOwned;
+
+    // The hash of the key of every group, kept so that growing the table does not rehash the keys.
+    std::vector<uint32_t> _hashes;
+    // For every bucket, the number of the group stored in it plus one, or zero if it is empty.
+    std::vector<uint32_t> _buckets;
+    size_t _size{0};
+};
+}  // namespace mongo::sbe::value
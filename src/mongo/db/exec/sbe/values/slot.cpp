@@ -287,7 +287,7 @@ void MaterializedRow::serializeForSorter(BufBuilder& buf) const {
     }
 }
 
-static int getApproximateSize(TypeTags tag, Value val) {
+int getApproximateSize(TypeTags tag, Value val) {
     int result = sizeof(tag) + sizeof(val);
     switch (tag) {
         // These are shallow types.
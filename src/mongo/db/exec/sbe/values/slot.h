@@ -560,6 +560,11 @@ struct MaterializedRowHasher {
     }
 };
 
+/**
+ * Returns the approximate amount of memory used by the value, including the memory it points to.
+ */
+int getApproximateSize(TypeTags tag, Value val);
+
 /**
  * Read the components of the 'keyString' value and populate 'accessors' with those components. Some
  * components are appended into the 'valueBufferBuilder' object's internal buffer, and the accessors
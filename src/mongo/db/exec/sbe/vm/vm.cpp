@@ -389,6 +389,7 @@ ByteCode::~ByteCode() {
             value::releaseValue(_argStackTags[i], _argStackVals[i]);
         }
     }
+    releaseBlockStack();
 }
 
 std::tuple<bool, value::TypeTags, value::Value> ByteCode::getField(value::TypeTags objTag,
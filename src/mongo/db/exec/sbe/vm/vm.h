@@ -319,6 +319,64 @@ private:
     int _stackSize{0};
 };
 
+/**
+ * The values of a slot for each row of a block, used by the block execution mode of the ByteCode.
+ * The arrays must hold as many values as there are rows in the block.
+ */
+struct ValueBlock {
+    const value::TypeTags* tags;
+    const value::Value* vals;
+};
+
+/**
+ * Binds the slot accessors read by a CodeFragment to the blocks holding their values.
+ */
+using BlockBindings = std::vector<std::pair<value::SlotAccessor*, ValueBlock>>;
+
+class ByteCode;
+struct ClosureSteps;
+
+/**
+ * A CodeFragment translated ahead of time into a sequence of closures. Every step holds a pointer
+ * to a function specialized for one instruction, or for a common sequence of instructions such as
+ * comparing a slot to a constant, together with its already decoded operands. Running the steps
+ * avoids decoding the byte stream and dispatching through the interpreter's switch.
+ */
+class ClosureFragment {
+public:
+    /**
+     * Returns nullptr if 'code' uses an instruction the closure compiler does not support, in which
+     * case the CodeFragment has to be run by the interpreter.
+     */
+    static std::unique_ptr<ClosureFragment> compile(const CodeFragment* code);
+
+    size_t numSteps() const {
+        return _steps.size();
+    }
+
+private:
+    friend class ByteCode;
+    friend struct ClosureSteps;
+
+    struct Step;
+
+    // Executes the step at position 'pc' and returns the position of the next step to execute.
+    using StepFn = size_t (*)(ByteCode& vm, const Step& step, size_t pc);
+
+    struct Step {
+        StepFn fn;
+        value::SlotAccessor* accessor{nullptr};
+        value::TypeTags tag{value::TypeTags::Nothing};
+        value::Value val{0};
+        // A stack offset, the position of a jump target, a type mask or a builtin, depending on
+        // the step.
+        int64_t operand{0};
+        uint8_t arity{0};
+    };
+
+    std::vector<Step> _steps;
+};
+
 class ByteCode {
 public:
     ~ByteCode();
@@ -326,7 +384,64 @@ public:
     std::tuple<uint8_t, value::TypeTags, value::Value> run(const CodeFragment* code);
     bool runPredicate(const CodeFragment* code);
 
+    std::tuple<uint8_t, value::TypeTags, value::Value> run(const ClosureFragment* code);
+    bool runPredicate(const ClosureFragment* code);
+
+    /**
+     * Evaluates the predicate 'code' over a block of 'blockSize' rows and appends the positions of
+     * the rows for which it returns true to 'selection', in increasing order.
+     *
+     * Each instruction is executed for all rows of the block before moving to the next one, so the
+     * cost of dispatching an instruction is paid once per block rather than once per row. Rows
+     * which take different branches are executed as separate groups which merge again once they
+     * reach the same instruction. Accessors bound in 'bindings' produce the value of each row from
+     * their block, all other accessors are read once and their value is shared by the whole block.
+     */
+    void runPredicateBlock(const CodeFragment* code,
+                           const BlockBindings& bindings,
+                           size_t blockSize,
+                           std::vector<uint32_t>* selection);
+
 private:
+    friend struct ClosureSteps;
+
+    /**
+     * One slot of the evaluation stack in block execution mode, holding a value for each row.
+     */
+    struct BlockStackSlot {
+        std::vector<uint8_t> owned;
+        std::vector<value::TypeTags> tags;
+        std::vector<value::Value> vals;
+    };
+
+    /**
+     * A group of rows of the block which are at the same instruction, with the same stack depth.
+     */
+    struct BlockRowGroup {
+        const uint8_t* pc;
+        size_t stackSize;
+        std::vector<uint32_t> rows;
+    };
+
+    void runBlockGroup(BlockRowGroup& group,
+                       const uint8_t* pcStop,
+                       const BlockBindings& bindings,
+                       std::vector<BlockRowGroup>* pendingGroups);
+    BlockStackSlot& pushBlockStack(BlockRowGroup& group);
+    void releaseBlockStack();
+
+    template <typename Op>
+    void blockUnaryOp(BlockRowGroup& group, Op op);
+    template <typename Op>
+    void blockTypeCheck(BlockRowGroup& group, Op op);
+    template <typename Op>
+    void blockBinaryOp(BlockRowGroup& group, Op op);
+    template <typename Op, typename GenericOp>
+    void blockCompare(BlockRowGroup& group, Op op, GenericOp genericOp);
+
+    std::vector<BlockStackSlot> _blockStack;
+    size_t _blockCapacity{0};
+
     std::vector<uint8_t> _argStackOwned;
     std::vector<value::TypeTags> _argStackTags;
     std::vector<value::Value> _argStackVals;
@@ -0,0 +1,614 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace mongo {
+namespace sbe {
+namespace vm {
+
+void ByteCode::runPredicateBlock(const CodeFragment* code,
+                                 const BlockBindings& bindings,
+                                 size_t blockSize,
+                                 std::vector<uint32_t>* selection) {
+    invariant(selection);
+
+    // An exception thrown while evaluating the previous block may have left values on the stack.
+    releaseBlockStack();
+
+    if (blockSize > _blockCapacity) {
+        for (auto& slot : _blockStack) {
+            slot.owned.resize(blockSize, false);
+            slot.tags.resize(blockSize);
+            slot.vals.resize(blockSize);
+        }
+        _blockCapacity = blockSize;
+    }
+
+    const auto pcEnd = code->instrs().data() + code->instrs().size();
+    const auto firstSelected = selection->size();
+
+    std::vector<BlockRowGroup> groups;
+    groups.push_back(BlockRowGroup{code->instrs().data(), 0, std::vector<uint32_t>(blockSize)});
+    std::iota(groups.back().rows.begin(), groups.back().rows.end(), 0);
+
+    while (!groups.empty()) {
+        // Always advance the group which is furthest behind. Jumps only go forward, so every group
+        // which is going to execute an instruction reaches it before it is executed, and all such
+        // groups are merged together.
+        auto it = std::min_element(groups.begin(), groups.end(), [](auto&& lhs, auto&& rhs) {
+            return lhs.pc < rhs.pc;
+        });
+        auto group = std::move(*it);
+        groups.erase(it);
+
+        auto pcStop = pcEnd;
+        for (auto other = groups.begin(); other != groups.end();) {
+            if (other->pc == group.pc) {
+                invariant(other->stackSize == group.stackSize);
+                group.rows.insert(group.rows.end(), other->rows.begin(), other->rows.end());
+                other = groups.erase(other);
+            } else {
+                pcStop = std::min(pcStop, other->pc);
+                ++other;
+            }
+        }
+
+        if (group.pc != pcEnd) {
+            runBlockGroup(group, pcStop, bindings, &groups);
+            if (!group.rows.empty()) {
+                groups.push_back(std::move(group));
+            }
+            continue;
+        }
+
+        uassert(5095400,
+                "The evaluation stack must hold only a single value",
+                group.stackSize == 1);
+
+        auto& result = _blockStack[0];
+        for (auto row : group.rows) {
+            if (result.tags[row] == value::TypeTags::Boolean && result.vals[row] != 0) {
+                selection->push_back(row);
+            }
+            if (result.owned[row]) {
+                value::releaseValue(result.tags[row], result.vals[row]);
+                result.owned[row] = false;
+            }
+        }
+    }
+
+    std::sort(selection->begin() + firstSelected, selection->end());
+}
+
+void ByteCode::runBlockGroup(BlockRowGroup& group,
+                             const uint8_t* pcStop,
+                             const BlockBindings& bindings,
+                             std::vector<BlockRowGroup>* pendingGroups) {
+    auto pcPointer = group.pc;
+
+    // Moves the rows for which 'predicate' holds to a new group starting at 'target'. Returns true
+    // if the rows of 'group' have been split and the scheduler needs to pick the next group.
+    auto branch = [&](const uint8_t* target, auto&& predicate) {
+        auto taken = std::stable_partition(group.rows.begin(), group.rows.end(), predicate);
+        if (taken == group.rows.begin()) {
+            return false;
+        }
+        if (taken == group.rows.end()) {
+            pcPointer = target;
+            return true;
+        }
+        pendingGroups->push_back(BlockRowGroup{
+            target, group.stackSize, std::vector<uint32_t>(group.rows.begin(), taken)});
+        group.rows.erase(group.rows.begin(), taken);
+        return true;
+    };
+
+    while (pcPointer != pcStop) {
+        Instruction i = value::readFromMemory<Instruction>(pcPointer);
+        pcPointer += sizeof(i);
+        switch (i.tag) {
+            case Instruction::pushConstVal: {
+                auto tag = value::readFromMemory<value::TypeTags>(pcPointer);
+                pcPointer += sizeof(tag);
+                auto val = value::readFromMemory<value::Value>(pcPointer);
+                pcPointer += sizeof(val);
+
+                auto& slot = pushBlockStack(group);
+                for (auto row : group.rows) {
+                    slot.tags[row] = tag;
+                    slot.vals[row] = val;
+                }
+                break;
+            }
+            case Instruction::pushAccessVal: {
+                auto accessor = value::readFromMemory<value::SlotAccessor*>(pcPointer);
+                pcPointer += sizeof(accessor);
+
+                auto& slot = pushBlockStack(group);
+                auto binding = std::find_if(bindings.begin(),
+                                            bindings.end(),
+                                            [&](auto&& b) { return b.first == accessor; });
+                if (binding != bindings.end()) {
+                    const auto& block = binding->second;
+                    for (auto row : group.rows) {
+                        slot.tags[row] = block.tags[row];
+                        slot.vals[row] = block.vals[row];
+                    }
+                } else {
+                    auto [tag, val] = accessor->getViewOfValue();
+                    for (auto row : group.rows) {
+                        slot.tags[row] = tag;
+                        slot.vals[row] = val;
+                    }
+                }
+                break;
+            }
+            case Instruction::pushMoveVal: {
+                auto accessor = value::readFromMemory<value::SlotAccessor*>(pcPointer);
+                pcPointer += sizeof(accessor);
+
+                // Every row needs a value of its own, so they are copied rather than moved out of
+                // the accessor.
+                auto& slot = pushBlockStack(group);
+                auto binding = std::find_if(bindings.begin(),
+                                            bindings.end(),
+                                            [&](auto&& b) { return b.first == accessor; });
+                for (auto row : group.rows) {
+                    auto [tag, val] = binding != bindings.end()
+                        ? value::copyValue(binding->second.tags[row], binding->second.vals[row])
+                        : std::apply(value::copyValue, accessor->getViewOfValue());
+                    slot.owned[row] = true;
+                    slot.tags[row] = tag;
+                    slot.vals[row] = val;
+                }
+                break;
+            }
+            case Instruction::pushLocalVal: {
+                auto stackOffset = value::readFromMemory<int>(pcPointer);
+                pcPointer += sizeof(stackOffset);
+
+                auto& slot = pushBlockStack(group);
+                const auto& local = _blockStack[group.stackSize - 2 - stackOffset];
+                for (auto row : group.rows) {
+                    slot.tags[row] = local.tags[row];
+                    slot.vals[row] = local.vals[row];
+                }
+                break;
+            }
+            case Instruction::pop: {
+                auto& slot = _blockStack[group.stackSize - 1];
+                for (auto row : group.rows) {
+                    if (slot.owned[row]) {
+                        value::releaseValue(slot.tags[row], slot.vals[row]);
+                        slot.owned[row] = false;
+                    }
+                }
+                --group.stackSize;
+                break;
+            }
+            case Instruction::swap: {
+                auto& rhs = _blockStack[group.stackSize - 1];
+                auto& lhs = _blockStack[group.stackSize - 2];
+                for (auto row : group.rows) {
+                    // Swap values only if they are not physically same, see ByteCode::run().
+                    if (!(rhs.tags[row] == lhs.tags[row] && rhs.vals[row] == lhs.vals[row])) {
+                        std::swap(rhs.owned[row], lhs.owned[row]);
+                        std::swap(rhs.tags[row], lhs.tags[row]);
+                        std::swap(rhs.vals[row], lhs.vals[row]);
+                    } else {
+                        invariant(!rhs.owned[row]);
+                    }
+                }
+                break;
+            }
+            case Instruction::add:
+                blockBinaryOp(group, [&](auto... args) { return genericAdd(args...); });
+                break;
+            case Instruction::sub:
+                blockBinaryOp(group, [&](auto... args) { return genericSub(args...); });
+                break;
+            case Instruction::mul:
+                blockBinaryOp(group, [&](auto... args) { return genericMul(args...); });
+                break;
+            case Instruction::div:
+                blockBinaryOp(group, [&](auto... args) { return genericDiv(args...); });
+                break;
+            case Instruction::idiv:
+                blockBinaryOp(group, [&](auto... args) { return genericIDiv(args...); });
+                break;
+            case Instruction::mod:
+                blockBinaryOp(group, [&](auto... args) { return genericMod(args...); });
+                break;
+            case Instruction::negate:
+                blockUnaryOp(group, [&](value::TypeTags tag, value::Value val) {
+                    return genericSub(value::TypeTags::NumberInt32, 0, tag, val);
+                });
+                break;
+            case Instruction::numConvert: {
+                auto targetTag = value::readFromMemory<value::TypeTags>(pcPointer);
+                pcPointer += sizeof(targetTag);
+
+                blockUnaryOp(group, [&](value::TypeTags tag, value::Value val) {
+                    return genericNumConvert(tag, val, targetTag);
+                });
+                break;
+            }
+            case Instruction::logicNot:
+                blockUnaryOp(group, [&](auto... args) { return genericNot(args...); });
+                break;
+            case Instruction::less:
+                blockCompare(group, std::less<>{}, [&](auto... args) {
+                    return genericCompare<std::less<>>(args...);
+                });
+                break;
+            case Instruction::lessEq:
+                blockCompare(group, std::less_equal<>{}, [&](auto... args) {
+                    return genericCompare<std::less_equal<>>(args...);
+                });
+                break;
+            case Instruction::greater:
+                blockCompare(group, std::greater<>{}, [&](auto... args) {
+                    return genericCompare<std::greater<>>(args...);
+                });
+                break;
+            case Instruction::greaterEq:
+                blockCompare(group, std::greater_equal<>{}, [&](auto... args) {
+                    return genericCompare<std::greater_equal<>>(args...);
+                });
+                break;
+            case Instruction::eq:
+                blockCompare(group, std::equal_to<>{}, [&](auto... args) {
+                    return genericCompareEq(args...);
+                });
+                break;
+            case Instruction::neq:
+                blockCompare(group, std::not_equal_to<>{}, [&](auto... args) {
+                    return genericCompareNeq(args...);
+                });
+                break;
+            case Instruction::cmp3w:
+                blockBinaryOp(group, [&](auto... args) {
+                    auto [tag, val] = compare3way(args...);
+                    return std::tuple<bool, value::TypeTags, value::Value>{false, tag, val};
+                });
+                break;
+            case Instruction::fillEmpty: {
+                auto& rhs = _blockStack[group.stackSize - 1];
+                auto& lhs = _blockStack[group.stackSize - 2];
+                for (auto row : group.rows) {
+                    if (lhs.tags[row] == value::TypeTags::Nothing) {
+                        lhs.owned[row] = rhs.owned[row];
+                        lhs.tags[row] = rhs.tags[row];
+                        lhs.vals[row] = rhs.vals[row];
+                    } else if (rhs.owned[row]) {
+                        value::releaseValue(rhs.tags[row], rhs.vals[row]);
+                    }
+                    rhs.owned[row] = false;
+                }
+                --group.stackSize;
+                break;
+            }
+            case Instruction::getField:
+                blockBinaryOp(group, [&](auto... args) { return getField(args...); });
+                break;
+            case Instruction::getElement:
+                blockBinaryOp(group, [&](auto... args) { return getElement(args...); });
+                break;
+            case Instruction::aggSum:
+                blockBinaryOp(group, [&](auto... args) { return aggSum(args...); });
+                break;
+            case Instruction::aggMin:
+                blockBinaryOp(group, [&](auto... args) { return aggMin(args...); });
+                break;
+            case Instruction::aggMax:
+                blockBinaryOp(group, [&](auto... args) { return aggMax(args...); });
+                break;
+            case Instruction::aggFirst:
+                blockBinaryOp(group, [&](auto... args) { return aggFirst(args...); });
+                break;
+            case Instruction::aggLast:
+                blockBinaryOp(group, [&](auto... args) { return aggLast(args...); });
+                break;
+            case Instruction::exists: {
+                auto& slot = _blockStack[group.stackSize - 1];
+                for (auto row : group.rows) {
+                    if (slot.owned[row]) {
+                        value::releaseValue(slot.tags[row], slot.vals[row]);
+                        slot.owned[row] = false;
+                    }
+                    slot.vals[row] =
+                        value::bitcastFrom(slot.tags[row] != value::TypeTags::Nothing);
+                    slot.tags[row] = value::TypeTags::Boolean;
+                }
+                break;
+            }
+            case Instruction::isNull:
+                blockTypeCheck(group,
+                               [](value::TypeTags tag) { return tag == value::TypeTags::Null; });
+                break;
+            case Instruction::isObject:
+                blockTypeCheck(group, [](value::TypeTags tag) { return value::isObject(tag); });
+                break;
+            case Instruction::isArray:
+                blockTypeCheck(group, [](value::TypeTags tag) { return value::isArray(tag); });
+                break;
+            case Instruction::isString:
+                blockTypeCheck(group, [](value::TypeTags tag) { return value::isString(tag); });
+                break;
+            case Instruction::isNumber:
+                blockTypeCheck(group, [](value::TypeTags tag) { return value::isNumber(tag); });
+                break;
+            case Instruction::isBinData:
+                blockTypeCheck(group, [](value::TypeTags tag) { return value::isBinData(tag); });
+                break;
+            case Instruction::isDate:
+                blockTypeCheck(group,
+                               [](value::TypeTags tag) { return tag == value::TypeTags::Date; });
+                break;
+            case Instruction::typeMatch: {
+                auto typeMask = value::readFromMemory<uint32_t>(pcPointer);
+                pcPointer += sizeof(typeMask);
+
+                blockTypeCheck(group, [&](value::TypeTags tag) {
+                    return static_cast<bool>(getBSONTypeMask(tag) & typeMask);
+                });
+                break;
+            }
+            case Instruction::function: {
+                auto f = value::readFromMemory<Builtin>(pcPointer);
+                pcPointer += sizeof(f);
+                auto arity = value::readFromMemory<uint8_t>(pcPointer);
+                pcPointer += sizeof(arity);
+
+                if (arity == 0) {
+                    pushBlockStack(group);
+                }
+                const auto firstArg = group.stackSize - std::max<size_t>(arity, 1);
+
+                // Builtins read their arguments from the regular evaluation stack, so they are
+                // called once per row with that row's arguments pushed as views.
+                for (auto row : group.rows) {
+                    for (size_t arg = 0; arg < arity; ++arg) {
+                        const auto& slot = _blockStack[firstArg + arg];
+                        pushStack(false, slot.tags[row], slot.vals[row]);
+                    }
+
+                    auto [owned, tag, val] = dispatchBuiltin(f, arity);
+
+                    for (size_t arg = 0; arg < arity; ++arg) {
+                        popStack();
+                        auto& slot = _blockStack[firstArg + arg];
+                        if (slot.owned[row]) {
+                            value::releaseValue(slot.tags[row], slot.vals[row]);
+                            slot.owned[row] = false;
+                        }
+                    }
+
+                    auto& result = _blockStack[firstArg];
+                    result.owned[row] = owned;
+                    result.tags[row] = tag;
+                    result.vals[row] = val;
+                }
+
+                group.stackSize = firstArg + 1;
+                break;
+            }
+            case Instruction::jmp: {
+                auto jumpOffset = value::readFromMemory<int>(pcPointer);
+                pcPointer += sizeof(jumpOffset);
+
+                pcPointer += jumpOffset;
+                group.pc = pcPointer;
+                return;
+            }
+            case Instruction::jmpTrue: {
+                auto jumpOffset = value::readFromMemory<int>(pcPointer);
+                pcPointer += sizeof(jumpOffset);
+
+                auto& slot = _blockStack[group.stackSize - 1];
+                --group.stackSize;
+                auto split = branch(pcPointer + jumpOffset, [&](uint32_t row) {
+                    auto taken = slot.tags[row] == value::TypeTags::Boolean && slot.vals[row];
+                    if (slot.owned[row]) {
+                        value::releaseValue(slot.tags[row], slot.vals[row]);
+                        slot.owned[row] = false;
+                    }
+                    return taken;
+                });
+                if (split) {
+                    group.pc = pcPointer;
+                    return;
+                }
+                break;
+            }
+            case Instruction::jmpNothing: {
+                auto jumpOffset = value::readFromMemory<int>(pcPointer);
+                pcPointer += sizeof(jumpOffset);
+
+                const auto& slot = _blockStack[group.stackSize - 1];
+                auto split = branch(pcPointer + jumpOffset, [&](uint32_t row) {
+                    return slot.tags[row] == value::TypeTags::Nothing;
+                });
+                if (split) {
+                    group.pc = pcPointer;
+                    return;
+                }
+                break;
+            }
+            case Instruction::fail: {
+                // The first row reaching the instruction fails the whole block.
+                const auto row = group.rows.front();
+                const auto& codeSlot = _blockStack[group.stackSize - 2];
+                invariant(codeSlot.tags[row] == value::TypeTags::NumberInt64);
+                auto& msgSlot = _blockStack[group.stackSize - 1];
+                invariant(value::isString(msgSlot.tags[row]));
+
+                ErrorCodes::Error code{
+                    static_cast<ErrorCodes::Error>(value::bitcastTo<int64_t>(codeSlot.vals[row]))};
+                std::string message{value::getStringView(msgSlot.tags[row], msgSlot.vals[row])};
+
+                uasserted(code, message);
+                break;
+            }
+            default:
+                MONGO_UNREACHABLE;
+        }
+    }
+
+    group.pc = pcPointer;
+}
+
+ByteCode::BlockStackSlot& ByteCode::pushBlockStack(BlockRowGroup& group) {
+    if (_blockStack.size() == group.stackSize) {
+        auto& slot = _blockStack.emplace_back();
+        slot.owned.resize(_blockCapacity, false);
+        slot.tags.resize(_blockCapacity);
+        slot.vals.resize(_blockCapacity);
+    }
+
+    auto& slot = _blockStack[group.stackSize++];
+    for (auto row : group.rows) {
+        invariant(!slot.owned[row]);
+    }
+    return slot;
+}
+
+void ByteCode::releaseBlockStack() {
+    for (auto& slot : _blockStack) {
+        for (size_t row = 0; row < _blockCapacity; ++row) {
+            if (slot.owned[row]) {
+                value::releaseValue(slot.tags[row], slot.vals[row]);
+                slot.owned[row] = false;
+            }
+        }
+    }
+}
+
+template <typename Op>
+void ByteCode::blockUnaryOp(BlockRowGroup& group, Op op) {
+    auto& slot = _blockStack[group.stackSize - 1];
+    for (auto row : group.rows) {
+        auto [owned, tag, val] = op(slot.tags[row], slot.vals[row]);
+        if (slot.owned[row]) {
+            value::releaseValue(slot.tags[row], slot.vals[row]);
+        }
+        slot.owned[row] = owned;
+        slot.tags[row] = tag;
+        slot.vals[row] = val;
+    }
+}
+
+template <typename Op>
+void ByteCode::blockTypeCheck(BlockRowGroup& group, Op op) {
+    auto& slot = _blockStack[group.stackSize - 1];
+    for (auto row : group.rows) {
+        // Nothing stays Nothing.
+        if (slot.tags[row] == value::TypeTags::Nothing) {
+            continue;
+        }
+        auto result = op(slot.tags[row]);
+        if (slot.owned[row]) {
+            value::releaseValue(slot.tags[row], slot.vals[row]);
+            slot.owned[row] = false;
+        }
+        slot.tags[row] = value::TypeTags::Boolean;
+        slot.vals[row] = value::bitcastFrom(result);
+    }
+}
+
+template <typename Op>
+void ByteCode::blockBinaryOp(BlockRowGroup& group, Op op) {
+    auto& rhs = _blockStack[group.stackSize - 1];
+    auto& lhs = _blockStack[group.stackSize - 2];
+    for (auto row : group.rows) {
+        auto [owned, tag, val] = op(lhs.tags[row], lhs.vals[row], rhs.tags[row], rhs.vals[row]);
+        if (rhs.owned[row]) {
+            value::releaseValue(rhs.tags[row], rhs.vals[row]);
+            rhs.owned[row] = false;
+        }
+        if (lhs.owned[row]) {
+            value::releaseValue(lhs.tags[row], lhs.vals[row]);
+        }
+        lhs.owned[row] = owned;
+        lhs.tags[row] = tag;
+        lhs.vals[row] = val;
+    }
+    --group.stackSize;
+}
+
+template <typename Op, typename GenericOp>
+void ByteCode::blockCompare(BlockRowGroup& group, Op op, GenericOp genericOp) {
+    auto& rhs = _blockStack[group.stackSize - 1];
+    auto& lhs = _blockStack[group.stackSize - 2];
+    for (auto row : group.rows) {
+        const auto lhsTag = lhs.tags[row];
+        const auto rhsTag = rhs.tags[row];
+        const auto lhsVal = lhs.vals[row];
+        const auto rhsVal = rhs.vals[row];
+
+        // Comparing a field to a constant of the same numeric type is by far the most common case
+        // in filters, so it is handled inline without going through the generic comparison.
+        if (lhsTag == rhsTag && lhsTag == value::TypeTags::NumberInt64) {
+            lhs.vals[row] = value::bitcastFrom(
+                op(value::bitcastTo<int64_t>(lhsVal), value::bitcastTo<int64_t>(rhsVal)));
+            lhs.tags[row] = value::TypeTags::Boolean;
+        } else if (lhsTag == rhsTag && lhsTag == value::TypeTags::NumberInt32) {
+            lhs.vals[row] = value::bitcastFrom(
+                op(value::bitcastTo<int32_t>(lhsVal), value::bitcastTo<int32_t>(rhsVal)));
+            lhs.tags[row] = value::TypeTags::Boolean;
+        } else if (lhsTag == rhsTag && lhsTag == value::TypeTags::NumberDouble) {
+            lhs.vals[row] = value::bitcastFrom(
+                op(value::bitcastTo<double>(lhsVal), value::bitcastTo<double>(rhsVal)));
+            lhs.tags[row] = value::TypeTags::Boolean;
+        } else {
+            auto [tag, val] = genericOp(lhsTag, lhsVal, rhsTag, rhsVal);
+            lhs.tags[row] = tag;
+            lhs.vals[row] = val;
+        }
+
+        if (rhs.owned[row]) {
+            value::releaseValue(rhsTag, rhsVal);
+            rhs.owned[row] = false;
+        }
+        if (lhs.owned[row]) {
+            value::releaseValue(lhsTag, lhsVal);
+            lhs.owned[row] = false;
+        }
+    }
+    --group.stackSize;
+}
+}  // namespace vm
+}  // namespace sbe
+}  // namespace mongo
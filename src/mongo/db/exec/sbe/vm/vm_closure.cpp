@@ -0,0 +1,737 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+#include <functional>
+
+namespace mongo {
+namespace sbe {
+namespace vm {
+
+/**
+ * The functions implementing the steps of a ClosureFragment. They mirror the implementation of the
+ * corresponding instructions in ByteCode::run().
+ */
+struct ClosureSteps {
+    using Step = ClosureFragment::Step;
+
+    static size_t pushConstVal(ByteCode& vm, const Step& step, size_t pc) {
+        vm.pushStack(false, step.tag, step.val);
+        return pc + 1;
+    }
+
+    static size_t pushAccessVal(ByteCode& vm, const Step& step, size_t pc) {
+        auto [tag, val] = step.accessor->getViewOfValue();
+        vm.pushStack(false, tag, val);
+        return pc + 1;
+    }
+
+    static size_t pushLocalVal(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.getFromStack(step.operand);
+        vm.pushStack(false, tag, val);
+        return pc + 1;
+    }
+
+    static size_t pop(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.getFromStack(0);
+        vm.popStack();
+        if (owned) {
+            value::releaseValue(tag, val);
+        }
+        return pc + 1;
+    }
+
+    static size_t swap(ByteCode& vm, const Step& step, size_t pc) {
+        auto [rhsOwned, rhsTag, rhsVal] = vm.getFromStack(0);
+        auto [lhsOwned, lhsTag, lhsVal] = vm.getFromStack(1);
+
+        // Swap values only if they are not physically same, see ByteCode::run().
+        if (!(rhsTag == lhsTag && rhsVal == lhsVal)) {
+            vm.setStack(0, lhsOwned, lhsTag, lhsVal);
+            vm.setStack(1, rhsOwned, rhsTag, rhsVal);
+        } else {
+            invariant(!rhsOwned);
+        }
+        return pc + 1;
+    }
+
+    template <auto Fn>
+    static size_t binaryOp(ByteCode& vm, const Step& step, size_t pc) {
+        auto [rhsOwned, rhsTag, rhsVal] = vm.getFromStack(0);
+        vm.popStack();
+        auto [lhsOwned, lhsTag, lhsVal] = vm.getFromStack(0);
+
+        auto [owned, tag, val] = (vm.*Fn)(lhsTag, lhsVal, rhsTag, rhsVal);
+
+        vm.topStack(owned, tag, val);
+
+        if (rhsOwned) {
+            value::releaseValue(rhsTag, rhsVal);
+        }
+        if (lhsOwned) {
+            value::releaseValue(lhsTag, lhsVal);
+        }
+        return pc + 1;
+    }
+
+    static size_t negate(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.getFromStack(0);
+
+        auto [resultOwned, resultTag, resultVal] =
+            vm.genericSub(value::TypeTags::NumberInt32, 0, tag, val);
+
+        vm.topStack(resultOwned, resultTag, resultVal);
+
+        if (owned) {
+            value::releaseValue(tag, val);
+        }
+        return pc + 1;
+    }
+
+    static size_t numConvert(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.getFromStack(0);
+
+        auto [resultOwned, resultTag, resultVal] = vm.genericNumConvert(tag, val, step.tag);
+
+        vm.topStack(resultOwned, resultTag, resultVal);
+
+        if (owned) {
+            value::releaseValue(tag, val);
+        }
+        return pc + 1;
+    }
+
+    static size_t logicNot(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.getFromStack(0);
+
+        auto [resultOwned, resultTag, resultVal] = vm.genericNot(tag, val);
+
+        vm.topStack(resultOwned, resultTag, resultVal);
+
+        if (owned) {
+            value::releaseValue(tag, val);
+        }
+        return pc + 1;
+    }
+
+    template <typename Op>
+    static std::pair<value::TypeTags, value::Value> compareValues(ByteCode& vm,
+                                                                  value::TypeTags lhsTag,
+                                                                  value::Value lhsVal,
+                                                                  value::TypeTags rhsTag,
+                                                                  value::Value rhsVal) {
+        // Same-typed numbers are by far the most common case in filters, so they are compared
+        // inline.
+        if (lhsTag == rhsTag) {
+            if (lhsTag == value::TypeTags::NumberInt32) {
+                return {value::TypeTags::Boolean,
+                        value::bitcastFrom(Op{}(value::bitcastTo<int32_t>(lhsVal),
+                                                value::bitcastTo<int32_t>(rhsVal)))};
+            } else if (lhsTag == value::TypeTags::NumberInt64) {
+                return {value::TypeTags::Boolean,
+                        value::bitcastFrom(Op{}(value::bitcastTo<int64_t>(lhsVal),
+                                                value::bitcastTo<int64_t>(rhsVal)))};
+            } else if (lhsTag == value::TypeTags::NumberDouble) {
+                return {value::TypeTags::Boolean,
+                        value::bitcastFrom(Op{}(value::bitcastTo<double>(lhsVal),
+                                                value::bitcastTo<double>(rhsVal)))};
+            }
+        }
+
+        if constexpr (std::is_same_v<Op, std::equal_to<>>) {
+            return vm.genericCompareEq(lhsTag, lhsVal, rhsTag, rhsVal);
+        } else if constexpr (std::is_same_v<Op, std::not_equal_to<>>) {
+            return vm.genericCompareNeq(lhsTag, lhsVal, rhsTag, rhsVal);
+        } else {
+            return vm.genericCompare<Op>(lhsTag, lhsVal, rhsTag, rhsVal);
+        }
+    }
+
+    template <typename Op>
+    static size_t compare(ByteCode& vm, const Step& step, size_t pc) {
+        auto [rhsOwned, rhsTag, rhsVal] = vm.getFromStack(0);
+        vm.popStack();
+        auto [lhsOwned, lhsTag, lhsVal] = vm.getFromStack(0);
+
+        auto [tag, val] = compareValues<Op>(vm, lhsTag, lhsVal, rhsTag, rhsVal);
+
+        vm.topStack(false, tag, val);
+
+        if (rhsOwned) {
+            value::releaseValue(rhsTag, rhsVal);
+        }
+        if (lhsOwned) {
+            value::releaseValue(lhsTag, lhsVal);
+        }
+        return pc + 1;
+    }
+
+    /**
+     * Fuses 'pushAccessVal; pushConstVal; <comparison>'.
+     */
+    template <typename Op>
+    static size_t compareAccessConst(ByteCode& vm, const Step& step, size_t pc) {
+        auto [lhsTag, lhsVal] = step.accessor->getViewOfValue();
+        auto [tag, val] = compareValues<Op>(vm, lhsTag, lhsVal, step.tag, step.val);
+        vm.pushStack(false, tag, val);
+        return pc + 1;
+    }
+
+    static size_t cmp3w(ByteCode& vm, const Step& step, size_t pc) {
+        auto [rhsOwned, rhsTag, rhsVal] = vm.getFromStack(0);
+        vm.popStack();
+        auto [lhsOwned, lhsTag, lhsVal] = vm.getFromStack(0);
+
+        auto [tag, val] = vm.compare3way(lhsTag, lhsVal, rhsTag, rhsVal);
+
+        vm.topStack(false, tag, val);
+
+        if (rhsOwned) {
+            value::releaseValue(rhsTag, rhsVal);
+        }
+        if (lhsOwned) {
+            value::releaseValue(lhsTag, lhsVal);
+        }
+        return pc + 1;
+    }
+
+    static size_t fillEmpty(ByteCode& vm, const Step& step, size_t pc) {
+        auto [rhsOwned, rhsTag, rhsVal] = vm.getFromStack(0);
+        vm.popStack();
+        auto [lhsOwned, lhsTag, lhsVal] = vm.getFromStack(0);
+
+        if (lhsTag == value::TypeTags::Nothing) {
+            vm.topStack(rhsOwned, rhsTag, rhsVal);
+
+            if (lhsOwned) {
+                value::releaseValue(lhsTag, lhsVal);
+            }
+        } else {
+            if (rhsOwned) {
+                value::releaseValue(rhsTag, rhsVal);
+            }
+        }
+        return pc + 1;
+    }
+
+    /**
+     * Fuses 'pushAccessVal; pushConstVal; getField'.
+     */
+    static size_t getFieldAccessConst(ByteCode& vm, const Step& step, size_t pc) {
+        auto [objTag, objVal] = step.accessor->getViewOfValue();
+        auto [owned, tag, val] = vm.getField(objTag, objVal, step.tag, step.val);
+        vm.pushStack(owned, tag, val);
+        return pc + 1;
+    }
+
+    static size_t exists(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.getFromStack(0);
+
+        vm.topStack(false, value::TypeTags::Boolean, tag != value::TypeTags::Nothing);
+
+        if (owned) {
+            value::releaseValue(tag, val);
+        }
+        return pc + 1;
+    }
+
+    template <bool (*Check)(value::TypeTags)>
+    static size_t typeCheck(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.getFromStack(0);
+
+        if (tag != value::TypeTags::Nothing) {
+            vm.topStack(false, value::TypeTags::Boolean, Check(tag));
+        }
+
+        if (owned) {
+            value::releaseValue(tag, val);
+        }
+        return pc + 1;
+    }
+
+    static size_t typeMatch(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.getFromStack(0);
+
+        if (tag != value::TypeTags::Nothing) {
+            bool matches = static_cast<bool>(getBSONTypeMask(tag) & step.operand);
+            vm.topStack(false, value::TypeTags::Boolean, matches);
+        }
+
+        if (owned) {
+            value::releaseValue(tag, val);
+        }
+        return pc + 1;
+    }
+
+    static bool isNull(value::TypeTags tag) {
+        return tag == value::TypeTags::Null;
+    }
+    static bool isObject(value::TypeTags tag) {
+        return value::isObject(tag);
+    }
+    static bool isArray(value::TypeTags tag) {
+        return value::isArray(tag);
+    }
+    static bool isString(value::TypeTags tag) {
+        return value::isString(tag);
+    }
+    static bool isNumber(value::TypeTags tag) {
+        return value::isNumber(tag);
+    }
+    static bool isBinData(value::TypeTags tag) {
+        return value::isBinData(tag);
+    }
+    static bool isDate(value::TypeTags tag) {
+        return tag == value::TypeTags::Date;
+    }
+
+    static size_t function(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.dispatchBuiltin(static_cast<Builtin>(step.operand), step.arity);
+
+        for (uint8_t cnt = 0; cnt < step.arity; ++cnt) {
+            auto [owned, tag, val] = vm.getFromStack(0);
+            vm.popStack();
+            if (owned) {
+                value::releaseValue(tag, val);
+            }
+        }
+
+        vm.pushStack(owned, tag, val);
+        return pc + 1;
+    }
+
+    static size_t jmp(ByteCode& vm, const Step& step, size_t pc) {
+        return step.operand;
+    }
+
+    static size_t jmpTrue(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.getFromStack(0);
+        vm.popStack();
+
+        auto taken = tag == value::TypeTags::Boolean && val;
+
+        if (owned) {
+            value::releaseValue(tag, val);
+        }
+        return taken ? step.operand : pc + 1;
+    }
+
+    static size_t jmpNothing(ByteCode& vm, const Step& step, size_t pc) {
+        auto [owned, tag, val] = vm.getFromStack(0);
+        return tag == value::TypeTags::Nothing ? step.operand : pc + 1;
+    }
+
+    static size_t fail(ByteCode& vm, const Step& step, size_t pc) {
+        auto [ownedCode, tagCode, valCode] = vm.getFromStack(1);
+        invariant(tagCode == value::TypeTags::NumberInt64);
+
+        auto [ownedMsg, tagMsg, valMsg] = vm.getFromStack(0);
+        invariant(value::isString(tagMsg));
+
+        ErrorCodes::Error code{static_cast<ErrorCodes::Error>(value::bitcastTo<int64_t>(valCode))};
+        std::string message{value::getStringView(tagMsg, valMsg)};
+
+        uasserted(code, message);
+    }
+
+    /**
+     * Returns the function implementing the binary arithmetic or field access instruction 'tag'.
+     */
+    static ClosureFragment::StepFn binary(Instruction::Tags tag) {
+        switch (tag) {
+            case Instruction::add:
+                return &binaryOp<&ByteCode::genericAdd>;
+            case Instruction::sub:
+                return &binaryOp<&ByteCode::genericSub>;
+            case Instruction::mul:
+                return &binaryOp<&ByteCode::genericMul>;
+            case Instruction::div:
+                return &binaryOp<&ByteCode::genericDiv>;
+            case Instruction::idiv:
+                return &binaryOp<&ByteCode::genericIDiv>;
+            case Instruction::mod:
+                return &binaryOp<&ByteCode::genericMod>;
+            case Instruction::getField:
+                return &binaryOp<&ByteCode::getField>;
+            case Instruction::getElement:
+                return &binaryOp<&ByteCode::getElement>;
+            default:
+                MONGO_UNREACHABLE;
+        }
+    }
+
+    template <typename Op>
+    static ClosureFragment::StepFn compareFn(bool fused) {
+        return fused ? &compareAccessConst<Op> : &compare<Op>;
+    }
+
+    /**
+     * Returns the function comparing the two values on top of the stack, or a slot to a constant
+     * if 'fused' is true, for the comparison instruction 'tag'. Returns nullptr if 'tag' is not a
+     * comparison.
+     */
+    static ClosureFragment::StepFn comparison(Instruction::Tags tag, bool fused) {
+        switch (tag) {
+            case Instruction::less:
+                return compareFn<std::less<>>(fused);
+            case Instruction::lessEq:
+                return compareFn<std::less_equal<>>(fused);
+            case Instruction::greater:
+                return compareFn<std::greater<>>(fused);
+            case Instruction::greaterEq:
+                return compareFn<std::greater_equal<>>(fused);
+            case Instruction::eq:
+                return compareFn<std::equal_to<>>(fused);
+            case Instruction::neq:
+                return compareFn<std::not_equal_to<>>(fused);
+            default:
+                return nullptr;
+        }
+    }
+};
+
+namespace {
+/**
+ * An instruction decoded from a CodeFragment.
+ */
+struct DecodedInstruction {
+    size_t offset;
+    Instruction::Tags tag;
+    value::SlotAccessor* accessor{nullptr};
+    value::TypeTags constTag{value::TypeTags::Nothing};
+    value::Value constVal{0};
+    int64_t operand{0};
+    uint8_t arity{0};
+};
+
+/**
+ * Decodes all instructions of 'code'. Returns boost::none if any of them is not supported by the
+ * closure compiler. Jump targets are stored as byte offsets in the 'operand'.
+ */
+boost::optional<std::vector<DecodedInstruction>> decode(const CodeFragment* code) {
+    std::vector<DecodedInstruction> instrs;
+
+    auto pcBegin = code->instrs().data();
+    auto pcEnd = pcBegin + code->instrs().size();
+    auto pcPointer = pcBegin;
+    while (pcPointer != pcEnd) {
+        DecodedInstruction decoded{static_cast<size_t>(pcPointer - pcBegin)};
+        Instruction i = value::readFromMemory<Instruction>(pcPointer);
+        pcPointer += sizeof(i);
+        decoded.tag = static_cast<Instruction::Tags>(i.tag);
+
+        switch (i.tag) {
+            case Instruction::pushConstVal:
+                decoded.constTag = value::readFromMemory<value::TypeTags>(pcPointer);
+                pcPointer += sizeof(decoded.constTag);
+                decoded.constVal = value::readFromMemory<value::Value>(pcPointer);
+                pcPointer += sizeof(decoded.constVal);
+                break;
+            case Instruction::pushAccessVal:
+                decoded.accessor = value::readFromMemory<value::SlotAccessor*>(pcPointer);
+                pcPointer += sizeof(decoded.accessor);
+                break;
+            case Instruction::pushLocalVal:
+                decoded.operand = value::readFromMemory<int>(pcPointer);
+                pcPointer += sizeof(int);
+                break;
+            case Instruction::numConvert:
+                decoded.constTag = value::readFromMemory<value::TypeTags>(pcPointer);
+                pcPointer += sizeof(decoded.constTag);
+                break;
+            case Instruction::typeMatch:
+                decoded.operand = value::readFromMemory<uint32_t>(pcPointer);
+                pcPointer += sizeof(uint32_t);
+                break;
+            case Instruction::function:
+                decoded.operand = static_cast<int64_t>(value::readFromMemory<Builtin>(pcPointer));
+                pcPointer += sizeof(Builtin);
+                decoded.arity = value::readFromMemory<uint8_t>(pcPointer);
+                pcPointer += sizeof(uint8_t);
+                break;
+            case Instruction::jmp:
+            case Instruction::jmpTrue:
+            case Instruction::jmpNothing: {
+                auto jumpOffset = value::readFromMemory<int>(pcPointer);
+                pcPointer += sizeof(jumpOffset);
+                decoded.operand = (pcPointer - pcBegin) + jumpOffset;
+                break;
+            }
+            case Instruction::pop:
+            case Instruction::swap:
+            case Instruction::add:
+            case Instruction::sub:
+            case Instruction::mul:
+            case Instruction::div:
+            case Instruction::idiv:
+            case Instruction::mod:
+            case Instruction::negate:
+            case Instruction::logicNot:
+            case Instruction::less:
+            case Instruction::lessEq:
+            case Instruction::greater:
+            case Instruction::greaterEq:
+            case Instruction::eq:
+            case Instruction::neq:
+            case Instruction::cmp3w:
+            case Instruction::fillEmpty:
+            case Instruction::getField:
+            case Instruction::getElement:
+            case Instruction::exists:
+            case Instruction::isNull:
+            case Instruction::isObject:
+            case Instruction::isArray:
+            case Instruction::isString:
+            case Instruction::isNumber:
+            case Instruction::isBinData:
+            case Instruction::isDate:
+            case Instruction::fail:
+                break;
+            default:
+                // Moving values out of accessors and the accumulator instructions are only used by
+                // aggregations, which are left to the interpreter.
+                return boost::none;
+        }
+
+        instrs.push_back(decoded);
+    }
+
+    return instrs;
+}
+}  // namespace
+
+std::unique_ptr<ClosureFragment> ClosureFragment::compile(const CodeFragment* code) {
+    auto instrs = decode(code);
+    if (!instrs) {
+        return nullptr;
+    }
+
+    // Instructions which are jump targets must start a step of their own.
+    stdx::unordered_set<size_t> jumpTargets;
+    for (auto&& instr : *instrs) {
+        if (instr.tag == Instruction::jmp || instr.tag == Instruction::jmpTrue ||
+            instr.tag == Instruction::jmpNothing) {
+            jumpTargets.insert(instr.operand);
+        }
+    }
+    auto canFuse = [&](size_t idx, size_t length) {
+        if (idx + length > instrs->size()) {
+            return false;
+        }
+        for (size_t next = idx + 1; next < idx + length; ++next) {
+            if (jumpTargets.count((*instrs)[next].offset)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto fragment = std::make_unique<ClosureFragment>();
+    auto& steps = fragment->_steps;
+
+    // Maps the byte offset of every instruction starting a step to the position of the step.
+    stdx::unordered_map<size_t, size_t> stepPositions;
+
+    for (size_t idx = 0; idx < instrs->size(); ++idx) {
+        const auto& instr = (*instrs)[idx];
+        stepPositions[instr.offset] = steps.size();
+
+        Step step;
+        step.accessor = instr.accessor;
+        step.tag = instr.constTag;
+        step.val = instr.constVal;
+        step.operand = instr.operand;
+        step.arity = instr.arity;
+
+        if (instr.tag == Instruction::pushAccessVal && canFuse(idx, 3) &&
+            (*instrs)[idx + 1].tag == Instruction::pushConstVal) {
+            const auto& constant = (*instrs)[idx + 1];
+            const auto op = (*instrs)[idx + 2].tag;
+
+            StepFn fused = op == Instruction::getField
+                ? &ClosureSteps::getFieldAccessConst
+                : ClosureSteps::comparison(op, true /* fused */);
+            if (fused) {
+                step.fn = fused;
+                step.tag = constant.constTag;
+                step.val = constant.constVal;
+                steps.push_back(step);
+                idx += 2;
+                continue;
+            }
+        }
+
+        switch (instr.tag) {
+            case Instruction::pushConstVal:
+                step.fn = &ClosureSteps::pushConstVal;
+                break;
+            case Instruction::pushAccessVal:
+                step.fn = &ClosureSteps::pushAccessVal;
+                break;
+            case Instruction::pushLocalVal:
+                step.fn = &ClosureSteps::pushLocalVal;
+                break;
+            case Instruction::pop:
+                step.fn = &ClosureSteps::pop;
+                break;
+            case Instruction::swap:
+                step.fn = &ClosureSteps::swap;
+                break;
+            case Instruction::add:
+            case Instruction::sub:
+            case Instruction::mul:
+            case Instruction::div:
+            case Instruction::idiv:
+            case Instruction::mod:
+            case Instruction::getField:
+            case Instruction::getElement:
+                step.fn = ClosureSteps::binary(instr.tag);
+                break;
+            case Instruction::negate:
+                step.fn = &ClosureSteps::negate;
+                break;
+            case Instruction::numConvert:
+                step.fn = &ClosureSteps::numConvert;
+                break;
+            case Instruction::logicNot:
+                step.fn = &ClosureSteps::logicNot;
+                break;
+            case Instruction::less:
+            case Instruction::lessEq:
+            case Instruction::greater:
+            case Instruction::greaterEq:
+            case Instruction::eq:
+            case Instruction::neq:
+                step.fn = ClosureSteps::comparison(instr.tag, false /* fused */);
+                break;
+            case Instruction::cmp3w:
+                step.fn = &ClosureSteps::cmp3w;
+                break;
+            case Instruction::fillEmpty:
+                step.fn = &ClosureSteps::fillEmpty;
+                break;
+            case Instruction::exists:
+                step.fn = &ClosureSteps::exists;
+                break;
+            case Instruction::isNull:
+                step.fn = &ClosureSteps::typeCheck<&ClosureSteps::isNull>;
+                break;
+            case Instruction::isObject:
+                step.fn = &ClosureSteps::typeCheck<&ClosureSteps::isObject>;
+                break;
+            case Instruction::isArray:
+                step.fn = &ClosureSteps::typeCheck<&ClosureSteps::isArray>;
+                break;
+            case Instruction::isString:
+                step.fn = &ClosureSteps::typeCheck<&ClosureSteps::isString>;
+                break;
+            case Instruction::isNumber:
+                step.fn = &ClosureSteps::typeCheck<&ClosureSteps::isNumber>;
+                break;
+            case Instruction::isBinData:
+                step.fn = &ClosureSteps::typeCheck<&ClosureSteps::isBinData>;
+                break;
+            case Instruction::isDate:
+                step.fn = &ClosureSteps::typeCheck<&ClosureSteps::isDate>;
+                break;
+            case Instruction::typeMatch:
+                step.fn = &ClosureSteps::typeMatch;
+                break;
+            case Instruction::function:
+                step.fn = &ClosureSteps::function;
+                break;
+            case Instruction::jmp:
+                step.fn = &ClosureSteps::jmp;
+                break;
+            case Instruction::jmpTrue:
+                step.fn = &ClosureSteps::jmpTrue;
+                break;
+            case Instruction::jmpNothing:
+                step.fn = &ClosureSteps::jmpNothing;
+                break;
+            case Instruction::fail:
+                step.fn = &ClosureSteps::fail;
+                break;
+            default:
+                MONGO_UNREACHABLE;
+        }
+        steps.push_back(step);
+    }
+    stepPositions[code->instrs().size()] = steps.size();
+
+    // Translate the jump targets from byte offsets to step positions.
+    for (auto& step : steps) {
+        if (step.fn == &ClosureSteps::jmp || step.fn == &ClosureSteps::jmpTrue ||
+            step.fn == &ClosureSteps::jmpNothing) {
+            auto it = stepPositions.find(step.operand);
+            invariant(it != stepPositions.end());
+            step.operand = it->second;
+        }
+    }
+
+    return fragment;
+}
+
+std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::run(const ClosureFragment* code) {
+    const auto& steps = code->_steps;
+    for (size_t pc = 0; pc < steps.size();) {
+        pc = steps[pc].fn(*this, steps[pc], pc);
+    }
+
+    uassert(
+        5095401, "The evaluation stack must hold only a single value", _argStackOwned.size() == 1);
+
+    auto owned = _argStackOwned[0];
+    auto tag = _argStackTags[0];
+    auto val = _argStackVals[0];
+
+    _argStackOwned.clear();
+    _argStackTags.clear();
+    _argStackVals.clear();
+
+    return {owned, tag, val};
+}
+
+bool ByteCode::runPredicate(const ClosureFragment* code) {
+    auto [owned, tag, val] = run(code);
+
+    bool pass = (tag == value::TypeTags::Boolean) && (val != 0);
+
+    if (owned) {
+        value::releaseValue(tag, val);
+    }
+
+    return pass;
+}
+}  // namespace vm
+}  // namespace sbe
+}  // namespace mongo
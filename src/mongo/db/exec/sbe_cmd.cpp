@@ -39,12 +39,13 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/plan_executor_factory.h"
+#include "mongo/db/query/query_knobs_gen.h"
 
 namespace mongo {
 /**
  * A command for manually constructing a SBE query tree and running it.
  *
- * db.runCommand({sbe: "sbe query text"})
+ * db.runCommand({sbe: "sbe query text", allowDiskUse: <bool>})
  *
  * The command is enabled only for testing.
  */
@@ -69,7 +70,8 @@ public:
         uassertStatusOK(CursorRequest::parseCommandCursorOptions(
             cmdObj, QueryRequest::kDefaultBatchSize, &batchSize));
 
-        sbe::Parser parser;
+        sbe::Parser parser(cmdObj["allowDiskUse"].trueValue(),
+                           internalQuerySlotBasedExecutionHashJoinMemoryUseBytesBeforeSpill.load());
         auto root = parser.parse(opCtx, dbname, cmdObj["sbe"].String());
         auto [resultSlot, recordIdSlot] = parser.getTopLevelSlots();
 
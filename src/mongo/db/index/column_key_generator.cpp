@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/column_key_generator.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/index_entry_comparison.h"
+
+namespace mongo {
+namespace {
+
+// The first component of the row column keys, which sorts before the name of any field.
+const BSONObj kRowColumn = BSON("" << MINKEY);
+
+}  // namespace
+
+ColumnKeyGenerator::ColumnKeyGenerator(KeyString::Version keyStringVersion, Ordering ordering)
+    : _keyStringVersion(keyStringVersion), _ordering(ordering) {}
+
+void ColumnKeyGenerator::generateKeys(SharedBufferFragmentBuilder& pooledBufferBuilder,
+                                      const BSONObj& obj,
+                                      const RecordId& id,
+                                      KeyStringSet* keys) const {
+    auto keysSequence = keys->extract_sequence();
+
+    KeyString::PooledBuilder rowKey(pooledBufferBuilder, _keyStringVersion, _ordering);
+    rowKey.appendBSONElement(kRowColumn.firstElement());
+    rowKey.appendNumberLong(id.repr());
+    rowKey.appendRecordId(id);
+    keysSequence.push_back(rowKey.release());
+
+    long long position = 0;
+    for (auto&& elem : obj) {
+        KeyString::PooledBuilder keyString(pooledBufferBuilder, _keyStringVersion, _ordering);
+        keyString.appendString(elem.fieldNameStringData());
+        keyString.appendNumberLong(id.repr());
+        keyString.appendNumberLong(position++);
+        keyString.appendBSONElement(elem);
+        keyString.appendRecordId(id);
+        keysSequence.push_back(keyString.release());
+    }
+
+    keys->adopt_sequence(std::move(keysSequence));
+}
+
+KeyString::Value ColumnKeyGenerator::makeSeekKey(boost::optional<StringData> field,
+                                                 const RecordId& id) const {
+    BSONObjBuilder bob;
+    if (field) {
+        bob.append("", *field);
+    } else {
+        bob.appendMinKey("");
+    }
+    bob.append("", static_cast<long long>(id.repr()));
+    return IndexEntryComparison::makeKeyStringFromBSONKeyForSeek(
+        bob.obj(), _keyStringVersion, _ordering, true /* isForward */, true /* inclusive */);
+}
+
+ColumnKeyGenerator::Cell ColumnKeyGenerator::decode(const BSONObj& key) {
+    BSONObjIterator it(key);
+    Cell cell;
+    auto first = it.next();
+    if (first.type() == String) {
+        cell.field = first.valueStringData();
+    }
+    cell.recordId = RecordId(it.next().numberLong());
+    if (cell.field) {
+        cell.position = it.next().numberLong();
+        cell.value = it.next();
+    }
+    return cell;
+}
+
+}  // namespace mongo
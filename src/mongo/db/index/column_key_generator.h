@@ -0,0 +1,88 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/key_string.h"
+
+namespace mongo {
+
+/**
+ * Generates the keys of a column store index. Such an index holds one column per top-level field
+ * of the documents, stored as a range of keys of the form
+ *      { '': 'field', '': <record id>, '': <position of the field>, '': <field value> }
+ * so that the values of a field are adjacent and ordered by record id. Every document also has a
+ * key in the row column, which holds no value and sorts before all the other columns:
+ *      { '': MinKey, '': <record id> }
+ * A scan of the index reads the row column to learn which documents exist, and the column of each
+ * field it needs to rebuild their values.
+ */
+class ColumnKeyGenerator {
+public:
+    /**
+     * A decoded column store index key. The row column cell has no field, position or value.
+     */
+    struct Cell {
+        boost::optional<StringData> field;
+        RecordId recordId;
+        long long position = 0;
+        BSONElement value;
+    };
+
+    ColumnKeyGenerator(KeyString::Version keyStringVersion, Ordering ordering);
+
+    /**
+     * Adds the row column key of 'obj', and one key for each of its top-level fields, to 'keys'.
+     */
+    void generateKeys(SharedBufferFragmentBuilder& pooledBufferBuilder,
+                      const BSONObj& obj,
+                      const RecordId& id,
+                      KeyStringSet* keys) const;
+
+    /**
+     * Returns a key to seek to the first cell of the column of 'field', or of the row column if
+     * 'field' is none, which belongs to a record id at or after 'id'.
+     */
+    KeyString::Value makeSeekKey(boost::optional<StringData> field, const RecordId& id) const;
+
+    /**
+     * Decodes a key, as returned by a cursor over the index, which must outlive the returned cell.
+     */
+    static Cell decode(const BSONObj& key);
+
+private:
+    const KeyString::Version _keyStringVersion;
+    const Ordering _ordering;
+};
+}  // namespace mongo
@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/json.h"
+#include "mongo/db/index/column_key_generator.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const Ordering kOrdering = Ordering::make(BSONObj());
+
+std::vector<BSONObj> generateKeys(const BSONObj& obj, const RecordId& id) {
+    ColumnKeyGenerator keyGen(KeyString::Version::kLatestVersion, kOrdering);
+    SharedBufferFragmentBuilder allocator(KeyString::HeapBuilder::kHeapAllocatorDefaultBytes);
+    KeyStringSet keys;
+    keyGen.generateKeys(allocator, obj, id, &keys);
+
+    std::vector<BSONObj> decoded;
+    for (auto&& keyString : keys) {
+        decoded.push_back(KeyString::toBson(keyString, kOrdering));
+    }
+    return decoded;
+}
+
+TEST(ColumnKeyGeneratorTest, GeneratesOneKeyPerTopLevelFieldAndARowKey) {
+    auto keys = generateKeys(fromjson("{b: 1, a: {c: [1, 2]}, _id: 'x'}"), RecordId(7));
+
+    ASSERT_EQ(keys.size(), 4U);
+    ASSERT_BSONOBJ_EQ(keys[0], BSON("" << MINKEY << "" << 7LL));
+    ASSERT_BSONOBJ_EQ(keys[1], fromjson("{'': '_id', '': {$numberLong: '7'}, '': 2, '': 'x'}"));
+    ASSERT_BSONOBJ_EQ(keys[2],
+                      fromjson("{'': 'a', '': {$numberLong: '7'}, '': 1, '': {c: [1, 2]}}"));
+    ASSERT_BSONOBJ_EQ(keys[3], fromjson("{'': 'b', '': {$numberLong: '7'}, '': 0, '': 1}"));
+}
+
+TEST(ColumnKeyGeneratorTest, EmptyDocumentOnlyHasARowKey) {
+    auto keys = generateKeys(BSONObj(), RecordId(1));
+
+    ASSERT_EQ(keys.size(), 1U);
+    ASSERT_BSONOBJ_EQ(keys[0], BSON("" << MINKEY << "" << 1LL));
+}
+
+TEST(ColumnKeyGeneratorTest, ValuesOfAFieldAreOrderedByRecordId) {
+    ColumnKeyGenerator keyGen(KeyString::Version::kLatestVersion, kOrdering);
+    SharedBufferFragmentBuilder allocator(KeyString::HeapBuilder::kHeapAllocatorDefaultBytes);
+    KeyStringSet keys;
+    keyGen.generateKeys(allocator, BSON("a" << 100), RecordId(2), &keys);
+    keyGen.generateKeys(allocator, BSON("a" << 1 << "b" << 1), RecordId(10), &keys);
+    keyGen.generateKeys(allocator, BSON("b" << 1), RecordId(1), &keys);
+
+    std::vector<std::pair<boost::optional<std::string>, RecordId>> cells;
+    for (auto&& keyString : keys) {
+        auto cell = ColumnKeyGenerator::decode(KeyString::toBson(keyString, kOrdering));
+        cells.emplace_back(cell.field ? boost::make_optional(cell.field->toString()) : boost::none,
+                           cell.recordId);
+    }
+
+    std::vector<std::pair<boost::optional<std::string>, RecordId>> expected = {
+        {boost::none, RecordId(1)},
+        {boost::none, RecordId(2)},
+        {boost::none, RecordId(10)},
+        {std::string("a"), RecordId(2)},
+        {std::string("a"), RecordId(10)},
+        {std::string("b"), RecordId(1)},
+        {std::string("b"), RecordId(10)},
+    };
+    ASSERT(cells == expected);
+}
+
+TEST(ColumnKeyGeneratorTest, DecodesCellsWithTheirValues) {
+    auto keys = generateKeys(fromjson("{a: 'str', b: null}"), RecordId(3));
+
+    auto row = ColumnKeyGenerator::decode(keys[0]);
+    ASSERT_FALSE(row.field);
+    ASSERT_EQ(row.recordId, RecordId(3));
+
+    auto cell = ColumnKeyGenerator::decode(keys[2]);
+    ASSERT_EQ(*cell.field, "b");
+    ASSERT_EQ(cell.recordId, RecordId(3));
+    ASSERT_EQ(cell.position, 1);
+    ASSERT_EQ(cell.value.type(), jstNULL);
+}
+
+TEST(ColumnKeyGeneratorTest, SeekKeySortsBeforeTheCellsOfItsRecord) {
+    ColumnKeyGenerator keyGen(KeyString::Version::kLatestVersion, kOrdering);
+    SharedBufferFragmentBuilder allocator(KeyString::HeapBuilder::kHeapAllocatorDefaultBytes);
+    KeyStringSet keys;
+    keyGen.generateKeys(allocator, BSON("a" << 1), RecordId(5), &keys);
+    ASSERT_EQ(keys.size(), 2U);
+    auto rowKey = *keys.begin();
+    auto fieldKey = *keys.rbegin();
+
+    ASSERT_LT(keyGen.makeSeekKey(boost::none, RecordId(5)), rowKey);
+    ASSERT_GT(keyGen.makeSeekKey(boost::none, RecordId(6)), rowKey);
+    ASSERT_GT(keyGen.makeSeekKey(StringData("a"), RecordId(5)), rowKey);
+    ASSERT_LT(keyGen.makeSeekKey(StringData("a"), RecordId(5)), fieldKey);
+    ASSERT_GT(keyGen.makeSeekKey(StringData("a"), RecordId(6)), fieldKey);
+    ASSERT_LT(keyGen.makeSeekKey(StringData("a"), RecordId(4)), fieldKey);
+}
+
+}  // namespace
+}  // namespace mongo
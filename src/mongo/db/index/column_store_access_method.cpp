@@ -0,0 +1,188 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/column_store_access_method.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/catalog/index_catalog_entry.h"
+
+namespace mongo {
+
+ColumnStoreAccessMethod::ColumnStoreAccessMethod(IndexCatalogEntry* columnStoreState,
+                                                 std::unique_ptr<SortedDataInterface> btree)
+    : AbstractIndexAccessMethod(columnStoreState, std::move(btree)),
+      _keyGen(getSortedDataInterface()->getKeyStringVersion(),
+              getSortedDataInterface()->getOrdering()) {}
+
+bool ColumnStoreAccessMethod::shouldMarkIndexAsMultikey(size_t numberOfKeys,
+                                                        const KeyStringSet& multikeyMetadataKeys,
+                                                        const MultikeyPaths& multikeyPaths) const {
+    return false;
+}
+
+void ColumnStoreAccessMethod::doGetKeys(SharedBufferFragmentBuilder& pooledBufferBuilder,
+                                        const BSONObj& obj,
+                                        GetKeysContext context,
+                                        KeyStringSet* keys,
+                                        KeyStringSet* multikeyMetadataKeys,
+                                        MultikeyPaths* multikeyPaths,
+                                        boost::optional<RecordId> id) const {
+    // The keys of a column store index are ordered by record id within each column.
+    invariant(id);
+    _keyGen.generateKeys(pooledBufferBuilder, obj, *id, keys);
+}
+
+std::unique_ptr<ColumnStoreAccessMethod::RowCursor> ColumnStoreAccessMethod::newRowCursor(
+    OperationContext* opCtx, const std::vector<std::string>& fields) const {
+    return std::make_unique<RowCursor>(opCtx, this, fields);
+}
+
+ColumnStoreAccessMethod::RowCursor::RowCursor(OperationContext* opCtx,
+                                              const ColumnStoreAccessMethod* accessMethod,
+                                              const std::vector<std::string>& fields)
+    : _accessMethod(accessMethod) {
+    _rowColumn.cursor = _accessMethod->newCursor(opCtx);
+    for (auto&& field : fields) {
+        _fieldColumns.push_back({field, _accessMethod->newCursor(opCtx), boost::none});
+    }
+}
+
+void ColumnStoreAccessMethod::RowCursor::_setEntry(Column* column,
+                                                   boost::optional<IndexKeyEntry> entry) {
+    if (entry) {
+        ++_keysExamined;
+        // The cursor has moved on to the next column once the field of the cell differs.
+        auto cell = ColumnKeyGenerator::decode(entry->key);
+        bool inColumn = column->field ? cell.field && *cell.field == *column->field : !cell.field;
+        if (!inColumn) {
+            entry = boost::none;
+        }
+    }
+    column->entry = std::move(entry);
+}
+
+void ColumnStoreAccessMethod::RowCursor::_seek(Column* column, const RecordId& id) {
+    boost::optional<StringData> field;
+    if (column->field) {
+        field = StringData(*column->field);
+    }
+    _setEntry(column, column->cursor->seek(_accessMethod->_keyGen.makeSeekKey(field, id)));
+}
+
+void ColumnStoreAccessMethod::RowCursor::_advance(Column* column) {
+    _setEntry(column, column->cursor->next());
+}
+
+boost::optional<ColumnStoreAccessMethod::RowCursor::Row>
+ColumnStoreAccessMethod::RowCursor::next() {
+    if (_needsSeek) {
+        const RecordId start = _lastRecordId ? RecordId(_lastRecordId->repr() + 1) : RecordId();
+        _seek(&_rowColumn, start);
+        for (auto&& column : _fieldColumns) {
+            _seek(&column, start);
+        }
+        _needsSeek = false;
+    }
+
+    // The row column holds one cell per document, which drives the scan.
+    if (!_rowColumn.entry) {
+        return boost::none;
+    }
+    const RecordId id = ColumnKeyGenerator::decode(_rowColumn.entry->key).recordId;
+    _advance(&_rowColumn);
+
+    // Each field column is advanced past the documents which lack its field, and its cells for the
+    // current document are collected. The keys are owned, so their values stay valid.
+    struct FieldValue {
+        long long position;
+        StringData field;
+        BSONObj key;
+    };
+    std::vector<FieldValue> values;
+    for (auto&& column : _fieldColumns) {
+        while (column.entry && ColumnKeyGenerator::decode(column.entry->key).recordId < id) {
+            _advance(&column);
+        }
+        while (column.entry) {
+            auto cell = ColumnKeyGenerator::decode(column.entry->key);
+            if (cell.recordId != id) {
+                break;
+            }
+            values.push_back({cell.position, *column.field, column.entry->key});
+            _advance(&column);
+        }
+    }
+
+    // The fields are returned in the order in which they appear in the document.
+    std::sort(values.begin(), values.end(), [](const FieldValue& lhs, const FieldValue& rhs) {
+        return lhs.position < rhs.position;
+    });
+    BSONObjBuilder bob;
+    for (auto&& value : values) {
+        bob.appendAs(ColumnKeyGenerator::decode(value.key).value, value.field);
+    }
+    _lastRecordId = id;
+    return Row{id, bob.obj()};
+}
+
+void ColumnStoreAccessMethod::RowCursor::save() {
+    _rowColumn.cursor->save();
+    for (auto&& column : _fieldColumns) {
+        column.cursor->save();
+    }
+}
+
+void ColumnStoreAccessMethod::RowCursor::restore() {
+    _rowColumn.cursor->restore();
+    for (auto&& column : _fieldColumns) {
+        column.cursor->restore();
+    }
+    // The cells read ahead of the last document may have changed while the cursors were saved.
+    _needsSeek = true;
+}
+
+void ColumnStoreAccessMethod::RowCursor::detachFromOperationContext() {
+    _rowColumn.cursor->detachFromOperationContext();
+    for (auto&& column : _fieldColumns) {
+        column.cursor->detachFromOperationContext();
+    }
+}
+
+void ColumnStoreAccessMethod::RowCursor::reattachToOperationContext(OperationContext* opCtx) {
+    _rowColumn.cursor->reattachToOperationContext(opCtx);
+    for (auto&& column : _fieldColumns) {
+        column.cursor->reattachToOperationContext(opCtx);
+    }
+}
+
+}  // namespace mongo
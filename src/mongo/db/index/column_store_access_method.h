@@ -0,0 +1,130 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/index/column_key_generator.h"
+#include "mongo/db/index/index_access_method.h"
+
+namespace mongo {
+
+/**
+ * Class which is responsible for generating and providing access to column store index keys. Any
+ * index created with { "$**": "columnstore" } uses this class.
+ *
+ * A column store index holds the values of every top-level field of the documents, grouped by field
+ * and ordered by record id; see ColumnKeyGenerator for the format of its keys. A RowCursor rebuilds
+ * the documents, restricted to a set of top-level fields, by reading only the columns of those
+ * fields.
+ */
+class ColumnStoreAccessMethod final : public AbstractIndexAccessMethod {
+public:
+    /**
+     * Returns each document of the collection, in record id order, with only the requested
+     * top-level fields, in the order in which they appear in the document. A document without any
+     * of the fields is returned as an empty object.
+     */
+    class RowCursor {
+    public:
+        struct Row {
+            RecordId recordId;
+            BSONObj obj;
+        };
+
+        RowCursor(OperationContext* opCtx,
+                  const ColumnStoreAccessMethod* accessMethod,
+                  const std::vector<std::string>& fields);
+
+        boost::optional<Row> next();
+
+        void save();
+
+        /**
+         * After a restore, the cursor continues with the first document after the last one it
+         * returned.
+         */
+        void restore();
+
+        void detachFromOperationContext();
+        void reattachToOperationContext(OperationContext* opCtx);
+
+        size_t keysExamined() const {
+            return _keysExamined;
+        }
+
+    private:
+        struct Column {
+            // The field of the column, or none for the row column.
+            boost::optional<std::string> field;
+            std::unique_ptr<SortedDataInterface::Cursor> cursor;
+            // The next cell of the column, or none once the column is exhausted.
+            boost::optional<IndexKeyEntry> entry;
+        };
+
+        // Positions 'column' on its first cell with a record id at or after 'id'.
+        void _seek(Column* column, const RecordId& id);
+        void _advance(Column* column);
+        void _setEntry(Column* column, boost::optional<IndexKeyEntry> entry);
+
+        const ColumnStoreAccessMethod* const _accessMethod;
+        Column _rowColumn;
+        std::vector<Column> _fieldColumns;
+        boost::optional<RecordId> _lastRecordId;
+        bool _needsSeek = true;
+        size_t _keysExamined = 0;
+    };
+
+    ColumnStoreAccessMethod(IndexCatalogEntry* columnStoreState,
+                            std::unique_ptr<SortedDataInterface> btree);
+
+    /**
+     * A column store index never becomes multikey: arrays are stored whole, in the column of the
+     * top-level field which holds them.
+     */
+    bool shouldMarkIndexAsMultikey(size_t numberOfKeys,
+                                   const KeyStringSet& multikeyMetadataKeys,
+                                   const MultikeyPaths& multikeyPaths) const final;
+
+    std::unique_ptr<RowCursor> newRowCursor(OperationContext* opCtx,
+                                            const std::vector<std::string>& fields) const;
+
+private:
+    void doGetKeys(SharedBufferFragmentBuilder& pooledBufferBuilder,
+                   const BSONObj& obj,
+                   GetKeysContext context,
+                   KeyStringSet* keys,
+                   KeyStringSet* multikeyMetadataKeys,
+                   MultikeyPaths* multikeyPaths,
+                   boost::optional<RecordId> id) const final;
+
+    const ColumnKeyGenerator _keyGen;
+};
+}  // namespace mongo
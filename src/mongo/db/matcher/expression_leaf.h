@@ -94,6 +94,8 @@ public:
  */
 class ComparisonMatchExpressionBase : public LeafMatchExpression {
 public:
+    using InputParamId = int32_t;
+
     static bool isEquality(MatchType matchType) {
         switch (matchType) {
             case MatchExpression::EQ:
@@ -142,6 +144,18 @@ public:
         return _collator;
     }
 
+    /**
+     * When the query is parameterized for reuse of a cached SBE plan, identifies the runtime
+     * parameter which holds the RHS of this expression. Clones share the same parameter id.
+     */
+    boost::optional<InputParamId> getInputParamId() const {
+        return _inputParamId;
+    }
+
+    void setInputParamId(boost::optional<InputParamId> paramId) {
+        _inputParamId = paramId;
+    }
+
 protected:
     /**
      * 'collator' must outlive the ComparisonMatchExpression and any clones made of it.
@@ -157,6 +171,8 @@ protected:
     // Collator used to compare elements. By default, simple binary comparison will be used.
     const CollatorInterface* _collator = nullptr;
 
+    boost::optional<InputParamId> _inputParamId;
+
 private:
     ExpressionOptimizerFunc getOptimizer() const final {
         return [](std::unique_ptr<MatchExpression> expression) { return expression; };
@@ -221,6 +237,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(_inputParamId);
         return e;
     }
 
@@ -257,6 +274,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(_inputParamId);
         return e;
     }
 
@@ -293,6 +311,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(_inputParamId);
         return e;
     }
 
@@ -334,6 +353,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(_inputParamId);
         return e;
     }
 
@@ -374,6 +394,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(_inputParamId);
         return e;
     }
 
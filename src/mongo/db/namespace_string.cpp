@@ -139,10 +139,15 @@ bool NamespaceString::isLegalClientSystemNS() const {
         return true;
     if (coll() == kSystemDotViewsCollectionName)
         return true;
+    if (coll() == kSystemDotStatisticsCollectionName)
+        return true;
     if (isTemporaryReshardingCollection()) {
         // Permit integration testing on resharding collections.
         return true;
     }
+    if (isTimeseriesBucketsCollection()) {
+        return true;
+    }
 
     return false;
 }
@@ -273,6 +278,19 @@ bool NamespaceString::isTemporaryReshardingCollection() const {
     return coll().startsWith(kTemporaryReshardingCollectionPrefix);
 }
 
+bool NamespaceString::isTimeseriesBucketsCollection() const {
+    return coll().startsWith(kTimeseriesBucketsCollectionPrefix);
+}
+
+NamespaceString NamespaceString::makeTimeseriesBucketsNamespace() const {
+    return {db(), kTimeseriesBucketsCollectionPrefix.toString() + coll()};
+}
+
+NamespaceString NamespaceString::getTimeseriesViewNamespace() const {
+    invariant(isTimeseriesBucketsCollection(), ns());
+    return {db(), coll().substr(kTimeseriesBucketsCollectionPrefix.size())};
+}
+
 bool NamespaceString::isReplicated() const {
     if (isLocal()) {
         return false;
@@ -281,5 +281,16 @@ TEST(NamespaceStringTest, EmptyNSStringReturnsEmptyDb) {
     ASSERT_EQ(nss.db(), StringData{});
 }
 
+TEST(NamespaceStringTest, TimeseriesBucketsNamespace) {
+    NamespaceString nss("test.weather");
+    ASSERT_FALSE(nss.isTimeseriesBucketsCollection());
+
+    auto bucketsNss = nss.makeTimeseriesBucketsNamespace();
+    ASSERT_EQ(bucketsNss.ns(), "test.system.buckets.weather");
+    ASSERT_TRUE(bucketsNss.isTimeseriesBucketsCollection());
+    ASSERT_TRUE(bucketsNss.isLegalClientSystemNS());
+    ASSERT_EQ(bucketsNss.getTimeseriesViewNamespace(), nss);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -45,6 +45,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop_failpoint_helpers.h"
 #include "mongo/db/curop_metrics.h"
+#include "mongo/db/dbhelpers.h"
 #include "mongo/db/error_labels.h"
 #include "mongo/db/exec/delete.h"
 #include "mongo/db/exec/update_stage.h"
@@ -72,6 +73,8 @@
 #include "mongo/db/stats/server_write_concern_metrics.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/db/storage/duplicate_key_error_info.h"
+#include "mongo/db/storage/durable_catalog.h"
+#include "mongo/db/timeseries/bucket_catalog.h"
 #include "mongo/db/transaction_participant.h"
 #include "mongo/db/update/path_support.h"
 #include "mongo/db/write_concern.h"
@@ -508,6 +511,226 @@ SingleWriteResult makeWriteResultForInsertOrDeleteRetry() {
 
 }  // namespace
 
+/**
+ * Returns the UUID of the buckets collection of the time-series collection 'ns' and the options of
+ * the time-series collection, or boost::none if 'ns' is not a time-series collection.
+ */
+static boost::optional<std::pair<UUID, TimeseriesOptions>> lookUpTimeseriesCollection(
+    OperationContext* opCtx, const NamespaceString& ns) {
+    const auto bucketsNs = ns.makeTimeseriesBucketsNamespace();
+
+    // Most namespaces have no buckets collection, which is told apart without taking any lock.
+    if (!CollectionCatalog::get(opCtx).lookupUUIDByNSS(opCtx, bucketsNs)) {
+        return boost::none;
+    }
+
+    AutoGetCollection bucketsColl(opCtx, bucketsNs, MODE_IS);
+    if (!bucketsColl.getCollection()) {
+        return boost::none;
+    }
+
+    auto options = DurableCatalog::get(opCtx)
+                       ->getCollectionOptions(opCtx, bucketsColl.getCollection()->getCatalogId())
+                       .timeseries;
+    if (options.isEmpty()) {
+        return boost::none;
+    }
+    return std::make_pair(bucketsColl.getCollection()->uuid(),
+                          TimeseriesOptions::parse(IDLParserErrorContext("timeseries"), options));
+}
+
+/**
+ * Inserts the measurements of 'wholeOp' into the buckets of the time-series collection
+ * 'wholeOp.getNamespace()'. The bucket catalog decides which bucket and which position in it each
+ * measurement goes to, and the measurements of a batch are written with one upsert per bucket:
+ *
+ *     {$setOnInsert: {'control.version': 1, meta: <meta value>},
+ *      $min: {'control.min.<field>': <value>, ...},
+ *      $max: {'control.max.<field>': <value>, ...},
+ *      $set: {'data.<field>.<position>': <value>, ...}}
+ *
+ * Concurrent batches may add to the same bucket, and the upserts of different batches commute.
+ */
+static WriteResult performTimeseriesInserts(OperationContext* opCtx,
+                                            const write_ops::Insert& wholeOp,
+                                            const UUID& bucketsUUID,
+                                            const TimeseriesOptions& options) {
+    // The measurements of a bucket are not written by statements of their own, so they can neither
+    // be part of a transaction nor be retried.
+    uassert(ErrorCodes::OperationNotSupportedInTransaction,
+            str::stream() << "Cannot insert into a time-series collection in a multi-document "
+                             "transaction: "
+                          << wholeOp.getNamespace(),
+            !opCtx->inMultiDocumentTransaction());
+    uassert(ErrorCodes::IllegalOperation,
+            str::stream() << "Cannot insert into a time-series collection with a retryable write: "
+                          << wholeOp.getNamespace(),
+            !opCtx->getTxnNumber());
+
+    const auto bucketsNs = wholeOp.getNamespace().makeTimeseriesBucketsNamespace();
+    const auto metaField = options.getMetaField();
+    auto& bucketCatalog = BucketCatalog::get(opCtx->getServiceContext());
+    auto& curOp = *CurOp::get(opCtx);
+    LastOpFixer lastOpFixer(opCtx, bucketsNs);
+
+    WriteResult out;
+    out.results.reserve(wholeOp.getDocuments().size());
+
+    // The changes made to each bucket by the measurements of the current batch. The elements point
+    // into the documents of 'wholeOp' or of 'fixedDocs'.
+    struct BucketChanges {
+        BSONElement meta;
+        StringMap<BSONElement> min;
+        StringMap<BSONElement> max;
+        BSONObjBuilder data;
+    };
+    std::map<OID, BucketChanges> batch;
+    std::vector<BSONObj> fixedDocs;
+    size_t batchSize = 0;
+
+    auto writeBatch = [&] {
+        if (batchSize == 0) {
+            return true;
+        }
+        ON_BLOCK_EXIT([&] {
+            batch.clear();
+            fixedDocs.clear();
+            batchSize = 0;
+        });
+
+        globalOpCounters.gotInserts(batchSize);
+        ServerWriteConcernMetrics::get(opCtx)->recordWriteConcernForInserts(
+            opCtx->getWriteConcern(), batchSize);
+
+        std::vector<std::pair<OID, BSONObj>> updates;
+        for (auto&& [bucketId, changes] : batch) {
+            BSONObjBuilder update;
+            {
+                BSONObjBuilder setOnInsert(update.subobjStart("$setOnInsert"));
+                setOnInsert.append("control.version", 1);
+                if (changes.meta) {
+                    setOnInsert.appendAs(changes.meta, "meta");
+                }
+            }
+            {
+                BSONObjBuilder min(update.subobjStart("$min"));
+                for (auto&& [field, elem] : changes.min) {
+                    min.appendAs(elem, "control.min." + field);
+                }
+            }
+            {
+                BSONObjBuilder max(update.subobjStart("$max"));
+                for (auto&& [field, elem] : changes.max) {
+                    max.appendAs(elem, "control.max." + field);
+                }
+            }
+            update.append("$set", changes.data.obj());
+            updates.emplace_back(bucketId, update.obj());
+        }
+
+        try {
+            writeConflictRetry(opCtx, "insert", bucketsNs.ns(), [&] {
+                AutoGetCollection bucketsColl(opCtx, bucketsNs, MODE_IX);
+                uassert(ErrorCodes::NamespaceNotFound,
+                        str::stream() << "Time-series collection " << wholeOp.getNamespace()
+                                      << " was dropped",
+                        bucketsColl.getCollection() &&
+                            bucketsColl.getCollection()->uuid() == bucketsUUID);
+                curOp.raiseDbProfileLevel(
+                    CollectionCatalog::get(opCtx).getDatabaseProfileLevel(bucketsNs.db()));
+                assertCanWrite_inlock(opCtx, bucketsNs);
+
+                lastOpFixer.startingOp();
+                WriteUnitOfWork wuow(opCtx);
+                for (auto&& [bucketId, update] : updates) {
+                    try {
+                        Helpers::upsert(opCtx, bucketsNs.ns(), BSON("_id" << bucketId), update);
+                    } catch (const ExceptionFor<ErrorCodes::DuplicateKey>&) {
+                        // A concurrent batch created the bucket after this upsert looked for it.
+                        throw WriteConflictException();
+                    }
+                }
+                wuow.commit();
+                lastOpFixer.finishedOpSuccessfully();
+            });
+        } catch (const DBException& ex) {
+            // The measurements of the batch are written together, so they fail together.
+            for (size_t i = 0; i < batchSize; ++i) {
+                if (!handleError(opCtx,
+                                 ex,
+                                 wholeOp.getNamespace(),
+                                 wholeOp.getWriteCommandBase(),
+                                 &out)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        SingleWriteResult result;
+        result.setN(1);
+        std::fill_n(std::back_inserter(out.results), batchSize, std::move(result));
+        curOp.debug().additiveMetrics.incrementNinserted(batchSize);
+        return true;
+    };
+
+    const size_t maxBatchSize = internalInsertMaxBatchSize.load();
+    for (auto&& doc : wholeOp.getDocuments()) {
+        try {
+            auto fixedDoc = uassertStatusOK(fixDocumentForInsert(opCtx->getServiceContext(), doc));
+            const auto& measurement = fixedDoc.isEmpty() ? doc : fixedDocs.emplace_back(fixedDoc);
+            for (auto&& elem : measurement) {
+                uassert(5095432,
+                        str::stream() << "The field names of the measurements of a time-series "
+                                         "collection cannot be empty or contain '.': "
+                                      << elem.fieldNameStringData(),
+                        !elem.fieldNameStringData().empty() &&
+                            elem.fieldNameStringData().find('.') == std::string::npos);
+            }
+
+            auto placement = bucketCatalog.insert(bucketsUUID, options, measurement);
+            auto& changes = batch[placement.bucketId];
+            const auto position = std::to_string(placement.index);
+            for (auto&& elem : measurement) {
+                const auto field = elem.fieldNameStringData();
+                if (metaField && field == *metaField) {
+                    changes.meta = elem;
+                    continue;
+                }
+
+                auto& min = changes.min[field];
+                if (!min || elem.woCompare(min, false) < 0) {
+                    min = elem;
+                }
+                auto& max = changes.max[field];
+                if (!max || elem.woCompare(max, false) > 0) {
+                    max = elem;
+                }
+                changes.data.appendAs(elem, str::stream() << "data." << field << "." << position);
+            }
+            ++batchSize;
+        } catch (const DBException& ex) {
+            // Write the measurements before this one, so that errors are reported in order.
+            if (!writeBatch()) {
+                break;
+            }
+            globalOpCounters.gotInsert();
+            if (!handleError(
+                    opCtx, ex, wholeOp.getNamespace(), wholeOp.getWriteCommandBase(), &out)) {
+                break;
+            }
+            continue;
+        }
+
+        if (batchSize >= maxBatchSize && !writeBatch()) {
+            break;
+        }
+    }
+    writeBatch();
+
+    return out;
+}
+
 WriteResult performInserts(OperationContext* opCtx,
                            const write_ops::Insert& wholeOp,
                            bool fromMigrate) {
@@ -541,6 +764,10 @@ WriteResult performInserts(OperationContext* opCtx,
 
     uassertStatusOK(userAllowedWriteNS(wholeOp.getNamespace()));
 
+    if (auto timeseries = lookUpTimeseriesCollection(opCtx, wholeOp.getNamespace())) {
+        return performTimeseriesInserts(opCtx, wholeOp, timeseries->first, timeseries->second);
+    }
+
     DisableDocumentValidationIfTrue docValidationDisabler(
         opCtx, wholeOp.getWriteCommandBase().getBypassDocumentValidation());
     LastOpFixer lastOpFixer(opCtx, wholeOp.getNamespace());
@@ -42,6 +42,7 @@
 #include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/spilled_value_runs.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/util/summation.h"
 
@@ -105,6 +106,14 @@ public:
     /// Reset this accumulator to a fresh state, ready for a new call to startNewGroup.
     virtual void reset() = 0;
 
+    /**
+     * Returns whether this accumulator has written any of its state to disk in order to stay
+     * within its memory limit.
+     */
+    virtual bool usedDisk() const {
+        return false;
+    }
+
     virtual bool isAssociative() const {
         return false;
     }
@@ -160,7 +169,9 @@ class AccumulatorAddToSet final : public AccumulatorState {
 public:
     /**
      * Creates a new $addToSet accumulator. If no memory limit is given, defaults to the value of
-     * the server parameter 'internalQueryMaxAddToSetBytes'.
+     * the server parameter 'internalQueryMaxAddToSetBytes'. When the operation allows disk use,
+     * the set is written to disk each time it reaches the limit, and the spilled values are read
+     * back and de-duplicated by getValue().
      */
     AccumulatorAddToSet(ExpressionContext* const expCtx,
                         boost::optional<int> maxMemoryUsageBytes = boost::none);
@@ -180,8 +191,19 @@ public:
         return true;
     }
 
+    bool usedDisk() const final {
+        return !_spilledValues.empty();
+    }
+
 private:
+    /**
+     * Writes the contents of '_set' to disk and empties it if the memory limit has been reached,
+     * or throws if the values can't be spilled.
+     */
+    void spillIfOverMemoryLimit();
+
     ValueUnorderedSet _set;
+    SpilledValueRuns _spilledValues;
     int _maxMemUsageBytes;
 };
 
@@ -292,7 +314,8 @@ class AccumulatorPush final : public AccumulatorState {
 public:
     /**
      * Creates a new $push accumulator. If no memory limit is given, defaults to the value of the
-     * server parameter 'internalQueryMaxPushBytes'.
+     * server parameter 'internalQueryMaxPushBytes'. When the operation allows disk use, the array
+     * is written to disk each time it reaches the limit, and getValue() reads it back in order.
      */
     AccumulatorPush(ExpressionContext* const expCtx,
                     boost::optional<int> maxMemoryUsageBytes = boost::none);
@@ -304,8 +327,19 @@ public:
 
     static boost::intrusive_ptr<AccumulatorState> create(ExpressionContext* const expCtx);
 
+    bool usedDisk() const final {
+        return !_spilledValues.empty();
+    }
+
 private:
+    /**
+     * Writes the contents of '_array' to disk and empties it if the memory limit has been reached,
+     * or throws if the values can't be spilled.
+     */
+    void spillIfOverMemoryLimit();
+
     std::vector<Value> _array;
+    SpilledValueRuns _spilledValues;
     int _maxMemUsageBytes;
 };
 
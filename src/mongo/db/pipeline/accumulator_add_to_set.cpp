@@ -52,11 +52,7 @@ void AccumulatorAddToSet::processInternal(const Value& input, bool merging) {
         bool inserted = _set.insert(val).second;
         if (inserted) {
             _memUsageBytes += val.getApproximateSize();
-            uassert(ErrorCodes::ExceededMemoryLimit,
-                    str::stream()
-                        << "$addToSet used too much memory and cannot spill to disk. Memory limit: "
-                        << _maxMemUsageBytes << " bytes",
-                    _memUsageBytes < _maxMemUsageBytes);
+            spillIfOverMemoryLimit();
         }
     };
     if (!merging) {
@@ -75,7 +71,28 @@ void AccumulatorAddToSet::processInternal(const Value& input, bool merging) {
     }
 }
 
+void AccumulatorAddToSet::spillIfOverMemoryLimit() {
+    if (_memUsageBytes < _maxMemUsageBytes) {
+        return;
+    }
+    uassert(ErrorCodes::ExceededMemoryLimit,
+            str::stream()
+                << "$addToSet used too much memory and cannot spill to disk. Memory limit: "
+                << _maxMemUsageBytes << " bytes",
+            SpilledValueRuns::canSpill(getExpressionContext()));
+
+    // Values which are added after this point may duplicate spilled ones, so the spilled runs are
+    // de-duplicated against the in-memory set when the result is produced.
+    _spilledValues.addRun(vector<Value>(_set.begin(), _set.end()));
+    _set = getExpressionContext()->getValueComparator().makeUnorderedValueSet();
+    _memUsageBytes = sizeof(*this);
+}
+
 Value AccumulatorAddToSet::getValue(bool toBeMerged) {
+    if (!_spilledValues.empty()) {
+        _spilledValues.forEach([&](const Value& val) { _set.insert(val); });
+        _spilledValues.clear();
+    }
     return Value(vector<Value>(_set.begin(), _set.end()));
 }
 
@@ -83,12 +100,14 @@ AccumulatorAddToSet::AccumulatorAddToSet(ExpressionContext* const expCtx,
                                          boost::optional<int> maxMemoryUsageBytes)
     : AccumulatorState(expCtx),
       _set(expCtx->getValueComparator().makeUnorderedValueSet()),
+      _spilledValues(expCtx),
       _maxMemUsageBytes(maxMemoryUsageBytes.value_or(internalQueryMaxAddToSetBytes.load())) {
     _memUsageBytes = sizeof(*this);
 }
 
 void AccumulatorAddToSet::reset() {
     _set = getExpressionContext()->getValueComparator().makeUnorderedValueSet();
+    _spilledValues.clear();
     _memUsageBytes = sizeof(*this);
 }
 
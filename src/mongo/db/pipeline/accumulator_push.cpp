@@ -52,11 +52,7 @@ void AccumulatorPush::processInternal(const Value& input, bool merging) {
         if (!input.missing()) {
             _array.push_back(input);
             _memUsageBytes += input.getApproximateSize();
-            uassert(ErrorCodes::ExceededMemoryLimit,
-                    str::stream()
-                        << "$push used too much memory and cannot spill to disk. Memory limit: "
-                        << _maxMemUsageBytes << " bytes",
-                    _memUsageBytes < _maxMemUsageBytes);
+            spillIfOverMemoryLimit();
         }
     } else {
         // If we're merging, we need to take apart the arrays we receive and put their elements into
@@ -64,32 +60,52 @@ void AccumulatorPush::processInternal(const Value& input, bool merging) {
         // array from each merge source.
         invariant(input.getType() == Array);
 
-        const vector<Value>& vec = input.getArray();
-        for (auto&& val : vec) {
+        for (auto&& val : input.getArray()) {
+            _array.push_back(val);
             _memUsageBytes += val.getApproximateSize();
-            uassert(ErrorCodes::ExceededMemoryLimit,
-                    str::stream()
-                        << "$push used too much memory and cannot spill to disk. Memory limit: "
-                        << _maxMemUsageBytes << " bytes",
-                    _memUsageBytes < _maxMemUsageBytes);
+            spillIfOverMemoryLimit();
         }
-        _array.insert(_array.end(), vec.begin(), vec.end());
     }
 }
 
+void AccumulatorPush::spillIfOverMemoryLimit() {
+    if (_memUsageBytes < _maxMemUsageBytes) {
+        return;
+    }
+    uassert(ErrorCodes::ExceededMemoryLimit,
+            str::stream() << "$push used too much memory and cannot spill to disk. Memory limit: "
+                          << _maxMemUsageBytes << " bytes",
+            SpilledValueRuns::canSpill(getExpressionContext()));
+
+    _spilledValues.addRun(_array);
+    vector<Value>().swap(_array);
+    _memUsageBytes = sizeof(*this);
+}
+
 Value AccumulatorPush::getValue(bool toBeMerged) {
-    return Value(_array);
+    if (_spilledValues.empty()) {
+        return Value(_array);
+    }
+
+    // The spilled values come before the ones still in memory.
+    vector<Value> result;
+    result.reserve(_spilledValues.numValues() + _array.size());
+    _spilledValues.forEach([&](const Value& val) { result.push_back(val); });
+    result.insert(result.end(), _array.begin(), _array.end());
+    return Value(std::move(result));
 }
 
 AccumulatorPush::AccumulatorPush(ExpressionContext* const expCtx,
                                  boost::optional<int> maxMemoryUsageBytes)
     : AccumulatorState(expCtx),
+      _spilledValues(expCtx),
       _maxMemUsageBytes(maxMemoryUsageBytes.value_or(internalQueryMaxPushBytes.load())) {
     _memUsageBytes = sizeof(*this);
 }
 
 void AccumulatorPush::reset() {
     vector<Value>().swap(_array);
+    _spilledValues.clear();
     _memUsageBytes = sizeof(*this);
 }
 
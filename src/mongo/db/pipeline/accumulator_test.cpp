@@ -41,6 +41,7 @@
 #include "mongo/db/query/collation/collator_interface_mock.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/logv2/log.h"
+#include "mongo/unittest/temp_dir.h"
 
 namespace AccumulatorTests {
 
@@ -368,6 +369,76 @@ TEST(Accumulators, PushRespectsMaxMemoryConstraint) {
         ErrorCodes::ExceededMemoryLimit);
 }
 
+TEST(Accumulators, PushSpillsToDiskWhenAllowed) {
+    auto expCtx = ExpressionContextForTest{};
+    unittest::TempDir tempDir("AccumulatorTests");
+    expCtx.tempDir = tempDir.path();
+    expCtx.allowDiskUse = true;
+
+    const int maxMemoryBytes = 1000;
+    auto push = AccumulatorPush(&expCtx, maxMemoryBytes);
+    std::vector<Value> expected;
+    for (int i = 0; i < 50; ++i) {
+        expected.push_back(Value(std::string(100, 'a' + (i % 26))));
+        push.process(expected.back(), false);
+    }
+    ASSERT_TRUE(push.usedDisk());
+    ASSERT_LT(push.memUsageForSorter(), maxMemoryBytes);
+
+    // Merging appends the values in order after the ones already accumulated.
+    std::vector<Value> toMerge(20, Value(std::string(100, 'z')));
+    push.process(Value(toMerge), true);
+    expected.insert(expected.end(), toMerge.begin(), toMerge.end());
+
+    ASSERT_VALUE_EQ(push.getValue(false), Value(expected));
+
+    push.reset();
+    ASSERT_FALSE(push.usedDisk());
+    ASSERT_VALUE_EQ(push.getValue(false), Value(std::vector<Value>()));
+}
+
+TEST(Accumulators, AddToSetSpillsToDiskWhenAllowed) {
+    auto expCtx = ExpressionContextForTest{};
+    unittest::TempDir tempDir("AccumulatorTests");
+    expCtx.tempDir = tempDir.path();
+    expCtx.allowDiskUse = true;
+
+    const int maxMemoryBytes = 1000;
+    auto addToSet = AccumulatorAddToSet(&expCtx, maxMemoryBytes);
+
+    // Add every value several times, so that some of the duplicates are spilled more than once.
+    const int numDistinct = 40;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < numDistinct; ++i) {
+            addToSet.process(Value(std::to_string(i) + std::string(100, 'x')), false);
+        }
+    }
+    ASSERT_TRUE(addToSet.usedDisk());
+
+    auto result = addToSet.getValue(false);
+    ASSERT_EQ(result.getArrayLength(), size_t(numDistinct));
+    auto distinct = expCtx.getValueComparator().makeOrderedValueSet();
+    for (auto&& val : result.getArray()) {
+        distinct.insert(val);
+    }
+    ASSERT_EQ(distinct.size(), size_t(numDistinct));
+}
+
+TEST(Accumulators, PushDoesNotSpillToDiskInMongos) {
+    auto expCtx = ExpressionContextForTest{};
+    unittest::TempDir tempDir("AccumulatorTests");
+    expCtx.tempDir = tempDir.path();
+    expCtx.allowDiskUse = true;
+    expCtx.inMongos = true;
+
+    auto push = AccumulatorPush(&expCtx, 20);
+    ASSERT_THROWS_CODE(
+        push.process(Value("This is a large string. Certainly we must be over 20 bytes by now"_sd),
+                     false),
+        AssertionException,
+        ErrorCodes::ExceededMemoryLimit);
+}
+
 /* ------------------------- AccumulatorMergeObjects -------------------------- */
 
 TEST(AccumulatorMergeObjects, MergingZeroObjectsShouldReturnEmptyDocument) {
@@ -33,6 +33,7 @@
 
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/db/query/query_knobs_gen.h"
 
 namespace mongo {
 
@@ -89,18 +90,34 @@ const char* DocumentSourceBucketAuto::getSourceName() const {
 
 DocumentSource::GetNextResult DocumentSourceBucketAuto::doGetNext() {
     if (!_populated) {
-        const auto populationResult = populateSorter();
+        const auto populationResult = _approximate ? populateCells() : populateSorter();
         if (populationResult.isPaused()) {
             return populationResult;
         }
         invariant(populationResult.isEOF());
 
-        initalizeBucketIteration();
+        if (_approximate) {
+            _cellsIt = _cells.begin();
+        } else {
+            initalizeBucketIteration();
+        }
         _populated = true;
     }
 
+    if (_approximate && pExpCtx->needsMerge) {
+        // This is the shard half of a split pipeline, so return the summary itself rather than the
+        // buckets. The merging $bucketAuto will compute the boundaries from all shards' summaries.
+        if (_cellsIt != _cells.end()) {
+            auto out = makePartialDocument(_cellsIt->first, _cellsIt->second);
+            ++_cellsIt;
+            return out;
+        }
+        dispose();
+        return GetNextResult::makeEOF();
+    }
+
     if (_currentBucketDetails.currentBucketNum++ < _nBuckets) {
-        if (auto bucket = populateNextBucket()) {
+        if (auto bucket = _approximate ? populateNextApproximateBucket() : populateNextBucket()) {
             return makeDocument(*bucket);
         }
     }
@@ -108,6 +125,24 @@ DocumentSource::GetNextResult DocumentSourceBucketAuto::doGetNext() {
     return GetNextResult::makeEOF();
 }
 
+boost::optional<DocumentSource::DistributedPlanLogic>
+DocumentSourceBucketAuto::distributedPlanLogic() {
+    if (!_approximate) {
+        // {shardsStage, mergingStage, sortPattern}
+        return DistributedPlanLogic{nullptr, this, boost::none};
+    }
+
+    auto mergingStage = DocumentSourceBucketAuto::create(pExpCtx,
+                                                         _groupByExpression,
+                                                         _nBuckets,
+                                                         _accumulatedFields,
+                                                         nullptr,
+                                                         _maxMemoryUsageBytes,
+                                                         true);
+    mergingStage->setDoingMerge(true);
+    return DistributedPlanLogic{this, mergingStage, boost::none};
+}
+
 boost::intrusive_ptr<DocumentSource> DocumentSourceBucketAuto::optimize() {
     _groupByExpression = _groupByExpression->optimize();
     for (auto&& accumulatedField : _accumulatedFields) {
@@ -118,6 +153,13 @@ boost::intrusive_ptr<DocumentSource> DocumentSourceBucketAuto::optimize() {
 }
 
 DepsTracker::State DocumentSourceBucketAuto::getDependencies(DepsTracker* deps) const {
+    if (_doingMerge) {
+        // The input consists of the cells emitted by the shards, which bear no relation to the
+        // fields referenced by the 'groupBy' and 'output' expressions.
+        deps->needWholeDocument = true;
+        return DepsTracker::State::EXHAUSTIVE_ALL;
+    }
+
     // Add the 'groupBy' expression.
     _groupByExpression->addDependencies(deps);
 
@@ -161,6 +203,111 @@ DocumentSource::GetNextResult DocumentSourceBucketAuto::populateSorter() {
     return next;
 }
 
+DocumentSource::GetNextResult DocumentSourceBucketAuto::populateCells() {
+    auto next = pSource->getNext();
+    for (; next.isAdvanced(); next = pSource->getNext()) {
+        auto nextDoc = next.releaseDocument();
+        const size_t numAccumulators = _accumulatedFields.size();
+        if (_doingMerge) {
+            // Each input document describes a cell computed by a shard. See makePartialDocument().
+            const Value id = nextDoc["_id"];
+            const long long count = id["count"].coerceToLong();
+            auto& cell = getOrCreateCell(id["min"], id["max"]);
+            cell.count += count;
+            _nDocuments += count;
+            for (size_t k = 0; k < numAccumulators; k++) {
+                cell.accums[k]->process(nextDoc[_accumulatedFields[k].fieldName], true);
+            }
+        } else {
+            const Value key = extractKey(nextDoc);
+            auto& cell = getOrCreateCell(key, key);
+            ++cell.count;
+            ++_nDocuments;
+            for (size_t k = 0; k < numAccumulators; k++) {
+                cell.accums[k]->process(
+                    _accumulatedFields[k].expr.argument->evaluate(nextDoc, &pExpCtx->variables),
+                    false);
+            }
+        }
+
+        // Let the summary grow to twice its capacity before compacting it back down, so that the
+        // cost of compaction is amortized over many documents.
+        if (_cells.size() > 2 * _maxCells) {
+            compactCells();
+        }
+    }
+    return next;
+}
+
+std::vector<intrusive_ptr<AccumulatorState>> DocumentSourceBucketAuto::makeStartedAccumulators() {
+    // Evaluate each initializer against an empty document. Normally the initializer can refer to
+    // the group key, but in $bucketAuto there is no single group key per bucket.
+    Document emptyDoc;
+    std::vector<intrusive_ptr<AccumulatorState>> accums;
+    accums.reserve(_accumulatedFields.size());
+    for (auto&& accumulatedField : _accumulatedFields) {
+        accums.push_back(accumulatedField.makeAccumulator());
+        accums.back()->startNewGroup(
+            accumulatedField.expr.initializer->evaluate(emptyDoc, &pExpCtx->variables));
+    }
+    return accums;
+}
+
+DocumentSourceBucketAuto::Cell& DocumentSourceBucketAuto::getOrCreateCell(const Value& min,
+                                                                          const Value& max) {
+    const auto& valueCmp = pExpCtx->getValueComparator();
+
+    // The candidate is the cell with the greatest minimum not exceeding 'min'. If it covers the
+    // whole range, or starts at the same value, then the range is folded into it. Otherwise we
+    // start a new cell. Cells summarized on a single host never overlap, but cells received from
+    // different shards may, which only affects the precision of the boundaries.
+    auto it = _cells.upper_bound(min);
+    if (it != _cells.begin()) {
+        auto prev = std::prev(it);
+        if (valueCmp.evaluate(prev->second.max >= max)) {
+            return prev->second;
+        }
+        if (valueCmp.evaluate(prev->first == min)) {
+            prev->second.max = max;
+            return prev->second;
+        }
+    }
+    return _cells.emplace_hint(it, min, Cell{max, 0, makeStartedAccumulators()})->second;
+}
+
+void DocumentSourceBucketAuto::mergeAccumulators(
+    const std::vector<intrusive_ptr<AccumulatorState>>& source,
+    std::vector<intrusive_ptr<AccumulatorState>>& target) {
+    const size_t numAccumulators = _accumulatedFields.size();
+    for (size_t k = 0; k < numAccumulators; k++) {
+        target[k]->process(source[k]->getValue(true), true);
+    }
+}
+
+void DocumentSourceBucketAuto::compactCells() {
+    // Combine each run of adjacent cells for as long as their total count stays within
+    // 'threshold'. Any two neighbouring cells that remain hold more than 'threshold' documents
+    // between them, so at most about '_maxCells' cells are left, and no cell spanning several
+    // values holds more than 1/16th of a bucket with the default number of cells per bucket.
+    const long long threshold =
+        std::max(1LL, 2 * _nDocuments / static_cast<long long>(_maxCells));
+    const auto& valueCmp = pExpCtx->getValueComparator();
+
+    auto it = _cells.begin();
+    while (it != _cells.end()) {
+        auto next = std::next(it);
+        while (next != _cells.end() && it->second.count + next->second.count <= threshold) {
+            if (valueCmp.evaluate(next->second.max > it->second.max)) {
+                it->second.max = next->second.max;
+            }
+            it->second.count += next->second.count;
+            mergeAccumulators(next->second.accums, it->second.accums);
+            next = _cells.erase(next);
+        }
+        it = next;
+    }
+}
+
 Value DocumentSourceBucketAuto::extractKey(const Document& doc) {
     if (!_groupByExpression) {
         return Value(BSONNULL);
@@ -324,6 +471,42 @@ boost::optional<DocumentSourceBucketAuto::Bucket> DocumentSourceBucketAuto::popu
     return currentBucket;
 }
 
+boost::optional<DocumentSourceBucketAuto::Bucket>
+DocumentSourceBucketAuto::populateNextApproximateBucket() {
+    if (_cellsIt == _cells.end()) {
+        return {};
+    }
+
+    const auto& valueCmp = pExpCtx->getValueComparator();
+    Bucket currentBucket(pExpCtx, _cellsIt->first, _cellsIt->second.max, {});
+    currentBucket._accums = makeStartedAccumulators();
+
+    // Add cells to the bucket until the documents returned so far make up this bucket's share of
+    // the input. A cell is only added if at least half of it falls within that share, and the last
+    // bucket takes all of the remaining cells.
+    const auto isLastBucket = (_currentBucketDetails.currentBucketNum == _nBuckets);
+    const double targetDocuments =
+        double(_nDocuments) * _currentBucketDetails.currentBucketNum / _nBuckets;
+    do {
+        const auto& cell = _cellsIt->second;
+        if (valueCmp.evaluate(cell.max > currentBucket._max)) {
+            currentBucket._max = cell.max;
+        }
+        _nCellDocumentsReturned += cell.count;
+        mergeAccumulators(cell.accums, currentBucket._accums);
+        ++_cellsIt;
+    } while (_cellsIt != _cells.end() &&
+             (isLastBucket ||
+              _nCellDocumentsReturned + _cellsIt->second.count / 2.0 <= targetDocuments));
+
+    // As in the exact case, a bucket's max boundary is the next bucket's min, so that max
+    // boundaries are exclusive except for the last bucket's.
+    if (_cellsIt != _cells.end()) {
+        currentBucket._max = _cellsIt->first;
+    }
+    return currentBucket;
+}
+
 DocumentSourceBucketAuto::Bucket::Bucket(
     const boost::intrusive_ptr<ExpressionContext>& expCtx,
     Value min,
@@ -354,8 +537,27 @@ Document DocumentSourceBucketAuto::makeDocument(const Bucket& bucket) {
     return out.freeze();
 }
 
+Document DocumentSourceBucketAuto::makePartialDocument(const Value& min, const Cell& cell) {
+    const size_t nAccumulatedFields = _accumulatedFields.size();
+    MutableDocument out(1 + nAccumulatedFields);
+
+    out.addField(
+        "_id",
+        Value{Document{{"min", min}, {"max", cell.max}, {"count", Value(cell.count)}}});
+
+    const bool mergingOutput = true;
+    for (size_t i = 0; i < nAccumulatedFields; i++) {
+        Value val = cell.accums[i]->getValue(mergingOutput);
+        out.addField(_accumulatedFields[i].fieldName,
+                     val.missing() ? Value(BSONNULL) : std::move(val));
+    }
+    return out.freeze();
+}
+
 void DocumentSourceBucketAuto::doDispose() {
     _sortedInput.reset();
+    _cells.clear();
+    _cellsIt = _cells.end();
 }
 
 Value DocumentSourceBucketAuto::serialize(
@@ -369,6 +571,14 @@ Value DocumentSourceBucketAuto::serialize(
         insides["granularity"] = Value(_granularityRounder->getName());
     }
 
+    if (_approximate) {
+        insides["approximate"] = Value(true);
+    }
+
+    if (_doingMerge) {
+        insides["$doingMerge"] = Value(true);
+    }
+
     MutableDocument outputSpec(_accumulatedFields.size());
     for (auto&& accumulatedField : _accumulatedFields) {
         intrusive_ptr<AccumulatorState> accum = accumulatedField.makeAccumulator();
@@ -388,11 +598,15 @@ intrusive_ptr<DocumentSourceBucketAuto> DocumentSourceBucketAuto::create(
     int numBuckets,
     std::vector<AccumulationStatement> accumulationStatements,
     const boost::intrusive_ptr<GranularityRounder>& granularityRounder,
-    uint64_t maxMemoryUsageBytes) {
+    uint64_t maxMemoryUsageBytes,
+    bool approximate) {
     uassert(40243,
             str::stream() << "The $bucketAuto 'buckets' field must be greater than 0, but found: "
                           << numBuckets,
             numBuckets > 0);
+    uassert(5095416,
+            "The $bucketAuto 'granularity' field cannot be specified with 'approximate'",
+            !(approximate && granularityRounder));
     // If there is no output field specified, then add the default one.
     if (accumulationStatements.empty()) {
         accumulationStatements.emplace_back(
@@ -406,7 +620,8 @@ intrusive_ptr<DocumentSourceBucketAuto> DocumentSourceBucketAuto::create(
                                         numBuckets,
                                         accumulationStatements,
                                         granularityRounder,
-                                        maxMemoryUsageBytes);
+                                        maxMemoryUsageBytes,
+                                        approximate);
 }
 
 DocumentSourceBucketAuto::DocumentSourceBucketAuto(
@@ -415,9 +630,15 @@ DocumentSourceBucketAuto::DocumentSourceBucketAuto(
     int numBuckets,
     std::vector<AccumulationStatement> accumulationStatements,
     const boost::intrusive_ptr<GranularityRounder>& granularityRounder,
-    uint64_t maxMemoryUsageBytes)
+    uint64_t maxMemoryUsageBytes,
+    bool approximate)
     : DocumentSource(kStageName, pExpCtx),
+      _cells(pExpCtx->getValueComparator().getLessThan()),
+      _cellsIt(_cells.end()),
+      _maxCells(static_cast<size_t>(numBuckets) *
+                internalDocumentSourceBucketAutoApproximateCellsPerBucket.load()),
       _maxMemoryUsageBytes(maxMemoryUsageBytes),
+      _approximate(approximate),
       _groupByExpression(groupByExpression),
       _granularityRounder(granularityRounder),
       _nBuckets(numBuckets),
@@ -448,6 +669,8 @@ intrusive_ptr<DocumentSource> DocumentSourceBucketAuto::createFromBson(
     boost::intrusive_ptr<Expression> groupByExpression;
     boost::optional<int> numBuckets;
     boost::intrusive_ptr<GranularityRounder> granularityRounder;
+    bool approximate = false;
+    bool doingMerge = false;
 
     for (auto&& argument : elem.Obj()) {
         const auto argName = argument.fieldNameStringData();
@@ -493,6 +716,18 @@ intrusive_ptr<DocumentSource> DocumentSourceBucketAuto::createFromBson(
                         << typeName(argument.type()),
                     argument.type() == BSONType::String);
             granularityRounder = GranularityRounder::getGranularityRounder(pExpCtx, argument.str());
+        } else if ("approximate" == argName) {
+            uassert(5095417,
+                    str::stream()
+                        << "The $bucketAuto 'approximate' field must be a boolean, but found type: "
+                        << typeName(argument.type()),
+                    argument.type() == BSONType::Bool);
+            approximate = argument.boolean();
+        } else if ("$doingMerge" == argName) {
+            uassert(5095418,
+                    "$doingMerge should be true if present",
+                    argument.type() == BSONType::Bool && argument.boolean());
+            doingMerge = true;
         } else {
             uasserted(40245, str::stream() << "Unrecognized option to $bucketAuto: " << argName);
         }
@@ -502,8 +737,19 @@ intrusive_ptr<DocumentSource> DocumentSourceBucketAuto::createFromBson(
             "$bucketAuto requires 'groupBy' and 'buckets' to be specified",
             groupByExpression && numBuckets);
 
-    return DocumentSourceBucketAuto::create(
-        pExpCtx, groupByExpression, numBuckets.get(), accumulationStatements, granularityRounder);
+    uassert(5095419,
+            "$bucketAuto can only specify '$doingMerge' together with 'approximate'",
+            approximate || !doingMerge);
+
+    auto bucketAuto = DocumentSourceBucketAuto::create(pExpCtx,
+                                                       groupByExpression,
+                                                       numBuckets.get(),
+                                                       accumulationStatements,
+                                                       granularityRounder,
+                                                       kDefaultMaxMemoryUsageBytes,
+                                                       approximate);
+    bucketAuto->setDoingMerge(doingMerge);
+    return bucketAuto;
 }
 
 }  // namespace mongo
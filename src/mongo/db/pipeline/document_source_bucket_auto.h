@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <map>
+
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source.h"
@@ -41,6 +43,14 @@ namespace mongo {
 /**
  * The $bucketAuto stage takes a user-specified number of buckets and automatically determines
  * boundaries such that the values are approximately equally distributed between those buckets.
+ *
+ * By default the stage sorts its entire input to compute exact boundaries, and so must run on the
+ * merging half of a split pipeline. When 'approximate' is set, the stage instead builds a bounded
+ * summary of the input in a single streaming pass: an ordered set of non-overlapping ranges of
+ * 'groupBy' values ("cells"), each holding a document count and partial accumulator state. Cells
+ * are combined whenever there are too many of them, so every bucket boundary is off by at most a
+ * fraction of a bucket. Since summaries are mergeable, the stage can be split across shards: each
+ * shard emits its cells, and the merging stage combines them before computing the boundaries.
  */
 class DocumentSourceBucketAuto final : public DocumentSource {
 public:
@@ -63,12 +73,10 @@ public:
     }
 
     /**
-     * The $bucketAuto stage must be run on the merging shard.
+     * An exact $bucketAuto stage must be run on the merging shard. An approximate one summarizes
+     * its input on each shard and merges those summaries on the merging shard.
      */
-    boost::optional<DistributedPlanLogic> distributedPlanLogic() final {
-        // {shardsStage, mergingStage, sortPattern}
-        return DistributedPlanLogic{nullptr, this, boost::none};
-    }
+    boost::optional<DistributedPlanLogic> distributedPlanLogic() final;
 
     static const uint64_t kDefaultMaxMemoryUsageBytes = 100 * 1024 * 1024;
 
@@ -84,7 +92,8 @@ public:
         int numBuckets,
         std::vector<AccumulationStatement> accumulationStatements = {},
         const boost::intrusive_ptr<GranularityRounder>& granularityRounder = nullptr,
-        uint64_t maxMemoryUsageBytes = kDefaultMaxMemoryUsageBytes);
+        uint64_t maxMemoryUsageBytes = kDefaultMaxMemoryUsageBytes,
+        bool approximate = false);
 
     /**
      * Parses a $bucketAuto stage from the user-supplied BSON.
@@ -95,6 +104,23 @@ public:
     const boost::intrusive_ptr<Expression> getGroupByExpression() const;
     const std::vector<AccumulationStatement>& getAccumulatedFields() const;
 
+    bool isApproximate() const {
+        return _approximate;
+    }
+
+    /**
+     * Tells this approximate stage that its input consists of the cells emitted by the shard half
+     * of a split pipeline, rather than of documents to be bucketed.
+     */
+    void setDoingMerge(bool doingMerge) {
+        invariant(_approximate || !doingMerge);
+        _doingMerge = doingMerge;
+    }
+
+    bool doingMerge() const {
+        return _doingMerge;
+    }
+
 protected:
     GetNextResult doGetNext() final;
     void doDispose() final;
@@ -105,7 +131,8 @@ private:
                              int numBuckets,
                              std::vector<AccumulationStatement> accumulationStatements,
                              const boost::intrusive_ptr<GranularityRounder>& granularityRounder,
-                             uint64_t maxMemoryUsageBytes);
+                             uint64_t maxMemoryUsageBytes,
+                             bool approximate);
 
     // struct for holding information about a bucket.
     struct Bucket {
@@ -118,6 +145,16 @@ private:
         std::vector<boost::intrusive_ptr<AccumulatorState>> _accums;
     };
 
+    // A range of 'groupBy' values in the approximate summary. The range's minimum is the key under
+    // which the cell is stored.
+    struct Cell {
+        Value max;
+        long long count = 0;
+        std::vector<boost::intrusive_ptr<AccumulatorState>> accums;
+    };
+
+    using CellMap = std::map<Value, Cell, ValueComparator::LessThan>;
+
     struct BucketDetails {
         int currentBucketNum;
         long long approxBucketSize = 0;
@@ -152,6 +189,46 @@ private:
      */
     void addDocumentToBucket(const std::pair<Value, Document>& entry, Bucket& bucket);
 
+    /**
+     * Consumes all of the documents from the source in the pipeline and adds them to the
+     * approximate summary. Like populateSorter(), this returns the last GetNextResult encountered,
+     * which may be either kEOF or kPauseExecution.
+     */
+    GetNextResult populateCells();
+
+    /**
+     * Returns a fresh set of accumulators, each started with its initializer value.
+     */
+    std::vector<boost::intrusive_ptr<AccumulatorState>> makeStartedAccumulators();
+
+    /**
+     * Returns the cell covering the range ['min', 'max'], creating it if needed. Existing cells
+     * overlapping that range are combined into the returned cell.
+     */
+    Cell& getOrCreateCell(const Value& min, const Value& max);
+
+    /**
+     * Folds the accumulated state of 'source' into 'target'.
+     */
+    void mergeAccumulators(const std::vector<boost::intrusive_ptr<AccumulatorState>>& source,
+                           std::vector<boost::intrusive_ptr<AccumulatorState>>& target);
+
+    /**
+     * Combines adjacent cells until at most about half of the summary's capacity is used.
+     */
+    void compactCells();
+
+    /**
+     * Returns the next bucket computed from the approximate summary, or boost::none if no cells
+     * remain.
+     */
+    boost::optional<Bucket> populateNextApproximateBucket();
+
+    /**
+     * Makes the document emitted for 'cell' when this stage feeds a merging $bucketAuto.
+     */
+    Document makePartialDocument(const Value& min, const Cell& cell);
+
     /**
      * Makes a document using the information from bucket. This is what is returned when getNext()
      * is called.
@@ -161,10 +238,17 @@ private:
     std::unique_ptr<Sorter<Value, Document>> _sorter;
     std::unique_ptr<Sorter<Value, Document>::Iterator> _sortedInput;
 
+    CellMap _cells;
+    CellMap::iterator _cellsIt;
+    size_t _maxCells;
+    long long _nCellDocumentsReturned = 0;
+
     std::vector<AccumulationStatement> _accumulatedFields;
 
     uint64_t _maxMemoryUsageBytes;
     bool _populated = false;
+    bool _approximate = false;
+    bool _doingMerge = false;
     boost::intrusive_ptr<Expression> _groupByExpression;
     boost::intrusive_ptr<GranularityRounder> _granularityRounder;
     int _nBuckets;
@@ -449,6 +449,121 @@ TEST_F(BucketAutoTests, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_TRUE(bucketAutoStage->getNext().isEOF());
 }
 
+TEST_F(BucketAutoTests, ApproximateModeMatchesExactModeWhenSummaryIsSmall) {
+    auto bucketAutoSpec =
+        fromjson("{$bucketAuto : {groupBy : '$x', buckets : 2, approximate : true}}");
+
+    auto results = getResults(
+        bucketAutoSpec,
+        {Document{{"x", 4}}, Document{{"x", 1}}, Document{{"x", 3}}, Document{{"x", 2}}});
+    ASSERT_EQUALS(results.size(), 2UL);
+    ASSERT_DOCUMENT_EQ(results[0], Document(fromjson("{_id : {min : 1, max : 3}, count : 2}")));
+    ASSERT_DOCUMENT_EQ(results[1], Document(fromjson("{_id : {min : 3, max : 4}, count : 2}")));
+}
+
+TEST_F(BucketAutoTests, ApproximateModeProducesEvenBucketsFromCompactedSummary) {
+    auto bucketAutoSpec = fromjson(
+        "{$bucketAuto : {groupBy : '$x', buckets : 4, approximate : true, output : {count : "
+        "{$sum : 1}, total : {$sum : '$x'}}}}");
+
+    // Feed the values in an interleaved order so that the summary is compacted repeatedly while
+    // it is being built.
+    const int numDocs = 1000;
+    deque<Document> inputs;
+    for (int i = 0; i < numDocs; ++i) {
+        inputs.push_back(Document{{"x", (i * 7) % numDocs}});
+    }
+    auto results = getResults(bucketAutoSpec, inputs);
+    ASSERT_EQUALS(results.size(), 4UL);
+
+    long long totalCount = 0;
+    long long totalSum = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto count = results[i]["count"].coerceToLong();
+        ASSERT_LTE(std::abs(count - numDocs / 4), numDocs / 32);
+        totalCount += count;
+        totalSum += results[i]["total"].coerceToLong();
+
+        if (i + 1 < results.size()) {
+            ASSERT_VALUE_EQ(results[i]["_id"]["max"], results[i + 1]["_id"]["min"]);
+        }
+    }
+    ASSERT_EQUALS(totalCount, numDocs);
+    ASSERT_EQUALS(totalSum, numDocs * (numDocs - 1) / 2);
+    ASSERT_VALUE_EQ(results.front()["_id"]["min"], Value(0));
+    ASSERT_VALUE_EQ(results.back()["_id"]["max"], Value(numDocs - 1));
+}
+
+TEST_F(BucketAutoTests, ExactModeRunsEntirelyOnMergingShard) {
+    auto bucketAuto = createBucketAuto(fromjson("{$bucketAuto : {groupBy : '$x', buckets : 2}}"));
+    auto distributedPlanLogic = bucketAuto->distributedPlanLogic();
+    ASSERT(distributedPlanLogic);
+    ASSERT_FALSE(distributedPlanLogic->shardsStage);
+    ASSERT_EQ(distributedPlanLogic->mergingStage, bucketAuto);
+}
+
+TEST_F(BucketAutoTests, ApproximateModeMergesSummariesFromShards) {
+    auto expCtx = getExpCtx();
+    auto bucketAuto = createBucketAuto(fromjson(
+        "{$bucketAuto : {groupBy : '$x', buckets : 2, approximate : true, output : {count : "
+        "{$sum : 1}, maxX : {$max : '$x'}}}}"));
+    auto distributedPlanLogic = bucketAuto->distributedPlanLogic();
+    ASSERT(distributedPlanLogic);
+    ASSERT_EQ(distributedPlanLogic->shardsStage, bucketAuto);
+    auto mergingStage =
+        dynamic_cast<DocumentSourceBucketAuto*>(distributedPlanLogic->mergingStage.get());
+    ASSERT(mergingStage);
+    ASSERT_TRUE(mergingStage->doingMerge());
+
+    // The merging stage must be re-parseable from its serialization, since it may run on a shard.
+    vector<Value> serialization;
+    mergingStage->serializeToArray(serialization);
+    ASSERT_EQUALS(serialization.size(), 1UL);
+    ASSERT_VALUE_EQ(serialization[0]["$bucketAuto"]["$doingMerge"], Value(true));
+    auto reparsed = dynamic_cast<DocumentSourceBucketAuto*>(
+        createBucketAuto(serialization[0].getDocument().toBson()).get());
+    ASSERT(reparsed);
+    ASSERT_TRUE(reparsed->doingMerge());
+
+    vector<Value> shardSerialization;
+    distributedPlanLogic->shardsStage->serializeToArray(shardSerialization);
+    ASSERT_EQUALS(shardSerialization.size(), 1UL);
+
+    // Simulate two shards which each hold every other value, so that their summaries overlap.
+    const int numDocs = 1000;
+    deque<DocumentSource::GetNextResult> partials;
+    expCtx->needsMerge = true;
+    for (int shard = 0; shard < 2; ++shard) {
+        auto shardStage = createBucketAuto(shardSerialization[0].getDocument().toBson());
+        deque<DocumentSource::GetNextResult> inputs;
+        for (int i = shard; i < numDocs; i += 2) {
+            inputs.emplace_back(Document{{"x", i}});
+        }
+        auto source = DocumentSourceMock::createForTest(std::move(inputs), expCtx);
+        shardStage->setSource(source.get());
+        for (auto next = shardStage->getNext(); next.isAdvanced(); next = shardStage->getNext()) {
+            partials.push_back(next.releaseDocument());
+        }
+    }
+    expCtx->needsMerge = false;
+
+    auto source = DocumentSourceMock::createForTest(std::move(partials), expCtx);
+    mergingStage->setSource(source.get());
+    vector<Document> results;
+    for (auto next = mergingStage->getNext(); next.isAdvanced(); next = mergingStage->getNext()) {
+        results.push_back(next.releaseDocument());
+    }
+
+    ASSERT_EQUALS(results.size(), 2UL);
+    ASSERT_VALUE_EQ(results[0]["_id"]["min"], Value(0));
+    ASSERT_VALUE_EQ(results[0]["_id"]["max"], results[1]["_id"]["min"]);
+    ASSERT_VALUE_EQ(results[1]["_id"]["max"], Value(numDocs - 1));
+    ASSERT_VALUE_EQ(results[1]["maxX"], Value(numDocs - 1));
+    const auto firstCount = results[0]["count"].coerceToLong();
+    ASSERT_LTE(std::abs(firstCount - numDocs / 2), numDocs / 16);
+    ASSERT_EQUALS(firstCount + results[1]["count"].coerceToLong(), numDocs);
+}
+
 TEST_F(BucketAutoTests, SourceNameIsBucketAuto) {
     auto bucketAuto = createBucketAuto(fromjson("{$bucketAuto : {groupBy : '$x', buckets : 2}}"));
     ASSERT_EQUALS(string(bucketAuto->getSourceName()), "$bucketAuto");
@@ -527,6 +642,15 @@ TEST_F(BucketAutoTests, SerializesGranularityFieldIfSpecified) {
     testSerialize(spec, expected);
 }
 
+TEST_F(BucketAutoTests, SerializesApproximateFieldIfSpecified) {
+    BSONObj spec = fromjson("{$bucketAuto : {groupBy : '$x', buckets : 2, approximate : true}}");
+    BSONObj expected = fromjson(
+        "{groupBy : '$x', buckets : 2, approximate : true, output : {count : {$sum : {$const : "
+        "1}}}}");
+
+    testSerialize(spec, expected);
+}
+
 TEST_F(BucketAutoTests, ShouldBeAbleToReParseSerializedStage) {
     auto bucketAuto =
         createBucketAuto(fromjson("{$bucketAuto : {groupBy : '$x', buckets : 2, granularity: 'R5', "
@@ -574,6 +698,18 @@ TEST_F(BucketAutoTests, FailsWithInvalidNumberOfBuckets) {
         40243);
 }
 
+TEST_F(BucketAutoTests, FailsWithInvalidApproximateField) {
+    auto spec = fromjson("{$bucketAuto : {groupBy : '$x', buckets : 2, approximate : 1}}");
+    ASSERT_THROWS_CODE(createBucketAuto(spec), AssertionException, 5095417);
+
+    spec = fromjson(
+        "{$bucketAuto : {groupBy : '$x', buckets : 2, approximate : true, granularity : 'R5'}}");
+    ASSERT_THROWS_CODE(createBucketAuto(spec), AssertionException, 5095416);
+
+    spec = fromjson("{$bucketAuto : {groupBy : '$x', buckets : 2, $doingMerge : true}}");
+    ASSERT_THROWS_CODE(createBucketAuto(spec), AssertionException, 5095419);
+}
+
 TEST_F(BucketAutoTests, FailsWithNonExpressionGroupBy) {
     auto spec = fromjson("{$bucketAuto : {groupBy : 'test', buckets : 1}}");
     ASSERT_THROWS_CODE(createBucketAuto(spec), AssertionException, 40239);
@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/document_source_exchange.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/logv2/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -86,6 +87,7 @@ public:
 
 constexpr size_t Exchange::kMaxBufferSize;
 constexpr size_t Exchange::kMaxNumberConsumers;
+constexpr size_t Exchange::kMaxLoadChunkSize;
 
 const char* DocumentSourceExchange::getSourceName() const {
     return kStageName.rawData();
@@ -314,7 +316,7 @@ DocumentSource::GetNextResult Exchange::getNext(OperationContext* opCtx,
                 // This will return when some exchange buffer is full and we cannot make any forward
                 // progress anymore.
                 // The return value is an index of a full consumer buffer.
-                size_t fullConsumerId = loadNextBatch();
+                size_t fullConsumerId = loadNextBatch(lk);
 
                 if (MONGO_unlikely(exchangeFailLoadNextBatch.shouldFail())) {
                     LOGV2(20897, "exchangeFailLoadNextBatch fail point enabled.");
@@ -341,63 +343,94 @@ DocumentSource::GetNextResult Exchange::getNext(OperationContext* opCtx,
             }
         } else {
             // Some other consumer is already loading the buffers. There is nothing else we can do
-            // but wait.
+            // but wait, either for documents to be appended to our buffer or for our turn to load.
             MutexAndResourceLock mutexAndResourceLock(opCtx, std::move(lk), resourceYielder);
-            _haveBufferSpace.wait(mutexAndResourceLock);
-            lk = mutexAndResourceLock.releaseLockOwnership();
+            ON_BLOCK_EXIT([&] { lk = mutexAndResourceLock.releaseLockOwnership(); });
+            opCtx->waitForConditionOrInterrupt(_haveBufferSpace, mutexAndResourceLock, [&] {
+                return !_errorInLoadNextBatch.isOK() || !_consumers[consumerId]->isEmpty() ||
+                    _loadingThreadId == kInvalidThreadId;
+            });
         }
     }
 }
 
-size_t Exchange::loadNextBatch() {
-    auto input = _pipeline->getSources().back()->getNext();
+size_t Exchange::loadNextBatch(stdx::unique_lock<Latch>& lk) {
+    for (;;) {
+        // Read a chunk of the input with the mutex released, so that the other consumers can keep
+        // draining their buffers while this thread runs the input pipeline. No other thread may
+        // load at the same time, since '_loadingThreadId' is set.
+        std::vector<DocumentSource::GetNextResult> chunk;
+        {
+            lk.unlock();
+            ON_BLOCK_EXIT([&] { lk.lock(); });
+
+            do {
+                chunk.push_back(_pipeline->getSources().back()->getNext());
+            } while (chunk.back().isAdvanced() && chunk.size() < kMaxLoadChunkSize);
+        }
+
+        size_t fullConsumerId = kInvalidThreadId;
+        for (auto&& input : chunk) {
+            if (!input.isAdvanced()) {
+                invariant(input.isEOF());
 
-    for (; input.isAdvanced(); input = _pipeline->getSources().back()->getNext()) {
-        // We have a document and we will deliver it to a consumer(s) based on the policy.
-        switch (_policy) {
-            case ExchangePolicyEnum::kBroadcast: {
-                bool full = false;
-                // The document is sent to all consumers.
+                // We have reached the end so send EOS to all consumers.
                 for (auto& c : _consumers) {
-                    // By default the Document is shallow copied. However, the broadcasted document
-                    // can be used by multiple threads (consumers) and the Document is not thread
-                    // safe. Hence we have to clone the Document.
-                    auto copy = DocumentSource::GetNextResult(input.getDocument().clone());
-                    full = c->appendDocument(copy, _maxBufferSize);
+                    c->appendDocument(input, _maxBufferSize);
                 }
+                return kInvalidThreadId;
+            }
 
-                if (full)
-                    return 0;
-            } break;
-            case ExchangePolicyEnum::kRoundRobin: {
-                size_t target = _roundRobinCounter;
-                _roundRobinCounter = (_roundRobinCounter + 1) % _consumers.size();
-
-                if (_consumers[target]->appendDocument(std::move(input), _maxBufferSize))
-                    return target;
-            } break;
-            case ExchangePolicyEnum::kKeyRange: {
-                size_t target = getTargetConsumer(input.getDocument());
-                bool full = _consumers[target]->appendDocument(std::move(input), _maxBufferSize);
-                if (full && _orderPreserving) {
-                    // TODO send the high watermark here.
-                }
-                if (full)
-                    return target;
-            } break;
-            default:
-                MONGO_UNREACHABLE;
+            auto fullId = appendToBuffers(std::move(input));
+            if (fullConsumerId == kInvalidThreadId) {
+                fullConsumerId = fullId;
+            }
         }
-    }
 
-    invariant(input.isEOF());
+        if (fullConsumerId != kInvalidThreadId) {
+            return fullConsumerId;
+        }
 
-    // We have reached the end so send EOS to all consumers.
-    for (auto& c : _consumers) {
-        c->appendDocument(input, _maxBufferSize);
+        // Let the consumers waiting on empty buffers pick up the documents we have just appended.
+        _haveBufferSpace.notify_all();
     }
+}
+
+size_t Exchange::appendToBuffers(DocumentSource::GetNextResult input) {
+    // We have a document and we will deliver it to a consumer(s) based on the policy.
+    switch (_policy) {
+        case ExchangePolicyEnum::kBroadcast: {
+            bool full = false;
+            // The document is sent to all consumers.
+            for (auto& c : _consumers) {
+                // By default the Document is shallow copied. However, the broadcasted document
+                // can be used by multiple threads (consumers) and the Document is not thread
+                // safe. Hence we have to clone the Document.
+                auto copy = DocumentSource::GetNextResult(input.getDocument().clone());
+                full = c->appendDocument(copy, _maxBufferSize);
+            }
+
+            return full ? 0 : kInvalidThreadId;
+        }
+        case ExchangePolicyEnum::kRoundRobin: {
+            size_t target = _roundRobinCounter;
+            _roundRobinCounter = (_roundRobinCounter + 1) % _consumers.size();
 
-    return kInvalidThreadId;
+            return _consumers[target]->appendDocument(std::move(input), _maxBufferSize)
+                ? target
+                : kInvalidThreadId;
+        }
+        case ExchangePolicyEnum::kKeyRange: {
+            size_t target = getTargetConsumer(input.getDocument());
+            bool full = _consumers[target]->appendDocument(std::move(input), _maxBufferSize);
+            if (full && _orderPreserving) {
+                // TODO send the high watermark here.
+            }
+            return full ? target : kInvalidThreadId;
+        }
+        default:
+            MONGO_UNREACHABLE;
+    }
 }
 
 size_t Exchange::getTargetConsumer(const Document& input) {
@@ -45,6 +45,9 @@ class Exchange : public RefCountable {
     static constexpr size_t kInvalidThreadId{std::numeric_limits<size_t>::max()};
     static constexpr size_t kMaxBufferSize = 100 * 1024 * 1024;  // 100 MB
     static constexpr size_t kMaxNumberConsumers = 100;
+    // The most documents the loading thread reads from the input before taking the mutex to
+    // distribute them to the buffers.
+    static constexpr size_t kMaxLoadChunkSize = 64;
 
     /**
      * Convert the BSON representation of boundaries (as deserialized off the wire) to the internal
@@ -105,7 +108,18 @@ public:
     void unblockLoading(size_t consumerId);
 
 private:
-    size_t loadNextBatch();
+    /**
+     * Loads documents from the input into the consumer buffers until some buffer is full, and
+     * returns the id of its consumer, or kInvalidThreadId if the input is exhausted. Must be called
+     * with 'lk' held. The mutex is released while the input pipeline is running.
+     */
+    size_t loadNextBatch(stdx::unique_lock<Latch>& lk);
+
+    /**
+     * Appends 'input' to the buffer(s) chosen by the policy. Returns the id of a consumer whose
+     * buffer is now full, or kInvalidThreadId.
+     */
+    size_t appendToBuffers(DocumentSource::GetNextResult input);
 
     size_t getTargetConsumer(const Document& input);
 
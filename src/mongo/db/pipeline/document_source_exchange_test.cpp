@@ -31,6 +31,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <set>
+
 #include "mongo/db/hasher.h"
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
 #include "mongo/db/pipeline/document_source_exchange.h"
@@ -635,6 +637,65 @@ TEST_F(DocumentSourceExchangeTest, RangeRandomHashExchangeNConsumer) {
     ASSERT_EQ(nDocs, processedDocs.load());
 }
 
+TEST_F(DocumentSourceExchangeTest, HashExchangeSmallBufferKeepsKeysTogether) {
+    const size_t nDocs = 1000;
+    auto source = getRandomMockSource(nDocs, getNewSeed());
+
+    const std::vector<BSONObj> boundaries = {
+        BSON("a" << MINKEY),
+        BSON("a" << BSONElementHasher::hash64(BSON("" << 0).firstElement(),
+                                              BSONElementHasher::DEFAULT_HASH_SEED)),
+        BSON("a" << MAXKEY)};
+
+    const size_t nConsumers = boundaries.size() - 1;
+
+    // The buffers are smaller than a single document, so every batch loaded from the input
+    // overflows some consumer's buffer.
+    ExchangeSpec spec;
+    spec.setPolicy(ExchangePolicyEnum::kKeyRange);
+    spec.setKey(BSON("a"
+                     << "hashed"));
+    spec.setBoundaries(boundaries);
+    spec.setConsumers(nConsumers);
+    spec.setBufferSize(1);
+
+    boost::intrusive_ptr<Exchange> ex =
+        new Exchange(std::move(spec), Pipeline::create({source}, getExpCtx()));
+
+    std::vector<ThreadInfo> threads = createNProducers(nConsumers, ex);
+    std::vector<executor::TaskExecutor::CallbackHandle> handles;
+    std::vector<std::set<int>> keys(nConsumers);
+    AtomicWord<size_t> processedDocs{0};
+
+    for (size_t id = 0; id < nConsumers; ++id) {
+        auto docSourceExchange = threads[id].documentSourceExchange.get();
+        auto consumerKeys = &keys[id];
+        auto handle = _executor->scheduleWork([docSourceExchange, consumerKeys, &processedDocs](
+                                                  const executor::TaskExecutor::CallbackArgs& cb) {
+            auto input = docSourceExchange->getNext();
+
+            size_t docs = 0;
+            for (; input.isAdvanced(); input = docSourceExchange->getNext()) {
+                consumerKeys->insert(input.getDocument()["a"].getInt());
+                ++docs;
+            }
+            processedDocs.fetchAndAdd(docs);
+        });
+
+        handles.emplace_back(std::move(handle.getValue()));
+    }
+
+    for (auto& h : handles)
+        _executor->wait(h);
+
+    ASSERT_EQ(nDocs, processedDocs.load());
+
+    // Every value of the key was sent to exactly one consumer.
+    for (auto key : keys[0]) {
+        ASSERT_EQ(0u, keys[1].count(key));
+    }
+}
+
 TEST_F(DocumentSourceExchangeTest, RejectNoConsumers) {
     BSONObj spec = BSON("policy"
                         << "broadcast"
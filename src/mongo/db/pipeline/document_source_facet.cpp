@@ -38,6 +38,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/bsontypes.h"
+#include "mongo/db/client.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/pipeline/document_source_tee_consumer.h"
@@ -46,6 +47,8 @@
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/pipeline/tee_buffer.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/future.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -58,19 +61,50 @@ using std::vector;
 DocumentSourceFacet::DocumentSourceFacet(std::vector<FacetPipeline> facetPipelines,
                                          const intrusive_ptr<ExpressionContext>& expCtx,
                                          size_t bufferSizeBytes,
-                                         size_t maxOutputDocBytes)
+                                         size_t maxOutputDocBytes,
+                                         size_t maxWorkers)
     : DocumentSource(kStageName, expCtx),
       _teeBuffer(TeeBuffer::create(facetPipelines.size(), bufferSizeBytes)),
       _facets(std::move(facetPipelines)),
-      _maxOutputDocSizeBytes(maxOutputDocBytes) {
+      _maxOutputDocSizeBytes(maxOutputDocBytes),
+      _maxWorkers(maxWorkers) {
     for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
         auto& facet = _facets[facetId];
         facet.pipeline->addInitialSource(
-            DocumentSourceTeeConsumer::create(pExpCtx, facetId, _teeBuffer));
+            DocumentSourceTeeConsumer::create(facet.pipeline->getContext(), facetId, _teeBuffer));
     }
 }
 
 namespace {
+// The number of worker threads currently held by $facet stages, see reserveFacetWorkers().
+AtomicWord<int> reservedFacetWorkers{0};
+
+/**
+ * Reserves up to 'maxWorkers' of the 'internalQueryFacetWorkerPoolMaxThreads' worker threads
+ * which all $facet stages share, returning how many were reserved, or 0 if fewer than two are
+ * left. The threads are reserved before any is started, so that no worker waits for a thread while
+ * holding up the input of the others.
+ */
+size_t reserveFacetWorkers(size_t maxWorkers) {
+    auto reserved = reservedFacetWorkers.load();
+    int nWorkers;
+    do {
+        nWorkers = std::min(static_cast<int>(maxWorkers),
+                            internalQueryFacetWorkerPoolMaxThreads - reserved);
+        if (nWorkers < 2) {
+            return 0;
+        }
+    } while (!reservedFacetWorkers.compareAndSwap(&reserved, reserved + nWorkers));
+    return nWorkers;
+}
+
+void assertOutputUnderMemoryLimit(long long usedBytes, size_t maxBytes) {
+    uassert(4031700,
+            str::stream() << "document constructed by $facet is " << usedBytes
+                          << " bytes, which exceeds the limit of " << maxBytes << " bytes",
+            static_cast<size_t>(usedBytes) <= maxBytes);
+}
+
 /**
  * Extracts the names of the facets and the vectors of raw BSONObjs representing the stages within
  * that facet's pipeline.
@@ -129,9 +163,10 @@ intrusive_ptr<DocumentSourceFacet> DocumentSourceFacet::create(
     std::vector<FacetPipeline> facetPipelines,
     const intrusive_ptr<ExpressionContext>& expCtx,
     size_t bufferSizeBytes,
-    size_t maxOutputDocBytes) {
+    size_t maxOutputDocBytes,
+    size_t maxWorkers) {
     return new DocumentSourceFacet(
-        std::move(facetPipelines), expCtx, bufferSizeBytes, maxOutputDocBytes);
+        std::move(facetPipelines), expCtx, bufferSizeBytes, maxOutputDocBytes, maxWorkers);
 }
 
 void DocumentSourceFacet::setSource(DocumentSource* source) {
@@ -150,16 +185,27 @@ DocumentSource::GetNextResult DocumentSourceFacet::doGetNext() {
         return GetNextResult::makeEOF();
     }
 
-    const size_t maxBytes = _maxOutputDocSizeBytes;
-    auto ensureUnderMemoryLimit = [usedBytes = 0ul, &maxBytes](long long additional) mutable {
-        usedBytes += additional;
-        uassert(4031700,
-                str::stream() << "document constructed by $facet is " << usedBytes
-                              << " bytes, which exceeds the limit of " << maxBytes << " bytes",
-                usedBytes <= maxBytes);
-    };
-
     vector<vector<Value>> results(_facets.size());
+    const size_t nWorkers =
+        canRunConcurrently() ? reserveFacetWorkers(std::min(_facets.size(), _maxWorkers)) : 0;
+    if (nWorkers > 0) {
+        ON_BLOCK_EXIT([&] { reservedFacetWorkers.subtractAndFetch(nWorkers); });
+        runConcurrently(nWorkers, &results);
+    } else {
+        runSerially(&results);
+    }
+
+    MutableDocument resultDoc;
+    for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
+        resultDoc[_facets[facetId].name] = Value(std::move(results[facetId]));
+    }
+
+    _done = true;  // We will only ever produce one result.
+    return resultDoc.freeze();
+}
+
+void DocumentSourceFacet::runSerially(vector<vector<Value>>* results) {
+    long long usedBytes = 0;
     bool allPipelinesEOF = false;
     while (!allPipelinesEOF) {
         allPipelinesEOF = true;  // Set this to false if any pipeline isn't EOF.
@@ -167,20 +213,151 @@ DocumentSource::GetNextResult DocumentSourceFacet::doGetNext() {
             const auto& pipeline = _facets[facetId].pipeline;
             auto next = pipeline->getSources().back()->getNext();
             for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
-                ensureUnderMemoryLimit(next.getDocument().getApproximateSize());
-                results[facetId].emplace_back(next.releaseDocument());
+                usedBytes += next.getDocument().getApproximateSize();
+                assertOutputUnderMemoryLimit(usedBytes, _maxOutputDocSizeBytes);
+                (*results)[facetId].emplace_back(next.releaseDocument());
             }
             allPipelinesEOF = allPipelinesEOF && next.isEOF();
         }
     }
+}
 
-    MutableDocument resultDoc;
+bool DocumentSourceFacet::canRunConcurrently() const {
+    if (_maxWorkers < 2 || _facets.size() < 2) {
+        return false;
+    }
+
+    for (auto&& facet : _facets) {
+        // A sub-pipeline sharing our ExpressionContext would also share our OperationContext.
+        if (facet.pipeline->getContext() == pExpCtx) {
+            return false;
+        }
+
+        // Reading another collection requires the locks and read concern of this operation, so
+        // such sub-pipelines must run on this thread.
+        stdx::unordered_set<NamespaceString> involvedNamespaces;
+        for (auto&& source : facet.pipeline->getSources()) {
+            source->addInvolvedCollections(&involvedNamespaces);
+        }
+        if (!involvedNamespaces.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DocumentSourceFacet::runConcurrently(size_t nWorkers, vector<vector<Value>>* results) {
+    _teeBuffer->enableConcurrentConsumers();
+
+    // Assign the sub-pipelines to the workers round-robin. Each worker interleaves its
+    // sub-pipelines the same way runSerially() does, so that none of them holds up the others.
+    vector<vector<size_t>> facetIdsByWorker(nWorkers);
     for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
-        resultDoc[_facets[facetId].name] = Value(std::move(results[facetId]));
+        facetIdsByWorker[facetId % nWorkers].push_back(facetId);
     }
 
-    _done = true;  // We will only ever produce one result.
-    return resultDoc.freeze();
+    for (auto&& facet : _facets) {
+        facet.pipeline->detachFromOperationContext();
+    }
+
+    // Every worker gets a thread of its own, since the input is not loaded any further until all
+    // the workers have consumed it.
+    ThreadPool::Options options;
+    options.poolName = "FacetWorkerPool";
+    options.threadNamePrefix = "FacetWorker";
+    options.minThreads = nWorkers;
+    options.maxThreads = nWorkers;
+    options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
+    ThreadPool pool(options);
+    pool.startup();
+
+    AtomicWord<long long> usedBytes{0};
+    vector<Future<void>> workers;
+    auto joinWorkers = [&] {
+        Status firstError = Status::OK();
+        for (auto&& worker : workers) {
+            auto status = worker.getNoThrow();
+            if (firstError.isOK() && !status.isOK()) {
+                firstError = std::move(status);
+            }
+        }
+        pool.shutdown();
+        pool.join();
+        for (auto&& facet : _facets) {
+            facet.pipeline->reattachToOperationContext(pExpCtx->opCtx);
+        }
+        return firstError;
+    };
+
+    try {
+        for (auto&& facetIds : facetIdsByWorker) {
+            auto pf = makePromiseFuture<void>();
+            pool.schedule(
+                [this, &facetIds, results, &usedBytes, promise = std::move(pf.promise)](
+                    auto status) mutable {
+                    if (!status.isOK()) {
+                        _teeBuffer->cancel(status);
+                        promise.setError(status);
+                        return;
+                    }
+
+                    auto opCtx = cc().makeOperationContext();
+                    promise.setWith(
+                        [&] { runWorker(opCtx.get(), facetIds, results, &usedBytes); });
+                });
+            workers.push_back(std::move(pf.future));
+        }
+
+        // Feed the workers until they have all reached the end of their input, or one of them
+        // failed.
+        while (_teeBuffer->loadNextBatchForConcurrentConsumers(pExpCtx->opCtx)) {
+        }
+    } catch (const DBException& ex) {
+        // Make sure the workers are done with the sub-pipelines before unwinding.
+        _teeBuffer->cancel(ex.toStatus());
+        joinWorkers().ignore();
+        throw;
+    }
+    uassertStatusOK(joinWorkers());
+}
+
+void DocumentSourceFacet::runWorker(OperationContext* opCtx,
+                                    const vector<size_t>& facetIds,
+                                    vector<vector<Value>>* results,
+                                    AtomicWord<long long>* usedBytes) {
+    try {
+        for (auto facetId : facetIds) {
+            _facets[facetId].pipeline->reattachToOperationContext(opCtx);
+        }
+        ON_BLOCK_EXIT([&] {
+            for (auto facetId : facetIds) {
+                _facets[facetId].pipeline->detachFromOperationContext();
+            }
+        });
+
+        vector<size_t> remainingFacetIds = facetIds;
+        while (!remainingFacetIds.empty()) {
+            for (auto it = remainingFacetIds.begin(); it != remainingFacetIds.end();) {
+                const auto& pipeline = _facets[*it].pipeline;
+                auto next = pipeline->getSources().back()->getNext();
+                for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
+                    assertOutputUnderMemoryLimit(
+                        usedBytes->addAndFetch(next.getDocument().getApproximateSize()),
+                        _maxOutputDocSizeBytes);
+                    (*results)[*it].emplace_back(next.releaseDocument());
+                }
+                it = next.isEOF() ? remainingFacetIds.erase(it) : std::next(it);
+            }
+
+            if (!remainingFacetIds.empty()) {
+                _teeBuffer->waitForConcurrentInput(remainingFacetIds);
+            }
+        }
+    } catch (const DBException& ex) {
+        // Stop the other workers and the thread loading the input.
+        _teeBuffer->cancel(ex.toStatus());
+        throw;
+    }
 }
 
 Value DocumentSourceFacet::serialize(boost::optional<ExplainOptions::Verbosity> explain) const {
@@ -304,11 +481,19 @@ intrusive_ptr<DocumentSource> DocumentSourceFacet::createFromBson(
     boost::optional<std::string> needsMongoS;
     boost::optional<std::string> needsShard;
 
+    // If the sub-pipelines may run concurrently, give each one its own ExpressionContext, so that
+    // each can be attached to the OperationContext of the worker running it.
+    auto rawFacets = extractRawPipelines(elem);
+    const size_t maxWorkers = internalQueryFacetMaxWorkers.load();
+    const bool mayRunConcurrently = maxWorkers > 1 && rawFacets.size() > 1;
+
     std::vector<FacetPipeline> facetPipelines;
-    for (auto&& rawFacet : extractRawPipelines(elem)) {
+    for (auto&& rawFacet : rawFacets) {
         const auto facetName = rawFacet.first;
+        auto facetExpCtx =
+            mayRunConcurrently ? expCtx->copyWith(expCtx->ns, expCtx->uuid) : expCtx;
 
-        auto pipeline = Pipeline::parse(rawFacet.second, expCtx, [](const Pipeline& pipeline) {
+        auto pipeline = Pipeline::parse(rawFacet.second, facetExpCtx, [](const Pipeline& pipeline) {
             auto sources = pipeline.getSources();
             std::for_each(sources.begin(), sources.end(), [](auto& stage) {
                 auto stageConstraints = stage->constraints();
@@ -341,6 +526,10 @@ intrusive_ptr<DocumentSource> DocumentSourceFacet::createFromBson(
         facetPipelines.emplace_back(facetName, std::move(pipeline));
     }
 
-    return DocumentSourceFacet::create(std::move(facetPipelines), expCtx);
+    return DocumentSourceFacet::create(std::move(facetPipelines),
+                                       expCtx,
+                                       internalQueryFacetBufferSizeBytes.load(),
+                                       internalQueryFacetMaxOutputDocSizeBytes.load(),
+                                       mayRunConcurrently ? maxWorkers : 0);
 }
 }  // namespace mongo
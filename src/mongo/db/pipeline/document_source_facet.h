@@ -38,6 +38,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
 #include "mongo/db/pipeline/pipeline.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -55,6 +56,12 @@ class NamespaceString;
  * For example, {$facet: {facetA: [{$skip: 1}], facetB: [{$limit: 1}]}} would describe a $facet
  * stage which will produce a document like the following:
  * {facetA: [<all input documents except the first one>], facetB: [<the first document>]}.
+ *
+ * When 'internalQueryFacetMaxWorkers' allows it, the sub-pipelines are each given their own
+ * ExpressionContext, and those which do not read from other collections are run concurrently by
+ * workers on threads of their own, as many as 'internalQueryFacetWorkerPoolMaxThreads' leaves
+ * available. The input is still read on the calling thread, and the output is the same as when the
+ * sub-pipelines run one at a time.
  */
 class DocumentSourceFacet final : public DocumentSource {
 public:
@@ -91,11 +98,16 @@ public:
     static boost::intrusive_ptr<DocumentSource> createFromBson(
         BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
+    /**
+     * Sub-pipelines can only be run concurrently, by up to 'maxWorkers' workers, if each of them
+     * was parsed with its own copy of 'expCtx'.
+     */
     static boost::intrusive_ptr<DocumentSourceFacet> create(
         std::vector<FacetPipeline> facetPipelines,
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
         size_t bufferSizeBytes = internalQueryFacetBufferSizeBytes.load(),
-        size_t maxOutputDocBytes = internalQueryFacetMaxOutputDocSizeBytes.load());
+        size_t maxOutputDocBytes = internalQueryFacetMaxOutputDocSizeBytes.load(),
+        size_t maxWorkers = 0);
 
     /**
      * Optimizes inner pipelines.
@@ -153,7 +165,34 @@ private:
     DocumentSourceFacet(std::vector<FacetPipeline> facetPipelines,
                         const boost::intrusive_ptr<ExpressionContext>& expCtx,
                         size_t bufferSizeBytes,
-                        size_t maxOutputDocBytes);
+                        size_t maxOutputDocBytes,
+                        size_t maxWorkers);
+
+    /**
+     * Returns whether the sub-pipelines can be run on worker threads: there is more than one of
+     * them, each has its own ExpressionContext, and none of them reads from another collection.
+     */
+    bool canRunConcurrently() const;
+
+    /**
+     * Runs the sub-pipelines to completion, one at a time on the calling thread, appending their
+     * results to 'results'.
+     */
+    void runSerially(std::vector<std::vector<Value>>* results);
+
+    /**
+     * Runs the sub-pipelines to completion on 'nWorkers' workers, each on a thread of its own,
+     * while this thread loads their input, appending their results to 'results'.
+     */
+    void runConcurrently(size_t nWorkers, std::vector<std::vector<Value>>* results);
+
+    /**
+     * Drains the sub-pipelines in 'facetIds' on a worker thread, under 'opCtx'.
+     */
+    void runWorker(OperationContext* opCtx,
+                   const std::vector<size_t>& facetIds,
+                   std::vector<std::vector<Value>>* results,
+                   AtomicWord<long long>* usedBytes);
 
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
 
@@ -161,6 +200,7 @@ private:
     std::vector<FacetPipeline> _facets;
 
     const size_t _maxOutputDocSizeBytes;
+    const size_t _maxWorkers;
 
     bool _done = false;
 };
@@ -44,8 +44,10 @@
 #include "mongo/db/pipeline/document_source_limit.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_source_skip.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 using std::deque;
@@ -455,6 +457,103 @@ TEST_F(DocumentSourceFacetTest, ShouldBeAbleToEvaluateMultipleStagesWithinOneSub
     ASSERT_DOCUMENT_EQ(output.getDocument(), Document(fromjson("{subPipe: [{_id: 0}, {_id: 1}]}")));
 }
 
+/**
+ * Runs a $facet parsed from 'spec' over documents {_id: 0, x: 0} through {_id: 99, x: 99}, with
+ * 'maxWorkers' workers and a buffer small enough to hold only a few documents at a time.
+ */
+Document runFacetOverNumbers(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                             const BSONObj& spec,
+                             int maxWorkers,
+                             bool expectConcurrent) {
+    const auto originalMaxWorkers = internalQueryFacetMaxWorkers.load();
+    const auto originalBufferSize = internalQueryFacetBufferSizeBytes.load();
+    internalQueryFacetMaxWorkers.store(maxWorkers);
+    internalQueryFacetBufferSizeBytes.store(100);
+    ON_BLOCK_EXIT([&] {
+        internalQueryFacetMaxWorkers.store(originalMaxWorkers);
+        internalQueryFacetBufferSizeBytes.store(originalBufferSize);
+    });
+
+    auto facetStage = dynamic_cast<DocumentSourceFacet*>(
+        DocumentSourceFacet::createFromBson(spec.firstElement(), expCtx).get());
+    ASSERT(facetStage);
+    for (auto&& facet : facetStage->getFacetPipelines()) {
+        ASSERT_EQ(facet.pipeline->getContext() != expCtx, expectConcurrent);
+    }
+
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < 100; ++i) {
+        inputs.emplace_back(Document{{"_id", i}, {"x", i}});
+    }
+    auto mock = DocumentSourceMock::createForTest(std::move(inputs), expCtx);
+    facetStage->setSource(mock.get());
+
+    auto output = facetStage->getNext();
+    ASSERT(output.isAdvanced());
+    ASSERT(facetStage->getNext().isEOF());
+    return output.releaseDocument();
+}
+
+TEST_F(DocumentSourceFacetTest, ConcurrentSubPipelinesShouldProduceSameOutputAsSerialOnes) {
+    auto spec = fromjson(
+        "{$facet: {"
+        "  matched: [{$match: {x: {$gte: 90}}}],"
+        "  grouped: [{$group: {_id: {$mod: ['$x', 3]}, total: {$sum: '$x'}}}, {$sort: {_id: 1}}],"
+        "  limited: [{$limit: 3}],"
+        "  skipped: [{$skip: 97}],"
+        "  sorted: [{$sort: {x: -1}}, {$limit: 2}, {$project: {_id: 0, x: 1}}]"
+        "}}");
+
+    auto serialOutput = runFacetOverNumbers(getExpCtx(), spec, 0, false);
+    ASSERT_EQ(serialOutput["matched"].getArrayLength(), 10UL);
+    ASSERT_EQ(serialOutput["grouped"].getArrayLength(), 3UL);
+    ASSERT_EQ(serialOutput["limited"].getArrayLength(), 3UL);
+
+    // The same output is produced whether there are fewer, as many, or more workers than facets.
+    for (int maxWorkers : {2, 5, 8}) {
+        ASSERT_DOCUMENT_EQ(runFacetOverNumbers(getExpCtx(), spec, maxWorkers, true),
+                           serialOutput);
+    }
+}
+
+TEST_F(DocumentSourceFacetTest, ShouldRunWithFewerWorkerThreadsThanSubPipelines) {
+    const auto originalMaxThreads = internalQueryFacetWorkerPoolMaxThreads;
+    ON_BLOCK_EXIT([&] { internalQueryFacetWorkerPoolMaxThreads = originalMaxThreads; });
+
+    auto spec = fromjson(
+        "{$facet: {"
+        "  a: [{$match: {x: {$lt: 10}}}],"
+        "  b: [{$match: {x: {$gte: 90}}}],"
+        "  c: [{$limit: 3}],"
+        "  d: [{$skip: 97}],"
+        "  e: [{$group: {_id: null, n: {$sum: 1}}}]"
+        "}}");
+    auto serialOutput = runFacetOverNumbers(getExpCtx(), spec, 0, false);
+
+    // Two threads are shared by the five sub-pipelines, and with a single thread to spare the
+    // sub-pipelines run on the calling thread.
+    for (int maxThreads : {2, 1}) {
+        internalQueryFacetWorkerPoolMaxThreads = maxThreads;
+        ASSERT_DOCUMENT_EQ(runFacetOverNumbers(getExpCtx(), spec, 5, true), serialOutput);
+    }
+}
+
+TEST_F(DocumentSourceFacetTest, ShouldNotGiveSubPipelinesTheirOwnContextIfOnlyOneFacet) {
+    auto spec = fromjson("{$facet: {all: [{$match: {x: {$lt: 5}}}]}}");
+    auto output = runFacetOverNumbers(getExpCtx(), spec, 4, false);
+    ASSERT_EQ(output["all"].getArrayLength(), 5UL);
+}
+
+TEST_F(DocumentSourceFacetTest, ShouldSurfaceErrorFromConcurrentSubPipeline) {
+    const auto originalMaxOutputSize = internalQueryFacetMaxOutputDocSizeBytes.load();
+    internalQueryFacetMaxOutputDocSizeBytes.store(1000);
+    ON_BLOCK_EXIT([&] { internalQueryFacetMaxOutputDocSizeBytes.store(originalMaxOutputSize); });
+
+    auto spec = fromjson("{$facet: {few: [{$limit: 1}], all: [{$match: {}}]}}");
+    ASSERT_THROWS_CODE(
+        runFacetOverNumbers(getExpCtx(), spec, 2, true), AssertionException, 4031700);
+}
+
 TEST_F(DocumentSourceFacetTest, ShouldPropagateDisposeThroughToSource) {
     auto ctx = getExpCtx();
 
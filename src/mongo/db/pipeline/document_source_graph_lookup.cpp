@@ -31,6 +31,7 @@
 
 #include "mongo/db/pipeline/document_source_graph_lookup.h"
 
+#include <boost/filesystem/operations.hpp>
 #include <memory>
 
 #include "mongo/base/init.h"
@@ -44,6 +45,7 @@
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/util/destructor_guard.h"
 
 namespace mongo {
 
@@ -51,6 +53,41 @@ namespace {
 bool foreignShardedLookupAllowed() {
     return getTestCommandsEnabled() && internalQueryAllowShardedLookup.load();
 }
+
+/**
+ * Generates a new file name on each call using a static, atomic and monotonically increasing
+ * number. See the comment on the equivalent function in document_source_group.cpp.
+ */
+std::string nextFileName() {
+    static AtomicWord<unsigned> documentSourceGraphLookUpFileCounter;
+    return "extsort-doc-graph-lookup." +
+        std::to_string(documentSourceGraphLookUpFileCounter.fetchAndAdd(1));
+}
+
+/**
+ * Orders spilled frontier values using the collation, so that duplicates are adjacent once the
+ * spilled ranges are merged.
+ */
+class SpilledFrontierComparator {
+public:
+    SpilledFrontierComparator(ValueComparator valueComparator)
+        : _valueComparator(valueComparator) {}
+
+    int operator()(const std::pair<Value, NullValue>& lhs,
+                   const std::pair<Value, NullValue>& rhs) const {
+        return _valueComparator.compare(lhs.first, rhs.first);
+    }
+
+private:
+    ValueComparator _valueComparator;
+};
+
+void removeSpillFile(const std::string& fileName) {
+    if (!fileName.empty()) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(fileName, ec);
+    }
+}
 }  // namespace
 
 using boost::intrusive_ptr;
@@ -106,11 +143,9 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::doGetNext() {
     performSearch();
 
     std::vector<Value> results;
-    while (!_visited.empty()) {
+    while (hasVisitedDocuments()) {
         // Remove elements one at a time to avoid consuming more memory.
-        auto it = _visited.begin();
-        results.push_back(Value(it->second));
-        _visited.erase(it);
+        results.push_back(Value(popVisitedDocument()));
     }
 
     MutableDocument output(*_input);
@@ -129,7 +164,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
     // If the unwind is not preserving empty arrays, we might have to process multiple inputs before
     // we get one that will produce an output.
     while (true) {
-        if (_visited.empty()) {
+        if (!hasVisitedDocuments()) {
             // No results are left for the current input, so we should move on to the next one and
             // perform a new search.
 
@@ -145,7 +180,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
         }
         MutableDocument unwound(*_input);
 
-        if (_visited.empty()) {
+        if (!hasVisitedDocuments()) {
             if ((*_unwind)->preserveNullAndEmptyArrays()) {
                 // Since "preserveNullAndEmptyArrays" was specified, output a document even though
                 // we had no result.
@@ -159,13 +194,11 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
                 continue;
             }
         } else {
-            auto it = _visited.begin();
-            unwound.setNestedField(_as, Value(it->second));
+            unwound.setNestedField(_as, Value(popVisitedDocument()));
             if (indexPath) {
                 unwound.setNestedField(*indexPath, Value(_outputIndex));
                 ++_outputIndex;
             }
-            _visited.erase(it);
         }
 
         return unwound.freeze();
@@ -176,61 +209,79 @@ void DocumentSourceGraphLookUp::doDispose() {
     _cache.clear();
     _frontier.clear();
     _visited.clear();
+    clearSpilledVisited();
+    clearSpilledFrontier();
+}
+
+DocumentSourceGraphLookUp::~DocumentSourceGraphLookUp() {
+    DESTRUCTOR_GUARD(clearSpilledVisited());
+    DESTRUCTOR_GUARD(clearSpilledFrontier());
+}
+
+bool DocumentSourceGraphLookUp::hasVisitedDocuments() {
+    if (!_visited.empty()) {
+        return true;
+    }
+
+    // Read back whatever was spilled to disk, one range at a time.
+    while (!_spilledVisitedReader || !_spilledVisitedReader->more()) {
+        if (_spilledVisitedReader) {
+            _spilledVisitedReader->closeSource();
+            _spilledVisitedReader.reset();
+        }
+
+        if (_spilledVisited.empty()) {
+            clearSpilledVisited();
+            return false;
+        }
+
+        _spilledVisitedReader = std::move(_spilledVisited.back());
+        _spilledVisited.pop_back();
+        _spilledVisitedReader->openSource();
+    }
+    return true;
+}
+
+Document DocumentSourceGraphLookUp::popVisitedDocument() {
+    if (!_visited.empty()) {
+        auto it = _visited.begin();
+        auto doc = std::move(it->second);
+        _visited.erase(it);
+        return doc;
+    }
+
+    // The caller must have checked hasVisitedDocuments(), which opens the next spilled range.
+    invariant(_spilledVisitedReader && _spilledVisitedReader->more());
+    return _spilledVisitedReader->next().second;
 }
 
 void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
     long long depth = 0;
     bool shouldPerformAnotherQuery;
     do {
-        if (!foreignShardedLookupAllowed()) {
-            // Enforce that the foreign collection must be unsharded for $graphLookup.
-            _fromExpCtx->mongoProcessInterface->setExpectedShardVersion(
-                _fromExpCtx->opCtx, _fromExpCtx->ns, ChunkVersion::UNSHARDED());
-        }
         shouldPerformAnotherQuery = false;
 
-        // Check whether each key in the frontier exists in the cache or needs to be queried.
-        auto cached = pExpCtx->getDocumentComparator().makeUnorderedDocumentSet();
-        auto matchStage = makeMatchStageFromFrontier(&cached);
+        // Take ownership of the frontier built by the previous wave, so that '_frontier' can be
+        // populated for the next one. If part of it was spilled to disk, spill the rest as well so
+        // that it can all be read back as a single de-duplicated stream.
+        std::unique_ptr<SpilledFrontierIterator> spilledWave;
+        if (!_spilledFrontier.empty()) {
+            if (!_frontier.empty()) {
+                spillFrontier();
+            }
+            spilledWave = takeSpilledFrontier();
+        }
 
-        ValueUnorderedSet queried = pExpCtx->getValueComparator().makeUnorderedValueSet();
-        _frontier.swap(queried);
+        ValueUnorderedSet wave = pExpCtx->getValueComparator().makeUnorderedValueSet();
+        _frontier.swap(wave);
         _frontierUsageBytes = 0;
 
-        // Process cached values, populating '_frontier' for the next iteration of search.
-        while (!cached.empty()) {
-            auto doc = *cached.begin();
-            cached.erase(cached.begin());
+        // Search for the values in the frontier in batches, so that the queries stay within the
+        // BSON size limit however large the frontier grows.
+        ValueUnorderedSet frontierBatch = pExpCtx->getValueComparator().makeUnorderedValueSet();
+        while (fillFrontierBatch(&wave, spilledWave.get(), &frontierBatch)) {
             shouldPerformAnotherQuery =
-                addToVisitedAndFrontier(std::move(doc), depth) || shouldPerformAnotherQuery;
-            checkMemoryUsage();
-        }
-
-        if (matchStage) {
-            // Query for all keys that were in the frontier and not in the cache, populating
-            // '_frontier' for the next iteration of search.
-
-            // We've already allocated space for the trailing $match stage in '_fromPipeline'.
-            _fromPipeline.back() = *matchStage;
-            MakePipelineOptions pipelineOpts;
-            pipelineOpts.optimize = true;
-            pipelineOpts.attachCursorSource = true;
-            // By default, $graphLookup doesn't support a sharded 'from' collection.
-            pipelineOpts.allowTargetingShards = internalQueryAllowShardedLookup.load();
-            _variables.copyToExpCtx(_variablesParseState, _fromExpCtx.get());
-            auto pipeline = Pipeline::makePipeline(_fromPipeline, _fromExpCtx, pipelineOpts);
-            while (auto next = pipeline->getNext()) {
-                uassert(40271,
-                        str::stream()
-                            << "Documents in the '" << _from.ns()
-                            << "' namespace must contain an _id for de-duplication in $graphLookup",
-                        !(*next)["_id"].missing());
-
-                shouldPerformAnotherQuery =
-                    addToVisitedAndFrontier(*next, depth) || shouldPerformAnotherQuery;
-                addToCache(std::move(*next), queried);
-            }
-            checkMemoryUsage();
+                searchFrontierBatch(&frontierBatch, depth) || shouldPerformAnotherQuery;
         }
 
         ++depth;
@@ -239,12 +290,100 @@ void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
 
     _frontier.clear();
     _frontierUsageBytes = 0;
+    clearSpilledFrontier();
+}
+
+bool DocumentSourceGraphLookUp::fillFrontierBatch(ValueUnorderedSet* wave,
+                                                  SpilledFrontierIterator* spilledWave,
+                                                  ValueUnorderedSet* frontierBatch) {
+    frontierBatch->clear();
+
+    const size_t maxBatchBytes = internalDocumentSourceGraphLookupFrontierBatchSizeBytes.load();
+    size_t batchBytes = 0;
+    while (batchBytes < maxBatchBytes) {
+        Value value;
+        if (!wave->empty()) {
+            auto it = wave->begin();
+            value = *it;
+            wave->erase(it);
+        } else if (spilledWave && spilledWave->more()) {
+            // Duplicates are adjacent in the merged stream, so at most one copy of a value is
+            // searched for in each batch.
+            value = spilledWave->next().first;
+        } else {
+            break;
+        }
+
+        if (frontierBatch->insert(value).second) {
+            batchBytes += value.getApproximateSize();
+        }
+    }
+
+    return !frontierBatch->empty();
+}
+
+bool DocumentSourceGraphLookUp::searchFrontierBatch(ValueUnorderedSet* frontierBatch,
+                                                    long long depth) {
+    bool shouldPerformAnotherQuery = false;
+
+    // Check whether each key in the frontier exists in the cache or needs to be queried.
+    auto cached = pExpCtx->getDocumentComparator().makeUnorderedDocumentSet();
+    auto matchStage = makeMatchStageFromFrontier(frontierBatch, &cached);
+
+    // Process cached values, populating '_frontier' for the next iteration of search.
+    while (!cached.empty()) {
+        auto doc = *cached.begin();
+        cached.erase(cached.begin());
+        shouldPerformAnotherQuery =
+            addToVisitedAndFrontier(std::move(doc), depth) || shouldPerformAnotherQuery;
+        checkMemoryUsage();
+    }
+
+    if (matchStage) {
+        // Query for all keys that were in the frontier and not in the cache, populating
+        // '_frontier' for the next iteration of search.
+        if (!foreignShardedLookupAllowed()) {
+            // Enforce that the foreign collection must be unsharded for $graphLookup.
+            _fromExpCtx->mongoProcessInterface->setExpectedShardVersion(
+                _fromExpCtx->opCtx, _fromExpCtx->ns, ChunkVersion::UNSHARDED());
+        }
+
+        // We've already allocated space for the trailing $match stage in '_fromPipeline'.
+        _fromPipeline.back() = *matchStage;
+        MakePipelineOptions pipelineOpts;
+        pipelineOpts.optimize = true;
+        pipelineOpts.attachCursorSource = true;
+        // By default, $graphLookup doesn't support a sharded 'from' collection.
+        pipelineOpts.allowTargetingShards = internalQueryAllowShardedLookup.load();
+        _variables.copyToExpCtx(_variablesParseState, _fromExpCtx.get());
+        auto pipeline = Pipeline::makePipeline(_fromPipeline, _fromExpCtx, pipelineOpts);
+        ++_stats.numQueries;
+        while (auto next = pipeline->getNext()) {
+            uassert(40271,
+                    str::stream()
+                        << "Documents in the '" << _from.ns()
+                        << "' namespace must contain an _id for de-duplication in $graphLookup",
+                    !(*next)["_id"].missing());
+
+            shouldPerformAnotherQuery =
+                addToVisitedAndFrontier(*next, depth) || shouldPerformAnotherQuery;
+            addToCache(std::move(*next), *frontierBatch);
+            checkMemoryUsage();
+        }
+    }
+
+    return shouldPerformAnotherQuery;
+}
+
+bool DocumentSourceGraphLookUp::isVisited(const Value& id) const {
+    return _visited.find(id) != _visited.end() ||
+        _spilledVisitedIds.find(id) != _spilledVisitedIds.end();
 }
 
 bool DocumentSourceGraphLookUp::addToVisitedAndFrontier(Document result, long long depth) {
     auto id = result.getField("_id");
 
-    if (_visited.find(id) != _visited.end()) {
+    if (isVisited(id)) {
         // We've already seen this object, don't repeat any work.
         return false;
     }
@@ -292,18 +431,12 @@ void DocumentSourceGraphLookUp::addToCache(const Document& result,
 }
 
 boost::optional<BSONObj> DocumentSourceGraphLookUp::makeMatchStageFromFrontier(
-    DocumentUnorderedSet* cached) {
-    // Add any cached values to 'cached' and remove them from '_frontier'.
-    for (auto it = _frontier.begin(); it != _frontier.end();) {
+    ValueUnorderedSet* frontierBatch, DocumentUnorderedSet* cached) {
+    // Add any cached values to 'cached' and remove them from 'frontierBatch'.
+    for (auto it = frontierBatch->begin(); it != frontierBatch->end();) {
         if (auto entry = _cache[*it]) {
             cached->insert(entry->begin(), entry->end());
-            size_t valueSize = it->getApproximateSize();
-            _frontier.erase(it++);
-
-            // If the cached value increased in size while in the cache, we don't want to underflow
-            // '_frontierUsageBytes'.
-            invariant(valueSize <= _frontierUsageBytes);
-            _frontierUsageBytes -= valueSize;
+            frontierBatch->erase(it++);
         } else {
             ++it;
         }
@@ -328,7 +461,7 @@ boost::optional<BSONObj> DocumentSourceGraphLookUp::makeMatchStageFromFrontier(
                     BSONObjBuilder subObj(connectToObj.subobjStart(_connectToField.fullPath()));
                     {
                         BSONArrayBuilder in(subObj.subarrayStart("$in"));
-                        for (auto&& value : _frontier) {
+                        for (auto&& value : *frontierBatch) {
                             in << value;
                         }
                     }
@@ -337,7 +470,7 @@ boost::optional<BSONObj> DocumentSourceGraphLookUp::makeMatchStageFromFrontier(
         }
     }
 
-    return _frontier.empty() ? boost::none : boost::optional<BSONObj>(match.obj());
+    return frontierBatch->empty() ? boost::none : boost::optional<BSONObj>(match.obj());
 }
 
 void DocumentSourceGraphLookUp::performSearch() {
@@ -403,11 +536,105 @@ Pipeline::SourceContainer::iterator DocumentSourceGraphLookUp::doOptimizeAt(
 }
 
 void DocumentSourceGraphLookUp::checkMemoryUsage() {
-    // TODO SERVER-23980: Implement spilling to disk if allowDiskUse is specified.
+    auto memoryUsageBytes = [&] {
+        return _visitedUsageBytes + _frontierUsageBytes + _spilledVisitedIdsUsageBytes;
+    };
+
+    if (memoryUsageBytes() >= _maxMemoryUsageBytes && pExpCtx->allowDiskUse &&
+        !pExpCtx->inMongos) {
+        if (!_visited.empty()) {
+            spillVisited();
+        }
+        if (!_frontier.empty()) {
+            spillFrontier();
+        }
+    }
+
+    // The '_id' values of the spilled visited documents are kept in memory, so the search can
+    // still run out of memory if it visits enough documents.
     uassert(40099,
             "$graphLookup reached maximum memory consumption",
-            (_visitedUsageBytes + _frontierUsageBytes) < _maxMemoryUsageBytes);
-    _cache.evictDownTo(_maxMemoryUsageBytes - _frontierUsageBytes - _visitedUsageBytes);
+            memoryUsageBytes() < _maxMemoryUsageBytes);
+    _cache.evictDownTo(_maxMemoryUsageBytes - memoryUsageBytes());
+}
+
+void DocumentSourceGraphLookUp::spillVisited() {
+    if (_visitedFileName.empty()) {
+        _visitedFileName = pExpCtx->tempDir + "/" + nextFileName();
+    }
+
+    SortedFileWriter<Value, Document> writer(
+        SortOptions().TempDir(pExpCtx->tempDir), _visitedFileName, _nextVisitedFileOffset);
+    for (auto&& [id, doc] : _visited) {
+        writer.addAlreadySorted(id, doc);
+        _spilledVisitedIdsUsageBytes += id.getApproximateSize();
+        _spilledVisitedIds.insert(id);
+    }
+    _spilledVisited.emplace_back(writer.done());
+    _nextVisitedFileOffset = writer.getFileEndOffset();
+
+    ++_stats.numVisitedSpills;
+    _stats.numVisitedDocumentsSpilled += _visited.size();
+
+    _visited.clear();
+    _visitedUsageBytes = 0;
+}
+
+void DocumentSourceGraphLookUp::spillFrontier() {
+    std::vector<Value> values(_frontier.begin(), _frontier.end());
+    std::sort(values.begin(), values.end(), pExpCtx->getValueComparator().getLessThan());
+
+    if (_frontierFileName.empty()) {
+        _frontierFileName = pExpCtx->tempDir + "/" + nextFileName();
+    }
+
+    SortedFileWriter<Value, NullValue> writer(
+        SortOptions().TempDir(pExpCtx->tempDir), _frontierFileName, _nextFrontierFileOffset);
+    for (auto&& value : values) {
+        writer.addAlreadySorted(value, NullValue());
+    }
+    _spilledFrontier.emplace_back(writer.done());
+    _nextFrontierFileOffset = writer.getFileEndOffset();
+
+    ++_stats.numFrontierSpills;
+    _stats.numFrontierValuesSpilled += values.size();
+
+    _frontier.clear();
+    _frontierUsageBytes = 0;
+}
+
+std::unique_ptr<DocumentSourceGraphLookUp::SpilledFrontierIterator>
+DocumentSourceGraphLookUp::takeSpilledFrontier() {
+    // The merged iterator deletes the file once it is destroyed, so any values spilled from here
+    // on must go to a new file.
+    std::unique_ptr<SpilledFrontierIterator> merged(
+        SpilledFrontierIterator::merge(_spilledFrontier,
+                                       _frontierFileName,
+                                       SortOptions(),
+                                       SpilledFrontierComparator(pExpCtx->getValueComparator())));
+    _spilledFrontier.clear();
+    _frontierFileName.clear();
+    _nextFrontierFileOffset = 0;
+    return merged;
+}
+
+void DocumentSourceGraphLookUp::clearSpilledVisited() {
+    _spilledVisitedReader.reset();
+    _spilledVisited.clear();
+    _spilledVisitedIds.clear();
+    _spilledVisitedIdsUsageBytes = 0;
+
+    removeSpillFile(_visitedFileName);
+    _visitedFileName.clear();
+    _nextVisitedFileOffset = 0;
+}
+
+void DocumentSourceGraphLookUp::clearSpilledFrontier() {
+    _spilledFrontier.clear();
+
+    removeSpillFile(_frontierFileName);
+    _frontierFileName.clear();
+    _nextFrontierFileOffset = 0;
 }
 
 void DocumentSourceGraphLookUp::serializeToArray(
@@ -431,6 +658,20 @@ void DocumentSourceGraphLookUp::serializeToArray(
         spec["restrictSearchWithMatch"] = Value(*_additionalFilter);
     }
 
+    if (explain && *explain >= ExplainOptions::Verbosity::kExecStats) {
+        spec["searchStats"] =
+            Value(DOC("numQueries" << static_cast<long long>(_stats.numQueries) << "usedDisk"
+                                   << (_stats.numVisitedSpills > 0 || _stats.numFrontierSpills > 0)
+                                   << "numVisitedSpills"
+                                   << static_cast<long long>(_stats.numVisitedSpills)
+                                   << "numVisitedDocumentsSpilled"
+                                   << static_cast<long long>(_stats.numVisitedDocumentsSpilled)
+                                   << "numFrontierSpills"
+                                   << static_cast<long long>(_stats.numFrontierSpills)
+                                   << "numFrontierValuesSpilled"
+                                   << static_cast<long long>(_stats.numFrontierValuesSpilled)));
+    }
+
     // If we are explaining, include an absorbed $unwind inside the $graphLookup specification.
     if (_unwind && explain) {
         const boost::optional<FieldPath> indexPath = (*_unwind)->indexPath();
@@ -477,8 +718,10 @@ DocumentSourceGraphLookUp::DocumentSourceGraphLookUp(
       _additionalFilter(additionalFilter),
       _depthField(depthField),
       _maxDepth(maxDepth),
+      _maxMemoryUsageBytes(internalDocumentSourceGraphLookupMaxMemoryBytes.load()),
       _frontier(pExpCtx->getValueComparator().makeUnorderedValueSet()),
       _visited(ValueComparator::kInstance.makeUnorderedValueMap<Document>()),
+      _spilledVisitedIds(ValueComparator::kInstance.makeUnorderedValueSet()),
       _cache(pExpCtx->getValueComparator()),
       _unwind(unwindSrc),
       _variables(expCtx->variables),
@@ -626,3 +869,6 @@ void DocumentSourceGraphLookUp::addInvolvedCollections(
     }
 }
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
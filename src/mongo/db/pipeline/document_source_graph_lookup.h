@@ -34,6 +34,7 @@
 #include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
+#include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
 
@@ -95,7 +96,7 @@ public:
         StageConstraints constraints(StreamType::kStreaming,
                                      PositionRequirement::kNone,
                                      HostTypeRequirement::kPrimaryShard,
-                                     DiskUseRequirement::kNoDiskUse,
+                                     DiskUseRequirement::kWritesTmpData,
                                      FacetRequirement::kAllowed,
                                      TransactionRequirement::kAllowed,
                                      LookupRequirement::kAllowed,
@@ -121,6 +122,12 @@ public:
 
     void reattachToOperationContext(OperationContext* opCtx) final;
 
+    bool usedDisk() final {
+        return _stats.numVisitedSpills > 0 || _stats.numFrontierSpills > 0;
+    }
+
+    ~DocumentSourceGraphLookUp();
+
     static boost::intrusive_ptr<DocumentSourceGraphLookUp> create(
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
         NamespaceString fromNs,
@@ -147,6 +154,25 @@ protected:
                                                      Pipeline::SourceContainer* container) final;
 
 private:
+    /**
+     * Statistics about the searches performed by this stage, reported by explain.
+     */
+    struct SearchStats {
+        // The total number of queries issued against the 'from' collection.
+        size_t numQueries = 0;
+
+        // The number of times the visited documents and the frontier were written to disk.
+        size_t numVisitedSpills = 0;
+        size_t numFrontierSpills = 0;
+
+        // The total number of visited documents and frontier values written to disk.
+        size_t numVisitedDocumentsSpilled = 0;
+        size_t numFrontierValuesSpilled = 0;
+    };
+
+    using SpilledVisitedIterator = Sorter<Value, Document>::Iterator;
+    using SpilledFrontierIterator = Sorter<Value, NullValue>::Iterator;
+
     DocumentSourceGraphLookUp(
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
         NamespaceString from,
@@ -166,14 +192,16 @@ private:
 
     /**
      * Prepares the query to execute on the 'from' collection wrapped in a $match by using the
-     * contents of '_frontier'.
+     * contents of 'frontierBatch'.
      *
-     * Fills 'cached' with any values that were retrieved from the cache.
+     * Fills 'cached' with any values that were retrieved from the cache, and removes the
+     * corresponding values from 'frontierBatch'.
      *
      * Returns boost::none if no query is necessary, i.e., all values were retrieved from the cache.
      * Otherwise, returns a query object.
      */
-    boost::optional<BSONObj> makeMatchStageFromFrontier(DocumentUnorderedSet* cached);
+    boost::optional<BSONObj> makeMatchStageFromFrontier(ValueUnorderedSet* frontierBatch,
+                                                        DocumentUnorderedSet* cached);
 
     /**
      * If we have internalized a $unwind, getNext() dispatches to this function.
@@ -182,11 +210,39 @@ private:
 
     /**
      * Perform a breadth-first search of the 'from' collection. '_frontier' should already be
-     * populated with the values for the initial query. Populates '_discovered' with the result(s)
+     * populated with the values for the initial query. Populates '_visited' with the result(s)
      * of the query.
      */
     void doBreadthFirstSearch();
 
+    /**
+     * Moves distinct values from the frontier of the current wave, held in 'wave' and
+     * 'spilledWave', into 'frontierBatch' until it holds
+     * 'internalDocumentSourceGraphLookupFrontierBatchSizeBytes' worth of values. Returns false if
+     * the frontier of the current wave has been exhausted.
+     */
+    bool fillFrontierBatch(ValueUnorderedSet* wave,
+                           SpilledFrontierIterator* spilledWave,
+                           ValueUnorderedSet* frontierBatch);
+
+    /**
+     * Queries the 'from' collection for the values in 'frontierBatch', which are at the given
+     * 'depth' of the search. Returns whether any new documents were visited, and thus, whether the
+     * search should recurse.
+     */
+    bool searchFrontierBatch(ValueUnorderedSet* frontierBatch, long long depth);
+
+    /**
+     * Returns whether there are visited documents left to be output for the current input.
+     */
+    bool hasVisitedDocuments();
+
+    /**
+     * Removes and returns one of the visited documents for the current input, reading it back from
+     * disk if it was spilled.
+     */
+    Document popVisitedDocument();
+
     /**
      * Populates '_frontier' with the '_startWith' value(s) from '_input' and then performs a
      * breadth-first search. Caller should check that _input is not boost::none.
@@ -200,11 +256,43 @@ private:
     void addToCache(const Document& result, const ValueUnorderedSet& queried);
 
     /**
-     * Assert that '_visited' and '_frontier' have not exceeded the maximum meory usage, and then
-     * evict from '_cache' until this source is using less than '_maxMemoryUsageBytes'.
+     * Assert that '_visited' and '_frontier' have not exceeded the maximum memory usage, spilling
+     * them to disk first if allowed, and then evict from '_cache' until this source is using less
+     * than '_maxMemoryUsageBytes'.
      */
     void checkMemoryUsage();
 
+    /**
+     * Writes the documents in '_visited' to disk, keeping only their '_id' values in memory.
+     */
+    void spillVisited();
+
+    /**
+     * Writes the values in '_frontier' to disk, sorted using the collation.
+     */
+    void spillFrontier();
+
+    /**
+     * Merges the frontier values which were spilled to disk into a single sorted stream, which
+     * takes ownership of the spilled data.
+     */
+    std::unique_ptr<SpilledFrontierIterator> takeSpilledFrontier();
+
+    /**
+     * Discards any visited documents which were spilled to disk for the current input.
+     */
+    void clearSpilledVisited();
+
+    /**
+     * Discards any frontier values which were spilled to disk.
+     */
+    void clearSpilledFrontier();
+
+    /**
+     * Returns whether a document with the given '_id' value has already been visited.
+     */
+    bool isVisited(const Value& id) const;
+
     /**
      * Process 'result', adding it to '_visited' with the given 'depth', and updating '_frontier'
      * with the object's 'connectTo' values.
@@ -230,11 +318,12 @@ private:
     // The aggregation pipeline to perform against the '_from' namespace.
     std::vector<BSONObj> _fromPipeline;
 
-    size_t _maxMemoryUsageBytes = 100 * 1024 * 1024;
+    size_t _maxMemoryUsageBytes;
 
     // Track memory usage to ensure we don't exceed '_maxMemoryUsageBytes'.
     size_t _visitedUsageBytes = 0;
     size_t _frontierUsageBytes = 0;
+    size_t _spilledVisitedIdsUsageBytes = 0;
 
     // Only used during the breadth-first search, tracks the set of values on the current frontier.
     ValueUnorderedSet _frontier;
@@ -244,6 +333,26 @@ private:
     // using the simple collation.
     ValueUnorderedMap<Document> _visited;
 
+    // Only populated when spilling to disk. Each iterator covers a range of '_visitedFileName'
+    // holding documents which were moved out of '_visited', keyed by '_id'. The '_id' values of
+    // those documents are kept in '_spilledVisitedIds', so that they are not visited again.
+    std::vector<std::shared_ptr<SpilledVisitedIterator>> _spilledVisited;
+    ValueUnorderedSet _spilledVisitedIds;
+    std::string _visitedFileName;
+    std::streampos _nextVisitedFileOffset = 0;
+
+    // The spilled iterator which is currently being read by popVisitedDocument(), if any.
+    std::shared_ptr<SpilledVisitedIterator> _spilledVisitedReader;
+
+    // Only populated when spilling to disk. Each iterator covers a range of '_frontierFileName'
+    // holding values which were moved out of '_frontier', sorted using the collation. Every wave
+    // of the search spills into a new file, since merging the iterators deletes their file.
+    std::vector<std::shared_ptr<SpilledFrontierIterator>> _spilledFrontier;
+    std::string _frontierFileName;
+    std::streampos _nextFrontierFileOffset = 0;
+
+    SearchStats _stats;
+
     // Caches query results to avoid repeating any work. This structure is maintained across calls
     // to getNext().
     LookupSetCache _cache;
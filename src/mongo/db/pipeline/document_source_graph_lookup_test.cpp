@@ -38,8 +38,11 @@
 #include "mongo/db/pipeline/document_source_graph_lookup.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/process_interface/stub_mongo_process_interface.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -613,5 +616,140 @@ TEST_F(DocumentSourceGraphLookUpTest, ShouldNotExpandArraysWithinArraysAtEndOfCo
     ASSERT(graphLookupStage->getNext().isEOF());
 }
 
+/**
+ * Creates a $graphLookup over a chain of 'numNodes' documents, each of which connects to the next,
+ * using a memory limit that is too small to hold all of the visited documents and a frontier
+ * batch size that results in one query per frontier value.
+ */
+boost::intrusive_ptr<DocumentSourceGraphLookUp> makeGraphLookupOverChain(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx, int numNodes) {
+    std::deque<DocumentSource::GetNextResult> fromContents;
+    for (int i = 0; i < numNodes; ++i) {
+        fromContents.push_back(Document{{"_id", i}, {"to", i}, {"from", i + 1}});
+    }
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+    expCtx->mongoProcessInterface = std::make_shared<MockMongoInterface>(std::move(fromContents));
+    return DocumentSourceGraphLookUp::create(
+        expCtx,
+        fromNs,
+        "results",
+        "from",
+        "to",
+        ExpressionFieldPath::deprecatedCreate(expCtx.get(), "_id"),
+        boost::none,
+        boost::none,
+        boost::none,
+        boost::none);
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldSpillToDiskWhenMemoryLimitIsReached) {
+    const auto oldMaxMemoryBytes = internalDocumentSourceGraphLookupMaxMemoryBytes.load();
+    const auto oldBatchSizeBytes = internalDocumentSourceGraphLookupFrontierBatchSizeBytes.load();
+    ON_BLOCK_EXIT([&] {
+        internalDocumentSourceGraphLookupMaxMemoryBytes.store(oldMaxMemoryBytes);
+        internalDocumentSourceGraphLookupFrontierBatchSizeBytes.store(oldBatchSizeBytes);
+    });
+    internalDocumentSourceGraphLookupMaxMemoryBytes.store(16 * 1024);
+    internalDocumentSourceGraphLookupFrontierBatchSizeBytes.store(1);
+
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    const int numNodes = 300;
+    auto graphLookupStage = makeGraphLookupOverChain(expCtx, numNodes);
+    auto inputMock =
+        DocumentSourceMock::createForTest({Document{{"_id", 0}}, Document{{"_id", 1}}}, expCtx);
+    graphLookupStage->setSource(inputMock.get());
+
+    // The mock returns every document for each query, so each input visits the whole chain.
+    for (int input = 0; input < 2; ++input) {
+        auto next = graphLookupStage->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_VALUE_EQ(Value(input), next.getDocument().getField("_id"));
+
+        auto results = next.getDocument().getField("results");
+        ASSERT(results.isArray());
+        std::vector<int> ids;
+        for (auto&& result : results.getArray()) {
+            ids.push_back(result.getDocument().getField("_id").getInt());
+        }
+        std::sort(ids.begin(), ids.end());
+        ASSERT_EQ(ids.size(), static_cast<size_t>(numNodes));
+        for (int i = 0; i < numNodes; ++i) {
+            ASSERT_EQ(ids[i], i);
+        }
+    }
+    ASSERT_TRUE(graphLookupStage->getNext().isEOF());
+    ASSERT_TRUE(graphLookupStage->usedDisk());
+
+    // The first search issues one query for its starting value, and then one for each of the values
+    // on the frontier that it discovered. The second search may be partially answered by the cache.
+    std::vector<Value> explain;
+    graphLookupStage->serializeToArray(explain, ExplainOptions::Verbosity::kExecStats);
+    ASSERT_EQ(explain.size(), 1U);
+    auto searchStats = explain[0].getDocument()["$graphLookup"]["searchStats"];
+    ASSERT_GTE(searchStats["numQueries"].getLong(), numNodes + 1);
+    ASSERT_VALUE_EQ(Value(true), searchStats["usedDisk"]);
+    ASSERT_GT(searchStats["numVisitedSpills"].getLong(), 0);
+    ASSERT_GT(searchStats["numFrontierSpills"].getLong(), 0);
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldUnwindSpilledResults) {
+    const auto oldMaxMemoryBytes = internalDocumentSourceGraphLookupMaxMemoryBytes.load();
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceGraphLookupMaxMemoryBytes.store(oldMaxMemoryBytes); });
+    internalDocumentSourceGraphLookupMaxMemoryBytes.store(16 * 1024);
+
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    const int numNodes = 300;
+    auto graphLookupStage = makeGraphLookupOverChain(expCtx, numNodes);
+    auto inputMock = DocumentSourceMock::createForTest({Document{{"_id", 0}}}, expCtx);
+
+    // Absorb a following $unwind.
+    auto unwindStage = DocumentSourceUnwind::create(expCtx, "results", false, boost::none);
+    Pipeline::SourceContainer container{graphLookupStage, unwindStage};
+    graphLookupStage->optimizeAt(container.begin(), &container);
+    ASSERT_EQ(container.size(), 1U);
+    graphLookupStage->setSource(inputMock.get());
+
+    std::vector<int> ids;
+    for (auto next = graphLookupStage->getNext(); next.isAdvanced();
+         next = graphLookupStage->getNext()) {
+        ids.push_back(next.getDocument().getField("results")["_id"].getInt());
+    }
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(ids.size(), static_cast<size_t>(numNodes));
+    for (int i = 0; i < numNodes; ++i) {
+        ASSERT_EQ(ids[i], i);
+    }
+    ASSERT_TRUE(graphLookupStage->usedDisk());
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldFailWhenMemoryLimitIsReachedWithoutAllowDiskUse) {
+    const auto oldMaxMemoryBytes = internalDocumentSourceGraphLookupMaxMemoryBytes.load();
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceGraphLookupMaxMemoryBytes.store(oldMaxMemoryBytes); });
+    internalDocumentSourceGraphLookupMaxMemoryBytes.store(16 * 1024);
+
+    auto expCtx = getExpCtx();
+    expCtx->allowDiskUse = false;
+
+    auto graphLookupStage = makeGraphLookupOverChain(expCtx, 300);
+    auto inputMock = DocumentSourceMock::createForTest({Document{{"_id", 0}}}, expCtx);
+    graphLookupStage->setSource(inputMock.get());
+
+    ASSERT_THROWS_CODE(graphLookupStage->getNext(), AssertionException, 40099);
+    ASSERT_FALSE(graphLookupStage->usedDisk());
+}
+
 }  // namespace
 }  // namespace mongo
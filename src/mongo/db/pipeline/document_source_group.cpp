@@ -562,6 +562,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
                 _doingMerge);
 
             _memoryTracker.memoryUsageBytes += group[i]->memUsageForSorter();
+            _usedDisk = _usedDisk || group[i]->usedDisk();
         }
 
         if (kDebugBuild && !storageGlobalParams.readOnly) {
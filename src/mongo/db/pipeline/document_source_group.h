@@ -101,6 +101,13 @@ public:
     StringMap<boost::intrusive_ptr<Expression>> getIdFields() const;
     const std::vector<AccumulationStatement>& getAccumulatedFields() const;
 
+    /**
+     * Returns the _id of the output document of the group which 'root' belongs to.
+     */
+    Value computeOutputId(const Document& root) {
+        return expandId(computeId(root));
+    }
+
     /**
      * Convenience method for creating a new $group stage. If maxMemoryUsageBytes is boost::none,
      * then it will actually use the value of internalDocumentSourceGroupMaxMemoryBytes.
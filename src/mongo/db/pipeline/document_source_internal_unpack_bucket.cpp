@@ -0,0 +1,229 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_internal_unpack_bucket.h"
+
+#include "mongo/db/field_ref.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/expression_path.h"
+#include "mongo/db/pipeline/lite_parsed_document_source.h"
+
+namespace mongo {
+
+REGISTER_DOCUMENT_SOURCE(_internalUnpackBucket,
+                         LiteParsedDocumentSourceDefault::parse,
+                         DocumentSourceInternalUnpackBucket::createFromBson);
+
+constexpr StringData DocumentSourceInternalUnpackBucket::kStageName;
+
+boost::intrusive_ptr<DocumentSource> DocumentSourceInternalUnpackBucket::createFromBson(
+    BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+    uassert(ErrorCodes::TypeMismatch,
+            str::stream() << "$_internalUnpackBucket must take a nested object but found: "
+                          << elem,
+            elem.type() == BSONType::Object);
+
+    return new DocumentSourceInternalUnpackBucket(
+        expCtx, TimeseriesOptions::parse(IDLParserErrorContext(kStageName), elem.embeddedObject()));
+}
+
+void DocumentSourceInternalUnpackBucket::_setBucket(BSONObj bucket) {
+    _bucket = std::move(bucket);
+    _meta = _bucket["meta"];
+    _columns.clear();
+    _timeColumn = 0;
+
+    bool hasTime = false;
+    for (auto&& column : _bucket["data"].Obj()) {
+        if (column.type() != BSONType::Object) {
+            continue;
+        }
+        if (column.fieldNameStringData() == _options.getTimeField()) {
+            _timeColumn = _columns.size();
+            hasTime = true;
+        }
+        BSONObjIterator it(column.embeddedObject());
+        auto next = it.more() ? it.next() : BSONElement();
+        _columns.push_back({column.fieldNameStringData(), it, next});
+    }
+
+    // Every measurement has a time, so a bucket without one holds no measurement.
+    if (!hasTime) {
+        _columns.clear();
+    }
+}
+
+DocumentSource::GetNextResult DocumentSourceInternalUnpackBucket::doGetNext() {
+    while (_columns.empty() || !_columns[_timeColumn].next) {
+        auto next = pSource->getNext();
+        if (!next.isAdvanced()) {
+            return next;
+        }
+        _setBucket(next.getDocument().toBson());
+    }
+
+    // Every field of the measurements is stored keyed by the position of the measurement in the
+    // bucket, and the values of every field are in the same order, so the next value of each field
+    // either belongs to the next measurement or to a later one.
+    const auto position = _columns[_timeColumn].next.fieldNameStringData();
+    MutableDocument measurement;
+    for (auto&& column : _columns) {
+        if (column.next && column.next.fieldNameStringData() == position) {
+            measurement.addField(column.field, Value(column.next));
+            column.next = column.it.more() ? column.it.next() : BSONElement();
+        }
+    }
+    if (_options.getMetaField() && _meta) {
+        measurement.addField(*_options.getMetaField(), Value(_meta));
+    }
+    return measurement.freeze();
+}
+
+Pipeline::SourceContainer::iterator DocumentSourceInternalUnpackBucket::doOptimizeAt(
+    Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container) {
+    invariant(*itr == this);
+
+    if (_triedBucketMatch || std::next(itr) == container->end()) {
+        return std::next(itr);
+    }
+
+    auto nextMatch = dynamic_cast<DocumentSourceMatch*>((*std::next(itr)).get());
+    if (!nextMatch) {
+        return std::next(itr);
+    }
+
+    _triedBucketMatch = true;
+    if (auto bucketMatch = createBucketMatch(*nextMatch->getMatchExpression())) {
+        // Optimize from the new $match, which may in turn move before the stages preceding it.
+        return container->insert(itr, bucketMatch);
+    }
+    return std::next(itr);
+}
+
+boost::intrusive_ptr<DocumentSourceMatch> DocumentSourceInternalUnpackBucket::createBucketMatch(
+    const MatchExpression& predicate) const {
+    std::vector<BSONObj> bucketPredicates;
+    _addBucketPredicates(predicate, &bucketPredicates);
+    if (bucketPredicates.empty()) {
+        return nullptr;
+    }
+
+    BSONObjBuilder filter;
+    {
+        BSONArrayBuilder conjuncts(filter.subarrayStart("$and"));
+        for (auto&& bucketPredicate : bucketPredicates) {
+            conjuncts.append(bucketPredicate);
+        }
+    }
+    return DocumentSourceMatch::create(filter.obj(), pExpCtx);
+}
+
+void DocumentSourceInternalUnpackBucket::_addBucketPredicates(
+    const MatchExpression& predicate, std::vector<BSONObj>* bucketPredicates) const {
+    // Only the conjuncts of a $match are looked at, since a bucket may be skipped only if it holds
+    // no measurement matching one of them.
+    if (predicate.matchType() == MatchExpression::AND) {
+        for (size_t i = 0; i < predicate.numChildren(); ++i) {
+            _addBucketPredicates(*predicate.getChild(i), bucketPredicates);
+        }
+        return;
+    }
+
+    auto pathPredicate = dynamic_cast<const PathMatchExpression*>(&predicate);
+    if (!pathPredicate) {
+        return;
+    }
+    const auto path = pathPredicate->path();
+
+    // Every measurement of a bucket has the same meta value, which is the 'meta' field of the
+    // bucket, so a predicate on the meta field matches exactly the same buckets on 'meta'.
+    const auto metaField = _options.getMetaField();
+    if (metaField && (path == *metaField || FieldRef(*metaField).isPrefixOf(FieldRef(path)))) {
+        auto renamed = predicate.shallowClone();
+        static_cast<PathMatchExpression*>(renamed.get())
+            ->applyRename(StringMap<std::string>{{metaField->toString(), "meta"}});
+        BSONObjBuilder bucketPredicate;
+        renamed->serialize(&bucketPredicate);
+        bucketPredicates->push_back(bucketPredicate.obj());
+        return;
+    }
+
+    if (path != _options.getTimeField()) {
+        return;
+    }
+    switch (predicate.matchType()) {
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::EQ:
+            break;
+        default:
+            return;
+    }
+
+    // The times of the measurements are dates, so a comparison with a value of another type
+    // matches none of them, which is not worth telling apart here.
+    const auto& time = static_cast<const ComparisonMatchExpressionBase&>(predicate).getData();
+    if (time.type() != BSONType::Date) {
+        return;
+    }
+
+    const std::string minTime = str::stream() << "control.min." << _options.getTimeField();
+    const std::string maxTime = str::stream() << "control.max." << _options.getTimeField();
+    switch (predicate.matchType()) {
+        case MatchExpression::LT:
+            bucketPredicates->push_back(BSON(minTime << BSON("$lt" << time)));
+            break;
+        case MatchExpression::LTE:
+            bucketPredicates->push_back(BSON(minTime << BSON("$lte" << time)));
+            break;
+        case MatchExpression::GT:
+            bucketPredicates->push_back(BSON(maxTime << BSON("$gt" << time)));
+            break;
+        case MatchExpression::GTE:
+            bucketPredicates->push_back(BSON(maxTime << BSON("$gte" << time)));
+            break;
+        case MatchExpression::EQ:
+            bucketPredicates->push_back(BSON(minTime << BSON("$lte" << time)));
+            bucketPredicates->push_back(BSON(maxTime << BSON("$gte" << time)));
+            break;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+Value DocumentSourceInternalUnpackBucket::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    return Value(Document{{getSourceName(), Document(_options.toBSON())}});
+}
+
+}  // namespace mongo
@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/timeseries/timeseries_gen.h"
+
+namespace mongo {
+
+/**
+ * Unpacks the measurements out of the buckets of a time-series collection. This is the only stage
+ * of the view of a time-series collection over its buckets collection, and takes the options of the
+ * time-series collection as its specification:
+ *
+ *     {$_internalUnpackBucket: {timeField: <string>, metaField: <string>,
+ *                               bucketMaxSpanSeconds: <number>}}
+ *
+ * Each measurement holds its fields from the 'data' of the bucket, followed by the meta field. The
+ * order of the other fields of the measurement is not kept.
+ *
+ * A $match which follows this stage is also turned into a $match on the buckets, placed before this
+ * stage, so that buckets which hold no measurement matched by the $match are never unpacked:
+ *  - A predicate on the meta field, or one of its subfields, is applied to the 'meta' field of the
+ *    buckets.
+ *  - A comparison of the time field with a date is applied to the minimum or maximum time of the
+ *    buckets, in 'control.min' and 'control.max'.
+ * The original $match stays after this stage.
+ */
+class DocumentSourceInternalUnpackBucket final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalUnpackBucket"_sd;
+
+    static boost::intrusive_ptr<DocumentSource> createFromBson(
+        BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    DocumentSourceInternalUnpackBucket(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                       TimeseriesOptions options)
+        : DocumentSource(kStageName, expCtx), _options(std::move(options)) {}
+
+    const char* getSourceName() const final {
+        return kStageName.rawData();
+    }
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        return {StreamType::kStreaming,
+                PositionRequirement::kNone,
+                HostTypeRequirement::kNone,
+                DiskUseRequirement::kNoDiskUse,
+                FacetRequirement::kAllowed,
+                TransactionRequirement::kAllowed,
+                LookupRequirement::kAllowed,
+                UnionRequirement::kAllowed};
+    }
+
+    boost::optional<DistributedPlanLogic> distributedPlanLogic() final {
+        return boost::none;
+    }
+
+    /**
+     * Places a $match on the buckets before this stage, built from the $match which follows this
+     * stage, if any.
+     */
+    Pipeline::SourceContainer::iterator doOptimizeAt(Pipeline::SourceContainer::iterator itr,
+                                                     Pipeline::SourceContainer* container) final;
+
+    /**
+     * Returns a $match which matches every bucket holding a measurement matched by 'predicate', and
+     * possibly other buckets, or nullptr if no part of 'predicate' applies to the buckets.
+     */
+    boost::intrusive_ptr<DocumentSourceMatch> createBucketMatch(
+        const MatchExpression& predicate) const;
+
+private:
+    /**
+     * The values of one field of the measurements of the bucket being unpacked.
+     */
+    struct Column {
+        StringData field;
+        BSONObjIterator it;
+        // The value of the field for the next measurement which has this field, or EOO once every
+        // value has been unpacked.
+        BSONElement next;
+    };
+
+    GetNextResult doGetNext() final;
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    /**
+     * Adds the predicates on the buckets implied by 'predicate' to 'bucketPredicates'.
+     */
+    void _addBucketPredicates(const MatchExpression& predicate,
+                              std::vector<BSONObj>* bucketPredicates) const;
+
+    /**
+     * Starts unpacking 'bucket'.
+     */
+    void _setBucket(BSONObj bucket);
+
+    const TimeseriesOptions _options;
+
+    // Whether a $match on the buckets has been made from the $match which follows this stage.
+    bool _triedBucketMatch = false;
+
+    // The bucket being unpacked, its meta value, and the values of each of its fields.
+    BSONObj _bucket;
+    BSONElement _meta;
+    std::vector<Column> _columns;
+    // The position in '_columns' of the time field, whose values tell the position of every
+    // measurement in the bucket.
+    size_t _timeColumn = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/json.h"
+#include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document_source_internal_unpack_bucket.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/pipeline.h"
+
+namespace mongo {
+namespace {
+
+class InternalUnpackBucketTest : public AggregationContextFixture {
+protected:
+    BSONObj unpackSpec() const {
+        return fromjson("{$_internalUnpackBucket: {timeField: 't', metaField: 'm'}}");
+    }
+
+    boost::intrusive_ptr<DocumentSourceInternalUnpackBucket> createUnpack() {
+        auto unpack = DocumentSourceInternalUnpackBucket::createFromBson(
+            unpackSpec().firstElement(), getExpCtx());
+        return static_cast<DocumentSourceInternalUnpackBucket*>(unpack.get());
+    }
+
+    BSONObj bucketMatchFor(const char* predicate) {
+        auto expr = uassertStatusOK(MatchExpressionParser::parse(fromjson(predicate), getExpCtx()));
+        auto bucketMatch = createUnpack()->createBucketMatch(*expr);
+        return bucketMatch ? bucketMatch->getQuery() : BSONObj();
+    }
+};
+
+TEST_F(InternalUnpackBucketTest, UnpacksMeasurementsOfEachBucket) {
+    auto unpack = createUnpack();
+    auto mock = DocumentSourceMock::createForTest(
+        {"{_id: 1, meta: {a: 1}, data: {_id: {'0': 1, '1': 2, '2': 3}, "
+         "t: {'0': {$date: 0}, '1': {$date: 1}, '2': {$date: 2}}, x: {'0': 'a', '2': 'c'}}}",
+         "{_id: 2, data: {t: {}}}",
+         "{_id: 3, data: {t: {'10': {$date: 10}, '9': {$date: 9}}, x: {'9': 'i'}}}"},
+        getExpCtx());
+    unpack->setSource(mock.get());
+
+    auto expectNext = [&](const char* expected) {
+        auto next = unpack->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(), Document(fromjson(expected)));
+    };
+    expectNext("{_id: 1, t: {$date: 0}, x: 'a', m: {a: 1}}");
+    expectNext("{_id: 2, t: {$date: 1}, m: {a: 1}}");
+    expectNext("{_id: 3, t: {$date: 2}, x: 'c', m: {a: 1}}");
+    // An empty bucket is skipped, and the measurements of a bucket without a meta value have no
+    // meta field. The values of a field which are not in the order of their positions are still
+    // matched with their measurements.
+    expectNext("{t: {$date: 10}}");
+    expectNext("{t: {$date: 9}, x: 'i'}");
+    ASSERT_TRUE(unpack->getNext().isEOF());
+}
+
+TEST_F(InternalUnpackBucketTest, MetaPredicatesApplyToTheMetaOfTheBuckets) {
+    ASSERT_BSONOBJ_EQ(bucketMatchFor("{m: 1}"), fromjson("{$and: [{meta: {$eq: 1}}]}"));
+    ASSERT_BSONOBJ_EQ(bucketMatchFor("{'m.a': {$in: [1, 2]}, x: 1}"),
+                      fromjson("{$and: [{'meta.a': {$in: [1, 2]}}]}"));
+    ASSERT_BSONOBJ_EQ(bucketMatchFor("{x: 1, mm: 1}"), BSONObj());
+    ASSERT_BSONOBJ_EQ(bucketMatchFor("{$or: [{m: 1}, {x: 1}]}"), BSONObj());
+}
+
+TEST_F(InternalUnpackBucketTest, TimePredicatesApplyToTheBoundsOfTheBuckets) {
+    ASSERT_BSONOBJ_EQ(
+        bucketMatchFor("{t: {$gt: {$date: 5}, $lte: {$date: 10}}}"),
+        fromjson("{$and: [{'control.max.t': {$gt: {$date: 5}}}, "
+                 "{'control.min.t': {$lte: {$date: 10}}}]}"));
+    ASSERT_BSONOBJ_EQ(bucketMatchFor("{t: {$date: 5}, m: 'a'}"),
+                      fromjson("{$and: [{'control.min.t': {$lte: {$date: 5}}}, "
+                               "{'control.max.t': {$gte: {$date: 5}}}, {meta: {$eq: 'a'}}]}"));
+
+    // Comparisons with values which are not dates, and other predicates on the time field, are not
+    // applied to the buckets.
+    ASSERT_BSONOBJ_EQ(bucketMatchFor("{t: {$gt: 5}}"), BSONObj());
+    ASSERT_BSONOBJ_EQ(bucketMatchFor("{t: {$exists: true}}"), BSONObj());
+}
+
+TEST_F(InternalUnpackBucketTest, BucketMatchIsPlacedBeforeTheStage) {
+    auto pipeline = Pipeline::parse(
+        {unpackSpec(), fromjson("{$match: {m: 'a', x: 1}}"), fromjson("{$project: {x: 1}}")},
+        getExpCtx());
+    pipeline->optimizePipeline();
+
+    auto serialized = pipeline->serializeToBson();
+    ASSERT_EQ(serialized.size(), 4u);
+    ASSERT_BSONOBJ_EQ(serialized[0], fromjson("{$match: {$and: [{meta: {$eq: 'a'}}]}}"));
+    ASSERT_BSONOBJ_EQ(serialized[1],
+                      fromjson("{$_internalUnpackBucket: {timeField: 't', metaField: 'm', "
+                               "bucketMaxSpanSeconds: 3600}}"));
+    ASSERT_EQ(serialized[2].firstElementFieldNameStringData(), "$match");
+
+    // Optimizing again does not add another $match.
+    pipeline->optimizePipeline();
+    ASSERT_EQ(pipeline->serializeToBson().size(), 4u);
+}
+
+}  // namespace
+}  // namespace mongo
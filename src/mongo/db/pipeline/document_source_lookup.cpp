@@ -33,13 +33,17 @@
 
 #include <memory>
 
+#include "mongo/base/exact_cast.h"
 #include "mongo/base/init.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
 #include "mongo/db/pipeline/document_path_support.h"
+#include "mongo/db/pipeline/document_source_limit.h"
 #include "mongo/db/pipeline/document_source_merge_gen.h"
+#include "mongo/db/pipeline/document_source_queue.h"
+#include "mongo/db/pipeline/document_source_sort.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/variable_validation.h"
@@ -276,6 +280,18 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
         return unwindResult();
     }
 
+    // Return what is left of the current batch before reading more input.
+    if (!_batchedOutput.empty()) {
+        auto output = std::move(_batchedOutput.front());
+        _batchedOutput.pop_front();
+        return output;
+    }
+    if (_batchedInputEnd) {
+        auto inputEnd = std::move(*_batchedInputEnd);
+        _batchedInputEnd.reset();
+        return inputEnd;
+    }
+
     auto nextInput = pSource->getNext();
     if (!nextInput.isAdvanced()) {
         return nextInput;
@@ -287,16 +303,20 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     // '_unwindSrc' would be non-null, and we would not have made it here.
     invariant(!_matchSrc);
 
-    if (!wasConstructedWithPipelineSyntax()) {
-        auto matchStage =
-            makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
-        // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
-        _resolvedPipeline.back() = matchStage;
-    }
-
-    std::unique_ptr<Pipeline, PipelineDeleter> pipeline;
     try {
-        pipeline = buildPipeline(inputDoc);
+        if (!wasConstructedWithPipelineSyntax() && !_joinStrategy) {
+            _joinStrategy = chooseJoinStrategy();
+        }
+
+        if (_joinStrategy == JoinStrategy::kBatchedLoopJoin) {
+            joinBatch(std::move(inputDoc));
+            invariant(!_batchedOutput.empty());
+            auto output = std::move(_batchedOutput.front());
+            _batchedOutput.pop_front();
+            return output;
+        }
+
+        return joinDocument(std::move(inputDoc));
     } catch (const ExceptionForCat<ErrorCategory::StaleShardVersionError>& ex) {
         // If lookup on a sharded collection is disallowed and the foreign collection is sharded,
         // throw a custom exception.
@@ -308,21 +328,29 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
         }
         throw;
     }
+}
+
+Document DocumentSourceLookUp::joinDocument(Document inputDoc) {
+    std::unique_ptr<Pipeline, PipelineDeleter> pipeline;
+    if (_joinStrategy == JoinStrategy::kHashJoin) {
+        pipeline = probeHashJoinTable(inputDoc);
+    }
+
+    if (!pipeline) {
+        if (!wasConstructedWithPipelineSyntax()) {
+            auto matchStage = makeMatchStageFromInput(
+                inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
+            // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
+            _resolvedPipeline.back() = matchStage;
+        }
+        pipeline = buildPipeline(inputDoc);
+    }
 
     std::vector<Value> results;
     long long objsize = 0;
-    const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
 
     while (auto result = pipeline->getNext()) {
-        long long safeSum = 0;
-        bool hasOverflowed = overflow::add(objsize, result->getApproximateSize(), &safeSum);
-        uassert(4568,
-                str::stream() << "Total size of documents in " << _fromNs.coll()
-                              << " matching pipeline's $lookup stage exceeds " << maxBytes
-                              << " bytes",
-
-                !hasOverflowed && objsize <= maxBytes);
-        objsize = safeSum;
+        addJoinedSize(*result, &objsize);
         results.emplace_back(std::move(*result));
     }
     _usedDisk = _usedDisk || pipeline->usedDisk();
@@ -332,6 +360,117 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     return output.freeze();
 }
 
+void DocumentSourceLookUp::joinBatch(Document firstInput) {
+    invariant(!wasConstructedWithPipelineSyntax());
+    invariant(_batchedOutput.empty() && !_batchedInputEnd);
+
+    // Stop filling the batch at a pause or EOF, which is returned after the batch's output.
+    const auto batchSize = internalQueryLookupBatchSize.load();
+    std::vector<Document> batch{std::move(firstInput)};
+    while (static_cast<long long>(batch.size()) < batchSize) {
+        auto nextInput = pSource->getNext();
+        if (!nextInput.isAdvanced()) {
+            _batchedInputEnd = std::move(nextInput);
+            break;
+        }
+        batch.push_back(nextInput.releaseDocument());
+    }
+
+    // Collect the distinct 'localField' values of the batch. As with the hash join, null,
+    // undefined, missing and nested array values have matching semantics which the in-memory join
+    // does not reproduce, so documents holding them are joined by their own foreign pipeline.
+    auto localValues = _fromExpCtx->getValueComparator().makeOrderedValueSet();
+    std::vector<bool> isBatched(batch.size(), true);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        bool hasValues = false;
+        document_path_support::visitAllValuesAtPath(
+            batch[i], *_localField, [&](const Value& value) {
+                hasValues = true;
+                if (value.nullish() || value.isArray()) {
+                    isBatched[i] = false;
+                }
+            });
+        if (!hasValues) {
+            isBatched[i] = false;
+        }
+        if (isBatched[i]) {
+            document_path_support::visitAllValuesAtPath(
+                batch[i], *_localField, [&](const Value& value) { localValues.insert(value); });
+        }
+    }
+
+    // Run a single foreign pipeline over all of the values, and index the foreign documents it
+    // returns by their values at 'foreignField', in the order they were returned.
+    std::vector<Document> foreignDocs;
+    auto foreignDocsByValue =
+        _fromExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>();
+    if (!localValues.empty()) {
+        static constexpr StringData kValuesField = "values"_sd;
+        const Document valuesDoc{
+            {kValuesField, Value(std::vector<Value>(localValues.begin(), localValues.end()))}};
+        _resolvedPipeline.back() = makeMatchStageFromInput(
+            valuesDoc, FieldPath(kValuesField), _foreignField->fullPath(), BSONObj());
+        auto pipeline = buildPipeline(batch.front());
+
+        while (auto next = pipeline->getNext()) {
+            const size_t position = foreignDocs.size();
+            document_path_support::visitAllValuesAtPath(
+                *next, *_foreignField, [&](const Value& value) {
+                    auto& positions = foreignDocsByValue[value];
+                    if (positions.empty() || positions.back() != position) {
+                        positions.push_back(position);
+                    }
+                });
+            foreignDocs.push_back(std::move(*next));
+        }
+        _usedDisk = _usedDisk || pipeline->usedDisk();
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (!isBatched[i]) {
+            _batchedOutput.push_back(joinDocument(std::move(batch[i])));
+            continue;
+        }
+
+        // Return each matching foreign document once, in the order the foreign pipeline returned
+        // it, as the nested loop join would.
+        std::vector<size_t> positions;
+        document_path_support::visitAllValuesAtPath(
+            batch[i], *_localField, [&](const Value& value) {
+                auto it = foreignDocsByValue.find(value);
+                if (it != foreignDocsByValue.end()) {
+                    positions.insert(positions.end(), it->second.begin(), it->second.end());
+                }
+            });
+        std::sort(positions.begin(), positions.end());
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+        std::vector<Value> results;
+        long long objsize = 0;
+        for (auto position : positions) {
+            addJoinedSize(foreignDocs[position], &objsize);
+            results.emplace_back(foreignDocs[position]);
+        }
+
+        MutableDocument output(std::move(batch[i]));
+        output.setNestedField(_as, Value(std::move(results)));
+        _batchedOutput.push_back(output.freeze());
+    }
+}
+
+void DocumentSourceLookUp::addJoinedSize(const Document& joined,
+                                         long long* joinedSizeBytes) const {
+    const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
+    long long safeSum = 0;
+    bool hasOverflowed = overflow::add(*joinedSizeBytes, joined.getApproximateSize(), &safeSum);
+    uassert(4568,
+            str::stream() << "Total size of documents in " << _fromNs.coll()
+                          << " matching pipeline's $lookup stage exceeds " << maxBytes
+                          << " bytes",
+            !hasOverflowed && *joinedSizeBytes <= maxBytes);
+    *joinedSizeBytes = safeSum;
+}
+
 std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -395,6 +534,154 @@ std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     return pipeline;
 }
 
+StringData DocumentSourceLookUp::joinStrategyToString(JoinStrategy strategy) {
+    switch (strategy) {
+        case JoinStrategy::kNestedLoopJoin:
+            return "NestedLoopJoin"_sd;
+        case JoinStrategy::kBatchedLoopJoin:
+            return "BatchedLoopJoin"_sd;
+        case JoinStrategy::kHashJoin:
+            return "HashJoin"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
+DocumentSourceLookUp::JoinStrategy DocumentSourceLookUp::chooseJoinStrategy() {
+    invariant(!wasConstructedWithPipelineSyntax());
+
+    // When neither an index nor a hash table can answer the join, the foreign pipeline may still
+    // be run once per batch of input documents rather than once per document. The $unwind which
+    // may have been absorbed streams the results of one input document at a time instead.
+    const auto loopJoin = [&] {
+        return internalQueryLookupBatchSize.load() > 1 && !_unwindSrc
+            ? JoinStrategy::kBatchedLoopJoin
+            : JoinStrategy::kNestedLoopJoin;
+    };
+
+    // The foreign collection can only be read in one pass when it is local to this node.
+    auto opCtx = pExpCtx->opCtx;
+    const auto& processInterface = pExpCtx->mongoProcessInterface;
+    if (pExpCtx->inMongos ||
+        (foreignShardedLookupAllowed() && processInterface->isSharded(opCtx, _resolvedNs))) {
+        return loopJoin();
+    }
+
+    // The hash join is only used if it has been enabled.
+    const auto maxForeignCount = internalQueryLookupHashJoinMaxForeignCollectionCount.load();
+    if (maxForeignCount == 0) {
+        return loopJoin();
+    }
+
+    // An index on 'foreignField' answers the $match of the foreign pipeline with point lookups,
+    // which is cheaper than reading the whole foreign collection. The index must be a visible
+    // btree or hashed index without a partial filter, and must share the collation of the
+    // $lookup. Indexes cannot be used through a view pipeline, so only check for a collection.
+    const auto foreignField = _foreignField->fullPath();
+    if (_resolvedPipeline.size() == 1) {
+        const auto collation = _fromExpCtx->getCollator()
+            ? _fromExpCtx->getCollator()->getSpec().toBSON()
+            : BSONObj();
+        for (auto&& spec : processInterface->getIndexSpecs(opCtx, _resolvedNs, false)) {
+            const auto firstKey = spec.getObjectField("key").firstElement();
+            if (firstKey.fieldNameStringData() == foreignField &&
+                (firstKey.isNumber() || firstKey.valueStringData() == "hashed"_sd) &&
+                !spec.getBoolField("hidden") && !spec.hasField("partialFilterExpression") &&
+                spec.getObjectField("collation").woCompare(collation) == 0) {
+                return loopJoin();
+            }
+        }
+    }
+
+    // Otherwise, a small enough foreign collection is cheaper to read once into a hash table than
+    // to scan once per input document. If the collection cannot be counted (e.g. it does not
+    // exist), the nested loop join is cheap anyway.
+    BSONObjBuilder countBuilder;
+    if (!processInterface->appendRecordCount(opCtx, _resolvedNs, &countBuilder).isOK()) {
+        return loopJoin();
+    }
+    if (countBuilder.obj()["count"].safeNumberLong() > maxForeignCount) {
+        return loopJoin();
+    }
+
+    return buildHashJoinTable() ? JoinStrategy::kHashJoin : loopJoin();
+}
+
+bool DocumentSourceLookUp::buildHashJoinTable() {
+    // Read the whole foreign collection (or view), applying only the filter absorbed from a
+    // subsequent $match. The join predicate is evaluated by probing the hash table instead.
+    _resolvedPipeline.back() = BSON("$match" << _additionalFilter.value_or(BSONObj()));
+    auto pipeline = buildPipeline(Document());
+
+    _hashJoinTable.emplace(
+        _fromExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>());
+    const auto maxMemoryBytes = internalQueryLookupHashJoinMaxMemoryBytes.load();
+    long long memoryUsageBytes = 0;
+
+    while (auto next = pipeline->getNext()) {
+        memoryUsageBytes += next->getApproximateSize();
+        if (memoryUsageBytes > maxMemoryBytes) {
+            _hashJoinDocs.clear();
+            _hashJoinTable.reset();
+            return false;
+        }
+
+        const size_t position = _hashJoinDocs.size();
+        document_path_support::visitAllValuesAtPath(
+            *next, *_foreignField, [&](const Value& value) {
+                // A document may hold the same value more than once along 'foreignField', but
+                // must only be returned once per matching input document.
+                auto& positions = (*_hashJoinTable)[value];
+                if (positions.empty() || positions.back() != position) {
+                    positions.push_back(position);
+                    memoryUsageBytes += sizeof(size_t);
+                }
+            });
+        _hashJoinDocs.push_back(std::move(*next));
+    }
+    _usedDisk = _usedDisk || pipeline->usedDisk();
+
+    return true;
+}
+
+std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::probeHashJoinTable(
+    const Document& inputDoc) {
+    invariant(_hashJoinTable);
+
+    std::vector<size_t> positions;
+    bool hasValues = false;
+    bool canProbe = true;
+    document_path_support::visitAllValuesAtPath(inputDoc, *_localField, [&](const Value& value) {
+        hasValues = true;
+        // Null and undefined also match foreign documents which are missing 'foreignField', and
+        // arrays nested in the local field match whole array values. Neither is indexed in the
+        // hash table, so such input documents are joined by the foreign pipeline instead.
+        if (value.nullish() || value.isArray()) {
+            canProbe = false;
+            return;
+        }
+        auto it = _hashJoinTable->find(value);
+        if (it != _hashJoinTable->end()) {
+            positions.insert(positions.end(), it->second.begin(), it->second.end());
+        }
+    });
+
+    // A missing local field is treated as null.
+    if (!hasValues || !canProbe) {
+        return nullptr;
+    }
+
+    // Return each matching foreign document once, in the order it was read from the collection,
+    // as the nested loop join would.
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+    auto queue = DocumentSourceQueue::create(_fromExpCtx);
+    for (auto position : positions) {
+        queue->emplace_back(Document(_hashJoinDocs[position]));
+    }
+    return Pipeline::create({queue}, _fromExpCtx);
+}
+
 DocumentSource::GetModPathsReturn DocumentSourceLookUp::getModifiedPaths() const {
     std::set<std::string> modifiedPaths{_as.fullPath()};
     if (_unwindSrc) {
@@ -406,6 +693,80 @@ DocumentSource::GetModPathsReturn DocumentSourceLookUp::getModifiedPaths() const
     return {GetModPathsReturn::Type::kFiniteSet, std::move(modifiedPaths), {}};
 }
 
+boost::optional<Pipeline::SourceContainer::iterator> DocumentSourceLookUp::pushTopKBefore(
+    Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container) {
+    auto nextItr = std::next(itr);
+    auto nextSort = dynamic_cast<DocumentSourceSort*>(nextItr->get());
+    auto nextLimit = exact_pointer_cast<DocumentSourceLimit*>(nextItr->get());
+    if (!nextSort && !nextLimit) {
+        return boost::none;
+    }
+
+    // The $limit which bounds a $sort may not have been coalesced into it yet.
+    boost::optional<long long> limit = nextLimit ? nextLimit->getLimit() : nextSort->getLimit();
+    if (nextSort && !limit && std::next(nextItr) != container->end()) {
+        auto limitAfterSort = exact_pointer_cast<DocumentSourceLimit*>(std::next(nextItr)->get());
+        if (limitAfterSort) {
+            limit = limitAfterSort->getLimit();
+        }
+    }
+    if (!limit) {
+        return boost::none;
+    }
+
+    // The $sort must not depend on the fields this stage sets.
+    if (nextSort) {
+        const auto modifiedPaths = getModifiedPaths().paths;
+        for (auto&& part : nextSort->getSortKeyPattern()) {
+            if (!part.fieldPath) {
+                return boost::none;
+            }
+            const auto sortPath = part.fieldPath->fullPath();
+            for (auto&& modifiedPath : modifiedPaths) {
+                if (sortPath == modifiedPath ||
+                    expression::isPathPrefixOf(sortPath, modifiedPath) ||
+                    expression::isPathPrefixOf(modifiedPath, sortPath)) {
+                    return boost::none;
+                }
+            }
+        }
+    }
+
+    auto resumeAt = [&](Pipeline::SourceContainer::iterator movedItr) {
+        // Let the stage which now precedes the moved stage try to optimize with it.
+        return movedItr == container->begin() ? movedItr : std::prev(movedItr);
+    };
+
+    if (!_unwindSrc) {
+        // Without an $unwind, each input document produces exactly one output document, so the
+        // $sort or $limit can simply run first.
+        std::iter_swap(itr, nextItr);
+        return resumeAt(itr);
+    }
+
+    // With an $unwind which preserves null and empty arrays, each input document produces at least
+    // one output document, all of which have the same sort key. The first 'limit' output documents
+    // are then produced by the first 'limit' input documents, which a copy of the $sort or $limit
+    // ahead of this stage selects. The original stage still has to bound the unwound output.
+    if (!_unwindSrc->preserveNullAndEmptyArrays() || _pushedDownTopK) {
+        return boost::none;
+    }
+    _pushedDownTopK = true;
+
+    boost::intrusive_ptr<DocumentSource> topK;
+    if (nextSort) {
+        topK = DocumentSourceSort::create(
+            pExpCtx,
+            nextSort->getSortKeyPattern()
+                .serialize(SortPattern::SortKeySerialization::kForPipelineSerialization)
+                .toBson(),
+            *limit);
+    } else {
+        topK = DocumentSourceLimit::create(pExpCtx, *limit);
+    }
+    return resumeAt(container->insert(itr, std::move(topK)));
+}
+
 Pipeline::SourceContainer::iterator DocumentSourceLookUp::doOptimizeAt(
     Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container) {
     invariant(*itr == this);
@@ -424,6 +785,10 @@ Pipeline::SourceContainer::iterator DocumentSourceLookUp::doOptimizeAt(
         return itr;
     }
 
+    if (auto resumeItr = pushTopKBefore(itr, container)) {
+        return *resumeItr;
+    }
+
     // Attempt to internalize any predicates of a $match upon the "_as" field.
     auto nextMatch = dynamic_cast<DocumentSourceMatch*>((*std::next(itr)).get());
 
@@ -536,6 +901,9 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _hashJoinDocs.clear();
+    _hashJoinTable.reset();
+    _batchedOutput.clear();
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
@@ -636,20 +1004,32 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
         _input = nextInput.releaseDocument();
 
-        if (!wasConstructedWithPipelineSyntax()) {
-            BSONObj filter = _additionalFilter.value_or(BSONObj());
-            auto matchStage =
-                makeMatchStageFromInput(*_input, *_localField, _foreignField->fullPath(), filter);
-            // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
-            _resolvedPipeline.back() = matchStage;
-        }
-
         if (_pipeline) {
             _usedDisk = _usedDisk || _pipeline->usedDisk();
             _pipeline->dispose(pExpCtx->opCtx);
+            _pipeline.reset();
         }
 
-        _pipeline = buildPipeline(*_input);
+        if (!wasConstructedWithPipelineSyntax()) {
+            if (!_joinStrategy) {
+                _joinStrategy = chooseJoinStrategy();
+            }
+            if (*_joinStrategy == JoinStrategy::kHashJoin) {
+                _pipeline = probeHashJoinTable(*_input);
+            }
+        }
+
+        if (!_pipeline) {
+            if (!wasConstructedWithPipelineSyntax()) {
+                BSONObj filter = _additionalFilter.value_or(BSONObj());
+                auto matchStage = makeMatchStageFromInput(
+                    *_input, *_localField, _foreignField->fullPath(), filter);
+                // We've already allocated space for the trailing $match stage in
+                // '_resolvedPipeline'.
+                _resolvedPipeline.back() = matchStage;
+            }
+            _pipeline = buildPipeline(*_input);
+        }
 
         // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
         // potentially be used by multiple OperationContexts, and the $lookup stage is part of an
@@ -757,6 +1137,11 @@ void DocumentSourceLookUp::serializeToArray(
             output[getSourceName()]["matching"] = Value(*_additionalFilter);
         }
 
+        // The join strategy is only known once the $lookup has started executing.
+        if (_joinStrategy) {
+            output[getSourceName()]["strategy"] = Value(joinStrategyToString(*_joinStrategy));
+        }
+
         array.push_back(Value(output.freeze()));
     } else {
         array.push_back(Value(output.freeze()));
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 
 #include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/pipeline/document_source.h"
@@ -50,6 +51,25 @@ class DocumentSourceLookUp final : public DocumentSource {
 public:
     static constexpr StringData kStageName = "$lookup"_sd;
 
+    /**
+     * The join algorithm used by a $lookup specified with localField/foreignField syntax. The
+     * strategy is chosen on the first call to getNext(), based on whether the foreign collection
+     * has an index on 'foreignField', on the number of documents it holds and on
+     * internalQueryLookupBatchSize.
+     */
+    enum class JoinStrategy {
+        // Runs the foreign pipeline once per input document.
+        kNestedLoopJoin,
+        // Runs the foreign pipeline once per batch of input documents, matching the distinct
+        // 'localField' values of the batch, and joins the results to each document in memory.
+        kBatchedLoopJoin,
+        // Reads the foreign collection once into a hash table keyed by 'foreignField' and probes
+        // it with the 'localField' values of each input document.
+        kHashJoin,
+    };
+
+    static StringData joinStrategyToString(JoinStrategy strategy);
+
     struct LetVariable {
         LetVariable(std::string name, boost::intrusive_ptr<Expression> expression, Variables::Id id)
             : name(std::move(name)), expression(std::move(expression)), id(id) {}
@@ -163,6 +183,14 @@ public:
         return _letVariables;
     }
 
+    /**
+     * Returns the join strategy picked by this $lookup, or boost::none if it has not started
+     * executing yet or was constructed with pipeline syntax.
+     */
+    boost::optional<JoinStrategy> getJoinStrategy() const {
+        return _joinStrategy;
+    }
+
     /**
      * Returns a non-executable pipeline which can be useful for introspection. In this pipeline,
      * all view definitions are resolved. This pipeline is present in both the sub-pipeline version
@@ -196,12 +224,20 @@ protected:
 
     /**
      * Attempts to combine with a subsequent $unwind stage, setting the internal '_unwindSrc'
-     * field.
+     * field, and to move a subsequent top-k $sort or $limit ahead of this stage.
      */
     Pipeline::SourceContainer::iterator doOptimizeAt(Pipeline::SourceContainer::iterator itr,
                                                      Pipeline::SourceContainer* container) final;
 
 private:
+    /**
+     * Attempts to move the $sort or $limit stage which follows this stage, pointed to by 'itr',
+     * ahead of it, so that only the documents which make it past the $sort or $limit are joined.
+     * Returns the position to resume optimizing at if the pipeline was rewritten, or boost::none.
+     */
+    boost::optional<Pipeline::SourceContainer::iterator> pushTopKBefore(
+        Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container);
+
     /**
      * Target constructor. Handles common-field initialization for the syntax-specific delegating
      * constructors.
@@ -256,6 +292,49 @@ private:
      */
     std::unique_ptr<Pipeline, PipelineDeleter> buildPipeline(const Document& inputDoc);
 
+    /**
+     * Picks the join strategy for a $lookup with localField/foreignField syntax. If a hash join is
+     * chosen, also builds the hash table over the foreign collection.
+     */
+    JoinStrategy chooseJoinStrategy();
+
+    /**
+     * Reads the foreign collection into '_hashJoinDocs' and indexes each document by all of its
+     * values at '_foreignField'. Returns false and releases the partially built table if the
+     * foreign documents do not fit in internalQueryLookupHashJoinMaxMemoryBytes.
+     */
+    bool buildHashJoinTable();
+
+    /**
+     * Returns a pipeline which produces the foreign documents joining with 'inputDoc', in the order
+     * they were read from the foreign collection. Returns nullptr if the 'localField' values of
+     * 'inputDoc' cannot be answered from the hash table, in which case the caller must fall back to
+     * running the foreign pipeline.
+     */
+    std::unique_ptr<Pipeline, PipelineDeleter> probeHashJoinTable(const Document& inputDoc);
+
+    /**
+     * Joins 'inputDoc' with the foreign documents returned by the hash table or by a foreign
+     * pipeline built for it, and returns the output document.
+     */
+    Document joinDocument(Document inputDoc);
+
+    /**
+     * Reads up to internalQueryLookupBatchSize input documents, starting with 'firstInput', and
+     * joins them with the foreign documents returned by a single foreign pipeline which matches
+     * all of their 'localField' values. The output documents are appended to '_batchedOutput' in
+     * input order. Input documents whose 'localField' values are null, missing, undefined or
+     * arrays are joined one at a time instead.
+     */
+    void joinBatch(Document firstInput);
+
+    /**
+     * Adds the size of 'joined' to 'joinedSizeBytes', the size of the foreign documents joined
+     * with one input document so far, and throws if the total exceeds
+     * internalLookupStageIntermediateDocumentMaxSizeBytes.
+     */
+    void addJoinedSize(const Document& joined, long long* joinedSizeBytes) const;
+
     /**
      * Reinitialize the cache with a new max size. May only be called if this DSLookup was created
      * with pipeline syntax, the cache has not been frozen or abandoned, and no data has been added
@@ -277,6 +356,21 @@ private:
     boost::optional<FieldPath> _localField;
     boost::optional<FieldPath> _foreignField;
 
+    // The join strategy, chosen lazily on the first call to getNext(). Only used with
+    // localField/foreignField syntax.
+    boost::optional<JoinStrategy> _joinStrategy;
+
+    // The build side of a hash join: the foreign documents in the order they were read, and a map
+    // from each value at '_foreignField' to the positions of the documents containing it.
+    std::vector<Document> _hashJoinDocs;
+    boost::optional<ValueUnorderedMap<std::vector<size_t>>> _hashJoinTable;
+
+    // The output documents of the current batch which have not been returned yet, and the pause
+    // or EOF which ended the batch's input, to be returned once they have been. Only used by the
+    // batched loop join.
+    std::deque<Document> _batchedOutput;
+    boost::optional<GetNextResult> _batchedInputEnd;
+
     // Holds 'let' defined variables defined both in this stage and in parent pipelines. These are
     // copied to the '_fromExpCtx' ExpressionContext's 'variables' and 'variablesParseState' for use
     // in foreign pipeline execution.
@@ -308,6 +402,10 @@ private:
     boost::intrusive_ptr<DocumentSourceMatch> _matchSrc;
     boost::intrusive_ptr<DocumentSourceUnwind> _unwindSrc;
 
+    // Whether a copy of a subsequent $sort or $limit was placed ahead of this stage, which is only
+    // done once.
+    bool _pushedDownTopK = false;
+
     // The following members are used to hold onto state across getNext() calls when '_unwindSrc' is
     // not null.
     long long _cursorIndex = 0;
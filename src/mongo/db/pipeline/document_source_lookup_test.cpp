@@ -50,6 +50,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -684,12 +685,51 @@ public:
 
         pipeline->addInitialSource(
             DocumentSourceMock::createForTest(_mockResults, pipeline->getContext()));
+        ++_numForeignPipelines;
         return pipeline;
     }
 
+    /**
+     * Returns the number of foreign pipelines which have been given a cursor source.
+     */
+    int getNumForeignPipelines() const {
+        return _numForeignPipelines;
+    }
+
+    std::list<BSONObj> getIndexSpecs(OperationContext* opCtx,
+                                     const NamespaceString& ns,
+                                     bool includeBuildUUIDs) final {
+        return _indexSpecs;
+    }
+
+    Status appendRecordCount(OperationContext* opCtx,
+                             const NamespaceString& nss,
+                             BSONObjBuilder* builder) const final {
+        if (!_recordCount) {
+            return {ErrorCodes::NamespaceNotFound, "record count is not mocked"};
+        }
+        builder->appendNumber("count", *_recordCount);
+        return Status::OK();
+    }
+
+    /**
+     * Reports 'recordCount' as the size of the foreign collection. Otherwise the foreign collection
+     * cannot be counted and $lookup always uses a nested loop join.
+     */
+    void setRecordCount(long long recordCount) {
+        _recordCount = recordCount;
+    }
+
+    void setIndexSpecs(std::list<BSONObj> indexSpecs) {
+        _indexSpecs = std::move(indexSpecs);
+    }
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
     bool _removeLeadingQueryStages = false;
+    boost::optional<long long> _recordCount;
+    std::list<BSONObj> _indexSpecs;
+    int _numForeignPipelines = 0;
 };
 
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
@@ -800,6 +840,303 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     lookup->dispose();
 }
 
+TEST_F(DocumentSourceLookUpTest, ShouldUseHashJoinForSmallUnindexedForeignCollection) {
+    const auto originalMaxForeignCount =
+        internalQueryLookupHashJoinMaxForeignCollectionCount.load();
+    internalQueryLookupHashJoinMaxForeignCollectionCount.store(100);
+    ON_BLOCK_EXIT([&] {
+        internalQueryLookupHashJoinMaxForeignCollectionCount.store(originalMaxForeignCount);
+    });
+
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    // Mock out the foreign collection. Leading $match stages are removed from the foreign
+    // pipeline, so only a hash join can produce correctly filtered results for non-null values.
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}, {"x", 1}},
+        Document{{"_id", 1}, {"x", Value(vector<Value>{Value(1), Value(2), Value(1)})}},
+        Document{{"_id", 2}, {"x", 3}}};
+    auto processInterface = std::make_shared<MockMongoInterface>(
+        std::move(mockForeignContents), true /* removeLeadingQueryStages */);
+    processInterface->setRecordCount(3);
+    expCtx->mongoProcessInterface = processInterface;
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "a"_sd},
+                                         {"foreignField", "x"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource = DocumentSourceMock::createForTest(
+        {Document{{"a", 1}},
+         Document{{"a", Value(vector<Value>{Value(3), Value(2)})}},
+         Document{{"a", 4}}},
+        expCtx);
+    lookup->setSource(mockLocalSource.get());
+
+    // Each matching foreign document is returned once, in foreign collection order.
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    auto firstResult = next.releaseDocument();
+    ASSERT_EQ(firstResult["foreignDocs"].getArrayLength(), 2UL);
+    ASSERT_VALUE_EQ(firstResult["foreignDocs"][0]["_id"], Value(0));
+    ASSERT_VALUE_EQ(firstResult["foreignDocs"][1]["_id"], Value(1));
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kHashJoin);
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    auto secondResult = next.releaseDocument();
+    ASSERT_EQ(secondResult["foreignDocs"].getArrayLength(), 2UL);
+    ASSERT_VALUE_EQ(secondResult["foreignDocs"][0]["_id"], Value(1));
+    ASSERT_VALUE_EQ(secondResult["foreignDocs"][1]["_id"], Value(2));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"a", 4}, {"foreignDocs", vector<Value>{}}}));
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+
+    vector<Value> explained;
+    lookup->serializeToArray(explained, ExplainOptions::Verbosity::kExecStats);
+    ASSERT_VALUE_EQ(explained[0]["$lookup"]["strategy"], Value("HashJoin"_sd));
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinShouldFallBackToForeignPipelineForNullLocalValues) {
+    const auto originalMaxForeignCount =
+        internalQueryLookupHashJoinMaxForeignCollectionCount.load();
+    internalQueryLookupHashJoinMaxForeignCollectionCount.store(100);
+    ON_BLOCK_EXIT([&] {
+        internalQueryLookupHashJoinMaxForeignCollectionCount.store(originalMaxForeignCount);
+    });
+
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"_id", 0}, {"x", 1}},
+                                                             Document{{"_id", 1}}};
+    auto processInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+    processInterface->setRecordCount(2);
+    expCtx->mongoProcessInterface = processInterface;
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "a"_sd},
+                                         {"foreignField", "x"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource =
+        DocumentSourceMock::createForTest({Document{{"a", BSONNULL}}, Document{}}, expCtx);
+    lookup->setSource(mockLocalSource.get());
+
+    // Null and missing local values match foreign documents where 'x' is missing.
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"a", BSONNULL}, {"foreignDocs", vector<Value>{Value(Document{{"_id", 1}})}}}));
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kHashJoin);
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"foreignDocs", vector<Value>{Value(Document{{"_id", 1}})}}}));
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldNotUseHashJoinWhenForeignFieldIsIndexed) {
+    const auto originalMaxForeignCount =
+        internalQueryLookupHashJoinMaxForeignCollectionCount.load();
+    internalQueryLookupHashJoinMaxForeignCollectionCount.store(100);
+    ON_BLOCK_EXIT([&] {
+        internalQueryLookupHashJoinMaxForeignCollectionCount.store(originalMaxForeignCount);
+    });
+
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    auto processInterface = std::make_shared<MockMongoInterface>(
+        deque<DocumentSource::GetNextResult>{Document{{"_id", 0}, {"x", 1}}});
+    processInterface->setRecordCount(1);
+    processInterface->setIndexSpecs(
+        {BSON("v" << 2 << "key" << BSON("_id" << 1) << "name"
+                  << "_id_"),
+         BSON("v" << 2 << "key" << BSON("x" << 1 << "y" << 1) << "name"
+                  << "x_1_y_1")});
+    expCtx->mongoProcessInterface = processInterface;
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "a"_sd},
+                                         {"foreignField", "x"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource = DocumentSourceMock::createForTest({Document{{"a", 1}}}, expCtx);
+    lookup->setSource(mockLocalSource.get());
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"a", 1},
+                                 {"foreignDocs",
+                                  vector<Value>{Value(Document{{"_id", 0}, {"x", 1}})}}}));
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kNestedLoopJoin);
+    ASSERT_TRUE(lookup->getNext().isEOF());
+
+    vector<Value> explained;
+    lookup->serializeToArray(explained, ExplainOptions::Verbosity::kExecStats);
+    ASSERT_VALUE_EQ(explained[0]["$lookup"]["strategy"], Value("NestedLoopJoin"_sd));
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldIgnoreHiddenIndexesWhenChoosingHashJoin) {
+    const auto originalMaxForeignCount =
+        internalQueryLookupHashJoinMaxForeignCollectionCount.load();
+    internalQueryLookupHashJoinMaxForeignCollectionCount.store(100);
+    ON_BLOCK_EXIT([&] {
+        internalQueryLookupHashJoinMaxForeignCollectionCount.store(originalMaxForeignCount);
+    });
+
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    auto processInterface = std::make_shared<MockMongoInterface>(
+        deque<DocumentSource::GetNextResult>{Document{{"_id", 0}, {"x", 1}}});
+    processInterface->setRecordCount(1);
+    processInterface->setIndexSpecs({BSON("v" << 2 << "key" << BSON("x" << 1) << "name"
+                                              << "x_1"
+                                              << "hidden" << true)});
+    expCtx->mongoProcessInterface = processInterface;
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "a"_sd},
+                                         {"foreignField", "x"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource = DocumentSourceMock::createForTest({Document{{"a", 1}}}, expCtx);
+    lookup->setSource(mockLocalSource.get());
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"a", 1},
+                                 {"foreignDocs",
+                                  vector<Value>{Value(Document{{"_id", 0}, {"x", 1}})}}}));
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kHashJoin);
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldUseBatchedLoopJoinWhenBatchSizeIsSet) {
+    const auto originalBatchSize = internalQueryLookupBatchSize.load();
+    internalQueryLookupBatchSize.store(3);
+    ON_BLOCK_EXIT([&] { internalQueryLookupBatchSize.store(originalBatchSize); });
+
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    // The foreign collection cannot be counted, so neither an index nor a hash join is used. The
+    // $match on the local values of each batch is applied to the mocked foreign contents.
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}, {"x", 1}},
+        Document{{"_id", 1}, {"x", Value(vector<Value>{Value(1), Value(2), Value(1)})}},
+        Document{{"_id", 2}, {"x", 3}},
+        Document{{"_id", 3}}};
+    auto processInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+    expCtx->mongoProcessInterface = processInterface;
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "a"_sd},
+                                         {"foreignField", "x"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    // The first batch holds three documents, one of which is joined by its own foreign pipeline
+    // since its local value is null. The second batch is ended early by a pause.
+    auto mockLocalSource = DocumentSourceMock::createForTest(
+        {Document{{"a", 1}},
+         Document{{"a", Value(vector<Value>{Value(3), Value(2)})}},
+         Document{{"a", BSONNULL}},
+         Document{{"a", 4}},
+         Document{{"a", 1}},
+         DocumentSource::GetNextResult::makePauseExecution()},
+        expCtx);
+    lookup->setSource(mockLocalSource.get());
+
+    auto foreignIds = [](const Document& output) {
+        vector<Value> ids;
+        for (auto&& foreignDoc : output["foreignDocs"].getArray()) {
+            ids.push_back(foreignDoc["_id"]);
+        }
+        return Value(std::move(ids));
+    };
+
+    // The output is returned in input order, and each matching foreign document is returned once,
+    // in the order it was read from the foreign collection.
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(foreignIds(next.releaseDocument()), Value(vector<Value>{Value(0), Value(1)}));
+    ASSERT(lookup->getJoinStrategy() == DocumentSourceLookUp::JoinStrategy::kBatchedLoopJoin);
+    ASSERT_EQ(processInterface->getNumForeignPipelines(), 2);
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(foreignIds(next.releaseDocument()), Value(vector<Value>{Value(1), Value(2)}));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(foreignIds(next.releaseDocument()), Value(vector<Value>{Value(3)}));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       (Document{{"a", 4}, {"foreignDocs", vector<Value>{}}}));
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(foreignIds(next.releaseDocument()), Value(vector<Value>{Value(0), Value(1)}));
+    ASSERT_EQ(processInterface->getNumForeignPipelines(), 3);
+
+    ASSERT_TRUE(lookup->getNext().isPaused());
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    ASSERT_EQ(processInterface->getNumForeignPipelines(), 3);
+
+    vector<Value> explained;
+    lookup->serializeToArray(explained, ExplainOptions::Verbosity::kExecStats);
+    ASSERT_VALUE_EQ(explained[0]["$lookup"]["strategy"], Value("BatchedLoopJoin"_sd));
+    lookup->dispose();
+}
+
 TEST_F(DocumentSourceLookUpTest, LookupReportsAsFieldIsModified) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
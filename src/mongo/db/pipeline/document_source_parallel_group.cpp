@@ -0,0 +1,343 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_parallel_group.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/db/client.h"
+#include "mongo/db/hasher.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/service_context.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+namespace {
+// The number of ranges of hash values assigned to each consumer. Using several ranges per consumer
+// keeps the split balanced after the ranges holding the hashes of null and undefined are moved to
+// consumer 0.
+constexpr size_t kHashRangesPerConsumer = 4;
+
+long long hashValue(const BSONObj& obj) {
+    return BSONElementHasher::hash64(obj.firstElement(), BSONElementHasher::DEFAULT_HASH_SEED);
+}
+}  // namespace
+
+boost::optional<std::string> DocumentSourceParallelGroup::getPartitionField(
+    const DocumentSourceGroup& group) {
+    boost::optional<std::string> partitionField;
+    for (auto&& idField : group.getIdFields()) {
+        // Only a top-level field is read the same way by the exchange and by the $group. A dotted
+        // path would be traversed through arrays by the $group, but not by the exchange.
+        auto fieldPath = dynamic_cast<ExpressionFieldPath*>(idField.second.get());
+        if (!fieldPath || !fieldPath->isRootFieldPath() ||
+            fieldPath->getFieldPath().getPathLength() != 2) {
+            continue;
+        }
+
+        // Pick the same field whatever the order of the group key's fields.
+        auto fieldName = fieldPath->getFieldPath().getFieldName(1).toString();
+        if (!partitionField || fieldName < *partitionField) {
+            partitionField = std::move(fieldName);
+        }
+    }
+    return partitionField;
+}
+
+boost::intrusive_ptr<DocumentSourceParallelGroup> DocumentSourceParallelGroup::create(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::unique_ptr<Pipeline, PipelineDeleter> input,
+    boost::intrusive_ptr<DocumentSource> group,
+    std::string partitionField,
+    size_t nConsumers) {
+    return new DocumentSourceParallelGroup(
+        expCtx, std::move(input), std::move(group), std::move(partitionField), nConsumers);
+}
+
+DocumentSourceParallelGroup::DocumentSourceParallelGroup(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::unique_ptr<Pipeline, PipelineDeleter> input,
+    boost::intrusive_ptr<DocumentSource> group,
+    std::string partitionField,
+    size_t nConsumers)
+    : DocumentSource(kStageName, expCtx),
+      _ownedInputPipeline(std::move(input)),
+      _inputPipeline(_ownedInputPipeline.get()),
+      _partitionField(std::move(partitionField)),
+      _nConsumers(nConsumers) {
+    invariant(_nConsumers > 1);
+
+    std::vector<Value> serializedGroup;
+    group->serializeToArray(serializedGroup);
+    invariant(serializedGroup.size() == 1);
+    _groupSpec = serializedGroup.front().getDocument().toBson();
+}
+
+const char* DocumentSourceParallelGroup::getSourceName() const {
+    return kStageName.rawData();
+}
+
+Value DocumentSourceParallelGroup::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    return Value(DOC(getSourceName() << DOC(
+                         "consumers" << static_cast<long long>(_nConsumers) << "partitionField"
+                                     << _partitionField << "input"
+                                     << Value(_inputPipeline->serialize()) << "group"
+                                     << _groupSpec)));
+}
+
+bool DocumentSourceParallelGroup::usedDisk() {
+    return std::any_of(_consumerPipelines.begin(),
+                       _consumerPipelines.end(),
+                       [](const auto& pipeline) { return pipeline && pipeline->usedDisk(); });
+}
+
+void DocumentSourceParallelGroup::detachFromOperationContext() {
+    _inputPipeline->detachFromOperationContext();
+    for (auto&& pipeline : _consumerPipelines) {
+        if (pipeline) {
+            pipeline->detachFromOperationContext();
+        }
+    }
+}
+
+void DocumentSourceParallelGroup::reattachToOperationContext(OperationContext* opCtx) {
+    _inputPipeline->reattachToOperationContext(opCtx);
+    for (auto&& pipeline : _consumerPipelines) {
+        if (pipeline) {
+            pipeline->reattachToOperationContext(opCtx);
+        }
+    }
+}
+
+void DocumentSourceParallelGroup::doDispose() {
+    if (_ownedInputPipeline) {
+        _ownedInputPipeline.get_deleter().dismissDisposal();
+        _ownedInputPipeline->dispose(pExpCtx->opCtx);
+    }
+
+    // Disposing of the last consumer also disposes of the input of the exchange.
+    for (auto&& pipeline : _consumerPipelines) {
+        if (pipeline) {
+            pipeline.get_deleter().dismissDisposal();
+            pipeline->dispose(pExpCtx->opCtx);
+        }
+    }
+}
+
+DocumentSource::GetNextResult DocumentSourceParallelGroup::doGetNext() {
+    if (!_exchange) {
+        runConsumers();
+    }
+
+    while (_currentConsumer < _nConsumers) {
+        if (!_returnedFirstResult) {
+            _returnedFirstResult = true;
+            auto& firstResult = _firstResults[_currentConsumer];
+            if (firstResult.isAdvanced()) {
+                return std::move(firstResult);
+            }
+        } else {
+            auto next = _consumerPipelines[_currentConsumer]->getSources().back()->getNext();
+            if (next.isAdvanced()) {
+                return next;
+            }
+        }
+
+        // This consumer has returned all of its groups.
+        ++_currentConsumer;
+        _returnedFirstResult = false;
+    }
+    return GetNextResult::makeEOF();
+}
+
+ExchangeSpec DocumentSourceParallelGroup::makeExchangeSpec() const {
+    // Split the range of hash values into equal ranges, assigned to the consumers in turn. The
+    // exchange sends the documents which don't have '_partitionField' to consumer 0, so the ranges
+    // holding the hashes of null and undefined go to consumer 0 as well, since the group key may
+    // not distinguish these values.
+    const size_t nRanges = _nConsumers * kHashRangesPerConsumer;
+    const uint64_t rangeWidth = std::numeric_limits<uint64_t>::max() / nRanges + 1;
+    const uint64_t minHash = static_cast<uint64_t>(std::numeric_limits<long long>::min());
+    auto getRange = [&](long long hash) {
+        return (static_cast<uint64_t>(hash) - minHash) / rangeWidth;
+    };
+
+    std::vector<BSONObj> boundaries{BSON(_partitionField << MINKEY)};
+    std::vector<int32_t> consumerIds;
+    for (size_t range = 0; range < nRanges; ++range) {
+        if (range > 0) {
+            boundaries.push_back(
+                BSON(_partitionField << static_cast<long long>(minHash + range * rangeWidth)));
+        }
+        consumerIds.push_back(range % _nConsumers);
+    }
+    boundaries.push_back(BSON(_partitionField << MAXKEY));
+    consumerIds[getRange(hashValue(BSON("" << BSONNULL)))] = 0;
+    consumerIds[getRange(hashValue(BSON("" << BSONUndefined)))] = 0;
+
+    ExchangeSpec spec;
+    spec.setPolicy(ExchangePolicyEnum::kKeyRange);
+    spec.setConsumers(_nConsumers);
+    spec.setKey(BSON(_partitionField << "hashed"));
+    spec.setBoundaries(std::move(boundaries));
+    spec.setConsumerIds(std::move(consumerIds));
+    return spec;
+}
+
+void DocumentSourceParallelGroup::runConsumers() {
+    auto opCtx = pExpCtx->opCtx;
+
+    // Each consumer needs an ExpressionContext of its own, since the consumers run concurrently.
+    // They must be made before creating the exchange, which detaches our ExpressionContext from
+    // 'opCtx' along with the input pipeline.
+    std::vector<boost::intrusive_ptr<ExpressionContext>> consumerExpCtxs;
+    for (size_t consumerId = 0; consumerId < _nConsumers; ++consumerId) {
+        consumerExpCtxs.push_back(pExpCtx->copyWith(pExpCtx->ns, pExpCtx->uuid));
+    }
+
+    _exchange = new Exchange(makeExchangeSpec(), std::move(_ownedInputPipeline));
+
+    for (auto&& consumerExpCtx : consumerExpCtxs) {
+        const auto consumerId = _consumerPipelines.size();
+        _consumerPipelines.push_back(Pipeline::create(
+            {new DocumentSourceExchange(consumerExpCtx, _exchange, consumerId, nullptr),
+             DocumentSourceGroup::createFromBson(_groupSpec.firstElement(), consumerExpCtx)},
+            consumerExpCtx));
+        _consumerPipelines.back()->detachFromOperationContext();
+    }
+    _firstResults.resize(_nConsumers, GetNextResult::makeEOF());
+    _consumerOpCtxs.resize(_nConsumers, nullptr);
+
+    ThreadPool::Options options;
+    options.poolName = "ParallelGroup";
+    options.threadNamePrefix = "ParallelGroupConsumer";
+    options.minThreads = _nConsumers;
+    options.maxThreads = _nConsumers;
+    options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
+    ThreadPool pool(options);
+    pool.startup();
+
+    // Every consumer gets a thread of its own, since the exchange stops reading the input when a
+    // consumer's buffer is full, until that consumer catches up.
+    for (size_t consumerId = 0; consumerId < _nConsumers; ++consumerId) {
+        pool.schedule([this, consumerId](auto status) {
+            if (!status.isOK()) {
+                stdx::lock_guard<Latch> lk(_mutex);
+                if (_firstError.isOK()) {
+                    _firstError = status;
+                }
+                killConsumers(lk);
+                ++_nFinishedConsumers;
+                _consumerFinished.notify_all();
+                return;
+            }
+            runConsumer(consumerId);
+        });
+    }
+
+    {
+        stdx::unique_lock<Latch> lk(_mutex);
+        auto allFinished = [&] { return _nFinishedConsumers == _nConsumers; };
+        try {
+            opCtx->waitForConditionOrInterrupt(_consumerFinished, lk, allFinished);
+        } catch (const DBException& ex) {
+            // This operation was interrupted, so stop the consumers before unwinding.
+            if (_firstError.isOK()) {
+                _firstError = ex.toStatus();
+            }
+            killConsumers(lk);
+            _consumerFinished.wait(lk, allFinished);
+        }
+    }
+    pool.shutdown();
+    pool.join();
+
+    _inputPipeline->reattachToOperationContext(opCtx);
+    for (auto&& pipeline : _consumerPipelines) {
+        if (pipeline) {
+            pipeline->reattachToOperationContext(opCtx);
+        }
+    }
+    uassertStatusOK(_firstError);
+}
+
+void DocumentSourceParallelGroup::runConsumer(size_t consumerId) {
+    auto opCtx = cc().makeOperationContext();
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _consumerOpCtxs[consumerId] = opCtx.get();
+        if (_killed) {
+            killConsumers(lk);
+        }
+    }
+
+    auto& pipeline = _consumerPipelines[consumerId];
+    try {
+        // The $group reads all of its input before returning its first result.
+        pipeline->reattachToOperationContext(opCtx.get());
+        _firstResults[consumerId] = pipeline->getSources().back()->getNext();
+        pipeline->detachFromOperationContext();
+    } catch (const DBException& ex) {
+        // Dispose of this consumer here, so that the exchange stops waiting for it, and so that
+        // the input is disposed of on this operation if this consumer failed while loading it.
+        pipeline.get_deleter().dismissDisposal();
+        pipeline->dispose(opCtx.get());
+        pipeline.reset();
+
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (_firstError.isOK()) {
+            _firstError = ex.toStatus();
+        }
+        killConsumers(lk);
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    _consumerOpCtxs[consumerId] = nullptr;
+    ++_nFinishedConsumers;
+    _consumerFinished.notify_all();
+}
+
+void DocumentSourceParallelGroup::killConsumers(WithLock) {
+    _killed = true;
+    for (auto consumerOpCtx : _consumerOpCtxs) {
+        if (consumerOpCtx) {
+            stdx::lock_guard<Client> clientLock(*consumerOpCtx->getClient());
+            consumerOpCtx->getServiceContext()->killOperation(
+                clientLock, consumerOpCtx, ErrorCodes::Interrupted);
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,177 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/document_source_exchange.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+
+namespace mongo {
+
+class DocumentSourceGroup;
+
+/**
+ * Runs a $group across several threads. The input of the $group is split by a hash of one of the
+ * group key's fields, using an Exchange, so that all the documents of a group go to the same
+ * consumer. Each consumer runs its own copy of the $group on a thread of its own, and this stage
+ * then returns the groups of each consumer in turn.
+ *
+ * This stage replaces the $group and every stage before it. It is never parsed, and is only
+ * created by PipelineD::parallelizeGroup() when mongod sets up the execution of an aggregation.
+ */
+class DocumentSourceParallelGroup final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalParallelGroup"_sd;
+
+    /**
+     * Returns the name of a top-level field which is part of the group key of 'group', or
+     * boost::none if there is no such field. Documents in the same group have equal values for
+     * this field, except that the group key may not distinguish null, undefined and missing.
+     */
+    static boost::optional<std::string> getPartitionField(const DocumentSourceGroup& group);
+
+    /**
+     * Creates a stage which runs 'group' over the output of 'input' using 'nConsumers' consumers,
+     * partitioning the documents by the value of 'partitionField'.
+     */
+    static boost::intrusive_ptr<DocumentSourceParallelGroup> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        std::unique_ptr<Pipeline, PipelineDeleter> input,
+        boost::intrusive_ptr<DocumentSource> group,
+        std::string partitionField,
+        size_t nConsumers);
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kBlocking,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kNone,
+                                     DiskUseRequirement::kWritesTmpData,
+                                     FacetRequirement::kNotAllowed,
+                                     TransactionRequirement::kNotAllowed,
+                                     LookupRequirement::kNotAllowed,
+                                     UnionRequirement::kNotAllowed);
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    boost::optional<DistributedPlanLogic> distributedPlanLogic() final {
+        return boost::none;
+    }
+
+    const char* getSourceName() const final;
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    bool usedDisk() final;
+
+    /**
+     * Returns the pipeline of the stages which this stage replaced before the $group.
+     */
+    const Pipeline* getInputPipeline() const {
+        return _inputPipeline;
+    }
+
+    void detachFromOperationContext() final;
+
+    void reattachToOperationContext(OperationContext* opCtx) final;
+
+protected:
+    GetNextResult doGetNext() final;
+    void doDispose() final;
+
+private:
+    DocumentSourceParallelGroup(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                std::unique_ptr<Pipeline, PipelineDeleter> input,
+                                boost::intrusive_ptr<DocumentSource> group,
+                                std::string partitionField,
+                                size_t nConsumers);
+
+    /**
+     * Returns the exchange spec which sends each document to a consumer based on a hash of
+     * '_partitionField'.
+     */
+    ExchangeSpec makeExchangeSpec() const;
+
+    /**
+     * Creates the consumer pipelines, and runs each of them on its own thread until its $group has
+     * consumed all of its input. Throws the first error that any of the consumers hit.
+     */
+    void runConsumers();
+
+    /**
+     * Runs the pipeline of consumer 'consumerId' until it returns its first result.
+     */
+    void runConsumer(size_t consumerId);
+
+    /**
+     * Interrupts the operations of the consumers which are still running. Must be called with
+     * '_mutex' held.
+     */
+    void killConsumers(WithLock);
+
+    // The stages before the $group, which are the input of the exchange. Once the exchange has been
+    // created, it owns this pipeline and '_inputPipeline' is only used to reattach it to this
+    // stage's operation context.
+    std::unique_ptr<Pipeline, PipelineDeleter> _ownedInputPipeline;
+    Pipeline* _inputPipeline;
+
+    // The specification of the $group. Each consumer parses its own copy of the $group from it.
+    BSONObj _groupSpec;
+
+    // The top-level field of the documents whose value is used to choose their consumer.
+    const std::string _partitionField;
+
+    const size_t _nConsumers;
+
+    boost::intrusive_ptr<Exchange> _exchange;
+
+    // Each consumer's pipeline is an $_internalExchange stage followed by a copy of the $group.
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> _consumerPipelines;
+
+    // The first result of each consumer, obtained on the consumer's thread.
+    std::vector<GetNextResult> _firstResults;
+
+    // The consumer whose results are being returned, and whether its first result has been.
+    size_t _currentConsumer = 0;
+    bool _returnedFirstResult = false;
+
+    // Synchronizes the consumer threads with the thread executing the query.
+    Mutex _mutex = MONGO_MAKE_LATCH("DocumentSourceParallelGroup::_mutex");
+    stdx::condition_variable _consumerFinished;
+    size_t _nFinishedConsumers = 0;
+    Status _firstError = Status::OK();
+    bool _killed = false;
+    std::vector<OperationContext*> _consumerOpCtxs;
+};
+
+}  // namespace mongo
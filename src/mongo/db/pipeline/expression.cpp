@@ -2683,9 +2683,15 @@ Value ExpressionMeta::evaluate(const Document& root, Variables* variables) const
             // Be sure that a RecordId can be represented by a long long.
             static_assert(RecordId::kMinRepr >= std::numeric_limits<long long>::min());
             static_assert(RecordId::kMaxRepr <= std::numeric_limits<long long>::max());
-            return metadata.hasRecordId()
-                ? Value{static_cast<long long>(metadata.getRecordId().repr())}
-                : Value();
+            if (!metadata.hasRecordId()) {
+                return Value();
+            }
+            // The RecordId of a document in a clustered collection is a string of bytes.
+            if (metadata.getRecordId().isStr()) {
+                const auto str = metadata.getRecordId().getStr();
+                return Value{BSONBinData(str.rawData(), str.size(), BinDataGeneral)};
+            }
+            return Value{static_cast<long long>(metadata.getRecordId().repr())};
         case MetaType::kIndexKey:
             return metadata.hasIndexKey() ? Value(metadata.getIndexKey()) : Value();
         case MetaType::kSortKey:
@@ -60,6 +60,7 @@
 #include "mongo/db/pipeline/document_source_geo_near_cursor.h"
 #include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/document_source_parallel_group.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
@@ -78,6 +79,7 @@
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/rpc/metadata/client_metadata_ismaster.h"
 #include "mongo/s/query/document_source_merge_cursors.h"
+#include "mongo/util/string_map.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
@@ -446,6 +448,51 @@ boost::optional<long long> extractLimitForPushdown(Pipeline* pipeline) {
     return limit;
 }
 
+/**
+ * Returns true if 'expr' is a constant or a path to a top-level field of the input documents.
+ */
+bool isConstantOrTopLevelField(const Expression* expr) {
+    if (dynamic_cast<const ExpressionConstant*>(expr)) {
+        return true;
+    }
+    auto fieldPath = dynamic_cast<const ExpressionFieldPath*>(expr);
+    return fieldPath && fieldPath->isRootFieldPath() &&
+        fieldPath->getFieldPath().getPathLength() == 2;
+}
+
+/**
+ * Returns true if the output of 'pipeline' is the same whether the fields its input documents lack
+ * are missing or null. This is the case if the pipeline begins with a $group whose key is a
+ * constant or a top-level field, since a missing key is grouped as null, and whose accumulators are
+ * $sum, $avg, $min or $max of a constant or a top-level field, since they ignore both.
+ *
+ * A covered scan of a whole index produces a null value for each indexed field a document lacks,
+ * so it can only provide the input of such a pipeline.
+ */
+bool groupTreatsMissingFieldsAsNull(const Pipeline* pipeline) {
+    static const StringDataSet kAccumulators{"$sum", "$avg", "$min", "$max"};
+
+    auto group = dynamic_cast<DocumentSourceGroup*>(pipeline->peekFront());
+    if (!group) {
+        return false;
+    }
+
+    // A key with several fields keeps the fields which are missing out of the group's _id.
+    auto idFields = group->getIdFields();
+    if (idFields.size() != 1 || idFields.begin()->first != "_id" ||
+        !isConstantOrTopLevelField(idFields.begin()->second.get())) {
+        return false;
+    }
+
+    for (auto&& accumulatedField : group->getAccumulatedFields()) {
+        if (!kAccumulators.count(accumulatedField.makeAccumulator()->getOpName()) ||
+            !isConstantOrTopLevelField(accumulatedField.expr.argument.get())) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * Given a dependency set and a pipeline, builds a projection BSON object to push down into the
  * PlanStage layer. The rules to push down the projection are as follows:
@@ -694,6 +741,12 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
         // projection at the front of the pipeline, it will be removed and handled by the PlanStage
         // layer. If a projection cannot be pushed down, an empty BSONObj will be returned.
         projObj = buildProjectionForPushdown(deps, pipeline);
+
+        // Without a filter, the planner only considers a COLLSCAN. If the pipeline needs just the
+        // fields of an index, let it scan the whole index instead, without fetching any document.
+        if (queryObj.isEmpty() && groupTreatsMissingFieldsAsNull(pipeline)) {
+            plannerOpts |= QueryPlannerParams::GENERATE_COVERED_IXSCANS;
+        }
     }
 
     if (rewrittenGroupStage) {
@@ -761,12 +814,63 @@ Timestamp PipelineD::getLatestOplogTimestamp(const Pipeline* pipeline) {
     return Timestamp();
 }
 
+void PipelineD::parallelizeGroup(Pipeline* pipeline, size_t nConsumers) {
+    invariant(nConsumers > 1);
+    const auto& expCtx = pipeline->getContext();
+    auto& sources = pipeline->_sources;
+
+    // The exchange which splits the input hashes the values of the group key without a collation.
+    if (expCtx->getCollator() || sources.empty() ||
+        !dynamic_cast<DocumentSourceCursor*>(sources.front().get())) {
+        return;
+    }
+
+    auto groupIt = std::find_if(sources.begin(), sources.end(), [](const auto& stage) {
+        return dynamic_cast<DocumentSourceGroup*>(stage.get());
+    });
+    if (groupIt == sources.end()) {
+        return;
+    }
+    auto partitionField = DocumentSourceParallelGroup::getPartitionField(
+        static_cast<const DocumentSourceGroup&>(**groupIt));
+    if (!partitionField) {
+        return;
+    }
+
+    // The stages before the $group run on the consumers' threads, so they may not read from other
+    // collections.
+    stdx::unordered_set<NamespaceString> involvedNamespaces;
+    for (auto it = sources.begin(); it != groupIt; ++it) {
+        (*it)->addInvolvedCollections(&involvedNamespaces);
+    }
+    if (!involvedNamespaces.empty()) {
+        return;
+    }
+
+    Pipeline::SourceContainer inputSources(sources.begin(), groupIt);
+    auto group = *groupIt;
+    sources.erase(sources.begin(), std::next(groupIt));
+    sources.push_front(
+        DocumentSourceParallelGroup::create(expCtx,
+                                            Pipeline::create(std::move(inputSources), expCtx),
+                                            std::move(group),
+                                            std::move(*partitionField),
+                                            nConsumers));
+    pipeline->stitch();
+}
+
 std::string PipelineD::getPlanSummaryStr(const Pipeline* pipeline) {
     if (auto docSourceCursor =
             dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
         return docSourceCursor->getPlanSummaryStr();
     }
 
+    // The $cursor stage of a parallelized $group is part of the $group's input.
+    if (auto parallelGroup =
+            dynamic_cast<DocumentSourceParallelGroup*>(pipeline->_sources.front().get())) {
+        return getPlanSummaryStr(parallelGroup->getInputPipeline());
+    }
+
     return "";
 }
 
@@ -776,6 +880,9 @@ void PipelineD::getPlanSummaryStats(const Pipeline* pipeline, PlanSummaryStats*
     if (auto docSourceCursor =
             dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
         *statsOut = docSourceCursor->getPlanSummaryStats();
+    } else if (auto parallelGroup = dynamic_cast<DocumentSourceParallelGroup*>(
+                   pipeline->_sources.front().get())) {
+        getPlanSummaryStats(parallelGroup->getInputPipeline(), statsOut);
     }
 
     for (auto&& source : pipeline->_sources) {
@@ -117,6 +117,14 @@ public:
                                                            const AggregationRequest* aggRequest,
                                                            Pipeline* pipeline);
 
+    /**
+     * If the first $group of 'pipeline' can be split across 'nConsumers' threads, replaces it and
+     * the stages before it with a $_internalParallelGroup stage which does so. Must be called after
+     * the $cursor stage has been attached to 'pipeline'. The caller is responsible for checking
+     * that the operation may run parts of the pipeline on other threads, which use operations of
+     * their own.
+     */
+    static void parallelizeGroup(Pipeline* pipeline, size_t nConsumers);
 
     static std::string getPlanSummaryStr(const Pipeline* pipeline);
 
@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/pipeline_result_cache.h"
+
+#include <limits>
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+namespace {
+
+const auto getPipelineResultCache = ServiceContext::declareDecoration<PipelineResultCache>();
+
+Counter64 pipelineResultCacheHits;
+Counter64 pipelineResultCacheMisses;
+Counter64 pipelineResultCacheEvictions;
+
+ServerStatusMetricField<Counter64> displayPipelineResultCacheHits("query.pipelineResultCache.hits",
+                                                                  &pipelineResultCacheHits);
+ServerStatusMetricField<Counter64> displayPipelineResultCacheMisses(
+    "query.pipelineResultCache.misses", &pipelineResultCacheMisses);
+ServerStatusMetricField<Counter64> displayPipelineResultCacheEvictions(
+    "query.pipelineResultCache.evictions", &pipelineResultCacheEvictions);
+
+}  // namespace
+
+PipelineResultCache& PipelineResultCache::get(ServiceContext* serviceContext) {
+    return getPipelineResultCache(serviceContext);
+}
+
+PipelineResultCache::PipelineResultCache() : _cache(std::numeric_limits<size_t>::max()) {}
+
+boost::optional<std::vector<BSONObj>> PipelineResultCache::lookup(const std::string& key,
+                                                                  const Version& version) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto it = _cache.find(key);
+    if (it == _cache.end()) {
+        pipelineResultCacheMisses.increment();
+        return boost::none;
+    }
+
+    if (it->second.version != version) {
+        // The data has changed since the results were computed, so they can never be served again.
+        _erase(lk, it);
+        pipelineResultCacheMisses.increment();
+        return boost::none;
+    }
+
+    pipelineResultCacheHits.increment();
+    return it->second.results;
+}
+
+void PipelineResultCache::add(const std::string& key,
+                              Version version,
+                              std::vector<BSONObj> results,
+                              size_t maxSizeBytes,
+                              size_t maxEntrySizeBytes) {
+    size_t entrySizeBytes = key.size();
+    for (auto&& result : results) {
+        entrySizeBytes += result.objsize();
+    }
+    if (entrySizeBytes > maxEntrySizeBytes || entrySizeBytes > maxSizeBytes) {
+        return;
+    }
+
+    for (auto&& result : results) {
+        result = result.getOwned();
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto it = _cache.find(key);
+    if (it != _cache.end()) {
+        _erase(lk, it);
+    }
+
+    _cache.add(key, Entry{std::move(version), std::move(results), entrySizeBytes});
+    _sizeBytes += entrySizeBytes;
+
+    while (_sizeBytes > maxSizeBytes) {
+        _erase(lk, std::prev(_cache.end()));
+        pipelineResultCacheEvictions.increment();
+    }
+}
+
+void PipelineResultCache::clear() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _cache.clear();
+    _sizeBytes = 0;
+}
+
+size_t PipelineResultCache::size() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _cache.size();
+}
+
+size_t PipelineResultCache::sizeBytes() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _sizeBytes;
+}
+
+void PipelineResultCache::_erase(WithLock, LRUCache<std::string, Entry>::iterator it) {
+    invariant(_sizeBytes >= it->second.sizeBytes);
+    _sizeBytes -= it->second.sizeBytes;
+    _cache.erase(it);
+}
+
+}  // namespace mongo
@@ -0,0 +1,135 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/lru_cache.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+class ServiceContext;
+
+/**
+ * A cache of the results of aggregations run on mongod, which answers an aggregation identical to
+ * one which ran before without running its pipeline again.
+ *
+ * The results of an aggregation are cached along with the version of the data they were computed
+ * from: the epoch of the collection catalog, and the number of committed writes to each of the
+ * collections the aggregation reads from, as counted by CollectionQueryInfo. The results can be
+ * served for as long as that version is current. The version must be read before the aggregation
+ * opens its snapshot, so that a write which commits concurrently always makes the results stale.
+ *
+ * The cache evicts the least recently used results once their total size exceeds a given budget.
+ */
+class PipelineResultCache {
+public:
+    /**
+     * The version of the data read by an aggregation.
+     */
+    struct Version {
+        bool operator==(const Version& other) const {
+            return catalogEpoch == other.catalogEpoch && writeCounts == other.writeCounts;
+        }
+
+        bool operator!=(const Version& other) const {
+            return !(*this == other);
+        }
+
+        uint64_t catalogEpoch = 0;
+
+        // The UUID and write count of each collection read from.
+        std::vector<std::pair<UUID, uint64_t>> writeCounts;
+    };
+
+    static PipelineResultCache& get(ServiceContext* serviceContext);
+
+    PipelineResultCache(const PipelineResultCache&) = delete;
+    PipelineResultCache& operator=(const PipelineResultCache&) = delete;
+
+    PipelineResultCache();
+
+    /**
+     * Returns the results cached under the given 'key' if they were computed at the given
+     * 'version', or boost::none otherwise. Results computed at another version are removed.
+     */
+    boost::optional<std::vector<BSONObj>> lookup(const std::string& key, const Version& version);
+
+    /**
+     * Caches the given 'results', computed at the given 'version', under the given 'key',
+     * replacing any results previously cached under this key. Then evicts the least recently used
+     * results until the total size of the cached results is at most 'maxSizeBytes'. Results which
+     * are larger than 'maxEntrySizeBytes' are not cached.
+     */
+    void add(const std::string& key,
+             Version version,
+             std::vector<BSONObj> results,
+             size_t maxSizeBytes,
+             size_t maxEntrySizeBytes);
+
+    /**
+     * Removes all cached results.
+     */
+    void clear();
+
+    /**
+     * Returns the number of cached results.
+     */
+    size_t size() const;
+
+    /**
+     * Returns the total size in bytes of the cached results and their keys.
+     */
+    size_t sizeBytes() const;
+
+private:
+    struct Entry {
+        Version version;
+        std::vector<BSONObj> results;
+        size_t sizeBytes = 0;
+    };
+
+    void _erase(WithLock, LRUCache<std::string, Entry>::iterator it);
+
+    // Protects the members below.
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("PipelineResultCache::_mutex");
+
+    // The cache is bounded by the size of its entries rather than by their number.
+    LRUCache<std::string, Entry> _cache;
+    size_t _sizeBytes = 0;
+};
+
+}  // namespace mongo
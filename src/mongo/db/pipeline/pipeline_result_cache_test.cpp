@@ -0,0 +1,164 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <limits>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/pipeline_result_cache.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const size_t kNoLimit = std::numeric_limits<size_t>::max();
+
+PipelineResultCache::Version makeVersion(uint64_t catalogEpoch,
+                                         std::vector<std::pair<UUID, uint64_t>> writeCounts) {
+    PipelineResultCache::Version version;
+    version.catalogEpoch = catalogEpoch;
+    version.writeCounts = std::move(writeCounts);
+    return version;
+}
+
+std::vector<BSONObj> makeResults(int n) {
+    std::vector<BSONObj> results;
+    for (int i = 0; i < n; ++i) {
+        results.push_back(BSON("_id" << i));
+    }
+    return results;
+}
+
+void assertResultsEq(const boost::optional<std::vector<BSONObj>>& actual,
+                     const std::vector<BSONObj>& expected) {
+    ASSERT(actual);
+    ASSERT_EQ(actual->size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_BSONOBJ_EQ((*actual)[i], expected[i]);
+    }
+}
+
+TEST(PipelineResultCacheTest, ServesResultsComputedAtTheSameVersion) {
+    PipelineResultCache cache;
+    const auto uuid = UUID::gen();
+    ASSERT_FALSE(cache.lookup("a", makeVersion(1, {{uuid, 0}})));
+
+    cache.add("a", makeVersion(1, {{uuid, 0}}), makeResults(3), kNoLimit, kNoLimit);
+    assertResultsEq(cache.lookup("a", makeVersion(1, {{uuid, 0}})), makeResults(3));
+    assertResultsEq(cache.lookup("a", makeVersion(1, {{uuid, 0}})), makeResults(3));
+    ASSERT_FALSE(cache.lookup("b", makeVersion(1, {{uuid, 0}})));
+    ASSERT_EQ(cache.size(), 1U);
+}
+
+TEST(PipelineResultCacheTest, RemovesResultsComputedAtAnotherVersion) {
+    PipelineResultCache cache;
+    const auto uuid = UUID::gen();
+    const auto otherUuid = UUID::gen();
+    const auto version = makeVersion(1, {{uuid, 5}, {otherUuid, 2}});
+
+    // A write to one of the collections makes the results stale.
+    cache.add("a", version, makeResults(1), kNoLimit, kNoLimit);
+    ASSERT_FALSE(cache.lookup("a", makeVersion(1, {{uuid, 5}, {otherUuid, 3}})));
+    ASSERT_EQ(cache.size(), 0U);
+    ASSERT_EQ(cache.sizeBytes(), 0U);
+
+    // So does reopening the catalog, even if the write counts are the same.
+    cache.add("a", version, makeResults(1), kNoLimit, kNoLimit);
+    ASSERT_FALSE(cache.lookup("a", makeVersion(2, {{uuid, 5}, {otherUuid, 2}})));
+    ASSERT_FALSE(cache.lookup("a", version));
+}
+
+TEST(PipelineResultCacheTest, AddReplacesResultsUnderTheSameKey) {
+    PipelineResultCache cache;
+    const auto uuid = UUID::gen();
+    cache.add("a", makeVersion(1, {{uuid, 0}}), makeResults(1), kNoLimit, kNoLimit);
+    const auto sizeBytes = cache.sizeBytes();
+
+    cache.add("a", makeVersion(1, {{uuid, 1}}), makeResults(2), kNoLimit, kNoLimit);
+    ASSERT_EQ(cache.size(), 1U);
+    ASSERT_GT(cache.sizeBytes(), sizeBytes);
+    ASSERT_FALSE(cache.lookup("a", makeVersion(1, {{uuid, 0}})));
+
+    cache.add("a", makeVersion(1, {{uuid, 1}}), makeResults(2), kNoLimit, kNoLimit);
+    assertResultsEq(cache.lookup("a", makeVersion(1, {{uuid, 1}})), makeResults(2));
+}
+
+TEST(PipelineResultCacheTest, EvictsLeastRecentlyUsedResultsOverTheSizeBudget) {
+    PipelineResultCache cache;
+    const auto version = makeVersion(1, {{UUID::gen(), 0}});
+
+    // Each entry is its one-byte key plus a document of 14 bytes.
+    const size_t entrySizeBytes = 1 + makeResults(1)[0].objsize();
+    const size_t maxSizeBytes = 3 * entrySizeBytes;
+    cache.add("a", version, makeResults(1), maxSizeBytes, kNoLimit);
+    cache.add("b", version, makeResults(1), maxSizeBytes, kNoLimit);
+    cache.add("c", version, makeResults(1), maxSizeBytes, kNoLimit);
+    ASSERT_EQ(cache.size(), 3U);
+    ASSERT_EQ(cache.sizeBytes(), maxSizeBytes);
+
+    // Using "a" makes "b" the least recently used entry.
+    ASSERT(cache.lookup("a", version));
+    cache.add("d", version, makeResults(1), maxSizeBytes, kNoLimit);
+    ASSERT_EQ(cache.size(), 3U);
+    ASSERT_FALSE(cache.lookup("b", version));
+    ASSERT(cache.lookup("a", version));
+    ASSERT(cache.lookup("c", version));
+    ASSERT(cache.lookup("d", version));
+
+    // A larger entry evicts as many entries as it needs to.
+    cache.add("e", version, makeResults(2), maxSizeBytes, kNoLimit);
+    ASSERT_EQ(cache.size(), 2U);
+    ASSERT_LTE(cache.sizeBytes(), maxSizeBytes);
+    ASSERT(cache.lookup("d", version));
+    ASSERT(cache.lookup("e", version));
+}
+
+TEST(PipelineResultCacheTest, DoesNotCacheResultsLargerThanTheEntrySizeLimit) {
+    PipelineResultCache cache;
+    const auto version = makeVersion(1, {{UUID::gen(), 0}});
+    const size_t maxEntrySizeBytes = 1 + makeResults(1)[0].objsize();
+
+    cache.add("a", version, makeResults(1), kNoLimit, maxEntrySizeBytes);
+    cache.add("b", version, makeResults(2), kNoLimit, maxEntrySizeBytes);
+    ASSERT(cache.lookup("a", version));
+    ASSERT_FALSE(cache.lookup("b", version));
+
+    // Results larger than the whole cache don't evict anything.
+    cache.add("c", version, makeResults(2), maxEntrySizeBytes, kNoLimit);
+    ASSERT_EQ(cache.size(), 1U);
+    ASSERT(cache.lookup("a", version));
+
+    cache.clear();
+    ASSERT_EQ(cache.size(), 0U);
+    ASSERT_EQ(cache.sizeBytes(), 0U);
+}
+
+}  // namespace
+}  // namespace mongo
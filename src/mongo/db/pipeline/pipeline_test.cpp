@@ -916,6 +916,142 @@ TEST(PipelineOptimizationTest, LookupDoesNotAbsorbUnwindOnSubfieldOfAsButStillMo
     assertPipelineOptimizesTo(inputPipe, outputPipe);
 }
 
+TEST(PipelineOptimizationTest, LookupShouldSwapWithTopKSortNotOnAs) {
+    string inputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$sort: {a: -1}}, "
+        " {$limit: 20}]";
+    string outputPipe =
+        "[{$sort: {sortKey: {a: -1}, limit: 20}}, "
+        " {$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}]";
+    string serializedPipe =
+        "[{$sort: {a: -1}}, "
+        " {$limit: 20}, "
+        " {$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}]";
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
+TEST(PipelineOptimizationTest, TopKSortShouldSwapWithSeveralLookups) {
+    string inputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$lookup: {from: 'lookupColl', as: 'w', localField: 'y', foreignField: 'z'}}, "
+        " {$sort: {a: 1}}, "
+        " {$limit: 20}]";
+    string outputPipe =
+        "[{$sort: {sortKey: {a: 1}, limit: 20}}, "
+        " {$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$lookup: {from: 'lookupColl', as: 'w', localField: 'y', foreignField: 'z'}}]";
+    string serializedPipe =
+        "[{$sort: {a: 1}}, "
+        " {$limit: 20}, "
+        " {$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$lookup: {from: 'lookupColl', as: 'w', localField: 'y', foreignField: 'z'}}]";
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
+TEST(PipelineOptimizationTest, LookupShouldNotSwapWithTopKSortOnAs) {
+    string inputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$sort: {'x.a': 1}}, "
+        " {$limit: 20}]";
+    string outputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$sort: {sortKey: {'x.a': 1}, limit: 20}}]";
+    string serializedPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$sort: {'x.a': 1}}, "
+        " {$limit: 20}]";
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
+TEST(PipelineOptimizationTest, LookupShouldNotSwapWithSortWithoutLimit) {
+    string inputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$sort: {a: 1}}]";
+    string outputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$sort: {sortKey: {a: 1}}}]";
+    string serializedPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$sort: {a: 1}}]";
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
+TEST(PipelineOptimizationTest, LookupWithUnwindPreservingNullAndEmptyArraysCopiesTopKSortAhead) {
+    string inputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$unwind: {path: '$x', preserveNullAndEmptyArrays: true}}, "
+        " {$sort: {a: 1}}, "
+        " {$limit: 20}]";
+    string outputPipe =
+        "[{$sort: {sortKey: {a: 1}, limit: 20}}, "
+        " {$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z', "
+        "            unwinding: {preserveNullAndEmptyArrays: true}}}, "
+        " {$sort: {sortKey: {a: 1}, limit: 20}}]";
+    string serializedPipe =
+        "[{$sort: {a: 1}}, "
+        " {$limit: 20}, "
+        " {$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$unwind: {path: '$x', preserveNullAndEmptyArrays: true}}, "
+        " {$sort: {a: 1}}, "
+        " {$limit: 20}]";
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
+TEST(PipelineOptimizationTest, LookupWithUnwindPreservingNullAndEmptyArraysCopiesLimitAhead) {
+    string inputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$unwind: {path: '$x', preserveNullAndEmptyArrays: true}}, "
+        " {$limit: 20}]";
+    string outputPipe =
+        "[{$limit: 20}, "
+        " {$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z', "
+        "            unwinding: {preserveNullAndEmptyArrays: true}}}, "
+        " {$limit: 20}]";
+    string serializedPipe =
+        "[{$limit: 20}, "
+        " {$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$unwind: {path: '$x', preserveNullAndEmptyArrays: true}}, "
+        " {$limit: 20}]";
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
+TEST(PipelineOptimizationTest, LookupWithUnwindNotPreservingNullAndEmptyArraysKeepsTopKSort) {
+    string inputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$unwind: {path: '$x'}}, "
+        " {$sort: {a: 1}}, "
+        " {$limit: 20}]";
+    string outputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z', "
+        "            unwinding: {preserveNullAndEmptyArrays: false}}}, "
+        " {$sort: {sortKey: {a: 1}, limit: 20}}]";
+    string serializedPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$unwind: {path: '$x'}}, "
+        " {$sort: {a: 1}}, "
+        " {$limit: 20}]";
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
+TEST(PipelineOptimizationTest, LookupWithUnwindIncludingArrayIndexKeepsTopKSortOnIndex) {
+    string inputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$unwind: {path: '$x', preserveNullAndEmptyArrays: true, includeArrayIndex: 'i'}}, "
+        " {$sort: {i: 1}}, "
+        " {$limit: 20}]";
+    string outputPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z', "
+        "            unwinding: {preserveNullAndEmptyArrays: true, includeArrayIndex: 'i'}}}, "
+        " {$sort: {sortKey: {i: 1}, limit: 20}}]";
+    string serializedPipe =
+        "[{$lookup: {from: 'lookupColl', as: 'x', localField: 'y', foreignField: 'z'}}, "
+        " {$unwind: {path: '$x', preserveNullAndEmptyArrays: true, includeArrayIndex: 'i'}}, "
+        " {$sort: {i: 1}}, "
+        " {$limit: 20}]";
+    assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
+}
+
 TEST(PipelineOptimizationTest, GroupShouldSwapWithMatchIfFilteringOnID) {
     string inputPipe =
         "[{$group : {_id:'$a'}}, "
@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/spilled_value_runs.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace {
+/**
+ * Generates a new file name on each call using a static, atomic and monotonically increasing
+ * number. See the comment on nextFileName() in document_source_group.cpp for why each user of the
+ * Sorter needs its own counter.
+ */
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> spilledValueRunsFileCounter;
+    return "extsort-accumulator." + std::to_string(spilledValueRunsFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+// FileIterator is defined in sorter.cpp, and is used below to re-read each run.
+#include "mongo/db/sorter/sorter.cpp"
+
+namespace mongo {
+
+SpilledValueRuns::~SpilledValueRuns() {
+    clear();
+}
+
+bool SpilledValueRuns::canSpill(const ExpressionContext* expCtx) {
+    return expCtx->allowDiskUse && !expCtx->inMongos;
+}
+
+void SpilledValueRuns::addRun(const std::vector<Value>& values) {
+    invariant(canSpill(_expCtx));
+    if (values.empty()) {
+        return;
+    }
+
+    if (_fileName.empty()) {
+        _fileName = _expCtx->tempDir + "/" + nextFileName();
+    }
+
+    SortedFileWriter<Value, NullValue> writer(
+        SortOptions().TempDir(_expCtx->tempDir), _fileName, _nextFileOffset);
+    for (auto&& value : values) {
+        writer.addAlreadySorted(value, NullValue());
+    }
+    std::unique_ptr<Sorter<Value, NullValue>::Iterator> run(writer.done());
+    _ranges.push_back(run->getRange());
+    _nextFileOffset = writer.getFileEndOffset();
+    _numValues += values.size();
+}
+
+void SpilledValueRuns::forEach(const std::function<void(const Value&)>& fn) const {
+    for (auto&& range : _ranges) {
+        sorter::FileIterator<Value, NullValue> run(_fileName,
+                                                   range.getStartOffset(),
+                                                   range.getEndOffset(),
+                                                   {},
+                                                   range.getChecksum());
+        run.openSource();
+        while (run.more()) {
+            fn(run.next().first);
+        }
+        run.closeSource();
+    }
+}
+
+void SpilledValueRuns::clear() {
+    _ranges.clear();
+    _numValues = 0;
+    _nextFileOffset = 0;
+    if (!_fileName.empty()) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(_fileName, ec);
+        _fileName.clear();
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,95 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/sorter/sorter_gen.h"
+
+namespace mongo {
+
+class ExpressionContext;
+
+/**
+ * Values which an accumulator has moved to a temporary file in order to stay within its memory
+ * limit, such as part of the array built by $push. Values are written to a single file as a series
+ * of runs, and can be read back any number of times, in the order in which they were written. The
+ * file is removed when this object is cleared or destroyed.
+ */
+class SpilledValueRuns {
+    SpilledValueRuns(const SpilledValueRuns&) = delete;
+    SpilledValueRuns& operator=(const SpilledValueRuns&) = delete;
+
+public:
+    explicit SpilledValueRuns(ExpressionContext* expCtx) : _expCtx(expCtx) {}
+    ~SpilledValueRuns();
+
+    /**
+     * Returns whether spilling is possible for this operation, that is whether it allows disk use
+     * and is not running on mongos.
+     */
+    static bool canSpill(const ExpressionContext* expCtx);
+
+    /**
+     * Appends 'values' to the file as a new run.
+     */
+    void addRun(const std::vector<Value>& values);
+
+    /**
+     * Calls 'fn' on each spilled value, in the order in which they were spilled.
+     */
+    void forEach(const std::function<void(const Value&)>& fn) const;
+
+    bool empty() const {
+        return _ranges.empty();
+    }
+
+    long long numValues() const {
+        return _numValues;
+    }
+
+    /**
+     * Discards all of the spilled values and removes the file.
+     */
+    void clear();
+
+private:
+    ExpressionContext* const _expCtx;
+
+    std::string _fileName;
+    std::streampos _nextFileOffset = 0;
+    std::vector<SorterRange> _ranges;
+    long long _numValues = 0;
+};
+
+}  // namespace mongo
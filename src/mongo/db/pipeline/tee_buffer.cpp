@@ -34,6 +34,7 @@
 #include <algorithm>
 
 #include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/operation_context.h"
 
 namespace mongo {
 
@@ -50,6 +51,10 @@ boost::intrusive_ptr<TeeBuffer> TeeBuffer::create(size_t nConsumers, int bufferS
 }
 
 DocumentSource::GetNextResult TeeBuffer::getNext(size_t consumerId) {
+    if (_concurrent) {
+        return getNextForConcurrentConsumer(consumerId);
+    }
+
     size_t nConsumersStillProcessingThisBatch =
         std::count_if(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
             return info.nLeftToReturn > 0;
@@ -104,4 +109,111 @@ void TeeBuffer::loadNextBatch() {
     }
 }
 
+DocumentSource::GetNextResult TeeBuffer::getNextForConcurrentConsumer(size_t consumerId) {
+    BSONObj next;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        auto& consumer = _consumers[consumerId];
+        if (consumer.nLeftToReturn == 0) {
+            return _concurrentInputExhausted ? DocumentSource::GetNextResult::makeEOF()
+                                             : DocumentSource::GetNextResult::makePauseExecution();
+        }
+
+        next = _concurrentBuffer[_concurrentBuffer.size() - consumer.nLeftToReturn];
+        if (--consumer.nLeftToReturn == 0) {
+            _batchConsumed.notify_all();
+        }
+    }
+
+    // Each consumer gets its own Document over the shared, immutable BSON.
+    return Document::fromBsonWithMetaData(next);
+}
+
+void TeeBuffer::disposeConcurrentConsumer(size_t consumerId) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _consumers[consumerId].stillInUse = false;
+    _consumers[consumerId].nLeftToReturn = 0;
+    _batchConsumed.notify_all();
+}
+
+bool TeeBuffer::loadNextBatchForConcurrentConsumers(OperationContext* opCtx) {
+    invariant(_concurrent);
+    {
+        stdx::unique_lock<Latch> lk(_mutex);
+        opCtx->waitForConditionOrInterrupt(_batchConsumed, lk, [&] {
+            return !_cancellationStatus.isOK() ||
+                std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
+                       return info.nLeftToReturn > 0;
+                   });
+        });
+        uassertStatusOK(_cancellationStatus);
+        _concurrentBuffer.clear();
+
+        if (std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
+                return info.stillInUse;
+            })) {
+            _concurrentInputExhausted = true;
+            _batchLoaded.notify_all();
+        }
+    }
+
+    if (_concurrentInputExhausted) {
+        // Every consumer has been disposed, so there is no need to read any further.
+        if (_source) {
+            _source->dispose();
+        }
+        return false;
+    }
+
+    // Read the batch without holding the mutex, so that the consumers can still observe
+    // cancellation. They cannot be reading the buffer, since they have all consumed it.
+    std::vector<BSONObj> batch;
+    size_t bytesInBuffer = 0;
+    auto input = _source->getNext();
+    for (; input.isAdvanced(); input = _source->getNext()) {
+        batch.push_back(input.releaseDocument().toBsonWithMetaData());
+        bytesInBuffer += batch.back().objsize();
+
+        if (bytesInBuffer >= _bufferSizeBytes) {
+            break;  // Need to break here so we don't get the next input and accidentally ignore it.
+        }
+    }
+
+    // See loadNextBatch() for why the input can never be paused.
+    invariant(!input.isPaused());  // NOLINT(bugprone-use-after-move)
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    _concurrentBuffer = std::move(batch);
+    _concurrentInputExhausted = _concurrentBuffer.empty();
+    for (auto&& consumer : _consumers) {
+        if (consumer.stillInUse) {
+            consumer.nLeftToReturn = _concurrentBuffer.size();
+        }
+    }
+    _batchLoaded.notify_all();
+    return !_concurrentInputExhausted;
+}
+
+void TeeBuffer::waitForConcurrentInput(const std::vector<size_t>& consumerIds) {
+    invariant(_concurrent);
+    stdx::unique_lock<Latch> lk(_mutex);
+    _batchLoaded.wait(lk, [&] {
+        return !_cancellationStatus.isOK() || _concurrentInputExhausted ||
+            std::any_of(consumerIds.begin(), consumerIds.end(), [&](size_t consumerId) {
+                   return _consumers[consumerId].nLeftToReturn > 0;
+               });
+    });
+    uassertStatusOK(_cancellationStatus);
+}
+
+void TeeBuffer::cancel(Status status) {
+    invariant(!status.isOK());
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_cancellationStatus.isOK()) {
+        _cancellationStatus = std::move(status);
+    }
+    _batchConsumed.notify_all();
+    _batchLoaded.notify_all();
+}
+
 }  // namespace mongo
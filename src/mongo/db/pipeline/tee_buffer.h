@@ -36,6 +36,8 @@
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/intrusive_counter.h"
 
 namespace mongo {
@@ -45,6 +47,12 @@ namespace mongo {
  * do so, it will batch incoming documents and allow each consumer to consume one batch at a time.
  * As a consequence, consumers must be able to pause their execution to allow other consumers to
  * process the batch before moving to the next batch.
+ *
+ * By default the consumers run on the thread that owns the source, and whichever consumer first
+ * needs the next batch loads it. In concurrent mode the consumers run on other threads: only the
+ * owning thread loads batches, once every consumer is done with the current one, and consumers
+ * that are done block until the next batch is published. Either way, at most one batch is held in
+ * memory, which throttles the source to the pace of the slowest consumer.
  */
 class TeeBuffer : public RefCountable {
 public:
@@ -59,11 +67,44 @@ public:
         _source = source;
     }
 
+    /**
+     * Switches this buffer to concurrent mode. Must be called before any input is consumed.
+     */
+    void enableConcurrentConsumers() {
+        invariant(_buffer.empty());
+        _concurrent = true;
+    }
+
+    /**
+     * In concurrent mode, waits until every consumer still in use has consumed the current batch,
+     * then loads the next batch from the source and publishes it to the consumers. Returns false
+     * once there is no more input for any consumer. Must be called on the thread which owns the
+     * source, with that thread's operation context. Throws if interrupted or cancelled.
+     */
+    bool loadNextBatchForConcurrentConsumers(OperationContext* opCtx);
+
+    /**
+     * In concurrent mode, blocks until any of 'consumerIds' has input to return or has reached the
+     * end of the input. Throws if the buffer has been cancelled.
+     */
+    void waitForConcurrentInput(const std::vector<size_t>& consumerIds);
+
+    /**
+     * In concurrent mode, makes current and future waits on this buffer fail with 'status'. Only
+     * the first cancellation status is kept.
+     */
+    void cancel(Status status);
+
     /**
      * Removes 'consumerId' as a consumer of this buffer. This is required to be called if a
      * consumer will not consume all input.
      */
     void dispose(size_t consumerId) {
+        if (_concurrent) {
+            disposeConcurrentConsumer(consumerId);
+            return;
+        }
+
         _consumers[consumerId].stillInUse = false;
         _consumers[consumerId].nLeftToReturn = 0;
         if (std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
@@ -93,6 +134,9 @@ private:
      */
     void loadNextBatch();
 
+    DocumentSource::GetNextResult getNextForConcurrentConsumer(size_t consumerId);
+    void disposeConcurrentConsumer(size_t consumerId);
+
     DocumentSource* _source = nullptr;
 
     const size_t _bufferSizeBytes;
@@ -103,5 +147,16 @@ private:
         int nLeftToReturn = 0;
     };
     std::vector<ConsumerInfo> _consumers;
+
+    // The following are only used in concurrent mode. Batches are held as BSON rather than as
+    // Documents, since Documents lazily cache their fields and so cannot be shared between
+    // threads. '_mutex' protects the batch, '_consumers', and the state below.
+    bool _concurrent = false;
+    std::vector<BSONObj> _concurrentBuffer;
+    bool _concurrentInputExhausted = false;
+    Status _cancellationStatus = Status::OK();
+    Mutex _mutex = MONGO_MAKE_LATCH("TeeBuffer::_mutex");
+    stdx::condition_variable _batchConsumed;
+    stdx::condition_variable _batchLoaded;
 };
 }  // namespace mongo
@@ -42,6 +42,7 @@
 #include "mongo/db/exec/and_hash.h"
 #include "mongo/db/exec/and_sorted.h"
 #include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/column_scan.h"
 #include "mongo/db/exec/count_scan.h"
 #include "mongo/db/exec/distinct_scan.h"
 #include "mongo/db/exec/ensure_sorted.h"
@@ -68,6 +69,14 @@ namespace mongo::stage_builder {
 // Returns a non-null pointer to the root of a plan tree, or a non-OK status if the PlanStage tree
 // could not be constructed.
 std::unique_ptr<PlanStage> ClassicStageBuilder::build(const QuerySolutionNode* root) {
+    auto stage = buildStage(root);
+    if (root->estimatedCardinality) {
+        stage->setEstimatedCardinality(*root->estimatedCardinality);
+    }
+    return stage;
+}
+
+std::unique_ptr<PlanStage> ClassicStageBuilder::buildStage(const QuerySolutionNode* root) {
     auto* const expCtx = _cq.getExpCtxRaw();
 
     switch (root->getType()) {
@@ -82,12 +91,27 @@ std::unique_ptr<PlanStage> ClassicStageBuilder::build(const QuerySolutionNode* r
             params.shouldWaitForOplogVisibility = csn->shouldWaitForOplogVisibility;
             params.minTs = csn->minTs;
             params.maxTs = csn->maxTs;
+            params.minRecord = csn->minRecord;
+            params.maxRecord = csn->maxRecord;
             params.requestResumeToken = csn->requestResumeToken;
             params.resumeAfterRecordId = csn->resumeAfterRecordId;
             params.stopApplyingFilterAfterFirstMatch = csn->stopApplyingFilterAfterFirstMatch;
             return std::make_unique<CollectionScan>(
                 expCtx, _collection, params, _ws, csn->filter.get());
         }
+        case STAGE_COLUMN_SCAN: {
+            const ColumnScanNode* csn = static_cast<const ColumnScanNode*>(root);
+
+            invariant(_collection);
+            auto descriptor =
+                _collection->getIndexCatalog()->findIndexByName(_opCtx, csn->indexName);
+            invariant(descriptor,
+                      str::stream() << "Namespace: " << _collection->ns()
+                                    << ", CanonicalQuery: " << _cq.toStringShort()
+                                    << ", index: " << csn->indexName);
+            return std::make_unique<ColumnScan>(
+                expCtx, _collection, descriptor, csn->fields, _ws, csn->filter.get());
+        }
         case STAGE_IXSCAN: {
             const IndexScanNode* ixn = static_cast<const IndexScanNode*>(root);
 
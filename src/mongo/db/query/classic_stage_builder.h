@@ -48,6 +48,8 @@ public:
     std::unique_ptr<PlanStage> build(const QuerySolutionNode* root) final;
 
 private:
+    std::unique_ptr<PlanStage> buildStage(const QuerySolutionNode* root);
+
     WorkingSet* _ws;
 };
 }  // namespace mongo::stage_builder
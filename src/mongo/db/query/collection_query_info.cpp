@@ -45,6 +45,7 @@
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index/wildcard_access_method.h"
+#include "mongo/db/operation_context.h"
 #include "mongo/db/query/collection_index_usage_tracker_decoration.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_cache.h"
@@ -80,7 +81,9 @@ CoreIndexInfo indexInfoFromIndexCatalogEntry(const IndexCatalogEntry& ice) {
 }  // namespace
 
 CollectionQueryInfo::CollectionQueryInfo()
-    : _keysComputed(false), _planCache(std::make_unique<PlanCache>()) {}
+    : _keysComputed(false),
+      _planCache(std::make_unique<PlanCache>()),
+      _sbePlanCache(std::make_unique<SbePlanCache>()) {}
 
 const UpdateIndexData& CollectionQueryInfo::getIndexKeys(OperationContext* opCtx) const {
     invariant(_keysComputed);
@@ -115,6 +118,10 @@ void CollectionQueryInfo::computeIndexKeys(OperationContext* opCtx, const Collec
                     _indexedPaths.addPath(path);
                 }
             }
+        } else if (descriptor->getAccessMethodName() == IndexNames::COLUMN_STORE) {
+            // A column store index holds every top-level field, along with its position in the
+            // document.
+            _indexedPaths.allPathsIndexed();
         } else if (descriptor->getAccessMethodName() == IndexNames::TEXT) {
             fts::FTSSpec ftsSpec(descriptor->infoObj());
 
@@ -181,6 +188,11 @@ void CollectionQueryInfo::notifyOfQuery(OperationContext* opCtx,
     }
 }
 
+void CollectionQueryInfo::notifyOfWrite(OperationContext* opCtx) const {
+    opCtx->recoveryUnit()->onCommit(
+        [this](boost::optional<Timestamp>) { _writeCount.fetchAndAdd(1); });
+}
+
 void CollectionQueryInfo::clearQueryCache(const Collection* coll) const {
     LOGV2_DEBUG(20907,
                 1,
@@ -189,12 +201,34 @@ void CollectionQueryInfo::clearQueryCache(const Collection* coll) const {
     if (nullptr != _planCache.get()) {
         _planCache->clear();
     }
+    if (nullptr != _sbePlanCache.get()) {
+        _sbePlanCache->clear();
+    }
+
+    stdx::lock_guard<Latch> lk(_statisticsMutex);
+    _statistics = boost::none;
+}
+
+boost::optional<std::shared_ptr<const CollectionStatistics>> CollectionQueryInfo::getStatistics()
+    const {
+    stdx::lock_guard<Latch> lk(_statisticsMutex);
+    return _statistics;
+}
+
+void CollectionQueryInfo::setStatistics(
+    std::shared_ptr<const CollectionStatistics> statistics) const {
+    stdx::lock_guard<Latch> lk(_statisticsMutex);
+    _statistics = std::move(statistics);
 }
 
 PlanCache* CollectionQueryInfo::getPlanCache() const {
     return _planCache.get();
 }
 
+SbePlanCache* CollectionQueryInfo::getSbePlanCache() const {
+    return _sbePlanCache.get();
+}
+
 void CollectionQueryInfo::updatePlanCacheIndexEntries(OperationContext* opCtx,
                                                       const Collection* coll) {
     std::vector<CoreIndexInfo> indexCores;
@@ -30,9 +30,13 @@
 #pragma once
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/sbe_plan_cache.h"
 #include "mongo/db/update_index_data.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
 
 namespace mongo {
 
@@ -55,6 +59,35 @@ public:
      */
     PlanCache* getPlanCache() const;
 
+    /**
+     * Get the cache of parameterized SBE plans for this collection.
+     */
+    SbePlanCache* getSbePlanCache() const;
+
+    /**
+     * Get the statistics of this collection as last read from the statistics collection, nullptr
+     * if there were none, or boost::none if they have not been read since the query cache was
+     * last cleared.
+     */
+    boost::optional<std::shared_ptr<const CollectionStatistics>> getStatistics() const;
+
+    /**
+     * Caches the statistics of this collection, until the query cache is next cleared.
+     */
+    void setStatistics(std::shared_ptr<const CollectionStatistics> statistics) const;
+
+    /**
+     * Returns the version of the statistics catalog the query cache of this collection was last
+     * brought up to date with. See collection_statistics_catalog::clearStaleStatistics().
+     */
+    uint64_t getStatisticsVersion() const {
+        return _statisticsVersion.load();
+    }
+
+    void setStatisticsVersion(uint64_t version) const {
+        _statisticsVersion.store(version);
+    }
+
     /* get set of index keys for this namespace.  handy to quickly check if a given
        field is indexed (Note it might be a secondary component of a compound index.)
     */
@@ -82,7 +115,7 @@ public:
     void droppedIndex(OperationContext* opCtx, const Collection* coll, StringData indexName);
 
     /**
-     * Removes all cached query plans.
+     * Removes all cached query plans and cached statistics.
      */
     void clearQueryCache(const Collection* coll) const;
 
@@ -90,6 +123,19 @@ public:
                        const Collection* coll,
                        const PlanSummaryStats& summaryStats) const;
 
+    /**
+     * Returns the number of writes to this collection which have committed since the Collection
+     * instance was created. Results computed from the collection are stale once this changes.
+     */
+    uint64_t getWriteCount() const {
+        return _writeCount.load();
+    }
+
+    /**
+     * Counts a write made to this collection by 'opCtx' once its storage transaction commits.
+     */
+    void notifyOfWrite(OperationContext* opCtx) const;
+
 private:
     void computeIndexKeys(OperationContext* opCtx, const Collection* coll);
     void updatePlanCacheIndexEntries(OperationContext* opCtx, const Collection* coll);
@@ -106,6 +152,20 @@ private:
 
     // A cache for query plans.
     std::unique_ptr<PlanCache> _planCache;
+
+    // A cache for parameterized SBE plans, which is cleared along with '_planCache'.
+    std::unique_ptr<SbePlanCache> _sbePlanCache;
+
+    // The statistics gathered for this collection by the 'analyze' command. Protected by
+    // '_statisticsMutex'.
+    mutable Mutex _statisticsMutex = MONGO_MAKE_LATCH("CollectionQueryInfo::_statisticsMutex");
+    mutable boost::optional<std::shared_ptr<const CollectionStatistics>> _statistics;
+
+    // See getStatisticsVersion().
+    mutable AtomicWord<uint64_t> _statisticsVersion{0};
+
+    // The number of committed writes, see getWriteCount().
+    mutable AtomicWord<uint64_t> _writeCount{0};
 };
 
 }  // namespace mongo
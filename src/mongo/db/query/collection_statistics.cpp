@@ -0,0 +1,370 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/bson/bsonelement_comparator_interface.h"
+#include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/db/hasher.h"
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+namespace {
+// The value a document which has nothing along a path contributes, as an index would.
+const BSONObj kNullValueObj = BSON("" << BSONNULL);
+
+int compareValues(const BSONElement& lhs, const BSONElement& rhs) {
+    return lhs.woCompare(rhs, 0);
+}
+
+/**
+ * Returns the fraction of the range (lo, hi) which lies below 'value', which must be within the
+ * range. The values are interpolated linearly if they are all numbers or all dates, otherwise the
+ * value is assumed to be in the middle of the range.
+ */
+double interpolate(const BSONElement& lo, const BSONElement& value, const BSONElement& hi) {
+    const auto type = value.canonicalType();
+    if (lo.canonicalType() != type || hi.canonicalType() != type) {
+        return 0.5;
+    }
+
+    auto toDouble = [](const BSONElement& elem) -> boost::optional<double> {
+        if (elem.isNumber()) {
+            return elem.numberDouble();
+        } else if (elem.type() == BSONType::Date) {
+            return static_cast<double>(elem.date().toMillisSinceEpoch());
+        }
+        return boost::none;
+    };
+
+    auto loValue = toDouble(lo);
+    auto hiValue = toDouble(hi);
+    auto val = toDouble(value);
+    if (!loValue || !hiValue || !val || !(*hiValue > *loValue)) {
+        return 0.5;
+    }
+    return std::clamp((*val - *loValue) / (*hiValue - *loValue), 0.0, 1.0);
+}
+
+std::vector<double> parseDoubleArray(const BSONObj& obj, StringData fieldName) {
+    auto elem = obj[fieldName];
+    uassert(5095402,
+            str::stream() << "histogram field '" << fieldName << "' must be an array",
+            elem.type() == BSONType::Array);
+
+    std::vector<double> result;
+    for (auto&& value : elem.Obj()) {
+        uassert(5095403,
+                str::stream() << "histogram field '" << fieldName << "' must contain numbers",
+                value.isNumber());
+        result.push_back(value.numberDouble());
+    }
+    return result;
+}
+}  // namespace
+
+void DistinctCountSketch::add(const BSONElement& elem) {
+    const auto hash = static_cast<uint64_t>(
+        BSONElementHasher::hash64(elem, BSONElementHasher::DEFAULT_HASH_SEED));
+    const auto index = hash >> (64 - kPrecision);
+    const auto rest = hash << kPrecision;
+    const auto rank = static_cast<uint8_t>(
+        rest == 0 ? 64 - kPrecision + 1 : countLeadingZeros64(rest) + 1);
+    _registers[index] = std::max(_registers[index], rank);
+}
+
+double DistinctCountSketch::estimate() const {
+    constexpr double m = kNumRegisters;
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    double sum = 0;
+    size_t zeroRegisters = 0;
+    for (auto reg : _registers) {
+        sum += std::ldexp(1.0, -reg);
+        zeroRegisters += reg == 0;
+    }
+
+    const double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zeroRegisters > 0) {
+        // Use linear counting for small cardinalities, where the raw estimate is biased.
+        return m * std::log(m / zeroRegisters);
+    }
+    return estimate;
+}
+
+void DistinctCountSketch::serialize(StringData fieldName, BSONObjBuilder* builder) const {
+    builder->appendBinData(fieldName, _registers.size(), BinDataGeneral, _registers.data());
+}
+
+DistinctCountSketch DistinctCountSketch::parse(const BSONElement& elem) {
+    int len = 0;
+    const char* data = nullptr;
+    if (elem.type() == BSONType::BinData) {
+        data = elem.binData(len);
+    }
+    uassert(5095404,
+            "distinct count sketch must be BinData of the expected length",
+            data && static_cast<size_t>(len) == kNumRegisters);
+
+    DistinctCountSketch sketch;
+    std::copy(data, data + len, sketch._registers.begin());
+    return sketch;
+}
+
+Histogram Histogram::build(const std::vector<BSONElement>& values,
+                           size_t maxBuckets,
+                           double scale) {
+    if (values.empty()) {
+        return {};
+    }
+
+    // The first bucket holds only the smallest value, so that every later bucket is bounded on
+    // both sides.
+    maxBuckets = std::max<size_t>(maxBuckets, 2);
+    const double valuesPerBucket =
+        std::max(1.0, static_cast<double>(values.size()) / (maxBuckets - 1));
+
+    BSONArrayBuilder bounds;
+    std::vector<Bucket> buckets;
+    Bucket current;
+    for (size_t runStart = 0; runStart < values.size();) {
+        size_t runEnd = runStart + 1;
+        while (runEnd < values.size() && compareValues(values[runStart], values[runEnd]) == 0) {
+            ++runEnd;
+        }
+        const double runLength = runEnd - runStart;
+
+        const bool closesBucket = buckets.empty() || runEnd == values.size() ||
+            (buckets.size() + 1 < maxBuckets && current.rangeCount + runLength >= valuesPerBucket);
+        if (closesBucket) {
+            current.boundCount = runLength;
+            buckets.push_back(current);
+            bounds.append(values[runStart]);
+            current = {};
+        } else {
+            current.rangeCount += runLength;
+            current.rangeDistinctCount += 1;
+        }
+        runStart = runEnd;
+    }
+
+    // Distinct counts are left as they were seen in the sample: values which are rare in the
+    // collection are unlikely to be sampled at all, so scaling them up would not be any closer.
+    for (auto&& bucket : buckets) {
+        bucket.rangeCount *= scale;
+        bucket.boundCount *= scale;
+    }
+
+    Histogram histogram;
+    histogram.init(bounds.obj(), std::move(buckets));
+    return histogram;
+}
+
+Histogram Histogram::parse(const BSONObj& obj) {
+    auto boundsElem = obj["bounds"];
+    uassert(5095405,
+            "histogram field 'bounds' must be an array",
+            boundsElem.type() == BSONType::Array);
+
+    auto rangeCounts = parseDoubleArray(obj, "rangeCounts");
+    auto rangeDistinctCounts = parseDoubleArray(obj, "rangeDistinctCounts");
+    auto boundCounts = parseDoubleArray(obj, "boundCounts");
+
+    const auto numBuckets = static_cast<size_t>(boundsElem.Obj().nFields());
+    uassert(5095406,
+            "histogram arrays must all have one entry per bucket",
+            rangeCounts.size() == numBuckets && rangeDistinctCounts.size() == numBuckets &&
+                boundCounts.size() == numBuckets);
+
+    std::vector<Bucket> buckets;
+    for (size_t i = 0; i < numBuckets; ++i) {
+        buckets.push_back({rangeCounts[i], rangeDistinctCounts[i], boundCounts[i]});
+    }
+
+    Histogram histogram;
+    histogram.init(boundsElem.Obj().getOwned(), std::move(buckets));
+    return histogram;
+}
+
+void Histogram::init(BSONObj bounds, std::vector<Bucket> buckets) {
+    _boundsObj = std::move(bounds);
+    _buckets = std::move(buckets);
+    _bounds.clear();
+    for (auto&& bound : _boundsObj) {
+        _bounds.push_back(bound);
+    }
+    invariant(_bounds.size() == _buckets.size());
+}
+
+BSONObj Histogram::toBSON() const {
+    BSONObjBuilder builder;
+    builder.appendArray("bounds", _boundsObj);
+
+    BSONArrayBuilder rangeCounts(builder.subarrayStart("rangeCounts"));
+    for (auto&& bucket : _buckets) {
+        rangeCounts.append(bucket.rangeCount);
+    }
+    rangeCounts.doneFast();
+
+    BSONArrayBuilder rangeDistinctCounts(builder.subarrayStart("rangeDistinctCounts"));
+    for (auto&& bucket : _buckets) {
+        rangeDistinctCounts.append(bucket.rangeDistinctCount);
+    }
+    rangeDistinctCounts.doneFast();
+
+    BSONArrayBuilder boundCounts(builder.subarrayStart("boundCounts"));
+    for (auto&& bucket : _buckets) {
+        boundCounts.append(bucket.boundCount);
+    }
+    boundCounts.doneFast();
+
+    return builder.obj();
+}
+
+double Histogram::estimateLessThan(const BSONElement& value, bool inclusive) const {
+    double count = 0;
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        const auto& bucket = _buckets[i];
+        const int cmp = compareValues(value, _bounds[i]);
+        if (cmp > 0) {
+            count += bucket.rangeCount + bucket.boundCount;
+            continue;
+        }
+
+        if (cmp == 0) {
+            return count + bucket.rangeCount + (inclusive ? bucket.boundCount : 0);
+        }
+
+        if (i > 0) {
+            count += bucket.rangeCount * interpolate(_bounds[i - 1], value, _bounds[i]);
+        }
+        return count;
+    }
+    return count;
+}
+
+double Histogram::estimateEquality(const BSONElement& value) const {
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        const auto& bucket = _buckets[i];
+        const int cmp = compareValues(value, _bounds[i]);
+        if (cmp == 0) {
+            return bucket.boundCount;
+        } else if (cmp < 0) {
+            return bucket.rangeDistinctCount > 0 ? bucket.rangeCount / bucket.rangeDistinctCount
+                                                 : 0;
+        }
+    }
+    return 0;
+}
+
+double Histogram::estimateInterval(const Interval& interval) const {
+    if (interval.isEmpty() || interval.isNull()) {
+        return 0;
+    }
+
+    if (interval.isPoint()) {
+        return estimateEquality(interval.start);
+    }
+
+    if (interval.getDirection() == Interval::Direction::kDirectionDescending) {
+        return estimateInterval(interval.reverseClone());
+    }
+
+    return std::max(0.0,
+                    estimateLessThan(interval.end, interval.endInclusive) -
+                        estimateLessThan(interval.start, !interval.startInclusive));
+}
+
+double Histogram::totalCount() const {
+    double count = 0;
+    for (auto&& bucket : _buckets) {
+        count += bucket.rangeCount + bucket.boundCount;
+    }
+    return count;
+}
+
+FieldStatistics FieldStatistics::parse(const BSONObj& obj) {
+    FieldStatistics stats;
+    stats.valueCount = obj["valueCount"].numberDouble();
+    stats.distinctCount = obj["distinctCount"].numberDouble();
+
+    auto histogramElem = obj["histogram"];
+    uassert(5095407,
+            "field statistics must contain a 'histogram' object",
+            histogramElem.type() == BSONType::Object);
+    stats.histogram = Histogram::parse(histogramElem.Obj());
+    return stats;
+}
+
+void FieldStatistics::serialize(BSONObjBuilder* builder) const {
+    builder->append("valueCount", valueCount);
+    builder->append("distinctCount", distinctCount);
+    builder->append("histogram", histogram.toBSON());
+}
+
+void FieldStatisticsBuilder::addDocument(const BSONObj& doc, bool sampled) {
+    BSONElementSet values;
+    dotted_path_support::extractAllElementsAlongPath(doc, _path, values);
+    if (values.empty()) {
+        values.insert(kNullValueObj.firstElement());
+    }
+
+    for (auto&& value : values) {
+        _valueCount += 1;
+        _sketch.add(value);
+        if (sampled) {
+            _sample.push_back(value.wrap(""));
+        }
+    }
+}
+
+FieldStatistics FieldStatisticsBuilder::done(size_t maxBuckets) {
+    std::vector<BSONElement> values;
+    values.reserve(_sample.size());
+    for (auto&& obj : _sample) {
+        values.push_back(obj.firstElement());
+    }
+    std::sort(values.begin(), values.end(), [](const BSONElement& lhs, const BSONElement& rhs) {
+        return compareValues(lhs, rhs) < 0;
+    });
+
+    FieldStatistics stats{_path};
+    stats.valueCount = _valueCount;
+    stats.distinctCount = std::min(_sketch.estimate(), _valueCount);
+    if (!values.empty()) {
+        stats.histogram = Histogram::build(values, maxBuckets, _valueCount / values.size());
+    }
+    return stats;
+}
+}  // namespace mongo
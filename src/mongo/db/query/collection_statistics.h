@@ -0,0 +1,201 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/query/interval.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+/**
+ * A HyperLogLog sketch estimating the number of distinct values added to it. Values are hashed
+ * the same way hashed indexes hash them, which truncates numbers to 64-bit integers, so numbers
+ * differing only in their fractional part count as one value. The sketch uses 2^kPrecision
+ * one-byte registers, which gives a standard error of about 3%.
+ */
+class DistinctCountSketch {
+public:
+    static constexpr int kPrecision = 10;
+    static constexpr size_t kNumRegisters = size_t{1} << kPrecision;
+
+    DistinctCountSketch() {
+        _registers.fill(0);
+    }
+
+    void add(const BSONElement& elem);
+
+    double estimate() const;
+
+    /**
+     * Serializes the registers as BinData under 'fieldName'.
+     */
+    void serialize(StringData fieldName, BSONObjBuilder* builder) const;
+
+    static DistinctCountSketch parse(const BSONElement& elem);
+
+private:
+    std::array<uint8_t, kNumRegisters> _registers;
+};
+
+/**
+ * An equi-depth histogram over the values a single path takes in a collection. Values are ordered
+ * the same way index keys are. Every bucket is closed by one value of the path, its bound, and
+ * covers all values greater than the bound of the previous bucket and less than or equal to its
+ * own bound. Bounds are always values which were seen, so the number of values equal to a bound
+ * is known precisely, and popular values tend to become bounds.
+ *
+ * All counts are scaled to the whole collection, even if the histogram was built from a sample.
+ */
+class Histogram {
+public:
+    struct Bucket {
+        // The number of values strictly between the previous bound and this bucket's bound.
+        double rangeCount{0};
+        // The number of distinct values strictly between the previous bound and this bound.
+        double rangeDistinctCount{0};
+        // The number of values equal to this bucket's bound.
+        double boundCount{0};
+    };
+
+    Histogram() = default;
+
+    /**
+     * Builds a histogram with at most 'maxBuckets' buckets, but no fewer than two, from 'values',
+     * which must be sorted in index key order. Each value stands for 'scale' values of the
+     * collection.
+     */
+    static Histogram build(const std::vector<BSONElement>& values, size_t maxBuckets, double scale);
+
+    static Histogram parse(const BSONObj& obj);
+
+    BSONObj toBSON() const;
+
+    /**
+     * Returns the estimated number of values equal to 'value'.
+     */
+    double estimateEquality(const BSONElement& value) const;
+
+    /**
+     * Returns the estimated number of values within 'interval', which may be in either direction.
+     */
+    double estimateInterval(const Interval& interval) const;
+
+    double totalCount() const;
+
+    size_t numBuckets() const {
+        return _buckets.size();
+    }
+
+    bool empty() const {
+        return _buckets.empty();
+    }
+
+private:
+    /**
+     * Returns the estimated number of values less than 'value', or less than or equal to 'value'
+     * if 'inclusive' is true.
+     */
+    double estimateLessThan(const BSONElement& value, bool inclusive) const;
+
+    void init(BSONObj bounds, std::vector<Bucket> buckets);
+
+    // The bounds of the buckets, as an array-like object, and the elements pointing into it.
+    BSONObj _boundsObj;
+    std::vector<BSONElement> _bounds;
+    std::vector<Bucket> _buckets;
+};
+
+/**
+ * The statistics of a single path. A document contributes one value for every distinct element it
+ * has along the path, with arrays expanded, and a null value if it has none, which matches the keys
+ * an index on the path would hold for it.
+ */
+struct FieldStatistics {
+    FieldStatistics() = default;
+    explicit FieldStatistics(std::string path) : path(std::move(path)) {}
+
+    static FieldStatistics parse(const BSONObj& obj);
+
+    /**
+     * Serializes the statistics, except for the path, into 'builder'.
+     */
+    void serialize(BSONObjBuilder* builder) const;
+
+    std::string path;
+    double valueCount{0};
+    double distinctCount{0};
+    Histogram histogram;
+};
+
+/**
+ * Accumulates the statistics of a single path while the documents of a collection are scanned.
+ * Every document is counted and added to the distinct count sketch, but only the values of
+ * sampled documents end up in the histogram.
+ */
+class FieldStatisticsBuilder {
+public:
+    explicit FieldStatisticsBuilder(std::string path) : _path(std::move(path)) {}
+
+    void addDocument(const BSONObj& doc, bool sampled);
+
+    /**
+     * Returns the statistics of the path, with a histogram of at most 'maxBuckets' buckets.
+     */
+    FieldStatistics done(size_t maxBuckets);
+
+private:
+    const std::string _path;
+    double _valueCount{0};
+    DistinctCountSketch _sketch;
+    // Each sampled value, wrapped into an object of its own.
+    std::vector<BSONObj> _sample;
+};
+
+/**
+ * The statistics of a collection, as gathered by the last run of the 'analyze' command.
+ */
+struct CollectionStatistics {
+    /**
+     * Returns the statistics for 'path', or nullptr if the path has not been analyzed.
+     */
+    const FieldStatistics* getField(StringData path) const {
+        auto it = fields.find(path);
+        return it == fields.end() ? nullptr : &it->second;
+    }
+
+    double numDocuments{0};
+    StringMap<FieldStatistics> fields;
+};
+}  // namespace mongo
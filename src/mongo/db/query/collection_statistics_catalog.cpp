@@ -0,0 +1,146 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics_catalog.h"
+
+#include "mongo/db/catalog/collection_catalog.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/logv2/log.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo::collection_statistics_catalog {
+namespace {
+// Counts the committed writes to the statistics collections of all the databases.
+AtomicWord<uint64_t> statisticsVersion{0};
+
+std::shared_ptr<const CollectionStatistics> readStatistics(OperationContext* opCtx,
+                                                           const Collection* collection) {
+    const auto nss = statisticsNamespace(collection->ns().db());
+    Lock::CollectionLock collLock(opCtx, nss, MODE_IS);
+    auto statsColl = CollectionCatalog::get(opCtx).lookupCollectionByNamespace(opCtx, nss);
+    if (!statsColl) {
+        return nullptr;
+    }
+
+    auto stats = std::make_shared<CollectionStatistics>();
+    Date_t lastUpdated;
+    auto exec = InternalPlanner::collectionScan(
+        opCtx, nss.ns(), statsColl, PlanYieldPolicy::YieldPolicy::NO_YIELD);
+    BSONObj doc;
+    while (exec->getNext(&doc, nullptr) == PlanExecutor::ADVANCED) {
+        auto id = doc["_id"];
+        if (id.type() != BSONType::Object || id.Obj()["coll"].str() != collection->ns().coll()) {
+            continue;
+        }
+
+        auto uuid = UUID::parse(doc["uuid"]);
+        if (!uuid.isOK() || uuid.getValue() != collection->uuid()) {
+            continue;
+        }
+
+        try {
+            auto fieldStats = FieldStatistics::parse(doc);
+            fieldStats.path = id.Obj()["path"].str();
+
+            // The paths may have been analyzed at different times. Trust the collection size
+            // recorded by the most recent run.
+            if (doc["lastUpdated"].date() >= lastUpdated) {
+                lastUpdated = doc["lastUpdated"].date();
+                stats->numDocuments = doc["numDocuments"].numberDouble();
+            }
+            auto path = fieldStats.path;
+            stats->fields[path] = std::move(fieldStats);
+        } catch (const DBException& ex) {
+            LOGV2_WARNING(5095408,
+                          "Ignoring malformed statistics document",
+                          "namespace"_attr = nss,
+                          "document"_attr = redact(doc),
+                          "error"_attr = ex.toStatus());
+        }
+    }
+
+    if (stats->fields.empty()) {
+        return nullptr;
+    }
+    return stats;
+}
+}  // namespace
+
+NamespaceString statisticsNamespace(StringData dbName) {
+    return NamespaceString(dbName, NamespaceString::kSystemDotStatisticsCollectionName);
+}
+
+BSONObj makeStatisticsDocument(const NamespaceString& nss,
+                               const UUID& uuid,
+                               double numDocuments,
+                               const FieldStatistics& fieldStats) {
+    BSONObjBuilder builder;
+    builder.append("_id", BSON("coll" << nss.coll() << "path" << fieldStats.path));
+    uuid.appendToBuilder(&builder, "uuid");
+    builder.append("numDocuments", numDocuments);
+    builder.appendDate("lastUpdated", Date_t::now());
+    fieldStats.serialize(&builder);
+    return builder.obj();
+}
+
+void onStatisticsChanged() {
+    statisticsVersion.fetchAndAdd(1);
+}
+
+void clearStaleStatistics(const Collection* collection) {
+    const auto& queryInfo = CollectionQueryInfo::get(collection);
+    // Load the version before clearing, so that a write committing concurrently leaves the
+    // collection behind and clears it again on its next query.
+    const auto version = statisticsVersion.load();
+    if (queryInfo.getStatisticsVersion() != version) {
+        queryInfo.clearQueryCache(collection);
+        queryInfo.setStatisticsVersion(version);
+    }
+}
+
+std::shared_ptr<const CollectionStatistics> getStatistics(OperationContext* opCtx,
+                                                          const Collection* collection) {
+    clearStaleStatistics(collection);
+
+    const auto& queryInfo = CollectionQueryInfo::get(collection);
+    if (auto cached = queryInfo.getStatistics()) {
+        return *cached;
+    }
+
+    auto stats = readStatistics(opCtx, collection);
+    queryInfo.setStatistics(stats);
+    return stats;
+}
+}  // namespace mongo::collection_statistics_catalog
@@ -0,0 +1,87 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/collection_statistics.h"
+
+/**
+ * Access to the statistics the 'analyze' command persists. The statistics of all the collections
+ * of a database are kept in its 'system.statistics' collection, one document per analyzed path:
+ *
+ *   {_id: {coll: <collection name>, path: <path>}, uuid: <collection UUID>,
+ *    numDocuments: <number>, lastUpdated: <date>, valueCount: <number>,
+ *    distinctCount: <number>, histogram: <histogram>}
+ *
+ * Documents whose UUID does not match the current incarnation of the collection are ignored, so
+ * statistics never outlive the collection they were gathered for.
+ */
+namespace mongo::collection_statistics_catalog {
+/**
+ * Returns the namespace of the collection which holds the statistics of the collections of the
+ * database 'dbName'.
+ */
+NamespaceString statisticsNamespace(StringData dbName);
+
+/**
+ * Builds the document recording the statistics 'fieldStats' of a path of the collection 'nss' with
+ * the given 'uuid', which had 'numDocuments' documents when it was analyzed.
+ */
+BSONObj makeStatisticsDocument(const NamespaceString& nss,
+                               const UUID& uuid,
+                               double numDocuments,
+                               const FieldStatistics& fieldStats);
+
+/**
+ * Records that a write to a statistics collection has committed, on this node or through
+ * replication, which makes the statistics and the plans cached by every collection stale.
+ */
+void onStatisticsChanged();
+
+/**
+ * Clears the query cache of 'collection' if the statistics changed since it was last cleared, so
+ * that neither the statistics nor the plans chosen with them outlive a write to the statistics
+ * collection. The caller must hold a lock on 'collection'.
+ */
+void clearStaleStatistics(const Collection* collection);
+
+/**
+ * Returns the statistics of 'collection', or nullptr if it has never been analyzed. The statistics
+ * are read from the statistics collection the first time they are needed, and then cached in the
+ * CollectionQueryInfo of the collection until its query cache is cleared, or until they are found
+ * stale by clearStaleStatistics(). The caller must hold a lock on 'collection'.
+ */
+std::shared_ptr<const CollectionStatistics> getStatistics(OperationContext* opCtx,
+                                                          const Collection* collection);
+}  // namespace mongo::collection_statistics_catalog
@@ -0,0 +1,100 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics_op_observer.h"
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/collection_statistics_catalog.h"
+
+namespace mongo {
+namespace {
+
+bool isStatisticsNamespace(const NamespaceString& nss) {
+    return nss.coll() == NamespaceString::kSystemDotStatisticsCollectionName;
+}
+
+/**
+ * Marks the cached statistics as stale once the write to the statistics collection 'nss' commits.
+ */
+void onStatisticsWrite(OperationContext* opCtx, const NamespaceString& nss) {
+    if (!isStatisticsNamespace(nss)) {
+        return;
+    }
+
+    opCtx->recoveryUnit()->onCommit(
+        [](boost::optional<Timestamp>) { collection_statistics_catalog::onStatisticsChanged(); });
+}
+
+}  // namespace
+
+void CollectionStatisticsOpObserver::onInserts(OperationContext* opCtx,
+                                               const NamespaceString& nss,
+                                               OptionalCollectionUUID uuid,
+                                               std::vector<InsertStatement>::const_iterator first,
+                                               std::vector<InsertStatement>::const_iterator last,
+                                               bool fromMigrate) {
+    onStatisticsWrite(opCtx, nss);
+}
+
+void CollectionStatisticsOpObserver::onUpdate(OperationContext* opCtx,
+                                              const OplogUpdateEntryArgs& args) {
+    onStatisticsWrite(opCtx, args.nss);
+}
+
+void CollectionStatisticsOpObserver::onDelete(OperationContext* opCtx,
+                                              const NamespaceString& nss,
+                                              OptionalCollectionUUID uuid,
+                                              StmtId stmtId,
+                                              bool fromMigrate,
+                                              const boost::optional<BSONObj>& deletedDoc) {
+    onStatisticsWrite(opCtx, nss);
+}
+
+repl::OpTime CollectionStatisticsOpObserver::onDropCollection(OperationContext* opCtx,
+                                                              const NamespaceString& collectionName,
+                                                              OptionalCollectionUUID uuid,
+                                                              std::uint64_t numRecords,
+                                                              CollectionDropType dropType) {
+    onStatisticsWrite(opCtx, collectionName);
+    return {};
+}
+
+void CollectionStatisticsOpObserver::onReplicationRollback(OperationContext* opCtx,
+                                                           const RollbackObserverInfo& rbInfo) {
+    for (auto&& nss : rbInfo.rollbackNamespaces) {
+        if (isStatisticsNamespace(nss)) {
+            collection_statistics_catalog::onStatisticsChanged();
+            return;
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,199 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include <algorithm>
+
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+/**
+ * Builds a histogram over 'values', each of which stands for exactly one value of the collection.
+ */
+Histogram buildHistogram(std::vector<BSONObj> values, size_t maxBuckets) {
+    std::vector<BSONElement> elems;
+    for (auto&& value : values) {
+        elems.push_back(value.firstElement());
+    }
+    std::sort(elems.begin(), elems.end(), [](const BSONElement& lhs, const BSONElement& rhs) {
+        return lhs.woCompare(rhs, 0) < 0;
+    });
+    return Histogram::build(elems, maxBuckets, 1.0);
+}
+
+std::vector<BSONObj> makeRange(int begin, int end) {
+    std::vector<BSONObj> values;
+    for (int i = begin; i < end; ++i) {
+        values.push_back(BSON("" << i));
+    }
+    return values;
+}
+
+TEST(HistogramTest, EmptyHistogramEstimatesNothing) {
+    auto histogram = buildHistogram({}, 10);
+    ASSERT_TRUE(histogram.empty());
+    ASSERT_EQ(histogram.estimateEquality(BSON("" << 1).firstElement()), 0.0);
+    ASSERT_EQ(histogram.estimateInterval(IndexBoundsBuilder::allValues()), 0.0);
+}
+
+TEST(HistogramTest, NumberOfBucketsIsBounded) {
+    auto histogram = buildHistogram(makeRange(0, 1000), 10);
+    ASSERT_LTE(histogram.numBuckets(), 10U);
+    ASSERT_EQ(histogram.totalCount(), 1000.0);
+    ASSERT_EQ(histogram.estimateInterval(IndexBoundsBuilder::allValues()), 1000.0);
+}
+
+TEST(HistogramTest, EstimatesUniformRanges) {
+    auto histogram = buildHistogram(makeRange(0, 1000), 10);
+
+    auto interval = IndexBoundsBuilder::makeRangeInterval(
+        BSON("" << 100 << "" << 200), BoundInclusion::kIncludeBothStartAndEndKeys);
+    ASSERT_APPROX_EQUAL(histogram.estimateInterval(interval), 100.0, 5.0);
+
+    // The direction of the interval does not matter.
+    ASSERT_APPROX_EQUAL(histogram.estimateInterval(interval.reverseClone()), 100.0, 5.0);
+
+    auto lessThan = IndexBoundsBuilder::makeRangeInterval(
+        BSON("" << -std::numeric_limits<double>::infinity() << "" << 500),
+        BoundInclusion::kIncludeStartKeyOnly);
+    ASSERT_APPROX_EQUAL(histogram.estimateInterval(lessThan), 500.0, 5.0);
+}
+
+TEST(HistogramTest, EstimatesPopularValuesPrecisely) {
+    auto values = makeRange(0, 100);
+    for (int i = 0; i < 900; ++i) {
+        values.push_back(BSON("" << 42));
+    }
+    auto histogram = buildHistogram(std::move(values), 10);
+
+    ASSERT_EQ(histogram.estimateEquality(BSON("" << 42).firstElement()), 901.0);
+    ASSERT_LTE(histogram.estimateEquality(BSON("" << 7).firstElement()), 2.0);
+    ASSERT_EQ(histogram.estimateEquality(BSON("" << 1000).firstElement()), 0.0);
+}
+
+TEST(HistogramTest, ComparesNumbersOfDifferentTypesByValue) {
+    auto histogram = buildHistogram(makeRange(0, 10), 20);
+    ASSERT_EQ(histogram.estimateEquality(BSON("" << 5.0).firstElement()), 1.0);
+    ASSERT_EQ(histogram.estimateEquality(BSON("" << 5LL).firstElement()), 1.0);
+}
+
+TEST(HistogramTest, SeparatesTypes) {
+    auto values = makeRange(0, 100);
+    for (int i = 0; i < 50; ++i) {
+        values.push_back(BSON("" << std::string(1, 'a' + (i % 26))));
+    }
+    auto histogram = buildHistogram(std::move(values), 1000);
+
+    auto allNumbers = IndexBoundsBuilder::makeRangeInterval(
+        BSON("" << -std::numeric_limits<double>::infinity() << ""
+                << std::numeric_limits<double>::infinity()),
+        BoundInclusion::kIncludeBothStartAndEndKeys);
+    ASSERT_EQ(histogram.estimateInterval(allNumbers), 100.0);
+}
+
+TEST(HistogramTest, RoundTripsThroughBSON) {
+    auto histogram = buildHistogram(makeRange(0, 1000), 10);
+    auto parsed = Histogram::parse(histogram.toBSON());
+
+    ASSERT_EQ(parsed.numBuckets(), histogram.numBuckets());
+    ASSERT_EQ(parsed.totalCount(), histogram.totalCount());
+    auto interval = IndexBoundsBuilder::makeRangeInterval(
+        BSON("" << 123 << "" << 456), BoundInclusion::kIncludeStartKeyOnly);
+    ASSERT_EQ(parsed.estimateInterval(interval), histogram.estimateInterval(interval));
+}
+
+TEST(HistogramTest, ParseRejectsMismatchedArrays) {
+    auto obj = BSON("bounds" << BSON_ARRAY(1 << 2) << "rangeCounts" << BSON_ARRAY(0 << 1)
+                             << "rangeDistinctCounts" << BSON_ARRAY(0) << "boundCounts"
+                             << BSON_ARRAY(1 << 1));
+    ASSERT_THROWS_CODE(Histogram::parse(obj), DBException, 5095406);
+}
+
+TEST(DistinctCountSketchTest, EstimatesDistinctValues) {
+    DistinctCountSketch sketch;
+    for (int i = 0; i < 100000; ++i) {
+        sketch.add(BSON("" << i).firstElement());
+    }
+    ASSERT_APPROX_EQUAL(sketch.estimate(), 100000.0, 10000.0);
+}
+
+TEST(DistinctCountSketchTest, IgnoresDuplicates) {
+    DistinctCountSketch sketch;
+    for (int i = 0; i < 10000; ++i) {
+        sketch.add(BSON("" << (i % 10)).firstElement());
+        sketch.add(BSON("" << static_cast<double>(i % 10)).firstElement());
+    }
+    ASSERT_APPROX_EQUAL(sketch.estimate(), 10.0, 1.0);
+}
+
+TEST(DistinctCountSketchTest, RoundTripsThroughBSON) {
+    DistinctCountSketch sketch;
+    for (int i = 0; i < 1000; ++i) {
+        sketch.add(BSON("" << i).firstElement());
+    }
+
+    BSONObjBuilder builder;
+    sketch.serialize("sketch", &builder);
+    auto obj = builder.obj();
+    ASSERT_EQ(DistinctCountSketch::parse(obj["sketch"]).estimate(), sketch.estimate());
+}
+
+TEST(FieldStatisticsBuilderTest, ExpandsArraysAndCountsMissingAsNull) {
+    FieldStatisticsBuilder builder("a.b");
+    builder.addDocument(BSON("a" << BSON("b" << 1)), true);
+    builder.addDocument(BSON("a" << BSON_ARRAY(BSON("b" << 2) << BSON("b" << 3))), true);
+    builder.addDocument(BSON("a" << BSON("b" << BSON_ARRAY(3 << 3 << 4))), true);
+    builder.addDocument(BSON("c" << 1), true);
+
+    auto stats = builder.done(10);
+    ASSERT_EQ(stats.path, "a.b");
+    ASSERT_EQ(stats.valueCount, 6.0);
+    ASSERT_APPROX_EQUAL(stats.distinctCount, 5.0, 0.5);
+    ASSERT_EQ(stats.histogram.estimateEquality(BSON("" << 3).firstElement()), 2.0);
+    ASSERT_EQ(stats.histogram.estimateEquality(BSON("" << BSONNULL).firstElement()), 1.0);
+}
+
+TEST(FieldStatisticsBuilderTest, ScalesSampleToAllDocuments) {
+    FieldStatisticsBuilder builder("a");
+    for (int i = 0; i < 1000; ++i) {
+        builder.addDocument(BSON("a" << (i % 2)), i % 10 == 0);
+    }
+
+    auto stats = builder.done(10);
+    ASSERT_EQ(stats.valueCount, 1000.0);
+    ASSERT_EQ(stats.histogram.totalCount(), 1000.0);
+    ASSERT_EQ(stats.histogram.estimateEquality(BSON("" << 0).firstElement()), 1000.0);
+}
+}  // namespace
+}  // namespace mongo
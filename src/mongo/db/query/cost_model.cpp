@@ -0,0 +1,340 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/cost_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/index_names.h"
+#include "mongo/db/matcher/expression_leaf.h"
+
+namespace mongo::cost_model {
+namespace {
+struct NodeEstimate {
+    double cardinality{0};
+    double cost{0};
+    // Whether the node consumes all of its input before returning its first result.
+    bool blocking{false};
+};
+
+/**
+ * Returns the fraction of the documents of the collection which 'count' values of a path stand
+ * for.
+ */
+double countToSelectivity(const CollectionStatistics& stats, double count) {
+    return stats.numDocuments > 0 ? std::clamp(count / stats.numDocuments, 0.0, 1.0) : 1.0;
+}
+
+/**
+ * Returns the interval of values matching a comparison against 'rhs', bracketed by type the same
+ * way the index bounds builder brackets it.
+ */
+Interval makeComparisonInterval(MatchExpression::MatchType matchType, const BSONElement& rhs) {
+    BSONObjBuilder builder;
+    switch (matchType) {
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+            builder.appendMinForType("", rhs.type());
+            builder.appendAs(rhs, "");
+            return Interval(builder.obj(), true, matchType == MatchExpression::LTE);
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+            builder.appendAs(rhs, "");
+            builder.appendMaxForType("", rhs.type());
+            return Interval(builder.obj(), matchType == MatchExpression::GTE, true);
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+double estimateEqualitySelectivity(const CollectionStatistics& stats,
+                                   StringData path,
+                                   const BSONElement& rhs) {
+    auto fieldStats = stats.getField(path);
+    if (!fieldStats || fieldStats->histogram.empty() || rhs.type() == BSONType::Array ||
+        rhs.type() == BSONType::RegEx) {
+        return kDefaultEqualitySelectivity;
+    }
+    return countToSelectivity(stats, fieldStats->histogram.estimateEquality(rhs));
+}
+
+double estimateComparisonSelectivity(const CollectionStatistics& stats,
+                                     const ComparisonMatchExpressionBase* expr) {
+    const auto& rhs = expr->getData();
+    if (expr->matchType() == MatchExpression::EQ) {
+        return estimateEqualitySelectivity(stats, expr->path(), rhs);
+    }
+
+    auto fieldStats = stats.getField(expr->path());
+    if (!fieldStats || fieldStats->histogram.empty() || rhs.type() == BSONType::Array ||
+        rhs.type() == BSONType::MinKey || rhs.type() == BSONType::MaxKey) {
+        return kDefaultRangeSelectivity;
+    }
+    auto interval = makeComparisonInterval(expr->matchType(), rhs);
+    return countToSelectivity(stats, fieldStats->histogram.estimateInterval(interval));
+}
+
+/**
+ * Returns the estimated number of keys within the intervals of 'oil', or boost::none if the field
+ * of 'oil' has not been analyzed.
+ */
+boost::optional<double> estimateIntervals(const CollectionStatistics& stats,
+                                          const OrderedIntervalList& oil) {
+    auto fieldStats = stats.getField(oil.name);
+    if (!fieldStats || fieldStats->histogram.empty()) {
+        return boost::none;
+    }
+
+    double count = 0;
+    for (auto&& interval : oil.intervals) {
+        count += fieldStats->histogram.estimateInterval(interval);
+    }
+    return count;
+}
+
+class CostEstimator {
+public:
+    explicit CostEstimator(const CollectionStatistics& stats) : _stats(stats) {}
+
+    boost::optional<NodeEstimate> estimate(QuerySolutionNode* node) {
+        auto result = estimateNode(node);
+        if (!result) {
+            return boost::none;
+        }
+
+        // Any node may carry a filter of its own.
+        if (node->filter) {
+            result->cost += result->cardinality * kFilterCost;
+            result->cardinality *= estimateSelectivity(_stats, node->filter.get());
+        }
+        node->estimatedCardinality = result->cardinality;
+        return result;
+    }
+
+private:
+    boost::optional<NodeEstimate> estimateNode(QuerySolutionNode* node) {
+        std::vector<NodeEstimate> children;
+        for (auto&& child : node->children) {
+            auto childEstimate = estimate(child);
+            if (!childEstimate) {
+                return boost::none;
+            }
+            children.push_back(*childEstimate);
+        }
+
+        switch (node->getType()) {
+            case STAGE_COLLSCAN:
+                return NodeEstimate{_stats.numDocuments, _stats.numDocuments * kDocumentScanCost};
+            case STAGE_IXSCAN:
+                return estimateIndexScan(static_cast<const IndexScanNode*>(node));
+            case STAGE_FETCH:
+                return NodeEstimate{children[0].cardinality,
+                                    children[0].cost + children[0].cardinality * kFetchCost,
+                                    children[0].blocking};
+            case STAGE_AND_HASH:
+            case STAGE_AND_SORTED: {
+                NodeEstimate result{_stats.numDocuments, 0, node->getType() == STAGE_AND_HASH};
+                for (auto&& child : children) {
+                    result.cost += child.cost;
+                    result.cardinality *= countToSelectivity(_stats, child.cardinality);
+                }
+                return result;
+            }
+            case STAGE_OR:
+            case STAGE_SORT_MERGE: {
+                NodeEstimate result;
+                for (auto&& child : children) {
+                    result.cost += child.cost + child.cardinality * kProcessCost;
+                    result.cardinality += child.cardinality;
+                }
+                result.cardinality = std::min(result.cardinality, _stats.numDocuments);
+                return result;
+            }
+            case STAGE_SORT_DEFAULT:
+            case STAGE_SORT_SIMPLE: {
+                const auto limit = static_cast<const SortNode*>(node)->limit;
+                const auto& child = children[0];
+                const double sortCost =
+                    child.cardinality * std::log2(std::max(2.0, child.cardinality)) * kSortCost;
+                NodeEstimate result{child.cardinality, child.cost + sortCost, true};
+                if (limit > 0) {
+                    result.cardinality = std::min(result.cardinality, static_cast<double>(limit));
+                }
+                return result;
+            }
+            case STAGE_LIMIT: {
+                const double limit = static_cast<const LimitNode*>(node)->limit;
+                const auto& child = children[0];
+                NodeEstimate result{std::min(child.cardinality, limit), child.cost, child.blocking};
+
+                // A streaming plan stops doing work once the limit is reached.
+                if (!child.blocking && child.cardinality > limit) {
+                    result.cost *= limit / child.cardinality;
+                }
+                return result;
+            }
+            case STAGE_SKIP: {
+                const double skip = static_cast<const SkipNode*>(node)->skip;
+                const auto& child = children[0];
+                return NodeEstimate{
+                    std::max(0.0, child.cardinality - skip), child.cost, child.blocking};
+            }
+            case STAGE_PROJECTION_DEFAULT:
+            case STAGE_PROJECTION_COVERED:
+            case STAGE_PROJECTION_SIMPLE:
+            case STAGE_SORT_KEY_GENERATOR:
+            case STAGE_RETURN_KEY:
+            case STAGE_SHARDING_FILTER:
+            case STAGE_ENSURE_SORTED: {
+                const auto& child = children[0];
+                return NodeEstimate{child.cardinality,
+                                    child.cost + child.cardinality * kProcessCost,
+                                    child.blocking};
+            }
+            default:
+                return boost::none;
+        }
+    }
+
+    boost::optional<NodeEstimate> estimateIndexScan(const IndexScanNode* ixn) {
+        if (ixn->index.type != INDEX_BTREE || ixn->bounds.isSimpleRange ||
+            ixn->bounds.fields.empty()) {
+            return boost::none;
+        }
+
+        auto keys = estimateIntervals(_stats, ixn->bounds.fields[0]);
+        if (!keys) {
+            return boost::none;
+        }
+
+        // The bounds on the remaining fields narrow the scan down further, independently of the
+        // bounds on the leading field.
+        for (size_t i = 1; i < ixn->bounds.fields.size(); ++i) {
+            const auto& oil = ixn->bounds.fields[i];
+            if (oil.isMinToMax()) {
+                continue;
+            }
+
+            if (auto fieldKeys = estimateIntervals(_stats, oil)) {
+                *keys *= countToSelectivity(_stats, *fieldKeys);
+            } else {
+                *keys *= kDefaultRangeSelectivity;
+            }
+        }
+
+        // A scan always examines at least the key it seeks to.
+        const double keysExamined = std::max(1.0, *keys);
+        const double seeks = std::max<size_t>(1, ixn->bounds.fields[0].intervals.size());
+
+        // The scan of a multikey index returns each document at most once.
+        const double cardinality =
+            ixn->index.multikey ? std::min(keysExamined, _stats.numDocuments) : keysExamined;
+        return NodeEstimate{cardinality, seeks * kIndexSeekCost + keysExamined * kIndexKeyCost};
+    }
+
+    const CollectionStatistics& _stats;
+};
+}  // namespace
+
+boost::optional<CostEstimate> estimateCost(const CollectionStatistics& stats,
+                                           QuerySolution* solution) {
+    auto result = CostEstimator{stats}.estimate(solution->root());
+    if (!result) {
+        return boost::none;
+    }
+
+    solution->estimatedCost = result->cost;
+    return CostEstimate{result->cardinality, result->cost};
+}
+
+double estimateSelectivity(const CollectionStatistics& stats, const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::AND: {
+            double selectivity = 1.0;
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                selectivity *= estimateSelectivity(stats, expr->getChild(i));
+            }
+            return selectivity;
+        }
+        case MatchExpression::OR:
+        case MatchExpression::NOR: {
+            double noneMatch = 1.0;
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                noneMatch *= 1.0 - estimateSelectivity(stats, expr->getChild(i));
+            }
+            return expr->matchType() == MatchExpression::OR ? 1.0 - noneMatch : noneMatch;
+        }
+        case MatchExpression::NOT:
+            return 1.0 - estimateSelectivity(stats, expr->getChild(0));
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+            return estimateComparisonSelectivity(
+                stats, static_cast<const ComparisonMatchExpressionBase*>(expr));
+        case MatchExpression::MATCH_IN: {
+            auto inExpr = static_cast<const InMatchExpression*>(expr);
+            double selectivity = inExpr->getRegexes().size() * kDefaultSelectivity;
+            for (auto&& equality : inExpr->getEqualities()) {
+                selectivity += estimateEqualitySelectivity(stats, inExpr->path(), equality);
+            }
+            return std::min(selectivity, 1.0);
+        }
+        default:
+            return kDefaultSelectivity;
+    }
+}
+
+bool rankSolutions(const CollectionStatistics& stats,
+                   double dominanceRatio,
+                   std::vector<std::unique_ptr<QuerySolution>>* solutions) {
+    std::vector<double> costs;
+    for (auto&& solution : *solutions) {
+        auto estimate = estimateCost(stats, solution.get());
+        if (!estimate) {
+            return false;
+        }
+        costs.push_back(estimate->cost);
+    }
+
+    const double cheapest = *std::min_element(costs.begin(), costs.end());
+    std::vector<std::unique_ptr<QuerySolution>> remaining;
+    for (size_t i = 0; i < solutions->size(); ++i) {
+        if (costs[i] == cheapest || costs[i] < cheapest * dominanceRatio) {
+            remaining.push_back(std::move((*solutions)[i]));
+        }
+    }
+    *solutions = std::move(remaining);
+    return true;
+}
+}  // namespace mongo::cost_model
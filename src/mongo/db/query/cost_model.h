@@ -0,0 +1,87 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/db/query/query_solution.h"
+
+/**
+ * A cost model for query solutions, based on the statistics the 'analyze' command gathers.
+ *
+ * Cardinalities are estimated bottom up: index scans from the histograms of the fields of their
+ * bounds, and filters from the histograms of the paths they test, assuming that predicates on
+ * different paths are independent. The cost of a plan is the sum of the work its stages are
+ * expected to do, measured in units of examining one index key.
+ */
+namespace mongo::cost_model {
+// The costs of the basic operations a plan performs, relative to examining one index key.
+constexpr double kIndexKeyCost = 1.0;
+constexpr double kIndexSeekCost = 10.0;
+constexpr double kDocumentScanCost = 1.0;
+constexpr double kFetchCost = 5.0;
+constexpr double kFilterCost = 0.2;
+constexpr double kSortCost = 0.5;
+constexpr double kProcessCost = 0.1;
+
+// The selectivities assumed for predicates on paths without statistics.
+constexpr double kDefaultEqualitySelectivity = 0.1;
+constexpr double kDefaultRangeSelectivity = 0.3;
+constexpr double kDefaultSelectivity = 0.5;
+
+struct CostEstimate {
+    double cardinality{0};
+    double cost{0};
+};
+
+/**
+ * Estimates the cost of 'solution' and records the estimated cardinality of each of its nodes.
+ * Returns boost::none if the solution contains a stage the model does not know how to cost, or an
+ * index scan over a leading field which has not been analyzed.
+ */
+boost::optional<CostEstimate> estimateCost(const CollectionStatistics& stats,
+                                           QuerySolution* solution);
+
+/**
+ * Estimates the selectivity of 'expr' over the documents of the collection.
+ */
+double estimateSelectivity(const CollectionStatistics& stats, const MatchExpression* expr);
+
+/**
+ * Costs every candidate in 'solutions' and discards the candidates which are estimated to be at
+ * least 'dominanceRatio' times as expensive as the cheapest one. Returns false, leaving
+ * 'solutions' untouched, if some candidate cannot be costed.
+ */
+bool rankSolutions(const CollectionStatistics& stats,
+                   double dominanceRatio,
+                   std::vector<std::unique_ptr<QuerySolution>>* solutions);
+}  // namespace mongo::cost_model
@@ -0,0 +1,202 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/cost_model.h"
+
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/index_entry.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+/**
+ * Statistics of a collection of 1000 documents where 'a' is unique and 'b' is 0 in all but 10
+ * documents.
+ */
+CollectionStatistics makeStatistics() {
+    FieldStatisticsBuilder aBuilder("a");
+    FieldStatisticsBuilder bBuilder("b");
+    for (int i = 0; i < 1000; ++i) {
+        auto doc = BSON("a" << i << "b" << (i < 990 ? 0 : 1));
+        aBuilder.addDocument(doc, true);
+        bBuilder.addDocument(doc, true);
+    }
+
+    CollectionStatistics stats;
+    stats.numDocuments = 1000;
+    stats.fields["a"] = aBuilder.done(100);
+    stats.fields["b"] = bBuilder.done(100);
+    return stats;
+}
+
+IndexEntry buildSimpleIndexEntry(const BSONObj& kp) {
+    return {kp,
+            IndexNames::nameToType(IndexNames::findPluginName(kp)),
+            false,
+            {},
+            {},
+            false,
+            false,
+            CoreIndexInfo::Identifier("test_foo"),
+            nullptr,
+            {},
+            nullptr,
+            nullptr};
+}
+
+std::unique_ptr<MatchExpression> parseMatchExpression(const BSONObj& obj) {
+    auto status = MatchExpressionParser::parse(obj, make_intrusive<ExpressionContextForTest>());
+    ASSERT_OK(status.getStatus());
+    return std::move(status.getValue());
+}
+
+/**
+ * Makes a solution fetching the documents whose 'field' equals 'value' from an index on 'field'.
+ */
+std::unique_ptr<QuerySolution> makeIndexScanSolution(StringData field, int value) {
+    auto ixn = std::make_unique<IndexScanNode>(buildSimpleIndexEntry(BSON(field << 1)));
+    OrderedIntervalList oil(field.toString());
+    oil.intervals.push_back(IndexBoundsBuilder::makePointInterval(BSON("" << value)));
+    ixn->bounds.fields.push_back(oil);
+
+    auto fetch = std::make_unique<FetchNode>();
+    fetch->children.push_back(ixn.release());
+
+    auto solution = std::make_unique<QuerySolution>();
+    solution->setRoot(std::move(fetch));
+    return solution;
+}
+
+std::unique_ptr<QuerySolution> makeCollectionScanSolution(const BSONObj& filter) {
+    auto csn = std::make_unique<CollectionScanNode>();
+    csn->filter = parseMatchExpression(filter);
+
+    auto solution = std::make_unique<QuerySolution>();
+    solution->setRoot(std::move(csn));
+    return solution;
+}
+
+TEST(CostModelTest, SelectiveIndexScanIsCheaperThanCollectionScan) {
+    auto stats = makeStatistics();
+    const auto filter = BSON("a" << 5);
+    auto ixscan = makeIndexScanSolution("a", 5);
+    auto collscan = makeCollectionScanSolution(filter);
+
+    auto ixscanCost = cost_model::estimateCost(stats, ixscan.get());
+    auto collscanCost = cost_model::estimateCost(stats, collscan.get());
+    ASSERT(ixscanCost);
+    ASSERT(collscanCost);
+    ASSERT_LT(ixscanCost->cost, collscanCost->cost);
+    ASSERT_APPROX_EQUAL(ixscanCost->cardinality, 1.0, 0.5);
+    ASSERT_APPROX_EQUAL(collscanCost->cardinality, 1.0, 0.5);
+}
+
+TEST(CostModelTest, UnselectiveIndexScanIsMoreExpensiveThanCollectionScan) {
+    auto stats = makeStatistics();
+    const auto filter = BSON("b" << 0);
+    auto ixscan = makeIndexScanSolution("b", 0);
+    auto collscan = makeCollectionScanSolution(filter);
+
+    auto ixscanCost = cost_model::estimateCost(stats, ixscan.get());
+    auto collscanCost = cost_model::estimateCost(stats, collscan.get());
+    ASSERT(ixscanCost);
+    ASSERT(collscanCost);
+    ASSERT_GT(ixscanCost->cost, collscanCost->cost);
+    ASSERT_EQ(ixscanCost->cardinality, 990.0);
+}
+
+TEST(CostModelTest, AnnotatesEveryNodeWithItsCardinality) {
+    auto stats = makeStatistics();
+    auto solution = makeIndexScanSolution("b", 1);
+    ASSERT(cost_model::estimateCost(stats, solution.get()));
+
+    ASSERT(solution->estimatedCost);
+    ASSERT_EQ(solution->root()->estimatedCardinality.value_or(0), 10.0);
+    ASSERT_EQ(solution->root()->children[0]->estimatedCardinality.value_or(0), 10.0);
+}
+
+TEST(CostModelTest, CannotCostIndexScanOverFieldWithoutStatistics) {
+    auto stats = makeStatistics();
+    auto solution = makeIndexScanSolution("c", 1);
+    ASSERT_FALSE(cost_model::estimateCost(stats, solution.get()));
+}
+
+TEST(CostModelTest, EstimatesRangeSelectivityFromHistogram) {
+    auto stats = makeStatistics();
+    const auto filter = BSON("a" << BSON("$lt" << 100));
+    auto expr = parseMatchExpression(filter);
+    ASSERT_APPROX_EQUAL(cost_model::estimateSelectivity(stats, expr.get()), 0.1, 0.01);
+}
+
+TEST(CostModelTest, AssumesIndependenceOfPredicatesOnDifferentPaths) {
+    auto stats = makeStatistics();
+    const auto filter = BSON("a" << BSON("$lt" << 100) << "b" << 1);
+    auto expr = parseMatchExpression(filter);
+    ASSERT_APPROX_EQUAL(cost_model::estimateSelectivity(stats, expr.get()), 0.001, 0.0005);
+}
+
+TEST(CostModelTest, RankingDiscardsDominatedCandidates) {
+    auto stats = makeStatistics();
+    const auto filter = BSON("a" << 5);
+    std::vector<std::unique_ptr<QuerySolution>> solutions;
+    solutions.push_back(makeCollectionScanSolution(filter));
+    solutions.push_back(makeIndexScanSolution("a", 5));
+
+    ASSERT_TRUE(cost_model::rankSolutions(stats, 10.0, &solutions));
+    ASSERT_EQ(solutions.size(), 1U);
+    ASSERT_EQ(solutions[0]->root()->getType(), STAGE_FETCH);
+}
+
+TEST(CostModelTest, RankingKeepsCompetitiveCandidates) {
+    auto stats = makeStatistics();
+    const auto filter = BSON("b" << 0);
+    std::vector<std::unique_ptr<QuerySolution>> solutions;
+    solutions.push_back(makeCollectionScanSolution(filter));
+    solutions.push_back(makeIndexScanSolution("b", 0));
+
+    ASSERT_TRUE(cost_model::rankSolutions(stats, 10.0, &solutions));
+    ASSERT_EQ(solutions.size(), 2U);
+}
+
+TEST(CostModelTest, RankingLeavesCandidatesAloneIfOneCannotBeCosted) {
+    auto stats = makeStatistics();
+    const auto filter = BSON("a" << 5);
+    std::vector<std::unique_ptr<QuerySolution>> solutions;
+    solutions.push_back(makeCollectionScanSolution(filter));
+    solutions.push_back(makeIndexScanSolution("c", 5));
+
+    ASSERT_FALSE(cost_model::rankSolutions(stats, 10.0, &solutions));
+    ASSERT_EQ(solutions.size(), 2U);
+}
+}  // namespace
+}  // namespace mongo
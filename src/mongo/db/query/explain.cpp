@@ -34,6 +34,7 @@
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/exec/cached_plan.h"
 #include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/column_scan.h"
 #include "mongo/db/exec/count_scan.h"
 #include "mongo/db/exec/distinct_scan.h"
 #include "mongo/db/exec/idhack.h"
@@ -58,6 +59,7 @@
 #include "mongo/db/query/query_settings_decoration.h"
 #include "mongo/db/query/stage_builder.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/storage/record_id_helpers.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/net/socket_utils.h"
 #include "mongo/util/str.h"
@@ -115,6 +117,9 @@ void addStageSummaryStr(const PlanStage* stage, StringBuilder& sb) {
         const TextStats* spec = static_cast<const TextStats*>(specific);
         const KeyPattern keyPattern{spec->indexPrefix};
         sb << " " << keyPattern;
+    } else if (STAGE_COLUMN_SCAN == stage->stageType()) {
+        const ColumnScanStats* spec = static_cast<const ColumnScanStats*>(specific);
+        sb << " " << spec->indexName;
     }
 }
 
@@ -229,6 +234,9 @@ size_t Explain::getKeysExamined(StageType type, const SpecificStats* specific) {
     } else if (STAGE_COUNT_SCAN == type) {
         const CountScanStats* spec = static_cast<const CountScanStats*>(specific);
         return spec->keysExamined;
+    } else if (STAGE_COLUMN_SCAN == type) {
+        const ColumnScanStats* spec = static_cast<const ColumnScanStats*>(specific);
+        return spec->keysExamined;
     } else if (STAGE_DISTINCT_SCAN == type) {
         const DistinctScanStats* spec = static_cast<const DistinctScanStats*>(specific);
         return spec->keysExamined;
@@ -277,6 +285,11 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         bob->append("filter", stats.common.filter);
     }
 
+    // Display the number of results the cost model expected, if the plan was costed.
+    if (stats.common.estimatedCardinality) {
+        bob->append("estimatedCardinality", *stats.common.estimatedCardinality);
+    }
+
     // Some top-level exec stats get pulled out of the root stage.
     if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
         bob->appendNumber("nReturned", stats.common.advanced);
@@ -326,9 +339,23 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (spec->maxTs) {
             bob->append("maxTs", *(spec->maxTs));
         }
+        if (spec->minRecord) {
+            record_id_helpers::appendToBSONAs(*spec->minRecord, bob, "minRecord");
+        }
+        if (spec->maxRecord) {
+            record_id_helpers::appendToBSONAs(*spec->maxRecord, bob, "maxRecord");
+        }
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("docsExamined", spec->docsTested);
         }
+    } else if (STAGE_COLUMN_SCAN == stats.stageType) {
+        ColumnScanStats* spec = static_cast<ColumnScanStats*>(stats.specific.get());
+        bob->append("indexName", spec->indexName);
+        bob->append("fields", spec->fields);
+        if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
+            bob->appendNumber("keysExamined", spec->keysExamined);
+            bob->appendNumber("docsTested", spec->docsTested);
+        }
     } else if (STAGE_COUNT == stats.stageType) {
         CountStats* spec = static_cast<CountStats*>(stats.specific.get());
 
@@ -946,6 +973,23 @@ void Explain::planCacheEntryToBSON(const PlanCacheEntry& entry, BSONObjBuilder*
     scoresBuilder.doneFast();
 
     out->append("indexFilterSet", entry.plannerData[0]->indexFilterApplied);
+
+    BSONObjBuilder feedbackBob(out->subobjStart("executionFeedback"));
+    feedbackBob.append("decisionWorksPerResult", entry.decisionWorksPerResult);
+    feedbackBob.append("numExecutions", static_cast<long long>(entry.feedback.numExecutions));
+    if (entry.feedback.numExecutions > 0) {
+        feedbackBob.append("worksPerResultEwma", entry.feedback.worksPerResultEwma);
+    }
+    BSONArrayBuilder historyBuilder(feedbackBob.subarrayStart("history"));
+    for (auto&& execution : entry.feedback.history) {
+        BSONObjBuilder executionBob(historyBuilder.subobjStart());
+        executionBob.append("works", static_cast<long long>(execution.works));
+        executionBob.append("nReturned", static_cast<long long>(execution.nReturned));
+        executionBob.append("time", execution.time);
+        executionBob.doneFast();
+    }
+    historyBuilder.doneFast();
+    feedbackBob.doneFast();
 }
 
 }  // namespace mongo
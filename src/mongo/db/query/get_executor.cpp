@@ -67,6 +67,8 @@
 #include "mongo/db/query/canonical_query_encoder.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/collection_statistics_catalog.h"
+#include "mongo/db/query/cost_model.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
@@ -84,6 +86,7 @@
 #include "mongo/db/query/query_settings_decoration.h"
 #include "mongo/db/query/sbe_cached_solution_planner.h"
 #include "mongo/db/query/sbe_multi_planner.h"
+#include "mongo/db/query/sbe_plan_cache_util.h"
 #include "mongo/db/query/sbe_sub_planner.h"
 #include "mongo/db/query/stage_builder_util.h"
 #include "mongo/db/query/util/make_data_structure.h"
@@ -279,10 +282,22 @@ void fillOutPlannerParams(OperationContext* opCtx,
         // Skip the addition of hidden indexes to prevent use in query planning.
         if (ice->descriptor()->hidden())
             continue;
+
+        // A column store index can only replace a collection scan, so the planner learns its name
+        // instead of an index entry.
+        if (ice->descriptor()->getIndexType() == IndexType::INDEX_COLUMN_STORE) {
+            plannerParams->columnStoreIndex = ice->descriptor()->indexName();
+            continue;
+        }
+
         plannerParams->indices.push_back(
             indexEntryFromIndexCatalogEntry(opCtx, *ice, canonicalQuery));
     }
 
+    if (collection->isClustered()) {
+        plannerParams->options |= QueryPlannerParams::CLUSTERED_COLLECTION;
+    }
+
     // If query supports index filters, filter params.indices by indices in query settings.
     // Ignore index filters when it is possible to use the id-hack.
     applyIndexFilters(collection, *canonicalQuery, plannerParams);
@@ -444,6 +459,8 @@ private:
  *       the PlanCache, and will hold the number of work cycles taken to decide on a winning plan
  *       when the plan was first cached. It used to decided whether cached solution runtime planning
  *       needs to be done or not.
+ *     - An optional PlanCacheKey, populated along with decisionWorks, which identifies the cache
+ *       entry that the solution was reconstructed from.
  *     - A 'needSubplanning' flag indicating that the query contains rooted $or predicate and is
  *       eligible for runtime sub-planning.
  */
@@ -482,6 +499,10 @@ public:
         return _decisionWorks;
     }
 
+    const boost::optional<PlanCacheKey>& planCacheKey() const {
+        return _planCacheKey;
+    }
+
     bool needsSubplanning() const {
         return _needSubplanning;
     }
@@ -494,10 +515,15 @@ public:
         _decisionWorks = decisionWorks;
     }
 
+    void setPlanCacheKey(PlanCacheKey planCacheKey) {
+        _planCacheKey = std::move(planCacheKey);
+    }
+
 private:
     QuerySolutionVector _solutions;
     PlanStageVector _roots;
     boost::optional<size_t> _decisionWorks;
+    boost::optional<PlanCacheKey> _planCacheKey;
     bool _needSubplanning{false};
 };
 
@@ -569,6 +595,12 @@ public:
                                         << " tailable cursor requested on non capped collection");
         }
 
+        // Plans ranked by cost must not be served from the cache once the statistics they were
+        // costed with have changed.
+        if (internalQueryPlannerEnableCostBasedRanking.load()) {
+            collection_statistics_catalog::clearStaleStatistics(_collection);
+        }
+
         // Check that the query should be cached.
         if (CollectionQueryInfo::get(_collection).getPlanCache()->shouldCacheQuery(*_cq)) {
             // Fill in opDebug information.
@@ -596,8 +628,10 @@ public:
                                     "query"_attr = redact(_cq->toStringShort()));
                     }
 
-                    return buildCachedPlan(
-                        std::move(querySolution), plannerParams, cs->decisionWorks);
+                    return buildCachedPlan(std::move(querySolution),
+                                           plannerParams,
+                                           cs->decisionWorks,
+                                           planCacheKey);
                 }
             }
         }
@@ -640,6 +674,27 @@ public:
             }
         }
 
+        // Cost the candidates using the statistics of the collection, if it has been analyzed,
+        // and discard the ones which are clearly more expensive than the cheapest one without
+        // running them. The histograms are built without regard to collation, so queries with a
+        // collator are left to the multi-planner.
+        if (internalQueryPlannerEnableCostBasedRanking.load() && !_cq->getCollator()) {
+            if (auto stats = collection_statistics_catalog::getStatistics(_opCtx, _collection)) {
+                const auto numCandidates = solutions.size();
+                if (cost_model::rankSolutions(*stats,
+                                              internalQueryCostBasedRankingDominanceRatio.load(),
+                                              &solutions) &&
+                    solutions.size() < numCandidates) {
+                    LOGV2_DEBUG(5095409,
+                                2,
+                                "Discarded candidate plans based on their estimated cost",
+                                "query"_attr = redact(_cq->toStringShort()),
+                                "numCandidates"_attr = numCandidates,
+                                "numRemaining"_attr = solutions.size());
+                }
+            }
+        }
+
         if (1 == solutions.size()) {
             auto result = makeResult();
             // Only one possible plan. Run it. Build the stages from the solution.
@@ -695,7 +750,8 @@ protected:
      */
     virtual std::unique_ptr<ResultType> buildCachedPlan(std::unique_ptr<QuerySolution> solution,
                                                         const QueryPlannerParams& plannerParams,
-                                                        size_t decisionWorks) = 0;
+                                                        size_t decisionWorks,
+                                                        const PlanCacheKey& planCacheKey) = 0;
 
     /**
      * Constructs a special PlanStage tree for rooted $or queries. Each clause of the $or is planned
@@ -817,7 +873,8 @@ protected:
     std::unique_ptr<ClassicPrepareExecutionResult> buildCachedPlan(
         std::unique_ptr<QuerySolution> solution,
         const QueryPlannerParams& plannerParams,
-        size_t decisionWorks) final {
+        size_t decisionWorks,
+        const PlanCacheKey& planCacheKey) final {
         auto result = makeResult();
         auto&& root = buildExecutableTree(*solution);
 
@@ -831,6 +888,7 @@ protected:
                                                           _cq,
                                                           plannerParams,
                                                           decisionWorks,
+                                                          planCacheKey,
                                                           std::move(root)),
                         std::move(solution));
         return result;
@@ -912,11 +970,13 @@ protected:
     std::unique_ptr<SlotBasedPrepareExecutionResult> buildCachedPlan(
         std::unique_ptr<QuerySolution> solution,
         const QueryPlannerParams& plannerParams,
-        size_t decisionWorks) final {
+        size_t decisionWorks,
+        const PlanCacheKey& planCacheKey) final {
         auto result = makeResult();
-        auto execTree = buildExecutableTree(*solution, true);
+        auto execTree = buildCachedExecutableTree(*solution);
         result->emplace(std::move(execTree), std::move(solution));
         result->setDecisionWorks(decisionWorks);
+        result->setPlanCacheKey(planCacheKey);
         return result;
     }
 
@@ -949,6 +1009,31 @@ private:
         return stage_builder::buildSlotBasedExecutableTree(
             _opCtx, _collection, *_cq, solution, _yieldPolicy, needsTrialRunProgressTracker);
     }
+
+    /**
+     * Constructs a PlanStage tree from a cached 'solution'. If the query has been parameterized,
+     * the tree is cloned from the SBE plan cache and re-bound to the constants of this query when
+     * possible, otherwise the newly built tree is added to the SBE plan cache.
+     */
+    std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>
+    buildCachedExecutableTree(const QuerySolution& solution) const {
+        auto key = internalQuerySlotBasedExecutionReuseCachedPlans.load()
+            ? sbe_plan_cache_util::computeKey(_collection, *_cq, solution)
+            : boost::none;
+        if (!key) {
+            return buildExecutableTree(solution, true);
+        }
+
+        if (auto cachedPlan = sbe_plan_cache_util::getCachedPlan(
+                _opCtx, _collection, *_cq, solution, *key, _yieldPolicy)) {
+            return std::move(*cachedPlan);
+        }
+
+        auto execTree = buildExecutableTree(solution, true);
+        sbe_plan_cache_util::cachePlan(
+            _collection, solution, *key, *execTree.first, execTree.second);
+        return execTree;
+    }
 };
 
 StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getClassicExecutor(
@@ -989,6 +1074,7 @@ std::unique_ptr<sbe::RuntimePlanner> makeRuntimePlannerIfNeeded(
     CanonicalQuery* canonicalQuery,
     size_t numSolutions,
     boost::optional<size_t> decisionWorks,
+    const boost::optional<PlanCacheKey>& planCacheKey,
     bool needsSubplanning,
     PlanYieldPolicySBE* yieldPolicy,
     size_t plannerOptions) {
@@ -1025,8 +1111,14 @@ std::unique_ptr<sbe::RuntimePlanner> makeRuntimePlannerIfNeeded(
         plannerParams.options = plannerOptions;
         fillOutPlannerParams(opCtx, collection, canonicalQuery, &plannerParams);
 
-        return std::make_unique<sbe::CachedSolutionPlanner>(
-            opCtx, collection, *canonicalQuery, plannerParams, *decisionWorks, yieldPolicy);
+        invariant(planCacheKey);
+        return std::make_unique<sbe::CachedSolutionPlanner>(opCtx,
+                                                            collection,
+                                                            *canonicalQuery,
+                                                            plannerParams,
+                                                            *decisionWorks,
+                                                            *planCacheKey,
+                                                            yieldPolicy);
     }
 
     // Runtime planning is not required.
@@ -1057,6 +1149,11 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getSlotBasedExe
     invariant(cq);
     auto nss = cq->nss();
     auto yieldPolicy = makeSbeYieldPolicy(opCtx, requestedYieldPolicy, nss);
+    // Move the constants of the query out of the plans built for it, so that a plan built on a
+    // plan cache hit can be reused by other queries of the same shape.
+    if (internalQuerySlotBasedExecutionReuseCachedPlans.load()) {
+        sbe_plan_cache_util::parameterizeQuery(cq.get());
+    }
     SlotBasedPrepareExecutionHelper helper{
         opCtx, collection, cq.get(), yieldPolicy.get(), plannerOptions};
     auto executionResult = helper.prepare();
@@ -1073,6 +1170,7 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getSlotBasedExe
                                                   cq.get(),
                                                   solutions.size(),
                                                   result->decisionWorks(),
+                                                  result->planCacheKey(),
                                                   result->needsSubplanning(),
                                                   yieldPolicy.get(),
                                                   plannerOptions)) {
@@ -1103,7 +1201,10 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutor(
     std::unique_ptr<CanonicalQuery> canonicalQuery,
     PlanYieldPolicy::YieldPolicy yieldPolicy,
     size_t plannerOptions) {
-    return internalQueryEnableSlotBasedExecutionEngine.load()
+    // The slot-based engine holds RecordIds as 64-bit integers, so it cannot read the records of a
+    // clustered collection.
+    return internalQueryEnableSlotBasedExecutionEngine.load() &&
+            !(collection && collection->isClustered())
         ? getSlotBasedExecutor(
               opCtx, collection, std::move(canonicalQuery), yieldPolicy, plannerOptions)
         : getClassicExecutor(
@@ -1126,6 +1227,9 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> _getExecutorFin
     if (OperationShardingState::isOperationVersioned(opCtx)) {
         plannerOptions |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
     }
+    // The documents of a find are only read through its projection, unlike those of an update or
+    // a delete, so they may come from a column store index.
+    plannerOptions |= QueryPlannerParams::COLUMN_SCAN;
     return getExecutor(opCtx, collection, std::move(canonicalQuery), yieldPolicy, plannerOptions);
 }
 
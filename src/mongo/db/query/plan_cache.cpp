@@ -104,8 +104,49 @@ void encodeIndexability(const MatchExpression* tree,
     }
 }
 
+/**
+ * Returns the works performed per returned document by the winning plan during the trial period
+ * which selected it. For SBE plans, the number of physical reads stands in for works.
+ */
+double computeDecisionWorksPerResult(const plan_ranker::PlanRankingDecision& decision) {
+    return stdx::visit(
+        visit_helper::Overloaded{
+            [](const std::vector<std::unique_ptr<PlanStageStats>>& stats) {
+                return stats.empty() ? 0.0
+                                     : PlanCacheEntryFeedback::worksPerResult(
+                                           stats[0]->common.works, stats[0]->common.advanced);
+            },
+            [](const std::vector<std::unique_ptr<sbe::PlanStageStats>>& stats) {
+                return stats.empty() ? 0.0
+                                     : PlanCacheEntryFeedback::worksPerResult(
+                                           calculateNumberOfReads(stats[0].get()),
+                                           stats[0]->common.advances);
+            }},
+        decision.stats);
+}
+
 }  // namespace
 
+//
+// PlanCacheEntryFeedback
+//
+
+double PlanCacheEntryFeedback::worksPerResult(size_t works, size_t nReturned) {
+    return static_cast<double>(works) / std::max<size_t>(nReturned, 1);
+}
+
+void PlanCacheEntryFeedback::record(const Execution& execution, double alpha, size_t maxHistory) {
+    const auto observed = worksPerResult(execution.works, execution.nReturned);
+    worksPerResultEwma =
+        numExecutions == 0 ? observed : alpha * observed + (1 - alpha) * worksPerResultEwma;
+    ++numExecutions;
+
+    history.push_back(execution);
+    while (history.size() > maxHistory) {
+        history.pop_front();
+    }
+}
+
 std::ostream& operator<<(std::ostream& stream, const PlanCacheKey& key) {
     stream << key.stringData();
     return stream;
@@ -267,6 +308,7 @@ PlanCacheEntry::PlanCacheEntry(std::vector<std::unique_ptr<const SolutionCacheDa
       decision(std::move(decision)),
       isActive(isActive),
       works(works),
+      decisionWorksPerResult(computeDecisionWorksPerResult(*this->decision)),
       _entireObjectSize(_estimateObjectSizeInBytes()) {
     // Account for the object in the global metric for estimating the server's total plan cache
     // memory consumption.
@@ -285,17 +327,19 @@ std::unique_ptr<PlanCacheEntry> PlanCacheEntry::clone() const {
     }
 
     auto decisionPtr = std::unique_ptr<plan_ranker::PlanRankingDecision>(decision->clone());
-    return std::unique_ptr<PlanCacheEntry>(new PlanCacheEntry(std::move(solutionCacheData),
-                                                              query,
-                                                              sort,
-                                                              projection,
-                                                              collation,
-                                                              timeOfCreation,
-                                                              queryHash,
-                                                              planCacheKey,
-                                                              std::move(decisionPtr),
-                                                              isActive,
-                                                              works));
+    auto entry = std::unique_ptr<PlanCacheEntry>(new PlanCacheEntry(std::move(solutionCacheData),
+                                                                    query,
+                                                                    sort,
+                                                                    projection,
+                                                                    collation,
+                                                                    timeOfCreation,
+                                                                    queryHash,
+                                                                    planCacheKey,
+                                                                    std::move(decisionPtr),
+                                                                    isActive,
+                                                                    works));
+    entry->feedback = feedback;
+    return entry;
 }
 
 uint64_t PlanCacheEntry::_estimateObjectSizeInBytes() const {
@@ -646,6 +690,53 @@ void PlanCache::deactivate(const CanonicalQuery& query) {
     entry->isActive = false;
 }
 
+bool PlanCache::recordExecutionFeedback(const PlanCacheKey& key,
+                                        size_t works,
+                                        size_t nReturned,
+                                        Date_t now) {
+    const double degradationRatio = internalQueryCacheFeedbackDegradationRatio.load();
+    if (degradationRatio <= 0) {
+        return false;
+    }
+
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    PlanCacheEntry* entry = nullptr;
+    Status cacheStatus = _cache.get(key, &entry);
+    if (!cacheStatus.isOK()) {
+        // The entry may have been evicted or replaced while the query was running.
+        invariant(cacheStatus == ErrorCodes::NoSuchKey);
+        return false;
+    }
+    invariant(entry);
+
+    entry->feedback.record({works, nReturned, now},
+                           internalQueryCacheFeedbackEwmaAlpha.load(),
+                           static_cast<size_t>(internalQueryCacheFeedbackHistorySize.load()));
+
+    if (!entry->isActive || internalQueryCacheDisableInactiveEntries.load() ||
+        entry->feedback.numExecutions <
+            static_cast<size_t>(internalQueryCacheFeedbackMinExecutions.load())) {
+        return false;
+    }
+
+    // Guard against a baseline of zero, which a plan that hit EOF without doing any work has.
+    const double baseline = std::max(entry->decisionWorksPerResult, 1.0);
+    if (entry->feedback.worksPerResultEwma < degradationRatio * baseline) {
+        return false;
+    }
+
+    LOGV2_DEBUG(5095415,
+                1,
+                "Deactivating cache entry whose plan has degraded across executions",
+                "queryHash"_attr = zeroPaddedHex(entry->queryHash),
+                "planCacheKey"_attr = zeroPaddedHex(entry->planCacheKey),
+                "decisionWorksPerResult"_attr = entry->decisionWorksPerResult,
+                "worksPerResultEwma"_attr = entry->feedback.worksPerResultEwma,
+                "numExecutions"_attr = entry->feedback.numExecutions);
+    entry->isActive = false;
+    return true;
+}
+
 PlanCache::GetResult PlanCache::get(const CanonicalQuery& query) const {
     PlanCacheKey key = computeKey(query);
     return get(key);
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/optional/optional.hpp>
+#include <deque>
 #include <set>
 
 #include "mongo/db/exec/plan_stats.h"
@@ -300,6 +301,41 @@ public:
     size_t decisionWorks;
 };
 
+/**
+ * Tracks how efficiently a cached plan has run across the executions which used it. Each
+ * execution reports the number of works performed and documents returned during its trial period,
+ * which are folded into an exponentially weighted moving average of works per returned document.
+ */
+struct PlanCacheEntryFeedback {
+    struct Execution {
+        size_t works = 0;
+        size_t nReturned = 0;
+        Date_t time;
+    };
+
+    /**
+     * Computes the works performed per returned document. Executions which returned nothing are
+     * treated as if they had returned a single document.
+     */
+    static double worksPerResult(size_t works, size_t nReturned);
+
+    /**
+     * Folds the given execution into the moving average, using 'alpha' as the smoothing factor,
+     * and appends it to 'history', keeping only the latest 'maxHistory' executions.
+     */
+    void record(const Execution& execution, double alpha, size_t maxHistory);
+
+    // The number of executions recorded since the entry was created.
+    size_t numExecutions = 0;
+
+    // Moving average of the works performed per returned document. Only meaningful once at least
+    // one execution has been recorded.
+    double worksPerResultEwma = 0;
+
+    // The most recent executions, oldest first.
+    std::deque<Execution> history;
+};
+
 /**
  * Used by the cache to track entries and their performance over time.
  * Also used by the plan cache commands to display plan cache state.
@@ -375,6 +411,13 @@ public:
     // cause this value to be increased.
     size_t works = 0;
 
+    // The works performed per returned document by the winning plan while it was being selected.
+    // Serves as the baseline against which 'feedback' is compared.
+    const double decisionWorksPerResult;
+
+    // Performance of the cached plan on subsequent executions.
+    PlanCacheEntryFeedback feedback;
+
     /**
      * Tracks the approximate cumulative size of the plan cache entries across all the collections.
      */
@@ -488,6 +531,19 @@ public:
      */
     void deactivate(const CanonicalQuery& query);
 
+    /**
+     * Records that the cached plan for the query shape identified by 'key' performed 'works' work
+     * cycles and returned 'nReturned' documents during its trial period. If the moving average of
+     * works per returned document has degraded to 'internalQueryCacheFeedbackDegradationRatio'
+     * times what was observed when the plan was cached, the entry is deactivated so that the next
+     * query of this shape re-plans. Does nothing if the ratio is 0. Returns true if the entry was
+     * deactivated by this call.
+     */
+    bool recordExecutionFeedback(const PlanCacheKey& key,
+                                 size_t works,
+                                 size_t nReturned,
+                                 Date_t now);
+
     /**
      * Look up the cached data access for the provided 'query'.  Used by the query planner
      * to shortcut planning.
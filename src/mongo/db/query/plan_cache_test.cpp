@@ -826,6 +826,119 @@ TEST(PlanCacheTest, DeactivateCacheEntry) {
     ASSERT_EQ(entry->works, 20U);
 }
 
+/**
+ * Creates an active cache entry for 'cq' whose winning plan performed 'works' works and returned
+ * no documents while it was being selected.
+ */
+void addActiveCacheEntry(const CanonicalQuery& cq, PlanCache* planCache, size_t works) {
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get()};
+    ASSERT_OK(planCache->set(cq, solns, createDecision(1U, works), Date_t{}));
+    ASSERT_OK(planCache->set(cq, solns, createDecision(1U, works), Date_t{}));
+    ASSERT_EQ(planCache->get(cq).state, PlanCache::CacheEntryState::kPresentActive);
+}
+
+TEST(PlanCacheTest, ExecutionFeedbackIsRecordedInCacheEntry) {
+    const auto oldHistorySize = internalQueryCacheFeedbackHistorySize.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheFeedbackHistorySize.store(oldHistorySize); });
+    internalQueryCacheFeedbackHistorySize.store(3);
+
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QueryTestServiceContext serviceContext;
+    addActiveCacheEntry(*cq, &planCache, 20);
+
+    auto entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_EQ(entry->decisionWorksPerResult, 20.0);
+    ASSERT_EQ(entry->feedback.numExecutions, 0U);
+    ASSERT_TRUE(entry->feedback.history.empty());
+
+    // Executions which are as efficient as the one that cached the plan leave the entry active.
+    const auto key = planCache.computeKey(*cq);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_FALSE(
+            planCache.recordExecutionFeedback(key, 40, 2, Date_t::fromMillisSinceEpoch(i)));
+    }
+
+    entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_TRUE(entry->isActive);
+    ASSERT_EQ(entry->feedback.numExecutions, 5U);
+    ASSERT_EQ(entry->feedback.worksPerResultEwma, 20.0);
+
+    // Only the most recent executions are retained.
+    ASSERT_EQ(entry->feedback.history.size(), 3U);
+    ASSERT_EQ(entry->feedback.history.front().time, Date_t::fromMillisSinceEpoch(2));
+    ASSERT_EQ(entry->feedback.history.back().time, Date_t::fromMillisSinceEpoch(4));
+    ASSERT_EQ(entry->feedback.history.back().works, 40U);
+    ASSERT_EQ(entry->feedback.history.back().nReturned, 2U);
+}
+
+TEST(PlanCacheTest, ExecutionFeedbackMaintainsMovingAverage) {
+    PlanCacheEntryFeedback feedback;
+    feedback.record({10, 1, Date_t{}}, 0.5, 10);
+    ASSERT_EQ(feedback.worksPerResultEwma, 10.0);
+    feedback.record({60, 2, Date_t{}}, 0.5, 10);
+    ASSERT_EQ(feedback.worksPerResultEwma, 20.0);
+
+    // An execution which returned nothing is treated as if it had returned a single document.
+    feedback.record({40, 0, Date_t{}}, 0.5, 10);
+    ASSERT_EQ(feedback.worksPerResultEwma, 30.0);
+    ASSERT_EQ(feedback.numExecutions, 3U);
+}
+
+TEST(PlanCacheTest, DegradedCacheEntryIsDeactivatedByExecutionFeedback) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QueryTestServiceContext serviceContext;
+    addActiveCacheEntry(*cq, &planCache, 10);
+    const auto key = planCache.computeKey(*cq);
+
+    // The entry is not deactivated until enough executions have been observed, however poorly
+    // they performed.
+    const auto minExecutions = internalQueryCacheFeedbackMinExecutions.load();
+    for (int i = 1; i < minExecutions; ++i) {
+        ASSERT_FALSE(planCache.recordExecutionFeedback(key, 1000, 1, Date_t{}));
+        ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+    }
+
+    ASSERT_TRUE(planCache.recordExecutionFeedback(key, 1000, 1, Date_t{}));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentInactive);
+
+    // The works value is left alone, so that the next plan to be cached must beat it.
+    auto entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_EQ(entry->works, 10U);
+    ASSERT_EQ(entry->feedback.numExecutions, static_cast<size_t>(minExecutions));
+
+    // Feedback for an inactive entry does not deactivate it again.
+    ASSERT_FALSE(planCache.recordExecutionFeedback(key, 1000, 1, Date_t{}));
+
+    // A newly cached plan starts over with no feedback.
+    addActiveCacheEntry(*cq, &planCache, 5);
+    entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_EQ(entry->feedback.numExecutions, 0U);
+}
+
+TEST(PlanCacheTest, ExecutionFeedbackDeactivationCanBeDisabled) {
+    const auto oldRatio = internalQueryCacheFeedbackDegradationRatio.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheFeedbackDegradationRatio.store(oldRatio); });
+    internalQueryCacheFeedbackDegradationRatio.store(0);
+
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QueryTestServiceContext serviceContext;
+    addActiveCacheEntry(*cq, &planCache, 10);
+
+    const auto key = planCache.computeKey(*cq);
+    for (int i = 0; i < 2 * internalQueryCacheFeedbackMinExecutions.load(); ++i) {
+        ASSERT_FALSE(planCache.recordExecutionFeedback(key, 1000, 1, Date_t{}));
+    }
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+
+    // No feedback is recorded while it is disabled.
+    auto entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_EQ(entry->feedback.numExecutions, 0U);
+}
+
 TEST(PlanCacheTest, GetMatchingStatsMatchesAndSerializesCorrectly) {
     PlanCache planCache;
 
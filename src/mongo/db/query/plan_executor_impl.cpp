@@ -646,6 +646,10 @@ void PlanExecutorImpl::getSummaryStats(PlanSummaryStats* statsOut) const {
             const CountScanStats* countScanStats =
                 static_cast<const CountScanStats*>(countScan->getSpecificStats());
             statsOut->indexesUsed.insert(countScanStats->indexName);
+        } else if (STAGE_COLUMN_SCAN == stages[i]->stageType()) {
+            const ColumnScanStats* columnScanStats =
+                static_cast<const ColumnScanStats*>(stages[i]->getSpecificStats());
+            statsOut->indexesUsed.insert(columnScanStats->indexName);
         } else if (STAGE_IDHACK == stages[i]->stageType()) {
             const IDHackStage* idHackStage = static_cast<const IDHackStage*>(stages[i]);
             const IDHackStats* idHackStats =
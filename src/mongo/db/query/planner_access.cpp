@@ -50,6 +50,7 @@
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/storage/record_id_helpers.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/transitional_tools_do_not_use/vector_spooling.h"
 
@@ -195,6 +196,59 @@ std::pair<boost::optional<Timestamp>, boost::optional<Timestamp>> extractTsRange
     }
 }
 
+/**
+ * Extracts the inclusive bounds on the RecordIds of a clustered collection from the comparisons of
+ * "_id" against a value at the top level of 'me' or inside a top-level $and.
+ */
+std::pair<boost::optional<RecordId>, boost::optional<RecordId>> extractClusteredIdRange(
+    const MatchExpression* me, bool topLevel = true) {
+    boost::optional<RecordId> min;
+    boost::optional<RecordId> max;
+
+    if (me->matchType() == MatchExpression::AND && topLevel) {
+        for (size_t i = 0; i < me->numChildren(); ++i) {
+            boost::optional<RecordId> childMin;
+            boost::optional<RecordId> childMax;
+            std::tie(childMin, childMax) = extractClusteredIdRange(me->getChild(i), false);
+            if (childMin && (!min || childMin.get() > min.get())) {
+                min = childMin;
+            }
+            if (childMax && (!max || childMax.get() < max.get())) {
+                max = childMax;
+            }
+        }
+        return {min, max};
+    }
+
+    if (!ComparisonMatchExpression::isComparisonMatchExpression(me) || me->path() != "_id") {
+        return {min, max};
+    }
+
+    // Leave out the values which the matcher does not only compare by their BSON order.
+    auto rawElem = static_cast<const ComparisonMatchExpression*>(me)->getData();
+    if (rawElem.type() == BSONType::Array || rawElem.type() == BSONType::RegEx ||
+        rawElem.type() == BSONType::Undefined) {
+        return {min, max};
+    }
+
+    switch (me->matchType()) {
+        case MatchExpression::EQ:
+            min = record_id_helpers::keyForId(rawElem);
+            max = min;
+            return {min, max};
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+            min = record_id_helpers::keyForId(rawElem);
+            return {min, max};
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+            max = record_id_helpers::keyForId(rawElem);
+            return {min, max};
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
 /**
  * Returns true if 'me' is a GTE or GE predicate over the "ts" field.
  */
@@ -228,6 +282,7 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
         BSONElement natural = hint[QueryRequest::kNaturalSortField];
         if (natural) {
             csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+            csn->requiresNaturalOrder = true;
         }
     }
 
@@ -237,7 +292,7 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
     // Extract and assign the RecordId from the 'resumeAfter' token, if present.
     const BSONObj& resumeAfterObj = query.getQueryRequest().getResumeAfter();
     if (!resumeAfterObj.isEmpty()) {
-        csn->resumeAfterRecordId = RecordId(resumeAfterObj["$recordId"].numberLong());
+        csn->resumeAfterRecordId = record_id_helpers::fromBSONElement(resumeAfterObj["$recordId"]);
     }
 
     if (query.nss().isOplog() && csn->direction == 1) {
@@ -256,6 +311,13 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
         }
     }
 
+    // The RecordIds of a clustered collection are ordered like the _id values under the simple
+    // collation.
+    if ((params.options & QueryPlannerParams::CLUSTERED_COLLECTION) && resumeAfterObj.isEmpty() &&
+        !query.getCollator()) {
+        std::tie(csn->minRecord, csn->maxRecord) = extractClusteredIdRange(query.root());
+    }
+
     return csn;
 }
 
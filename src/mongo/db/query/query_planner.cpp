@@ -44,6 +44,7 @@
 #include "mongo/db/matcher/expression_algo.h"
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/matcher/expression_text.h"
+#include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/collation/collation_index_key.h"
 #include "mongo/db/query/collation/collator_interface.h"
@@ -325,6 +326,61 @@ std::unique_ptr<QuerySolution> buildCollscanSoln(const CanonicalQuery& query,
     return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
 }
 
+/**
+ * Returns a solution which reads the documents from the column store index of the collection
+ * instead of scanning it, or nullptr if the query needs more than a few of their top-level fields.
+ * The documents only hold the fields needed by the filter, the sort and the projection, so the
+ * query must have a projection which needs neither the whole document nor any metadata.
+ */
+std::unique_ptr<QuerySolution> buildColumnScanSoln(const CanonicalQuery& query,
+                                                   const QueryPlannerParams& params) {
+    const auto& qr = query.getQueryRequest();
+    const auto* proj = query.getProj();
+    if (!(params.options & QueryPlannerParams::COLUMN_SCAN) || !params.columnStoreIndex ||
+        params.options &
+            (QueryPlannerParams::INCLUDE_SHARD_FILTER | QueryPlannerParams::TRACK_LATEST_OPLOG_TS |
+             QueryPlannerParams::CLUSTERED_COLLECTION) ||
+        !proj || proj->type() != projection_ast::ProjectType::kInclusion ||
+        proj->requiresDocument() || proj->requiresMatchDetails() || proj->metadataDeps().any() ||
+        query.metadataDeps().any() || !qr.getHint().isEmpty() || !qr.getMin().isEmpty() ||
+        !qr.getMax().isEmpty() || !qr.getResumeAfter().isEmpty() || qr.getRequestResumeToken() ||
+        qr.isTailable() || query.nss().isOplog() ||
+        QueryPlannerCommon::hasNode(query.root(), MatchExpression::WHERE)) {
+        return nullptr;
+    }
+
+    DepsTracker deps;
+    query.root()->addDependencies(&deps);
+    if (deps.needWholeDocument) {
+        return nullptr;
+    }
+
+    std::set<std::string> paths(deps.fields.begin(), deps.fields.end());
+    paths.insert(proj->getRequiredFields().begin(), proj->getRequiredFields().end());
+    if (auto& sortPattern = query.getSortPattern()) {
+        for (auto&& part : *sortPattern) {
+            if (!part.fieldPath) {
+                return nullptr;
+            }
+            paths.insert(part.fieldPath->fullPath());
+        }
+    }
+
+    // Each column holds the whole value of a top-level field.
+    std::set<std::string> fields;
+    for (auto&& path : paths) {
+        fields.insert(path.substr(0, path.find('.')));
+    }
+    if (fields.size() > static_cast<size_t>(internalQueryColumnScanMaxFields.load())) {
+        return nullptr;
+    }
+
+    auto csn = std::make_unique<ColumnScanNode>(
+        *params.columnStoreIndex, std::vector<std::string>(fields.begin(), fields.end()));
+    csn->filter = query.root()->shallowClone();
+    return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(csn));
+}
+
 std::unique_ptr<QuerySolution> buildWholeIXSoln(const IndexEntry& index,
                                                 const CanonicalQuery& query,
                                                 const QueryPlannerParams& params,
@@ -506,7 +562,10 @@ StatusWith<std::unique_ptr<QuerySolution>> QueryPlanner::planFromCache(
     } else if (SolutionCacheData::COLLSCAN_SOLN == winnerCacheData.solnType) {
         // The cached solution is a collection scan. We don't cache collscans
         // with tailable==true, hence the false below.
-        auto soln = buildCollscanSoln(query, false, params);
+        auto soln = buildColumnScanSoln(query, params);
+        if (!soln) {
+            soln = buildCollscanSoln(query, false, params);
+        }
         if (!soln) {
             return Status(ErrorCodes::NoQueryExecutionPlans,
                           "plan cache error: collection scan soln");
@@ -1101,7 +1160,12 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
     }
 
     if (possibleToCollscan && (collscanRequested || collScanRequired)) {
-        auto collscan = buildCollscanSoln(query, isTailable, params);
+        // When the collection has to be scanned, reading only the columns which the query needs
+        // from a column store index is cheaper.
+        auto collscan = collScanRequired ? buildColumnScanSoln(query, params) : nullptr;
+        if (!collscan) {
+            collscan = buildCollscanSoln(query, isTailable, params);
+        }
         if (!collscan && collScanRequired) {
             return Status(ErrorCodes::NoQueryExecutionPlans,
                           "Failed to build collection scan soln");
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+#include <string>
 #include <vector>
 
 #include "mongo/db/jsobj.h"
@@ -118,6 +120,15 @@ struct QueryPlannerParams {
         // is thought to be helpful in general, but particularly in cases where all children of the
         // $or use the same fields and have the same indexes available, as in this example.
         ENUMERATE_OR_CHILDREN_LOCKSTEP = 1 << 12,
+
+        // Set this if the collection is clustered, so that collection scans only read the range of
+        // records which can match the predicates on _id.
+        CLUSTERED_COLLECTION = 1 << 13,
+
+        // Set this if the documents returned by the plan are only read through its projection, so
+        // that a collection scan may be replaced by a scan of the few columns of a column store
+        // index which the query needs.
+        COLUMN_SCAN = 1 << 14,
     };
 
     // See Options enum above.
@@ -126,6 +137,10 @@ struct QueryPlannerParams {
     // What indices are available for planning?
     std::vector<IndexEntry> indices;
 
+    // The name of the column store index of the collection, if it has one. Column store indexes
+    // are not in 'indices', since they can only stand in for a collection scan.
+    boost::optional<std::string> columnStoreIndex;
+
     // What's our shard key?  If INCLUDE_SHARD_FILTER is set we will create a shard filtering
     // stage.  If we know the shard key, we can perform covering analysis instead of always
     // forcing a fetch.
@@ -636,10 +636,12 @@ Status QueryRequest::validate() const {
         }
         if (!_resumeAfter.isEmpty()) {
             if (_resumeAfter.nFields() != 1 ||
-                _resumeAfter["$recordId"].type() != BSONType::NumberLong) {
+                (_resumeAfter["$recordId"].type() != BSONType::NumberLong &&
+                 _resumeAfter["$recordId"].type() != BSONType::BinData)) {
                 return Status(ErrorCodes::BadValue,
                               "Malformed resume token: the '_resumeAfter' object must contain"
-                              " exactly one field named '$recordId', of type NumberLong.");
+                              " exactly one field named '$recordId', of type NumberLong or"
+                              " BinData.");
             }
         }
     } else if (!_resumeAfter.isEmpty()) {
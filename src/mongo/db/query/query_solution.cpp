@@ -134,6 +134,10 @@ void QuerySolutionNode::addCommon(str::stream* ss, int indent) const {
     *ss << "sortedByDiskLoc = " << sortedByDiskLoc() << '\n';
     addIndent(ss, indent + 1);
     *ss << "providedSorts = {" << providedSorts().debugString() << "}" << '\n';
+    if (estimatedCardinality) {
+        addIndent(ss, indent + 1);
+        *ss << "estimatedCardinality = " << *estimatedCardinality << '\n';
+    }
 }
 
 bool QuerySolutionNode::hasNode(StageType type) const {
@@ -226,10 +230,41 @@ QuerySolutionNode* CollectionScanNode::clone() const {
     copy->name = this->name;
     copy->tailable = this->tailable;
     copy->direction = this->direction;
+    copy->requiresNaturalOrder = this->requiresNaturalOrder;
     copy->shouldTrackLatestOplogTimestamp = this->shouldTrackLatestOplogTimestamp;
     copy->assertMinTsHasNotFallenOffOplog = this->assertMinTsHasNotFallenOffOplog;
     copy->shouldWaitForOplogVisibility = this->shouldWaitForOplogVisibility;
+    copy->minRecord = this->minRecord;
+    copy->maxRecord = this->maxRecord;
+
+    return copy;
+}
 
+//
+// ColumnScanNode
+//
+
+void ColumnScanNode::appendToString(str::stream* ss, int indent) const {
+    addIndent(ss, indent);
+    *ss << "COLUMN_SCAN\n";
+    addIndent(ss, indent + 1);
+    *ss << "indexName = " << indexName << '\n';
+    addIndent(ss, indent + 1);
+    *ss << "fields = [";
+    for (size_t i = 0; i < fields.size(); ++i) {
+        *ss << (i ? ", " : "") << fields[i];
+    }
+    *ss << "]\n";
+    if (nullptr != filter) {
+        addIndent(ss, indent + 1);
+        *ss << "filter = " << filter->debugString();
+    }
+    addCommon(ss, indent);
+}
+
+QuerySolutionNode* ColumnScanNode::clone() const {
+    ColumnScanNode* copy = new ColumnScanNode(indexName, fields);
+    cloneBaseData(copy);
     return copy;
 }
 
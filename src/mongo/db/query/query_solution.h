@@ -227,6 +227,7 @@ struct QuerySolutionNode {
         if (nullptr != this->filter) {
             other->filter = this->filter->shallowClone();
         }
+        other->estimatedCardinality = this->estimatedCardinality;
     }
 
     /**
@@ -261,6 +262,10 @@ struct QuerySolutionNode {
     // filter.
     std::unique_ptr<MatchExpression> filter;
 
+    // The number of results the cost model expects this node to produce, if the plan was costed.
+    // Only reported by explain.
+    boost::optional<double> estimatedCardinality;
+
 protected:
     /**
      * Formatting helper used by toString().
@@ -366,6 +371,9 @@ public:
     // if the planning process for this solution was based on filtered indices.
     bool indexFilterApplied{false};
 
+    // The cost the cost model estimated for this solution, if it was costed.
+    boost::optional<double> estimatedCost;
+
     // Owned here. Used by the plan cache.
     std::unique_ptr<SolutionCacheData> cacheData;
 
@@ -456,6 +464,11 @@ struct CollectionScanNode : public QuerySolutionNodeWithSortSet {
     // This field cannot be used in conjunction with 'resumeAfterRecordId'.
     boost::optional<Timestamp> maxTs;
 
+    // If present, the collection scan only reads the records of a clustered collection whose
+    // RecordId is within ['minRecord', 'maxRecord'].
+    boost::optional<RecordId> minRecord;
+    boost::optional<RecordId> maxRecord;
+
     // If true, the collection scan will return a token that can be used to resume the scan.
     bool requestResumeToken = false;
 
@@ -477,6 +490,10 @@ struct CollectionScanNode : public QuerySolutionNodeWithSortSet {
 
     int direction{1};
 
+    // True if the query hinted or sorted by {$natural: +-1}, so the documents must be returned in
+    // the natural order of the collection.
+    bool requiresNaturalOrder = false;
+
     // Whether or not to wait for oplog visibility on oplog collection scans.
     bool shouldWaitForOplogVisibility = false;
 
@@ -484,6 +501,38 @@ struct CollectionScanNode : public QuerySolutionNodeWithSortSet {
     bool stopApplyingFilterAfterFirstMatch = false;
 };
 
+/**
+ * Reads the documents of a collection from its column store index. Each document only holds the
+ * top-level 'fields', which the planner chooses to cover everything that the query needs.
+ */
+struct ColumnScanNode : public QuerySolutionNodeWithSortSet {
+    ColumnScanNode(std::string indexName, std::vector<std::string> fields)
+        : indexName(std::move(indexName)), fields(std::move(fields)) {}
+
+    StageType getType() const final {
+        return STAGE_COLUMN_SCAN;
+    }
+
+    void appendToString(str::stream* ss, int indent) const final;
+
+    bool fetched() const {
+        return true;
+    }
+    FieldAvailability getFieldAvailability(const std::string& field) const {
+        return FieldAvailability::kFullyProvided;
+    }
+    bool sortedByDiskLoc() const {
+        return false;
+    }
+
+    QuerySolutionNode* clone() const final;
+
+    std::string indexName;
+
+    // The top-level fields whose columns are read.
+    std::vector<std::string> fields;
+};
+
 struct AndHashNode : public QuerySolutionNode {
     AndHashNode();
     virtual ~AndHashNode();
@@ -32,6 +32,7 @@
 
 #include "mongo/db/query/sbe_cached_solution_planner.h"
 
+#include "mongo/db/exec/plan_cache_util.h"
 #include "mongo/db/query/collection_query_info.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/query_planner.h"
@@ -68,6 +69,8 @@ plan_ranker::CandidatePlan CachedSolutionPlanner::plan(
     // If the cached plan hit EOF quickly enough, or still as efficient as before, then no need to
     // replan. Finalize the cached plan and return it.
     if (stats->common.isEOF || numReads <= _decisionReads) {
+        plan_cache_util::recordExecutionFeedback(
+            _opCtx, _collection, _planCacheKey, numReads, stats->common.advances);
         return finalizeExecutionPlan(std::move(stats), std::move(candidate));
     }
 
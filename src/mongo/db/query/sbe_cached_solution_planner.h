@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/sbe_plan_ranker.h"
 #include "mongo/db/query/sbe_runtime_planner.h"
 
@@ -47,10 +48,12 @@ public:
                           const CanonicalQuery& cq,
                           const QueryPlannerParams& queryParams,
                           size_t decisionReads,
+                          PlanCacheKey planCacheKey,
                           PlanYieldPolicySBE* yieldPolicy)
         : BaseRuntimePlanner{opCtx, collection, cq, yieldPolicy},
           _queryParams{queryParams},
-          _decisionReads{decisionReads} {}
+          _decisionReads{decisionReads},
+          _planCacheKey{std::move(planCacheKey)} {}
 
     plan_ranker::CandidatePlan plan(
         std::vector<std::unique_ptr<QuerySolution>> solutions,
@@ -82,5 +85,8 @@ private:
     // The number of physical reads taken to decide on a winning plan when the plan was first
     // cached.
     const size_t _decisionReads;
+
+    // The key of the plan cache entry which the plan came from, used to report execution feedback.
+    const PlanCacheKey _planCacheKey;
 };
 }  // namespace mongo::sbe
@@ -0,0 +1,98 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/query/sbe_stage_builder.h"
+#include "mongo/platform/mutex.h"
+
+namespace mongo {
+/**
+ * A per-collection cache of fully built SBE plans. The plans are built for parameterized queries:
+ * the constants of the query live in the runtime environment of a plan rather than in the plan
+ * itself, so a plan cached for one query can be cloned and re-bound to the constants of any other
+ * query of the same shape, without running the stage builder again.
+ *
+ * The cached plans are never executed. The trees are kept as they came out of the stage builder,
+ * and callers receive their own copies of both the tree and its runtime environment.
+ */
+class SbePlanCache {
+public:
+    SbePlanCache(const SbePlanCache&) = delete;
+    SbePlanCache& operator=(const SbePlanCache&) = delete;
+
+    SbePlanCache();
+    explicit SbePlanCache(size_t size);
+
+    /**
+     * Returns a copy of the plan cached under the given 'key' along with a copy of its data, or
+     * boost::none if there is no such plan.
+     */
+    boost::optional<std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>> get(
+        const std::string& key) const;
+
+    /**
+     * Caches a copy of the given plan 'root' and its 'data' under the given 'key', replacing any
+     * plan previously cached under this key. The plan must not have been prepared yet.
+     */
+    void set(const std::string& key,
+             const sbe::PlanStage& root,
+             const stage_builder::PlanStageData& data);
+
+    /**
+     * Removes the plan cached under the given 'key', if any.
+     */
+    void remove(const std::string& key);
+
+    /**
+     * Removes all cached plans.
+     */
+    void clear();
+
+    /**
+     * Returns the number of cached plans.
+     */
+    size_t size() const;
+
+private:
+    struct Entry {
+        std::unique_ptr<sbe::PlanStage> root;
+        stage_builder::PlanStageData data;
+    };
+
+    LRUKeyValue<std::string, Entry> _cache;
+
+    // Protects _cache.
+    mutable Mutex _cacheMutex = MONGO_MAKE_LATCH("SbePlanCache::_cacheMutex");
+};
+}  // namespace mongo
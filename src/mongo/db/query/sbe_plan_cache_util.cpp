@@ -0,0 +1,309 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/sbe_plan_cache_util.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/exec/trial_period_utils.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/plan_yield_policy_sbe.h"
+#include "mongo/db/query/sbe_stage_builder_filter.h"
+#include "mongo/db/query/sbe_stage_builder_index_scan.h"
+
+namespace mongo::sbe_plan_cache_util {
+namespace {
+Counter64 sbePlanCacheHits;
+Counter64 sbePlanCacheMisses;
+
+ServerStatusMetricField<Counter64> displaySbePlanCacheHits("query.sbePlanCache.hits",
+                                                           &sbePlanCacheHits);
+ServerStatusMetricField<Counter64> displaySbePlanCacheMisses("query.sbePlanCache.misses",
+                                                             &sbePlanCacheMisses);
+
+void assignInputParamIds(MatchExpression* expr,
+                         ComparisonMatchExpressionBase::InputParamId* nextParamId) {
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        static_cast<ComparisonMatchExpression*>(expr)->setInputParamId((*nextParamId)++);
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        assignInputParamIds(expr->getChild(i), nextParamId);
+    }
+}
+
+void encodeString(StringData str, StringBuilder* builder) {
+    *builder << str.size() << ':' << str;
+}
+
+/**
+ * Appends the shape of the filter 'expr' to 'builder'. Returns false if the filter embeds a
+ * constant which is not stored in an input parameter slot.
+ */
+bool encodeFilter(const MatchExpression* expr, StringBuilder* builder) {
+    *builder << '[' << static_cast<int>(expr->matchType());
+    encodeString(expr->path(), builder);
+
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE: {
+            auto paramId = static_cast<const ComparisonMatchExpression*>(expr)->getInputParamId();
+            if (!paramId) {
+                return false;
+            }
+            *builder << '#' << *paramId;
+            break;
+        }
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+        case MatchExpression::NOR:
+        case MatchExpression::NOT:
+        case MatchExpression::EXISTS:
+        case MatchExpression::ELEM_MATCH_OBJECT:
+        case MatchExpression::ELEM_MATCH_VALUE:
+        case MatchExpression::ALWAYS_FALSE:
+        case MatchExpression::ALWAYS_TRUE:
+            break;
+        default:
+            return false;
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        if (!encodeFilter(expr->getChild(i), builder)) {
+            return false;
+        }
+    }
+
+    *builder << ']';
+    return true;
+}
+
+/**
+ * Appends the shape of the query solution tree rooted at 'node' to 'builder'. Everything the stage
+ * builder embeds into the plan, except for the values held in input parameter and index bounds
+ * slots, must be a part of the shape. Returns false if the tree contains a node which the stage
+ * builder cannot parameterize.
+ */
+bool encodeSolution(const QuerySolutionNode* node, StringBuilder* builder) {
+    *builder << '(' << static_cast<int>(node->getType());
+
+    switch (node->getType()) {
+        case STAGE_COLLSCAN: {
+            auto csn = static_cast<const CollectionScanNode*>(node);
+            // Scans of oplog ranges, as well as resumable and tailable scans, depend on values
+            // which are not query parameters.
+            if (csn->minTs || csn->maxTs || csn->resumeAfterRecordId || csn->requestResumeToken ||
+                csn->tailable || csn->shouldTrackLatestOplogTimestamp ||
+                csn->assertMinTsHasNotFallenOffOplog || csn->stopApplyingFilterAfterFirstMatch) {
+                return false;
+            }
+            *builder << csn->direction;
+            break;
+        }
+        case STAGE_COLUMN_SCAN: {
+            auto csn = static_cast<const ColumnScanNode*>(node);
+            encodeString(csn->indexName, builder);
+            for (auto&& field : csn->fields) {
+                encodeString(field, builder);
+            }
+            break;
+        }
+        case STAGE_IXSCAN: {
+            auto ixn = static_cast<const IndexScanNode*>(node);
+            encodeString(ixn->index.identifier.catalogName, builder);
+            encodeString(ixn->index.keyPattern.toString(), builder);
+            *builder << ixn->direction << ixn->shouldDedup << ixn->addKeyMetadata;
+            break;
+        }
+        case STAGE_OR:
+            *builder << static_cast<const OrNode*>(node)->dedup;
+            break;
+        case STAGE_LIMIT:
+            *builder << static_cast<const LimitNode*>(node)->limit;
+            break;
+        case STAGE_SKIP:
+            *builder << static_cast<const SkipNode*>(node)->skip;
+            break;
+        case STAGE_SORT_SIMPLE:
+        case STAGE_SORT_DEFAULT: {
+            auto sn = static_cast<const SortNode*>(node);
+            encodeString(sn->pattern.toString(), builder);
+            *builder << sn->limit << sn->addSortKeyMetadata;
+            break;
+        }
+        case STAGE_SORT_KEY_GENERATOR:
+            encodeString(static_cast<const SortKeyGeneratorNode*>(node)->sortSpec.toString(),
+                         builder);
+            break;
+        case STAGE_RETURN_KEY:
+            for (auto&& field : static_cast<const ReturnKeyNode*>(node)->sortKeyMetaFields) {
+                encodeString(field.fullPath(), builder);
+            }
+            break;
+        case STAGE_FETCH:
+        case STAGE_PROJECTION_SIMPLE:
+        case STAGE_PROJECTION_DEFAULT:
+            // Projections are encoded as a part of the query, see computeKey().
+            break;
+        default:
+            return false;
+    }
+
+    if (node->filter) {
+        *builder << '?';
+        if (!encodeFilter(node->filter.get(), builder)) {
+            return false;
+        }
+    }
+
+    for (auto&& child : node->children) {
+        if (!encodeSolution(child, builder)) {
+            return false;
+        }
+    }
+
+    *builder << ')';
+    return true;
+}
+
+void bindInputParams(const MatchExpression* expr, sbe::RuntimeEnvironment* env) {
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        auto cmp = static_cast<const ComparisonMatchExpression*>(expr);
+        if (auto paramId = cmp->getInputParamId()) {
+            // A predicate which has been fully absorbed into index bounds has no slot.
+            if (auto slot = env->getSlotIfExists(stage_builder::makeInputParamSlotName(*paramId))) {
+                const auto& rhs = cmp->getData();
+                auto [tagView, valView] = sbe::bson::convertFrom(
+                    true, rhs.rawdata(), rhs.rawdata() + rhs.size(), rhs.fieldNameSize() - 1);
+                auto [tag, val] = sbe::value::copyValue(tagView, valView);
+                env->resetSlot(*slot, tag, val, true);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        bindInputParams(expr->getChild(i), env);
+    }
+}
+}  // namespace
+
+void parameterizeQuery(CanonicalQuery* cq) {
+    ComparisonMatchExpressionBase::InputParamId nextParamId = 0;
+    assignInputParamIds(cq->root(), &nextParamId);
+}
+
+boost::optional<std::string> computeKey(const Collection* collection,
+                                        const CanonicalQuery& cq,
+                                        const QuerySolution& solution) {
+    StringBuilder builder;
+    // The plan cache key covers the shape of the query, including the shape of its predicates,
+    // sort, projection and collation.
+    encodeString(CollectionQueryInfo::get(collection).getPlanCache()->computeKey(cq).toString(),
+                 &builder);
+    if (!encodeSolution(solution.root(), &builder)) {
+        return boost::none;
+    }
+
+    // The projection is compiled into the plan, along with any constants it may have.
+    const auto& proj = cq.getQueryRequest().getProj();
+    encodeString(StringData{proj.objdata(), static_cast<size_t>(proj.objsize())}, &builder);
+    builder << cq.getExpCtx()->allowDiskUse;
+
+    return builder.str();
+}
+
+boost::optional<std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>>
+getCachedPlan(OperationContext* opCtx,
+              const Collection* collection,
+              const CanonicalQuery& cq,
+              const QuerySolution& solution,
+              const std::string& key,
+              PlanYieldPolicy* yieldPolicy) {
+    auto cachedPlan = CollectionQueryInfo::get(collection).getSbePlanCache()->get(key);
+    if (!cachedPlan) {
+        sbePlanCacheMisses.increment();
+        return boost::none;
+    }
+
+    auto&& [root, data] = *cachedPlan;
+    bindInputParams(cq.root(), data.env);
+
+    auto indexScanNodes = stage_builder::getIndexScanNodes(solution.root());
+    for (auto&& boundsParams : data.indexBoundsParams) {
+        invariant(boundsParams.nodeOrdinal < indexScanNodes.size());
+        if (!stage_builder::bindIndexBoundsParams(opCtx,
+                                                  collection,
+                                                  indexScanNodes[boundsParams.nodeOrdinal],
+                                                  boundsParams,
+                                                  data.env)) {
+            sbePlanCacheMisses.increment();
+            return boost::none;
+        }
+    }
+
+    // Plans are built for cached solutions with a trial run progress tracker, so the cached plan
+    // needs a fresh one.
+    data.trialRunProgressTracker = std::make_unique<TrialRunProgressTracker>(
+        trial_period::getTrialPeriodNumToReturn(cq),
+        trial_period::getTrialPeriodMaxWorks(opCtx, collection));
+    root->rebindYieldPolicyAndTracker(yieldPolicy, data.trialRunProgressTracker.get());
+
+    auto sbeYieldPolicy = dynamic_cast<PlanYieldPolicySBE*>(yieldPolicy);
+    invariant(sbeYieldPolicy);
+    sbeYieldPolicy->registerPlan(root.get());
+
+    sbePlanCacheHits.increment();
+    return cachedPlan;
+}
+
+void cachePlan(const Collection* collection,
+               const QuerySolution& solution,
+               const std::string& key,
+               const sbe::PlanStage& root,
+               const stage_builder::PlanStageData& data) {
+    auto numIndexScans = stage_builder::getIndexScanNodes(solution.root()).size();
+    if (data.indexBoundsParams.size() != numIndexScans) {
+        return;
+    }
+    for (auto&& boundsParams : data.indexBoundsParams) {
+        if (!boundsParams.lowKeySlot && !boundsParams.intervalsSlot) {
+            return;
+        }
+    }
+
+    CollectionQueryInfo::get(collection).getSbePlanCache()->set(key, root, data);
+}
+}  // namespace mongo::sbe_plan_cache_util
@@ -0,0 +1,91 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/sbe_stage_builder.h"
+
+/**
+ * Helpers to build SBE plans which can be kept in the SBE plan cache, and to reuse them.
+ *
+ * A plan can be reused by a query other than the one it was built for when all the constants of
+ * the query live in the runtime environment of the plan: the comparison predicates read their
+ * operands from input parameter slots, and the index scans read their bounds from index bounds
+ * slots. A cached plan is then cloned and its slots are re-bound to the values of the new query.
+ */
+namespace mongo::sbe_plan_cache_util {
+/**
+ * Assigns input parameter ids to the comparison predicates of 'cq', so that the filters the stage
+ * builder generates for them read their operands from the runtime environment. Ids are assigned
+ * in a pre-order traversal of the match expression tree, so that the same predicate in two queries
+ * with the same plan cache key gets the same id.
+ */
+void parameterizeQuery(CanonicalQuery* cq);
+
+/**
+ * Computes the key under which the SBE plan built for the 'solution' of the query 'cq' can be
+ * kept in the SBE plan cache of 'collection'. Returns boost::none if such a plan depends on
+ * constants which cannot be re-bound, and so cannot be reused by other queries.
+ */
+boost::optional<std::string> computeKey(const Collection* collection,
+                                        const CanonicalQuery& cq,
+                                        const QuerySolution& solution);
+
+/**
+ * Looks up the SBE plan cache of 'collection' for a plan cached under 'key', and if there is one,
+ * returns a copy of it bound to the constants of 'cq' and the index bounds of 'solution', and
+ * ready to run a trial period under the given 'yieldPolicy'. Returns boost::none if there is no
+ * such plan, or if it cannot be bound to this query.
+ */
+boost::optional<std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>>
+getCachedPlan(OperationContext* opCtx,
+              const Collection* collection,
+              const CanonicalQuery& cq,
+              const QuerySolution& solution,
+              const std::string& key,
+              PlanYieldPolicy* yieldPolicy);
+
+/**
+ * Keeps a copy of the plan 'root' built for 'solution' in the SBE plan cache of 'collection', under
+ * the given 'key', provided that all the index scans of the plan have been built with
+ * parameterized bounds.
+ */
+void cachePlan(const Collection* collection,
+               const QuerySolution& solution,
+               const std::string& key,
+               const sbe::PlanStage& root,
+               const stage_builder::PlanStageData& data);
+}  // namespace mongo::sbe_plan_cache_util
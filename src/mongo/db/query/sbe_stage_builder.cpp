@@ -33,6 +33,7 @@
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/exec/sbe/stages/co_scan.h"
+#include "mongo/db/exec/sbe/stages/column_scan.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 #include "mongo/db/exec/sbe/stages/limit_skip.h"
@@ -51,6 +52,7 @@
 #include "mongo/db/query/sbe_stage_builder_coll_scan.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
 #include "mongo/db/query/sbe_stage_builder_index_scan.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/sbe_stage_builder_projection.h"
 #include "mongo/db/query/util/make_data_structure.h"
 
@@ -97,9 +99,55 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildCollScan(
     return std::move(stage);
 }
 
+std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildColumnScan(
+    const QuerySolutionNode* root) {
+    auto csn = static_cast<const ColumnScanNode*>(root);
+    _data.resultSlot = _slotIdGenerator.generate();
+    _data.recordIdSlot = _slotIdGenerator.generate();
+
+    std::unique_ptr<sbe::PlanStage> stage = sbe::makeS<sbe::ColumnScanStage>(
+        NamespaceStringOrUUID{_collection->ns().db().toString(), _collection->uuid()},
+        csn->indexName,
+        csn->fields,
+        _data.resultSlot,
+        _data.recordIdSlot,
+        _yieldPolicy,
+        _data.trialRunProgressTracker.get());
+
+    if (csn->filter) {
+        stage = generateFilter(_opCtx,
+                               csn->filter.get(),
+                               std::move(stage),
+                               &_slotIdGenerator,
+                               &_frameIdGenerator,
+                               *_data.resultSlot,
+                               _data.env,
+                               sbe::makeSV(*_data.resultSlot, *_data.recordIdSlot));
+    }
+
+    if (_returnKeySlot) {
+        // Assign the '_returnKeySlot' to be the empty object.
+        stage = sbe::makeProjectStage(
+            std::move(stage), *_returnKeySlot, sbe::makeE<sbe::EFunction>("newObj", sbe::makeEs()));
+    }
+
+    return stage;
+}
+
 std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildIndexScan(
     const QuerySolutionNode* root) {
     auto ixn = static_cast<const IndexScanNode*>(root);
+
+    boost::optional<IndexBoundsParams> boundsParams;
+    if (_parameterizeIndexBounds) {
+        auto indexScanNodes = getIndexScanNodes(_solution.root());
+        auto it = std::find(indexScanNodes.begin(), indexScanNodes.end(), ixn);
+        invariant(it != indexScanNodes.end());
+
+        boundsParams.emplace();
+        boundsParams->nodeOrdinal = std::distance(indexScanNodes.begin(), it);
+    }
+
     auto [slot, stage] = generateIndexScan(_opCtx,
                                            _collection,
                                            ixn,
@@ -107,7 +155,13 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildIndexScan(
                                            &_slotIdGenerator,
                                            &_spoolIdGenerator,
                                            _yieldPolicy,
-                                           _data.trialRunProgressTracker.get());
+                                           _data.trialRunProgressTracker.get(),
+                                           _data.env,
+                                           _cq.getExpCtx()->allowDiskUse,
+                                           boundsParams.get_ptr());
+    if (boundsParams) {
+        _data.indexBoundsParams.push_back(*boundsParams);
+    }
     _data.recordIdSlot = slot;
     return std::move(stage);
 }
@@ -373,7 +427,11 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildOr(const QuerySoluti
 
     if (orn->dedup) {
         stage = sbe::makeS<sbe::HashAggStage>(
-            std::move(stage), sbe::makeSV(*_data.recordIdSlot), sbe::makeEM());
+            std::move(stage),
+            sbe::makeSV(*_data.recordIdSlot),
+            sbe::makeEM(),
+            internalQuerySlotBasedExecutionHashAggMemoryUseBytesBeforeSpill.load(),
+            _cq.getExpCtx()->allowDiskUse);
     }
 
     if (orn->filter) {
@@ -462,7 +520,11 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildText(const QuerySolu
     // index keys for a given document. This will require expression evaluation to be able to
     // extract the score directly from the key string.
     auto hashAggStage = sbe::makeS<sbe::HashAggStage>(
-        std::move(unionStage), sbe::makeSV(*_data.recordIdSlot), sbe::makeEM());
+        std::move(unionStage),
+        sbe::makeSV(*_data.recordIdSlot),
+        sbe::makeEM(),
+        internalQuerySlotBasedExecutionHashAggMemoryUseBytesBeforeSpill.load(),
+        _cq.getExpCtx()->allowDiskUse);
 
     auto nljStage = makeLoopJoinForFetch(std::move(hashAggStage), *_data.recordIdSlot);
 
@@ -592,6 +654,7 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::build(const QuerySolution
                                          SlotBasedStageBuilder&, const QuerySolutionNode* root)>>
         kStageBuilders = {
             {STAGE_COLLSCAN, std::mem_fn(&SlotBasedStageBuilder::buildCollScan)},
+            {STAGE_COLUMN_SCAN, std::mem_fn(&SlotBasedStageBuilder::buildColumnScan)},
             {STAGE_IXSCAN, std::mem_fn(&SlotBasedStageBuilder::buildIndexScan)},
             {STAGE_FETCH, std::mem_fn(&SlotBasedStageBuilder::buildFetch)},
             {STAGE_LIMIT, std::mem_fn(&SlotBasedStageBuilder::buildLimit)},
@@ -35,6 +35,8 @@
 #include "mongo/db/exec/trial_period_utils.h"
 #include "mongo/db/exec/trial_run_progress_tracker.h"
 #include "mongo/db/query/plan_yield_policy_sbe.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/sbe_stage_builder_index_scan.h"
 #include "mongo/db/query/stage_builder.h"
 
 namespace mongo::stage_builder {
@@ -71,6 +73,24 @@ struct PlanStageData {
         return builder.str();
     }
 
+    /**
+     * Makes a copy of this data to go along with a clone of the plan it was built for. The runtime
+     * environment is copied deeply, so that its slots can be re-bound independently of this one.
+     * The trial run progress tracker is not copied.
+     */
+    PlanStageData makeCopy() const {
+        PlanStageData copy{env->makeDeepCopy()};
+        copy.resultSlot = resultSlot;
+        copy.recordIdSlot = recordIdSlot;
+        copy.oplogTsSlot = oplogTsSlot;
+        copy.ctx.closureCompilation = ctx.closureCompilation;
+        copy.shouldTrackLatestOplogTimestamp = shouldTrackLatestOplogTimestamp;
+        copy.shouldTrackResumeToken = shouldTrackResumeToken;
+        copy.shouldUseTailableScan = shouldUseTailableScan;
+        copy.indexBoundsParams = indexBoundsParams;
+        return copy;
+    }
+
     boost::optional<sbe::value::SlotId> resultSlot;
     boost::optional<sbe::value::SlotId> recordIdSlot;
     boost::optional<sbe::value::SlotId> oplogTsSlot;
@@ -81,6 +101,9 @@ struct PlanStageData {
     bool shouldUseTailableScan{false};
     // Used during the trial run of the runtime planner to track progress of the work done so far.
     std::unique_ptr<TrialRunProgressTracker> trialRunProgressTracker;
+    // If the plan was built with parameterized index bounds, describes where the bounds of each
+    // index scan are stored in the runtime environment.
+    std::vector<IndexBoundsParams> indexBoundsParams;
 };
 
 /**
@@ -94,7 +117,12 @@ public:
                           const QuerySolution& solution,
                           PlanYieldPolicySBE* yieldPolicy,
                           bool needsTrialRunProgressTracker)
-        : StageBuilder(opCtx, collection, cq, solution), _yieldPolicy(yieldPolicy) {
+        : StageBuilder(opCtx, collection, cq, solution),
+          _yieldPolicy(yieldPolicy),
+          _parameterizeIndexBounds(internalQuerySlotBasedExecutionReuseCachedPlans.load()) {
+        _data.ctx.closureCompilation =
+            internalQuerySlotBasedExecutionEnableClosureCompiler.load();
+
         if (needsTrialRunProgressTracker) {
             const auto maxNumResults{trial_period::getTrialPeriodNumToReturn(_cq)};
             const auto maxNumReads{trial_period::getTrialPeriodMaxWorks(_opCtx, _collection)};
@@ -111,6 +139,7 @@ public:
 
 private:
     std::unique_ptr<sbe::PlanStage> buildCollScan(const QuerySolutionNode* root);
+    std::unique_ptr<sbe::PlanStage> buildColumnScan(const QuerySolutionNode* root);
     std::unique_ptr<sbe::PlanStage> buildIndexScan(const QuerySolutionNode* root);
     std::unique_ptr<sbe::PlanStage> buildFetch(const QuerySolutionNode* root);
     std::unique_ptr<sbe::PlanStage> buildLimit(const QuerySolutionNode* root);
@@ -151,6 +180,10 @@ private:
 
     PlanYieldPolicySBE* const _yieldPolicy;
 
+    // If set, the bounds of index scans are stored in the runtime environment rather than embedded
+    // into the tree as constants, so that the plan can be reused from the SBE plan cache.
+    const bool _parameterizeIndexBounds;
+
     // Apart from generating just an execution tree, this builder will also produce some auxiliary
     // data which is needed to execute the tree, such as a result slot, or a recordId slot.
     PlanStageData _data{makeRuntimeEnvironment(_opCtx, &_slotIdGenerator)};
@@ -42,8 +42,10 @@
 #include "mongo/db/exec/sbe/stages/project.h"
 #include "mongo/db/exec/sbe/stages/scan.h"
 #include "mongo/db/exec/sbe/stages/union.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
 #include "mongo/db/query/util/make_data_structure.h"
+#include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/str.h"
@@ -323,17 +325,30 @@ generateGenericCollScan(OperationContext* opCtx,
     auto&& [fields, slots, tsSlot] = makeOplogTimestampSlotsIfNeeded(
         collection, slotIdGenerator, csn->shouldTrackLatestOplogTimestamp);
 
+    // A scan in block mode reads records ahead of the ones it returns, so it is only used for scans
+    // which neither seek nor wait for new records to be inserted.
+    const auto blockSize =
+        static_cast<size_t>(internalQuerySlotBasedExecutionScanBlockSize.load());
+    const auto useBlockMode =
+        blockSize > 0 && !seekRecordIdSlot && !csn->tailable && !collection->ns().isOplog();
+
     NamespaceStringOrUUID nss{collection->ns().db().toString(), collection->uuid()};
-    auto stage = sbe::makeS<sbe::ScanStage>(nss,
-                                            resultSlot,
-                                            recordIdSlot,
-                                            std::move(fields),
-                                            std::move(slots),
-                                            seekRecordIdSlot,
-                                            forward,
-                                            yieldPolicy,
-                                            tracker,
-                                            makeOpenCallbackIfNeeded(collection, csn));
+    auto makeScan = [&, fields = fields, slots = slots](std::unique_ptr<sbe::EExpression> filter) {
+        return sbe::makeS<sbe::ScanStage>(nss,
+                                          resultSlot,
+                                          recordIdSlot,
+                                          fields,
+                                          slots,
+                                          seekRecordIdSlot,
+                                          forward,
+                                          yieldPolicy,
+                                          tracker,
+                                          makeOpenCallbackIfNeeded(collection, csn),
+                                          std::move(filter),
+                                          useBlockMode ? blockSize : 0);
+    };
+    auto stage = makeScan(nullptr);
+    const auto scanStage = stage.get();
 
     // Check if the scan should be started after the provided resume RecordId and construct a nested
     // loop join sub-tree to project out the resume RecordId as a seekRecordIdSlot and feed it to
@@ -419,10 +434,112 @@ generateGenericCollScan(OperationContext* opCtx,
                                resultSlot,
                                env,
                                std::move(relevantSlots));
+
+        // If the whole filter has been compiled into a single expression applied directly to the
+        // output of the scan, evaluate it inside the scan over entire blocks of records instead.
+        if (useBlockMode) {
+            auto filterStage = dynamic_cast<sbe::FilterStage<false>*>(stage.get());
+            if (filterStage && filterStage->getInput() == scanStage) {
+                stage = makeScan(filterStage->getFilter()->clone());
+            }
+        }
     }
 
     return {resultSlot, recordIdSlot, tsSlot, std::move(stage)};
 }
+
+/**
+ * Checks if the collection scan can be split across multiple threads. Every thread reads the
+ * collection under its own operation context and storage snapshot, so parallel scans are limited
+ * to local and available reads outside of transactions. Scans which need to return documents in
+ * their natural order, such as those hinted or sorted by {$natural: 1}, or to produce a resume
+ * token, are never split.
+ */
+bool shouldScanInParallel(OperationContext* opCtx,
+                          const Collection* collection,
+                          const CollectionScanNode* csn,
+                          bool isTailableResumeBranch,
+                          TrialRunProgressTracker* tracker) {
+    if (internalQuerySlotBasedExecutionParallelScanDegree.load() <= 1) {
+        return false;
+    }
+
+    if (isTailableResumeBranch || tracker || csn->tailable || csn->requestResumeToken ||
+        csn->resumeAfterRecordId || csn->direction != CollectionScanParams::FORWARD ||
+        csn->requiresNaturalOrder || csn->shouldTrackLatestOplogTimestamp || collection->ns().isOplog() ||
+        collection->isCapped()) {
+        return false;
+    }
+
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(opCtx);
+    const auto readConcernLevel = readConcernArgs.getLevel();
+    if (opCtx->inMultiDocumentTransaction() || readConcernArgs.getArgsAtClusterTime() ||
+        (readConcernLevel != repl::ReadConcernLevel::kLocalReadConcern &&
+         readConcernLevel != repl::ReadConcernLevel::kAvailableReadConcern)) {
+        return false;
+    }
+
+    return static_cast<long long>(collection->dataSize(opCtx)) >=
+        internalQuerySlotBasedExecutionParallelScanMinCollectionSizeBytes.load();
+}
+
+/**
+ * Generates a collection scan split into RecordId ranges, which are scanned and filtered by
+ * 'internalQuerySlotBasedExecutionParallelScanDegree' producer threads. The results are gathered
+ * by an exchange in no particular order:
+ *
+ *     exchange [resultSlot, recordIdSlot] roundrobin
+ *     <filter>
+ *     pscan resultSlot recordIdSlot
+ *
+ * The producers run under their own operation contexts, which the query's yield policy cannot yield
+ * on their behalf, so the scans are given no yield policy. Instead, every scan releases its locks
+ * and storage snapshot each time it moves on to a new range. This is only acceptable because
+ * shouldScanInParallel() limits parallel scans to reads which need no single snapshot anyway.
+ */
+std::tuple<sbe::value::SlotId,
+           sbe::value::SlotId,
+           boost::optional<sbe::value::SlotId>,
+           std::unique_ptr<sbe::PlanStage>>
+generateParallelCollScan(OperationContext* opCtx,
+                         const Collection* collection,
+                         const CollectionScanNode* csn,
+                         sbe::value::SlotIdGenerator* slotIdGenerator,
+                         sbe::value::FrameIdGenerator* frameIdGenerator,
+                         sbe::RuntimeEnvironment* env) {
+    auto resultSlot = slotIdGenerator->generate();
+    auto recordIdSlot = slotIdGenerator->generate();
+
+    NamespaceStringOrUUID nss{collection->ns().db().toString(), collection->uuid()};
+    std::unique_ptr<sbe::PlanStage> stage =
+        sbe::makeS<sbe::ParallelScanStage>(nss,
+                                           resultSlot,
+                                           recordIdSlot,
+                                           std::vector<std::string>{},
+                                           sbe::makeSV(),
+                                           nullptr /* yieldPolicy */);
+
+    if (csn->filter) {
+        stage = generateFilter(opCtx,
+                               csn->filter.get(),
+                               std::move(stage),
+                               slotIdGenerator,
+                               frameIdGenerator,
+                               resultSlot,
+                               env,
+                               sbe::makeSV(resultSlot, recordIdSlot));
+    }
+
+    stage = sbe::makeS<sbe::ExchangeConsumer>(
+        std::move(stage),
+        static_cast<size_t>(internalQuerySlotBasedExecutionParallelScanDegree.load()),
+        sbe::makeSV(resultSlot, recordIdSlot),
+        sbe::ExchangePolicy::roundrobin,
+        nullptr /* partition */,
+        nullptr /* orderLess */);
+
+    return {resultSlot, recordIdSlot, boost::none, std::move(stage)};
+}
 }  // namespace
 
 std::tuple<sbe::value::SlotId,
@@ -450,6 +567,10 @@ generateCollScan(OperationContext* opCtx,
                                               env,
                                               isTailableResumeBranch,
                                               tracker);
+        } else if (shouldScanInParallel(
+                       opCtx, collection, csn, isTailableResumeBranch, tracker)) {
+            return generateParallelCollScan(
+                opCtx, collection, csn, slotIdGenerator, frameIdGenerator, env);
         } else {
             return generateGenericCollScan(opCtx,
                                            collection,
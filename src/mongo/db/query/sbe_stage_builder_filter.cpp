@@ -550,12 +550,33 @@ void generateComparison(MatchExpressionVisitorContext* context,
                         const ComparisonMatchExpression* expr,
                         sbe::EPrimBinary::Op binaryOp) {
     auto makePredicate =
-        [expr, binaryOp](sbe::value::SlotId inputSlot,
-                         std::unique_ptr<sbe::PlanStage> inputStage) -> MakePredicateReturnType {
+        [context, expr, binaryOp](
+            sbe::value::SlotId inputSlot,
+            std::unique_ptr<sbe::PlanStage> inputStage) -> MakePredicateReturnType {
         const auto& rhs = expr->getData();
         auto [tagView, valView] = sbe::bson::convertFrom(
             true, rhs.rawdata(), rhs.rawdata() + rhs.size(), rhs.fieldNameSize() - 1);
 
+        // If the query has been parameterized, the RHS is read from the runtime environment, so
+        // that a cached copy of this plan can be re-bound to the constants of another query with
+        // the same shape. The planner may clone a predicate into several places of the plan, in
+        // which case all copies share the same slot.
+        if (auto paramId = expr->getInputParamId(); paramId && context->env) {
+            auto slotName = makeInputParamSlotName(*paramId);
+            auto slot = context->env->getSlotIfExists(slotName);
+            if (!slot) {
+                auto [tag, val] = sbe::value::copyValue(tagView, valView);
+                slot = context->env->registerSlot(
+                    slotName, tag, val, true /* owned */, context->slotIdGenerator);
+            }
+
+            return {makeFillEmptyFalse(
+                        sbe::makeE<sbe::EPrimBinary>(binaryOp,
+                                                     sbe::makeE<sbe::EVariable>(inputSlot),
+                                                     sbe::makeE<sbe::EVariable>(*slot))),
+                    std::move(inputStage)};
+        }
+
         // SBE EConstant assumes ownership of the value so we have to make a copy here.
         auto [tag, val] = sbe::value::copyValue(tagView, valView);
 
@@ -1332,4 +1353,8 @@ std::unique_ptr<sbe::PlanStage> generateFilter(OperationContext* opCtx,
     tree_walker::walk<true, MatchExpression>(root, &walker);
     return context.done();
 }
+
+std::string makeInputParamSlotName(ComparisonMatchExpressionBase::InputParamId paramId) {
+    return str::stream() << "inputParam" << paramId;
+}
 }  // namespace mongo::stage_builder
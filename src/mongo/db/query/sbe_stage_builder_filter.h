@@ -33,6 +33,7 @@
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_leaf.h"
 
 namespace mongo::stage_builder {
 /**
@@ -51,4 +52,10 @@ std::unique_ptr<sbe::PlanStage> generateFilter(OperationContext* opCtx,
                                                sbe::RuntimeEnvironment* env,
                                                sbe::value::SlotVector relevantSlotsIn);
 
+/**
+ * Returns the name of the RuntimeEnvironment slot which holds the value of the input parameter
+ * 'paramId' in a filter generated for a parameterized query. The comparison predicates carrying an
+ * input parameter id read their RHS from such slots instead of embedding it as a constant.
+ */
+std::string makeInputParamSlotName(ComparisonMatchExpressionBase::InputParamId paramId);
 }  // namespace mongo::stage_builder
@@ -241,6 +241,31 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
     return result;
 }
 
+/**
+ * Constructs an array containing objects with the low and high keys for each of the given
+ * 'intervals'. E.g.,
+ *    [ {l: KS(...), h: KS(...)},
+ *      {l: KS(...), h: KS(...)}, ... ]
+ */
+std::pair<sbe::value::TypeTags, sbe::value::Value> makeIntervalsArray(
+    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
+        intervals) {
+    using namespace std::literals;
+
+    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
+    auto arr = sbe::value::getArrayView(boundsVal);
+    for (auto&& [lowKey, highKey] : intervals) {
+        auto [tag, val] = sbe::value::makeNewObject();
+        auto obj = sbe::value::getObjectView(val);
+        obj->push_back(
+            "l"sv, sbe::value::TypeTags::ksValue, sbe::value::bitcastFrom(lowKey.release()));
+        obj->push_back(
+            "h"sv, sbe::value::TypeTags::ksValue, sbe::value::bitcastFrom(highKey.release()));
+        arr->push_back(tag, val);
+    }
+    return {boundsTag, boundsVal};
+}
+
 /**
  * Constructs an optimized version of an index scan for multi-interval index bounds for the case
  * when the bounds can be decomposed in a number of single-interval bounds. In this case, instead
@@ -265,48 +290,29 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
  * use the unwind stage to flatten the array and generate multiple input intervals to the ixscan.
  */
 std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>>
-generateOptimizedMultiIntervalIndexScan(
-    const Collection* collection,
-    const std::string& indexName,
-    bool forward,
-    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
-        intervals,
-    sbe::IndexKeysInclusionSet indexKeysToInclude,
-    sbe::value::SlotVector vars,
-    sbe::value::SlotIdGenerator* slotIdGenerator,
-    PlanYieldPolicy* yieldPolicy,
-    TrialRunProgressTracker* tracker) {
+generateOptimizedMultiIntervalIndexScan(const Collection* collection,
+                                        const std::string& indexName,
+                                        bool forward,
+                                        std::unique_ptr<sbe::EExpression> intervalsExpr,
+                                        sbe::IndexKeysInclusionSet indexKeysToInclude,
+                                        sbe::value::SlotVector vars,
+                                        sbe::value::SlotIdGenerator* slotIdGenerator,
+                                        PlanYieldPolicy* yieldPolicy,
+                                        TrialRunProgressTracker* tracker) {
     using namespace std::literals;
 
     auto recordIdSlot = slotIdGenerator->generate();
     auto lowKeySlot = slotIdGenerator->generate();
     auto highKeySlot = slotIdGenerator->generate();
-
-    // Construct an array containing objects with the low and high keys for each interval. E.g.,
-    //    [ {l: KS(...), h: KS(...)},
-    //      {l: KS(...), h: KS(...)}, ... ]
-    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
-    auto arr = sbe::value::getArrayView(boundsVal);
-    for (auto&& [lowKey, highKey] : intervals) {
-        auto [tag, val] = sbe::value::makeNewObject();
-        auto obj = sbe::value::getObjectView(val);
-        obj->push_back(
-            "l"sv, sbe::value::TypeTags::ksValue, sbe::value::bitcastFrom(lowKey.release()));
-        obj->push_back(
-            "h"sv, sbe::value::TypeTags::ksValue, sbe::value::bitcastFrom(highKey.release()));
-        arr->push_back(tag, val);
-    }
-
     auto boundsSlot = slotIdGenerator->generate();
     auto unwindSlot = slotIdGenerator->generate();
 
-    // Project out the constructed array as a constant value and add an unwind stage on top to
-    // flatten the array.
+    // Project out the array of intervals and add an unwind stage on top to flatten the array.
     auto unwind = sbe::makeS<sbe::UnwindStage>(
         sbe::makeProjectStage(
             sbe::makeS<sbe::LimitSkipStage>(sbe::makeS<sbe::CoScanStage>(), 1, boost::none),
             boundsSlot,
-            sbe::makeE<sbe::EConstant>(boundsTag, boundsVal)),
+            std::move(intervalsExpr)),
         boundsSlot,
         unwindSlot,
         slotIdGenerator->generate(), /* We don't need an index slot but must to provide it. */
@@ -584,20 +590,23 @@ generateGenericMultiIntervalIndexScan(const Collection* collection,
                 sbe::makeE<sbe::EFunction>("isNumber"sv,
                                            sbe::makeEs(sbe::makeE<sbe::EVariable>(resultSlot))))};
 }
-}  // namespace
 
-std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleIntervalIndexScan(
-    const Collection* collection,
-    const std::string& indexName,
-    bool forward,
-    std::unique_ptr<KeyString::Value> lowKey,
-    std::unique_ptr<KeyString::Value> highKey,
-    sbe::IndexKeysInclusionSet indexKeysToInclude,
-    sbe::value::SlotVector vars,
-    boost::optional<sbe::value::SlotId> recordSlot,
-    sbe::value::SlotIdGenerator* slotIdGenerator,
-    PlanYieldPolicy* yieldPolicy,
-    TrialRunProgressTracker* tracker) {
+/**
+ * Same as 'generateSingleIntervalIndexScan()', but the seek boundaries are given as arbitrary
+ * expressions rather than as constant KeyStrings.
+ */
+std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>>
+generateSingleIntervalIndexScanImpl(const Collection* collection,
+                                    const std::string& indexName,
+                                    bool forward,
+                                    std::unique_ptr<sbe::EExpression> lowKeyExpr,
+                                    std::unique_ptr<sbe::EExpression> highKeyExpr,
+                                    sbe::IndexKeysInclusionSet indexKeysToInclude,
+                                    sbe::value::SlotVector vars,
+                                    boost::optional<sbe::value::SlotId> recordSlot,
+                                    sbe::value::SlotIdGenerator* slotIdGenerator,
+                                    PlanYieldPolicy* yieldPolicy,
+                                    TrialRunProgressTracker* tracker) {
     auto recordIdSlot = slotIdGenerator->generate();
     auto lowKeySlot = slotIdGenerator->generate();
     auto highKeySlot = slotIdGenerator->generate();
@@ -607,11 +616,9 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleInt
     auto project = sbe::makeProjectStage(
         sbe::makeS<sbe::LimitSkipStage>(sbe::makeS<sbe::CoScanStage>(), 1, boost::none),
         lowKeySlot,
-        sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::ksValue,
-                                   sbe::value::bitcastFrom(lowKey.release())),
+        std::move(lowKeyExpr),
         highKeySlot,
-        sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::ksValue,
-                                   sbe::value::bitcastFrom(highKey.release())));
+        std::move(highKeyExpr));
 
     // Scan the index in the range {'lowKeySlot', 'highKeySlot'} (subject to inclusive or
     // exclusive boundaries), and produce a single field recordIdSlot that can be used to
@@ -637,7 +644,35 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleInt
                                            sbe::makeSV(lowKeySlot, highKeySlot),
                                            nullptr)};
 }
+}  // namespace
 
+std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleIntervalIndexScan(
+    const Collection* collection,
+    const std::string& indexName,
+    bool forward,
+    std::unique_ptr<KeyString::Value> lowKey,
+    std::unique_ptr<KeyString::Value> highKey,
+    sbe::IndexKeysInclusionSet indexKeysToInclude,
+    sbe::value::SlotVector vars,
+    boost::optional<sbe::value::SlotId> recordSlot,
+    sbe::value::SlotIdGenerator* slotIdGenerator,
+    PlanYieldPolicy* yieldPolicy,
+    TrialRunProgressTracker* tracker) {
+    return generateSingleIntervalIndexScanImpl(
+        collection,
+        indexName,
+        forward,
+        sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::ksValue,
+                                   sbe::value::bitcastFrom(lowKey.release())),
+        sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::ksValue,
+                                   sbe::value::bitcastFrom(highKey.release())),
+        indexKeysToInclude,
+        std::move(vars),
+        recordSlot,
+        slotIdGenerator,
+        yieldPolicy,
+        tracker);
+}
 
 std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateIndexScan(
     OperationContext* opCtx,
@@ -647,8 +682,12 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateIndexScan
     sbe::value::SlotIdGenerator* slotIdGenerator,
     sbe::value::SpoolIdGenerator* spoolIdGenerator,
     PlanYieldPolicy* yieldPolicy,
-    TrialRunProgressTracker* tracker) {
+    TrialRunProgressTracker* tracker,
+    sbe::RuntimeEnvironment* env,
+    bool allowDiskUse,
+    IndexBoundsParams* boundsParams) {
     invariant(returnKeySlot || !ixn->addKeyMetadata);
+    invariant(!boundsParams || env);
     uassert(4822864, "Index scans with a filter are not supported in SBE", !ixn->filter);
 
     auto descriptor =
@@ -692,37 +731,80 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateIndexScan
         return {std::move(returnKeyExpr), std::move(vars), indexKeysToInclude};
     }();
 
+    // Binds a value describing the index bounds either to a constant, or, if the index scan is
+    // being parameterized, to a slot in the runtime environment registered under 'slotName'.
+    auto makeBoundsExpr = [&](StringData slotName,
+                              sbe::value::TypeTags tag,
+                              sbe::value::Value val,
+                              boost::optional<sbe::value::SlotId>* slotOut)
+        -> std::unique_ptr<sbe::EExpression> {
+        if (!boundsParams) {
+            return sbe::makeE<sbe::EConstant>(tag, val);
+        }
+
+        *slotOut = env->registerSlot(
+            str::stream() << "indexBounds" << boundsParams->nodeOrdinal << slotName,
+            tag,
+            val,
+            true /* owned */,
+            slotIdGenerator);
+        return sbe::makeE<sbe::EVariable>(**slotOut);
+    };
+
     auto [slot,
           stage] = [&, vars = std::ref(vars), indexKeysToInclude = std::ref(indexKeysToInclude)]() {
         if (intervals.size() == 1) {
             // If we have just a single interval, we can construct a simplified sub-tree.
             auto&& [lowKey, highKey] = intervals[0];
-            return generateSingleIntervalIndexScan(collection,
-                                                   ixn->index.identifier.catalogName,
-                                                   ixn->direction == 1,
-                                                   std::move(lowKey),
-                                                   std::move(highKey),
-                                                   indexKeysToInclude,
-                                                   vars,
-                                                   boost::none,  // recordSlot
-                                                   slotIdGenerator,
-                                                   yieldPolicy,
-                                                   tracker);
+            boost::optional<sbe::value::SlotId> lowKeySlot, highKeySlot;
+            auto lowKeyExpr = makeBoundsExpr("LowKey"_sd,
+                                             sbe::value::TypeTags::ksValue,
+                                             sbe::value::bitcastFrom(lowKey.release()),
+                                             &lowKeySlot);
+            auto highKeyExpr = makeBoundsExpr("HighKey"_sd,
+                                              sbe::value::TypeTags::ksValue,
+                                              sbe::value::bitcastFrom(highKey.release()),
+                                              &highKeySlot);
+            if (boundsParams) {
+                boundsParams->lowKeySlot = lowKeySlot;
+                boundsParams->highKeySlot = highKeySlot;
+            }
+
+            return generateSingleIntervalIndexScanImpl(collection,
+                                                       ixn->index.identifier.catalogName,
+                                                       ixn->direction == 1,
+                                                       std::move(lowKeyExpr),
+                                                       std::move(highKeyExpr),
+                                                       indexKeysToInclude,
+                                                       vars,
+                                                       boost::none,  // recordSlot
+                                                       slotIdGenerator,
+                                                       yieldPolicy,
+                                                       tracker);
         } else if (intervals.size() > 1) {
             // Or, if we were able to decompose multi-interval index bounds into a number of
             // single-interval bounds, we can also built an optimized sub-tree to perform an index
             // scan.
+            boost::optional<sbe::value::SlotId> intervalsSlot;
+            auto [tag, val] = makeIntervalsArray(std::move(intervals));
+            auto intervalsExpr = makeBoundsExpr("Intervals"_sd, tag, val, &intervalsSlot);
+            if (boundsParams) {
+                boundsParams->intervalsSlot = intervalsSlot;
+            }
+
             return generateOptimizedMultiIntervalIndexScan(collection,
                                                            ixn->index.identifier.catalogName,
                                                            ixn->direction == 1,
-                                                           std::move(intervals),
+                                                           std::move(intervalsExpr),
                                                            indexKeysToInclude,
                                                            vars,
                                                            slotIdGenerator,
                                                            yieldPolicy,
                                                            tracker);
         } else {
-            // Otherwise, build a generic index scan for multi-interval index bounds.
+            // Otherwise, build a generic index scan for multi-interval index bounds. Such scans
+            // cannot be parameterized, which is signaled to the caller by leaving 'boundsParams'
+            // unset.
             return generateGenericMultiIntervalIndexScan(
                 collection,
                 ixn,
@@ -746,7 +828,11 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateIndexScan
                                             sbe::makeEs(sbe::makeE<sbe::EVariable>(varSlot)))});
         }
         stage = sbe::makeS<sbe::HashAggStage>(
-            std::move(stage), sbe::makeSV(slot), std::move(forwardedVarSlots));
+            std::move(stage),
+            sbe::makeSV(slot),
+            std::move(forwardedVarSlots),
+            internalQuerySlotBasedExecutionHashAggMemoryUseBytesBeforeSpill.load(),
+            allowDiskUse);
     }
 
     if (returnKeyExpr) {
@@ -755,4 +841,61 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateIndexScan
 
     return {slot, std::move(stage)};
 }
+
+std::vector<const IndexScanNode*> getIndexScanNodes(const QuerySolutionNode* root) {
+    std::vector<const IndexScanNode*> nodes;
+    std::vector<const QuerySolutionNode*> stack{root};
+    while (!stack.empty()) {
+        auto node = stack.back();
+        stack.pop_back();
+
+        if (node->getType() == STAGE_IXSCAN) {
+            nodes.push_back(static_cast<const IndexScanNode*>(node));
+        }
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+            stack.push_back(*it);
+        }
+    }
+    return nodes;
+}
+
+bool bindIndexBoundsParams(OperationContext* opCtx,
+                           const Collection* collection,
+                           const IndexScanNode* ixn,
+                           const IndexBoundsParams& boundsParams,
+                           sbe::RuntimeEnvironment* env) {
+    auto descriptor =
+        collection->getIndexCatalog()->findIndexByName(opCtx, ixn->index.identifier.catalogName);
+    if (!descriptor) {
+        return false;
+    }
+
+    auto accessMethod = collection->getIndexCatalog()->getEntry(descriptor)->accessMethod();
+    auto intervals =
+        makeIntervalsFromIndexBounds(ixn->bounds,
+                                     ixn->direction == 1,
+                                     accessMethod->getSortedDataInterface()->getKeyStringVersion(),
+                                     accessMethod->getSortedDataInterface()->getOrdering());
+
+    // The new bounds must decompose into the same kind of sub-tree as the one the plan was built
+    // with, otherwise the plan cannot be reused.
+    if (intervals.size() == 1 && boundsParams.lowKeySlot && boundsParams.highKeySlot) {
+        auto&& [lowKey, highKey] = intervals[0];
+        env->resetSlot(*boundsParams.lowKeySlot,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom(lowKey.release()),
+                       true);
+        env->resetSlot(*boundsParams.highKeySlot,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom(highKey.release()),
+                       true);
+        return true;
+    } else if (intervals.size() > 1 && boundsParams.intervalsSlot) {
+        auto [tag, val] = makeIntervalsArray(std::move(intervals));
+        env->resetSlot(*boundsParams.intervalsSlot, tag, val, true);
+        return true;
+    }
+
+    return false;
+}
 }  // namespace mongo::stage_builder
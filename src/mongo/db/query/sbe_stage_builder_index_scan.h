@@ -29,14 +29,37 @@
 
 #pragma once
 
+#include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/exec/trial_run_progress_tracker.h"
 #include "mongo/db/query/query_solution.h"
 
 namespace mongo::stage_builder {
+/**
+ * Describes where the KeyString bounds of a parameterized index scan are stored in the runtime
+ * environment. Depending on how the index bounds were decomposed, either the low and high key
+ * slots, or the intervals slot is set. If none of them is set, the bounds could not be expressed
+ * as a set of intervals, and the index scan cannot be re-bound to different bounds.
+ */
+struct IndexBoundsParams {
+    // The position of the IXSCAN node within a pre-order traversal of the query solution tree.
+    size_t nodeOrdinal{0};
+
+    boost::optional<sbe::value::SlotId> lowKeySlot;
+    boost::optional<sbe::value::SlotId> highKeySlot;
+    boost::optional<sbe::value::SlotId> intervalsSlot;
+};
+
 /**
  * Generates an SBE plan stage sub-tree implementing an index scan.
+ *
+ * If 'boundsParams' is not null, the index bounds are not embedded into the tree as constants, but
+ * are registered within the runtime environment 'env', and 'boundsParams' is filled out to
+ * describe the slots holding them.
+ *
+ * If the index scan needs to be deduplicated, 'allowDiskUse' tells whether the hash aggregation
+ * doing it may spill to disk.
  */
 std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateIndexScan(
     OperationContext* opCtx,
@@ -46,7 +69,26 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateIndexScan
     sbe::value::SlotIdGenerator* slotIdGenerator,
     sbe::value::SpoolIdGenerator* spoolIdGenerator,
     PlanYieldPolicy* yieldPolicy,
-    TrialRunProgressTracker* tracker);
+    TrialRunProgressTracker* tracker,
+    sbe::RuntimeEnvironment* env,
+    bool allowDiskUse,
+    IndexBoundsParams* boundsParams);
+
+/**
+ * Returns the IXSCAN nodes of the query solution tree rooted at 'root', in pre-order.
+ */
+std::vector<const IndexScanNode*> getIndexScanNodes(const QuerySolutionNode* root);
+
+/**
+ * Re-binds the slots described by 'boundsParams' in the runtime environment 'env' to the index
+ * bounds of the given index scan node 'ixn'. Returns false if the bounds of 'ixn' cannot be
+ * expressed in the same form as the one the parameterized index scan was built with.
+ */
+bool bindIndexBoundsParams(OperationContext* opCtx,
+                           const Collection* collection,
+                           const IndexScanNode* ixn,
+                           const IndexBoundsParams& boundsParams,
+                           sbe::RuntimeEnvironment* env);
 
 /**
  * Constructs the most simple version of an index scan from the single interval index bounds. The
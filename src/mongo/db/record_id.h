@@ -33,17 +33,24 @@
 #include <boost/optional.hpp>
 #include <climits>
 #include <cstdint>
+#include <cstring>
 #include <fmt/format.h>
 #include <ostream>
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/util/bufreader.h"
+#include "mongo/util/hex.h"
+#include "mongo/util/shared_buffer.h"
 
 namespace mongo {
 
 /**
  * The key that uniquely identifies a Record in a Collection or RecordStore.
+ *
+ * A RecordId is either a 64-bit integer or, for the records of a clustered collection, a
+ * variable-length string of bytes which sorts by binary comparison. A RecordStore holds RecordIds
+ * of only one of these formats, as given by its KeyFormat.
  */
 class RecordId {
 public:
@@ -73,6 +80,16 @@ public:
      */
     RecordId(int high, int low) : _repr((uint64_t(high) << 32) | uint32_t(low)) {}
 
+    /**
+     * Constructs a variable-length RecordId holding a copy of the 'size' bytes at 'data'.
+     */
+    RecordId(const char* data, int32_t size) : _repr(size) {
+        invariant(size > 0);
+        auto buffer = SharedBuffer::allocate(size);
+        std::memcpy(buffer.get(), data, size);
+        _str = std::move(buffer);
+    }
+
     /**
      * A RecordId that compares less than all ids that represent documents in a collection.
      */
@@ -95,13 +112,32 @@ public:
     }
 
     bool isNull() const {
-        return _repr == 0;
+        return !_str && _repr == 0;
     }
 
+    /**
+     * Returns true if this RecordId is in the variable-length format.
+     */
+    bool isStr() const {
+        return static_cast<bool>(_str);
+    }
+
+    /**
+     * Returns the integer value of a RecordId which is not in the variable-length format.
+     */
     int64_t repr() const {
+        dassert(!isStr());
         return _repr;
     }
 
+    /**
+     * Returns the bytes of a RecordId in the variable-length format.
+     */
+    StringData getStr() const {
+        dassert(isStr());
+        return StringData(_str.get(), _repr);
+    }
+
     /**
      * Valid RecordIds are the only ones which may be used to represent Records. The range of valid
      * RecordIds includes both "normal" ids that refer to user data, and "reserved" ids that are
@@ -116,18 +152,30 @@ public:
      * excluding the reserved range at the top of the RecordId space.
      */
     bool isNormal() const {
-        return _repr > 0 && _repr < kMinReservedRepr;
+        return isStr() || (_repr > 0 && _repr < kMinReservedRepr);
     }
 
     /**
      * Returns true if this RecordId falls within the reserved range at the top of the record space.
      */
     bool isReserved() const {
-        return _repr >= kMinReservedRepr && _repr < kMaxRepr;
+        return !isStr() && _repr >= kMinReservedRepr && _repr < kMaxRepr;
     }
 
-    int compare(RecordId rhs) const {
-        return _repr == rhs._repr ? 0 : _repr < rhs._repr ? -1 : 1;
+    int compare(const RecordId& rhs) const {
+        if (!isStr() && !rhs.isStr()) {
+            return _repr == rhs._repr ? 0 : _repr < rhs._repr ? -1 : 1;
+        }
+        if (isStr() && rhs.isStr()) {
+            const int cmp = getStr().compare(rhs.getStr());
+            return cmp == 0 ? 0 : cmp < 0 ? -1 : 1;
+        }
+        // An integer RecordId is only compared with a variable-length one when it is a sentinel
+        // such as null, min() or max(). Only max() sorts after the variable-length RecordIds.
+        if (isStr()) {
+            return rhs._repr == kMaxRepr ? -1 : 1;
+        }
+        return _repr == kMaxRepr ? 1 : -1;
     }
 
     /**
@@ -135,7 +183,11 @@ public:
      * may differ across platforms. Hash values should not be persisted.
      */
     struct Hasher {
-        size_t operator()(RecordId rid) const {
+        size_t operator()(const RecordId& rid) const {
+            if (rid.isStr()) {
+                const auto str = rid.getStr();
+                return boost::hash_range(str.rawData(), str.rawData() + str.size());
+            }
             size_t hash = 0;
             // TODO consider better hashes
             boost::hash_combine(hash, rid.repr());
@@ -146,59 +198,83 @@ public:
     /// members for Sorter
     struct SorterDeserializeSettings {};  // unused
     void serializeForSorter(BufBuilder& buf) const {
+        buf.appendChar(isStr());
         buf.appendNum(static_cast<long long>(_repr));
+        if (isStr()) {
+            buf.appendBuf(_str.get(), _repr);
+        }
     }
     static RecordId deserializeForSorter(BufReader& buf, const SorterDeserializeSettings&) {
-        return RecordId(buf.read<LittleEndian<int64_t>>());
+        const bool isStr = buf.read<char>();
+        const auto repr = buf.read<LittleEndian<int64_t>>();
+        if (isStr) {
+            return RecordId(static_cast<const char*>(buf.skip(repr)), repr);
+        }
+        return RecordId(repr);
     }
     int memUsageForSorter() const {
-        return sizeof(RecordId);
+        return sizeof(RecordId) + (isStr() ? _repr : 0);
     }
     RecordId getOwned() const {
         return *this;
     }
 
+    /**
+     * Returns the integer value, or the bytes of a variable-length RecordId encoded as hex.
+     */
+    std::string toString() const {
+        return isStr() ? hexblob::encode(getStr()) : std::to_string(_repr);
+    }
+
     void serialize(fmt::memory_buffer& buffer) const {
-        fmt::format_to(buffer, "RecordId({})", _repr);
+        fmt::format_to(buffer, "RecordId({})", toString());
     }
 
     void serialize(BSONObjBuilder* builder) const {
-        builder->append("RecordId"_sd, _repr);
+        if (isStr()) {
+            builder->append("RecordId"_sd, toString());
+        } else {
+            builder->append("RecordId"_sd, _repr);
+        }
     }
 
 private:
+    // The integer value of the RecordId, or the size of '_str' in the variable-length format.
     int64_t _repr;
+
+    // The bytes of a RecordId in the variable-length format, or null otherwise.
+    ConstSharedBuffer _str;
 };
 
-inline bool operator==(RecordId lhs, RecordId rhs) {
-    return lhs.repr() == rhs.repr();
+inline bool operator==(const RecordId& lhs, const RecordId& rhs) {
+    return lhs.compare(rhs) == 0;
 }
-inline bool operator!=(RecordId lhs, RecordId rhs) {
-    return lhs.repr() != rhs.repr();
+inline bool operator!=(const RecordId& lhs, const RecordId& rhs) {
+    return lhs.compare(rhs) != 0;
 }
-inline bool operator<(RecordId lhs, RecordId rhs) {
-    return lhs.repr() < rhs.repr();
+inline bool operator<(const RecordId& lhs, const RecordId& rhs) {
+    return lhs.compare(rhs) < 0;
 }
-inline bool operator<=(RecordId lhs, RecordId rhs) {
-    return lhs.repr() <= rhs.repr();
+inline bool operator<=(const RecordId& lhs, const RecordId& rhs) {
+    return lhs.compare(rhs) <= 0;
 }
-inline bool operator>(RecordId lhs, RecordId rhs) {
-    return lhs.repr() > rhs.repr();
+inline bool operator>(const RecordId& lhs, const RecordId& rhs) {
+    return lhs.compare(rhs) > 0;
 }
-inline bool operator>=(RecordId lhs, RecordId rhs) {
-    return lhs.repr() >= rhs.repr();
+inline bool operator>=(const RecordId& lhs, const RecordId& rhs) {
+    return lhs.compare(rhs) >= 0;
 }
 
 inline StringBuilder& operator<<(StringBuilder& stream, const RecordId& id) {
-    return stream << "RecordId(" << id.repr() << ')';
+    return stream << "RecordId(" << id.toString() << ')';
 }
 
 inline std::ostream& operator<<(std::ostream& stream, const RecordId& id) {
-    return stream << "RecordId(" << id.repr() << ')';
+    return stream << "RecordId(" << id.toString() << ')';
 }
 
 inline std::ostream& operator<<(std::ostream& stream, const boost::optional<RecordId>& id) {
-    return stream << "RecordId(" << (id ? id.get().repr() : 0) << ')';
+    return stream << "RecordId(" << (id ? id->toString() : "0") << ')';
 }
 
 }  // namespace mongo
@@ -65,5 +65,38 @@ TEST(RecordId, HashNotEqual) {
     ASSERT_NOT_EQUALS(hasher(original), hasher(reversed));
 }
 
+TEST(RecordId, StrCompareAndHash) {
+    RecordId abc("abc", 3);
+    RecordId abd("abd", 3);
+    RecordId ab("ab", 2);
+    ASSERT_TRUE(abc.isStr());
+    ASSERT_TRUE(abc.isNormal());
+    ASSERT_FALSE(abc.isNull());
+    ASSERT_EQ(abc.getStr(), "abc");
+
+    ASSERT_EQUALS(abc, RecordId("abc", 3));
+    ASSERT_LT(ab, abc);
+    ASSERT_LT(abc, abd);
+
+    // Only RecordId::max() sorts after the variable-length RecordIds.
+    ASSERT_LT(RecordId(), ab);
+    ASSERT_LT(RecordId::min(), ab);
+    ASSERT_LT(abd, RecordId::max());
+
+    RecordId::Hasher hasher;
+    ASSERT_EQUALS(hasher(abc), hasher(RecordId("abc", 3)));
+    ASSERT_NOT_EQUALS(hasher(abc), hasher(abd));
+}
+
+TEST(RecordId, StrRoundTripsThroughSorterSerialization) {
+    for (const auto& original : {RecordId(5), RecordId("\x00\x01abc", 5)}) {
+        BufBuilder builder;
+        original.serializeForSorter(builder);
+        BufReader reader(builder.buf(), builder.len());
+        ASSERT_EQUALS(RecordId::deserializeForSorter(reader, {}), original);
+        ASSERT_TRUE(reader.atEof());
+    }
+}
+
 }  // namespace
 }  // namespace mongo
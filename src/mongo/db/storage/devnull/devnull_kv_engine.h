@@ -53,6 +53,10 @@ public:
                                      StringData ns,
                                      StringData ident,
                                      const CollectionOptions& options) {
+        if (options.clusteredIndex) {
+            return {ErrorCodes::InvalidOptions,
+                    "clustered collections are not supported by the devnull storage engine"};
+        }
         return Status::OK();
     }
 
@@ -70,6 +70,10 @@ Status KVEngine::createRecordStore(OperationContext* opCtx,
                                    StringData ns,
                                    StringData ident,
                                    const CollectionOptions& options) {
+    if (options.clusteredIndex) {
+        return {ErrorCodes::InvalidOptions,
+                "clustered collections are not supported by the ephemeralForTest storage engine"};
+    }
     stdx::lock_guard lock(_identsLock);
     _idents[ident.toString()] = true;
     return Status::OK();
@@ -472,6 +472,25 @@ boost::optional<Record> RecordStore::Cursor::seekExact(const RecordId& id) {
     return Record{id, RecordData(it->second.c_str(), it->second.length())};
 }
 
+boost::optional<Record> RecordStore::Cursor::seekNear(const RecordId& start) {
+    _savedPosition = boost::none;
+    _lastMoveWasRestore = false;
+    _needFirstSeek = false;
+    StringStore* workingCopy(RecoveryUnit::get(opCtx)->getHead());
+    it = workingCopy->lower_bound(createKey(_rs._ident, start.repr()));
+
+    if (it == workingCopy->end() || !inPrefix(it->first))
+        return boost::none;
+
+    _savedPosition = it->first;
+    RecordId id(extractRecordId(it->first));
+    if (_rs._isOplog && id > _oplogVisibility) {
+        return boost::none;
+    }
+
+    return Record{id, RecordData(it->second.c_str(), it->second.length())};
+}
+
 // Positions are saved as we go.
 void RecordStore::Cursor::save() {}
 void RecordStore::Cursor::saveUnpositioned() {}
@@ -553,6 +572,24 @@ boost::optional<Record> RecordStore::ReverseCursor::seekExact(const RecordId& id
     return Record{id, RecordData(it->second.c_str(), it->second.length())};
 }
 
+boost::optional<Record> RecordStore::ReverseCursor::seekNear(const RecordId& start) {
+    _needFirstSeek = false;
+    _savedPosition = boost::none;
+    _lastMoveWasRestore = false;
+    StringStore* workingCopy(RecoveryUnit::get(opCtx)->getHead());
+    // The reverse_iterator points to the element preceding the one its base points to, which is
+    // the last record at or before 'start'.
+    it = StringStore::const_reverse_iterator(
+        workingCopy->upper_bound(createKey(_rs._ident, start.repr())));
+
+    if (it == workingCopy->rend() || !inPrefix(it->first))
+        return boost::none;
+
+    _savedPosition = it->first;
+    return Record{RecordId(extractRecordId(it->first)),
+                  RecordData(it->second.c_str(), it->second.length())};
+}
+
 void RecordStore::ReverseCursor::save() {}
 void RecordStore::ReverseCursor::saveUnpositioned() {}
 
@@ -188,6 +188,7 @@ private:
                VisibilityManager* visibilityManager);
         boost::optional<Record> next() final;
         boost::optional<Record> seekExact(const RecordId& id) final override;
+        boost::optional<Record> seekNear(const RecordId& start) final override;
         void save() final;
         void saveUnpositioned() final override;
         bool restore() final;
@@ -213,6 +214,7 @@ private:
                       VisibilityManager* visibilityManager);
         boost::optional<Record> next() final;
         boost::optional<Record> seekExact(const RecordId& id) final override;
+        boost::optional<Record> seekNear(const RecordId& start) final override;
         void save() final;
         void saveUnpositioned() final override;
         bool restore() final;
@@ -0,0 +1,86 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/record_id_helpers.h"
+
+#include "mongo/bson/bson_validate.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/util/debug_util.h"
+
+namespace mongo {
+namespace record_id_helpers {
+
+RecordId keyForId(const BSONElement& id) {
+    KeyString::Builder keyString(KeyString::Version::kLatestVersion);
+    keyString.appendBSONElement(id);
+    auto value = keyString.getValueCopy();
+    return RecordId(value.getBuffer(), value.getSize());
+}
+
+StatusWith<RecordId> extractKey(const char* data, int len) {
+    if (kDebugBuild)
+        invariant(validateBSON(data, len).isOK());
+
+    const BSONObj obj(data);
+    const BSONElement id = obj["_id"];
+    if (id.eoo())
+        return StatusWith<RecordId>(ErrorCodes::BadValue, "no _id field");
+
+    return keyForId(id);
+}
+
+void appendToBSONAs(const RecordId& rid, BSONObjBuilder* builder, StringData fieldName) {
+    if (rid.isStr()) {
+        const auto str = rid.getStr();
+        builder->appendBinData(fieldName, str.size(), BinDataGeneral, str.rawData());
+    } else {
+        builder->append(fieldName, static_cast<long long>(rid.repr()));
+    }
+}
+
+RecordId fromBSONElement(const BSONElement& elem) {
+    if (elem.type() == BinData) {
+        int size;
+        const char* data = elem.binData(size);
+        uassert(ErrorCodes::BadValue, "RecordId must not be empty", size > 0);
+        return RecordId(data, size);
+    }
+    uassert(ErrorCodes::BadValue,
+            str::stream() << "RecordId must be a NumberLong or BinData, not "
+                          << typeName(elem.type()),
+            elem.type() == NumberLong);
+    return RecordId(elem.numberLong());
+}
+
+}  // namespace record_id_helpers
+}  // namespace mongo
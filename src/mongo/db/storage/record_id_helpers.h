@@ -0,0 +1,67 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+class BSONObjBuilder;
+class RecordId;
+
+namespace record_id_helpers {
+
+/**
+ * Returns the RecordId under which a clustered collection stores the document whose _id is 'id'.
+ * This is the KeyString encoding of 'id', so that the RecordIds sort in the same order as the _id
+ * values, and _id values which compare equal, such as 1 and 1.0, map to the same RecordId.
+ */
+RecordId keyForId(const BSONElement& id);
+
+/**
+ * data and len must be the arguments from RecordStore::insert() on a clustered collection.
+ */
+StatusWith<RecordId> extractKey(const char* data, int len);
+
+/**
+ * Appends 'rid' to 'builder' under 'fieldName', as a NumberLong, or as BinData if it is in the
+ * variable-length format.
+ */
+void appendToBSONAs(const RecordId& rid, BSONObjBuilder* builder, StringData fieldName);
+
+/**
+ * Returns the RecordId appended to 'elem' by appendToBSONAs(). Throws if 'elem' is neither a
+ * NumberLong nor BinData.
+ */
+RecordId fromBSONElement(const BSONElement& elem);
+
+}  // namespace record_id_helpers
+}  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/ident.h"
+#include "mongo/db/storage/key_format.h"
 #include "mongo/db/storage/record_data.h"
 
 namespace mongo {
@@ -172,6 +173,19 @@ public:
      */
     virtual boost::optional<Record> seekExact(const RecordId& id) = 0;
 
+    /**
+     * Seeks to the first Record whose id is at or after 'start' in the direction of the cursor,
+     * and returns it, or boost::none if there is no such Record. Subsequent calls to next()
+     * continue from the returned Record.
+     *
+     * This is used to scan a range of a clustered collection, and to position the ranges of a
+     * parallel collection scan, so only record stores which support KeyFormat::String or hold
+     * enough records for a parallel scan to split have to implement it.
+     */
+    virtual boost::optional<Record> seekNear(const RecordId& start) {
+        MONGO_UNREACHABLE;
+    }
+
     /**
      * Prepares for state changes in underlying data without necessarily saving the current
      * state.
@@ -240,6 +254,15 @@ public:
 
     virtual bool isCapped() const = 0;
 
+    /**
+     * Returns the format of the RecordIds in this RecordStore. A RecordStore with KeyFormat::String
+     * takes the RecordIds of inserted records from their _id, and holds the records of a clustered
+     * collection.
+     */
+    virtual KeyFormat keyFormat() const {
+        return KeyFormat::Long;
+    }
+
     virtual void setCappedCallback(CappedCallback*) {
         MONGO_UNREACHABLE;
     }
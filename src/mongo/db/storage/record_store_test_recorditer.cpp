@@ -483,5 +483,60 @@ TEST(RecordStoreTestHarness, SeekExactForMissingRecordReturnsNone) {
     ASSERT_FALSE(recordStore->findRecord(opCtx.get(), recordIds[1], &outputData));
 }
 
+// seekNear() must position the cursor on the next record in its direction if the RecordId does not
+// exist.
+TEST(RecordStoreTestHarness, SeekNearForMissingRecordReturnsNextRecord) {
+    const auto harnessHelper{newRecordStoreHarnessHelper()};
+    auto recordStore = harnessHelper->newNonCappedRecordStore();
+    ServiceContext::UniqueOperationContext opCtx{harnessHelper->newOperationContext()};
+
+    // Insert three records and remember their record ids.
+    const int nToInsert = 3;
+    RecordId recordIds[nToInsert];
+    for (int i = 0; i < nToInsert; ++i) {
+        StringBuilder sb;
+        sb << "record " << i;
+        string data = sb.str();
+
+        WriteUnitOfWork uow{opCtx.get()};
+        auto res =
+            recordStore->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, Timestamp{});
+        ASSERT_OK(res.getStatus());
+        recordIds[i] = res.getValue();
+        uow.commit();
+    }
+    std::sort(recordIds, recordIds + nToInsert);
+
+    // Delete the second record.
+    {
+        WriteUnitOfWork uow{opCtx.get()};
+        recordStore->deleteRecord(opCtx.get(), recordIds[1]);
+        uow.commit();
+    }
+
+    // A forward cursor lands on the third record and continues from there.
+    {
+        auto cursor = recordStore->getCursor(opCtx.get(), true);
+        auto record = cursor->seekNear(recordIds[1]);
+        ASSERT(record);
+        ASSERT_EQUALS(recordIds[2], record->id);
+        ASSERT(!cursor->next());
+
+        record = cursor->seekNear(recordIds[0]);
+        ASSERT(record);
+        ASSERT_EQUALS(recordIds[0], record->id);
+        ASSERT(!cursor->seekNear(RecordId(recordIds[2].repr() + 1)));
+    }
+
+    // A reverse cursor lands on the first record and continues from there.
+    {
+        auto cursor = recordStore->getCursor(opCtx.get(), false);
+        auto record = cursor->seekNear(recordIds[1]);
+        ASSERT(record);
+        ASSERT_EQUALS(recordIds[0], record->id);
+        ASSERT(!cursor->next());
+    }
+}
+
 }  // namespace
 }  // namespace mongo
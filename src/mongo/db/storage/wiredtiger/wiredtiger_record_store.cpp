@@ -53,7 +53,9 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_recovery.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/index_entry_comparison.h"
 #include "mongo/db/storage/oplog_hack.h"
+#include "mongo/db/storage/record_id_helpers.h"
 #include "mongo/db/storage/wiredtiger/oplog_stone_parameters_gen.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
@@ -661,9 +663,7 @@ public:
             return {};
         invariantWTOK(advanceRet);
 
-        int64_t key;
-        invariantWTOK(_cursor->get_key(_cursor, &key));
-        const RecordId id = RecordId(key);
+        const RecordId id = _rs->getKey(_cursor);
 
         WT_ITEM value;
         invariantWTOK(_cursor->get_value(_cursor, &value));
@@ -769,7 +769,15 @@ StatusWith<std::string> WiredTigerRecordStore::generateCreateString(
 
     // WARNING: No user-specified config can appear below this line. These options are required
     // for correct behavior of the server.
-    if (prefixed) {
+    if (options.clusteredIndex) {
+        // A clustered collection is keyed by the KeyString encoding of the _id of its documents,
+        // which a grouped collection cannot prefix.
+        if (prefixed) {
+            return {ErrorCodes::InvalidOptions,
+                    "clustered collections are not supported with grouped collections"};
+        }
+        ss << "key_format=u";
+    } else if (prefixed) {
         ss << "key_format=qq";
     } else {
         ss << "key_format=q";
@@ -812,6 +820,7 @@ WiredTigerRecordStore::WiredTigerRecordStore(WiredTigerKVEngine* kvEngine,
                     getGlobalReplSettings().usingReplSets() ||
                         repl::ReplSettings::shouldRecoverFromOplogAsStandalone())),
       _isOplog(NamespaceString::oplog(params.ns)),
+      _keyFormat(params.keyFormat),
       _cappedMaxSize(params.cappedMaxSize),
       _cappedMaxSizeSlack(std::min(params.cappedMaxSize / 10, int64_t(16 * 1024 * 1024))),
       _cappedMaxDocs(params.cappedMaxDocs),
@@ -1476,10 +1485,18 @@ Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
             if (!status.isOK())
                 return status.getStatus();
             record.id = status.getValue();
+        } else if (_keyFormat == KeyFormat::String) {
+            StatusWith<RecordId> status =
+                record_id_helpers::extractKey(record.data.data(), record.data.size());
+            if (!status.isOK())
+                return status.getStatus();
+            record.id = status.getValue();
         } else {
             record.id = _nextId(opCtx);
         }
-        dassert(record.id > highestIdRecord.id);
+        // The RecordIds of a clustered collection come from the _id of the documents, which need
+        // not be inserted in order.
+        dassert(_keyFormat == KeyFormat::String || record.id > highestIdRecord.id);
         highestIdRecord = record;
     }
 
@@ -1502,6 +1519,21 @@ Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
             LOGV2_DEBUG(22403, 4, "inserting record with timestamp {ts}", "ts"_attr = ts);
             fassert(39001, opCtx->recoveryUnit()->setTimestamp(ts));
         }
+        if (_keyFormat == KeyFormat::String) {
+            // The cursor overwrites existing records, so a duplicate _id has to be looked for
+            // before inserting.
+            setKey(c, record.id);
+            int ret = wiredTigerPrepareConflictRetry(opCtx, [&] { return c->search(c); });
+            if (ret == 0) {
+                return buildDupKeyErrorStatus(BSON("" << record.data.toBson()["_id"]),
+                                              NamespaceString(ns()),
+                                              "_id_",
+                                              BSON("_id" << 1),
+                                              BSONObj());
+            }
+            if (ret != WT_NOTFOUND)
+                return wtRCToStatus(ret, "WiredTigerRecordStore::insertRecord");
+        }
         setKey(c, record.id);
         WiredTigerItem value(record.data.data(), record.data.size());
         c->set_value(c, value.Get());
@@ -1896,6 +1928,11 @@ void WiredTigerRecordStore::updateStatsAfterRepair(OperationContext* opCtx,
 }
 
 void WiredTigerRecordStore::_initNextIdIfNeeded(OperationContext* opCtx) {
+    // The RecordIds of a clustered collection are not generated.
+    if (_keyFormat == KeyFormat::String) {
+        return;
+    }
+
     // In the normal case, this will already be initialized, so use a weak load. Since this value
     // will only change from 0 to a positive integer, the only risk is reading an outdated value, 0,
     // and having to take the mutex.
@@ -2214,6 +2251,50 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordI
     return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
 }
 
+boost::optional<Record> WiredTigerRecordStoreCursorBase::seekNear(const RecordId& start) {
+    invariant(_hasRestored);
+
+    // Ensure an active transaction is open.
+    WiredTigerRecoveryUnit::get(_opCtx)->getSession();
+
+    _skipNextAdvance = false;
+    WT_CURSOR* c = _cursor->get();
+    setKey(c, start);
+    int cmp;
+    // Nothing after the next line can throw WCEs.
+    int ret = wiredTigerPrepareConflictRetry(_opCtx, [&] { return c->search_near(c, &cmp); });
+    if (ret == 0 && (_forward ? cmp < 0 : cmp > 0)) {
+        // We landed on the record just before 'start' in the direction of the cursor.
+        ret = wiredTigerPrepareConflictRetry(_opCtx,
+                                             [&] { return _forward ? c->next(c) : c->prev(c); });
+    }
+    if (ret == WT_NOTFOUND) {
+        _eof = true;
+        return {};
+    }
+    invariantWTOK(ret);
+
+    RecordId id;
+    if (hasWrongPrefix(c, &id)) {
+        _eof = true;
+        return {};
+    }
+    if (!id.isValid()) {
+        id = getKey(c);
+    }
+
+    if (_oplogVisibleTs && id.repr() > *_oplogVisibleTs) {
+        _eof = true;
+        return {};
+    }
+
+    WT_ITEM value;
+    invariantWTOK(c->get_value(c, &value));
+
+    _lastReturnedId = id;
+    _eof = false;
+    return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
+}
 
 void WiredTigerRecordStoreCursorBase::save() {
     try {
@@ -2306,6 +2387,32 @@ void WiredTigerRecordStoreCursorBase::reattachToOperationContext(OperationContex
 
 // Standard Implementations:
 
+namespace {
+RecordId getStandardKey(WT_CURSOR* cursor, KeyFormat keyFormat) {
+    if (keyFormat == KeyFormat::String) {
+        WT_ITEM item;
+        invariantWTOK(cursor->get_key(cursor, &item));
+        return RecordId(static_cast<const char*>(item.data), item.size);
+    }
+    std::int64_t recordId;
+    invariantWTOK(cursor->get_key(cursor, &recordId));
+    return RecordId(recordId);
+}
+
+/**
+ * WiredTiger does not copy the bytes of a 'u' key, so the buffer of 'id', which is shared with the
+ * RecordId of the caller, has to outlive the next operation on the cursor.
+ */
+void setStandardKey(WT_CURSOR* cursor, const RecordId& id) {
+    if (id.isStr()) {
+        const auto str = id.getStr();
+        WiredTigerItem item(str.rawData(), str.size());
+        cursor->set_key(cursor, item.Get());
+    } else {
+        cursor->set_key(cursor, id.repr());
+    }
+}
+}  // namespace
 
 StandardWiredTigerRecordStore::StandardWiredTigerRecordStore(WiredTigerKVEngine* kvEngine,
                                                              OperationContext* opCtx,
@@ -2313,13 +2420,11 @@ StandardWiredTigerRecordStore::StandardWiredTigerRecordStore(WiredTigerKVEngine*
     : WiredTigerRecordStore(kvEngine, opCtx, params) {}
 
 RecordId StandardWiredTigerRecordStore::getKey(WT_CURSOR* cursor) const {
-    std::int64_t recordId;
-    invariantWTOK(cursor->get_key(cursor, &recordId));
-    return RecordId(recordId);
+    return getStandardKey(cursor, _keyFormat);
 }
 
 void StandardWiredTigerRecordStore::setKey(WT_CURSOR* cursor, RecordId id) const {
-    cursor->set_key(cursor, id.repr());
+    setStandardKey(cursor, id);
 }
 
 std::unique_ptr<SeekableRecordCursor> StandardWiredTigerRecordStore::getCursor(
@@ -2349,19 +2454,16 @@ WiredTigerRecordStoreStandardCursor::WiredTigerRecordStoreStandardCursor(
     : WiredTigerRecordStoreCursorBase(opCtx, rs, forward) {}
 
 void WiredTigerRecordStoreStandardCursor::setKey(WT_CURSOR* cursor, RecordId id) const {
-    cursor->set_key(cursor, id.repr());
+    setStandardKey(cursor, id);
 }
 
 RecordId WiredTigerRecordStoreStandardCursor::getKey(WT_CURSOR* cursor) const {
-    std::int64_t recordId;
-    invariantWTOK(cursor->get_key(cursor, &recordId));
-
-    return RecordId(recordId);
+    return getStandardKey(cursor, _rs.keyFormat());
 }
 
 bool WiredTigerRecordStoreStandardCursor::hasWrongPrefix(WT_CURSOR* cursor,
                                                          RecordId* recordId) const {
-    invariantWTOK(cursor->get_key(cursor, recordId));
+    *recordId = getKey(cursor);
     return false;
 }
 
@@ -2430,7 +2532,9 @@ RecordId WiredTigerRecordStorePrefixedCursor::getKey(WT_CURSOR* cursor) const {
 bool WiredTigerRecordStorePrefixedCursor::hasWrongPrefix(WT_CURSOR* cursor,
                                                          RecordId* recordId) const {
     std::int64_t prefix;
-    invariantWTOK(cursor->get_key(cursor, &prefix, recordId));
+    std::int64_t id;
+    invariantWTOK(cursor->get_key(cursor, &prefix, &id));
+    *recordId = RecordId(id);
 
     return prefix != _prefix.repr();
 }
@@ -2438,9 +2542,9 @@ bool WiredTigerRecordStorePrefixedCursor::hasWrongPrefix(WT_CURSOR* cursor,
 void WiredTigerRecordStorePrefixedCursor::initCursorToBeginning() {
     WT_CURSOR* cursor = _cursor->get();
     if (_forward) {
-        cursor->set_key(cursor, _prefix.repr(), RecordId::min());
+        cursor->set_key(cursor, _prefix.repr(), RecordId::min().repr());
     } else {
-        cursor->set_key(cursor, _prefix.repr(), RecordId::max());
+        cursor->set_key(cursor, _prefix.repr(), RecordId::max().repr());
     }
 
     int exact;
@@ -114,6 +114,7 @@ public:
         WiredTigerSizeStorer* sizeStorer;
         bool isReadOnly;
         bool tracksSizeAdjustments;
+        KeyFormat keyFormat = KeyFormat::Long;
     };
 
     WiredTigerRecordStore(WiredTigerKVEngine* kvEngine, OperationContext* opCtx, Params params);
@@ -133,6 +134,10 @@ public:
 
     virtual bool isCapped() const;
 
+    KeyFormat keyFormat() const override {
+        return _keyFormat;
+    }
+
     virtual int64_t storageSize(OperationContext* opCtx,
                                 BSONObjBuilder* extraInfo = nullptr,
                                 int infoLevel = 0) const;
@@ -351,6 +356,9 @@ private:
     const bool _isLogged;
     // True if the namespace of this record store starts with "local.oplog.", and false otherwise.
     const bool _isOplog;
+    // The format of the keys of this record store, which is KeyFormat::String for the records of
+    // a clustered collection.
+    const KeyFormat _keyFormat;
     int64_t _cappedMaxSize;
     const int64_t _cappedMaxSizeSlack;  // when to start applying backpressure
     const int64_t _cappedMaxDocs;
@@ -440,6 +448,8 @@ public:
 
     boost::optional<Record> seekExact(const RecordId& id);
 
+    boost::optional<Record> seekNear(const RecordId& start);
+
     void save();
 
     void saveUnpositioned();
@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/bucket_catalog.h"
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+const auto getBucketCatalog = ServiceContext::declareDecoration<BucketCatalog>();
+
+}  // namespace
+
+BucketCatalog& BucketCatalog::get(ServiceContext* serviceContext) {
+    return getBucketCatalog(serviceContext);
+}
+
+BucketCatalog::Placement BucketCatalog::insert(const UUID& uuid,
+                                               const TimeseriesOptions& options,
+                                               const BSONObj& doc) {
+    auto timeElem = doc[options.getTimeField()];
+    uassert(5095431,
+            str::stream() << "'" << options.getTimeField()
+                          << "' must be present and contain a date in every measurement of a "
+                             "time-series collection: "
+                          << doc,
+            timeElem.type() == BSONType::Date);
+    const auto time = timeElem.date();
+
+    // The field name of the meta value is the same for every measurement of the collection, so the
+    // whole element can be compared.
+    std::string metaKey;
+    if (auto metaField = options.getMetaField()) {
+        if (auto metaElem = doc[*metaField]) {
+            metaKey.assign(metaElem.rawdata(), metaElem.size());
+        }
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto& collBuckets = _buckets[uuid];
+    auto it = collBuckets.find(metaKey);
+    if (it != collBuckets.end()) {
+        auto& bucket = it->second;
+        if (bucket.numMeasurements < gTimeseriesBucketMaxCount.load() &&
+            bucket.size + doc.objsize() <= gTimeseriesBucketMaxSize.load() &&
+            time >= bucket.minTime &&
+            time < bucket.minTime + Seconds(options.getBucketMaxSpanSeconds())) {
+            bucket.size += doc.objsize();
+            return {bucket.id, bucket.numMeasurements++};
+        }
+
+        // The bucket is full or the measurement is outside of its time span, so it is closed and
+        // replaced by a new bucket.
+        collBuckets.erase(it);
+        --_numBuckets;
+    }
+
+    // Bound the memory used by the open buckets, at the cost of starting new buckets which could
+    // have been added to.
+    if (_numBuckets >= static_cast<size_t>(gTimeseriesMaxOpenBuckets.load())) {
+        _buckets.clear();
+        _numBuckets = 0;
+    }
+
+    Bucket bucket{OID::gen(), time, 1, doc.objsize()};
+    _buckets[uuid].emplace(std::move(metaKey), bucket);
+    ++_numBuckets;
+    return {bucket.id, 0};
+}
+
+void BucketCatalog::clear(const UUID& uuid) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto it = _buckets.find(uuid);
+    if (it != _buckets.end()) {
+        _numBuckets -= it->second.size();
+        _buckets.erase(it);
+    }
+}
+
+void BucketCatalog::clear() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _buckets.clear();
+    _numBuckets = 0;
+}
+
+}  // namespace mongo
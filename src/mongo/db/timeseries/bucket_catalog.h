@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/oid.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/timeseries/timeseries_gen.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/string_map.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+/**
+ * Assigns the measurements inserted into time-series collections to buckets. Each collection has at
+ * most one open bucket per value of the meta field of its measurements, and a measurement is added
+ * to the open bucket with the same meta value unless that bucket is full, or the time of the
+ * measurement is outside of the time span of the bucket. A new bucket is opened in that case.
+ *
+ * A bucket is a document of the buckets collection of the form
+ *
+ *     {_id: <ObjectId>,
+ *      control: {version: 1, min: {<field>: <min>, ...}, max: {<field>: <max>, ...}},
+ *      meta: <meta value>,
+ *      data: {<field>: {'0': <value>, '1': <value>, ...}, ...}}
+ *
+ * where the values of each field of the measurements are stored together, keyed by the position of
+ * the measurement in the bucket, and 'control' holds the minimum and maximum of each field over
+ * the measurements of the bucket. The catalog only decides which bucket and which position each
+ * measurement goes to; the caller writes the bucket documents.
+ *
+ * The catalog only lives in memory. Buckets which were open when the server restarted, or when this
+ * node became primary, are not added to again. This class is thread safe.
+ */
+class BucketCatalog {
+public:
+    /**
+     * The bucket a measurement is added to, and the position of the measurement in it.
+     */
+    struct Placement {
+        OID bucketId;
+        int index;
+    };
+
+    static BucketCatalog& get(ServiceContext* serviceContext);
+
+    /**
+     * Returns where the measurement 'doc' of the time-series collection whose buckets collection
+     * has the UUID 'uuid' and the options 'options' goes, opening a new bucket if needed. Throws if
+     * the time field of 'doc' is not a date.
+     */
+    Placement insert(const UUID& uuid, const TimeseriesOptions& options, const BSONObj& doc);
+
+    /**
+     * Closes the open buckets of the collection 'uuid'.
+     */
+    void clear(const UUID& uuid);
+
+    /**
+     * Closes every open bucket.
+     */
+    void clear();
+
+private:
+    struct Bucket {
+        OID id;
+        // The time of the first measurement of the bucket. The measurements of the bucket are no
+        // earlier than this time, and earlier than this time plus the bucket span of the
+        // collection.
+        Date_t minTime;
+        int numMeasurements = 0;
+        // The sum of the sizes of the measurements of the bucket.
+        int size = 0;
+    };
+
+    Mutex _mutex = MONGO_MAKE_LATCH("BucketCatalog::_mutex");
+
+    // The open buckets of each collection, by the binary value of the meta field of their
+    // measurements, or the empty string for the measurements without a meta field.
+    stdx::unordered_map<UUID, StringMap<Bucket>, UUID::Hash> _buckets;
+    size_t _numBuckets = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/timeseries/bucket_catalog.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+class BucketCatalogTest : public unittest::Test {
+protected:
+    BSONObj measurement(int seconds, BSONObj meta = BSONObj()) {
+        BSONObjBuilder builder;
+        builder.appendDate("t", Date_t::fromMillisSinceEpoch(seconds * 1000LL));
+        builder.appendElements(meta);
+        builder.append("x", seconds);
+        return builder.obj();
+    }
+
+    BucketCatalog::Placement insert(const BSONObj& doc) {
+        return _catalog.insert(_uuid, _options, doc);
+    }
+
+    BucketCatalog _catalog;
+    UUID _uuid = UUID::gen();
+    TimeseriesOptions _options = TimeseriesOptions::parse(
+        IDLParserErrorContext("timeseries"), BSON("timeField"
+                                                  << "t"
+                                                  << "metaField"
+                                                  << "m"
+                                                  << "bucketMaxSpanSeconds" << 60));
+};
+
+TEST_F(BucketCatalogTest, MeasurementsWithTheSameMetaGoToTheSameBucket) {
+    auto first = insert(measurement(0, BSON("m" << 1)));
+    ASSERT_EQ(first.index, 0);
+
+    auto second = insert(measurement(1, BSON("m" << 1)));
+    ASSERT_EQ(second.bucketId, first.bucketId);
+    ASSERT_EQ(second.index, 1);
+
+    auto other = insert(measurement(1, BSON("m" << 2)));
+    ASSERT_NE(other.bucketId, first.bucketId);
+    ASSERT_EQ(other.index, 0);
+
+    // Meta values are compared by their binary value, so values of different types which compare
+    // equal go to different buckets.
+    auto otherType = insert(measurement(1, BSON("m" << 1.0)));
+    ASSERT_NE(otherType.bucketId, first.bucketId);
+
+    auto noMeta = insert(measurement(1));
+    ASSERT_NE(noMeta.bucketId, first.bucketId);
+    ASSERT_EQ(insert(measurement(2)).bucketId, noMeta.bucketId);
+
+    ASSERT_EQ(insert(measurement(2, BSON("m" << 1))).bucketId, first.bucketId);
+}
+
+TEST_F(BucketCatalogTest, MeasurementOutsideOfTheTimeSpanOpensANewBucket) {
+    auto first = insert(measurement(100));
+    ASSERT_EQ(insert(measurement(159)).bucketId, first.bucketId);
+
+    auto later = insert(measurement(160));
+    ASSERT_NE(later.bucketId, first.bucketId);
+    ASSERT_EQ(later.index, 0);
+
+    // A measurement earlier than the open bucket replaces it with a new bucket.
+    auto earlier = insert(measurement(150));
+    ASSERT_NE(earlier.bucketId, later.bucketId);
+    ASSERT_EQ(insert(measurement(151)).bucketId, earlier.bucketId);
+}
+
+TEST_F(BucketCatalogTest, FullBucketIsClosed) {
+    const auto originalMaxCount = gTimeseriesBucketMaxCount.load();
+    gTimeseriesBucketMaxCount.store(3);
+    ON_BLOCK_EXIT([&] { gTimeseriesBucketMaxCount.store(originalMaxCount); });
+
+    auto first = insert(measurement(0));
+    ASSERT_EQ(insert(measurement(1)).bucketId, first.bucketId);
+    ASSERT_EQ(insert(measurement(2)).index, 2);
+
+    auto next = insert(measurement(3));
+    ASSERT_NE(next.bucketId, first.bucketId);
+    ASSERT_EQ(next.index, 0);
+
+    const auto originalMaxSize = gTimeseriesBucketMaxSize.load();
+    gTimeseriesBucketMaxSize.store(measurement(0).objsize() * 2);
+    ON_BLOCK_EXIT([&] { gTimeseriesBucketMaxSize.store(originalMaxSize); });
+
+    ASSERT_EQ(insert(measurement(4)).bucketId, next.bucketId);
+    ASSERT_NE(insert(measurement(5)).bucketId, next.bucketId);
+}
+
+TEST_F(BucketCatalogTest, ClearClosesTheBuckets) {
+    auto first = insert(measurement(0));
+    _catalog.clear(UUID::gen());
+    ASSERT_EQ(insert(measurement(1)).bucketId, first.bucketId);
+
+    _catalog.clear(_uuid);
+    auto second = insert(measurement(2));
+    ASSERT_NE(second.bucketId, first.bucketId);
+
+    _catalog.clear();
+    ASSERT_NE(insert(measurement(3)).bucketId, second.bucketId);
+}
+
+TEST_F(BucketCatalogTest, TimeMustBeADate) {
+    ASSERT_THROWS_CODE(insert(BSON("x" << 1)), DBException, 5095431);
+    ASSERT_THROWS_CODE(insert(BSON("t" << 1)), DBException, 5095431);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,230 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/views/materialized_view.h"
+
+#include <limits>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/ops/delete.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+
+constexpr StringData MaterializedView::kSourceFieldName;
+constexpr StringData MaterializedView::kPipelineFieldName;
+
+namespace {
+
+/**
+ * Returns true if the stage named 'stageName' may appear before the $group of a materialized view.
+ * These stages transform each document on its own, so they can be applied to one source document
+ * at a time.
+ */
+bool isAllowedBeforeGroup(StringData stageName) {
+    return stageName == "$match"_sd || stageName == "$project"_sd ||
+        stageName == "$addFields"_sd || stageName == "$set"_sd || stageName == "$unset"_sd ||
+        stageName == "$unwind"_sd;
+}
+
+/**
+ * Returns true if 'stmt' counts the documents of its group, that is if it is {$sum: 1}.
+ */
+bool isCount(const AccumulationStatement& stmt) {
+    auto constant = dynamic_cast<ExpressionConstant*>(stmt.expr.argument.get());
+    return constant && constant->getValue().numeric() &&
+        constant->getValue().coerceToDouble() == 1;
+}
+
+/**
+ * Returns the value which cancels out 'value' when both are passed to $sum. Non-numeric values are
+ * ignored by $sum, so they are returned unchanged.
+ */
+Value negate(const Value& value) {
+    switch (value.getType()) {
+        case NumberInt:
+            return value.getInt() == std::numeric_limits<int>::min()
+                ? Value(-static_cast<long long>(value.getInt()))
+                : Value(-value.getInt());
+        case NumberLong:
+            return value.getLong() == std::numeric_limits<long long>::min()
+                ? Value(-value.coerceToDouble())
+                : Value(-value.getLong());
+        case NumberDouble:
+            return Value(-value.getDouble());
+        case NumberDecimal:
+            return Value(value.getDecimal().negate());
+        default:
+            return value;
+    }
+}
+
+}  // namespace
+
+NamespaceString MaterializedView::getSource(StringData dbName, const BSONObj& definition) {
+    for (auto&& elem : definition) {
+        uassert(5095420,
+                str::stream() << "Unrecognized field '" << elem.fieldNameStringData()
+                              << "' in the definition of a materialized view",
+                elem.fieldNameStringData() == kSourceFieldName ||
+                    elem.fieldNameStringData() == kPipelineFieldName);
+    }
+
+    auto source = definition[kSourceFieldName];
+    uassert(5095421,
+            str::stream() << "The '" << kSourceFieldName
+                          << "' of a materialized view must be the name of a collection",
+            source.type() == String &&
+                NamespaceString(dbName, source.valueStringData()).isValid());
+    return NamespaceString(dbName, source.valueStringData());
+}
+
+MaterializedView::MaterializedView(OperationContext* opCtx,
+                                   StringData dbName,
+                                   const BSONObj& definition)
+    : _expCtx(make_intrusive<ExpressionContext>(opCtx, nullptr, getSource(dbName, definition))),
+      _input(DocumentSourceQueue::create(_expCtx)) {
+    auto pipeline = definition[kPipelineFieldName];
+    uassert(5095422,
+            str::stream() << "The '" << kPipelineFieldName
+                          << "' of a materialized view must be an array of stages ending with a "
+                          << DocumentSourceGroup::kStageName,
+            pipeline.type() == Array && !pipeline.Obj().isEmpty());
+
+    Pipeline::SourceContainer sources{_input};
+    const auto stages = pipeline.Array();
+    for (size_t i = 0; i < stages.size(); ++i) {
+        uassert(5095422,
+                str::stream() << "Each stage of the pipeline of a materialized view must be an "
+                                 "object with a single field, found: "
+                              << stages[i],
+                stages[i].type() == Object && stages[i].Obj().nFields() == 1);
+        auto stage = stages[i].Obj().firstElement();
+
+        if (i + 1 < stages.size()) {
+            uassert(5095423,
+                    str::stream() << stage.fieldNameStringData()
+                                  << " is not allowed before the $group of a materialized view",
+                    isAllowedBeforeGroup(stage.fieldNameStringData()));
+            sources.splice(sources.end(), DocumentSource::parse(_expCtx, stages[i].Obj()));
+            continue;
+        }
+
+        uassert(5095422,
+                str::stream() << "The pipeline of a materialized view must end with a "
+                              << DocumentSourceGroup::kStageName,
+                stage.fieldNameStringData() == DocumentSourceGroup::kStageName);
+        _group = boost::static_pointer_cast<DocumentSourceGroup>(
+            DocumentSourceGroup::createFromBson(stage, _expCtx));
+    }
+    _pipeline = Pipeline::create(std::move(sources), _expCtx);
+
+    // Only sums can be updated from the changed documents alone.
+    boost::optional<size_t> countIndex;
+    const auto& fields = _group->getAccumulatedFields();
+    for (size_t i = 0; i < fields.size(); ++i) {
+        uassert(5095424,
+                str::stream() << "The accumulators of a materialized view must be $sum, found "
+                              << fields[i].makeAccumulator()->getOpName() << " for '"
+                              << fields[i].fieldName << "'",
+                StringData(fields[i].makeAccumulator()->getOpName()) == "$sum"_sd);
+        if (!countIndex && isCount(fields[i])) {
+            countIndex = i;
+        }
+    }
+    uassert(5095425,
+            "The $group of a materialized view must count the documents of each group with "
+            "{$sum: 1}, so that empty groups can be removed",
+            countIndex);
+    _countIndex = *countIndex;
+}
+
+void MaterializedView::_accumulate(const BSONObj& doc, bool remove) {
+    const auto& fields = _group->getAccumulatedFields();
+
+    _input->emplace_back(Document(doc));
+    while (auto next = _pipeline->getNext()) {
+        auto id = _group->computeOutputId(*next);
+        uassert(5095426,
+                str::stream() << "The _id of a group of a materialized view cannot be an array, "
+                                 "found: "
+                              << id.toString(),
+                !id.isArray());
+
+        auto& accumulators = _changes[id];
+        if (accumulators.empty()) {
+            for (auto&& field : fields) {
+                accumulators.push_back(field.makeAccumulator());
+            }
+        }
+
+        for (size_t i = 0; i < fields.size(); ++i) {
+            auto value = fields[i].expr.argument->evaluate(*next, &_expCtx->variables);
+            accumulators[i]->process(remove ? negate(value) : value, false);
+        }
+    }
+}
+
+void MaterializedView::applyChanges(OperationContext* opCtx, const Collection* target) {
+    const auto& fields = _group->getAccumulatedFields();
+
+    for (auto&& [id, changes] : _changes) {
+        BSONObjBuilder idBuilder;
+        id.addToBsonObj(&idBuilder, "_id");
+        const auto idQuery = idBuilder.obj();
+
+        BSONObj current;
+        auto rid = Helpers::findById(opCtx, target, idQuery);
+        if (!rid.isNull()) {
+            current = target->docFor(opCtx, rid).value();
+        }
+
+        MutableDocument group;
+        group.addField("_id", id);
+        for (size_t i = 0; i < fields.size(); ++i) {
+            auto total = fields[i].makeAccumulator();
+            total->process(Value(current[fields[i].fieldName]), false);
+            total->process(changes[i]->getValue(false), false);
+            group.addField(fields[i].fieldName, total->getValue(false));
+        }
+
+        if (group.peek()[fields[_countIndex].fieldName].coerceToDouble() > 0) {
+            Helpers::upsert(opCtx, target->ns().ns(), group.freeze().toBson());
+        } else if (!rid.isNull()) {
+            deleteObjects(opCtx, target, target->ns(), idQuery, true /* justOne */);
+        }
+    }
+    _changes.clear();
+}
+
+}  // namespace mongo
@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/exec/document_value/value_comparator.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_queue.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/pipeline.h"
+
+namespace mongo {
+
+class Collection;
+class OperationContext;
+
+/**
+ * A materialized view is a collection holding the output of a $group over a source collection in
+ * the same database, which is kept up to date as documents are inserted into, updated in and
+ * deleted from the source. Its definition, {source: <collection name>, pipeline: [...]}, is stored
+ * in the 'materializedView' option of the view's collection.
+ *
+ * The pipeline is any number of $match, $project, $addFields, $set, $unset and $unwind stages,
+ * followed by a $group whose accumulators are all $sum, one of which counts the documents of each
+ * group with {$sum: 1}. Since every accumulator is a sum, the contributions of a source document
+ * to its group can be added or subtracted without reading the group's other documents: an insert
+ * adds them, a delete subtracts them and an update does both. A group whose count reaches zero is
+ * removed from the view.
+ *
+ * A MaterializedView is parsed for each batch of writes to the source collection, and is not
+ * thread-safe.
+ */
+class MaterializedView {
+public:
+    static constexpr StringData kSourceFieldName = "source"_sd;
+    static constexpr StringData kPipelineFieldName = "pipeline"_sd;
+
+    /**
+     * Returns the namespace of the source collection of the materialized view with the given
+     * 'definition', stored in the database 'dbName'. Throws if the definition has no valid source.
+     */
+    static NamespaceString getSource(StringData dbName, const BSONObj& definition);
+
+    /**
+     * Parses the 'definition' of a materialized view stored in the database 'dbName'. Throws if
+     * the definition is invalid.
+     */
+    MaterializedView(OperationContext* opCtx, StringData dbName, const BSONObj& definition);
+
+    /**
+     * Adds the contributions of the source document 'doc' to the pending changes to the view.
+     */
+    void addDocument(const BSONObj& doc) {
+        _accumulate(doc, false);
+    }
+
+    /**
+     * Subtracts the contributions of the source document 'doc' from the pending changes to the
+     * view.
+     */
+    void removeDocument(const BSONObj& doc) {
+        _accumulate(doc, true);
+    }
+
+    /**
+     * Writes the pending changes to the groups of the view into the view's collection, 'target',
+     * and clears them. The caller must hold an intent lock on 'target' within a WriteUnitOfWork.
+     */
+    void applyChanges(OperationContext* opCtx, const Collection* target);
+
+private:
+    void _accumulate(const BSONObj& doc, bool remove);
+
+    boost::intrusive_ptr<ExpressionContext> _expCtx;
+
+    // The source documents are pushed into '_input', the first stage of '_pipeline', which applies
+    // the stages of the definition before its $group.
+    boost::intrusive_ptr<DocumentSourceQueue> _input;
+    std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
+
+    boost::intrusive_ptr<DocumentSourceGroup> _group;
+
+    // The position of the {$sum: 1} accumulator among the accumulated fields of '_group'.
+    size_t _countIndex = 0;
+
+    // The sum of the contributions of the documents added and removed so far, by group _id.
+    ValueUnorderedMap<DocumentSourceGroup::Accumulators> _changes =
+        ValueComparator().makeUnorderedValueMap<DocumentSourceGroup::Accumulators>();
+};
+
+}  // namespace mongo
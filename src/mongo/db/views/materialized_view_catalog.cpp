@@ -0,0 +1,126 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/views/materialized_view_catalog.h"
+
+#include <algorithm>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_catalog.h"
+#include "mongo/db/storage/durable_catalog.h"
+#include "mongo/db/views/materialized_view.h"
+
+namespace mongo {
+namespace {
+
+const auto getMaterializedViewCatalog =
+    ServiceContext::declareDecoration<MaterializedViewCatalog>();
+
+}  // namespace
+
+MaterializedViewCatalog& MaterializedViewCatalog::get(ServiceContext* serviceContext) {
+    return getMaterializedViewCatalog(serviceContext);
+}
+
+std::vector<MaterializedViewCatalog::Entry> MaterializedViewCatalog::lookup(
+    OperationContext* opCtx, const NamespaceString& source) {
+    const auto dbName = source.db().toString();
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (_loadedDbs.count(dbName)) {
+            auto it = _bySource.find(source);
+            return it == _bySource.end() ? std::vector<Entry>{} : it->second;
+        }
+    }
+
+    // Read the definitions without holding the mutex. Views created concurrently are added when
+    // their creation commits, and stale definitions of dropped views are ignored by the users.
+    std::vector<std::pair<NamespaceString, Entry>> loaded;
+    const auto& catalog = CollectionCatalog::get(opCtx);
+    for (auto&& uuid : catalog.getAllCollectionUUIDsFromDb(dbName)) {
+        auto coll = catalog.lookupCollectionByUUID(opCtx, uuid);
+        if (!coll) {
+            continue;
+        }
+        auto options =
+            DurableCatalog::get(opCtx)->getCollectionOptions(opCtx, coll->getCatalogId());
+        if (!options.materializedView.isEmpty()) {
+            loaded.emplace_back(MaterializedView::getSource(dbName, options.materializedView),
+                                Entry{uuid, options.materializedView});
+        }
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    for (auto&& [viewSource, entry] : loaded) {
+        _add(lk, viewSource, std::move(entry));
+    }
+    _loadedDbs.insert(dbName);
+
+    auto it = _bySource.find(source);
+    return it == _bySource.end() ? std::vector<Entry>{} : it->second;
+}
+
+void MaterializedViewCatalog::add(const NamespaceString& source, Entry entry) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _add(lk, source, std::move(entry));
+}
+
+void MaterializedViewCatalog::_add(WithLock, const NamespaceString& source, Entry entry) {
+    auto& entries = _bySource[source];
+    auto sameTarget = [&](const Entry& other) { return other.target == entry.target; };
+    if (std::none_of(entries.begin(), entries.end(), sameTarget)) {
+        entries.push_back(std::move(entry));
+    }
+}
+
+void MaterializedViewCatalog::remove(const UUID& target) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    for (auto it = _bySource.begin(); it != _bySource.end();) {
+        auto& entries = it->second;
+        entries.erase(std::remove_if(entries.begin(),
+                                     entries.end(),
+                                     [&](const Entry& entry) { return entry.target == target; }),
+                      entries.end());
+        if (entries.empty()) {
+            _bySource.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MaterializedViewCatalog::clear() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _loadedDbs.clear();
+    _bySource.clear();
+}
+
+}  // namespace mongo
@@ -0,0 +1,96 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+/**
+ * Caches the definitions of the materialized views over each source collection, so that writes to
+ * collections which are not the source of any view can be told apart cheaply. The definitions of
+ * the views of a database are read from the options of its collections the first time a write to
+ * the database is looked up, and are then kept up to date as views are created and dropped.
+ *
+ * The cache may briefly hold the definition of a view which has just been dropped, so users must
+ * check that the view's collection still exists. This class is thread safe.
+ */
+class MaterializedViewCatalog {
+public:
+    struct Entry {
+        // The UUID of the collection holding the view.
+        UUID target;
+        // The 'materializedView' option of that collection.
+        BSONObj definition;
+    };
+
+    static MaterializedViewCatalog& get(ServiceContext* serviceContext);
+
+    /**
+     * Returns the materialized views whose source is 'source'. The caller must hold at least an
+     * intent lock on the database of 'source'.
+     */
+    std::vector<Entry> lookup(OperationContext* opCtx, const NamespaceString& source);
+
+    /**
+     * Records the materialized view 'entry' over 'source'.
+     */
+    void add(const NamespaceString& source, Entry entry);
+
+    /**
+     * Forgets the materialized view held in the collection 'target', if any.
+     */
+    void remove(const UUID& target);
+
+    /**
+     * Forgets every definition, so that they are read again from the collections' options.
+     */
+    void clear();
+
+private:
+    void _add(WithLock, const NamespaceString& source, Entry entry);
+
+    Mutex _mutex = MONGO_MAKE_LATCH("MaterializedViewCatalog::_mutex");
+
+    // The databases whose collections' options have been read.
+    std::set<std::string> _loadedDbs;
+    stdx::unordered_map<NamespaceString, std::vector<Entry>> _bySource;
+};
+
+}  // namespace mongo
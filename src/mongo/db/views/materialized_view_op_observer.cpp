@@ -0,0 +1,299 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/views/materialized_view_op_observer.h"
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_catalog.h"
+#include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/catalog_raii.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/views/materialized_view.h"
+#include "mongo/db/views/materialized_view_catalog.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+// The document being deleted from the source of a materialized view, between aboutToDelete() and
+// onDelete().
+const auto documentToDelete = OperationContext::declareDecoration<boost::optional<BSONObj>>();
+
+/**
+ * Returns true if the materialized views over 'nss' should be updated with this operation's
+ * writes to 'nss'.
+ */
+bool shouldMaintainViews(OperationContext* opCtx, const NamespaceString& nss) {
+    return opCtx->writesAreReplicated() && !nss.isOnInternalDb() && !nss.isSystem();
+}
+
+/**
+ * Applies the changes recorded by 'accumulate' to each of the materialized views over 'source'.
+ */
+template <typename Accumulate>
+void maintainViews(OperationContext* opCtx,
+                   const NamespaceString& source,
+                   const std::vector<MaterializedViewCatalog::Entry>& views,
+                   Accumulate&& accumulate) {
+    for (auto&& entry : views) {
+        auto targetNss = CollectionCatalog::get(opCtx).lookupNSSByUUID(opCtx, entry.target);
+        if (!targetNss) {
+            continue;
+        }
+
+        AutoGetCollection target(opCtx, *targetNss, MODE_IX);
+        if (!target.getCollection() || target.getCollection()->uuid() != entry.target) {
+            continue;
+        }
+
+        MaterializedView view(opCtx, source.db(), entry.definition);
+        accumulate(view);
+        view.applyChanges(opCtx, target.getCollection());
+    }
+}
+
+}  // namespace
+
+void MaterializedViewOpObserver::onInserts(OperationContext* opCtx,
+                                           const NamespaceString& nss,
+                                           OptionalCollectionUUID uuid,
+                                           std::vector<InsertStatement>::const_iterator first,
+                                           std::vector<InsertStatement>::const_iterator last,
+                                           bool fromMigrate) {
+    if (fromMigrate || !shouldMaintainViews(opCtx, nss)) {
+        return;
+    }
+
+    auto views = MaterializedViewCatalog::get(opCtx->getServiceContext()).lookup(opCtx, nss);
+    maintainViews(opCtx, nss, views, [&](MaterializedView& view) {
+        for (auto it = first; it != last; ++it) {
+            view.addDocument(it->doc);
+        }
+    });
+}
+
+void MaterializedViewOpObserver::onUpdate(OperationContext* opCtx,
+                                          const OplogUpdateEntryArgs& args) {
+    if (args.updateArgs.fromMigrate || !shouldMaintainViews(opCtx, args.nss)) {
+        return;
+    }
+
+    auto views =
+        MaterializedViewCatalog::get(opCtx->getServiceContext()).lookup(opCtx, args.nss);
+    if (views.empty()) {
+        return;
+    }
+
+    // In-place updates only keep the pre-image of the document when the collection records them.
+    uassert(5095430,
+            str::stream() << "Cannot apply an update of " << args.nss
+                          << " to the materialized views over it without the pre-image of the "
+                             "document, 'recordPreImages' must be enabled on the collection",
+            args.updateArgs.preImageDoc);
+    maintainViews(opCtx, args.nss, views, [&](MaterializedView& view) {
+        view.removeDocument(*args.updateArgs.preImageDoc);
+        view.addDocument(args.updateArgs.updatedDoc);
+    });
+}
+
+void MaterializedViewOpObserver::aboutToDelete(OperationContext* opCtx,
+                                               const NamespaceString& nss,
+                                               const BSONObj& doc) {
+    auto& toDelete = documentToDelete(opCtx);
+    toDelete = boost::none;
+    if (shouldMaintainViews(opCtx, nss) &&
+        !MaterializedViewCatalog::get(opCtx->getServiceContext()).lookup(opCtx, nss).empty()) {
+        toDelete = doc.getOwned();
+    }
+}
+
+void MaterializedViewOpObserver::onDelete(OperationContext* opCtx,
+                                          const NamespaceString& nss,
+                                          OptionalCollectionUUID uuid,
+                                          StmtId stmtId,
+                                          bool fromMigrate,
+                                          const boost::optional<BSONObj>& deletedDoc) {
+    auto toDelete = std::exchange(documentToDelete(opCtx), boost::none);
+    if (!toDelete || fromMigrate) {
+        return;
+    }
+
+    auto views = MaterializedViewCatalog::get(opCtx->getServiceContext()).lookup(opCtx, nss);
+    maintainViews(
+        opCtx, nss, views, [&](MaterializedView& view) { view.removeDocument(*toDelete); });
+}
+
+void MaterializedViewOpObserver::onCreateCollection(OperationContext* opCtx,
+                                                    const Collection* coll,
+                                                    const NamespaceString& collectionName,
+                                                    const CollectionOptions& options,
+                                                    const BSONObj& idIndex,
+                                                    const OplogSlot& createOpTime) {
+    // Temporary collections copy the options of the collection they replace, as well as its
+    // documents.
+    if (options.materializedView.isEmpty() || options.temp) {
+        return;
+    }
+
+    const auto source = MaterializedView::getSource(collectionName.db(), options.materializedView);
+    if (shouldMaintainViews(opCtx, collectionName)) {
+        uassert(5095427,
+                str::stream() << "A materialized view cannot be its own source: " << source,
+                source != collectionName);
+
+        // Writes to the source which commit after the documents below are read are only applied
+        // to the view once it is registered, when its creation commits. Creating the collection
+        // holds the source in MODE_S until then, so that no write falls in between.
+        uassert(5095434,
+                str::stream() << "The source of a materialized view must be locked against writes "
+                                 "while the view is created: "
+                              << source,
+                opCtx->lockState()->isCollectionLockedForMode(source, MODE_S));
+
+        AutoGetCollection sourceColl(opCtx, source, MODE_IS);
+        uassert(5095428,
+                str::stream() << "The source of a materialized view must be an existing "
+                                 "collection with 'recordPreImages' enabled: "
+                              << source,
+                sourceColl.getCollection() && sourceColl.getCollection()->getRecordPreImages());
+        uassert(5095429,
+                str::stream() << "The source of a materialized view must use the simple "
+                                 "collation: "
+                              << source,
+                !sourceColl.getCollection()->getDefaultCollator());
+
+        // Fill the view from the current documents of the source, as part of its creation.
+        MaterializedView view(opCtx, collectionName.db(), options.materializedView);
+        auto cursor = sourceColl.getCollection()->getCursor(opCtx);
+        while (auto record = cursor->next()) {
+            view.addDocument(record->data.toBson());
+        }
+        view.applyChanges(opCtx, coll);
+    }
+
+    opCtx->recoveryUnit()->onCommit(
+        [serviceContext = opCtx->getServiceContext(),
+         source,
+         entry = MaterializedViewCatalog::Entry{coll->uuid(), options.materializedView}](
+            boost::optional<Timestamp>) {
+            MaterializedViewCatalog::get(serviceContext).add(source, entry);
+        });
+}
+
+void MaterializedViewOpObserver::onCollMod(OperationContext* opCtx,
+                                          const NamespaceString& nss,
+                                          OptionalCollectionUUID uuid,
+                                          const BSONObj& collModCmd,
+                                          const CollectionOptions& oldCollOptions,
+                                          boost::optional<IndexCollModInfo> indexInfo) {
+    // collMod sets 'recordPreImages' to false unless the command enables it.
+    if (!shouldMaintainViews(opCtx, nss) || !oldCollOptions.recordPreImages ||
+        collModCmd["recordPreImages"].trueValue()) {
+        return;
+    }
+
+    uassert(5095435,
+            str::stream() << "Cannot disable 'recordPreImages' on " << nss
+                          << ", which is the source of materialized views; drop the views first",
+            MaterializedViewCatalog::get(opCtx->getServiceContext()).lookup(opCtx, nss).empty());
+}
+
+void MaterializedViewOpObserver::onRenameCollection(OperationContext* opCtx,
+                                                   const NamespaceString& fromCollection,
+                                                   const NamespaceString& toCollection,
+                                                   OptionalCollectionUUID uuid,
+                                                   OptionalCollectionUUID dropTargetUUID,
+                                                   std::uint64_t numRecords,
+                                                   bool stayTemp) {
+    postRenameCollection(opCtx, fromCollection, toCollection, uuid, dropTargetUUID, stayTemp);
+}
+
+void MaterializedViewOpObserver::postRenameCollection(OperationContext* opCtx,
+                                                     const NamespaceString& fromCollection,
+                                                     const NamespaceString& toCollection,
+                                                     OptionalCollectionUUID uuid,
+                                                     OptionalCollectionUUID dropTargetUUID,
+                                                     bool stayTemp) {
+    // Views refer to their source by name, so they would be fed by whichever collection is next
+    // given the name of their source.
+    auto& catalog = MaterializedViewCatalog::get(opCtx->getServiceContext());
+    if (shouldMaintainViews(opCtx, fromCollection)) {
+        uassert(5095436,
+                str::stream() << "Cannot rename " << fromCollection
+                              << ", which is the source of materialized views; drop the views "
+                                 "first",
+                catalog.lookup(opCtx, fromCollection).empty());
+    }
+    if (dropTargetUUID && shouldMaintainViews(opCtx, toCollection)) {
+        uassert(5095437,
+                str::stream() << "Cannot replace " << toCollection
+                              << ", which is the source of materialized views; drop the views "
+                                 "first",
+                catalog.lookup(opCtx, toCollection).empty());
+    }
+}
+
+repl::OpTime MaterializedViewOpObserver::onDropCollection(OperationContext* opCtx,
+                                                          const NamespaceString& collectionName,
+                                                          OptionalCollectionUUID uuid,
+                                                          std::uint64_t numRecords,
+                                                          const CollectionDropType dropType) {
+    // The views over a collection are in its database, so they are dropped along with it.
+    if (shouldMaintainViews(opCtx, collectionName)) {
+        auto db = DatabaseHolder::get(opCtx)->getDb(opCtx, collectionName.db());
+        uassert(5095438,
+                str::stream() << "Cannot drop " << collectionName
+                              << ", which is the source of materialized views; drop the views "
+                                 "first",
+                (db && db->isDropPending(opCtx)) ||
+                    MaterializedViewCatalog::get(opCtx->getServiceContext())
+                        .lookup(opCtx, collectionName)
+                        .empty());
+    }
+
+    if (uuid) {
+        opCtx->recoveryUnit()->onCommit([serviceContext = opCtx->getServiceContext(),
+                                         uuid = *uuid](boost::optional<Timestamp>) {
+            MaterializedViewCatalog::get(serviceContext).remove(uuid);
+        });
+    }
+    return {};
+}
+
+void MaterializedViewOpObserver::onReplicationRollback(OperationContext* opCtx,
+                                                       const RollbackObserverInfo& rbInfo) {
+    // Rollback may have created or dropped any view, so read the definitions again.
+    MaterializedViewCatalog::get(opCtx->getServiceContext()).clear();
+}
+
+}  // namespace mongo
@@ -155,12 +155,15 @@ public:
             mockChild->enqueueStateCode(PlanStage::NEED_TIME);
         }
 
+        const auto planCacheKey =
+            CollectionQueryInfo::get(collection).getPlanCache()->computeKey(*cq);
         CachedPlanStage cachedPlanStage(_expCtx.get(),
                                         collection,
                                         &_ws,
                                         cq,
                                         plannerParams,
                                         decisionWorks,
+                                        planCacheKey,
                                         std::move(mockChild));
 
         // This should succeed after triggering a replan.
@@ -210,12 +213,14 @@ TEST_F(QueryStageCachedPlan, QueryStageCachedPlanFailureMemoryLimitExceeded) {
 
     // High enough so that we shouldn't trigger a replan based on works.
     const size_t decisionWorks = 50;
+    const auto planCacheKey = CollectionQueryInfo::get(collection).getPlanCache()->computeKey(*cq);
     CachedPlanStage cachedPlanStage(_expCtx.get(),
                                     collection,
                                     &_ws,
                                     cq.get(),
                                     plannerParams,
                                     decisionWorks,
+                                    planCacheKey,
                                     std::move(mockChild));
 
     // This should succeed after triggering a replan.
@@ -264,12 +269,14 @@ TEST_F(QueryStageCachedPlan, QueryStageCachedPlanHitMaxWorks) {
         mockChild->enqueueStateCode(PlanStage::NEED_TIME);
     }
 
+    const auto planCacheKey = CollectionQueryInfo::get(collection).getPlanCache()->computeKey(*cq);
     CachedPlanStage cachedPlanStage(_expCtx.get(),
                                     collection,
                                     &_ws,
                                     cq.get(),
                                     plannerParams,
                                     decisionWorks,
+                                    planCacheKey,
                                     std::move(mockChild));
 
     // This should succeed after triggering a replan.
@@ -467,12 +474,14 @@ TEST_F(QueryStageCachedPlan, ThrowsOnYieldRecoveryWhenIndexIsDroppedBeforePlanSe
     fillOutPlannerParams(&_opCtx, collection, cq.get(), &plannerParams);
 
     const size_t decisionWorks = 10;
+    const auto planCacheKey = CollectionQueryInfo::get(collection).getPlanCache()->computeKey(*cq);
     CachedPlanStage cachedPlanStage(_expCtx.get(),
                                     collection,
                                     &_ws,
                                     cq.get(),
                                     plannerParams,
                                     decisionWorks,
+                                    planCacheKey,
                                     std::make_unique<MockStage>(_expCtx.get(), &_ws));
 
     // Drop an index while the CachedPlanStage is in a saved state. Restoring should fail, since we
@@ -509,12 +518,14 @@ TEST_F(QueryStageCachedPlan, DoesNotThrowOnYieldRecoveryWhenIndexIsDroppedAferPl
     fillOutPlannerParams(&_opCtx, collection, cq.get(), &plannerParams);
 
     const size_t decisionWorks = 10;
+    const auto planCacheKey = CollectionQueryInfo::get(collection).getPlanCache()->computeKey(*cq);
     CachedPlanStage cachedPlanStage(_expCtx.get(),
                                     collection,
                                     &_ws,
                                     cq.get(),
                                     plannerParams,
                                     decisionWorks,
+                                    planCacheKey,
                                     std::make_unique<MockStage>(_expCtx.get(), &_ws));
 
     NoopYieldPolicy yieldPolicy(_opCtx.getServiceContext()->getFastClockSource());